@@ -1,6 +1,6 @@
 # cython: language_level=3
 # from libc.stdlib cimport malloc, free
-from libc.stdint cimport int64_t, uintptr_t, uint32_t, int32_t, uint16_t, uint8_t, int8_t
+from libc.stdint cimport int64_t, uint64_t, uintptr_t, uint32_t, int32_t, uint16_t, uint8_t, int8_t
 from cpython.mem cimport PyMem_Malloc, PyMem_Free
 # from cpython.view cimport array as cvarray
 import numpy as np
@@ -141,6 +141,8 @@ cdef extern from "../include/pgenlib_read.h" namespace "plink2":
 
     PglErr PgrGet1(const uintptr_t* sample_include, PgrSampleSubsetIndexStruct pssi, uint32_t sample_ct, uint32_t vidx, uint32_t allele_idx, PgenReaderStruct* pgr_ptr, uintptr_t* allele_countvec)
 
+    PglErr PgrGet1Batch(const uintptr_t* sample_include, PgrSampleSubsetIndexStruct pssi, uint32_t sample_ct, const uintptr_t* variant_include, const uint32_t* variant_uidxs, uint32_t variant_uidx_start, uint32_t variant_ct, uint32_t allele_idx, PgenReaderStruct* pgr_ptr, uintptr_t dest_word_stride, uintptr_t* dest)
+
     PglErr PgrGetP(const uintptr_t* sample_include, PgrSampleSubsetIndexStruct pssi, uint32_t sample_ct, uint32_t vidx, PgenReaderStruct* pgr_ptr, uintptr_t* genovec, uintptr_t* phasepresent, uintptr_t* phaseinfo, uint32_t* phasepresent_ct_ptr)
 
     PglErr PgrGet1D(const uintptr_t* sample_include, PgrSampleSubsetIndexStruct pssi, uint32_t sample_ct, uint32_t vidx, AlleleCode allele_idx, PgenReaderStruct* pgr_ptr, uintptr_t* allele_countvec, uintptr_t* dosage_present, uint16_t* dosage_main, uint32_t* dosage_ct_ptr)
@@ -150,6 +152,22 @@ cdef extern from "../include/pgenlib_read.h" namespace "plink2":
     BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp)
     BoolErr CleanupPgr(PgenReaderStruct* pgr_ptr, PglErr* reterrp)
 
+    ctypedef struct PgenVrecCacheStats:
+        uint64_t record_hit_ct
+        uint64_t record_miss_ct
+        uint64_t ldbase_hit_ct
+        uint64_t ldbase_miss_ct
+        uint64_t evict_ct
+        uintptr_t entry_ct
+        uintptr_t byte_ct
+        uintptr_t byte_budget
+
+
+cdef extern from "../pgenlib_ffi_support.h" namespace "plink2":
+    PglErr SetSharedVrecCache(uintptr_t byte_budget, uint32_t cache_ldbase_genovecs)
+    PglErr AttachSharedVrecCache(const char* fname, PgenFileInfo* pgfip)
+    void GetSharedVrecCacheStats(PgenVrecCacheStats* statsp)
+
 
 cdef extern from "../include/pgenlib_write.h" namespace "plink2":
     cdef cppclass PgenWriterCommon:
@@ -171,6 +189,10 @@ cdef extern from "../include/pgenlib_write.h" namespace "plink2":
 
     void SpgwInitPhase2(uint32_t max_vrec_len, STPgenWriter* spgwp, unsigned char* spgw_alloc)
 
+    PglErr SpgwInitPhase1Append(const char* fname, uintptr_t* allele_idx_offsets, uintptr_t* explicit_nonref_flags, uint32_t append_variant_ct, uint32_t sample_ct, uint32_t optional_max_allele_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, STPgenWriter* spgwp, uintptr_t* alloc_cacheline_ct_ptr, uint32_t* max_vrec_len_ptr, uint32_t* prev_variant_ct_ptr)
+
+    PglErr SpgwInitPhase2Append(uint32_t max_vrec_len, STPgenWriter* spgwp, unsigned char* spgw_alloc)
+
     PglErr SpgwAppendBiallelicGenovec(const uintptr_t* genovec, STPgenWriter* spgwp)
 
     PglErr SpgwAppendBiallelicGenovecHphase(const uintptr_t* genovec, const uintptr_t* phasepresent, const uintptr_t* phaseinfo, STPgenWriter* spgwp)
@@ -287,6 +309,8 @@ cdef class PgenReader:
             # todo: support this by wrapping pvar loader the same way as the R
             # interface
             raise RuntimeError("Multiallelic + phase/dosage datasets not supported yet")
+        if AttachSharedVrecCache(fname, self._info_ptr) != kPglRetSuccess:
+            raise RuntimeError("Failed to attach shared record cache.")
 
         self._state_ptr = <PgenReaderStruct*>PyMem_Malloc(sizeof(PgenReaderStruct))
         if not self._state_ptr:
@@ -452,23 +476,31 @@ cdef class PgenReader:
         cdef const uintptr_t* subset_include_vec = self._subset_include_vec
         cdef PgrSampleSubsetIndexStruct subset_index = self._subset_index
         cdef PgenReaderStruct* pgrp = self._state_ptr
-        cdef uintptr_t* genovec = self._genovec
         cdef uint32_t variant_idx_ct = variant_idx_end - variant_idx_start
         cdef uint32_t subset_size = self._subset_size
         cdef int8_t* data_ptr
         cdef uint32_t variant_idx
         cdef PglErr reterr
+        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
+        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
+        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
+        cdef uintptr_t* vmaj_iter
+        cdef uint32_t uii
         if sample_maj == 0:
             if geno_int8_out.shape[0] < variant_idx_ct:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few rows (" + str(geno_int8_out.shape[0]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
             if geno_int8_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few columns (" + str(geno_int8_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_idx in range(variant_idx_start, variant_idx_end):
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
+            for variant_idx in range(variant_idx_start, variant_idx_end, kPglNypTransposeBatch):
+                variant_batch_size = min(kPglNypTransposeBatch, variant_idx_end - variant_idx)
+                reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, NULL, variant_idx, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
                 if reterr != kPglRetSuccess:
                     raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = &(geno_int8_out[(variant_idx - variant_idx_start), 0])
-                GenoarrToBytesMinus9(genovec, subset_size, data_ptr)
+                vmaj_iter = multivar_vmaj_geno_buf
+                for uii in range(variant_batch_size):
+                    data_ptr = &(geno_int8_out[uii + variant_idx - variant_idx_start, 0])
+                    GenoarrToBytesMinus9(vmaj_iter, subset_size, data_ptr)
+                    vmaj_iter = &(vmaj_iter[sample_ctaw2])
             return
         if variant_idx_start >= variant_idx_end:
             raise RuntimeError("read_range() variant_idx_start >= variant_idx_end (" + str(variant_idx_start) + ", " + str(variant_idx_end) + ")")
@@ -477,28 +509,20 @@ cdef class PgenReader:
         if geno_int8_out.shape[1] < variant_idx_ct:
             raise RuntimeError("Sample-major read_range() geno_int_out buffer has too few columns (" + str(geno_int8_out.shape[1]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
         cdef uint32_t variant_batch_ct = DivUp(variant_idx_ct, kPglNypTransposeBatch)
-        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
         cdef uint32_t variant_idx_offset = variant_idx_start
-        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
         cdef uint32_t sample_batch_ct = DivUp(subset_size, kPglNypTransposeBatch)
         cdef VecW* transpose_batch_buf = self._transpose_batch_buf
-        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
         cdef uintptr_t* multivar_smaj_geno_batch_buf = self._multivar_smaj_geno_batch_buf
-        cdef uintptr_t* vmaj_iter
         cdef uintptr_t* smaj_iter
         cdef uint32_t variant_batch_idx
         cdef uint32_t sample_batch_size
         cdef uint32_t sample_batch_idx
-        cdef uint32_t uii
         for variant_batch_idx in range(variant_batch_ct):
             if variant_batch_idx == (variant_batch_ct - 1):
                 variant_batch_size = 1 + <uint32_t>((variant_idx_ct - 1) % kPglNypTransposeBatch)
-            vmaj_iter = multivar_vmaj_geno_buf
-            for uii in range(variant_batch_size):
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, uii + variant_idx_offset, allele_idx, pgrp, vmaj_iter)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                vmaj_iter = &(vmaj_iter[sample_ctaw2])
+            reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, NULL, variant_idx_offset, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_range() error " + str(reterr))
             sample_batch_size = kPglNypTransposeBatch
             vmaj_iter = multivar_vmaj_geno_buf
             for sample_batch_idx in range(sample_batch_ct):
@@ -520,23 +544,31 @@ cdef class PgenReader:
         cdef const uintptr_t* subset_include_vec = self._subset_include_vec
         cdef PgrSampleSubsetIndexStruct subset_index = self._subset_index
         cdef PgenReaderStruct* pgrp = self._state_ptr
-        cdef uintptr_t* genovec = self._genovec
         cdef uint32_t variant_idx_ct = variant_idx_end - variant_idx_start
         cdef uint32_t subset_size = self._subset_size
         cdef int32_t* data_ptr
         cdef uint32_t variant_idx
         cdef PglErr reterr
+        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
+        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
+        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
+        cdef uintptr_t* vmaj_iter
+        cdef uint32_t uii
         if sample_maj == 0:
             if geno_int32_out.shape[0] < variant_idx_ct:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few rows (" + str(geno_int32_out.shape[0]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
             if geno_int32_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few columns (" + str(geno_int32_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_idx in range(variant_idx_start, variant_idx_end):
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
+            for variant_idx in range(variant_idx_start, variant_idx_end, kPglNypTransposeBatch):
+                variant_batch_size = min(kPglNypTransposeBatch, variant_idx_end - variant_idx)
+                reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, NULL, variant_idx, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
                 if reterr != kPglRetSuccess:
                     raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = <int32_t*>(&(geno_int32_out[(variant_idx - variant_idx_start), 0]))
-                GenoarrToInt32sMinus9(genovec, subset_size, data_ptr)
+                vmaj_iter = multivar_vmaj_geno_buf
+                for uii in range(variant_batch_size):
+                    data_ptr = <int32_t*>(&(geno_int32_out[uii + variant_idx - variant_idx_start, 0]))
+                    GenoarrToInt32sMinus9(vmaj_iter, subset_size, data_ptr)
+                    vmaj_iter = &(vmaj_iter[sample_ctaw2])
             return
         if variant_idx_start >= variant_idx_end:
             raise RuntimeError("read_range() variant_idx_start >= variant_idx_end (" + str(variant_idx_start) + ", " + str(variant_idx_end) + ")")
@@ -545,28 +577,20 @@ cdef class PgenReader:
         if geno_int32_out.shape[1] < variant_idx_ct:
             raise RuntimeError("Sample-major read_range() geno_int_out buffer has too few columns (" + str(geno_int32_out.shape[1]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
         cdef uint32_t variant_batch_ct = DivUp(variant_idx_ct, kPglNypTransposeBatch)
-        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
         cdef uint32_t variant_idx_offset = variant_idx_start
-        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
         cdef uint32_t sample_batch_ct = DivUp(subset_size, kPglNypTransposeBatch)
         cdef VecW* transpose_batch_buf = self._transpose_batch_buf
-        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
         cdef uintptr_t* multivar_smaj_geno_batch_buf = self._multivar_smaj_geno_batch_buf
-        cdef uintptr_t* vmaj_iter
         cdef uintptr_t* smaj_iter
         cdef uint32_t variant_batch_idx
         cdef uint32_t sample_batch_size
         cdef uint32_t sample_batch_idx
-        cdef uint32_t uii
         for variant_batch_idx in range(variant_batch_ct):
             if variant_batch_idx == (variant_batch_ct - 1):
                 variant_batch_size = 1 + <uint32_t>((variant_idx_ct - 1) % kPglNypTransposeBatch)
-            vmaj_iter = multivar_vmaj_geno_buf
-            for uii in range(variant_batch_size):
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, uii + variant_idx_offset, allele_idx, pgrp, vmaj_iter)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                vmaj_iter = &(vmaj_iter[sample_ctaw2])
+            reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, NULL, variant_idx_offset, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_range() error " + str(reterr))
             sample_batch_size = kPglNypTransposeBatch
             vmaj_iter = multivar_vmaj_geno_buf
             for sample_batch_idx in range(sample_batch_ct):
@@ -588,23 +612,31 @@ cdef class PgenReader:
         cdef const uintptr_t* subset_include_vec = self._subset_include_vec
         cdef PgrSampleSubsetIndexStruct subset_index = self._subset_index
         cdef PgenReaderStruct* pgrp = self._state_ptr
-        cdef uintptr_t* genovec = self._genovec
         cdef uint32_t variant_idx_ct = variant_idx_end - variant_idx_start
         cdef uint32_t subset_size = self._subset_size
         cdef int64_t* data_ptr
         cdef uint32_t variant_idx
         cdef PglErr reterr
+        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
+        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
+        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
+        cdef uintptr_t* vmaj_iter
+        cdef uint32_t uii
         if sample_maj == 0:
             if geno_int64_out.shape[0] < variant_idx_ct:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few rows (" + str(geno_int64_out.shape[0]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
             if geno_int64_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few columns (" + str(geno_int64_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_idx in range(variant_idx_start, variant_idx_end):
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
+            for variant_idx in range(variant_idx_start, variant_idx_end, kPglNypTransposeBatch):
+                variant_batch_size = min(kPglNypTransposeBatch, variant_idx_end - variant_idx)
+                reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, NULL, variant_idx, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
                 if reterr != kPglRetSuccess:
                     raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = &(geno_int64_out[(variant_idx - variant_idx_start), 0])
-                GenoarrToInt64sMinus9(genovec, subset_size, data_ptr)
+                vmaj_iter = multivar_vmaj_geno_buf
+                for uii in range(variant_batch_size):
+                    data_ptr = &(geno_int64_out[uii + variant_idx - variant_idx_start, 0])
+                    GenoarrToInt64sMinus9(vmaj_iter, subset_size, data_ptr)
+                    vmaj_iter = &(vmaj_iter[sample_ctaw2])
             return
         if variant_idx_start >= variant_idx_end:
             raise RuntimeError("read_range() variant_idx_start >= variant_idx_end (" + str(variant_idx_start) + ", " + str(variant_idx_end) + ")")
@@ -613,28 +645,20 @@ cdef class PgenReader:
         if geno_int64_out.shape[1] < variant_idx_ct:
             raise RuntimeError("Sample-major read_range() geno_int_out buffer has too few columns (" + str(geno_int64_out.shape[1]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
         cdef uint32_t variant_batch_ct = DivUp(variant_idx_ct, kPglNypTransposeBatch)
-        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
         cdef uint32_t variant_idx_offset = variant_idx_start
-        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
         cdef uint32_t sample_batch_ct = DivUp(subset_size, kPglNypTransposeBatch)
         cdef VecW* transpose_batch_buf = self._transpose_batch_buf
-        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
         cdef uintptr_t* multivar_smaj_geno_batch_buf = self._multivar_smaj_geno_batch_buf
-        cdef uintptr_t* vmaj_iter
         cdef uintptr_t* smaj_iter
         cdef uint32_t variant_batch_idx
         cdef uint32_t sample_batch_size
         cdef uint32_t sample_batch_idx
-        cdef uint32_t uii
         for variant_batch_idx in range(variant_batch_ct):
             if variant_batch_idx == (variant_batch_ct - 1):
                 variant_batch_size = 1 + <uint32_t>((variant_idx_ct - 1) % kPglNypTransposeBatch)
-            vmaj_iter = multivar_vmaj_geno_buf
-            for uii in range(variant_batch_size):
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, uii + variant_idx_offset, allele_idx, pgrp, vmaj_iter)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                vmaj_iter = &(vmaj_iter[sample_ctaw2])
+            reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, NULL, variant_idx_offset, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_range() error " + str(reterr))
             sample_batch_size = kPglNypTransposeBatch
             vmaj_iter = multivar_vmaj_geno_buf
             for sample_batch_idx in range(sample_batch_ct):
@@ -668,58 +692,63 @@ cdef class PgenReader:
         cdef const uintptr_t* subset_include_vec = self._subset_include_vec
         cdef PgrSampleSubsetIndexStruct subset_index = self._subset_index
         cdef PgenReaderStruct* pgrp = self._state_ptr
-        cdef uintptr_t* genovec = self._genovec
         cdef uint32_t variant_idx_ct = <uint32_t>variant_idxs.shape[0]
         cdef uint32_t subset_size = self._subset_size
         cdef int8_t* data_ptr
         cdef uint32_t variant_list_idx
         cdef uint32_t variant_idx
         cdef PglErr reterr
+        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
+        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
+        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
+        cdef uintptr_t* vmaj_iter
+        cdef uint32_t uii
+        cdef uint32_t[kPglNypTransposeBatch] batch_variant_idxs
         if sample_maj == 0:
             if geno_int8_out.shape[0] < variant_idx_ct:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few rows (" + str(geno_int8_out.shape[0]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
             if geno_int8_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few columns (" + str(geno_int8_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_list_idx in range(variant_idx_ct):
-                variant_idx = variant_idxs[variant_list_idx]
-                if variant_idx >= raw_variant_ct:
-                    raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
+            for variant_list_idx in range(0, variant_idx_ct, kPglNypTransposeBatch):
+                variant_batch_size = min(kPglNypTransposeBatch, variant_idx_ct - variant_list_idx)
+                for uii in range(variant_batch_size):
+                    variant_idx = variant_idxs[uii + variant_list_idx]
+                    if variant_idx >= raw_variant_ct:
+                        raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
+                    batch_variant_idxs[uii] = variant_idx
+                reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, batch_variant_idxs, 0, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
                 if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = &(geno_int8_out[variant_list_idx, 0])
-                GenoarrToBytesMinus9(genovec, subset_size, data_ptr)
+                    raise RuntimeError("read_list() error " + str(reterr))
+                vmaj_iter = multivar_vmaj_geno_buf
+                for uii in range(variant_batch_size):
+                    data_ptr = &(geno_int8_out[uii + variant_list_idx, 0])
+                    GenoarrToBytesMinus9(vmaj_iter, subset_size, data_ptr)
+                    vmaj_iter = &(vmaj_iter[sample_ctaw2])
             return
         if geno_int8_out.shape[0] < subset_size:
             raise RuntimeError("Sample-major read_list() geno_int_out buffer has too few rows (" + str(geno_int8_out.shape[0]) + "; current sample subset has size " + str(subset_size) + ")")
         if geno_int8_out.shape[1] < variant_idx_ct:
             raise RuntimeError("Sample-major read_list() geno_int_out buffer has too few columns (" + str(geno_int8_out.shape[1]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
         cdef uint32_t variant_batch_ct = DivUp(variant_idx_ct, kPglNypTransposeBatch)
-        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
-        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
         cdef uint32_t sample_batch_ct = DivUp(subset_size, kPglNypTransposeBatch)
         cdef VecW* transpose_batch_buf = self._transpose_batch_buf
-        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
         cdef uintptr_t* multivar_smaj_geno_batch_buf = self._multivar_smaj_geno_batch_buf
-        cdef uintptr_t* vmaj_iter
         cdef uintptr_t* smaj_iter
         cdef uint32_t variant_batch_idx
         cdef uint32_t sample_batch_size
         cdef uint32_t sample_batch_idx
-        cdef uint32_t uii
         variant_list_idx = 0
         for variant_batch_idx in range(variant_batch_ct):
             if variant_batch_idx == (variant_batch_ct - 1):
                 variant_batch_size = 1 + <uint32_t>((variant_idx_ct - 1) % kPglNypTransposeBatch)
-            vmaj_iter = multivar_vmaj_geno_buf
             for uii in range(variant_batch_size):
                 variant_idx = variant_idxs[uii + variant_list_idx]
                 if variant_idx >= raw_variant_ct:
                     raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, vmaj_iter)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_list() error " + str(reterr))
-                vmaj_iter = &(vmaj_iter[sample_ctaw2])
+                batch_variant_idxs[uii] = variant_idx
+            reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, batch_variant_idxs, 0, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_list() error " + str(reterr))
             sample_batch_size = kPglNypTransposeBatch
             vmaj_iter = multivar_vmaj_geno_buf
             for sample_batch_idx in range(sample_batch_ct):
@@ -740,58 +769,63 @@ cdef class PgenReader:
         cdef const uintptr_t* subset_include_vec = self._subset_include_vec
         cdef PgrSampleSubsetIndexStruct subset_index = self._subset_index
         cdef PgenReaderStruct* pgrp = self._state_ptr
-        cdef uintptr_t* genovec = self._genovec
         cdef uint32_t variant_idx_ct = <uint32_t>variant_idxs.shape[0]
         cdef uint32_t subset_size = self._subset_size
         cdef int32_t* data_ptr
         cdef uint32_t variant_list_idx
         cdef uint32_t variant_idx
         cdef PglErr reterr
+        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
+        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
+        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
+        cdef uintptr_t* vmaj_iter
+        cdef uint32_t uii
+        cdef uint32_t[kPglNypTransposeBatch] batch_variant_idxs
         if sample_maj == 0:
             if geno_int32_out.shape[0] < variant_idx_ct:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few rows (" + str(geno_int32_out.shape[0]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
             if geno_int32_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few columns (" + str(geno_int32_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_list_idx in range(variant_idx_ct):
-                variant_idx = variant_idxs[variant_list_idx]
-                if variant_idx >= raw_variant_ct:
-                    raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
+            for variant_list_idx in range(0, variant_idx_ct, kPglNypTransposeBatch):
+                variant_batch_size = min(kPglNypTransposeBatch, variant_idx_ct - variant_list_idx)
+                for uii in range(variant_batch_size):
+                    variant_idx = variant_idxs[uii + variant_list_idx]
+                    if variant_idx >= raw_variant_ct:
+                        raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
+                    batch_variant_idxs[uii] = variant_idx
+                reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, batch_variant_idxs, 0, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
                 if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = <int32_t*>(&(geno_int32_out[variant_list_idx, 0]))
-                GenoarrToInt32sMinus9(genovec, subset_size, data_ptr)
+                    raise RuntimeError("read_list() error " + str(reterr))
+                vmaj_iter = multivar_vmaj_geno_buf
+                for uii in range(variant_batch_size):
+                    data_ptr = <int32_t*>(&(geno_int32_out[uii + variant_list_idx, 0]))
+                    GenoarrToInt32sMinus9(vmaj_iter, subset_size, data_ptr)
+                    vmaj_iter = &(vmaj_iter[sample_ctaw2])
             return
         if geno_int32_out.shape[0] < subset_size:
             raise RuntimeError("Sample-major read_list() geno_int_out buffer has too few rows (" + str(geno_int32_out.shape[0]) + "; current sample subset has size " + str(subset_size) + ")")
         if geno_int32_out.shape[1] < variant_idx_ct:
             raise RuntimeError("Sample-major read_list() geno_int_out buffer has too few columns (" + str(geno_int32_out.shape[1]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
         cdef uint32_t variant_batch_ct = DivUp(variant_idx_ct, kPglNypTransposeBatch)
-        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
-        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
         cdef uint32_t sample_batch_ct = DivUp(subset_size, kPglNypTransposeBatch)
         cdef VecW* transpose_batch_buf = self._transpose_batch_buf
-        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
         cdef uintptr_t* multivar_smaj_geno_batch_buf = self._multivar_smaj_geno_batch_buf
-        cdef uintptr_t* vmaj_iter
         cdef uintptr_t* smaj_iter
         cdef uint32_t variant_batch_idx
         cdef uint32_t sample_batch_size
         cdef uint32_t sample_batch_idx
-        cdef uint32_t uii
         variant_list_idx = 0
         for variant_batch_idx in range(variant_batch_ct):
             if variant_batch_idx == (variant_batch_ct - 1):
                 variant_batch_size = 1 + <uint32_t>((variant_idx_ct - 1) % kPglNypTransposeBatch)
-            vmaj_iter = multivar_vmaj_geno_buf
             for uii in range(variant_batch_size):
                 variant_idx = variant_idxs[uii + variant_list_idx]
                 if variant_idx >= raw_variant_ct:
                     raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, vmaj_iter)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_list() error " + str(reterr))
-                vmaj_iter = &(vmaj_iter[sample_ctaw2])
+                batch_variant_idxs[uii] = variant_idx
+            reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, batch_variant_idxs, 0, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_list() error " + str(reterr))
             sample_batch_size = kPglNypTransposeBatch
             vmaj_iter = multivar_vmaj_geno_buf
             for sample_batch_idx in range(sample_batch_ct):
@@ -812,58 +846,63 @@ cdef class PgenReader:
         cdef const uintptr_t* subset_include_vec = self._subset_include_vec
         cdef PgrSampleSubsetIndexStruct subset_index = self._subset_index
         cdef PgenReaderStruct* pgrp = self._state_ptr
-        cdef uintptr_t* genovec = self._genovec
         cdef uint32_t variant_idx_ct = <uint32_t>variant_idxs.shape[0]
         cdef uint32_t subset_size = self._subset_size
         cdef int64_t* data_ptr
         cdef uint32_t variant_list_idx
         cdef uint32_t variant_idx
         cdef PglErr reterr
+        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
+        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
+        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
+        cdef uintptr_t* vmaj_iter
+        cdef uint32_t uii
+        cdef uint32_t[kPglNypTransposeBatch] batch_variant_idxs
         if sample_maj == 0:
             if geno_int64_out.shape[0] < variant_idx_ct:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few rows (" + str(geno_int64_out.shape[0]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
             if geno_int64_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few columns (" + str(geno_int64_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_list_idx in range(variant_idx_ct):
-                variant_idx = variant_idxs[variant_list_idx]
-                if variant_idx >= raw_variant_ct:
-                    raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
+            for variant_list_idx in range(0, variant_idx_ct, kPglNypTransposeBatch):
+                variant_batch_size = min(kPglNypTransposeBatch, variant_idx_ct - variant_list_idx)
+                for uii in range(variant_batch_size):
+                    variant_idx = variant_idxs[uii + variant_list_idx]
+                    if variant_idx >= raw_variant_ct:
+                        raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
+                    batch_variant_idxs[uii] = variant_idx
+                reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, batch_variant_idxs, 0, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
                 if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = &(geno_int64_out[variant_list_idx, 0])
-                GenoarrToInt64sMinus9(genovec, subset_size, data_ptr)
+                    raise RuntimeError("read_list() error " + str(reterr))
+                vmaj_iter = multivar_vmaj_geno_buf
+                for uii in range(variant_batch_size):
+                    data_ptr = &(geno_int64_out[uii + variant_list_idx, 0])
+                    GenoarrToInt64sMinus9(vmaj_iter, subset_size, data_ptr)
+                    vmaj_iter = &(vmaj_iter[sample_ctaw2])
             return
         if geno_int64_out.shape[0] < subset_size:
             raise RuntimeError("Sample-major read_list() geno_int_out buffer has too few rows (" + str(geno_int64_out.shape[0]) + "; current sample subset has size " + str(subset_size) + ")")
         if geno_int64_out.shape[1] < variant_idx_ct:
             raise RuntimeError("Sample-major read_list() geno_int_out buffer has too few columns (" + str(geno_int64_out.shape[1]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
         cdef uint32_t variant_batch_ct = DivUp(variant_idx_ct, kPglNypTransposeBatch)
-        cdef uint32_t variant_batch_size = kPglNypTransposeBatch
-        cdef uint32_t sample_ctaw2 = kWordsPerVec * DivUp(subset_size, kBitsPerWordD2)
         cdef uint32_t sample_batch_ct = DivUp(subset_size, kPglNypTransposeBatch)
         cdef VecW* transpose_batch_buf = self._transpose_batch_buf
-        cdef uintptr_t* multivar_vmaj_geno_buf = self._multivar_vmaj_geno_buf
         cdef uintptr_t* multivar_smaj_geno_batch_buf = self._multivar_smaj_geno_batch_buf
-        cdef uintptr_t* vmaj_iter
         cdef uintptr_t* smaj_iter
         cdef uint32_t variant_batch_idx
         cdef uint32_t sample_batch_size
         cdef uint32_t sample_batch_idx
-        cdef uint32_t uii
         variant_list_idx = 0
         for variant_batch_idx in range(variant_batch_ct):
             if variant_batch_idx == (variant_batch_ct - 1):
                 variant_batch_size = 1 + <uint32_t>((variant_idx_ct - 1) % kPglNypTransposeBatch)
-            vmaj_iter = multivar_vmaj_geno_buf
             for uii in range(variant_batch_size):
                 variant_idx = variant_idxs[uii + variant_list_idx]
                 if variant_idx >= raw_variant_ct:
                     raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, vmaj_iter)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_list() error " + str(reterr))
-                vmaj_iter = &(vmaj_iter[sample_ctaw2])
+                batch_variant_idxs[uii] = variant_idx
+            reterr = PgrGet1Batch(subset_include_vec, subset_index, subset_size, NULL, batch_variant_idxs, 0, variant_batch_size, allele_idx, pgrp, sample_ctaw2, multivar_vmaj_geno_buf)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_list() error " + str(reterr))
             sample_batch_size = kPglNypTransposeBatch
             vmaj_iter = multivar_vmaj_geno_buf
             for sample_batch_idx in range(sample_batch_ct):
@@ -1164,6 +1203,25 @@ cdef class PgenReader:
 
 
 
+def set_shared_cache(uintptr_t byte_budget, bint cache_ldbase_genovecs = True):
+    if SetSharedVrecCache(byte_budget, cache_ldbase_genovecs) != kPglRetSuccess:
+        raise MemoryError()
+    return
+
+
+def get_shared_cache_stats():
+    cdef PgenVrecCacheStats stats
+    GetSharedVrecCacheStats(&stats)
+    return {"record_hits": stats.record_hit_ct,
+            "record_misses": stats.record_miss_ct,
+            "ldbase_hits": stats.ldbase_hit_ct,
+            "ldbase_misses": stats.ldbase_miss_ct,
+            "evictions": stats.evict_ct,
+            "entries": stats.entry_ct,
+            "bytes": stats.byte_ct,
+            "byte_budget": stats.byte_budget}
+
+
 cdef bytes_to_bits_internal(np.ndarray[np.uint8_t,mode="c",cast=True] boolbytes, uint32_t sample_ct, uintptr_t* bitarr):
     BytesToBitsUnsafe(boolbytes, sample_ct, bitarr)
 
@@ -1183,9 +1241,12 @@ cdef class PgenWriter:
                   object allele_idx_offsets = None,
                   bint hardcall_phase_present = False,
                   bint dosage_present = False,
-                  bint dosage_phase_present = False):
+                  bint dosage_phase_present = False,
+                  bint append = False):
         if dosage_phase_present and not dosage_present:
             raise RuntimeError("Invalid arguments for PgenWriter constructor (dosage_phase_present true but dosage_present false).")
+        if append and (nonref_flags is not None) and (type(nonref_flags) != type(True)):
+            raise RuntimeError("Invalid arguments for PgenWriter constructor (append mode requires nonref_flags to be True, False, or None).")
         if allele_idx_offsets is not None:
             for uii in range(variant_ct + 1):
                 if allele_idx_offsets[uii] != uii * 2:
@@ -1217,15 +1278,27 @@ cdef class PgenWriter:
         assert not dosage_phase_present
         cdef uintptr_t alloc_cacheline_ct
         cdef uint32_t max_vrec_len
-        cdef PglErr reterr = SpgwInitPhase1(fname, NULL, self._nonref_flags, variant_ct, sample_ct, 0, phase_dosage_gflags, nonref_flags_storage, self._state_ptr, &alloc_cacheline_ct, &max_vrec_len)
-        if reterr != kPglRetSuccess:
-            raise RuntimeError("SpgwInitPhase1() error " + str(reterr))
+        cdef uint32_t prev_variant_ct
+        cdef PglErr reterr
+        if append:
+            reterr = SpgwInitPhase1Append(fname, NULL, self._nonref_flags, variant_ct, sample_ct, 0, phase_dosage_gflags, nonref_flags_storage, self._state_ptr, &alloc_cacheline_ct, &max_vrec_len, &prev_variant_ct)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("SpgwInitPhase1Append() error " + str(reterr))
+        else:
+            reterr = SpgwInitPhase1(fname, NULL, self._nonref_flags, variant_ct, sample_ct, 0, phase_dosage_gflags, nonref_flags_storage, self._state_ptr, &alloc_cacheline_ct, &max_vrec_len)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("SpgwInitPhase1() error " + str(reterr))
         cdef uint32_t genovec_cacheline_ct = DivUp(sample_ct, kNypsPerCacheline)
         cdef uint32_t dosage_main_cacheline_ct = DivUp(sample_ct, (2 * kInt32PerCacheline))
         cdef unsigned char* spgw_alloc
         if cachealigned_malloc((alloc_cacheline_ct + genovec_cacheline_ct + 3 * bitvec_cacheline_ct + dosage_main_cacheline_ct) * kCacheline, &spgw_alloc):
             raise MemoryError()
-        SpgwInitPhase2(max_vrec_len, self._state_ptr, spgw_alloc)
+        if append:
+            reterr = SpgwInitPhase2Append(max_vrec_len, self._state_ptr, spgw_alloc)
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("SpgwInitPhase2Append() error " + str(reterr))
+        else:
+            SpgwInitPhase2(max_vrec_len, self._state_ptr, spgw_alloc)
         self._genovec = <uintptr_t*>(&(spgw_alloc[alloc_cacheline_ct * kCacheline]))
         self._phasepresent = <uintptr_t*>(&(spgw_alloc[(alloc_cacheline_ct + genovec_cacheline_ct) * kCacheline]))
         self._phaseinfo = <uintptr_t*>(&(spgw_alloc[(alloc_cacheline_ct + genovec_cacheline_ct + bitvec_cacheline_ct) * kCacheline]))
@@ -10,12 +10,14 @@ ext_modules = [
     Extension('pgenlib',
               sources = ['pgenlib.pyx', '../pgenlib_ffi_support.cc', '../include/pgenlib_misc.cc', '../include/pgenlib_read.cc', '../include/pgenlib_write.cc', '../include/plink2_base.cc', '../include/plink2_bits.cc'],
               language = "c++",
+              # zstd-compressed (mode 0x12) .pgen files are not supported here
+              define_macros = [('NO_PGEN_ZSTD', None)],
               # do not compile as c++11, since cython doesn't yet support
               # overload of uint32_t operator
               # extra_compile_args = ["-std=c++11", "-Wno-unused-function"],
               # extra_link_args = ["-std=c++11"],
               extra_compile_args = ["-std=c++98", "-Wno-unused-function", "-Wno-macro-redefined"],
-              extra_link_args = ["-std=c++98"],
+              extra_link_args = ["-std=c++98", "-lpthread"],
               include_dirs = [np.get_include()]
               )
     ]
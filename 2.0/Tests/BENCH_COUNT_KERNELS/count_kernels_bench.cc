@@ -0,0 +1,161 @@
+// Microbenchmark for the genovec counting kernels (GenoarrCountFreqsUnsafe(),
+// GenoarrCountSubsetFreqs(), CountNyp(), PopcountWords()).  Build it once per
+// instruction-set tier with run_bench.sh and compare the ns/call columns.
+// Every kernel result is also checked against a naive per-sample loop.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../include/pgenlib_misc.h"
+
+#ifdef __cplusplus
+namespace plink2 {
+#endif
+
+// not exported by pgenlib_read.h
+uint32_t CountNyp(const void* nyparr, uintptr_t nyp_word, uint32_t nyp_ct);
+
+#ifdef __cplusplus
+}  // namespace plink2
+#endif
+
+static uint64_t g_rng_state = 0x9e3779b97f4a7c15LLU;
+
+static uint64_t NextRand() {
+  // xorshift64*
+  g_rng_state ^= g_rng_state >> 12;
+  g_rng_state ^= g_rng_state << 25;
+  g_rng_state ^= g_rng_state >> 27;
+  return g_rng_state * 0x2545f4914f6cdd1dLLU;
+}
+
+static double NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(double, ts.tv_sec) * 1e9 + S_CAST(double, ts.tv_nsec);
+}
+
+int32_t main(int32_t argc, char** argv) {
+#ifdef __cplusplus
+  using namespace plink2;
+#endif
+  static const uint32_t kSampleCts[4] = {10000, 100000, 500000, 2000000};
+  const char* tier_str =
+#ifdef USE_AVX512
+    "avx512";
+#elif defined(USE_AVX2)
+    "avx2";
+#elif defined(USE_SSE42)
+    "sse4.2";
+#else
+    "sse2";
+#endif
+  // ~2 GiB of genotype bytes per (kernel, size) pair by default
+  double target_bytes = 2.0 * 1024 * 1024 * 1024;
+  if (argc > 1) {
+    target_bytes = atof(argv[1]) * 1024 * 1024;
+  }
+  uint32_t mismatch_ct = 0;
+  volatile uint64_t sink = 0;
+  printf("tier\tkernel\tsample_ct\tns_per_call\tGB_per_s\n");
+  for (uint32_t size_idx = 0; size_idx != 4; ++size_idx) {
+    const uint32_t raw_sample_ct = kSampleCts[size_idx];
+    const uint32_t raw_sample_ctl2 = NypCtToWordCt(raw_sample_ct);
+    const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+    uintptr_t* genovec;
+    uintptr_t* sample_include;
+    uintptr_t* interleaved_vec;
+    if (unlikely(
+            cachealigned_malloc(NypCtToVecCt(raw_sample_ct) * kBytesPerVec, &genovec) ||
+            cachealigned_malloc(BitCtToVecCt(raw_sample_ct) * kBytesPerVec, &sample_include) ||
+            cachealigned_malloc(BitCtToVecCt(raw_sample_ct) * kBytesPerVec, &interleaved_vec))) {
+      fputs("Out of memory.\n", stderr);
+      return 1;
+    }
+    // Realistic-ish genotype mix: mostly hom-ref, some het/hom-alt, ~1%
+    // missing.
+    STD_ARRAY_DECL(uint32_t, 4, naive_genocounts);
+    STD_ARRAY_DECL(uint32_t, 4, naive_subset_genocounts);
+    STD_ARRAY_FILL0(naive_genocounts);
+    STD_ARRAY_FILL0(naive_subset_genocounts);
+    ZeroWArr(NypCtToVecCt(raw_sample_ct) * kWordsPerVec, genovec);
+    ZeroWArr(BitCtToVecCt(raw_sample_ct) * kWordsPerVec, sample_include);
+    uint32_t sample_ct = 0;
+    for (uint32_t sample_idx = 0; sample_idx != raw_sample_ct; ++sample_idx) {
+      const uint32_t rr = NextRand() % 100;
+      uintptr_t geno = 0;
+      if (rr < 1) {
+        geno = 3;
+      } else if (rr < 21) {
+        geno = 1;
+      } else if (rr < 26) {
+        geno = 2;
+      }
+      genovec[sample_idx / kBitsPerWordD2] |= geno << (2 * (sample_idx % kBitsPerWordD2));
+      naive_genocounts[geno] += 1;
+      if (NextRand() & 1) {
+        SetBit(sample_idx, sample_include);
+        naive_subset_genocounts[geno] += 1;
+        ++sample_ct;
+      }
+    }
+    FillInterleavedMaskVec(sample_include, BitCtToVecCt(raw_sample_ct), interleaved_vec);
+    const double genovec_bytes = S_CAST(double, raw_sample_ctl2) * kBytesPerWord;
+    const uint32_t iter_ct = S_CAST(uint32_t, target_bytes / genovec_bytes) + 1;
+
+    STD_ARRAY_DECL(uint32_t, 4, genocounts);
+    GenoarrCountFreqsUnsafe(genovec, raw_sample_ct, genocounts);
+    for (uint32_t geno = 0; geno != 4; ++geno) {
+      mismatch_ct += (genocounts[geno] != naive_genocounts[geno]);
+    }
+    double start_ns = NowNs();
+    for (uint32_t iter_idx = 0; iter_idx != iter_ct; ++iter_idx) {
+      GenoarrCountFreqsUnsafe(genovec, raw_sample_ct, genocounts);
+      sink += genocounts[1];
+    }
+    double elapsed_ns = NowNs() - start_ns;
+    printf("%s\tGenoarrCountFreqsUnsafe\t%u\t%.1f\t%.2f\n", tier_str, raw_sample_ct, elapsed_ns / iter_ct, genovec_bytes * iter_ct / elapsed_ns);
+
+    GenoarrCountSubsetFreqs(genovec, interleaved_vec, raw_sample_ct, sample_ct, genocounts);
+    for (uint32_t geno = 0; geno != 4; ++geno) {
+      mismatch_ct += (genocounts[geno] != naive_subset_genocounts[geno]);
+    }
+    start_ns = NowNs();
+    for (uint32_t iter_idx = 0; iter_idx != iter_ct; ++iter_idx) {
+      GenoarrCountSubsetFreqs(genovec, interleaved_vec, raw_sample_ct, sample_ct, genocounts);
+      sink += genocounts[1];
+    }
+    elapsed_ns = NowNs() - start_ns;
+    printf("%s\tGenoarrCountSubsetFreqs\t%u\t%.1f\t%.2f\n", tier_str, raw_sample_ct, elapsed_ns / iter_ct, genovec_bytes * iter_ct / elapsed_ns);
+
+    // CountNyp(..., kMask5555, ...) counts hets.
+    mismatch_ct += (CountNyp(genovec, kMask5555, raw_sample_ct) != naive_genocounts[1]);
+    start_ns = NowNs();
+    for (uint32_t iter_idx = 0; iter_idx != iter_ct; ++iter_idx) {
+      sink += CountNyp(genovec, kMask5555, raw_sample_ct);
+    }
+    elapsed_ns = NowNs() - start_ns;
+    printf("%s\tCountNyp\t%u\t%.1f\t%.2f\n", tier_str, raw_sample_ct, elapsed_ns / iter_ct, genovec_bytes * iter_ct / elapsed_ns);
+
+    // PopcountWords() over a sample_include-sized bitarray; scale the
+    // iteration count so the byte volume matches the genovec kernels.
+    mismatch_ct += (PopcountWords(sample_include, raw_sample_ctl) != sample_ct);
+    const uint32_t popcount_iter_ct = iter_ct * 2;
+    start_ns = NowNs();
+    for (uint32_t iter_idx = 0; iter_idx != popcount_iter_ct; ++iter_idx) {
+      sink += PopcountWords(sample_include, raw_sample_ctl);
+    }
+    elapsed_ns = NowNs() - start_ns;
+    printf("%s\tPopcountWords\t%u\t%.1f\t%.2f\n", tier_str, raw_sample_ct, elapsed_ns / popcount_iter_ct, S_CAST(double, raw_sample_ctl) * kBytesPerWord * popcount_iter_ct / elapsed_ns);
+
+    aligned_free(interleaved_vec);
+    aligned_free(sample_include);
+    aligned_free(genovec);
+  }
+  if (mismatch_ct) {
+    fprintf(stderr, "Error: %u kernel result(s) disagree with naive counts.\n", mismatch_ct);
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,15 @@
+#!/bin/bash
+
+# Usage: ./run_bench.sh {optional MiB of genotype data per kernel/size pair}
+# Builds count_kernels_bench once per instruction-set tier supported by this
+# machine, then prints a combined table.  Exits nonzero if any tier's kernel
+# results disagree with the naive counts.
+
+set -eo pipefail
+
+. ../bench_build.sh
+CXXFLAGS="$CXXFLAGS -DNO_PGEN_ZSTD"
+
+bench_detect_tiers avx512
+bench_build_tiers count_kernels_bench count_kernels_bench.cc $PGENLIB_READ_SRC
+bench_run_tiers count_kernels_bench $1
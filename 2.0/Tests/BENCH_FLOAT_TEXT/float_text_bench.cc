@@ -0,0 +1,365 @@
+// Floating-point text conversion microbenchmark.  Parsing: ScanadvDouble()
+// (Clinger fast path + Eisel-Lemire, correctly rounded) against the previous
+// approximate ScanadvDouble() and strtod().  Formatting: dtoa_g() (6
+// significant digits) and dtoa_r() (shortest round-trip) against
+// snprintf("%.17g").  Inputs mimic --glm/--freq/--make-king-table output
+// columns.  Every parse is checked against strtod(), and every dtoa_r() string
+// is checked to parse back to the original double.
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/plink2_string.h"
+
+#ifdef __cplusplus
+using namespace plink2;
+#endif
+
+static uint64_t g_rng_state = 0x9e3779b97f4a7c15LLU;
+
+static uint64_t NextRand() {
+  // xorshift64*
+  g_rng_state ^= g_rng_state >> 12;
+  g_rng_state ^= g_rng_state << 25;
+  g_rng_state ^= g_rng_state >> 27;
+  return g_rng_state * 0x2545f4914f6cdd1dLLU;
+}
+
+static double NextUnif() {
+  return S_CAST(double, NextRand() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(double, ts.tv_sec) * 1e9 + S_CAST(double, ts.tv_nsec);
+}
+
+// ScanadvDouble() as it was before the Eisel-Lemire rewrite (64-bit path).
+static const double kLegacyPositivePow10[] = {1, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15};
+static const double kLegacyPositivePowTen16[] = {1, 1.0e16, 1.0e32, 1.0e48, 1.0e64, 1.0e80, 1.0e96, 1.0e112, 1.0e128, 1.0e144, 1.0e160, 1.0e176, 1.0e192, 1.0e208, 1.0e224, 1.0e240};
+static const double kLegacyNegativePow10[] = {1, 1.0e-1, 1.0e-2, 1.0e-3, 1.0e-4, 1.0e-5, 1.0e-6, 1.0e-7, 1.0e-8, 1.0e-9, 1.0e-10, 1.0e-11, 1.0e-12, 1.0e-13, 1.0e-14, 1.0e-15};
+static const double kLegacyNegativePowTen16[] = {1, 1.0e-16, 1.0e-32, 1.0e-48, 1.0e-64, 1.0e-80, 1.0e-96, 1.0e-112};
+
+static const char* ScanadvDoubleLegacy(const char* str_iter, double* valp) {
+  // requires first character to be nonspace (to succeed; it fails without
+  //   segfaulting on space/eoln/null)
+  // don't care about hexadecimal
+  // ok to lose last ~2 bits of precision
+  // ok if behavior undefined on >1GB strings in 32-bit case, >2GB for 64-bit
+  // fail on nan/infinity/overflow instead of usual strtod behavior
+  uint32_t cur_char_code = ctou32(*str_iter);
+  const uint32_t is_negative = (cur_char_code == 45);
+  if (is_negative || (cur_char_code == 43)) {
+    cur_char_code = ctou32(*(++str_iter));
+  }
+  uint32_t cur_digit = cur_char_code - 48;
+  intptr_t e10 = 0;
+  const char* dot_ptr;
+  int64_t digits;
+  if (cur_digit < 10) {
+    // ok, we have at least one digit
+    digits = cur_digit;
+    // to check: best to skip leading zeroes and compare against 17 instead of
+    // 10^16?
+    do {
+      cur_digit = ctou32(*(++str_iter)) - 48;
+      if (cur_digit >= 10) {
+        if (cur_digit == 0xfffffffeU) {
+          dot_ptr = str_iter;
+          goto ScanadvDouble_parse_decimal;
+        }
+        goto ScanadvDouble_parse_exponent;
+      }
+      digits = digits * 10 + cur_digit;
+    } while (digits < 10000000000000000LL);
+    // we have 17 significant digits; count the rest, but don't worry about
+    // contents
+    // (could keep ~19 instead, but if we're systematically losing the last two
+    // bits of precision anyway...)
+    const char* last_sig_fig_ptr = str_iter;
+    do {
+      cur_digit = ctou32(*(++str_iter)) - 48;
+    } while (cur_digit < 10);
+    e10 = S_CAST(intptr_t, str_iter - last_sig_fig_ptr) - 1;
+    if (cur_digit == 0xfffffffeU) {
+      do {
+        cur_digit = ctou32(*(++str_iter)) - 48;
+      } while (cur_digit < 10);
+    }
+    goto ScanadvDouble_parse_exponent;
+  }
+  if (cur_digit != 0xfffffffeU) {
+    return nullptr;
+  }
+  // first (nonsign) character is dot, verify we have a digit after it
+  dot_ptr = str_iter;
+  cur_digit = ctou32(*(++str_iter)) - 48;
+  if (cur_digit >= 10) {
+    return nullptr;
+  }
+  digits = cur_digit;
+ ScanadvDouble_parse_decimal:
+  while (1) {
+    cur_digit = ctou32(*(++str_iter)) - 48;
+    if (cur_digit >= 10) {
+      e10 = 1 - S_CAST(intptr_t, str_iter - dot_ptr);
+      break;
+    }
+    digits = digits * 10 + cur_digit;
+    if (digits >= 10000000000000000LL) {
+      e10 = -S_CAST(intptr_t, str_iter - dot_ptr);
+      do {
+        cur_digit = ctou32(*(++str_iter)) - 48;
+      } while (cur_digit < 10);
+      break;
+    }
+  }
+ ScanadvDouble_parse_exponent:
+  if ((cur_digit & 0xdf) == 21) { // 'E' - '0' is 21
+    cur_char_code = ctou32(*(++str_iter));
+    const uint32_t exp_is_negative = (cur_char_code == 45);
+    if (exp_is_negative || (cur_char_code == 43)) {
+      cur_char_code = ctou32(*(++str_iter));
+    }
+    cur_digit = cur_char_code - 48;
+    int32_t cur_exp = 0;
+    while (cur_digit < 10) {
+      if (cur_exp >= 214748364) {
+        // may as well guard against exponent overflow
+        if (!exp_is_negative) {
+          return nullptr;
+        }
+        *valp = 0;
+        do {
+          cur_digit = ctou32(*(++str_iter)) - 48;
+        } while (cur_digit < 10);
+        return str_iter;
+      }
+      cur_exp = cur_exp * 10 + cur_digit;
+      cur_digit = ctou32(*(++str_iter)) - 48;
+    }
+    if (exp_is_negative) {
+      cur_exp = -cur_exp;
+    }
+    e10 += cur_exp;
+  }
+  if (digits == 0) {
+    *valp = 0;
+    return str_iter;
+  }
+  if (is_negative) {
+    digits = -digits;
+  }
+  double dxx = S_CAST(double, digits);
+  if (e10) {
+    if (e10 < 0) {
+      uint32_t pos_exp = -e10;
+      dxx *= kLegacyNegativePow10[pos_exp & 15];
+      pos_exp /= 16;
+      if (pos_exp) {
+        dxx *= kLegacyNegativePowTen16[pos_exp & 7];
+        if (pos_exp > 7) {
+          if (pos_exp > 23) {
+            dxx = 0;
+          } else if (pos_exp > 15) {
+            dxx *= 1.0e-256;
+          } else {
+            dxx *= 1.0e-128;
+          }
+        }
+      }
+    } else {
+      uint32_t pos_exp = e10;
+      dxx *= kLegacyPositivePow10[pos_exp & 15];
+      pos_exp /= 16;
+      if (pos_exp) {
+        dxx *= kLegacyPositivePowTen16[pos_exp & 15];
+        if (pos_exp > 15) {
+          // overflow check
+          // last digits are "54" instead of "57" since that's the threshold
+          // beyond which multiply-by-1e256 overflows
+          if ((pos_exp > 31) || (dxx > 1.7976931348623154e52)) {
+            return nullptr;
+          }
+          dxx *= 1.0e256;
+        }
+      }
+    }
+  }
+  *valp = dxx;
+  return str_iter;
+}
+
+
+// Mix of report-column-like values: allele frequencies, p-values spanning
+// many orders of magnitude, regression coefficients and standard errors.
+static double NextReportValue(uint32_t idx) {
+  switch (idx % 4) {
+  case 0:
+    return NextUnif();
+  case 1:
+    return exp(-NextUnif() * 100);
+  case 2:
+    return (NextUnif() - 0.5) * 0.2;
+  }
+  return NextUnif() * 0.05;
+}
+
+enum {
+  kTextG,
+  kTextR,
+  kText17,
+  kTextCt
+};
+
+static const char* const kTextNames[kTextCt] = {
+  "6-digit",
+  "shortest",
+  "%.17g"
+};
+
+int32_t main(int32_t argc, char** argv) {
+  uint32_t value_ct = 1000000;
+  if (argc > 1) {
+    value_ct = atoi(argv[1]);
+  }
+  uint32_t rep_ct = 10;
+  if (argc > 2) {
+    rep_ct = atoi(argv[2]);
+  }
+  double* vals = S_CAST(double*, malloc(value_ct * sizeof(double)));
+  double* parsed = S_CAST(double*, malloc(value_ct * sizeof(double)));
+  // One newline-terminated text column per format.
+  char* texts[kTextCt];
+  for (uint32_t text_idx = 0; text_idx != kTextCt; ++text_idx) {
+    texts[text_idx] = S_CAST(char*, malloc(value_ct * (kMaxDoubleRSlen + 1) + 1));
+  }
+  if ((!vals) || (!parsed) || (!texts[kTextCt - 1])) {
+    fputs("Error: Out of memory.\n", stderr);
+    return 1;
+  }
+  for (uint32_t uii = 0; uii != value_ct; ++uii) {
+    vals[uii] = NextReportValue(uii);
+  }
+  uint32_t mismatch_ct = 0;
+  volatile uintptr_t sink = 0;
+  // bytes/value (formatting only) includes the newline.
+  printf("%-10s %-24s %10s %12s\n", "input", "routine", "ns/value", "bytes/value");
+
+  // Formatting.
+  for (uint32_t text_idx = 0; text_idx != kTextCt; ++text_idx) {
+    char* text = texts[text_idx];
+    double best_ns = 1e300;
+    uintptr_t text_blen = 0;
+    for (uint32_t rep_idx = 0; rep_idx != rep_ct; ++rep_idx) {
+      const double start_ns = NowNs();
+      char* write_iter = text;
+      if (text_idx == kTextG) {
+        for (uint32_t uii = 0; uii != value_ct; ++uii) {
+          write_iter = dtoa_g(vals[uii], write_iter);
+          *write_iter++ = '\n';
+        }
+      } else if (text_idx == kTextR) {
+        for (uint32_t uii = 0; uii != value_ct; ++uii) {
+          write_iter = dtoa_r(vals[uii], write_iter);
+          *write_iter++ = '\n';
+        }
+      } else {
+        for (uint32_t uii = 0; uii != value_ct; ++uii) {
+          write_iter += snprintf(write_iter, kMaxDoubleRSlen + 1, "%.17g", vals[uii]);
+          *write_iter++ = '\n';
+        }
+      }
+      *write_iter = '\0';
+      const double elapsed_ns = NowNs() - start_ns;
+      if (elapsed_ns < best_ns) {
+        best_ns = elapsed_ns;
+      }
+      text_blen = write_iter - text;
+      sink += text_blen;
+    }
+    const char* routine_name = (text_idx == kTextG)? "dtoa_g" : ((text_idx == kTextR)? "dtoa_r" : "snprintf(%.17g)");
+    printf("%-10s %-24s %10.2f %12.2f\n", "format", routine_name, best_ns / value_ct, S_CAST(double, text_blen) / value_ct);
+  }
+  {
+    // dtoa_r() output must round-trip.
+    const char* read_iter = texts[kTextR];
+    for (uint32_t uii = 0; uii != value_ct; ++uii) {
+      char* parse_end;
+      const double dxx = strtod(read_iter, &parse_end);
+      if (memcmp(&dxx, &(vals[uii]), sizeof(double))) {
+        if (mismatch_ct < 10) {
+          fprintf(stderr, "dtoa_r(%.17g) does not round-trip\n", vals[uii]);
+        }
+        ++mismatch_ct;
+      }
+      read_iter = &(parse_end[1]);
+    }
+  }
+
+  // Parsing.
+  for (uint32_t text_idx = 0; text_idx != kTextCt; ++text_idx) {
+    const char* text = texts[text_idx];
+    for (uint32_t routine_idx = 0; routine_idx != 3; ++routine_idx) {
+      double best_ns = 1e300;
+      for (uint32_t rep_idx = 0; rep_idx != rep_ct; ++rep_idx) {
+        const double start_ns = NowNs();
+        const char* read_iter = text;
+        if (routine_idx == 0) {
+          for (uint32_t uii = 0; uii != value_ct; ++uii) {
+            read_iter = &(ScanadvDouble(read_iter, &(parsed[uii]))[1]);
+          }
+        } else if (routine_idx == 1) {
+          for (uint32_t uii = 0; uii != value_ct; ++uii) {
+            read_iter = &(ScanadvDoubleLegacy(read_iter, &(parsed[uii]))[1]);
+          }
+        } else {
+          for (uint32_t uii = 0; uii != value_ct; ++uii) {
+            char* parse_end;
+            parsed[uii] = strtod(read_iter, &parse_end);
+            read_iter = &(parse_end[1]);
+          }
+        }
+        const double elapsed_ns = NowNs() - start_ns;
+        if (elapsed_ns < best_ns) {
+          best_ns = elapsed_ns;
+        }
+      }
+      // Correctly rounded results must match strtod(); the legacy parser is
+      // only required to be close.
+      const char* read_iter = text;
+      uint32_t inexact_ct = 0;
+      for (uint32_t uii = 0; uii != value_ct; ++uii) {
+        char* parse_end;
+        const double expected = strtod(read_iter, &parse_end);
+        read_iter = &(parse_end[1]);
+        if (memcmp(&expected, &(parsed[uii]), sizeof(double))) {
+          ++inexact_ct;
+          if ((routine_idx == 0) && (mismatch_ct < 10)) {
+            fprintf(stderr, "ScanadvDouble() mismatch on %.17g\n", expected);
+          }
+        }
+      }
+      if (routine_idx == 0) {
+        mismatch_ct += inexact_ct;
+      }
+      char routine_name[48];
+      snprintf(routine_name, 48, "%s (%u inexact)", (routine_idx == 0)? "ScanadvDouble" : ((routine_idx == 1)? "legacy" : "strtod"), inexact_ct);
+      printf("%-10s %-24s %10.2f\n", kTextNames[text_idx], routine_name, best_ns / value_ct);
+    }
+  }
+  for (uint32_t text_idx = 0; text_idx != kTextCt; ++text_idx) {
+    free(texts[text_idx]);
+  }
+  free(parsed);
+  free(vals);
+  if (mismatch_ct) {
+    fprintf(stderr, "%u mismatch(es).\n", mismatch_ct);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,15 @@
+#!/bin/bash
+
+# Usage: ./run_bench.sh {value count} {repetitions}
+# Builds float_text_bench and times floating-point formatting (dtoa_g(),
+# dtoa_r(), snprintf) and parsing (ScanadvDouble(), the previous approximate
+# ScanadvDouble(), strtod()) on report-column-like values, keeping the best of
+# the given number of repetitions.  Exits nonzero if any dtoa_r() string fails
+# to round-trip or any ScanadvDouble() result differs from strtod().
+
+set -eo pipefail
+
+. ../bench_build.sh
+
+bench_build float_text_bench "" float_text_bench.cc $STRING_SRC
+"$BENCH_BIN_DIR/float_text_bench" "$@"
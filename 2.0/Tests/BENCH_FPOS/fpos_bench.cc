@@ -0,0 +1,210 @@
+// Compares the flat var_fpos[] record-offset table with the compact
+// fpos_bases[]/vrec_lens[] representation (PgfiEnableCompactFpos()): bytes per variant, random-lookup cost, and sequential/random
+// PgrGet() throughput.  Every lookup and every decoded genovec is also checked
+// against the flat representation.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/pgenlib_read.h"
+
+static uint64_t g_rng_state = 0x9e3779b97f4a7c15LLU;
+
+static uint64_t NextRand() {
+  // xorshift64*
+  g_rng_state ^= g_rng_state >> 12;
+  g_rng_state ^= g_rng_state << 25;
+  g_rng_state ^= g_rng_state >> 27;
+  return g_rng_state * 0x2545f4914f6cdd1dLLU;
+}
+
+static double NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(double, ts.tv_sec) * 1e9 + S_CAST(double, ts.tv_nsec);
+}
+
+#ifdef __cplusplus
+using namespace plink2;
+#endif
+
+typedef struct BenchReaderStruct {
+  PgenFileInfo pgfi;
+  PgenReader pgr;
+  unsigned char* pgfi_alloc;
+  unsigned char* pgr_alloc;
+  uintptr_t pgfi_alloc_byte_ct;
+} BenchReader;
+
+static int32_t OpenBenchReader(const char* fname, uint32_t compact_fpos, BenchReader* brp) {
+  char errstr_buf[kPglErrstrBufBlen];
+  PreinitPgfi(&brp->pgfi);
+  PreinitPgr(&brp->pgr);
+  brp->pgfi_alloc = nullptr;
+  brp->pgr_alloc = nullptr;
+  PgenHeaderCtrl header_ctrl;
+  uintptr_t cacheline_ct;
+  if (PgfiInitPhase1(fname, UINT32_MAX, UINT32_MAX, 0, &header_ctrl, &brp->pgfi, &cacheline_ct, errstr_buf)) {
+    fputs(errstr_buf, stderr);
+    return 1;
+  }
+  if (compact_fpos) {
+    PgfiEnableCompactFpos(header_ctrl, &brp->pgfi, &cacheline_ct);
+  }
+  brp->pgfi_alloc_byte_ct = cacheline_ct * kCacheline;
+  if (cacheline_ct && cachealigned_malloc(brp->pgfi_alloc_byte_ct, &brp->pgfi_alloc)) {
+    fputs("Out of memory.\n", stderr);
+    return 1;
+  }
+  uint32_t max_vrec_width;
+  if (PgfiInitPhase2(header_ctrl, 0, 0, 0, 0, brp->pgfi.raw_variant_ct, &max_vrec_width, &brp->pgfi, brp->pgfi_alloc, &cacheline_ct, errstr_buf)) {
+    fputs(errstr_buf, stderr);
+    return 1;
+  }
+  if (cachealigned_malloc(cacheline_ct * kCacheline, &brp->pgr_alloc)) {
+    fputs("Out of memory.\n", stderr);
+    return 1;
+  }
+  if (PgrInit(fname, max_vrec_width, &brp->pgfi, &brp->pgr, brp->pgr_alloc)) {
+    fprintf(stderr, "Error: PgrInit() failed on %s.\n", fname);
+    return 1;
+  }
+  return 0;
+}
+
+static void CloseBenchReader(BenchReader* brp) {
+  PglErr reterr = kPglRetSuccess;
+  CleanupPgr(&brp->pgr, &reterr);
+  CleanupPgfi(&brp->pgfi, &reterr);
+  aligned_free_cond(brp->pgr_alloc);
+  aligned_free_cond(brp->pgfi_alloc);
+}
+
+// Table bytes that persist after phase 2 (i.e. excluding the compact mode's
+// decode buffer, and excluding vrtypes[], which is common to both).
+static uint64_t FposTableByteCt(const PgenFileInfo* pgfip) {
+  const uint64_t variant_ct = pgfip->raw_variant_ct;
+  if (pgfip->var_fpos) {
+    return (variant_ct + 1) * sizeof(int64_t);
+  }
+  return (variant_ct / kPglFposBlockSize + 1) * sizeof(int64_t) + variant_ct * pgfip->vrec_len_byte_ct;
+}
+
+static int32_t RunBench(const char* fname, uint32_t lookup_ct, uint32_t read_ct) {
+  BenchReader flat;
+  BenchReader compact;
+  if (OpenBenchReader(fname, 0, &flat) || OpenBenchReader(fname, 1, &compact)) {
+    return 1;
+  }
+  int32_t retval = 0;
+  const uint32_t variant_ct = flat.pgfi.raw_variant_ct;
+  const uint32_t sample_ct = flat.pgfi.raw_sample_ct;
+  uintptr_t* genovec_flat = nullptr;
+  uintptr_t* genovec_compact = nullptr;
+  uint32_t* vidxs = nullptr;
+  if (cachealigned_malloc(NypCtToVecCt(sample_ct) * kBytesPerVec, &genovec_flat) ||
+      cachealigned_malloc(NypCtToVecCt(sample_ct) * kBytesPerVec, &genovec_compact) ||
+      cachealigned_malloc(S_CAST(uintptr_t, lookup_ct) * sizeof(int32_t), &vidxs)) {
+    fputs("Out of memory.\n", stderr);
+    retval = 1;
+    goto RunBench_ret;
+  }
+  {
+    if (flat.pgfi.const_vrec_width) {
+      fprintf(stderr, "Error: %s has fixed-width variant records; no offset table to compare.\n", fname);
+      retval = 1;
+      goto RunBench_ret;
+    }
+    uint32_t mismatch_ct = 0;
+    for (uint32_t vidx = 0; vidx <= variant_ct; ++vidx) {
+      mismatch_ct += (GetPgfiFpos(&flat.pgfi, vidx) != GetPgfiFpos(&compact.pgfi, vidx));
+    }
+    for (uint32_t uii = 0; uii != lookup_ct; ++uii) {
+      vidxs[uii] = NextRand() % variant_ct;
+    }
+    volatile uint64_t sink = 0;
+    double lookup_ns[2];
+    for (uint32_t mode_idx = 0; mode_idx != 2; ++mode_idx) {
+      const PgenFileInfo* pgfip = mode_idx? (&compact.pgfi) : (&flat.pgfi);
+      uint64_t fpos_sum = 0;
+      const double start_ns = NowNs();
+      for (uint32_t uii = 0; uii != lookup_ct; ++uii) {
+        fpos_sum += GetPgfiFpos(pgfip, vidxs[uii]);
+      }
+      lookup_ns[mode_idx] = (NowNs() - start_ns) / lookup_ct;
+      sink += fpos_sum;
+    }
+
+    PgrSampleSubsetIndex pssi;
+    PgrClearSampleSubsetIndex(&flat.pgr, &pssi);
+    double seq_ns[2];
+    double rand_ns[2];
+    for (uint32_t mode_idx = 0; mode_idx != 2; ++mode_idx) {
+      BenchReader* brp = mode_idx? (&compact) : (&flat);
+      uintptr_t* genovec = mode_idx? genovec_compact : genovec_flat;
+      const uint32_t seq_ct = MINV(read_ct, variant_ct);
+      double start_ns = NowNs();
+      for (uint32_t vidx = 0; vidx != seq_ct; ++vidx) {
+        if (PgrGet(nullptr, pssi, sample_ct, vidx, &brp->pgr, genovec)) {
+          fputs("Error: PgrGet() failed.\n", stderr);
+          retval = 1;
+          goto RunBench_ret;
+        }
+      }
+      seq_ns[mode_idx] = (NowNs() - start_ns) / seq_ct;
+      start_ns = NowNs();
+      for (uint32_t uii = 0; uii != read_ct; ++uii) {
+        if (PgrGet(nullptr, pssi, sample_ct, vidxs[uii % lookup_ct], &brp->pgr, genovec)) {
+          fputs("Error: PgrGet() failed.\n", stderr);
+          retval = 1;
+          goto RunBench_ret;
+        }
+      }
+      rand_ns[mode_idx] = (NowNs() - start_ns) / read_ct;
+    }
+    // Correctness pass over every variant, interleaving sequential and random
+    // access so the compact reader's fpos cache is exercised both ways.
+    for (uint32_t vidx = 0; vidx != variant_ct; ++vidx) {
+      const uint32_t cur_vidx = (vidx & 1)? vidxs[vidx % lookup_ct] : vidx;
+      if (PgrGet(nullptr, pssi, sample_ct, cur_vidx, &flat.pgr, genovec_flat) ||
+          PgrGet(nullptr, pssi, sample_ct, cur_vidx, &compact.pgr, genovec_compact)) {
+        fputs("Error: PgrGet() failed.\n", stderr);
+        retval = 1;
+        goto RunBench_ret;
+      }
+      ZeroTrailingNyps(sample_ct, genovec_flat);
+      ZeroTrailingNyps(sample_ct, genovec_compact);
+      mismatch_ct += !memequal(genovec_flat, genovec_compact, NypCtToByteCt(sample_ct));
+    }
+    printf("mode\tbytes_per_variant\tlookup_ns\tseq_get_ns\trand_get_ns\n");
+    printf("flat\t%.2f\t%.1f\t%.1f\t%.1f\n", S_CAST(double, FposTableByteCt(&flat.pgfi)) / variant_ct, lookup_ns[0], seq_ns[0], rand_ns[0]);
+    printf("compact%u\t%.2f\t%.1f\t%.1f\t%.1f\n", compact.pgfi.vrec_len_byte_ct, S_CAST(double, FposTableByteCt(&compact.pgfi)) / variant_ct, lookup_ns[1], seq_ns[1], rand_ns[1]);
+    if (mismatch_ct) {
+      fprintf(stderr, "Error: %u compact-fpos result(s) disagree with the flat table.\n", mismatch_ct);
+      retval = 2;
+    }
+  }
+ RunBench_ret:
+  aligned_free_cond(vidxs);
+  aligned_free_cond(genovec_compact);
+  aligned_free_cond(genovec_flat);
+  CloseBenchReader(&compact);
+  CloseBenchReader(&flat);
+  return retval;
+}
+
+int32_t main(int32_t argc, char** argv) {
+  if ((argc < 2) || (argc > 4)) {
+    fputs("Usage: fpos_bench [.pgen filename] {random lookup count} {PgrGet() count}\n", stderr);
+    return 1;
+  }
+  const uint32_t lookup_ct = (argc > 2)? strtoul(argv[2], nullptr, 10) : 10000000;
+  const uint32_t read_ct = (argc > 3)? strtoul(argv[3], nullptr, 10) : 100000;
+  if ((!lookup_ct) || (!read_ct)) {
+    fputs("Error: Counts must be positive.\n", stderr);
+    return 1;
+  }
+  return RunBench(argv[1], lookup_ct, read_ct);
+}
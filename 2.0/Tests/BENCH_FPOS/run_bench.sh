@@ -0,0 +1,15 @@
+#!/bin/bash
+
+# Usage: ./run_bench.sh [.pgen filename] {random lookup count} {PgrGet() count}
+# Builds fpos_bench, then compares the flat and compact
+# (PgfiEnableCompactFpos()) record-offset tables on the given variable-width
+# .pgen.  Exits nonzero if any compact-mode lookup or decoded variant disagrees
+# with the flat table.
+
+set -eo pipefail
+
+. ../bench_build.sh
+CXXFLAGS="$CXXFLAGS -DNO_PGEN_ZSTD"
+
+bench_build fpos_bench "" fpos_bench.cc $PGENLIB_READ_SRC
+"$BENCH_BIN_DIR/fpos_bench" "$@"
@@ -0,0 +1,257 @@
+// Measures the multi-candidate LD-base search (SpgwEnableLdSearch()): writes
+// the same synthetic genotype matrix with the search disabled and with each
+// requested window size, then reports .pgen size, write time, and sequential
+// PgrGet() throughput.  Every variant is read back and compared against the
+// source matrix.
+//
+// The synthetic data has gradually-decaying LD: each variant is drawn from one
+// of cluster_ct independent lineages (chosen at random), and each lineage
+// drifts by resampling ~noise_per_10k/10000 of its genotypes every time it's
+// used.  With the default single lineage, LD between variants i and j decays
+// with |i - j|, which is the case where the greedy base choice keeps each LD
+// base for too long.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/pgenlib_read.h"
+#include "../../include/pgenlib_write.h"
+
+static uint64_t g_rng_state = 0x9e3779b97f4a7c15LLU;
+
+static uint64_t NextRand() {
+  // xorshift64*
+  g_rng_state ^= g_rng_state >> 12;
+  g_rng_state ^= g_rng_state << 25;
+  g_rng_state ^= g_rng_state >> 27;
+  return g_rng_state * 0x2545f4914f6cdd1dLLU;
+}
+
+static double NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(double, ts.tv_sec) * 1e9 + S_CAST(double, ts.tv_nsec);
+}
+
+#ifdef __cplusplus
+using namespace plink2;
+#endif
+
+// Returns 0 on success.
+static int32_t GenerateMatrix(uint32_t sample_ct, uint32_t variant_ct, uint32_t cluster_ct, uint32_t noise_per_10k, uintptr_t* genomat) {
+  const uintptr_t genovec_word_ct = NypCtToVecCt(sample_ct) * kWordsPerVec;
+  uintptr_t* cluster_genovecs;
+  if (cachealigned_malloc(cluster_ct * genovec_word_ct * sizeof(intptr_t), &cluster_genovecs)) {
+    return 1;
+  }
+  for (uint32_t cluster_idx = 0; cluster_idx != cluster_ct; ++cluster_idx) {
+    uintptr_t* cur_genovec = &(cluster_genovecs[cluster_idx * genovec_word_ct]);
+    // allele frequency between 0.05 and 0.5
+    const uint32_t af_per_1k = 50 + (NextRand() % 451);
+    ZeroWArr(genovec_word_ct, cur_genovec);
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      const uint64_t rand_val = NextRand();
+      const uintptr_t geno = ((rand_val % 1000) < af_per_1k) + (((rand_val >> 20) % 1000) < af_per_1k);
+      cur_genovec[sample_idx / kBitsPerWordD2] |= geno << (2 * (sample_idx % kBitsPerWordD2));
+    }
+  }
+  for (uint32_t vidx = 0; vidx != variant_ct; ++vidx) {
+    uintptr_t* lineage_genovec = &(cluster_genovecs[(NextRand() % cluster_ct) * genovec_word_ct]);
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      if ((NextRand() % 10000) < noise_per_10k) {
+        const uint32_t bit_shift = 2 * (sample_idx % kBitsPerWordD2);
+        uintptr_t* wordp = &(lineage_genovec[sample_idx / kBitsPerWordD2]);
+        *wordp = ((*wordp) & (~((3 * k1LU) << bit_shift))) | ((NextRand() % 3) << bit_shift);
+      }
+    }
+    memcpy(&(genomat[vidx * genovec_word_ct]), lineage_genovec, genovec_word_ct * sizeof(intptr_t));
+  }
+  aligned_free(cluster_genovecs);
+  return 0;
+}
+
+static int32_t WritePgen(const char* fname, const uintptr_t* genomat, uint32_t sample_ct, uint32_t variant_ct, uint32_t window_max, double* write_ns_ptr) {
+  const uintptr_t genovec_word_ct = NypCtToVecCt(sample_ct) * kWordsPerVec;
+  STPgenWriter spgw;
+  PreinitSpgw(&spgw);
+  unsigned char* spgw_alloc = nullptr;
+  unsigned char* ld_search_alloc = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  const double start_ns = NowNs();
+  {
+    uintptr_t alloc_cacheline_ct;
+    uint32_t max_vrec_len;
+    reterr = SpgwInitPhase1(fname, nullptr, nullptr, variant_ct, sample_ct, 0, kfPgenGlobal0, 2, &spgw, &alloc_cacheline_ct, &max_vrec_len);
+    if (reterr) {
+      fprintf(stderr, "Error: Failed to open %s.\n", fname);
+      goto WritePgen_ret;
+    }
+    if (cachealigned_malloc(alloc_cacheline_ct * kCacheline, &spgw_alloc)) {
+      reterr = kPglRetNomem;
+      goto WritePgen_ret;
+    }
+    SpgwInitPhase2(max_vrec_len, &spgw, spgw_alloc);
+    if (window_max) {
+      if (cachealigned_malloc(PgenLdSearchCachelineCt(sample_ct, window_max) * kCacheline, &ld_search_alloc)) {
+        reterr = kPglRetNomem;
+        goto WritePgen_ret;
+      }
+      SpgwEnableLdSearch(window_max, ld_search_alloc, &spgw);
+    }
+    for (uint32_t vidx = 0; vidx != variant_ct; ++vidx) {
+      reterr = SpgwAppendBiallelicGenovec(&(genomat[vidx * genovec_word_ct]), &spgw);
+      if (reterr) {
+        goto WritePgen_ret;
+      }
+    }
+    reterr = SpgwFinish(&spgw);
+  }
+ WritePgen_ret:
+  *write_ns_ptr = NowNs() - start_ns;
+  CleanupSpgw(&spgw, &reterr);
+  aligned_free_cond(ld_search_alloc);
+  aligned_free_cond(spgw_alloc);
+  return (reterr != kPglRetSuccess);
+}
+
+// Reads every variant back, checking it against genomat.
+static int32_t ReadPgen(const char* fname, const uintptr_t* genomat, uint32_t sample_ct, uint32_t variant_ct, uint64_t* file_size_ptr, double* read_ns_ptr, uint32_t* mismatch_ct_ptr) {
+  char errstr_buf[kPglErrstrBufBlen];
+  const uintptr_t genovec_word_ct = NypCtToVecCt(sample_ct) * kWordsPerVec;
+  PgenFileInfo pgfi;
+  PgenReader pgr;
+  PreinitPgfi(&pgfi);
+  PreinitPgr(&pgr);
+  unsigned char* pgfi_alloc = nullptr;
+  unsigned char* pgr_alloc = nullptr;
+  uintptr_t* genovec = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  {
+    FILE* infile = fopen(fname, FOPEN_RB);
+    if ((!infile) || fseeko(infile, 0, SEEK_END)) {
+      fprintf(stderr, "Error: Failed to open %s.\n", fname);
+      reterr = kPglRetOpenFail;
+      goto ReadPgen_ret;
+    }
+    *file_size_ptr = ftello(infile);
+    fclose(infile);
+    PgenHeaderCtrl header_ctrl;
+    uintptr_t cacheline_ct;
+    reterr = PgfiInitPhase1(fname, variant_ct, sample_ct, 0, &header_ctrl, &pgfi, &cacheline_ct, errstr_buf);
+    if (reterr) {
+      fputs(errstr_buf, stderr);
+      goto ReadPgen_ret;
+    }
+    if (cacheline_ct && cachealigned_malloc(cacheline_ct * kCacheline, &pgfi_alloc)) {
+      reterr = kPglRetNomem;
+      goto ReadPgen_ret;
+    }
+    uint32_t max_vrec_width;
+    reterr = PgfiInitPhase2(header_ctrl, 0, 0, 0, 0, variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &cacheline_ct, errstr_buf);
+    if (reterr) {
+      fputs(errstr_buf, stderr);
+      goto ReadPgen_ret;
+    }
+    if (cachealigned_malloc(cacheline_ct * kCacheline, &pgr_alloc) ||
+        cachealigned_malloc(genovec_word_ct * sizeof(intptr_t), &genovec)) {
+      reterr = kPglRetNomem;
+      goto ReadPgen_ret;
+    }
+    reterr = PgrInit(fname, max_vrec_width, &pgfi, &pgr, pgr_alloc);
+    if (reterr) {
+      fprintf(stderr, "Error: PgrInit() failed on %s.\n", fname);
+      goto ReadPgen_ret;
+    }
+    PgrSampleSubsetIndex pssi;
+    PgrClearSampleSubsetIndex(&pgr, &pssi);
+    uint32_t mismatch_ct = 0;
+    const double start_ns = NowNs();
+    for (uint32_t vidx = 0; vidx != variant_ct; ++vidx) {
+      reterr = PgrGet(nullptr, pssi, sample_ct, vidx, &pgr, genovec);
+      if (reterr) {
+        fputs("Error: PgrGet() failed.\n", stderr);
+        goto ReadPgen_ret;
+      }
+      ZeroTrailingNyps(sample_ct, genovec);
+      mismatch_ct += !memequal(genovec, &(genomat[vidx * genovec_word_ct]), NypCtToByteCt(sample_ct));
+    }
+    *read_ns_ptr = NowNs() - start_ns;
+    *mismatch_ct_ptr = mismatch_ct;
+  }
+ ReadPgen_ret:
+  CleanupPgr(&pgr, &reterr);
+  CleanupPgfi(&pgfi, &reterr);
+  aligned_free_cond(genovec);
+  aligned_free_cond(pgr_alloc);
+  aligned_free_cond(pgfi_alloc);
+  return (reterr != kPglRetSuccess);
+}
+
+int32_t main(int32_t argc, char** argv) {
+  if (argc < 3) {
+    fputs("Usage: ld_search_bench [sample ct] [variant ct] {cluster ct} {noise per 10k} {window sizes...}\n", stderr);
+    return 1;
+  }
+  const uint32_t sample_ct = strtoul(argv[1], nullptr, 10);
+  const uint32_t variant_ct = strtoul(argv[2], nullptr, 10);
+  const uint32_t cluster_ct = (argc > 3)? strtoul(argv[3], nullptr, 10) : 1;
+  const uint32_t noise_per_10k = (argc > 4)? strtoul(argv[4], nullptr, 10) : 100;
+  if ((!sample_ct) || (!variant_ct) || (!cluster_ct)) {
+    fputs("Error: Counts must be positive.\n", stderr);
+    return 1;
+  }
+  uint32_t window_maxes[16];
+  uint32_t window_size_ct = 1;
+  window_maxes[0] = 0;
+  for (int32_t argn = 5; (argn < argc) && (window_size_ct != 16); ++argn) {
+    window_maxes[window_size_ct++] = strtoul(argv[argn], nullptr, 10);
+  }
+  if (window_size_ct == 1) {
+    window_maxes[window_size_ct++] = 4;
+    window_maxes[window_size_ct++] = 8;
+    window_maxes[window_size_ct++] = 16;
+  }
+  const uintptr_t genovec_word_ct = NypCtToVecCt(sample_ct) * kWordsPerVec;
+  uintptr_t* genomat;
+  if (cachealigned_malloc(S_CAST(uint64_t, variant_ct) * genovec_word_ct * sizeof(intptr_t), &genomat)) {
+    fputs("Out of memory.\n", stderr);
+    return 1;
+  }
+  int32_t retval = 0;
+  if (GenerateMatrix(sample_ct, variant_ct, cluster_ct, noise_per_10k, genomat)) {
+    fputs("Out of memory.\n", stderr);
+    retval = 1;
+    goto main_ret;
+  }
+  printf("window\tfile_bytes\tsize_vs_off\twrite_ms\tseq_get_ns\n");
+  {
+    uint64_t base_file_size = 0;
+    for (uint32_t uii = 0; uii != window_size_ct; ++uii) {
+      const uint32_t window_max = window_maxes[uii];
+      char fname[64];
+      snprintf(fname, 64, "ld_search_bench_w%u.pgen", window_max);
+      double write_ns;
+      double read_ns = 0.0;
+      uint64_t file_size = 0;
+      uint32_t mismatch_ct = 0;
+      if (WritePgen(fname, genomat, sample_ct, variant_ct, window_max, &write_ns) ||
+          ReadPgen(fname, genomat, sample_ct, variant_ct, &file_size, &read_ns, &mismatch_ct)) {
+        retval = 1;
+        goto main_ret;
+      }
+      if (!uii) {
+        base_file_size = file_size;
+      }
+      printf("%u\t%" PRIu64 "\t%.4f\t%.1f\t%.1f\n", window_max, file_size, S_CAST(double, file_size) / S_CAST(double, base_file_size), write_ns * 1e-6, read_ns / variant_ct);
+      if (mismatch_ct) {
+        fprintf(stderr, "Error: %u variant(s) read back from %s disagree with the source.\n", mismatch_ct, fname);
+        retval = 2;
+      }
+    }
+  }
+ main_ret:
+  aligned_free(genomat);
+  return retval;
+}
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Usage: ./run_bench.sh {sample ct} {variant ct} {cluster ct} {noise per 10k}
+#   {window sizes...}
+# Builds ld_search_bench, then writes the same synthetic decaying-LD genotype
+# matrix with the multi-candidate LD-base search off and with each window
+# size, reporting .pgen size, write time, and sequential read speed.
+# Exits nonzero if any written file fails to round-trip.
+
+set -eo pipefail
+
+. ../bench_build.sh
+CXXFLAGS="$CXXFLAGS -DNO_PGEN_ZSTD"
+
+bench_build ld_search_bench "" ld_search_bench.cc $PGENLIB_READ_SRC ../../include/pgenlib_write.cc
+if [[ $# -lt 2 ]]; then
+    "$BENCH_BIN_DIR/ld_search_bench" 10000 100000 "$@"
+else
+    "$BENCH_BIN_DIR/ld_search_bench" "$@"
+fi
+rm -f ld_search_bench_w*.pgen
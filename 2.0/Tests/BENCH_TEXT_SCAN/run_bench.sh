@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# Usage: ./run_bench.sh [plink2 build dir] {variant count} {MiB per case}
+# Generates a synthetic dataset (200000 variants, 100 samples by default),
+# exports it as .pvar and VCF, then builds text_scan_bench once per
+# instruction-set tier supported by this machine and runs it on both files.
+# .pvar lines skip to ALT (3 columns), VCF lines to the first genotype (9
+# columns).  Exits nonzero if any mask-based scan result disagrees with the
+# pointer-walking scanners.
+
+set -eo pipefail
+
+PLINK2="$1/plink2"
+VARIANT_CT=${2:-200000}
+MIB=$3
+
+. ../bench_build.sh
+
+$PLINK2 --dummy 100 $VARIANT_CT --out tmp_data > /dev/null
+$PLINK2 --pfile tmp_data --export vcf --out tmp_data > /dev/null
+ls -l tmp_data.pvar tmp_data.vcf
+
+bench_detect_tiers
+bench_build_tiers text_scan_bench text_scan_bench.cc $STRING_SRC
+
+for case in "pvar 3" "vcf 9"; do
+    read ext skip_ct <<< "$case"
+    echo "== tmp_data.$ext (skip $skip_ct)"
+    bench_run_tiers text_scan_bench tmp_data.$ext $skip_ct $MIB
+done
+
+rm -f tmp_*
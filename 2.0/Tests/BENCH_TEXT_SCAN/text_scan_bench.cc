@@ -0,0 +1,264 @@
+// Text-scanning microbenchmark: line splitting, column skipping, and token
+// counting on real .pvar/VCF lines, comparing the pointer-walking scanners
+// (rawmemchr, NextTokenMult(), AdvToNthDelim(), CountTokens()) with the
+// ClassifyTextBytes() bitmask kernels and their Mask...() helpers.  Build it
+// once per instruction-set tier with run_bench.sh and compare the GB/s
+// columns.  Every mask-based result is also checked line-by-line against the
+// pointer-walking one.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/plink2_string.h"
+
+#ifdef __cplusplus
+using namespace plink2;
+#endif
+
+static double NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(double, ts.tv_sec) * 1e9 + S_CAST(double, ts.tv_nsec);
+}
+
+// CountTokens() as it was before the movemask rewrite.
+static uint32_t CountTokensScalar(const char* str_iter) {
+  uint32_t token_ct = 0;
+  str_iter = FirstNonTspace(str_iter);
+  while (!IsEolnKns(*str_iter)) {
+    ++token_ct;
+    str_iter = FirstNonTspace(CurTokenEnd(str_iter));
+  }
+  return token_ct;
+}
+
+typedef struct TextMasksStruct {
+  uintptr_t* newline_bits;
+  uintptr_t* tab_bits;
+  uintptr_t* space_bits;
+  uintptr_t* token_start_bits;
+} TextMasks;
+
+// Returns the newline count, so the classification can't be optimized away.
+static uintptr_t Classify(const char* buf, uintptr_t byte_ct, TextMasks* masksp) {
+  ClassifyTextBytes(buf, byte_ct, masksp->newline_bits, masksp->tab_bits, masksp->space_bits, masksp->token_start_bits);
+  const uintptr_t word_ct = DivUp(byte_ct, kBitsPerWord);
+  uintptr_t line_ct = 0;
+  for (uintptr_t widx = 0; widx != word_ct; ++widx) {
+    line_ct += PopcountWord(masksp->newline_bits[widx]);
+  }
+  return line_ct;
+}
+
+enum {
+  kBenchLinesRawmemchr,
+  kBenchLinesMask,
+  kBenchSkipNextTokenMult,
+  kBenchSkipNextTokenMultFar,
+  kBenchSkipAdvToNthDelim,
+  kBenchSkipMaskToken,
+  kBenchSkipMaskTab,
+  kBenchCountScalar,
+  kBenchCountTokens,
+  kBenchCountMask,
+  kBenchCt
+};
+
+static const char* const kBenchNames[kBenchCt] = {
+  "lines/rawmemchr",
+  "lines/mask",
+  "skip/NextTokenMult",
+  "skip/NextTokenMultFar",
+  "skip/AdvToNthDelim",
+  "skip/mask-token",
+  "skip/mask-tab",
+  "count/scalar",
+  "count/CountTokens",
+  "count/mask"
+};
+
+// Returns a checksum; mask-based cases include the ClassifyTextBytes() pass.
+static uintptr_t RunOnce(uint32_t bench_idx, const char* buf, uintptr_t byte_ct, uint32_t skip_ct, TextMasks* masksp) {
+  const char* buf_end = &(buf[byte_ct]);
+  uintptr_t checksum = 0;
+  switch (bench_idx) {
+  case kBenchLinesRawmemchr:
+    for (const char* line_iter = buf; line_iter != buf_end; line_iter = AdvPastDelim(line_iter, '\n')) {
+      ++checksum;
+    }
+    break;
+  case kBenchLinesMask:
+    checksum = Classify(buf, byte_ct, masksp);
+    break;
+  case kBenchSkipNextTokenMult:
+  case kBenchSkipNextTokenMultFar:
+  case kBenchSkipAdvToNthDelim:
+  case kBenchCountScalar:
+  case kBenchCountTokens:
+    for (const char* line_iter = buf; line_iter != buf_end; line_iter = AdvPastDelim(line_iter, '\n')) {
+      if (bench_idx == kBenchSkipNextTokenMult) {
+        checksum += NextTokenMult(line_iter, skip_ct) - line_iter;
+      } else if (bench_idx == kBenchSkipNextTokenMultFar) {
+        checksum += NextTokenMultFar(line_iter, skip_ct) - line_iter;
+      } else if (bench_idx == kBenchSkipAdvToNthDelim) {
+        checksum += AdvToNthDelim(line_iter, skip_ct, '\t') + 1 - line_iter;
+      } else if (bench_idx == kBenchCountScalar) {
+        checksum += CountTokensScalar(line_iter);
+      } else {
+        checksum += CountTokens(line_iter);
+      }
+      // Skip/count functions don't advance line_iter, so the AdvPastDelim()
+      // cost is shared by every pointer-walking case.
+    }
+    break;
+  default:
+    {
+      Classify(buf, byte_ct, masksp);
+      const uintptr_t* newline_bits = masksp->newline_bits;
+      const uintptr_t word_ct = DivUp(byte_ct, kBitsPerWord);
+      uintptr_t line_start = 0;
+      for (uintptr_t widx = 0; widx != word_ct; ++widx) {
+        uintptr_t cur_bits = newline_bits[widx];
+        while (cur_bits) {
+          const uintptr_t line_end = widx * kBitsPerWord + ctzw(cur_bits);
+          if (bench_idx == kBenchSkipMaskToken) {
+            checksum += MaskNextTokenMult(masksp->token_start_bits, newline_bits, line_start, byte_ct, skip_ct) - line_start;
+          } else if (bench_idx == kBenchSkipMaskTab) {
+            checksum += MaskAdvToNthDelim(masksp->tab_bits, line_start, byte_ct, skip_ct) + 1 - line_start;
+          } else {
+            checksum += MaskCountTokens(masksp->token_start_bits, newline_bits, line_start, byte_ct);
+          }
+          line_start = line_end + 1;
+          cur_bits &= cur_bits - 1;
+        }
+      }
+    }
+  }
+  return checksum;
+}
+
+// Line-by-line agreement check between the two scanner families.
+static uint32_t Verify(const char* buf, uintptr_t byte_ct, uint32_t skip_ct, TextMasks* masksp) {
+  Classify(buf, byte_ct, masksp);
+  uint32_t mismatch_ct = 0;
+  uintptr_t line_start = 0;
+  for (uintptr_t line_idx = 1; line_start != byte_ct; ++line_idx) {
+    const char* line_iter = &(buf[line_start]);
+    const uintptr_t line_end = AdvToDelim(line_iter, '\n') - buf;
+    if (line_end != MaskAdvToNthDelim(masksp->newline_bits, line_start, byte_ct, 1)) {
+      fprintf(stderr, "line %" PRIuPTR ": newline mismatch\n", line_idx);
+      ++mismatch_ct;
+    }
+    for (uint32_t cur_skip = 1; cur_skip <= skip_ct + 1; ++cur_skip) {
+      const char* token_ptr = NextTokenMult(line_iter, cur_skip);
+      const uintptr_t expected = token_ptr? S_CAST(uintptr_t, token_ptr - buf) : UINTPTR_MAX;
+      if (expected != MaskNextTokenMult(masksp->token_start_bits, masksp->newline_bits, line_start, byte_ct, cur_skip)) {
+        fprintf(stderr, "line %" PRIuPTR ": MaskNextTokenMult(%u) mismatch\n", line_idx, cur_skip);
+        ++mismatch_ct;
+      }
+      const char* tab_ptr = AdvToNthDelimChecked(line_iter, &(buf[line_end]), cur_skip, '\t');
+      const uintptr_t tab_expected = tab_ptr? S_CAST(uintptr_t, tab_ptr - buf) : UINTPTR_MAX;
+      if (tab_expected != MaskAdvToNthDelim(masksp->tab_bits, line_start, line_end, cur_skip)) {
+        fprintf(stderr, "line %" PRIuPTR ": MaskAdvToNthDelim(%u) mismatch\n", line_idx, cur_skip);
+        ++mismatch_ct;
+      }
+    }
+    const uint32_t token_ct = CountTokensScalar(line_iter);
+    if ((token_ct != CountTokens(line_iter)) || (token_ct != MaskCountTokens(masksp->token_start_bits, masksp->newline_bits, line_start, byte_ct))) {
+      fprintf(stderr, "line %" PRIuPTR ": token count mismatch\n", line_idx);
+      ++mismatch_ct;
+    }
+    if (mismatch_ct > 10) {
+      break;
+    }
+    line_start = line_end + 1;
+  }
+  return mismatch_ct;
+}
+
+int32_t main(int32_t argc, char** argv) {
+  const char* tier_str =
+#ifdef USE_AVX2
+    "avx2";
+#elif defined(USE_SSE42)
+    "sse4.2";
+#else
+    "sse2";
+#endif
+  if (argc < 3) {
+    fputs("Usage: text_scan_bench [text file] [columns to skip] {MiB per case}\n", stderr);
+    return 2;
+  }
+  const uint32_t skip_ct = atoi(argv[2]);
+  if (!skip_ct) {
+    fputs("Error: column skip count must be positive.\n", stderr);
+    return 2;
+  }
+  // ~1 GiB of text per case by default
+  double target_bytes = 1024.0 * 1024 * 1024;
+  if (argc > 3) {
+    target_bytes = atof(argv[3]) * 1024 * 1024;
+  }
+  FILE* infile = fopen(argv[1], "rb");
+  if (!infile) {
+    fprintf(stderr, "Error: Failed to open %s.\n", argv[1]);
+    return 1;
+  }
+  fseeko(infile, 0, SEEK_END);
+  const uintptr_t file_size = ftello(infile);
+  rewind(infile);
+  // Pad so the aligned-vector overreads of the pointer-walking scanners stay
+  // inside the allocation.
+  char* file_buf = S_CAST(char*, malloc(file_size + 2 * kBytesPerVec));
+  if ((!file_buf) || (fread(file_buf, 1, file_size, infile) != file_size)) {
+    fprintf(stderr, "Error: Failed to read %s.\n", argv[1]);
+    return 1;
+  }
+  fclose(infile);
+  memset(&(file_buf[file_size]), 0, 2 * kBytesPerVec);
+  // Drop header lines, and any unterminated final line.
+  const char* buf = file_buf;
+  while ((buf != &(file_buf[file_size])) && (*buf == '#')) {
+    buf = AdvPastDelim(buf, '\n');
+  }
+  const char* last_nl = Memrchr(buf, '\n', &(file_buf[file_size]) - buf);
+  if (!last_nl) {
+    fputs("Error: No complete non-header lines.\n", stderr);
+    return 1;
+  }
+  const uintptr_t byte_ct = &(last_nl[1]) - buf;
+  const uintptr_t word_ct = DivUp(byte_ct, kBitsPerWord);
+  TextMasks masks;
+  uintptr_t* mask_alloc = S_CAST(uintptr_t*, malloc(4 * word_ct * sizeof(intptr_t)));
+  if (!mask_alloc) {
+    fputs("Error: Out of memory.\n", stderr);
+    return 1;
+  }
+  masks.newline_bits = mask_alloc;
+  masks.tab_bits = &(mask_alloc[word_ct]);
+  masks.space_bits = &(mask_alloc[2 * word_ct]);
+  masks.token_start_bits = &(mask_alloc[3 * word_ct]);
+
+  const uint32_t mismatch_ct = Verify(buf, byte_ct, skip_ct, &masks);
+  const uint32_t rep_ct = MAXV(1, S_CAST(uint32_t, target_bytes / S_CAST(double, byte_ct)));
+  printf("%-8s %-22s %10s %10s\n", "tier", "case", "checksum", "GB/s");
+  volatile uintptr_t sink = 0;
+  for (uint32_t bench_idx = 0; bench_idx != kBenchCt; ++bench_idx) {
+    uintptr_t checksum = RunOnce(bench_idx, buf, byte_ct, skip_ct, &masks);
+    const double start_ns = NowNs();
+    for (uint32_t rep_idx = 0; rep_idx != rep_ct; ++rep_idx) {
+      sink += RunOnce(bench_idx, buf, byte_ct, skip_ct, &masks);
+    }
+    const double elapsed_ns = NowNs() - start_ns;
+    printf("%-8s %-22s %10" PRIuPTR " %10.2f\n", tier_str, kBenchNames[bench_idx], checksum, S_CAST(double, byte_ct) * rep_ct / elapsed_ns);
+  }
+  free(mask_alloc);
+  free(file_buf);
+  if (mismatch_ct) {
+    fprintf(stderr, "%u mismatch(es) between pointer-walking and mask-based results.\n", mismatch_ct);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+# Usage: ./run_bench.sh [plink2 build dir] {baseline build dir} {thread ct}
+# Runs the work-stealing phases (--glm firth-fallback on a dataset with
+# multiallelic variants, sparse and dense KING) under --perf-log and prints
+# each phase's wall time, wall-clock utilization, and cpu_balance (the
+# utilization it would reach with a dedicated core per thread).  With a
+# baseline build, the same table is printed for it, and the outputs of the
+# two builds are compared.  thread_ct defaults to the number of online CPUs.
+#
+# utilization is only meaningful with at least thread_ct idle cores.
+# cpu_balance is computed from per-thread CPU time, so for a static partition
+# it measures the partition's imbalance on any host.  With work stealing on
+# an oversubscribed host, it understates balance: whichever thread gets a core
+# first also steals the most tasks, which doesn't cost anything there.
+
+set -eo pipefail
+
+PLINK2="$1/plink2"
+BASELINE_DIR=$2
+THREAD_CT=${3:-$(getconf _NPROCESSORS_ONLN)}
+
+$PLINK2 --dummy 2000 20000 0.05 acgt --seed 5 --out tmp_data > /dev/null
+$PLINK2 --pfile tmp_data --export vcf --out tmp_data > /dev/null
+# Make every fifth variant triallelic.
+awk 'BEGIN {OFS="\t"} /^#/ {print; next} (NR % 5 == 0) {$5 = $5 ",T"; for (i = 10; i <= NF; i += 3) {if ($i == "1/1") $i = "2/2"; else if ($i == "0/1") $i = "0/2"}} {print}' tmp_data.vcf > tmp_multi.vcf
+$PLINK2 --vcf tmp_multi.vcf --make-pgen --out tmp_multi > /dev/null
+cut -f 1,3 tmp_data.psam | sed '1s/.*/#IID\tPHENO1/' > tmp_pheno.txt
+
+run_phases() {
+    local bin_dir=$1
+    local out=$2
+    $bin_dir/plink2 --pfile tmp_multi --pheno tmp_pheno.txt --glm allow-no-covars firth-fallback --threads $THREAD_CT --perf-log $out.glm.json --out $out > /dev/null
+    $bin_dir/plink2 --pfile tmp_multi --make-king-table counts --make-king square --threads $THREAD_CT --perf-log $out.king.json --out $out > /dev/null
+    printf "%-28s %8s %10s %12s %12s\n" "phase" "threads" "wall_ms" "utilization" "cpu_balance"
+    cat $out.glm.json $out.king.json | awk '/"func": "(GlmLogistic|CalcKing)/ {
+        match($0, /"func": "[^"]*"/); func_name = substr($0, RSTART + 9, RLENGTH - 10);
+        match($0, /"thread_ct": [0-9]*/); thread_ct = substr($0, RSTART + 13, RLENGTH - 13);
+        match($0, /"wall_ms": [0-9.e+-]*/); wall_ms = substr($0, RSTART + 11, RLENGTH - 11);
+        match($0, /"utilization": [0-9.e+-]*/); util = substr($0, RSTART + 15, RLENGTH - 15);
+        match($0, /"cpu_balance": [0-9.e+-]*/); balance = substr($0, RSTART + 15, RLENGTH - 15);
+        printf "%-28s %8s %10.1f %12.3f %12.3f\n", func_name, thread_ct, wall_ms, util, balance
+    }'
+}
+
+echo "== $1"
+run_phases $1 tmp_new
+if [ -n "$BASELINE_DIR" ]; then
+    echo "== $BASELINE_DIR"
+    run_phases $BASELINE_DIR tmp_base
+    cmp tmp_new.PHENO1.glm.logistic.hybrid tmp_base.PHENO1.glm.logistic.hybrid
+    cmp tmp_new.kin0 tmp_base.kin0
+    cmp tmp_new.king tmp_base.king
+fi
+
+rm -f tmp_*
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# The index is written by htslib's tabix; nothing to check without it.
+if ! command -v tabix > /dev/null; then
+    echo "tabix not found, skipping TEST_BGZF_SEEK."
+    exit 0
+fi
+
+# Three chromosomes, spread over many BGZF blocks.
+$1/plink2 $2 $3 --dummy 8 30000 --out tmp_dummy
+awk 'BEGIN {OFS="\t"} /^#/ {print; next} {$1 = 1 + int((NR - 2) / 10000); $2 = 1 + 40 * ((NR - 2) % 10000); print}' tmp_dummy.pvar > tmp_data.pvar
+$1/plink2 $2 $3 --pgen tmp_dummy.pgen --psam tmp_dummy.psam --pvar tmp_data.pvar --export vcf bgz --out tmp_data
+tabix -f -p vcf tmp_data.vcf.gz
+tabix -C -p vcf -f tmp_data.vcf.gz
+mv tmp_data.vcf.gz.csi tmp_csi.vcf.gz.csi
+cp tmp_data.vcf.gz tmp_csi.vcf.gz
+tabix -p vcf -f tmp_data.vcf.gz
+cp tmp_data.vcf.gz tmp_noidx.vcf.gz
+
+# Indexed imports must match unindexed ones exactly.
+for filt in "--chr 2" "--chr 1,3" "--not-chr 1" "--chr 2 --from-bp 100001 --to-bp 150000" "--chr 3 --to-bp 1000"; do
+    for t in 1 4; do
+        $1/plink2 $2 $3 --vcf tmp_noidx.vcf.gz $filt --threads $t --make-pgen --out tmp_ref
+        for f in tmp_data tmp_csi; do
+            $1/plink2 $2 $3 --vcf $f.vcf.gz $filt --threads $t --make-pgen --out tmp_out
+            cmp tmp_out.pgen tmp_ref.pgen
+            cmp tmp_out.pvar tmp_ref.pvar
+        done
+    done
+done
+# Region lookup should skip most of the file.
+$1/plink2 $2 $3 --vcf tmp_data.vcf.gz --chr 2 --from-bp 100001 --to-bp 150000 --make-pgen --out tmp_out
+grep -q "^--vcf: [0-9]* variants scanned.$" tmp_out.log
+
+# Same for a .pvar loaded without a .pgen.
+cut -f 1-5 tmp_data.pvar | bgzip -c > tmp_idx.pvar.gz
+tabix -s 1 -b 2 -e 2 -c '#' tmp_idx.pvar.gz
+cut -f 1-5 tmp_data.pvar | bgzip -c > tmp_noidx.pvar.gz
+for filt in "--chr 2" "--not-chr 2" "--chr 3 --from-bp 20001 --to-bp 30000"; do
+    $1/plink2 $2 $3 --pvar tmp_noidx.pvar.gz $filt --make-just-pvar --out tmp_ref
+    $1/plink2 $2 $3 --pvar tmp_idx.pvar.gz $filt --make-just-pvar --out tmp_out
+    cmp tmp_out.pvar tmp_ref.pvar
+done
+
+# Malformed index: warning, then full scan.
+head -c 100 tmp_data.vcf.gz.tbi > tmp_bad.vcf.gz.tbi
+cp tmp_data.vcf.gz tmp_bad.vcf.gz
+$1/plink2 $2 $3 --vcf tmp_bad.vcf.gz --chr 2 --make-pgen --out tmp_bad
+grep -q "Ignoring tabix/CSI index" tmp_bad.log
+$1/plink2 $2 $3 --vcf tmp_noidx.vcf.gz --chr 2 --make-pgen --out tmp_ref
+cmp tmp_bad.pgen tmp_ref.pgen
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Three sorted chromosomes, spread over many BGZF blocks.
+$1/plink2 $2 $3 --dummy 8 30000 --out tmp_dummy
+awk 'BEGIN {OFS="\t"} /^#/ {print; next} {$1 = 1 + int((NR - 2) / 10000); $2 = 1 + 40 * ((NR - 2) % 10000); print}' tmp_dummy.pvar > tmp_data.pvar
+$1/plink2 $2 $3 --pgen tmp_dummy.pgen --psam tmp_dummy.psam --pvar tmp_data.pvar --make-just-pvar bgz --freq bgz --export vcf bgz --out tmp_data
+for f in tmp_data.pvar.gz tmp_data.afreq.gz tmp_data.vcf.gz; do
+    test -s $f.tbi
+    grep -q "^Index written to $f.tbi .$" tmp_data.log
+done
+gzip -dc tmp_data.pvar.gz | cmp - tmp_data.pvar
+# (bgz forces the pos column.)
+$1/plink2 $2 $3 --pgen tmp_dummy.pgen --psam tmp_dummy.psam --pvar tmp_data.pvar --freq cols=+pos --out tmp_plain
+gzip -dc tmp_data.afreq.gz | cmp - tmp_plain.afreq
+
+# Region lookups through the new index must match full scans.
+cp tmp_data.pvar.gz tmp_noidx.pvar.gz
+cp tmp_data.vcf.gz tmp_noidx.vcf.gz
+for filt in "--chr 2" "--chr 1,3" "--chr 2 --from-bp 100001 --to-bp 150000" "--chr 3 --to-bp 1000"; do
+    $1/plink2 $2 $3 --pvar tmp_noidx.pvar.gz $filt --make-just-pvar --out tmp_ref
+    $1/plink2 $2 $3 --pvar tmp_data.pvar.gz $filt --make-just-pvar --out tmp_out
+    cmp tmp_out.pvar tmp_ref.pvar
+    $1/plink2 $2 $3 --vcf tmp_noidx.vcf.gz $filt --make-pgen --out tmp_ref
+    $1/plink2 $2 $3 --vcf tmp_data.vcf.gz $filt --make-pgen --out tmp_out
+    cmp tmp_out.pgen tmp_ref.pgen
+    cmp tmp_out.pvar tmp_ref.pvar
+done
+$1/plink2 $2 $3 --vcf tmp_data.vcf.gz --chr 2 --from-bp 100001 --to-bp 150000 --make-pgen --out tmp_out
+grep -q "^--vcf: [0-9]* variants scanned.$" tmp_out.log
+
+# Positions past 2^29 need a CSI index.
+awk 'BEGIN {OFS="\t"} /^#/ {print; next} {$1 = 1 + int((NR - 2) / 10000); $2 = 1 + 60000 * ((NR - 2) % 10000); print}' tmp_dummy.pvar > tmp_big.pvar
+$1/plink2 $2 $3 --pvar tmp_big.pvar --make-just-pvar bgz --out tmp_big
+test -s tmp_big.pvar.gz.csi
+test ! -e tmp_big.pvar.gz.tbi
+cp tmp_big.pvar.gz tmp_bignoidx.pvar.gz
+$1/plink2 $2 $3 --pvar tmp_bignoidx.pvar.gz --chr 2 --from-bp 550000001 --to-bp 560000000 --make-just-pvar --out tmp_ref
+$1/plink2 $2 $3 --pvar tmp_big.pvar.gz --chr 2 --from-bp 550000001 --to-bp 560000000 --make-just-pvar --out tmp_out
+cmp tmp_out.pvar tmp_ref.pvar
+
+# A CSI index deeper than 10 levels can't be queried with 32-bit bin numbers;
+# it must be rejected with a warning, followed by a full scan.
+if command -v python3 > /dev/null; then
+    python3 -c "
+import gzip, struct, sys, zlib
+d = bytearray(gzip.open('tmp_big.pvar.gz.csi', 'rb').read())
+d[8:12] = struct.pack('<i', 11)
+for i in range(0, len(d), 65280):
+    b = bytes(d[i:i + 65280])
+    c = zlib.compressobj(6, zlib.DEFLATED, -15)
+    z = c.compress(b) + c.flush()
+    sys.stdout.buffer.write(struct.pack('<4BI2BH2BHH', 31, 139, 8, 4, 0, 0, 255, 6, 66, 67, 2, len(z) + 25) + z + struct.pack('<II', zlib.crc32(b), len(b)))
+" > tmp_deep.pvar.gz.csi
+    cp tmp_big.pvar.gz tmp_deep.pvar.gz
+    $1/plink2 $2 $3 --pvar tmp_deep.pvar.gz --chr 2 --from-bp 550000001 --to-bp 560000000 --make-just-pvar --out tmp_deep
+    grep -q "^Warning: Ignoring tabix/CSI index .*depth > 10" tmp_deep.log
+    cmp tmp_deep.pvar tmp_ref.pvar
+fi
+
+# Unsorted positions: warning, and no index.
+awk 'BEGIN {OFS="\t"} /^#/ {print; next} {$1 = 1; $2 = 1 + (NR * 7919) % 100000; print}' tmp_dummy.pvar > tmp_unsorted.pvar
+$1/plink2 $2 $3 --pgen tmp_dummy.pgen --psam tmp_dummy.psam --pvar tmp_unsorted.pvar --freq bgz --out tmp_unsorted
+grep -q "^Warning: tmp_unsorted.afreq.gz not indexed" tmp_unsorted.log
+test ! -e tmp_unsorted.afreq.gz.tbi
@@ -0,0 +1,39 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# --dry-run must report workspace estimates without writing any analysis
+# output, and regular runs should log per-phase workspace high-water marks.
+$1/plink2 $2 $3 --dummy 300 1000 0.05 acgt --seed 3 --out tmp_data
+
+rm -f tmp_dry.*
+$1/plink2 $2 $3 --pfile tmp_data --make-king square --make-rel --dry-run --out tmp_dry
+test ! -e tmp_dry.king
+test ! -e tmp_dry.rel
+grep -q -- '--dry-run: 300 samples and 1000 variants remaining' tmp_dry.log
+grep -q -- '--dry-run: KING-robust computation needs' tmp_dry.log
+grep -q -- '--dry-run: GRM construction needs' tmp_dry.log
+grep -q -- '--dry-run: Suggested minimum --memory value: ' tmp_dry.log
+
+# A run at the suggested --memory value must succeed.  --king-cutoff on 9400
+# samples needs more than the 640 MiB minimum for a single pass.
+$1/plink2 $2 $3 --dummy 9400 200 0.05 acgt --seed 3 --out tmp_big
+$1/plink2 $2 $3 --pfile tmp_big --king-cutoff 0.2 --dry-run --out tmp_dry_king
+king_mib=$(sed -n 's/^--dry-run: Suggested minimum --memory value: \([0-9]*\)\..*/\1/p' tmp_dry_king.log)
+test "$king_mib" -gt 640
+$1/plink2 $2 $3 --pfile tmp_big --king-cutoff 0.2 --memory $king_mib --out tmp_king
+grep -q -- '--king-cutoff pass 1/1:' tmp_king.log
+test -e tmp_king.king.cutoff.in.id
+
+rel_mib=$(sed -n 's/^--dry-run: Suggested minimum --memory value: \([0-9]*\)\..*/\1/p' tmp_dry.log)
+$1/plink2 $2 $3 --pfile tmp_data --make-king square --make-rel --memory $rel_mib --out tmp_sized
+test -e tmp_sized.king
+test -e tmp_sized.rel
+
+$1/plink2 $2 $3 --pfile tmp_data --make-rel --out tmp_rel
+grep -q 'Workspace high-water mark (.pvar load): ' tmp_rel.log
+# Line buffers sized to the available workspace are listed separately, so
+# loading 300 samples shouldn't register as more than 1 MiB of fixed usage.
+grep -q 'Workspace high-water mark (.psam load): 1 MiB, plus [0-9]* MiB of buffers sized' tmp_rel.log
+grep -q 'Workspace high-water mark (--make-rel/--make-grm): ' tmp_rel.log
+grep -q 'Workspace high-water mark (overall): ' tmp_rel.log
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Large enough for several multithreaded-decoder batches.
+$1/plink2 $2 $3 --dummy 8 600000 --out tmp_data
+# Long repetitive INFO values, for long-distance back-references.
+awk 'BEGIN {OFS="\t"; print "##INFO=<ID=X,Number=1,Type=String,Description=\"x\">"} /^#CHROM/ {print $0, "INFO"; next} {print $0, "X=" substr("ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGT", 1 + (NR % 40), 60)}' tmp_data.pvar > tmp_rep.pvar
+
+# gzip -1, -6 (with stored file name), -9
+gzip -1 -n -c tmp_data.pvar > tmp_1.pvar.gz
+gzip -c tmp_data.pvar > tmp_6.pvar.gz
+gzip -9 -n -c tmp_rep.pvar > tmp_rep.pvar.gz
+# Concatenated members, including a tiny one.
+sed -n '1,100p' tmp_data.pvar | gzip -n > tmp_cat.pvar.gz
+sed -n '101,300100p' tmp_data.pvar | gzip -1 -n >> tmp_cat.pvar.gz
+tail -n +300101 tmp_data.pvar | gzip -9 -n >> tmp_cat.pvar.gz
+for f in tmp_1 tmp_6 tmp_cat; do
+    gzip -dc $f.pvar.gz | cmp - tmp_data.pvar
+    for t in 1 2 4 8; do
+        $1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar $f.pvar.gz --threads $t --make-just-pvar --out tmp_out$t
+        cmp tmp_out$t.pvar tmp_data.pvar
+    done
+done
+gzip -dc tmp_rep.pvar.gz | cmp - tmp_rep.pvar
+for t in 1 4 8; do
+    $1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar tmp_rep.pvar.gz --threads $t --make-just-pvar --out tmp_out$t
+    cmp tmp_out$t.pvar tmp_rep.pvar
+done
+
+if command -v python3 > /dev/null; then
+    # Stored (uncompressed) and fixed-Huffman blocks.
+    python3 -c "import sys, zlib; d = open('tmp_data.pvar', 'rb').read(); c = zlib.compressobj(0, zlib.DEFLATED, 31); sys.stdout.buffer.write(c.compress(d) + c.flush())" > tmp_stored.pvar.gz
+    python3 -c "import sys, zlib; d = open('tmp_data.pvar', 'rb').read(); c = zlib.compressobj(6, zlib.DEFLATED, 31, 9, zlib.Z_FIXED); sys.stdout.buffer.write(c.compress(d) + c.flush())" > tmp_fixed.pvar.gz
+    for f in tmp_stored tmp_fixed; do
+        gzip -dc $f.pvar.gz | cmp - tmp_data.pvar
+        for t in 1 4; do
+            $1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar $f.pvar.gz --threads $t --make-just-pvar --out tmp_out$t
+            cmp tmp_out$t.pvar tmp_data.pvar
+        done
+    done
+fi
+
+# Truncated file.
+head -c 1500000 tmp_1.pvar.gz > tmp_trunc.pvar.gz
+for t in 1 4; do
+    $1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar tmp_trunc.pvar.gz --threads $t --make-just-pvar --out tmp_trunc$t && exit 1
+    grep -q "truncated" tmp_trunc$t.log
+done
+
+# Corrupted CRC.
+sz=$(wc -c < tmp_1.pvar.gz)
+head -c $((sz - 8)) tmp_1.pvar.gz > tmp_crc.pvar.gz
+printf '\x00\x00\x00\x00' >> tmp_crc.pvar.gz
+tail -c 4 tmp_1.pvar.gz >> tmp_crc.pvar.gz
+$1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar tmp_crc.pvar.gz --threads 4 --make-just-pvar --out tmp_crc && exit 1
+grep -q "CRC" tmp_crc.log
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Slowly-drifting haplotype background, so that the best LD-compression base
+# is frequently not the most recent uncompressed variant.
+awk 'BEGIN {
+  srand(1);
+  printf "##fileformat=VCFv4.2\n#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT";
+  for (s = 0; s < 240; ++s) {
+    printf "\ts%d", s;
+    g[s] = int(rand() * 3);
+  }
+  printf "\n";
+  for (v = 1; v <= 3000; ++v) {
+    printf "1\t%d\tv%d\tA\tC\t.\t.\t.\tGT", v, v;
+    for (s = 0; s < 240; ++s) {
+      if (rand() < 0.02) {
+        g[s] = int(rand() * 4);
+      }
+      if (g[s] == 3) {
+        printf "\t./.";
+      } else {
+        printf "\t%d/%d", (g[s] == 2), (g[s] != 0);
+      }
+    }
+    printf "\n";
+  }
+}' > tmp_data.vcf
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --make-pgen ld-search --out tmp_ld
+$1/plink2 $2 $3 --pfile tmp_data --sort-vars --make-pgen ld-search --out tmp_ld_sorted
+$1/plink2 $2 $3 --dummy 333 4321 0.05 dosage-freq=0.1 --out tmp_dosage
+$1/plink2 $2 $3 --pfile tmp_dosage --make-pgen ld-search --out tmp_dosage_ld
+
+# The search must only change the encoding, never the genotypes, and it
+# should not make the file larger.
+$1/plink2 $2 $3 --pfile tmp_data --export A --out tmp_data
+for f in tmp_ld tmp_ld_sorted; do
+    $1/plink2 $2 $3 --pfile $f --export A --out $f
+    diff -q tmp_data.raw $f.raw
+    test $(wc -c < $f.pgen) -le $(wc -c < tmp_data.pgen)
+done
+$1/plink2 $2 $3 --pfile tmp_dosage --export A --out tmp_dosage
+$1/plink2 $2 $3 --pfile tmp_dosage_ld --export A --out tmp_dosage_ld
+diff -q tmp_dosage.raw tmp_dosage_ld.raw
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 200 3000 0.1 dosage-freq=0.3 --seed 1 --out tmp_data
+
+for r in "" "--output-roundtrip"; do
+    o=tmp_out$(test -z "$r" || echo _r)
+    $1/plink2 $2 $3 --pfile tmp_data --freq cols=+reffreq,+machr2 --glm allow-no-covars --make-king-table --make-king square $r --out $o
+done
+
+# Each --output-roundtrip value must agree with the default 6-significant-digit
+# output to within its precision.  (dtoa_g() doesn't always round ties
+# correctly, so the 6-digit strings can't be compared directly.)
+for f in afreq PHENO1.glm.logistic.hybrid kin0 king; do
+    paste tmp_out.$f tmp_out_r.$f | awk -F'\t' '{
+        n = NF / 2;
+        for (i = 1; i <= n; ++i) {
+            s = $(i + n);
+            d = s - $i;
+            if ((s ~ /^-?[0-9.]+(e[-+][0-9]+)?$/) && (d * d > 1e-10 * s * s)) {
+                print "line " NR " column " i ": " $i " vs. " s;
+                bad = 1;
+            }
+        }
+    } END { exit bad }'
+done
+! cmp -s tmp_out.afreq tmp_out_r.afreq
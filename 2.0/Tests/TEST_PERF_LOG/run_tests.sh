@@ -0,0 +1,40 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# --perf-log must not change any other output, and should report one phase per
+# thread-group function with sane utilization numbers.
+$1/plink2 $2 $3 --dummy 400 2000 0.05 acgt --seed 7 --out tmp_data
+
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars --make-king-table --threads 3 --out tmp_ref
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars --make-king-table --threads 3 --perf-log tmp_perf.json --out tmp_out
+cmp tmp_out.PHENO1.glm.logistic.hybrid tmp_ref.PHENO1.glm.logistic.hybrid
+cmp tmp_out.kin0 tmp_ref.kin0
+grep -q 'tmp_perf.json' tmp_out.log
+grep -q '"func": "GlmLogisticThread"' tmp_perf.json
+
+if command -v python3 > /dev/null; then
+    python3 - tmp_perf.json <<'PYEOF'
+import json
+import sys
+
+with open(sys.argv[1]) as f:
+    perf = json.load(f)
+funcs = [phase["func"] for phase in perf["phases"]]
+assert "GlmLogisticThread" in funcs, funcs
+assert "CalcKingTableSubsetThread" in funcs or "CalcKingSparseThread" in funcs or "CalcKingDenseThread" in funcs, funcs
+prev_start = -1.0
+for phase in perf["phases"]:
+    assert phase["start_ms"] >= prev_start
+    prev_start = phase["start_ms"]
+    assert phase["round_ct"] >= 1
+    assert len(phase["thread_busy_ms"]) == phase["thread_ct"]
+    assert len(phase["thread_wait_ms"]) == phase["thread_ct"]
+    assert len(phase["thread_cpu_ms"]) == phase["thread_ct"]
+    assert 0.0 <= phase["utilization"] <= 1.0 + 1e-6, phase
+    assert 0.0 <= phase["cpu_balance"] <= 1.0 + 1e-6, phase
+    assert phase["critical_cpu_ms"] <= sum(phase["thread_cpu_ms"]) + 1e-3, phase
+    if phase["func"] == "GlmLogisticThread":
+        assert phase["thread_ct"] == 3, phase
+PYEOF
+fi
@@ -0,0 +1,85 @@
+// LD_PRELOAD shim that kills the process partway through .pgen finalization.
+//
+// PGEN_CRASH_AT=tables: SpgwFinish() seeks to offset 12 before writing the
+//   header tables; the next fwrite() after that writes half its bytes, flushes
+//   them, and then the process is SIGKILLed.
+// PGEN_CRASH_AT=rename: the process is SIGKILLed on entry to rename(), i.e.
+//   after the finished file has been synced but before it replaces anything.
+
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+namespace {
+
+int g_armed = 0;
+
+int CrashAt(const char* stage) {
+  const char* env_val = getenv("PGEN_CRASH_AT");
+  return env_val && (!strcmp(env_val, stage));
+}
+
+void ArmIfTableSeek(off_t offset, int whence) {
+  if ((offset == 12) && (whence == SEEK_SET) && CrashAt("tables")) {
+    g_armed = 1;
+  }
+}
+
+size_t HalfWriteAndDie(const void* ptr, size_t size, size_t n, FILE* stream) {
+  typedef size_t (*FwriteFn)(const void*, size_t, size_t, FILE*);
+  FwriteFn real_fwrite = reinterpret_cast<FwriteFn>(dlsym(RTLD_NEXT, "fwrite"));
+  const size_t byte_ct = size * n;
+  real_fwrite(ptr, 1, byte_ct / 2, stream);
+  fflush(stream);
+  raise(SIGKILL);
+  return 0;
+}
+
+}  // namespace
+
+extern "C" {
+
+int fseeko(FILE* stream, off_t offset, int whence) {
+  typedef int (*FseekoFn)(FILE*, off_t, int);
+  ArmIfTableSeek(offset, whence);
+  return reinterpret_cast<FseekoFn>(dlsym(RTLD_NEXT, "fseeko"))(stream, offset, whence);
+}
+
+int fseeko64(FILE* stream, off64_t offset, int whence) {
+  typedef int (*Fseeko64Fn)(FILE*, off64_t, int);
+  ArmIfTableSeek(offset, whence);
+  return reinterpret_cast<Fseeko64Fn>(dlsym(RTLD_NEXT, "fseeko64"))(stream, offset, whence);
+}
+
+size_t fwrite(const void* ptr, size_t size, size_t n, FILE* stream) {
+  typedef size_t (*FwriteFn)(const void*, size_t, size_t, FILE*);
+  if (g_armed) {
+    return HalfWriteAndDie(ptr, size, n, stream);
+  }
+  return reinterpret_cast<FwriteFn>(dlsym(RTLD_NEXT, "fwrite"))(ptr, size, n, stream);
+}
+
+size_t fwrite_unlocked(const void* ptr, size_t size, size_t n, FILE* stream) {
+  typedef size_t (*FwriteFn)(const void*, size_t, size_t, FILE*);
+  if (g_armed) {
+    return HalfWriteAndDie(ptr, size, n, stream);
+  }
+  return reinterpret_cast<FwriteFn>(dlsym(RTLD_NEXT, "fwrite_unlocked"))(ptr, size, n, stream);
+}
+
+int rename(const char* oldpath, const char* newpath) {
+  typedef int (*RenameFn)(const char*, const char*);
+  if (CrashAt("rename")) {
+    raise(SIGKILL);
+  }
+  return reinterpret_cast<RenameFn>(dlsym(RTLD_NEXT, "rename"))(oldpath, newpath);
+}
+
+}
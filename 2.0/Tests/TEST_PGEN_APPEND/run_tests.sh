@@ -0,0 +1,67 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Three pieces: a tiny first file (so the first append must move the existing
+# records to make room for the larger header), then enough variants to cross
+# a vblock boundary, then a small tail that should fit in the header slack.
+$1/plink2 $2 $3 --dummy 150 80000 0.05 --make-bed --out tmp_data
+awk 'NR <= 11 {print $2}' tmp_data.bim > tmp_part1.txt
+awk 'NR > 11 && NR <= 70000 {print $2}' tmp_data.bim > tmp_part2.txt
+awk 'NR > 70000 {print $2}' tmp_data.bim > tmp_part3.txt
+for i in 1 2 3; do
+    $1/plink2 $2 $3 --bfile tmp_data --extract tmp_part$i.txt --make-bed --out tmp_part$i
+done
+
+$1/pgen_compress tmp_data.bed tmp_whole.pgen 150
+$1/pgen_compress tmp_part1.bed tmp_appended.pgen 150
+
+# An append killed at any point must leave the original untouched; the new
+# file is always built as tmp_appended.pgen.tmp and renamed over it at the
+# end.  First append: killed while copying (SIGXFSZ from the file size limit);
+# the records have to move to make room for the larger header.
+cp tmp_appended.pgen tmp_appended_copy.pgen
+if (ulimit -f 4; exec $1/pgen_compress -a tmp_part2.bed tmp_appended.pgen 150); then
+    exit 1
+fi
+cmp tmp_appended.pgen tmp_appended_copy.pgen
+$1/pgen_compress -a tmp_part2.bed tmp_appended.pgen 150
+test ! -e tmp_appended.pgen.tmp
+
+# Third append: the records keep their offsets.  Kill it while writing the new
+# records, halfway through writing the header tables, and just before the
+# rename; a stale .tmp file left behind must not affect the next attempt.
+${CXX:-g++} -O2 -shared -fPIC -o tmp_crash_shim.so crash_shim.cc -ldl
+cp tmp_appended.pgen tmp_appended_copy.pgen
+prev_kib=$(( $(wc -c < tmp_appended.pgen) / 1024 + 8 ))
+if (ulimit -f $prev_kib; exec $1/pgen_compress -a tmp_part3.bed tmp_appended.pgen 150); then
+    exit 1
+fi
+cmp tmp_appended.pgen tmp_appended_copy.pgen
+for stage in tables rename; do
+    if (PGEN_CRASH_AT=$stage LD_PRELOAD=./tmp_crash_shim.so exec $1/pgen_compress -a tmp_part3.bed tmp_appended.pgen 150); then
+        exit 1
+    fi
+    cmp tmp_appended.pgen tmp_appended_copy.pgen
+    test -e tmp_appended.pgen.tmp
+done
+$1/pgen_compress -a tmp_part3.bed tmp_appended.pgen 150
+test ! -e tmp_appended.pgen.tmp
+
+$1/pgen_compress -u tmp_whole.pgen tmp_whole.bed
+$1/pgen_compress -u tmp_appended.pgen tmp_appended.bed
+cmp tmp_whole.bed tmp_appended.bed
+
+# Appended files must also be readable by plink2 itself.
+cp tmp_data.bim tmp_appended.bim
+cp tmp_data.fam tmp_appended.fam
+$1/plink2 $2 $3 --bfile tmp_data --freq --out tmp_data
+$1/plink2 $2 $3 --bpfile tmp_appended --freq --out tmp_appended
+diff -q tmp_data.afreq tmp_appended.afreq
+
+# Sample count mismatch must be rejected without touching the file.
+cp tmp_appended.pgen tmp_appended_copy.pgen
+if $1/pgen_compress -a tmp_part3.bed tmp_appended.pgen 149; then
+    exit 1
+fi
+cmp tmp_appended.pgen tmp_appended_copy.pgen
@@ -0,0 +1,426 @@
+// Checks PgrGet1Batch() and PgrGet1BatchTransposed() against per-variant
+// PgrGet1()/PgrGet() calls.
+//
+// Usage: pgen_batch_check <.pgen> <.pvar>
+// Covers contiguous, variant_uidxs and variant_include selection, allele_idx
+// 0/1/2/UINT32_MAX, all samples and a sample subset, and runs split across
+// several calls.  Per-variant reads made on the batch reader afterwards must
+// still match, so LD-cache state left behind by the batch loader is checked
+// too.  Exits nonzero on any mismatch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "../../include/pgenlib_read.h"
+
+using namespace plink2;
+
+namespace {
+
+struct Reader {
+  PgenReader pgr;
+  unsigned char* alloc;
+};
+
+uint32_t g_fail_ct = 0;
+
+PglErr ReadOne(const uintptr_t* sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, uint32_t allele_idx, PgenReader* pgrp, uintptr_t* dest) {
+  if (allele_idx == UINT32_MAX) {
+    return PgrGet(sample_include, pssi, sample_ct, vidx, pgrp, dest);
+  }
+  return PgrGet1(sample_include, pssi, sample_ct, vidx, allele_idx, pgrp, dest);
+}
+
+void CompareRow(const char* label, uint32_t allele_idx, uint32_t sample_ct, uint32_t variant_idx, uint32_t vidx, const uintptr_t* expected, const uintptr_t* actual) {
+  for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+    if (GetNyparrEntry(expected, sample_idx) != GetNyparrEntry(actual, sample_idx)) {
+      if (g_fail_ct < 10) {
+        fprintf(stderr, "%s, allele_idx %d, sample_ct %u: row %u (variant %u) differs at sample %u\n", label, S_CAST(int32_t, allele_idx), sample_ct, variant_idx, vidx, sample_idx);
+      }
+      ++g_fail_ct;
+      return;
+    }
+  }
+}
+
+// Selects the variants in vidxs via each of the three modes the selection
+// permits, in chunks of chunk_size per PgrGet1Batch() call.
+PglErr CheckSelection(const char* label, const uintptr_t* sample_include, PgrSampleSubsetIndex batch_pssi, PgrSampleSubsetIndex ref_pssi, uint32_t sample_ct, const uintptr_t* variant_include, const std::vector<uint32_t>& vidxs, uint32_t allele_idx, uint32_t chunk_size, PgenReader* batch_pgrp, PgenReader* ref_pgrp) {
+  const uint32_t variant_ct = vidxs.size();
+  if (!variant_ct) {
+    return kPglRetSuccess;
+  }
+  const uintptr_t stride = NypCtToVecCt(sample_ct) * kWordsPerVec;
+  uintptr_t* batch_buf;
+  uintptr_t* ref_buf;
+  if (cachealigned_malloc(stride * variant_ct * sizeof(intptr_t), &batch_buf)) {
+    return kPglRetNomem;
+  }
+  if (cachealigned_malloc(stride * sizeof(intptr_t), &ref_buf)) {
+    aligned_free(batch_buf);
+    return kPglRetNomem;
+  }
+  PglErr reterr = kPglRetSuccess;
+  for (uint32_t variant_idx = 0; variant_idx != variant_ct; ) {
+    uint32_t cur_ct = variant_ct - variant_idx;
+    if (cur_ct > chunk_size) {
+      cur_ct = chunk_size;
+    }
+    if (variant_include) {
+      reterr = PgrGet1Batch(sample_include, batch_pssi, sample_ct, variant_include, nullptr, vidxs[variant_idx], cur_ct, allele_idx, batch_pgrp, stride, &(batch_buf[variant_idx * stride]));
+    } else if (label[0] == 'l') {
+      reterr = PgrGet1Batch(sample_include, batch_pssi, sample_ct, nullptr, &(vidxs[variant_idx]), 0, cur_ct, allele_idx, batch_pgrp, stride, &(batch_buf[variant_idx * stride]));
+    } else {
+      reterr = PgrGet1Batch(sample_include, batch_pssi, sample_ct, nullptr, nullptr, vidxs[variant_idx], cur_ct, allele_idx, batch_pgrp, stride, &(batch_buf[variant_idx * stride]));
+    }
+    if (reterr) {
+      goto CheckSelection_ret_1;
+    }
+    variant_idx += cur_ct;
+  }
+  for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+    const uint32_t vidx = vidxs[variant_idx];
+    reterr = ReadOne(sample_include, ref_pssi, sample_ct, vidx, allele_idx, ref_pgrp, ref_buf);
+    if (reterr) {
+      goto CheckSelection_ret_1;
+    }
+    CompareRow(label, allele_idx, sample_ct, variant_idx, vidx, ref_buf, &(batch_buf[variant_idx * stride]));
+    // Same read on the batch reader, after the batch loader has touched its
+    // LD cache.
+    reterr = ReadOne(sample_include, batch_pssi, sample_ct, vidx, allele_idx, batch_pgrp, &(batch_buf[variant_idx * stride]));
+    if (reterr) {
+      goto CheckSelection_ret_1;
+    }
+    CompareRow(label, allele_idx, sample_ct, variant_idx, vidx, ref_buf, &(batch_buf[variant_idx * stride]));
+  }
+ CheckSelection_ret_1:
+  aligned_free(ref_buf);
+  aligned_free(batch_buf);
+  return reterr;
+}
+
+// Loads all of vidxs in one sample-major PgrGet1BatchTransposed() call (same
+// selection modes as CheckSelection()), and compares each sample row against
+// per-variant reads.
+PglErr CheckTransposed(const char* label, const uintptr_t* sample_include, PgrSampleSubsetIndex batch_pssi, PgrSampleSubsetIndex ref_pssi, uint32_t sample_ct, const uintptr_t* variant_include, const std::vector<uint32_t>& vidxs, uint32_t allele_idx, PgenReader* batch_pgrp, PgenReader* ref_pgrp) {
+  const uint32_t variant_ct = vidxs.size();
+  if (!variant_ct) {
+    return kPglRetSuccess;
+  }
+  const uintptr_t vmaj_stride = NypCtToVecCt(sample_ct) * kWordsPerVec;
+  const uintptr_t smaj_stride = kPglNypTransposeWords * DivUp(variant_ct, kPglNypTransposeBatch);
+  uintptr_t* vmaj_buf;
+  VecW* transpose_buf;
+  uintptr_t* smaj_buf;
+  uintptr_t* ref_buf;
+  if (cachealigned_malloc(vmaj_stride * kPglNypTransposeBatch * sizeof(intptr_t), &vmaj_buf)) {
+    return kPglRetNomem;
+  }
+  if (cachealigned_malloc(kPglNypTransposeBufbytes, &transpose_buf)) {
+    aligned_free(vmaj_buf);
+    return kPglRetNomem;
+  }
+  if (cachealigned_malloc(smaj_stride * RoundUpPow2(sample_ct, 4) * sizeof(intptr_t), &smaj_buf)) {
+    aligned_free(transpose_buf);
+    aligned_free(vmaj_buf);
+    return kPglRetNomem;
+  }
+  if (cachealigned_malloc(vmaj_stride * sizeof(intptr_t), &ref_buf)) {
+    aligned_free(smaj_buf);
+    aligned_free(transpose_buf);
+    aligned_free(vmaj_buf);
+    return kPglRetNomem;
+  }
+  PglErr reterr;
+  if (variant_include) {
+    reterr = PgrGet1BatchTransposed(sample_include, batch_pssi, sample_ct, variant_include, nullptr, vidxs[0], variant_ct, allele_idx, batch_pgrp, vmaj_buf, transpose_buf, smaj_stride, smaj_buf);
+  } else if (label[0] == 'l') {
+    reterr = PgrGet1BatchTransposed(sample_include, batch_pssi, sample_ct, nullptr, &(vidxs[0]), 0, variant_ct, allele_idx, batch_pgrp, vmaj_buf, transpose_buf, smaj_stride, smaj_buf);
+  } else {
+    reterr = PgrGet1BatchTransposed(sample_include, batch_pssi, sample_ct, nullptr, nullptr, vidxs[0], variant_ct, allele_idx, batch_pgrp, vmaj_buf, transpose_buf, smaj_stride, smaj_buf);
+  }
+  if (reterr) {
+    goto CheckTransposed_ret_1;
+  }
+  for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+    const uint32_t vidx = vidxs[variant_idx];
+    reterr = ReadOne(sample_include, ref_pssi, sample_ct, vidx, allele_idx, ref_pgrp, ref_buf);
+    if (reterr) {
+      goto CheckTransposed_ret_1;
+    }
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      if (GetNyparrEntry(ref_buf, sample_idx) != GetNyparrEntry(&(smaj_buf[sample_idx * smaj_stride]), variant_idx)) {
+        if (g_fail_ct < 10) {
+          fprintf(stderr, "%s (transposed), allele_idx %d, sample_ct %u: column %u (variant %u) differs at sample %u\n", label, S_CAST(int32_t, allele_idx), sample_ct, variant_idx, vidx, sample_idx);
+        }
+        ++g_fail_ct;
+        break;
+      }
+    }
+  }
+ CheckTransposed_ret_1:
+  aligned_free(ref_buf);
+  aligned_free(smaj_buf);
+  aligned_free(transpose_buf);
+  aligned_free(vmaj_buf);
+  return reterr;
+}
+
+}  // namespace
+
+int32_t main(int32_t argc, char** argv) {
+  if (argc != 3) {
+    fputs("Usage: pgen_batch_check <.pgen> <.pvar>\n", stderr);
+    return 2;
+  }
+  PglErr reterr = kPglRetSuccess;
+  PgenFileInfo pgfi;
+  Reader readers[2];
+  unsigned char* pgfi_alloc = nullptr;
+  uintptr_t* sample_include_all = nullptr;
+  uintptr_t* sample_include_sub = nullptr;
+  uint32_t* cumulative_popcounts_all = nullptr;
+  uint32_t* cumulative_popcounts_sub = nullptr;
+  uintptr_t* variant_include = nullptr;
+  uintptr_t* allele_idx_offsets = nullptr;
+  FILE* pvarfile = nullptr;
+  PreinitPgfi(&pgfi);
+  for (uint32_t reader_idx = 0; reader_idx != 2; ++reader_idx) {
+    PreinitPgr(&readers[reader_idx].pgr);
+    readers[reader_idx].alloc = nullptr;
+  }
+  {
+    char errstr_buf[kPglErrstrBufBlen];
+    PgenHeaderCtrl header_ctrl;
+    uintptr_t cur_alloc_cacheline_ct;
+    reterr = PgfiInitPhase1(argv[1], UINT32_MAX, UINT32_MAX, 0, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, errstr_buf);
+    if (reterr) {
+      fputs(errstr_buf, stderr);
+      goto main_ret_1;
+    }
+    const uint32_t raw_sample_ct = pgfi.raw_sample_ct;
+    const uint32_t raw_variant_ct = pgfi.raw_variant_ct;
+    if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &pgfi_alloc)) {
+      goto main_ret_NOMEM;
+    }
+    // Allele counts come from the .pvar ALT column, as in plink2.
+    if (cachealigned_malloc((raw_variant_ct + 1) * sizeof(intptr_t), &allele_idx_offsets)) {
+      goto main_ret_NOMEM;
+    }
+    pvarfile = fopen(argv[2], FOPEN_RB);
+    if (!pvarfile) {
+      fprintf(stderr, "Error: Failed to open %s.\n", argv[2]);
+      goto main_ret_OPEN_FAIL;
+    }
+    {
+      char line_buf[4096];
+      uint32_t vidx = 0;
+      uint32_t max_allele_ct = 2;
+      allele_idx_offsets[0] = 0;
+      while (fgets(line_buf, 4096, pvarfile)) {
+        if (line_buf[0] == '#') {
+          continue;
+        }
+        if (vidx == raw_variant_ct) {
+          fputs("Error: .pvar/.pgen variant count mismatch.\n", stderr);
+          goto main_ret_INCONSISTENT_INPUT;
+        }
+        // CHROM POS ID REF ALT
+        const char* alt_start = line_buf;
+        for (uint32_t col_idx = 0; col_idx != 4; ++col_idx) {
+          alt_start = strchr(alt_start, '\t');
+          if (!alt_start) {
+            fputs("Error: Malformed .pvar line.\n", stderr);
+            goto main_ret_INCONSISTENT_INPUT;
+          }
+          ++alt_start;
+        }
+        uint32_t allele_ct = 2;
+        for (const char* alt_iter = alt_start; (*alt_iter != '\t') && (*alt_iter != '\n') && *alt_iter; ++alt_iter) {
+          allele_ct += (*alt_iter == ',');
+        }
+        allele_idx_offsets[vidx + 1] = allele_idx_offsets[vidx] + allele_ct;
+        if (allele_ct > max_allele_ct) {
+          max_allele_ct = allele_ct;
+        }
+        ++vidx;
+      }
+      if (vidx != raw_variant_ct) {
+        fputs("Error: .pvar/.pgen variant count mismatch.\n", stderr);
+        goto main_ret_INCONSISTENT_INPUT;
+      }
+      pgfi.max_allele_ct = max_allele_ct;
+    }
+    pgfi.allele_idx_offsets = allele_idx_offsets;
+    uint32_t max_vrec_width;
+    reterr = PgfiInitPhase2(header_ctrl, 1, 0, 0, 0, raw_variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &cur_alloc_cacheline_ct, errstr_buf);
+    if (reterr) {
+      fputs(errstr_buf, stderr);
+      goto main_ret_1;
+    }
+    for (uint32_t reader_idx = 0; reader_idx != 2; ++reader_idx) {
+      if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &readers[reader_idx].alloc)) {
+        goto main_ret_NOMEM;
+      }
+      reterr = PgrInit(argv[1], max_vrec_width, &pgfi, &readers[reader_idx].pgr, readers[reader_idx].alloc);
+      if (reterr) {
+        fprintf(stderr, "PgrInit error %u\n", S_CAST(uint32_t, reterr));
+        goto main_ret_1;
+      }
+    }
+
+    uint32_t ld_ct = 0;
+    uint32_t ld_inv_ct = 0;
+    std::vector<uint32_t> multiallelic_vidxs;
+    for (uint32_t vidx = 0; vidx != raw_variant_ct; ++vidx) {
+      if (pgfi.vrtypes && VrtypeLdCompressed(pgfi.vrtypes[vidx] & 7)) {
+        ++ld_ct;
+        ld_inv_ct += ((pgfi.vrtypes[vidx] & 7) == 3);
+      }
+      if (pgfi.allele_idx_offsets && (pgfi.allele_idx_offsets[vidx + 1] - pgfi.allele_idx_offsets[vidx] > 2)) {
+        multiallelic_vidxs.push_back(vidx);
+      }
+    }
+    printf("%u variants (%u LD-compressed, %u of those inverted; %u multiallelic), %u samples.\n", raw_variant_ct, ld_ct, ld_inv_ct, S_CAST(uint32_t, multiallelic_vidxs.size()), raw_sample_ct);
+    if ((!ld_inv_ct) || (ld_ct == ld_inv_ct) || multiallelic_vidxs.empty()) {
+      fputs("Error: test input must contain LD-compressed (plain and inverted) and\nmultiallelic variants.\n", stderr);
+      goto main_ret_INCONSISTENT_INPUT;
+    }
+
+    const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    if (cachealigned_malloc(raw_sample_ctl * sizeof(intptr_t), &sample_include_all) ||
+        cachealigned_malloc(raw_sample_ctl * sizeof(intptr_t), &sample_include_sub) ||
+        cachealigned_malloc((raw_sample_ctl + 1) * sizeof(int32_t), &cumulative_popcounts_all) ||
+        cachealigned_malloc((raw_sample_ctl + 1) * sizeof(int32_t), &cumulative_popcounts_sub) ||
+        cachealigned_malloc(raw_variant_ctl * sizeof(intptr_t), &variant_include)) {
+      goto main_ret_NOMEM;
+    }
+    memset(sample_include_all, 0, raw_sample_ctl * sizeof(intptr_t));
+    memset(sample_include_sub, 0, raw_sample_ctl * sizeof(intptr_t));
+    uint32_t sub_sample_ct = 0;
+    for (uint32_t sample_idx = 0; sample_idx != raw_sample_ct; ++sample_idx) {
+      SetBit(sample_idx, sample_include_all);
+      if ((sample_idx % 3) != 1) {
+        SetBit(sample_idx, sample_include_sub);
+        ++sub_sample_ct;
+      }
+    }
+    FillCumulativePopcounts(sample_include_all, raw_sample_ctl, cumulative_popcounts_all);
+    FillCumulativePopcounts(sample_include_sub, raw_sample_ctl, cumulative_popcounts_sub);
+
+    // Contiguous: everything.  List: descending blocks with repeats, so LD
+    // bases are sometimes seen after their dependents.  Bitvector: a
+    // deterministic pseudorandom ~2/3 of the variants, so some LD bases are
+    // skipped.
+    std::vector<uint32_t> contig_vidxs;
+    std::vector<uint32_t> list_vidxs;
+    std::vector<uint32_t> bitvec_vidxs;
+    memset(variant_include, 0, raw_variant_ctl * sizeof(intptr_t));
+    uint32_t lcg = 1;
+    for (uint32_t vidx = 0; vidx != raw_variant_ct; ++vidx) {
+      contig_vidxs.push_back(vidx);
+      lcg = lcg * 1103515245U + 12345;
+      if ((lcg >> 16) % 3) {
+        SetBit(vidx, variant_include);
+        bitvec_vidxs.push_back(vidx);
+      }
+    }
+    for (uint32_t block_start = 0; block_start < raw_variant_ct; block_start += 5) {
+      uint32_t block_end = block_start + 5;
+      if (block_end > raw_variant_ct) {
+        block_end = raw_variant_ct;
+      }
+      for (uint32_t vidx = block_end; vidx != block_start; ) {
+        --vidx;
+        list_vidxs.push_back(vidx);
+      }
+      list_vidxs.push_back(block_start);
+    }
+    const uint32_t biallelic_allele_idxs[3] = {0, 1, UINT32_MAX};
+    const uint32_t chunk_sizes[2] = {7, 0xffffffffU};
+    for (uint32_t subset_idx = 0; subset_idx != 2; ++subset_idx) {
+      const uintptr_t* sample_include = subset_idx? sample_include_sub : sample_include_all;
+      const uint32_t* cumulative_popcounts = subset_idx? cumulative_popcounts_sub : cumulative_popcounts_all;
+      const uint32_t sample_ct = subset_idx? sub_sample_ct : raw_sample_ct;
+      PgrSampleSubsetIndex pssis[2];
+      for (uint32_t reader_idx = 0; reader_idx != 2; ++reader_idx) {
+        PgrSetSampleSubsetIndex(cumulative_popcounts, &readers[reader_idx].pgr, &pssis[reader_idx]);
+      }
+      for (uint32_t chunk_idx = 0; chunk_idx != 2; ++chunk_idx) {
+        const uint32_t chunk_size = chunk_sizes[chunk_idx];
+        for (uint32_t aidx_idx = 0; aidx_idx != 4; ++aidx_idx) {
+          // allele_idx 2 is only meaningful for the multiallelic variants.
+          const uint32_t allele_idx = (aidx_idx == 3)? 2 : biallelic_allele_idxs[aidx_idx];
+          const std::vector<uint32_t>& contig_sel = (aidx_idx == 3)? multiallelic_vidxs : contig_vidxs;
+          reterr = CheckSelection((aidx_idx == 3)? "list (multiallelic)" : "contiguous", sample_include, pssis[0], pssis[1], sample_ct, nullptr, contig_sel, allele_idx, chunk_size, &readers[0].pgr, &readers[1].pgr);
+          if (reterr) {
+            goto main_ret_1;
+          }
+          if (!chunk_idx) {
+            reterr = CheckTransposed((aidx_idx == 3)? "list (multiallelic)" : "contiguous", sample_include, pssis[0], pssis[1], sample_ct, nullptr, contig_sel, allele_idx, &readers[0].pgr, &readers[1].pgr);
+            if (reterr) {
+              goto main_ret_1;
+            }
+          }
+          if (aidx_idx == 3) {
+            continue;
+          }
+          reterr = CheckSelection("list", sample_include, pssis[0], pssis[1], sample_ct, nullptr, list_vidxs, allele_idx, chunk_size, &readers[0].pgr, &readers[1].pgr);
+          if (reterr) {
+            goto main_ret_1;
+          }
+          reterr = CheckSelection("bitvector", sample_include, pssis[0], pssis[1], sample_ct, variant_include, bitvec_vidxs, allele_idx, chunk_size, &readers[0].pgr, &readers[1].pgr);
+          if (reterr) {
+            goto main_ret_1;
+          }
+          if (!chunk_idx) {
+            reterr = CheckTransposed("list", sample_include, pssis[0], pssis[1], sample_ct, nullptr, list_vidxs, allele_idx, &readers[0].pgr, &readers[1].pgr);
+            if (reterr) {
+              goto main_ret_1;
+            }
+            reterr = CheckTransposed("bitvector", sample_include, pssis[0], pssis[1], sample_ct, variant_include, bitvec_vidxs, allele_idx, &readers[0].pgr, &readers[1].pgr);
+            if (reterr) {
+              goto main_ret_1;
+            }
+          }
+        }
+      }
+    }
+    if (g_fail_ct) {
+      fprintf(stderr, "%u mismatched rows.\n", g_fail_ct);
+      goto main_ret_INCONSISTENT_INPUT;
+    }
+    printf("PgrGet1Batch() and PgrGet1BatchTransposed() output matches per-variant reads.\n");
+  }
+  while (0) {
+  main_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  main_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  main_ret_INCONSISTENT_INPUT:
+    reterr = kPglRetInconsistentInput;
+    break;
+  }
+ main_ret_1:
+  if (pvarfile) {
+    fclose(pvarfile);
+  }
+  for (uint32_t reader_idx = 0; reader_idx != 2; ++reader_idx) {
+    CleanupPgr(&readers[reader_idx].pgr, &reterr);
+    aligned_free_cond(readers[reader_idx].alloc);
+  }
+  CleanupPgfi(&pgfi, &reterr);
+  aligned_free_cond(pgfi_alloc);
+  aligned_free_cond(sample_include_all);
+  aligned_free_cond(sample_include_sub);
+  aligned_free_cond(cumulative_popcounts_all);
+  aligned_free_cond(cumulative_popcounts_sub);
+  aligned_free_cond(variant_include);
+  aligned_free_cond(allele_idx_offsets);
+  return S_CAST(int32_t, reterr);
+}
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Variants come in runs of near-identical genotype rows, so --make-pgen
+# LD-compresses most of them; the last quarter of each run is flipped, so the
+# inverted-LD record type shows up too.  Every 37th variant is triallelic.
+awk 'BEGIN {
+    srand(1);
+    sample_ct = 300;
+    printf "##fileformat=VCFv4.2\n##contig=<ID=1>\n##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT";
+    for (s = 0; s < sample_ct; ++s) {
+        printf "\ts%d", s;
+    }
+    printf "\n";
+    for (v = 0; v < 4000; ++v) {
+        if (v % 40 == 0) {
+            for (s = 0; s < sample_ct; ++s) {
+                base[s] = int(rand() * 3);
+            }
+        }
+        multi = (v % 37 == 5);
+        printf "1\t%d\tv%d\tA\t%s\t.\t.\t.\tGT", v + 1, v, multi? "C,G" : "C";
+        for (s = 0; s < sample_ct; ++s) {
+            g = (v % 40 < 30)? base[s] : 2 - base[s];
+            r = rand();
+            if (r < 0.02) {
+                g = int(rand() * 3);
+            }
+            if (r > 0.995) {
+                gt = "./.";
+            } else if (multi && (rand() < 0.2)) {
+                gt = (g == 0)? "0/2" : ((g == 1)? "1/2" : "2/2");
+            } else {
+                gt = (g == 0)? "0/0" : ((g == 1)? "0/1" : "1/1");
+            }
+            printf "\t%s", gt;
+        }
+        printf "\n";
+    }
+}' > tmp_data.vcf
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+
+SRC="../../include/plink2_base.cc ../../include/plink2_bits.cc ../../include/pgenlib_misc.cc ../../include/pgenlib_read.cc"
+${CXX:-g++} -O2 -std=c++14 -DNO_PGEN_ZSTD -o tmp_pgen_batch_check pgen_batch_check.cc $SRC -lpthread
+./tmp_pgen_batch_check tmp_data.pgen tmp_data.pvar
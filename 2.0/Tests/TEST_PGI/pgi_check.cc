@@ -0,0 +1,198 @@
+// Opens a variable-width .pgen four ways: {flat, compact
+// (PgfiEnableCompactFpos())} record-offset table x {PgfiInitPhase2(), .pgi via
+// PgfiInitPhase2Pgi() with PgfiInitPhase2() fallback}.  Checks that the .pgi
+// was used or skipped as expected, that the compact table is only in effect
+// when the .pgi wasn't used, and that every variant decodes identically (in
+// sequential and random order) to the flat, index-free open.
+//
+// Usage: pgi_check <.pgen> <.pgi> <used | skipped>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/pgenlib_read.h"
+
+#ifdef __cplusplus
+using namespace plink2;
+#endif
+
+typedef struct CheckReaderStruct {
+  PgenFileInfo pgfi;
+  PgenReader pgr;
+  unsigned char* pgfi_alloc;
+  unsigned char* pgr_alloc;
+  uintptr_t* nonref_flags;
+} CheckReader;
+
+// *pgi_used_ptr is set to 1 iff pgi_fname was non-null and the index was
+// accepted.
+static int32_t OpenCheckReader(const char* fname, const char* pgi_fname, uint32_t compact_fpos, CheckReader* crp, uint32_t* pgi_used_ptr) {
+  char errstr_buf[kPglErrstrBufBlen];
+  PreinitPgfi(&crp->pgfi);
+  PreinitPgr(&crp->pgr);
+  crp->pgfi_alloc = nullptr;
+  crp->pgr_alloc = nullptr;
+  crp->nonref_flags = nullptr;
+  *pgi_used_ptr = 0;
+  PgenHeaderCtrl header_ctrl;
+  uintptr_t cacheline_ct;
+  if (PgfiInitPhase1(fname, UINT32_MAX, UINT32_MAX, 0, &header_ctrl, &crp->pgfi, &cacheline_ct, errstr_buf)) {
+    fputs(errstr_buf, stderr);
+    return 1;
+  }
+  if (compact_fpos) {
+    PgfiEnableCompactFpos(header_ctrl, &crp->pgfi, &cacheline_ct);
+  }
+  if ((header_ctrl >> 6) == 3) {
+    if (cachealigned_malloc(BitCtToWordCt(crp->pgfi.raw_variant_ct) * sizeof(intptr_t), &crp->nonref_flags)) {
+      fputs("Out of memory.\n", stderr);
+      return 1;
+    }
+    crp->pgfi.nonref_flags = crp->nonref_flags;
+  }
+  if (header_ctrl & 0x30) {
+    fputs("Error: pgi_check doesn't support .pgen files with stored allele counts.\n", stderr);
+    return 1;
+  }
+  uint32_t max_vrec_width;
+  uintptr_t pgr_cacheline_ct;
+  PglErr reterr = kPglRetSkipped;
+  if (pgi_fname) {
+    reterr = PgfiInitPhase2Pgi(fname, pgi_fname, header_ctrl, 0, 0, 0, &max_vrec_width, &crp->pgfi, &pgr_cacheline_ct, errstr_buf);
+    if (reterr == kPglRetSkipped) {
+      // Expected warning for a stale/truncated index; surface it so the
+      // calling script can check it.
+      fputs(errstr_buf, stdout);
+    } else if (reterr) {
+      fputs(errstr_buf, stderr);
+      return 1;
+    } else {
+      *pgi_used_ptr = 1;
+    }
+  }
+  if (reterr == kPglRetSkipped) {
+    if (cacheline_ct && cachealigned_malloc(cacheline_ct * kCacheline, &crp->pgfi_alloc)) {
+      fputs("Out of memory.\n", stderr);
+      return 1;
+    }
+    if (PgfiInitPhase2(header_ctrl, 0, 0, 0, 0, crp->pgfi.raw_variant_ct, &max_vrec_width, &crp->pgfi, crp->pgfi_alloc, &pgr_cacheline_ct, errstr_buf)) {
+      fputs(errstr_buf, stderr);
+      return 1;
+    }
+  }
+  if (cachealigned_malloc(pgr_cacheline_ct * kCacheline, &crp->pgr_alloc)) {
+    fputs("Out of memory.\n", stderr);
+    return 1;
+  }
+  if (PgrInit(fname, max_vrec_width, &crp->pgfi, &crp->pgr, crp->pgr_alloc)) {
+    fprintf(stderr, "Error: PgrInit() failed on %s.\n", fname);
+    return 1;
+  }
+  return 0;
+}
+
+static void CloseCheckReader(CheckReader* crp) {
+  PglErr reterr = kPglRetSuccess;
+  CleanupPgr(&crp->pgr, &reterr);
+  CleanupPgfi(&crp->pgfi, &reterr);
+  aligned_free_cond(crp->pgr_alloc);
+  aligned_free_cond(crp->pgfi_alloc);
+  aligned_free_cond(crp->nonref_flags);
+}
+
+// Decodes variant vidx from both readers and compares.
+static int32_t CompareVariant(uint32_t vidx, uint32_t sample_ct, CheckReader* ref_crp, CheckReader* crp, uintptr_t* ref_genovec, uintptr_t* genovec) {
+  PgrSampleSubsetIndex null_pssi;
+  PgrClearSampleSubsetIndex(&ref_crp->pgr, &null_pssi);
+  if (PgrGet(nullptr, null_pssi, sample_ct, vidx, &ref_crp->pgr, ref_genovec)) {
+    fprintf(stderr, "Error: Reference read of variant %u failed.\n", vidx);
+    return 1;
+  }
+  PgrClearSampleSubsetIndex(&crp->pgr, &null_pssi);
+  if (PgrGet(nullptr, null_pssi, sample_ct, vidx, &crp->pgr, genovec)) {
+    fprintf(stderr, "Error: Read of variant %u failed.\n", vidx);
+    return 1;
+  }
+  const uint32_t word_ct = NypCtToWordCt(sample_ct);
+  ZeroTrailingNyps(sample_ct, ref_genovec);
+  ZeroTrailingNyps(sample_ct, genovec);
+  if (!memequal(ref_genovec, genovec, word_ct * sizeof(intptr_t))) {
+    fprintf(stderr, "Error: Variant %u decodes differently.\n", vidx);
+    return 1;
+  }
+  return 0;
+}
+
+int32_t main(int32_t argc, char** argv) {
+  if ((argc != 4) || (strcmp(argv[3], "used") && strcmp(argv[3], "skipped"))) {
+    fputs("Usage: pgi_check <.pgen> <.pgi> <used | skipped>\n", stderr);
+    return 2;
+  }
+  const char* fname = argv[1];
+  const char* pgi_fname = argv[2];
+  const uint32_t pgi_expected = !strcmp(argv[3], "used");
+  CheckReader ref;
+  uint32_t pgi_used;
+  if (OpenCheckReader(fname, nullptr, 0, &ref, &pgi_used)) {
+    return 1;
+  }
+  const uint32_t raw_variant_ct = ref.pgfi.raw_variant_ct;
+  const uint32_t sample_ct = ref.pgfi.raw_sample_ct;
+  if (ref.pgfi.const_vrec_width) {
+    fputs("Error: pgi_check requires a variable-width .pgen.\n", stderr);
+    return 1;
+  }
+  uintptr_t* ref_genovec;
+  uintptr_t* genovec;
+  if (cachealigned_malloc(NypCtToVecCt(sample_ct) * kBytesPerVec, &ref_genovec) ||
+      cachealigned_malloc(NypCtToVecCt(sample_ct) * kBytesPerVec, &genovec)) {
+    fputs("Out of memory.\n", stderr);
+    return 1;
+  }
+  int32_t retval = 0;
+  for (uint32_t mode_idx = 0; mode_idx != 4; ++mode_idx) {
+    const uint32_t compact_fpos = mode_idx & 1;
+    const char* cur_pgi_fname = (mode_idx & 2)? pgi_fname : nullptr;
+    CheckReader cur;
+    if (OpenCheckReader(fname, cur_pgi_fname, compact_fpos, &cur, &pgi_used)) {
+      retval = 1;
+      break;
+    }
+    const char* mode_str = compact_fpos? "compact" : "flat";
+    if (cur_pgi_fname && (pgi_used != pgi_expected)) {
+      fprintf(stderr, "Error: .pgi %s with %s record-offset table, expected it to be %s.\n", pgi_used? "used" : "skipped", mode_str, argv[3]);
+      retval = 1;
+    }
+    // The mapped index always supplies a flat var_fpos[]; the compact table
+    // only applies to the PgfiInitPhase2() path.
+    const uint32_t compact_expected = compact_fpos && (!pgi_used);
+    if (compact_expected != (cur.pgfi.fpos_bases != nullptr)) {
+      fprintf(stderr, "Error: Unexpected record-offset representation (%s requested, .pgi %s).\n", mode_str, pgi_used? "used" : "not used");
+      retval = 1;
+    }
+    for (uint32_t vidx = 0; (!retval) && (vidx != raw_variant_ct); ++vidx) {
+      retval = CompareVariant(vidx, sample_ct, &ref, &cur, ref_genovec, genovec);
+    }
+    uint64_t rng_state = 0x9e3779b97f4a7c15LLU;
+    for (uint32_t read_idx = 0; (!retval) && (read_idx != 20000); ++read_idx) {
+      // xorshift64*
+      rng_state ^= rng_state >> 12;
+      rng_state ^= rng_state << 25;
+      rng_state ^= rng_state >> 27;
+      const uint32_t vidx = (rng_state * 0x2545f4914f6cdd1dLLU) % raw_variant_ct;
+      retval = CompareVariant(vidx, sample_ct, &ref, &cur, ref_genovec, genovec);
+    }
+    if (!retval) {
+      printf("%s record-offset table, %s: %u variants match.\n", mode_str, cur_pgi_fname? (pgi_used? ".pgi used" : ".pgi skipped") : "no .pgi", raw_variant_ct);
+    }
+    CloseCheckReader(&cur);
+    if (retval) {
+      break;
+    }
+  }
+  aligned_free(genovec);
+  aligned_free(ref_genovec);
+  CloseCheckReader(&ref);
+  return retval;
+}
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# 2 vblocks plus a partial third, so the vblock-offset cross-check covers more
+# than one entry.
+$1/plink2 $2 $3 --dummy 60 140000 0.1 --make-pgen pgi --out tmp_data
+test -s tmp_data.pgen.pgi
+cp tmp_data.pgen.pgi tmp_data_modifier.pgi
+rm tmp_data.pgen.pgi
+$1/plink2 $2 $3 --pfile tmp_data --make-pgi --out tmp_data_mkpgi
+cmp tmp_data.pgen.pgi tmp_data_modifier.pgi
+cp tmp_data.pgen.pgi tmp_data_good.pgi
+
+# Outputs must not depend on whether (or which) .pgi was found: one
+# sequential pass and one filtered (sparse) pass per state.
+awk 'NR % 7 == 3 {print $3}' tmp_data.pvar > tmp_extract.txt
+run_state() {
+    $1/plink2 $2 $3 --pfile tmp_data --freq --make-bed --out tmp_$4
+    $1/plink2 $2 $3 --pfile tmp_data --extract tmp_extract.txt --thin 0.5 --seed 1 --make-bed --out tmp_$4_sub
+}
+
+rm tmp_data.pgen.pgi
+run_state "$1" "$2" "$3" noidx
+if grep -q "\.pgi" tmp_noidx.log; then
+    exit 1
+fi
+
+cp tmp_data_good.pgi tmp_data.pgen.pgi
+run_state "$1" "$2" "$3" idx
+if grep -q "Warning: Ignoring" tmp_idx.log; then
+    exit 1
+fi
+
+# Stale: .pgen mtime no longer matches.
+touch -d "2001-01-01 00:00:00" tmp_data.pgen
+run_state "$1" "$2" "$3" stale
+grep -q "out of date" tmp_stale.log
+# Rebuilding the index makes it current again.
+$1/plink2 $2 $3 --pfile tmp_data --make-pgi --out tmp_data_mkpgi
+cp tmp_data.pgen.pgi tmp_data_good.pgi
+
+# Truncated index.
+head -c 4000 tmp_data_good.pgi > tmp_data.pgen.pgi
+run_state "$1" "$2" "$3" trunc
+grep -q "wrong size" tmp_trunc.log
+
+for s in idx stale trunc; do
+    cmp tmp_noidx.afreq tmp_$s.afreq
+    for ext in bed bim fam; do
+        cmp tmp_noidx.$ext tmp_$s.$ext
+        cmp tmp_noidx_sub.$ext tmp_${s}_sub.$ext
+    done
+done
+
+# Library-level check, including the compact record-offset table: plink2 only
+# switches to it when var_fpos[] would take more than 1/8 of the workspace,
+# which a test-sized dataset can't trigger.
+SRC="../../include/plink2_base.cc ../../include/plink2_bits.cc ../../include/pgenlib_misc.cc ../../include/pgenlib_read.cc"
+${CXX:-g++} -O2 -std=c++14 -DNO_PGEN_ZSTD -o tmp_pgi_check pgi_check.cc $SRC -lpthread
+./tmp_pgi_check tmp_data.pgen tmp_data_good.pgi used
+./tmp_pgi_check tmp_data.pgen tmp_data.pgen.pgi skipped > tmp_check_trunc.txt
+grep -q "wrong size" tmp_check_trunc.txt
+touch -d "2002-02-02 00:00:00" tmp_data.pgen
+./tmp_pgi_check tmp_data.pgen tmp_data_good.pgi skipped > tmp_check_stale.txt
+grep -q "out of date" tmp_check_stale.txt
@@ -0,0 +1,91 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# A .pvar loaded from its binary cache must produce the same results as a
+# parse of the text.  Include a ##chrSet line, nonstandard contigs,
+# multiallelic variants, QUAL/FILTER/INFO, and a .bim with centimorgans.
+awk 'BEGIN {
+  srand(11);
+  OFS = "\t";
+  print "##chrSet=<autosomePairCt=25,Y>";
+  print "##INFO=<ID=AF,Number=A,Type=Float,Description=\"Allele frequency\">";
+  print "#CHROM", "POS", "ID", "REF", "ALT", "QUAL", "FILTER", "INFO";
+  split("A C G T AT GCC", alleles, " ");
+  n = split("1 2 contigA 3 contigB", chrs, " ");
+  for (c = 1; c <= n; ++c) {
+    for (i = 1; i <= 20000; ++i) {
+      ref = alleles[int(rand() * 6) + 1];
+      alt = alleles[int(rand() * 4) + 1];
+      if (rand() < 0.1) {
+        alt = alt ",TTT";
+      }
+      qual = (rand() < 0.3)? "." : int(rand() * 100);
+      filter = (rand() < 0.5)? "PASS" : ((rand() < 0.5)? "." : "q10;lowDP");
+      id = (rand() < 0.2)? "." : ("rs" c "_" i);
+      print chrs[c], i * 10, id, ref, alt, qual, filter, "AF=0." int(rand() * 99);
+    }
+  }
+}' > tmp_data.pvar
+awk 'BEGIN {OFS = "\t"; for (c = 1; c <= 3; ++c) for (i = 1; i <= 3000; ++i) print c, "v" c "_" i, (i % 2)? 0 : i / 1000.0, i * 7, "A", (i % 3)? "G" : "AT"}' > tmp_data.bim
+
+idx=0
+for cols in "" "cols=xheader,qual,filter,info" "cols=+cm"; do
+    $1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --make-just-pvar $cols --out tmp_ref$idx
+    idx=$((idx + 1))
+done
+
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --make-pvar-cache --out tmp_make
+test -s tmp_data.pvar.pvc
+
+idx=0
+for cols in "" "cols=xheader,qual,filter,info" "cols=+cm"; do
+    $1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --make-just-pvar $cols --out tmp_out
+    grep -q "Using binary .pvar cache" tmp_out.log
+    cmp tmp_out.pvar tmp_ref$idx.pvar
+    idx=$((idx + 1))
+
+    rm -f tmp_data.bim.pvc
+    $1/plink2 $2 $3 --bim tmp_data.bim --make-just-pvar $cols --out tmp_ref
+    $1/plink2 $2 $3 --bim tmp_data.bim --make-just-pvar $cols --pvar-cache --out tmp_out
+    grep -q "Binary .pvar cache written" tmp_out.log
+    $1/plink2 $2 $3 --bim tmp_data.bim --make-just-pvar $cols --out tmp_out
+    grep -q "Using binary .pvar cache" tmp_out.log
+    cmp tmp_out.pvar tmp_ref.pvar
+done
+
+# Load-time filters bypass the cache.
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --chr 2 --snps-only --make-just-pvar --out tmp_out
+if grep -q "Using binary .pvar cache" tmp_out.log; then
+    exit 1
+fi
+
+# A modified .pvar invalidates the cache.
+touch tmp_data.pvar
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --make-just-pvar --out tmp_out
+grep -q "out of date" tmp_out.log
+if grep -q "Using binary .pvar cache" tmp_out.log; then
+    exit 1
+fi
+
+# Post-load filtering modifies the mapped arrays in place; the cache file
+# itself must be untouched.
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --make-pvar-cache --out tmp_make
+mv tmp_data.pvar.pvc tmp_pvc_copy
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --thin-count 5000 --seed 3 --make-just-pvar --out tmp_ref
+cp tmp_pvc_copy tmp_data.pvar.pvc
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --thin-count 5000 --seed 3 --make-just-pvar --out tmp_out
+grep -q "Using binary .pvar cache" tmp_out.log
+cmp tmp_out.pvar tmp_ref.pvar
+cmp tmp_data.pvar.pvc tmp_pvc_copy
+
+# The whole-file checksum is only checked under --pvar-cache verify.  (Bytes
+# 36..39 hold the stored checksum.)
+printf '\xff\xff\xff\xff' | dd of=tmp_data.pvar.pvc bs=1 seek=36 conv=notrunc
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --make-just-pvar --out tmp_out
+grep -q "Using binary .pvar cache" tmp_out.log
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --pvar-cache verify --make-just-pvar --out tmp_out
+grep -q "checksum does not match" tmp_out.log
+grep -q "Binary .pvar cache written" tmp_out.log
+$1/plink2 $2 $3 --pvar tmp_data.pvar --allow-extra-chr --pvar-cache verify --make-just-pvar --out tmp_out
+grep -q "Using binary .pvar cache" tmp_out.log
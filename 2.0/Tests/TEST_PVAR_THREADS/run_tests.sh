@@ -0,0 +1,59 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# .pvar lines are lexed by worker threads; the loaded variant set must not
+# depend on the thread count.  Mix in multiallelic variants, QUAL/FILTER/INFO
+# filters, leading whitespace, and runs of very short lines (which overflow
+# the per-chunk line capacity and fall back to main-thread lexing).
+awk 'BEGIN {
+  srand(7);
+  OFS = "\t";
+  print "##INFO=<ID=AF,Number=A,Type=Float,Description=\"Allele frequency\">";
+  print "#CHROM", "POS", "ID", "REF", "ALT", "QUAL", "FILTER", "INFO";
+  split("A C G T AT GCC", alleles, " ");
+  for (chr = 1; chr <= 4; ++chr) {
+    for (i = 1; i <= 40000; ++i) {
+      ref = alleles[int(rand() * 6) + 1];
+      alt = alleles[int(rand() * 4) + 1];
+      if (rand() < 0.1) {
+        alt = alt ",TTT";
+      }
+      qual = (rand() < 0.3)? "." : int(rand() * 100);
+      filter = (rand() < 0.5)? "PASS" : ((rand() < 0.5)? "." : "q10;lowDP");
+      pad = "";
+      for (k = int(rand() * 8); k; --k) {
+        pad = pad "XYZW";
+      }
+      id = (rand() < 0.2)? "." : ("rs" chr "_" i);
+      lead = (i % 13)? "" : "  ";
+      print lead chr, i * 10, id, ref, alt, qual, filter, "AF=0." int(rand() * 99) ";DESC=" pad;
+    }
+  }
+}' > tmp_data.pvar
+awk 'BEGIN {OFS = "\t"; print "#CHROM", "POS", "ID", "REF", "ALT"; for (i = 1; i <= 150000; ++i) print "5", i, ".", "A", "C"}' > tmp_short.pvar
+
+$1/plink2 $2 $3 --pvar tmp_data.pvar --make-just-pvar zs --out tmp_data_zs
+
+for flags in "" "--chr 2,4" "--snps-only just-acgt --var-min-qual 20" "--var-filter q10 --max-alleles 2" "--set-all-var-ids @:#:\$r:\$a --new-id-max-allele-len 2 truncate" "--extract-if-info AF > 0.5"; do
+    for input in tmp_data.pvar tmp_data_zs.pvar.zst; do
+        $1/plink2 $2 $3 --pvar $input $flags --make-just-pvar --threads 1 --out tmp_ref
+        for t in 2 5; do
+            $1/plink2 $2 $3 --pvar $input $flags --make-just-pvar --threads $t --out tmp_out
+            cmp tmp_out.pvar tmp_ref.pvar
+        done
+    done
+done
+
+$1/plink2 $2 $3 --pvar tmp_short.pvar --make-just-pvar --threads 1 --out tmp_ref
+$1/plink2 $2 $3 --pvar tmp_short.pvar --make-just-pvar --threads 3 --out tmp_out
+cmp tmp_out.pvar tmp_ref.pvar
+
+# Errors must still point at the right line.
+awk '(NR == 90003) {print "3\t5"; next} {print}' tmp_data.pvar > tmp_bad.pvar
+for t in 1 4; do
+    if $1/plink2 $2 $3 --pvar tmp_bad.pvar --make-just-pvar --threads $t --out tmp_bad; then
+        exit 1
+    fi
+    grep -q "Line 90003 of tmp_bad.pvar has fewer tokens than expected" tmp_bad.log
+done
@@ -0,0 +1,20 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 20 5000 --out tmp_data
+
+# No trailing newline, and exactly one page long, so the appended '\n' lands
+# in the guard page.
+awk 'NR > 1 && NR % 7 == 0 {print $3}' tmp_data.pvar > tmp_ids.txt
+head -c 4096 tmp_ids.txt > tmp_page_nolf.txt
+# Plain file with CRLF line endings and blank lines, and a gzipped one, so
+# --extract retargets between the mmap and reader-thread backends.
+awk 'NR > 1 && NR % 5 == 0 {printf "%s\r\n\n", $3}' tmp_data.pvar > tmp_crlf.txt
+awk 'NR > 1 && NR % 11 == 0 {print $3}' tmp_data.pvar | gzip > tmp_gz.txt.gz
+
+for f in "tmp_page_nolf.txt" "tmp_crlf.txt" "tmp_page_nolf.txt tmp_gz.txt.gz tmp_crlf.txt"; do
+    $1/plink2 $2 $3 --pfile tmp_data --extract $f --write-snplist --out tmp_mmap
+    $1/plink2 $2 $3 --pfile tmp_data --extract $f --write-snplist --no-text-mmap --out tmp_thread
+    cmp tmp_mmap.snplist tmp_thread.snplist
+done
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Work-stealing tasks hand variants/rows to threads in no particular order;
+# results must not depend on the thread count.
+$1/plink2 $2 $3 --dummy 600 3000 0.05 acgt --seed 5 --out tmp_data
+# Make every fifth variant triallelic.
+$1/plink2 $2 $3 --pfile tmp_data --export vcf --out tmp_data
+awk 'BEGIN {OFS="\t"} /^#/ {print; next} (NR % 5 == 0) {$5 = $5 ",T"; for (i = 10; i <= NF; i += 3) {if ($i == "1/1") $i = "2/2"; else if ($i == "0/1") $i = "0/2"}} {print}' tmp_data.vcf > tmp_multi.vcf
+$1/plink2 $2 $3 --vcf tmp_multi.vcf --make-pgen --out tmp_multi
+cut -f 1,3 tmp_data.psam | sed '1s/.*/#IID\tPHENO1/' > tmp_pheno.txt
+
+$1/plink2 $2 $3 --pfile tmp_multi --pheno tmp_pheno.txt --glm allow-no-covars firth-fallback --threads 1 --out tmp_ref
+$1/plink2 $2 $3 --pfile tmp_multi --make-king-table counts --make-king square --threads 1 --out tmp_ref
+for t in 2 5; do
+    $1/plink2 $2 $3 --pfile tmp_multi --pheno tmp_pheno.txt --glm allow-no-covars firth-fallback --threads $t --out tmp_out
+    cmp tmp_out.PHENO1.glm.logistic.hybrid tmp_ref.PHENO1.glm.logistic.hybrid
+    $1/plink2 $2 $3 --pfile tmp_multi --make-king-table counts --make-king square --threads $t --out tmp_out
+    cmp tmp_out.kin0 tmp_ref.kin0
+    cmp tmp_out.king tmp_ref.king
+done
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 333 4321 0.05 dosage-freq=0.1 --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --make-pgen vsum --out tmp_vsum
+$1/plink2 $2 $3 --pfile tmp_data --sort-vars --make-pgen vsum --out tmp_vsum_sorted
+
+# Counts derived from the .vsum sidecar must match a full decode.
+for f in tmp_vsum tmp_vsum_sorted; do
+    $1/plink2 $2 $3 --pfile $f --freq --missing --hardy --geno-counts --out ${f}_with
+    mv $f.pgen.vsum $f.pgen.vsum.bak
+    $1/plink2 $2 $3 --pfile $f --freq --missing --hardy --geno-counts --out ${f}_without
+    mv $f.pgen.vsum.bak $f.pgen.vsum
+    diff -q ${f}_with.afreq ${f}_without.afreq
+    diff -q ${f}_with.vmiss ${f}_without.vmiss
+    diff -q ${f}_with.hardy ${f}_without.hardy
+    diff -q ${f}_with.gcount ${f}_without.gcount
+done
+
+# Stale sidecar must be ignored.
+touch -d '+1 minute' tmp_vsum.pgen
+$1/plink2 $2 $3 --pfile tmp_vsum --freq --out tmp_vsum_stale
+grep -q "out of date" tmp_vsum_stale.log
+diff -q tmp_vsum_stale.afreq tmp_vsum_without.afreq
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# More than two 4096-variant frames, with a partial last frame.
+$1/plink2 $2 $3 --dummy 300 9500 0.05 dosage-freq=0.1 --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --make-pgen --out tmp_plain
+$1/plink2 $2 $3 --pfile tmp_data --make-pgen pzs pgi vsum --out tmp_z
+$1/plink2 $2 $3 --pfile tmp_data --sort-vars --make-pgen pzs --out tmp_z_sorted
+$1/plink2 $2 $3 --pfile tmp_data --threads 1 --make-pgen pzs ld-search --out tmp_z_st
+
+# Compression must round-trip exactly.
+$1/plink2 $2 $3 --pfile tmp_z --make-pgen --out tmp_back
+cmp tmp_plain.pgen tmp_back.pgen
+
+$1/plink2 $2 $3 --pfile tmp_data --export A --out tmp_data
+for f in tmp_z tmp_z_sorted tmp_z_st; do
+    $1/plink2 $2 $3 --pfile $f --export A --out $f
+    diff -q tmp_data.raw $f.raw
+done
+$1/plink2 $2 $3 --pfile tmp_z --pgen-io-threads 2 --export A --out tmp_z_io
+diff -q tmp_data.raw tmp_z_io.raw
+
+# Random access across frame boundaries.
+awk 'NR > 1 && (NR % 97 == 3 || NR == 4097 || NR == 4098 || NR == 9501) {print $3}' tmp_data.pvar > tmp_extract.txt
+$1/plink2 $2 $3 --pfile tmp_data --extract tmp_extract.txt --export A --out tmp_data_sub
+$1/plink2 $2 $3 --pfile tmp_z --extract tmp_extract.txt --export A --out tmp_z_sub
+diff -q tmp_data_sub.raw tmp_z_sub.raw
+$1/plink2 $2 $3 --pfile tmp_data --freq --missing --hardy --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_z --freq --missing --hardy --out tmp_z
+for ext in afreq vmiss smiss hardy; do
+    diff -q tmp_data.$ext tmp_z.$ext
+done
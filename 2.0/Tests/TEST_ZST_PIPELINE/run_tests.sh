@@ -0,0 +1,23 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Large enough for the .pvar.zst to span several frames.
+$1/plink2 $2 $3 --dummy 8 600000 --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --freq --out tmp_plain
+
+for p in "" "1" "3 1"; do
+    $1/plink2 $2 $3 --pfile tmp_data --make-just-pvar zs --freq zs --zst-pipeline $p --out tmp_pipe
+    $1/plink2 $2 $3 --zst-decompress tmp_pipe.pvar.zst | cmp - tmp_data.pvar
+    $1/plink2 $2 $3 --zst-decompress tmp_pipe.afreq.zst | cmp - tmp_plain.afreq
+    # Seek table footer must be present, so that readers can decompress the
+    # frames in parallel.
+    test "$(tail -c 4 tmp_pipe.pvar.zst | od -An -tx4 | tr -d ' ')" = "8f92eab1"
+    $1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar tmp_pipe.pvar.zst --threads 4 --freq --out tmp_zst
+    cmp tmp_plain.afreq tmp_zst.afreq
+    test "$(grep -c '^--zst-pipeline: ' tmp_pipe.log)" = "2"
+done
+
+# Output smaller than one frame.
+$1/plink2 $2 $3 --pfile tmp_data --chr 1 --from-bp 0 --to-bp 9 --make-just-pvar zs --zst-pipeline --out tmp_small
+$1/plink2 $2 $3 --zst-decompress tmp_small.pvar.zst | cmp - <(head -n 11 tmp_data.pvar)
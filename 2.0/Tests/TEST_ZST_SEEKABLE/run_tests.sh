@@ -0,0 +1,27 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Large enough for the .pvar.zst to span several 4 MiB frames.
+$1/plink2 $2 $3 --dummy 8 600000 --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --make-just-pvar zs --out tmp_z
+
+# Seek table footer must be present.
+test "$(tail -c 4 tmp_z.pvar.zst | od -An -tx4 | tr -d ' ')" = "8f92eab1"
+$1/plink2 $2 $3 --zst-decompress tmp_z.pvar.zst > tmp_z.pvar
+cmp tmp_z.pvar tmp_data.pvar
+if command -v zstd > /dev/null; then
+    zstd -dc tmp_z.pvar.zst | cmp - tmp_data.pvar
+    # Trailing frame after the seek table; must fall back to the
+    # single-threaded decoder.
+    head -n 1 tmp_data.pvar | zstd -c > tmp_hdr.zst
+    cat tmp_hdr.zst tmp_z.pvar.zst > tmp_cat.pvar.zst
+    $1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar tmp_cat.pvar.zst --threads 4 --freq --out tmp_cat && exit 1
+    grep -q "starts with a '#'" tmp_cat.log
+fi
+
+$1/plink2 $2 $3 --pfile tmp_data --freq --out tmp_plain
+for t in 1 4; do
+    $1/plink2 $2 $3 --pgen tmp_data.pgen --psam tmp_data.psam --pvar tmp_z.pvar.zst --threads $t --freq --out tmp_zst$t
+    cmp tmp_plain.afreq tmp_zst$t.afreq
+done
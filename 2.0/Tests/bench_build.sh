@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# Sourced by the BENCH_* scripts that compile a standalone benchmark program
+# against the library sources.  Binaries go to a temporary directory that is
+# removed when the calling script exits.
+#
+#   bench_build <name> <extra flags> <main .cc> [library .cc...]
+#     Builds $BENCH_BIN_DIR/<name> with $CXX $CXXFLAGS <extra flags>.
+#   bench_detect_tiers [avx512]
+#     Sets BENCH_TIERS to the instruction-set tiers this machine supports
+#     (sse42, avx2, and optionally avx512 VPOPCNTDQ); the matching compiler
+#     flags are in BENCH_FLAGS_<tier>.
+#   bench_build_tiers <name> <main .cc> [library .cc...]
+#     bench_build once per tier, as <name>_<tier>.
+#   bench_run_tiers <name> [args...]
+#     Runs each tier's binary, keeping only the first tier's header line.
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-O2 -std=c++14 -DNDEBUG"}
+PGENLIB_READ_SRC="../../include/plink2_base.cc ../../include/plink2_bits.cc ../../include/pgenlib_misc.cc ../../include/pgenlib_read.cc"
+STRING_SRC="../../include/plink2_base.cc ../../include/plink2_string.cc"
+
+BENCH_BIN_DIR=$(mktemp -d "${TMPDIR:-/tmp}/plink2_bench.XXXXXX")
+trap 'rm -rf "$BENCH_BIN_DIR"' EXIT
+
+bench_build() {
+    local name=$1
+    local extra_flags=$2
+    shift 2
+    $CXX $CXXFLAGS $extra_flags -o "$BENCH_BIN_DIR/$name" "$@" -lpthread
+}
+
+BENCH_FLAGS_sse42="-msse4.2"
+BENCH_FLAGS_avx2="-mavx2 -mbmi -mbmi2 -mlzcnt"
+BENCH_FLAGS_avx512="-mavx2 -mbmi -mbmi2 -mlzcnt -mavx512f -mavx512vpopcntdq"
+
+bench_detect_tiers() {
+    BENCH_TIERS="sse42"
+    if grep -q avx2 /proc/cpuinfo 2> /dev/null; then
+        BENCH_TIERS="$BENCH_TIERS avx2"
+    fi
+    if [[ "$1" == "avx512" ]] && grep -q avx512_vpopcntdq /proc/cpuinfo 2> /dev/null; then
+        BENCH_TIERS="$BENCH_TIERS avx512"
+    fi
+}
+
+bench_build_tiers() {
+    local name=$1
+    shift
+    local t
+    for t in $BENCH_TIERS; do
+        local flags_var=BENCH_FLAGS_$t
+        bench_build ${name}_$t "${!flags_var}" "$@"
+    done
+}
+
+bench_run_tiers() {
+    local name=$1
+    shift
+    local t
+    local first=1
+    for t in $BENCH_TIERS; do
+        if [[ $first -eq 1 ]]; then
+            "$BENCH_BIN_DIR/${name}_$t" "$@"
+            first=0
+        else
+            "$BENCH_BIN_DIR/${name}_$t" "$@" | tail -n +2
+        fi
+    done
+}
@@ -48,4 +48,94 @@ cd TEST_DOSAGE_ROUND_TRIP
 cd ..
 echo "TEST_DOSAGE_ROUND_TRIP passed."
 
+cd TEST_PGEN_BATCH
+./run_tests.sh $d $2 $3 > TEST_PGEN_BATCH.log
+cd ..
+echo "TEST_PGEN_BATCH passed."
+
+cd TEST_PGI
+./run_tests.sh $d $2 $3 > TEST_PGI.log
+cd ..
+echo "TEST_PGI passed."
+
+cd TEST_VARIANT_SUMMARY
+./run_tests.sh $d $2 $3 > TEST_VARIANT_SUMMARY.log
+cd ..
+echo "TEST_VARIANT_SUMMARY passed."
+
+cd TEST_LD_SEARCH
+./run_tests.sh $d $2 $3 > TEST_LD_SEARCH.log
+cd ..
+echo "TEST_LD_SEARCH passed."
+
+cd TEST_ZSTD_PGEN
+./run_tests.sh $d $2 $3 > TEST_ZSTD_PGEN.log
+cd ..
+echo "TEST_ZSTD_PGEN passed."
+
+cd TEST_PGEN_APPEND
+./run_tests.sh $d $2 $3 > TEST_PGEN_APPEND.log
+cd ..
+echo "TEST_PGEN_APPEND passed."
+
+cd TEST_TEXT_MMAP
+./run_tests.sh $d $2 $3 > TEST_TEXT_MMAP.log
+cd ..
+echo "TEST_TEXT_MMAP passed."
+
+cd TEST_ZST_SEEKABLE
+./run_tests.sh $d $2 $3 > TEST_ZST_SEEKABLE.log
+cd ..
+echo "TEST_ZST_SEEKABLE passed."
+
+cd TEST_GZ_MT
+./run_tests.sh $d $2 $3 > TEST_GZ_MT.log
+cd ..
+echo "TEST_GZ_MT passed."
+
+cd TEST_BGZF_SEEK
+./run_tests.sh $d $2 $3 > TEST_BGZF_SEEK.log
+cd ..
+echo "TEST_BGZF_SEEK passed."
+
+cd TEST_OUTPUT_ROUNDTRIP
+./run_tests.sh $d $2 $3 > TEST_OUTPUT_ROUNDTRIP.log
+cd ..
+echo "TEST_OUTPUT_ROUNDTRIP passed."
+
+cd TEST_ZST_PIPELINE
+./run_tests.sh $d $2 $3 > TEST_ZST_PIPELINE.log
+cd ..
+echo "TEST_ZST_PIPELINE passed."
+
+cd TEST_BGZ_INDEX
+./run_tests.sh $d $2 $3 > TEST_BGZ_INDEX.log
+cd ..
+echo "TEST_BGZ_INDEX passed."
+
+cd TEST_THREAD_TASKS
+./run_tests.sh $d $2 $3 > TEST_THREAD_TASKS.log
+cd ..
+echo "TEST_THREAD_TASKS passed."
+
+cd TEST_PERF_LOG
+./run_tests.sh $d $2 $3 > TEST_PERF_LOG.log
+cd ..
+echo "TEST_PERF_LOG passed."
+
+cd TEST_DRY_RUN
+./run_tests.sh $d $2 $3 > TEST_DRY_RUN.log
+cd ..
+echo "TEST_DRY_RUN passed."
+
+cd TEST_PVAR_THREADS
+./run_tests.sh $d $2 $3 > TEST_PVAR_THREADS.log
+cd ..
+echo "TEST_PVAR_THREADS passed."
+
+cd TEST_PVAR_CACHE
+./run_tests.sh $d $2 $3 > TEST_PVAR_CACHE.log
+cd ..
+echo "TEST_PVAR_CACHE passed."
+
 echo "All tests passed."
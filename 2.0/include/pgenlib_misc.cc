@@ -533,6 +533,30 @@ void GenovecCount12Unsafe(const uintptr_t* genovec, uint32_t sample_ct, uint32_t
   *raw_10_ctp = raw_both_ct - raw_01_ct;
 }
 
+#ifdef USE_AVX512
+void Count3FreqVec6(const VecW* geno_vvec, uint32_t vec_ct, uint32_t* __restrict even_ctp, uint32_t* __restrict odd_ctp, uint32_t* __restrict bothset_ctp) {
+  assert(!(vec_ct % 6));
+  // VPOPCNTQ version.  odd_ct is derived from the full-word popcount, so
+  // only three popcounts are needed per 512-bit load.
+  const VecZ m1 = VCONST_Z(kMask5555);
+  const VecZ* geno_zvec_iter = R_CAST(const VecZ*, geno_vvec);
+  const VecZ* geno_zvec_stop = &(geno_zvec_iter[vec_ct / 2]);
+  VecZ acc_even = vecz_setzero();
+  VecZ acc_all = vecz_setzero();
+  VecZ acc_bothset = vecz_setzero();
+  for (; geno_zvec_iter != geno_zvec_stop; ++geno_zvec_iter) {
+    const VecZ cur_geno_zword = vecz_loadu(geno_zvec_iter);
+    const VecZ cur_geno_zword_high = cur_geno_zword >> 1;
+    acc_even = acc_even + vecz_popcnt64(cur_geno_zword & m1);
+    acc_all = acc_all + vecz_popcnt64(cur_geno_zword);
+    acc_bothset = acc_bothset + vecz_popcnt64(vecz_ternlog(cur_geno_zword, cur_geno_zword_high, m1, 0x80));
+  }
+  const uint32_t even_ct = HsumZ(acc_even);
+  *even_ctp = even_ct;
+  *odd_ctp = HsumZ(acc_all) - even_ct;
+  *bothset_ctp = HsumZ(acc_bothset);
+}
+#else
 void Count3FreqVec6(const VecW* geno_vvec, uint32_t vec_ct, uint32_t* __restrict even_ctp, uint32_t* __restrict odd_ctp, uint32_t* __restrict bothset_ctp) {
   assert(!(vec_ct % 6));
   // Sets even_ct to the number of set low bits in the current block, odd_ct to
@@ -622,6 +646,7 @@ void Count3FreqVec6(const VecW* geno_vvec, uint32_t vec_ct, uint32_t* __restrict
     acc_bothset = acc_bothset + vecw_bytesum(inner_acc_bothset, m0);
   }
 }
+#endif
 
 void FillInterleavedMaskVec(const uintptr_t* __restrict subset_mask, uint32_t base_vec_ct, uintptr_t* interleaved_mask_vec) {
 #ifdef __LP64__
@@ -744,6 +769,32 @@ uintptr_t MostCommonGenoUnsafe(const uintptr_t* genoarr, uint32_t sample_ct) {
 }
 
 // geno_vvec now allowed to be unaligned.
+#ifdef USE_AVX512
+void CountSubset3FreqVec6(const VecW* __restrict geno_vvec, const VecW* __restrict interleaved_mask_vvec, uint32_t vec_ct, uint32_t* __restrict even_ctp, uint32_t* __restrict odd_ctp, uint32_t* __restrict bothset_ctp) {
+  assert(!(vec_ct % 6));
+  // Each interleaved-mask vector covers two genotype vectors (even bits for
+  // the first, odd bits for the second), i.e. exactly one 512-bit load.
+  const VecZ m1 = VCONST_Z(kMask5555);
+  const VecZ mask_shifts = {0, 0, 0, 0, 1, 1, 1, 1};
+  const VecZ* geno_zvec_iter = R_CAST(const VecZ*, geno_vvec);
+  const VecZ* geno_zvec_stop = &(geno_zvec_iter[vec_ct / 2]);
+  const VecW* interleaved_mask_vvec_iter = interleaved_mask_vvec;
+  VecZ acc_even = vecz_setzero();
+  VecZ acc_odd = vecz_setzero();
+  VecZ acc_bothset = vecz_setzero();
+  for (; geno_zvec_iter != geno_zvec_stop; ++geno_zvec_iter) {
+    const VecZ cur_mask = (vecz_broadcast_vecw(interleaved_mask_vvec_iter++) >> mask_shifts) & m1;
+    const VecZ cur_geno_zword = vecz_loadu(geno_zvec_iter);
+    const VecZ cur_geno_zword_high = cur_geno_zword >> 1;
+    acc_even = acc_even + vecz_popcnt64(cur_geno_zword & cur_mask);
+    acc_odd = acc_odd + vecz_popcnt64(cur_geno_zword_high & cur_mask);
+    acc_bothset = acc_bothset + vecz_popcnt64(vecz_ternlog(cur_geno_zword, cur_geno_zword_high, cur_mask, 0x80));
+  }
+  *even_ctp = HsumZ(acc_even);
+  *odd_ctp = HsumZ(acc_odd);
+  *bothset_ctp = HsumZ(acc_bothset);
+}
+#else
 void CountSubset3FreqVec6(const VecW* __restrict geno_vvec, const VecW* __restrict interleaved_mask_vvec, uint32_t vec_ct, uint32_t* __restrict even_ctp, uint32_t* __restrict odd_ctp, uint32_t* __restrict bothset_ctp) {
   assert(!(vec_ct % 6));
   // Sets even_ct to the number of set low bits in the current block after
@@ -841,6 +892,7 @@ void CountSubset3FreqVec6(const VecW* __restrict geno_vvec, const VecW* __restri
     acc_bothset = acc_bothset + vecw_bytesum(inner_acc_bothset, m0);
   }
 }
+#endif
 
 void GenoarrCountSubsetFreqs(const uintptr_t* __restrict genoarr, const uintptr_t* __restrict sample_include_interleaved_vec, uint32_t raw_sample_ct, uint32_t sample_ct, STD_ARRAY_REF(uint32_t, 4) genocounts) {
   // fills genocounts[0] with the number of 00s, genocounts[1] with the number
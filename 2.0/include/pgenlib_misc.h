@@ -76,6 +76,17 @@
 
 #include "plink2_bits.h"
 
+// Storage mode 0x12 (zstd-compressed variant records) requires zstd; define
+// NO_PGEN_ZSTD to build pgenlib without it, in which case such files are
+// rejected with kPglRetNotYetSupported.
+#ifndef NO_PGEN_ZSTD
+#  ifdef STATIC_ZSTD
+#    include "../zstd/lib/zstd.h"
+#  else
+#    include <zstd.h>
+#  endif
+#endif
+
 // 10000 * major + 100 * minor + patch
 // Exception to CONSTI32, since we want the preprocessor to have access to this
 // value.  Named with all caps as a consequence.
@@ -602,6 +613,10 @@ HEADER_INLINE double MultiallelicDiploidMachR2(const uint64_t* __restrict sums,
 
 CONSTI32(kPglVblockSize, 65536);
 
+// Number of variants per zstd frame in storage mode 0x12.  Must divide
+// kPglVblockSize.
+CONSTI32(kPglZframeSize, 4096);
+
 // Currently chosen so that it plus kPglFwriteBlockSize + kCacheline - 2 is
 // < 2^32, so DivUp(kPglMaxBytesPerVariant + kPglFwriteBlockSize - 1,
 // kCacheline) doesn't overflow.
@@ -639,6 +654,61 @@ CONSTI32(kPglMaxDifflistLenDivisor, 8);
 // kPglMaxDifflistLenDivisor.
 CONSTI32(kPglMaxDeltalistLenDivisor, 9);
 
+// .vsum sidecar: optional per-variant summary statistics covering all samples
+// in a .pgen, written by the .pgen writer when requested, so that frequency,
+// missingness, and HWE computations on the full sample set don't need to touch
+// genotype data.  Layout (all integers little-endian):
+//   PgenVsumHeader (64 bytes)
+//   PgenVariantSummary[variant_ct]
+// The header records the .pgen's size, mtime, and a hash of its vblock offset
+// table; a .vsum that doesn't match its .pgen is stale and must be ignored.
+typedef struct PgenVsumHeaderStruct {
+  char magic[4];
+  uint32_t variant_ct;
+  uint32_t sample_ct;
+  uint32_t record_byte_ct;
+  uint64_t pgen_fsize;
+  int64_t pgen_mtime;
+  uint64_t vblock_fpos_hash;
+  uint32_t reserved[6];
+} PgenVsumHeader;
+
+typedef struct PgenVariantSummaryStruct {
+  // Counts of the four genovec categories: hom-ref, ref/altx, altx/alty,
+  // missing.  (Multiallelic patches are not resolved, so for a multiallelic
+  // variant these are not allele-specific.)
+  uint32_t geno_cts[4];
+
+  // ref and alt1 dosage sums over all samples, in 1/16384 units; identical to
+  // the all_dosages[] values PgrGetDCounts() returns without sample
+  // subsetting.  Hardcalls are used where dosages are absent.
+  uint64_t dosage_sums[2];
+
+  // Number of phased heterozygous hardcalls.
+  uint32_t phased_het_ct;
+
+  // Number of explicit dosages (including explicitly missing ones).
+  uint32_t dosage_ct;
+} PgenVariantSummary;
+
+static_assert(sizeof(PgenVsumHeader) == 64, "PgenVsumHeader must be 64 bytes.");
+static_assert(sizeof(PgenVariantSummary) == 40, "PgenVariantSummary must be 40 bytes.");
+
+HEADER_INLINE uint32_t IsPgenVsumMagic(const char* magic) {
+  return (magic[0] == 'l') && (magic[1] == 0x1b) && (magic[2] == 'V') && (magic[3] == 1);
+}
+
+// Chainable; the vblock offset table can be hashed in pieces.
+HEADER_INLINE uint64_t PglVsumHashVblockFpos(const uint64_t* vblock_fpos, uint32_t vblock_ct, uint64_t hash) {
+  for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
+    hash = (hash ^ vblock_fpos[vblock_idx]) * 0x100000001b3LLU;
+    hash ^= hash >> 29;
+  }
+  return hash;
+}
+
+CONSTI32(kPglVsumHashSeed, 0x6c1b5653);
+
 void PgrDifflistToGenovecUnsafe(const uintptr_t* __restrict raregeno, const uint32_t* difflist_sample_ids, uintptr_t difflist_common_geno, uint32_t sample_ct, uint32_t difflist_len, uintptr_t* __restrict genovec);
 
 // This covers all the possibilities.  Todo: switch all functions exporting
@@ -712,7 +782,9 @@ void PglMultiallelicSparseToDenseMiss(const PgenVariant* pgvp, uint32_t sample_c
 //      0x10 = variable-type and/or variable-length records present.
 //      0x11 = mode 0x10, but with phase set information at the end of the
 //             file.
-//      0x05..0x0f and 0x12..0x7f are reserved for possible use by future
+//      0x12 = mode 0x10, but with the variant records zstd-compressed in
+//             independently decodable frames; see {4c}.
+//      0x05..0x0f and 0x13..0x7f are reserved for possible use by future
 //      versions of the PGEN specification, and 0 is off-limits (PLINK 1
 //      sample-major .bed).
 //      0x80..0xff can be safely used by developers for their own purposes.
@@ -759,7 +831,7 @@ void PglMultiallelicSparseToDenseMiss(const PgenVariant* pgvp, uint32_t sample_c
 //       Bits 0-5 do not apply to the fixed-length modes (currently 0x02-0x04)
 //       and should be zeroed out in that case.
 //
-// 4. If mode 0x10/0x11,
+// 4. If mode 0x10/0x11/0x12,
 //    a. Array of 8-byte fpos values for the first variant in each vblock.
 //       (Note that this suggests a way to support in-place insertions: some
 //       unused space can be left between the vblocks.)
@@ -774,6 +846,12 @@ void PglMultiallelicSparseToDenseMiss(const PgenVariant* pgvp, uint32_t sample_c
 //       iii. if bits 4-5 of {3c} aren't 00, array of alt allele counts.
 //        iv. nonref flags info, if explicitly stored
 //      (this representation allows more efficient random access)
+//    c. If mode 0x12, array of (DivUp(M, kPglZframeSize) + 1) 8-byte fpos
+//       values: the start of each zstd frame, followed by the file size.  Each
+//       frame holds the records of kPglZframeSize consecutive variants (except
+//       the last may be shorter).  All fpos values in {4a}, and all offsets
+//       derived from {4b}, then refer to the decompressed record stream, which
+//       is considered to start at the same position as the first frame.
 //    If mode 0x02-0x04, and nonref flags info explicitly stored, just that
 //    bitarray.
 //
@@ -27,6 +27,14 @@
 #  include <unistd.h>  // fstat()
 #endif
 
+#ifndef NO_PGEN_IO_POOL
+#  include <pthread.h>
+#  include <time.h>  // clock_gettime()
+#  include <unistd.h>  // pread()
+#endif
+
+#include <sys/stat.h>  // stat(), for PgfiAttachVrecCache()
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -373,6 +381,15 @@ void PreinitPgfi(PgenFileInfo* pgfip) {
   pgfip->block_base = nullptr;
   // we want this for proper handling of e.g. sites-only VCFs
   pgfip->nonref_flags = nullptr;
+  pgfip->io_pool = nullptr;
+  pgfip->vrec_cache = nullptr;
+  pgfip->vrec_cache_file_id = 0;
+  pgfip->pgi_base = nullptr;
+  pgfip->vsums = nullptr;
+  pgfip->vsum_base = nullptr;
+  pgfip->zframe_ct = 0;
+  pgfip->zframe_fpos = nullptr;
+  pgfip->zstream = nullptr;
 }
 
 uint32_t CountPgfiAllocCachelinesRequired(uint32_t raw_variant_ct) {
@@ -387,6 +404,23 @@ uint32_t CountPgfiAllocCachelinesRequired(uint32_t raw_variant_ct) {
   return cachelines_required;
 }
 
+uintptr_t CountPgfiCompactAllocCachelinesRequired(uint32_t raw_variant_ct, uint32_t vrec_len_byte_ct) {
+  // vrtypes
+  uintptr_t cachelines_required = 1 + (raw_variant_ct / kCacheline);
+
+  // fpos_bases: 8 bytes per entry, (raw_variant_ct / kPglFposBlockSize + 1)
+  // entries
+  cachelines_required += 1 + (raw_variant_ct / (kPglFposBlockSize * kInt64PerCacheline));
+
+  // vrec_lens: vrec_len_byte_ct bytes per entry, plus padding for 4-byte
+  // loads
+  cachelines_required += DivUp(S_CAST(uint64_t, raw_variant_ct) * vrec_len_byte_ct + 3, kCacheline);
+
+  // one vblock's worth of decoded offsets, only used during phase 2
+  cachelines_required += 1 + (MINV(raw_variant_ct, kPglVblockSize) / kInt64PerCacheline);
+  return cachelines_required;
+}
+
 uint32_t CountPgrAllocCachelinesRequired(uint32_t raw_sample_ct, PgenGlobalFlags gflags, uint32_t max_allele_ct, uint32_t fread_buf_byte_ct) {
   // ldbase_raw_genovec: always needed, 2 bits per entry, up to raw_sample_ct
   // entries
@@ -462,9 +496,21 @@ uint32_t CountPgrAllocCachelinesRequired(uint32_t raw_sample_ct, PgenGlobalFlags
 static_assert(kPglMaxAlleleCt == 255, "Need to update PgfiInitPhase1().");
 PglErr PgfiInitPhase1(const char* fname, uint32_t raw_variant_ct, uint32_t raw_sample_ct, uint32_t use_mmap, PgenHeaderCtrl* header_ctrl_ptr, PgenFileInfo* pgfip, uintptr_t* pgfi_alloc_cacheline_ct_ptr, char* errstr_buf) {
   pgfip->var_fpos = nullptr;
+  pgfip->fpos_bases = nullptr;
+  pgfip->vrec_lens = nullptr;
+  pgfip->vrec_len_byte_ct = 0;
   pgfip->vrtypes = nullptr;
   pgfip->allele_idx_offsets = nullptr;
   pgfip->nonref_flags = nullptr;
+  pgfip->io_pool = nullptr;
+  pgfip->vrec_cache = nullptr;
+  pgfip->vrec_cache_file_id = 0;
+  pgfip->pgi_base = nullptr;
+  pgfip->vsums = nullptr;
+  pgfip->vsum_base = nullptr;
+  pgfip->zframe_ct = 0;
+  pgfip->zframe_fpos = nullptr;
+  pgfip->zstream = nullptr;
 
   // Caller is currently expected to reset max_allele_ct if allele_idx_offsets
   // is preloaded... need to fix this interface.
@@ -689,11 +735,23 @@ PglErr PgfiInitPhase1(const char* fname, uint32_t raw_variant_ct, uint32_t raw_s
     *pgfi_alloc_cacheline_ct_ptr = 0;
     return kPglRetSuccess;
   }
-  if (unlikely(file_type_code >= 0x11)) {
+  if (unlikely((file_type_code == 0x11) || (file_type_code > 0x12))) {
     // todo: 0x11 phase sets (maybe not before 2021, though)
     snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Third byte of %s does not correspond to a storage mode supported by this version of pgenlib.\n", fname);
     return kPglRetNotYetSupported;
   }
+  if (file_type_code == 0x12) {
+#ifdef NO_PGEN_ZSTD
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has zstd-compressed variant records, but pgenlib was not compiled with zstd support.\n", fname);
+    return kPglRetNotYetSupported;
+#else
+    if (unlikely(use_mmap)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has zstd-compressed variant records, which can't be read via mmap.\n", fname);
+      return kPglRetNotYetSupported;
+    }
+    pgfip->zframe_ct = DivUp(raw_variant_ct, kPglZframeSize);
+#endif
+  }
   // plink 2 binary, general-purpose
   pgfip->const_vrtype = UINT32_MAX;
   pgfip->const_vrec_width = 0;
@@ -751,10 +809,30 @@ PglErr PgfiInitPhase1(const char* fname, uint32_t raw_variant_ct, uint32_t raw_s
     vrtype_and_vrec_len_bit_cost = 12 + phase_or_dosage_present_x4 + 8 * (header_ctrl & 3);
   }
   pgfip->const_fpos_offset += (raw_sample_ct * vrtype_and_vrec_len_bit_cost + 7) / 8 + (raw_sample_ct * alt_allele_ct_byte_ct) + (8 * vblock_ct);
+  if (pgfip->zframe_ct) {
+    pgfip->const_fpos_offset += 8 * (pgfip->zframe_ct + 1);
+  }
   *pgfi_alloc_cacheline_ct_ptr = CountPgfiAllocCachelinesRequired(raw_variant_ct);
   return kPglRetSuccess;
 }
 
+void PgfiEnableCompactFpos(PgenHeaderCtrl header_ctrl, PgenFileInfo* pgfip, uintptr_t* pgfi_alloc_cacheline_ct_ptr) {
+  if (pgfip->const_vrec_width) {
+    // no record-offset table
+    return;
+  }
+  uint32_t vrec_len_byte_ct;
+  if (header_ctrl & 8) {
+    // Special encodings never exceed vrtype 0 length + 8 bytes.
+    const uint32_t max_vrec_len = NypCtToByteCt(pgfip->raw_sample_ct) + 8;
+    vrec_len_byte_ct = 1 + (max_vrec_len > 0xff) + (max_vrec_len > 0xffff) + (max_vrec_len > 0xffffff);
+  } else {
+    vrec_len_byte_ct = 1 + (header_ctrl & 3);
+  }
+  pgfip->vrec_len_byte_ct = vrec_len_byte_ct;
+  *pgfi_alloc_cacheline_ct_ptr = CountPgfiCompactAllocCachelinesRequired(pgfip->raw_variant_ct, vrec_len_byte_ct);
+}
+
 void FillPgenReadErrstrFromErrno(char* errstr_buf) {
   if (errno) {
     snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen read failure: %s.\n", strerror(errno));
@@ -770,6 +848,313 @@ void FillPgenReadErrstr(FILE* ff, char* errstr_buf) {
   FillPgenReadErrstrFromErrno(errstr_buf);
 }
 
+#ifndef NO_PGEN_ZSTD
+#  ifndef NO_PGEN_IO_POOL
+static BoolErr PreadFull(int32_t fd, uint64_t fpos, uintptr_t byte_ct, unsigned char* dst);
+
+static void PgenIoPoolSubmitZstd(int32_t fd, uint64_t src_fpos, uint64_t src_byte_ct, uint64_t skip_ct, uintptr_t byte_ct, unsigned char* dst, PgenIoTicket* ticketp, PgenIoPool* io_poolp);
+#  endif
+
+CONSTI32(kPgenZstdInBufSize, 1 << 17);
+CONSTI32(kPgenZstdSkipBufSize, 1 << 16);
+
+// Decompressor positioned within one storage-mode-0x12 frame.
+struct PgenZstdStreamStruct {
+  ZSTD_DStream* zds;
+  // compressed bytes not yet consumed are in_buf[zib.pos, zib.size)
+  ZSTD_inBuffer zib;
+  // physical position of the next compressed byte to load, and number of
+  // compressed bytes left in the frame
+  uint64_t src_fpos;
+  uint64_t src_left;
+  // logical (decompressed-stream) position of the next output byte
+  uint64_t lfpos;
+  // UINT32_MAX if no frame is open
+  uint32_t frame_idx;
+  // ZSTD_decompressStream()'s last return value; zero iff the frame is done
+  uintptr_t last_zret;
+  unsigned char in_buf[kPgenZstdInBufSize];
+  unsigned char skip_buf[kPgenZstdSkipBufSize];
+};
+
+static PgenZstdStream* CreatePgenZstdStream() {
+  PgenZstdStream* zsp = S_CAST(PgenZstdStream*, malloc(sizeof(PgenZstdStream)));
+  if (unlikely(!zsp)) {
+    return nullptr;
+  }
+  zsp->zds = ZSTD_createDStream();
+  if (unlikely(!zsp->zds)) {
+    free(zsp);
+    return nullptr;
+  }
+  zsp->frame_idx = UINT32_MAX;
+  return zsp;
+}
+
+static void CleanupPgenZstdStream(PgenZstdStream* zsp) {
+  if (zsp) {
+    ZSTD_freeDStream(zsp->zds);
+    free(zsp);
+  }
+}
+
+static void PgenZstdStreamOpen(uint64_t src_fpos, uint64_t src_byte_ct, uint64_t lfpos, uint32_t frame_idx, PgenZstdStream* zsp) {
+  ZSTD_DCtx_reset(zsp->zds, ZSTD_reset_session_only);
+  zsp->zib.src = zsp->in_buf;
+  zsp->zib.size = 0;
+  zsp->zib.pos = 0;
+  zsp->src_fpos = src_fpos;
+  zsp->src_left = src_byte_ct;
+  zsp->lfpos = lfpos;
+  zsp->frame_idx = frame_idx;
+  zsp->last_zret = 1;
+}
+
+static inline void PgenZstdStreamOpenFrame(const PgenFileInfo* pgfip, uint32_t frame_idx, PgenZstdStream* zsp) {
+  const uint64_t src_fpos = pgfip->zframe_fpos[frame_idx];
+  PgenZstdStreamOpen(src_fpos, pgfip->zframe_fpos[frame_idx + 1] - src_fpos, GetPgfiFpos(pgfip, frame_idx * S_CAST(uintptr_t, kPglZframeSize)), frame_idx, zsp);
+}
+
+static BoolErr PgenZstdStreamRefill(FILE* ff, __maybe_unused int32_t fd, PgenZstdStream* zsp) {
+  const uintptr_t load_byte_ct = MINV(zsp->src_left, kPgenZstdInBufSize);
+  if (ff) {
+    if (unlikely(fseeko(ff, zsp->src_fpos, SEEK_SET))) {
+      return 1;
+    }
+    if (unlikely(!fread_unlocked(zsp->in_buf, load_byte_ct, 1, ff))) {
+      if (feof_unlocked(ff)) {
+        errno = 0;
+      }
+      return 1;
+    }
+  } else {
+#  ifdef NO_PGEN_IO_POOL
+    assert(0);
+#  else
+    if (unlikely(PreadFull(fd, zsp->src_fpos, load_byte_ct, zsp->in_buf))) {
+      return 1;
+    }
+#  endif
+  }
+  zsp->src_fpos += load_byte_ct;
+  zsp->src_left -= load_byte_ct;
+  zsp->zib.size = load_byte_ct;
+  zsp->zib.pos = 0;
+  return 0;
+}
+
+// Decompresses the next byte_ct bytes of the current frame to dst, or
+// discards them if dst is nullptr.  Compressed bytes are read from ff if it's
+// non-null, and pread() from fd otherwise.  On failure, errno is set to zero
+// if the frame was malformed or truncated.
+static BoolErr PgenZstdStreamRead(FILE* ff, int32_t fd, uint64_t byte_ct, unsigned char* dst, PgenZstdStream* zsp) {
+  ZSTD_inBuffer* zibp = &(zsp->zib);
+  while (byte_ct) {
+    if ((zibp->pos == zibp->size) && zsp->src_left) {
+      if (unlikely(PgenZstdStreamRefill(ff, fd, zsp))) {
+        return 1;
+      }
+    }
+    ZSTD_outBuffer zob;
+    if (dst) {
+      zob.dst = dst;
+      zob.size = MINV(byte_ct, kMaxBytesPerIO);
+    } else {
+      zob.dst = zsp->skip_buf;
+      zob.size = MINV(byte_ct, kPgenZstdSkipBufSize);
+    }
+    zob.pos = 0;
+    const uintptr_t in_pos_start = zibp->pos;
+    const uintptr_t zret = ZSTD_decompressStream(zsp->zds, &zob, zibp);
+    // Error out on a decoding error, premature end of frame, or lack of
+    // progress (which means the compressed data was truncated).
+    if (unlikely(ZSTD_isError(zret) || ((!zret) && (zob.pos != byte_ct)) || ((!zob.pos) && (zibp->pos == in_pos_start)))) {
+      errno = 0;
+      return 1;
+    }
+    zsp->last_zret = zret;
+    if (dst) {
+      dst = &(dst[zob.pos]);
+    }
+    byte_ct -= zob.pos;
+    zsp->lfpos += zob.pos;
+  }
+  return 0;
+}
+
+// Verifies that the current frame has no more output, and that it ends
+// exactly where the frame index says it does.
+static BoolErr PgenZstdStreamFinish(FILE* ff, int32_t fd, PgenZstdStream* zsp) {
+  ZSTD_inBuffer* zibp = &(zsp->zib);
+  while (zsp->last_zret) {
+    if ((zibp->pos == zibp->size) && zsp->src_left) {
+      if (unlikely(PgenZstdStreamRefill(ff, fd, zsp))) {
+        return 1;
+      }
+    }
+    unsigned char extra_byte;
+    ZSTD_outBuffer zob;
+    zob.dst = &extra_byte;
+    zob.size = 1;
+    zob.pos = 0;
+    const uintptr_t in_pos_start = zibp->pos;
+    const uintptr_t zret = ZSTD_decompressStream(zsp->zds, &zob, zibp);
+    if (unlikely(ZSTD_isError(zret) || zob.pos || (zret && (zibp->pos == in_pos_start)))) {
+      errno = 0;
+      return 1;
+    }
+    zsp->last_zret = zret;
+  }
+  if (unlikely((zibp->pos != zibp->size) || zsp->src_left)) {
+    errno = 0;
+    return 1;
+  }
+  return 0;
+}
+
+// Loads the storage-mode-0x12 frame table, which immediately precedes the
+// first variant record.
+static PglErr PgfiLoadZframeFpos(PgenFileInfo* pgfip, char* errstr_buf) {
+  FILE* shared_ff = pgfip->shared_ff;
+  const uint32_t zframe_ct = pgfip->zframe_ct;
+  const uintptr_t table_byte_ct = (zframe_ct + 1) * sizeof(int64_t);
+  uint64_t first_fpos;
+  if (unlikely(fseeko(shared_ff, 12, SEEK_SET) ||
+               (!fread_unlocked(&first_fpos, sizeof(int64_t), 1, shared_ff)))) {
+    FillPgenReadErrstr(shared_ff, errstr_buf);
+    return kPglRetReadFail;
+  }
+  if (unlikely(first_fpos < 12 + table_byte_ct)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid .pgen header.\n");
+    return kPglRetMalformedInput;
+  }
+  uint64_t* zframe_fpos = S_CAST(uint64_t*, malloc(table_byte_ct));
+  if (unlikely(!zframe_fpos)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Out of memory.\n");
+    return kPglRetNomem;
+  }
+  if (unlikely(fseeko(shared_ff, first_fpos - table_byte_ct, SEEK_SET) ||
+               (!fread_unlocked(zframe_fpos, table_byte_ct, 1, shared_ff)) ||
+               fseeko(shared_ff, 0, SEEK_END))) {
+    FillPgenReadErrstr(shared_ff, errstr_buf);
+    free(zframe_fpos);
+    return kPglRetReadFail;
+  }
+  const uint64_t fsize = ftello(shared_ff);
+  uint32_t is_valid = (zframe_fpos[0] == first_fpos) && (zframe_fpos[zframe_ct] == fsize);
+  for (uint32_t frame_idx = 0; frame_idx != zframe_ct; ++frame_idx) {
+    // A zstd frame is never empty.
+    if (zframe_fpos[frame_idx] >= zframe_fpos[frame_idx + 1]) {
+      is_valid = 0;
+    }
+  }
+  if (unlikely(!is_valid)) {
+    free(zframe_fpos);
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid .pgen zstd frame index.\n");
+    return kPglRetMalformedInput;
+  }
+  pgfip->zframe_fpos = zframe_fpos;
+  return kPglRetSuccess;
+}
+#endif
+
+static_assert(!(kPglVblockSize % kPglFposBlockSize), "kPglFposBlockSize must divide kPglVblockSize.");
+uint64_t GetCompactFpos(const PgenFileInfo* pgfip, uintptr_t vidx) {
+  const uintptr_t block_idx = vidx / kPglFposBlockSize;
+  uint64_t fpos = pgfip->fpos_bases[block_idx];
+  const uint32_t byte_ct = pgfip->vrec_len_byte_ct;
+  const unsigned char* vrec_lens_iter = &(pgfip->vrec_lens[block_idx * kPglFposBlockSize * byte_ct]);
+  const unsigned char* vrec_lens_stop = &(pgfip->vrec_lens[vidx * byte_ct]);
+  // Specialize the common widths so the compiler can unroll.
+  switch (byte_ct) {
+  case 1:
+    for (; vrec_lens_iter != vrec_lens_stop; ++vrec_lens_iter) {
+      fpos += *vrec_lens_iter;
+    }
+    break;
+  case 2:
+    for (; vrec_lens_iter != vrec_lens_stop; vrec_lens_iter = &(vrec_lens_iter[2])) {
+      uint16_t cur_vrec_len;
+      memcpy(&cur_vrec_len, vrec_lens_iter, sizeof(int16_t));
+      fpos += cur_vrec_len;
+    }
+    break;
+  case 3:
+    for (; vrec_lens_iter != vrec_lens_stop; vrec_lens_iter = &(vrec_lens_iter[3])) {
+      uint32_t cur_vrec_len;
+      memcpy(&cur_vrec_len, vrec_lens_iter, sizeof(int32_t));
+      fpos += cur_vrec_len & 0xffffff;
+    }
+    break;
+  default:
+    for (; vrec_lens_iter != vrec_lens_stop; vrec_lens_iter = &(vrec_lens_iter[4])) {
+      uint32_t cur_vrec_len;
+      memcpy(&cur_vrec_len, vrec_lens_iter, sizeof(int32_t));
+      fpos += cur_vrec_len;
+    }
+  }
+  return fpos;
+}
+
+// Like GetPgfiFpos(), but remembers the successor's offset, so sequential
+// compact-fpos lookups don't need a prefix sum.
+static inline uint64_t GetPgrFpos(uint32_t vidx, PgenReaderMain* pgrp) {
+  const PgenFileInfo* fip = &(pgrp->fi);
+  if (!fip->fpos_bases) {
+    return GetPgfiFpos(fip, vidx);
+  }
+  const uint64_t fpos = (vidx == pgrp->fpos_cache_vidx)? pgrp->fpos_cache : GetCompactFpos(fip, vidx);
+  pgrp->fpos_cache_vidx = vidx + 1;
+  pgrp->fpos_cache = fpos + GetCompactVrecLen(fip, vidx);
+  return fpos;
+}
+
+#ifndef NO_PGEN_ZSTD
+// Per-variant fread mode: decompresses variant vidx's record to dst.
+static BoolErr PgrZstdRead(uint32_t vidx, uintptr_t byte_ct, unsigned char* dst, PgenReaderMain* pgrp) {
+  PgenZstdStream* zsp = pgrp->zstream;
+  if (!zsp) {
+    zsp = CreatePgenZstdStream();
+    if (unlikely(!zsp)) {
+      errno = ENOMEM;
+      return 1;
+    }
+    pgrp->zstream = zsp;
+  }
+  const uint64_t fpos = GetPgrFpos(vidx, pgrp);
+  const uint32_t frame_idx = vidx / kPglZframeSize;
+  if ((zsp->frame_idx != frame_idx) || (zsp->lfpos > fpos)) {
+    PgenZstdStreamOpenFrame(&(pgrp->fi), frame_idx, zsp);
+  }
+  if (unlikely(PgenZstdStreamRead(pgrp->ff, -1, fpos - zsp->lfpos, nullptr, zsp) ||
+               PgenZstdStreamRead(pgrp->ff, -1, byte_ct, dst, zsp))) {
+    // Don't trust the stream state after a failure.
+    zsp->frame_idx = UINT32_MAX;
+    return 1;
+  }
+  return 0;
+}
+#endif
+
+// Converts one vblock's worth of decoded var_fpos[] entries to the compact
+// representation.  var_fpos_buf[vblock_variant_ct] is overwritten.
+static void PackVblockFpos(uint64_t* var_fpos_buf, uint32_t vidx_start, uint32_t vblock_variant_ct, uint64_t end_fpos, PgenFileInfo* pgfip) {
+  const uint32_t byte_ct = pgfip->vrec_len_byte_ct;
+  uint64_t* fpos_bases = &(pgfip->fpos_bases[vidx_start / kPglFposBlockSize]);
+  unsigned char* vrec_lens_iter = &(pgfip->vrec_lens[S_CAST(uint64_t, vidx_start) * byte_ct]);
+  var_fpos_buf[vblock_variant_ct] = end_fpos;
+  for (uint32_t uii = 0; uii != vblock_variant_ct; ++uii) {
+    const uint64_t cur_fpos = var_fpos_buf[uii];
+    if (!(uii % kPglFposBlockSize)) {
+      *fpos_bases++ = cur_fpos;
+    }
+    // Little-endian truncation; lengths are guaranteed to fit.
+    const uint32_t cur_vrec_len = var_fpos_buf[uii + 1] - cur_fpos;
+    memcpy(vrec_lens_iter, &cur_vrec_len, byte_ct);
+    vrec_lens_iter = &(vrec_lens_iter[byte_ct]);
+  }
+}
+
 static_assert(kPglMaxAlleleCt == 255, "Need to update PgfiInitPhase2().");
 PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_loaded, uint32_t nonref_flags_already_loaded, uint32_t use_blockload, uint32_t vblock_idx_start, uint32_t vidx_end, uint32_t* max_vrec_width_ptr, PgenFileInfo* pgfip, unsigned char* pgfi_alloc, uintptr_t* pgr_alloc_cacheline_ct_ptr, char* errstr_buf) {
   // *max_vrec_width_ptr technically only needs to be set in single-variant
@@ -905,7 +1290,22 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
   unsigned char* vrtypes_iter = pgfi_alloc;
   pgfip->vrtypes = vrtypes_iter;
   uint64_t* var_fpos_iter = R_CAST(uint64_t*, &(vrtypes_iter[RoundUpPow2(raw_variant_ct + 1, kCacheline)]));
-  pgfip->var_fpos = var_fpos_iter;
+  // compact-fpos mode: var_fpos_iter instead points to a one-vblock decode
+  // buffer, which is packed into fpos_bases[]/vrec_lens[] after each vblock.
+  uint64_t* var_fpos_buf = nullptr;
+  if (pgfip->vrec_len_byte_ct) {
+    if (unlikely(vblock_idx_start)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitPhase2() cannot be called with nonzero vblock_idx_start after PgfiEnableCompactFpos().\n");
+      return kPglRetImproperFunctionCall;
+    }
+    pgfip->fpos_bases = var_fpos_iter;
+    unsigned char* vrec_lens = R_CAST(unsigned char*, &(var_fpos_iter[RoundUpPow2(raw_variant_ct / kPglFposBlockSize + 1, kInt64PerCacheline)]));
+    pgfip->vrec_lens = vrec_lens;
+    var_fpos_buf = R_CAST(uint64_t*, &(vrec_lens[RoundUpPow2(S_CAST(uint64_t, raw_variant_ct) * pgfip->vrec_len_byte_ct + 3, kCacheline)]));
+    var_fpos_iter = var_fpos_buf;
+  } else {
+    pgfip->var_fpos = var_fpos_iter;
+  }
   uint32_t vblock_ct_m1 = (raw_variant_ct - 1) / kPglVblockSize;
   uint32_t max_vrec_width = 0;
   uint64_t cur_fpos;
@@ -983,6 +1383,7 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
   }
   uint32_t cur_vblock_variant_ct = kPglVblockSize;
   uint32_t max_allele_ct = pgfip->max_allele_ct;
+  const uint64_t first_fpos = cur_fpos;
   for (; ; ++vblock_idx) {
     if (vblock_idx >= vblock_ct_m1) {
       if (vblock_idx > vblock_ct_m1) {
@@ -991,20 +1392,35 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
         // now > instead of != to allow additional information to be stored
         // between header and first variant record
         if (!shared_ff) {
-          if (unlikely(S_CAST(uintptr_t, fread_ptr - pgfip->block_base) > pgfip->var_fpos[0])) {
+          if (unlikely(S_CAST(uintptr_t, fread_ptr - pgfip->block_base) > first_fpos)) {
             snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid .pgen header.\n");
             return kPglRetMalformedInput;
           }
         } else {
 #endif
-          if (unlikely(S_CAST(uint64_t, ftello(shared_ff)) > pgfip->var_fpos[0])) {
+          if (unlikely(S_CAST(uint64_t, ftello(shared_ff)) > first_fpos)) {
             snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid .pgen header.\n");
             return kPglRetMalformedInput;
           }
 #ifndef NO_MMAP
         }
 #endif
-        pgfip->var_fpos[vidx_end] = cur_fpos;
+#ifndef NO_PGEN_ZSTD
+        if (pgfip->zframe_ct) {
+          const PglErr reterr = PgfiLoadZframeFpos(pgfip, errstr_buf);
+          if (unlikely(reterr)) {
+            return reterr;
+          }
+        }
+#endif
+        if (var_fpos_buf) {
+          if (!(vidx_end % kPglFposBlockSize)) {
+            pgfip->fpos_bases[vidx_end / kPglFposBlockSize] = cur_fpos;
+          }
+          memset(&(pgfip->vrec_lens[S_CAST(uint64_t, vidx_end) * pgfip->vrec_len_byte_ct]), 0, 3);
+        } else {
+          pgfip->var_fpos[vidx_end] = cur_fpos;
+        }
         pgfip->max_allele_ct = max_allele_ct;
         // if difflist/LD might be present, scan for them in a way that's
         // likely to terminate quickly
@@ -1127,6 +1543,9 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
       }
       cur_vblock_variant_ct = ModNz(vidx_end, kPglVblockSize);
     }
+    if (var_fpos_buf) {
+      var_fpos_iter = var_fpos_buf;
+    }
     // 1. handle vrtypes and var_fpos.
     if (vrtype_and_fpos_storage >= 8) {
       // Special encodings.
@@ -1381,6 +1800,9 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
       }
 #endif
     }
+    if (var_fpos_buf) {
+      PackVblockFpos(var_fpos_buf, vblock_idx * kPglVblockSize, cur_vblock_variant_ct, cur_fpos, pgfip);
+    }
     // 2. allele counts?
     if (alt_allele_ct_byte_ct) {
       assert(alt_allele_ct_byte_ct == 1);
@@ -1415,8 +1837,8 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
       } else {
         for (uint32_t cur_vblock_vidx = 0; cur_vblock_vidx != cur_vblock_variant_ct; ++cur_vblock_vidx) {
           const uint32_t cur_allele_ct = fread_ptr[cur_vblock_vidx];
-          allele_idx_offsets_iter[cur_vblock_vidx] = prev_allele_idx_offset;
           prev_allele_idx_offset += cur_allele_ct;
+          allele_idx_offsets_iter[cur_vblock_vidx] = prev_allele_idx_offset;
           if (cur_allele_ct > max_allele_ct) {
             max_allele_ct = cur_allele_ct;
           }
@@ -1464,6 +1886,431 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
   }
 }
 
+// .pgi sidecar index layout (all integers little-endian):
+//   PgiHeader (64 bytes)
+//   var_fpos[]: (raw_variant_ct + 1) uint64s, zero-padded to a cacheline
+//     boundary
+//   vrtypes[]: RoundUpPow2(raw_variant_ct + 1, kCacheline) bytes, zero-padded
+//   if (header_ctrl >> 4) & 3: allele count of each variant, 1 byte each,
+//     zero-padded to a cacheline boundary
+//   if (header_ctrl >> 6) == 3: nonref flags, DivUp(raw_variant_ct, 8) bytes
+typedef struct PgiHeaderStruct {
+  char magic[4];
+  uint32_t raw_variant_ct;
+  uint32_t raw_sample_ct;
+  uint32_t header_ctrl;
+  uint64_t pgen_fsize;
+  int64_t pgen_mtime;
+  uint32_t gflags;
+  uint32_t max_vrec_width;
+  uint32_t max_allele_ct;
+  uint32_t reserved[5];
+} PgiHeader;
+
+static_assert(sizeof(PgiHeader) == 64, "PgiHeader must be 64 bytes.");
+
+static const char kPgiMagic[4] = {'l', 0x1b, 'I', 1};
+
+static uint64_t PgiFsizeExpected(uint32_t raw_variant_ct, PgenHeaderCtrl header_ctrl) {
+  uint64_t fsize = sizeof(PgiHeader) + RoundUpPow2((raw_variant_ct + 1) * S_CAST(uint64_t, sizeof(int64_t)), kCacheline) + RoundUpPow2(raw_variant_ct + 1, kCacheline);
+  if ((header_ctrl >> 4) & 3) {
+    fsize += RoundUpPow2(raw_variant_ct, kCacheline);
+  }
+  if ((header_ctrl >> 6) == 3) {
+    fsize += DivUp(raw_variant_ct, CHAR_BIT);
+  }
+  return fsize;
+}
+
+#ifndef NO_MMAP
+static PglErr PgiLoadVblockFpos(uint32_t vblock_idx, uint32_t vblock_ct, const PgenFileInfo* pgfip, uint64_t* vblock_fpos_buf) {
+  // Loads vblock offsets [vblock_idx, vblock_idx + vblock_ct) from the .pgen
+  // header into vblock_fpos_buf.
+  const uint64_t fpos = 12 + vblock_idx * S_CAST(uint64_t, sizeof(int64_t));
+  const uintptr_t byte_ct = vblock_ct * sizeof(int64_t);
+  FILE* shared_ff = pgfip->shared_ff;
+  if (!shared_ff) {
+    memcpy(vblock_fpos_buf, &(pgfip->block_base[fpos]), byte_ct);
+    return kPglRetSuccess;
+  }
+  if (unlikely(fseeko(shared_ff, fpos, SEEK_SET) ||
+               (!fread_unlocked(vblock_fpos_buf, byte_ct, 1, shared_ff)))) {
+    return kPglRetReadFail;
+  }
+  return kPglRetSuccess;
+}
+#endif
+
+PglErr PgfiInitPhase2Pgi(const char* pgen_fname, const char* pgi_fname, PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_loaded, uint32_t nonref_flags_already_loaded, uint32_t use_blockload, uint32_t* max_vrec_width_ptr, PgenFileInfo* pgfip, uintptr_t* pgr_alloc_cacheline_ct_ptr, char* errstr_buf) {
+  errstr_buf[0] = '\0';
+#ifdef NO_MMAP
+  return kPglRetSkipped;
+#else
+  const uint32_t raw_variant_ct = pgfip->raw_variant_ct;
+  if (pgfip->const_vrec_width || (!raw_variant_ct)) {
+    return kPglRetSkipped;
+  }
+  FILE* shared_ff = pgfip->shared_ff;
+  if (unlikely(use_blockload && (!shared_ff))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitPhase2Pgi() cannot be called with use_blockload set when PgfiInitPhase1() had use_mmap set.\n");
+    return kPglRetImproperFunctionCall;
+  }
+  const uint32_t alt_allele_ct_byte_ct = (header_ctrl >> 4) & 3;
+  if (unlikely(alt_allele_ct_byte_ct && (!pgfip->allele_idx_offsets))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: pgfip->allele_idx_offsets must be allocated before PgfiInitPhase2Pgi() is called.\n");
+    return kPglRetImproperFunctionCall;
+  }
+  const uint32_t nonref_flags_stored = ((header_ctrl >> 6) == 3);
+  const int32_t pgi_fd = open(pgi_fname, O_RDONLY);
+  if (pgi_fd == -1) {
+    return kPglRetSkipped;
+  }
+  struct stat statbuf;
+  if (unlikely(fstat(pgi_fd, &statbuf) < 0)) {
+    close(pgi_fd);
+    return kPglRetSkipped;
+  }
+  const uint64_t pgi_size = statbuf.st_size;
+  if (unlikely(pgi_size != PgiFsizeExpected(raw_variant_ct, header_ctrl))) {
+    close(pgi_fd);
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Warning: Ignoring %s, since it has the wrong size for %s.\n", pgi_fname, pgen_fname);
+    return kPglRetSkipped;
+  }
+  const unsigned char* pgi_base = S_CAST(const unsigned char*, mmap(0, pgi_size, PROT_READ, MAP_SHARED, pgi_fd, 0));
+  close(pgi_fd);
+  if (unlikely(R_CAST(uintptr_t, pgi_base) == (~k0LU))) {
+    return kPglRetSkipped;
+  }
+  PglErr reterr = kPglRetSkipped;
+  {
+    const PgiHeader* pgi_headerp = R_CAST(const PgiHeader*, pgi_base);
+    if (unlikely(stat(pgen_fname, &statbuf))) {
+      goto PgfiInitPhase2Pgi_ret_STALE;
+    }
+    if (unlikely((!memequal(pgi_headerp->magic, kPgiMagic, 4)) ||
+                 (pgi_headerp->raw_variant_ct != raw_variant_ct) ||
+                 (pgi_headerp->raw_sample_ct != pgfip->raw_sample_ct) ||
+                 (pgi_headerp->header_ctrl != header_ctrl) ||
+                 (pgi_headerp->pgen_fsize != S_CAST(uint64_t, statbuf.st_size)) ||
+                 (pgi_headerp->pgen_mtime != S_CAST(int64_t, statbuf.st_mtime)) ||
+                 (pgi_headerp->max_allele_ct > kPglMaxAlleleCt))) {
+      goto PgfiInitPhase2Pgi_ret_STALE;
+    }
+    const uint64_t* var_fpos = R_CAST(const uint64_t*, &(pgi_base[sizeof(PgiHeader)]));
+    const unsigned char* vrtypes = R_CAST(const unsigned char*, &(var_fpos[RoundUpPow2(raw_variant_ct + 1, kInt64PerCacheline)]));
+    // Cross-check var_fpos[] against the .pgen's vblock offset table.  This is
+    // cheap (8 bytes per 64Ki variants), and catches an index belonging to a
+    // different .pgen of the same size and mtime.
+    const uint32_t vblock_ct = DivUp(raw_variant_ct, kPglVblockSize);
+    uint64_t vblock_fpos_buf[kPglVblockSize / 8];
+    for (uint32_t vblock_idx_start = 0; vblock_idx_start < vblock_ct; vblock_idx_start += kPglVblockSize / 8) {
+      const uint32_t cur_vblock_ct = MINV(vblock_ct - vblock_idx_start, kPglVblockSize / 8);
+      if (unlikely(PgiLoadVblockFpos(vblock_idx_start, cur_vblock_ct, pgfip, vblock_fpos_buf))) {
+        FillPgenReadErrstr(shared_ff, errstr_buf);
+        reterr = kPglRetReadFail;
+        goto PgfiInitPhase2Pgi_ret_1;
+      }
+      for (uint32_t uii = 0; uii != cur_vblock_ct; ++uii) {
+        if (unlikely(vblock_fpos_buf[uii] != var_fpos[(vblock_idx_start + uii) * S_CAST(uintptr_t, kPglVblockSize)])) {
+          goto PgfiInitPhase2Pgi_ret_STALE;
+        }
+      }
+    }
+    // In storage mode 0x12, var_fpos[] refers to the decompressed record
+    // stream, so the end can't be checked against the file size; the frame
+    // index is checked instead.
+    if (unlikely((var_fpos[0] < pgfip->const_fpos_offset) || ((!pgfip->zframe_ct) && (var_fpos[raw_variant_ct] != pgi_headerp->pgen_fsize)))) {
+      goto PgfiInitPhase2Pgi_ret_STALE;
+    }
+    const unsigned char* trailing_ptr = &(vrtypes[RoundUpPow2(raw_variant_ct + 1, kCacheline)]);
+    uint32_t max_allele_ct = pgfip->max_allele_ct;
+    if (alt_allele_ct_byte_ct) {
+      const unsigned char* allele_cts = trailing_ptr;
+      trailing_ptr = &(trailing_ptr[RoundUpPow2(raw_variant_ct, kCacheline)]);
+      uintptr_t* allele_idx_offsets = pgfip->allele_idx_offsets;
+      if (allele_cts_already_loaded) {
+        for (uint32_t vidx = 0; vidx != raw_variant_ct; ++vidx) {
+          if (unlikely(allele_idx_offsets[vidx + 1] - allele_idx_offsets[vidx] != allele_cts[vidx])) {
+            snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Loaded allele_idx_offsets do not match values in %s.\n", pgi_fname);
+            reterr = kPglRetInconsistentInput;
+            goto PgfiInitPhase2Pgi_ret_1;
+          }
+        }
+      } else {
+        uintptr_t cur_allele_idx_offset = 0;
+        allele_idx_offsets[0] = 0;
+        for (uint32_t vidx = 0; vidx != raw_variant_ct; ++vidx) {
+          cur_allele_idx_offset += allele_cts[vidx];
+          allele_idx_offsets[vidx + 1] = cur_allele_idx_offset;
+        }
+      }
+      if (pgi_headerp->max_allele_ct > max_allele_ct) {
+        max_allele_ct = pgi_headerp->max_allele_ct;
+      }
+    }
+    if (nonref_flags_stored) {
+      const uint32_t nonref_flags_byte_ct = DivUp(raw_variant_ct, CHAR_BIT);
+      if (nonref_flags_already_loaded) {
+        if (unlikely(!memequal(pgfip->nonref_flags, trailing_ptr, nonref_flags_byte_ct))) {
+          snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Loaded nonref_flags do not match values in %s.\n", pgi_fname);
+          reterr = kPglRetInconsistentInput;
+          goto PgfiInitPhase2Pgi_ret_1;
+        }
+      } else {
+        memcpy(pgfip->nonref_flags, trailing_ptr, nonref_flags_byte_ct);
+      }
+    } else if (nonref_flags_already_loaded && (header_ctrl & 192)) {
+      if (header_ctrl & 64) {
+        // all ref
+        if (unlikely(!AllWordsAreZero(pgfip->nonref_flags, BitCtToWordCt(raw_variant_ct)))) {
+          snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Loaded nonref_flags do not match values in .pgen file.\n");
+          reterr = kPglRetInconsistentInput;
+          goto PgfiInitPhase2Pgi_ret_1;
+        }
+      } else if (unlikely(!AllBitsAreOne(pgfip->nonref_flags, raw_variant_ct))) {
+        snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Loaded nonref_flags do not match values in .pgen file.\n");
+        reterr = kPglRetInconsistentInput;
+        goto PgfiInitPhase2Pgi_ret_1;
+      }
+    }
+    if (shared_ff) {
+      // PgrInit() and PgfiMultiread() don't assume any particular file
+      // position, but keep the post-PgfiInitPhase2() state anyway.
+      if (unlikely(fseeko(shared_ff, var_fpos[0], SEEK_SET))) {
+        FillPgenReadErrstrFromErrno(errstr_buf);
+        reterr = kPglRetReadFail;
+        goto PgfiInitPhase2Pgi_ret_1;
+      }
+    }
+#  ifndef NO_PGEN_ZSTD
+    if (pgfip->zframe_ct) {
+      reterr = PgfiLoadZframeFpos(pgfip, errstr_buf);
+      if (unlikely(reterr)) {
+        goto PgfiInitPhase2Pgi_ret_1;
+      }
+    }
+#  endif
+    const PgenGlobalFlags stored_gflags = S_CAST(PgenGlobalFlags, pgi_headerp->gflags);
+    const uint32_t max_vrec_width = pgi_headerp->max_vrec_width;
+    pgfip->var_fpos = K_CAST(uint64_t*, var_fpos);
+    pgfip->fpos_bases = nullptr;
+    pgfip->vrec_lens = nullptr;
+    pgfip->vrec_len_byte_ct = 0;
+    pgfip->vrtypes = K_CAST(unsigned char*, vrtypes);
+    pgfip->gflags |= stored_gflags;
+    pgfip->max_allele_ct = max_allele_ct;
+    pgfip->pgi_base = pgi_base;
+    pgfip->pgi_size = pgi_size;
+    *pgr_alloc_cacheline_ct_ptr = CountPgrAllocCachelinesRequired(pgfip->raw_sample_ct, stored_gflags, max_allele_ct, (shared_ff && (!use_blockload))? max_vrec_width : 0);
+    *max_vrec_width_ptr = max_vrec_width;
+    return kPglRetSuccess;
+  }
+ PgfiInitPhase2Pgi_ret_STALE:
+  snprintf(errstr_buf, kPglErrstrBufBlen, "Warning: Ignoring %s, since it is out of date relative to %s.\n", pgi_fname, pgen_fname);
+ PgfiInitPhase2Pgi_ret_1:
+  munmap(K_CAST(unsigned char*, pgi_base), pgi_size);
+  if (shared_ff && (reterr == kPglRetSkipped)) {
+    // restore file position expected by PgfiInitPhase2()
+    if (unlikely(fseeko(shared_ff, 12, SEEK_SET))) {
+      FillPgenReadErrstrFromErrno(errstr_buf);
+      reterr = kPglRetReadFail;
+    }
+  }
+  return reterr;
+#endif
+}
+
+PglErr PgfiWritePgi(const char* pgen_fname, const char* pgi_fname, PgenHeaderCtrl header_ctrl, uint32_t max_vrec_width, const PgenFileInfo* pgfip, char* errstr_buf) {
+  const uint32_t raw_variant_ct = pgfip->raw_variant_ct;
+  if (unlikely(pgfip->const_vrec_width || ((!pgfip->var_fpos) && (!pgfip->fpos_bases)))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiWritePgi() requires a fully-initialized variable-width PgenFileInfo.\n");
+    return kPglRetImproperFunctionCall;
+  }
+  const uint32_t alt_allele_ct_byte_ct = (header_ctrl >> 4) & 3;
+  const uint32_t nonref_flags_stored = ((header_ctrl >> 6) == 3);
+  if (unlikely((alt_allele_ct_byte_ct && (!pgfip->allele_idx_offsets)) ||
+               (nonref_flags_stored && (!pgfip->nonref_flags)))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiWritePgi() requires allele_idx_offsets/nonref_flags to be loaded when they're stored in the .pgen.\n");
+    return kPglRetImproperFunctionCall;
+  }
+  struct stat statbuf;
+  if (unlikely(stat(pgen_fname, &statbuf))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to open %s : %s.\n", pgen_fname, strerror(errno));
+    return kPglRetOpenFail;
+  }
+  PgiHeader pgi_header;
+  memset(&pgi_header, 0, sizeof(PgiHeader));
+  memcpy(pgi_header.magic, kPgiMagic, 4);
+  pgi_header.raw_variant_ct = raw_variant_ct;
+  pgi_header.raw_sample_ct = pgfip->raw_sample_ct;
+  pgi_header.header_ctrl = header_ctrl;
+  pgi_header.pgen_fsize = statbuf.st_size;
+  pgi_header.pgen_mtime = statbuf.st_mtime;
+  // kfPgenGlobalAllNonref is determined by PgfiInitPhase1().
+  pgi_header.gflags = pgfip->gflags & (~kfPgenGlobalAllNonref);
+  pgi_header.max_vrec_width = max_vrec_width;
+  pgi_header.max_allele_ct = 2;
+  const uintptr_t* allele_idx_offsets = pgfip->allele_idx_offsets;
+  if (alt_allele_ct_byte_ct) {
+    for (uint32_t vidx = 0; vidx != raw_variant_ct; ++vidx) {
+      const uint32_t cur_allele_ct = allele_idx_offsets[vidx + 1] - allele_idx_offsets[vidx];
+      if (cur_allele_ct > pgi_header.max_allele_ct) {
+        pgi_header.max_allele_ct = cur_allele_ct;
+      }
+    }
+  }
+  FILE* outfile = fopen(pgi_fname, FOPEN_WB);
+  if (unlikely(!outfile)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to open %s : %s.\n", pgi_fname, strerror(errno));
+    return kPglRetOpenFail;
+  }
+  PglErr reterr = kPglRetSuccess;
+  {
+    unsigned char zero_buf[kCacheline];
+    memset(zero_buf, 0, kCacheline);
+    const uintptr_t var_fpos_byte_ct = (raw_variant_ct + 1) * sizeof(int64_t);
+    const uintptr_t vrtypes_byte_ct = raw_variant_ct + 1;
+    if (unlikely(!fwrite_unlocked(&pgi_header, sizeof(PgiHeader), 1, outfile))) {
+      goto PgfiWritePgi_ret_WRITE_FAIL;
+    }
+    if (pgfip->var_fpos) {
+      if (unlikely(!fwrite_unlocked(pgfip->var_fpos, var_fpos_byte_ct, 1, outfile))) {
+        goto PgfiWritePgi_ret_WRITE_FAIL;
+      }
+    } else {
+      // compact representation; decode sequentially
+      uint64_t var_fpos_buf[512];
+      uint64_t cur_fpos = pgfip->fpos_bases[0];
+      for (uint32_t vidx_start = 0; vidx_start <= raw_variant_ct; vidx_start += 512) {
+        const uint32_t cur_entry_ct = MINV(raw_variant_ct + 1 - vidx_start, 512);
+        for (uint32_t uii = 0; uii != cur_entry_ct; ++uii) {
+          var_fpos_buf[uii] = cur_fpos;
+          // vrec_lens[raw_variant_ct] is zero padding
+          cur_fpos += GetCompactVrecLen(pgfip, vidx_start + uii);
+        }
+        if (unlikely(!fwrite_unlocked(var_fpos_buf, cur_entry_ct * sizeof(int64_t), 1, outfile))) {
+          goto PgfiWritePgi_ret_WRITE_FAIL;
+        }
+      }
+    }
+    if (unlikely(fwrite_unlocked(zero_buf, 1, RoundUpPow2(var_fpos_byte_ct, kCacheline) - var_fpos_byte_ct, outfile) != RoundUpPow2(var_fpos_byte_ct, kCacheline) - var_fpos_byte_ct)) {
+      goto PgfiWritePgi_ret_WRITE_FAIL;
+    }
+    // vrtypes[raw_variant_ct] isn't necessarily initialized.
+    if (unlikely((fwrite_unlocked(pgfip->vrtypes, 1, raw_variant_ct, outfile) != raw_variant_ct) ||
+                 (fwrite_unlocked(zero_buf, 1, RoundUpPow2(vrtypes_byte_ct, kCacheline) - raw_variant_ct, outfile) != RoundUpPow2(vrtypes_byte_ct, kCacheline) - raw_variant_ct))) {
+      goto PgfiWritePgi_ret_WRITE_FAIL;
+    }
+    if (alt_allele_ct_byte_ct) {
+      unsigned char allele_ct_buf[kPglVblockSize];
+      for (uint32_t vidx_start = 0; vidx_start < raw_variant_ct; vidx_start += kPglVblockSize) {
+        const uint32_t cur_variant_ct = MINV(raw_variant_ct - vidx_start, kPglVblockSize);
+        for (uint32_t uii = 0; uii != cur_variant_ct; ++uii) {
+          allele_ct_buf[uii] = allele_idx_offsets[vidx_start + uii + 1] - allele_idx_offsets[vidx_start + uii];
+        }
+        if (unlikely(!fwrite_unlocked(allele_ct_buf, cur_variant_ct, 1, outfile))) {
+          goto PgfiWritePgi_ret_WRITE_FAIL;
+        }
+      }
+      const uintptr_t pad_byte_ct = RoundUpPow2(raw_variant_ct, kCacheline) - raw_variant_ct;
+      if (unlikely(fwrite_unlocked(zero_buf, 1, pad_byte_ct, outfile) != pad_byte_ct)) {
+        goto PgfiWritePgi_ret_WRITE_FAIL;
+      }
+    }
+    if (nonref_flags_stored) {
+      if (unlikely(!fwrite_unlocked(pgfip->nonref_flags, DivUp(raw_variant_ct, CHAR_BIT), 1, outfile))) {
+        goto PgfiWritePgi_ret_WRITE_FAIL;
+      }
+    }
+    if (unlikely(fclose_null(&outfile))) {
+      goto PgfiWritePgi_ret_WRITE_FAIL;
+    }
+  }
+  while (0) {
+  PgfiWritePgi_ret_WRITE_FAIL:
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s write failure: %s.\n", pgi_fname, strerror(errno));
+    reterr = kPglRetWriteFail;
+    break;
+  }
+  if (outfile) {
+    fclose(outfile);
+  }
+  return reterr;
+}
+
+PglErr PgfiAttachVariantSummary(const char* pgen_fname, const char* vsum_fname, PgenFileInfo* pgfip, char* errstr_buf) {
+  errstr_buf[0] = '\0';
+#ifdef NO_MMAP
+  return kPglRetSkipped;
+#else
+  const uint32_t raw_variant_ct = pgfip->raw_variant_ct;
+  if (!raw_variant_ct) {
+    return kPglRetSkipped;
+  }
+  const int32_t vsum_fd = open(vsum_fname, O_RDONLY);
+  if (vsum_fd == -1) {
+    return kPglRetSkipped;
+  }
+  struct stat statbuf;
+  if (unlikely(fstat(vsum_fd, &statbuf) < 0)) {
+    close(vsum_fd);
+    return kPglRetSkipped;
+  }
+  const uint64_t vsum_size = statbuf.st_size;
+  if (unlikely(vsum_size != sizeof(PgenVsumHeader) + raw_variant_ct * S_CAST(uint64_t, sizeof(PgenVariantSummary)))) {
+    close(vsum_fd);
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Warning: Ignoring %s, since it has the wrong size for %s.\n", vsum_fname, pgen_fname);
+    return kPglRetSkipped;
+  }
+  const unsigned char* vsum_base = S_CAST(const unsigned char*, mmap(0, vsum_size, PROT_READ, MAP_SHARED, vsum_fd, 0));
+  close(vsum_fd);
+  if (unlikely(R_CAST(uintptr_t, vsum_base) == (~k0LU))) {
+    return kPglRetSkipped;
+  }
+  PglErr reterr = kPglRetSkipped;
+  {
+    const PgenVsumHeader* vsum_headerp = R_CAST(const PgenVsumHeader*, vsum_base);
+    if (unlikely(stat(pgen_fname, &statbuf))) {
+      goto PgfiAttachVariantSummary_ret_STALE;
+    }
+    if (unlikely((!IsPgenVsumMagic(vsum_headerp->magic)) ||
+                 (vsum_headerp->variant_ct != raw_variant_ct) ||
+                 (vsum_headerp->sample_ct != pgfip->raw_sample_ct) ||
+                 (vsum_headerp->record_byte_ct != sizeof(PgenVariantSummary)) ||
+                 (vsum_headerp->pgen_fsize != S_CAST(uint64_t, statbuf.st_size)) ||
+                 (vsum_headerp->pgen_mtime != S_CAST(int64_t, statbuf.st_mtime)))) {
+      goto PgfiAttachVariantSummary_ret_STALE;
+    }
+    // Cheap (8 bytes per 64Ki variants), and catches a .vsum belonging to a
+    // different .pgen of the same size and mtime.
+    const uint32_t vblock_ct = DivUp(raw_variant_ct, kPglVblockSize);
+    uint64_t vblock_fpos_buf[kPglVblockSize / 8];
+    uint64_t vblock_fpos_hash = kPglVsumHashSeed;
+    for (uint32_t vblock_idx_start = 0; vblock_idx_start < vblock_ct; vblock_idx_start += kPglVblockSize / 8) {
+      const uint32_t cur_vblock_ct = MINV(vblock_ct - vblock_idx_start, kPglVblockSize / 8);
+      if (unlikely(PgiLoadVblockFpos(vblock_idx_start, cur_vblock_ct, pgfip, vblock_fpos_buf))) {
+        FillPgenReadErrstr(pgfip->shared_ff, errstr_buf);
+        reterr = kPglRetReadFail;
+        goto PgfiAttachVariantSummary_ret_1;
+      }
+      vblock_fpos_hash = PglVsumHashVblockFpos(vblock_fpos_buf, cur_vblock_ct, vblock_fpos_hash);
+    }
+    if (unlikely(vblock_fpos_hash != vsum_headerp->vblock_fpos_hash)) {
+      goto PgfiAttachVariantSummary_ret_STALE;
+    }
+    pgfip->vsums = R_CAST(const PgenVariantSummary*, &(vsum_base[sizeof(PgenVsumHeader)]));
+    pgfip->vsum_base = vsum_base;
+    pgfip->vsum_size = vsum_size;
+    return kPglRetSuccess;
+  }
+ PgfiAttachVariantSummary_ret_STALE:
+  snprintf(errstr_buf, kPglErrstrBufBlen, "Warning: Ignoring %s, since it is out of date relative to %s.\n", vsum_fname, pgen_fname);
+ PgfiAttachVariantSummary_ret_1:
+  munmap(K_CAST(unsigned char*, vsum_base), vsum_size);
+  return reterr;
+#endif
+}
+
 uint32_t GetLdbaseVidx(const unsigned char* vrtypes, uint32_t cur_vidx) {
 #ifdef __LP64__
   const VecW* vrtypes_valias = R_CAST(const VecW*, vrtypes);
@@ -1526,9 +2373,9 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
   } else {
     block_ct_m1 = (raw_variant_ct - 1) / block_size;
   }
-  const uint64_t* var_fpos = pgfip->var_fpos;
-  if ((!variant_include) && (!var_fpos)) {
-    return DivUpU64(S_CAST(uint64_t, pgfip->const_vrec_width) * block_size, kCacheline);
+  const uint32_t const_vrec_width = pgfip->const_vrec_width;
+  if ((!variant_include) && const_vrec_width) {
+    return DivUpU64(S_CAST(uint64_t, const_vrec_width) * block_size, kCacheline);
   }
   uint64_t max_block_byte_ct = 0;
   uint32_t max_block_variant_ct = 0;
@@ -1548,12 +2395,12 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
       }
       variant_uidx_end = 1 + FindLast1BitBefore(variant_include, variant_uidx_end);
     }
-    if (var_fpos) {
+    if (!const_vrec_width) {
       if (pgfip->vrtypes && ((pgfip->vrtypes[variant_uidx_start] & 6) == 2)) {
         // need to start loading from LD-buddy
         variant_uidx_start = GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start);
       }
-      uint64_t cur_block_byte_ct = var_fpos[variant_uidx_end] - var_fpos[variant_uidx_start];
+      uint64_t cur_block_byte_ct = GetPgfiFpos(pgfip, variant_uidx_end) - GetPgfiFpos(pgfip, variant_uidx_start);
       if (cur_block_byte_ct > max_block_byte_ct) {
         max_block_byte_ct = cur_block_byte_ct;
       }
@@ -1569,12 +2416,86 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
       }
     }
   }
-  if (!var_fpos) {
-    max_block_byte_ct = max_block_variant_ct * S_CAST(uint64_t, pgfip->const_vrec_width);
+  if (const_vrec_width) {
+    max_block_byte_ct = max_block_variant_ct * S_CAST(uint64_t, const_vrec_width);
   }
   return DivUpU64(max_block_byte_ct, kCacheline);
 }
 
+#ifndef NO_PGEN_ZSTD
+// Pending PgfiMultiread() work in storage mode 0x12: variants [uidx_start,
+// uidx_end) of one frame, all of which are decompressed into block_base.
+typedef struct PgenZframeJobStruct {
+  uint32_t frame_idx;  // UINT32_MAX if nothing is pending
+  uint32_t uidx_start;
+  uint32_t uidx_end;
+#  ifndef NO_PGEN_IO_POOL
+  PgenIoTicket* ticketp;
+#  endif
+} PgenZframeJob;
+
+static BoolErr PgfiZstdDispatch(PgenZframeJob* zjobp, PgenFileInfo* pgfip) {
+  const uint32_t frame_idx = zjobp->frame_idx;
+  if (frame_idx == UINT32_MAX) {
+    return 0;
+  }
+  zjobp->frame_idx = UINT32_MAX;
+  const uint64_t frame_lfpos = GetPgfiFpos(pgfip, frame_idx * S_CAST(uintptr_t, kPglZframeSize));
+  const uint64_t lfpos_start = GetPgfiFpos(pgfip, zjobp->uidx_start);
+  const uint64_t byte_ct = GetPgfiFpos(pgfip, zjobp->uidx_end) - lfpos_start;
+  unsigned char* dst = K_CAST(unsigned char*, &(pgfip->block_base[lfpos_start - pgfip->block_offset]));
+  const uint64_t src_fpos = pgfip->zframe_fpos[frame_idx];
+  const uint64_t src_byte_ct = pgfip->zframe_fpos[frame_idx + 1] - src_fpos;
+#  ifndef NO_PGEN_IO_POOL
+  if (pgfip->io_pool) {
+    PgenIoPoolSubmitZstd(fileno(pgfip->shared_ff), src_fpos, src_byte_ct, lfpos_start - frame_lfpos, byte_ct, dst, zjobp->ticketp, pgfip->io_pool);
+    return 0;
+  }
+#  endif
+  PgenZstdStream* zsp = pgfip->zstream;
+  if (!zsp) {
+    zsp = CreatePgenZstdStream();
+    if (unlikely(!zsp)) {
+      errno = ENOMEM;
+      return 1;
+    }
+    pgfip->zstream = zsp;
+  }
+  // Consecutive blocks frequently share a frame.
+  if ((zsp->frame_idx != frame_idx) || (zsp->lfpos > lfpos_start)) {
+    PgenZstdStreamOpen(src_fpos, src_byte_ct, frame_lfpos, frame_idx, zsp);
+  }
+  if (unlikely(PgenZstdStreamRead(pgfip->shared_ff, -1, lfpos_start - zsp->lfpos, nullptr, zsp) ||
+               PgenZstdStreamRead(pgfip->shared_ff, -1, byte_ct, dst, zsp))) {
+    zsp->frame_idx = UINT32_MAX;
+    return 1;
+  }
+  return 0;
+}
+
+// Adds variants [uidx_start, uidx_end) to the pending work, dispatching
+// whenever we move on to a new frame.
+static BoolErr PgfiZstdReadSpan(uint32_t uidx_start, uint32_t uidx_end, PgenFileInfo* pgfip, PgenZframeJob* zjobp) {
+  const uint32_t frame_idx_last = (uidx_end - 1) / kPglZframeSize;
+  for (uint32_t frame_idx = uidx_start / kPglZframeSize; frame_idx <= frame_idx_last; ++frame_idx) {
+    const uint32_t cur_uidx_start = MAXV(uidx_start, frame_idx * kPglZframeSize);
+    const uint32_t cur_uidx_end = MINV(uidx_end, (frame_idx + 1) * kPglZframeSize);
+    if (frame_idx == zjobp->frame_idx) {
+      // Any gap is decompressed anyway, so just extend the pending job.
+      zjobp->uidx_end = cur_uidx_end;
+      continue;
+    }
+    if (unlikely(PgfiZstdDispatch(zjobp, pgfip))) {
+      return 1;
+    }
+    zjobp->frame_idx = frame_idx;
+    zjobp->uidx_start = cur_uidx_start;
+    zjobp->uidx_end = cur_uidx_end;
+  }
+  return 0;
+}
+#endif
+
 PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip) {
   // we could permit 0, but that encourages lots of unnecessary thread wakeups
   assert(load_variant_ct);
@@ -1582,22 +2503,34 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
     variant_uidx_start = AdvTo1Bit(variant_include, variant_uidx_start);
   }
   assert(variant_uidx_start < pgfip->raw_variant_ct);
-  uint64_t block_offset;
+  uint32_t next_read_uidx_start = variant_uidx_start;
   if (pgfip->vrtypes && ((pgfip->vrtypes[variant_uidx_start] & 6) == 2)) {
     // need to start loading from LD-buddy
     // assume for now that we can't skip any variants between the LD-buddy and
     // the actual first variant; should remove this assumption later
-    block_offset = pgfip->var_fpos[GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start)];
-  } else {
-    block_offset = GetPgfiFpos(pgfip, variant_uidx_start);
+    next_read_uidx_start = GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start);
   }
+  const uint64_t block_offset = GetPgfiFpos(pgfip, next_read_uidx_start);
   pgfip->block_offset = block_offset;
   uint64_t next_read_start_fpos = block_offset;
+#ifndef NO_PGEN_IO_POOL
+  PgenIoPool* io_poolp = pgfip->io_pool;
+  PgenIoTicket ticket;
+  PgenIoTicketInit(&ticket);
+#endif
+#ifndef NO_PGEN_ZSTD
+  PgenZframeJob zjob;
+  zjob.frame_idx = UINT32_MAX;
+#  ifndef NO_PGEN_IO_POOL
+  zjob.ticketp = &ticket;
+#  endif
+#endif
   // break this up into multiple freads whenever this lets us skip an entire
   // disk block
   // (possible todo: make the disk block size a parameter of this function)
   do {
     const uint64_t cur_read_start_fpos = next_read_start_fpos;
+    __maybe_unused const uint32_t cur_read_uidx_start = next_read_uidx_start;
     uint32_t cur_read_uidx_end;
     uint64_t cur_read_end_fpos;
     while (1) {
@@ -1614,13 +2547,15 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
         break;
       }
       variant_uidx_start = AdvTo1Bit(variant_include, cur_read_uidx_end);
+      next_read_uidx_start = variant_uidx_start;
       next_read_start_fpos = GetPgfiFpos(pgfip, variant_uidx_start);
       if (pgfip->vrtypes && ((pgfip->vrtypes[variant_uidx_start] & 6) == 2)) {
         const uint32_t variant_read_uidx_start = GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start);
         if (variant_read_uidx_start <= cur_read_uidx_end) {
           continue;
         }
-        next_read_start_fpos = pgfip->var_fpos[variant_read_uidx_start];
+        next_read_uidx_start = variant_read_uidx_start;
+        next_read_start_fpos = GetPgfiFpos(pgfip, variant_read_uidx_start);
       }
       // bugfix: can't use do..while, since previous "continue" needs to skip
       // this check
@@ -1629,24 +2564,705 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
         break;
       }
     }
+    uintptr_t len = cur_read_end_fpos - cur_read_start_fpos;
+    unsigned char* cur_dst = K_CAST(unsigned char*, &(pgfip->block_base[cur_read_start_fpos - block_offset]));
+#ifndef NO_PGEN_ZSTD
+    if (pgfip->zframe_fpos) {
+      if (unlikely(PgfiZstdReadSpan(cur_read_uidx_start, cur_read_uidx_end, pgfip, &zjob))) {
+        return kPglRetReadFail;
+      }
+      continue;
+    }
+#endif
+#ifndef NO_PGEN_IO_POOL
+    if (io_poolp) {
+      const int32_t fd = fileno(pgfip->shared_ff);
+      uint64_t cur_fpos = cur_read_start_fpos;
+      while (len) {
+        const uintptr_t cur_len = MINV(len, kPgenIoChunkSize);
+        PgenIoPoolSubmit(fd, cur_fpos, cur_len, cur_dst, &ticket, io_poolp);
+        cur_fpos += cur_len;
+        cur_dst = &(cur_dst[cur_len]);
+        len -= cur_len;
+      }
+      continue;
+    }
+#endif
     if (unlikely(fseeko(pgfip->shared_ff, cur_read_start_fpos, SEEK_SET))) {
       return kPglRetReadFail;
     }
-    uintptr_t len = cur_read_end_fpos - cur_read_start_fpos;
-    if (unlikely(fread_checked(K_CAST(unsigned char*, &(pgfip->block_base[cur_read_start_fpos - block_offset])), len, pgfip->shared_ff))) {
+    if (unlikely(fread_checked(cur_dst, len, pgfip->shared_ff))) {
       if (feof_unlocked(pgfip->shared_ff)) {
         errno = 0;
       }
-      return kPglRetReadFail;
+      return kPglRetReadFail;
+    }
+  } while (load_variant_ct);
+#ifndef NO_PGEN_ZSTD
+  if (pgfip->zframe_fpos) {
+    if (unlikely(PgfiZstdDispatch(&zjob, pgfip))) {
+      return kPglRetReadFail;
+    }
+  }
+#endif
+#ifndef NO_PGEN_IO_POOL
+  if (io_poolp) {
+    if (unlikely(PgenIoPoolWait(&ticket, io_poolp))) {
+      return kPglRetReadFail;
+    }
+  }
+#endif
+  return kPglRetSuccess;
+}
+
+#ifndef NO_PGEN_IO_POOL
+typedef struct PgenIoRequestStruct {
+  unsigned char* dst;
+  uint64_t fpos;
+  uintptr_t byte_ct;
+  // Storage mode 0x12 decompression requests only (src_byte_ct is zero for
+  // plain reads): fpos and src_byte_ct describe a zstd frame, and the output
+  // bytes [skip_ct, skip_ct + byte_ct) are written to dst.
+  uint64_t src_byte_ct;
+  uint64_t skip_ct;
+  PgenIoTicket* ticketp;
+  int32_t fd;
+} PgenIoRequest;
+
+struct PgenIoPoolStruct {
+  pthread_mutex_t mutex;
+  // signaled when a request is queued, or on shutdown
+  pthread_cond_t request_condvar;
+  // signaled when a queue entry is freed
+  pthread_cond_t space_condvar;
+  // broadcast when a request completes
+  pthread_cond_t done_condvar;
+
+  PgenIoRequest* queue;
+  uint32_t queue_capacity;
+  uint32_t queue_start;
+  uint32_t queue_ct;
+  uint32_t shutdown;
+
+  uint32_t thread_ct;
+  pthread_t* threads;
+
+  PgenIoPoolStats stats;
+};
+
+static inline uint64_t PgenIoNanoseconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(uint64_t, ts.tv_sec) * 1000000000LLU + S_CAST(uint64_t, ts.tv_nsec);
+}
+
+// Sets errno to 0 on premature EOF, for consistency with the fread() code
+// paths.
+static BoolErr PreadFull(int32_t fd, uint64_t fpos, uintptr_t byte_ct, unsigned char* dst) {
+  while (byte_ct) {
+    const uintptr_t cur_byte_ct = MINV(byte_ct, kMaxBytesPerIO);
+    const intptr_t read_ct = pread(fd, dst, cur_byte_ct, fpos);
+    if (read_ct <= 0) {
+      if ((read_ct == -1) && (errno == EINTR)) {
+        continue;
+      }
+      if (!read_ct) {
+        errno = 0;
+      }
+      return 1;
+    }
+    dst = &(dst[S_CAST(uintptr_t, read_ct)]);
+    fpos += S_CAST(uint64_t, read_ct);
+    byte_ct -= S_CAST(uintptr_t, read_ct);
+  }
+  return 0;
+}
+
+#ifndef NO_PGEN_ZSTD
+static BoolErr PgenIoZstdRead(const PgenIoRequest* reqp, PgenZstdStream** zspp) {
+  PgenZstdStream* zsp = *zspp;
+  if (!zsp) {
+    zsp = CreatePgenZstdStream();
+    if (unlikely(!zsp)) {
+      errno = ENOMEM;
+      return 1;
+    }
+    *zspp = zsp;
+  }
+  PgenZstdStreamOpen(reqp->fpos, reqp->src_byte_ct, 0, UINT32_MAX, zsp);
+  return PgenZstdStreamRead(nullptr, reqp->fd, reqp->skip_ct, nullptr, zsp) || PgenZstdStreamRead(nullptr, reqp->fd, reqp->byte_ct, reqp->dst, zsp);
+}
+#endif
+
+static void* PgenIoPoolThread(void* raw_arg) {
+  PgenIoPool* io_poolp = S_CAST(PgenIoPool*, raw_arg);
+#ifndef NO_PGEN_ZSTD
+  // lazily allocated
+  PgenZstdStream* zsp = nullptr;
+#endif
+  pthread_mutex_lock(&io_poolp->mutex);
+  while (1) {
+    while ((!io_poolp->queue_ct) && (!io_poolp->shutdown)) {
+      pthread_cond_wait(&io_poolp->request_condvar, &io_poolp->mutex);
+    }
+    if (!io_poolp->queue_ct) {
+      break;
+    }
+    const PgenIoRequest req = io_poolp->queue[io_poolp->queue_start];
+    io_poolp->queue_start += 1;
+    if (io_poolp->queue_start == io_poolp->queue_capacity) {
+      io_poolp->queue_start = 0;
+    }
+    io_poolp->queue_ct -= 1;
+    pthread_cond_signal(&io_poolp->space_condvar);
+    pthread_mutex_unlock(&io_poolp->mutex);
+
+#ifdef NO_PGEN_ZSTD
+    const BoolErr read_failed = PreadFull(req.fd, req.fpos, req.byte_ct, req.dst);
+#else
+    const BoolErr read_failed = req.src_byte_ct? PgenIoZstdRead(&req, &zsp) : PreadFull(req.fd, req.fpos, req.byte_ct, req.dst);
+#endif
+    const int32_t read_errno = read_failed? errno : 0;
+
+    pthread_mutex_lock(&io_poolp->mutex);
+    PgenIoTicket* ticketp = req.ticketp;
+    if (read_failed && (!ticketp->failed)) {
+      ticketp->failed = 1;
+      ticketp->errno_val = read_errno;
+    }
+    ticketp->pending_ct -= 1;
+    io_poolp->stats.request_ct += 1;
+    io_poolp->stats.byte_ct += req.byte_ct;
+    pthread_cond_broadcast(&io_poolp->done_condvar);
+  }
+  pthread_mutex_unlock(&io_poolp->mutex);
+#ifndef NO_PGEN_ZSTD
+  CleanupPgenZstdStream(zsp);
+#endif
+  return nullptr;
+}
+
+PglErr PgenIoPoolCreate(uint32_t thread_ct, uint32_t queue_capacity, PgenIoPool** io_poolpp) {
+  assert(thread_ct && queue_capacity);
+  *io_poolpp = nullptr;
+  PgenIoPool* io_poolp = S_CAST(PgenIoPool*, malloc(sizeof(PgenIoPool)));
+  if (unlikely(!io_poolp)) {
+    return kPglRetNomem;
+  }
+  io_poolp->queue = S_CAST(PgenIoRequest*, malloc(queue_capacity * sizeof(PgenIoRequest)));
+  io_poolp->threads = S_CAST(pthread_t*, malloc(thread_ct * sizeof(pthread_t)));
+  if (unlikely((!io_poolp->queue) || (!io_poolp->threads))) {
+    free_cond(io_poolp->queue);
+    free_cond(io_poolp->threads);
+    free(io_poolp);
+    return kPglRetNomem;
+  }
+  pthread_mutex_init(&io_poolp->mutex, nullptr);
+  pthread_cond_init(&io_poolp->request_condvar, nullptr);
+  pthread_cond_init(&io_poolp->space_condvar, nullptr);
+  pthread_cond_init(&io_poolp->done_condvar, nullptr);
+  io_poolp->queue_capacity = queue_capacity;
+  io_poolp->queue_start = 0;
+  io_poolp->queue_ct = 0;
+  io_poolp->shutdown = 0;
+  io_poolp->thread_ct = 0;
+  memset(&io_poolp->stats, 0, sizeof(PgenIoPoolStats));
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    if (unlikely(pthread_create(&(io_poolp->threads[tidx]), nullptr, PgenIoPoolThread, io_poolp))) {
+      CleanupPgenIoPool(io_poolp);
+      return kPglRetThreadCreateFail;
+    }
+    io_poolp->thread_ct = tidx + 1;
+  }
+  *io_poolpp = io_poolp;
+  return kPglRetSuccess;
+}
+
+static void PgenIoPoolEnqueue(const PgenIoRequest* reqp, PgenIoPool* io_poolp) {
+  pthread_mutex_lock(&io_poolp->mutex);
+  while (io_poolp->queue_ct == io_poolp->queue_capacity) {
+    pthread_cond_wait(&io_poolp->space_condvar, &io_poolp->mutex);
+  }
+  uint32_t queue_idx = io_poolp->queue_start + io_poolp->queue_ct;
+  if (queue_idx >= io_poolp->queue_capacity) {
+    queue_idx -= io_poolp->queue_capacity;
+  }
+  io_poolp->queue[queue_idx] = *reqp;
+  io_poolp->queue_ct += 1;
+  reqp->ticketp->pending_ct += 1;
+  pthread_cond_signal(&io_poolp->request_condvar);
+  pthread_mutex_unlock(&io_poolp->mutex);
+}
+
+void PgenIoPoolSubmit(int32_t fd, uint64_t fpos, uintptr_t byte_ct, unsigned char* dst, PgenIoTicket* ticketp, PgenIoPool* io_poolp) {
+  PgenIoRequest req;
+  req.dst = dst;
+  req.fpos = fpos;
+  req.byte_ct = byte_ct;
+  req.src_byte_ct = 0;
+  req.skip_ct = 0;
+  req.ticketp = ticketp;
+  req.fd = fd;
+  PgenIoPoolEnqueue(&req, io_poolp);
+}
+
+#ifndef NO_PGEN_ZSTD
+static void PgenIoPoolSubmitZstd(int32_t fd, uint64_t src_fpos, uint64_t src_byte_ct, uint64_t skip_ct, uintptr_t byte_ct, unsigned char* dst, PgenIoTicket* ticketp, PgenIoPool* io_poolp) {
+  PgenIoRequest req;
+  req.dst = dst;
+  req.fpos = src_fpos;
+  req.byte_ct = byte_ct;
+  req.src_byte_ct = src_byte_ct;
+  req.skip_ct = skip_ct;
+  req.ticketp = ticketp;
+  req.fd = fd;
+  PgenIoPoolEnqueue(&req, io_poolp);
+}
+#endif
+
+BoolErr PgenIoPoolWait(PgenIoTicket* ticketp, PgenIoPool* io_poolp) {
+  pthread_mutex_lock(&io_poolp->mutex);
+  if (ticketp->pending_ct) {
+    const uint64_t start_ns = PgenIoNanoseconds();
+    do {
+      pthread_cond_wait(&io_poolp->done_condvar, &io_poolp->mutex);
+    } while (ticketp->pending_ct);
+    io_poolp->stats.stall_ct += 1;
+    io_poolp->stats.stall_ns += PgenIoNanoseconds() - start_ns;
+  }
+  const uint32_t failed = ticketp->failed;
+  const int32_t errno_val = ticketp->errno_val;
+  pthread_mutex_unlock(&io_poolp->mutex);
+  if (unlikely(failed)) {
+    errno = errno_val;
+    return 1;
+  }
+  return 0;
+}
+
+uint32_t PgenIoTicketIsDone(PgenIoTicket* ticketp, PgenIoPool* io_poolp) {
+  pthread_mutex_lock(&io_poolp->mutex);
+  const uint32_t is_done = !ticketp->pending_ct;
+  pthread_mutex_unlock(&io_poolp->mutex);
+  return is_done;
+}
+
+void PgenIoPoolGetStats(PgenIoPool* io_poolp, PgenIoPoolStats* statsp) {
+  pthread_mutex_lock(&io_poolp->mutex);
+  *statsp = io_poolp->stats;
+  pthread_mutex_unlock(&io_poolp->mutex);
+}
+
+void CleanupPgenIoPool(PgenIoPool* io_poolp) {
+  if (!io_poolp) {
+    return;
+  }
+  pthread_mutex_lock(&io_poolp->mutex);
+  io_poolp->shutdown = 1;
+  pthread_cond_broadcast(&io_poolp->request_condvar);
+  pthread_mutex_unlock(&io_poolp->mutex);
+  const uint32_t thread_ct = io_poolp->thread_ct;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    pthread_join(io_poolp->threads[tidx], nullptr);
+  }
+  pthread_cond_destroy(&io_poolp->done_condvar);
+  pthread_cond_destroy(&io_poolp->space_condvar);
+  pthread_cond_destroy(&io_poolp->request_condvar);
+  pthread_mutex_destroy(&io_poolp->mutex);
+  free(io_poolp->threads);
+  free(io_poolp->queue);
+  free(io_poolp);
+}
+
+PglErr PgfiAttachIoPool(uint32_t thread_ct, PgenFileInfo* pgfip) {
+  if (unlikely((!pgfip->shared_ff) || pgfip->io_pool)) {
+    return kPglRetImproperFunctionCall;
+  }
+  // A few requests per thread is enough to keep everyone busy while the
+  // submitter is still walking the block.
+  return PgenIoPoolCreate(thread_ct, 4 * thread_ct, &pgfip->io_pool);
+}
+#endif
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION PgenVrecCacheMutex;
+
+static inline void VrecCacheMutexInit(PgenVrecCacheMutex* mutexp) {
+  InitializeCriticalSection(mutexp);
+}
+
+static inline void VrecCacheLock(PgenVrecCacheMutex* mutexp) {
+  EnterCriticalSection(mutexp);
+}
+
+static inline void VrecCacheUnlock(PgenVrecCacheMutex* mutexp) {
+  LeaveCriticalSection(mutexp);
+}
+
+static inline void VrecCacheMutexDestroy(PgenVrecCacheMutex* mutexp) {
+  DeleteCriticalSection(mutexp);
+}
+#else
+typedef pthread_mutex_t PgenVrecCacheMutex;
+
+static inline void VrecCacheMutexInit(PgenVrecCacheMutex* mutexp) {
+  pthread_mutex_init(mutexp, nullptr);
+}
+
+static inline void VrecCacheLock(PgenVrecCacheMutex* mutexp) {
+  pthread_mutex_lock(mutexp);
+}
+
+static inline void VrecCacheUnlock(PgenVrecCacheMutex* mutexp) {
+  pthread_mutex_unlock(mutexp);
+}
+
+static inline void VrecCacheMutexDestroy(PgenVrecCacheMutex* mutexp) {
+  pthread_mutex_destroy(mutexp);
+}
+#endif
+
+// Payload immediately follows the header.
+typedef struct PgenVrecCacheEntryStruct {
+  struct PgenVrecCacheEntryStruct* hash_next;
+  // lru_prev points toward the most-recently-used end of the list
+  struct PgenVrecCacheEntryStruct* lru_prev;
+  struct PgenVrecCacheEntryStruct* lru_next;
+  uintptr_t payload_byte_ct;
+  uint32_t file_id;
+  uint32_t vidx;
+  uint32_t is_ldbase_genovec;
+} PgenVrecCacheEntry;
+
+typedef struct PgenVrecCacheFileStruct {
+  uint64_t dev;
+  uint64_t ino;
+  uint64_t size;
+  int64_t mtime;
+  // set when ino is unavailable; such entries never match a later attachment
+  uint32_t unshared;
+} PgenVrecCacheFile;
+
+struct PgenVrecCacheStruct {
+  PgenVrecCacheMutex mutex;
+
+  // chained hash table; bucket_ct is a power of 2
+  PgenVrecCacheEntry** buckets;
+  uint32_t bucket_ct;
+
+  uint32_t refcount;
+  PgenVrecCacheFlags flags;
+
+  // file_id indexes into this
+  PgenVrecCacheFile* files;
+  uint32_t file_ct;
+  uint32_t file_capacity;
+
+  PgenVrecCacheEntry* lru_head;
+  PgenVrecCacheEntry* lru_tail;
+
+  PgenVrecCacheStats stats;
+};
+
+CONSTI32(kVrecCacheInitBucketCt, 1024);
+
+static inline uint32_t VrecCacheBucketIdx(uint32_t file_id, uint32_t vidx, uint32_t is_ldbase_genovec, uint32_t bucket_ct) {
+  const uint64_t key = (S_CAST(uint64_t, file_id) << 33) | (S_CAST(uint64_t, vidx) << 1) | is_ldbase_genovec;
+  // Fibonacci hashing
+  return S_CAST(uint32_t, (key * 0x9e3779b97f4a7c15LLU) >> 32) & (bucket_ct - 1);
+}
+
+static inline unsigned char* VrecCachePayload(PgenVrecCacheEntry* entryp) {
+  return R_CAST(unsigned char*, &(entryp[1]));
+}
+
+static PgenVrecCacheEntry* VrecCacheFind(uint32_t file_id, uint32_t vidx, uint32_t is_ldbase_genovec, const PgenVrecCache* vrec_cachep) {
+  PgenVrecCacheEntry* entryp = vrec_cachep->buckets[VrecCacheBucketIdx(file_id, vidx, is_ldbase_genovec, vrec_cachep->bucket_ct)];
+  for (; entryp; entryp = entryp->hash_next) {
+    if ((entryp->vidx == vidx) && (entryp->file_id == file_id) && (entryp->is_ldbase_genovec == is_ldbase_genovec)) {
+      break;
+    }
+  }
+  return entryp;
+}
+
+static void VrecCacheLruUnlink(PgenVrecCacheEntry* entryp, PgenVrecCache* vrec_cachep) {
+  if (entryp->lru_prev) {
+    entryp->lru_prev->lru_next = entryp->lru_next;
+  } else {
+    vrec_cachep->lru_head = entryp->lru_next;
+  }
+  if (entryp->lru_next) {
+    entryp->lru_next->lru_prev = entryp->lru_prev;
+  } else {
+    vrec_cachep->lru_tail = entryp->lru_prev;
+  }
+}
+
+static void VrecCacheLruPushFront(PgenVrecCacheEntry* entryp, PgenVrecCache* vrec_cachep) {
+  entryp->lru_prev = nullptr;
+  entryp->lru_next = vrec_cachep->lru_head;
+  if (vrec_cachep->lru_head) {
+    vrec_cachep->lru_head->lru_prev = entryp;
+  } else {
+    vrec_cachep->lru_tail = entryp;
+  }
+  vrec_cachep->lru_head = entryp;
+}
+
+static void VrecCacheEvictLru(PgenVrecCache* vrec_cachep) {
+  PgenVrecCacheEntry* entryp = vrec_cachep->lru_tail;
+  PgenVrecCacheEntry** hash_linkp = &(vrec_cachep->buckets[VrecCacheBucketIdx(entryp->file_id, entryp->vidx, entryp->is_ldbase_genovec, vrec_cachep->bucket_ct)]);
+  while (*hash_linkp != entryp) {
+    hash_linkp = &((*hash_linkp)->hash_next);
+  }
+  *hash_linkp = entryp->hash_next;
+  VrecCacheLruUnlink(entryp, vrec_cachep);
+  vrec_cachep->stats.entry_ct -= 1;
+  vrec_cachep->stats.byte_ct -= sizeof(PgenVrecCacheEntry) + entryp->payload_byte_ct;
+  vrec_cachep->stats.evict_ct += 1;
+  free(entryp);
+}
+
+// Best-effort; on allocation failure we just keep the current table size.
+static void VrecCacheGrowBuckets(PgenVrecCache* vrec_cachep) {
+  const uint32_t old_bucket_ct = vrec_cachep->bucket_ct;
+  if (old_bucket_ct >= 0x80000000U) {
+    return;
+  }
+  const uint32_t new_bucket_ct = old_bucket_ct * 2;
+  PgenVrecCacheEntry** new_buckets = S_CAST(PgenVrecCacheEntry**, calloc(new_bucket_ct, sizeof(intptr_t)));
+  if (!new_buckets) {
+    return;
+  }
+  PgenVrecCacheEntry** old_buckets = vrec_cachep->buckets;
+  for (uint32_t bucket_idx = 0; bucket_idx != old_bucket_ct; ++bucket_idx) {
+    PgenVrecCacheEntry* entryp = old_buckets[bucket_idx];
+    while (entryp) {
+      PgenVrecCacheEntry* next_entryp = entryp->hash_next;
+      const uint32_t new_bucket_idx = VrecCacheBucketIdx(entryp->file_id, entryp->vidx, entryp->is_ldbase_genovec, new_bucket_ct);
+      entryp->hash_next = new_buckets[new_bucket_idx];
+      new_buckets[new_bucket_idx] = entryp;
+      entryp = next_entryp;
+    }
+  }
+  free(old_buckets);
+  vrec_cachep->buckets = new_buckets;
+  vrec_cachep->bucket_ct = new_bucket_ct;
+}
+
+// Copies the cached payload to dst and returns 1 on hit.
+static uint32_t VrecCacheGet(uint32_t file_id, uint32_t vidx, uint32_t is_ldbase_genovec, PgenVrecCache* vrec_cachep, void* dst) {
+  VrecCacheLock(&vrec_cachep->mutex);
+  PgenVrecCacheEntry* entryp = VrecCacheFind(file_id, vidx, is_ldbase_genovec, vrec_cachep);
+  if (!entryp) {
+    if (is_ldbase_genovec) {
+      vrec_cachep->stats.ldbase_miss_ct += 1;
+    } else {
+      vrec_cachep->stats.record_miss_ct += 1;
+    }
+    VrecCacheUnlock(&vrec_cachep->mutex);
+    return 0;
+  }
+  if (is_ldbase_genovec) {
+    vrec_cachep->stats.ldbase_hit_ct += 1;
+  } else {
+    vrec_cachep->stats.record_hit_ct += 1;
+  }
+  if (vrec_cachep->lru_head != entryp) {
+    VrecCacheLruUnlink(entryp, vrec_cachep);
+    VrecCacheLruPushFront(entryp, vrec_cachep);
+  }
+  memcpy(dst, VrecCachePayload(entryp), entryp->payload_byte_ct);
+  VrecCacheUnlock(&vrec_cachep->mutex);
+  return 1;
+}
+
+// Best-effort: silently does nothing if the entry is larger than the entire
+// budget, or on allocation failure.
+static void VrecCachePut(uint32_t file_id, uint32_t vidx, uint32_t is_ldbase_genovec, const void* src, uintptr_t byte_ct, PgenVrecCache* vrec_cachep) {
+  const uintptr_t entry_byte_ct = sizeof(PgenVrecCacheEntry) + byte_ct;
+  if (entry_byte_ct > vrec_cachep->stats.byte_budget) {
+    return;
+  }
+  // Allocate and fill outside the critical section.
+  PgenVrecCacheEntry* new_entryp = S_CAST(PgenVrecCacheEntry*, malloc(entry_byte_ct));
+  if (!new_entryp) {
+    return;
+  }
+  new_entryp->payload_byte_ct = byte_ct;
+  new_entryp->file_id = file_id;
+  new_entryp->vidx = vidx;
+  new_entryp->is_ldbase_genovec = is_ldbase_genovec;
+  memcpy(VrecCachePayload(new_entryp), src, byte_ct);
+  VrecCacheLock(&vrec_cachep->mutex);
+  if (VrecCacheFind(file_id, vidx, is_ldbase_genovec, vrec_cachep)) {
+    // another reader got here first
+    VrecCacheUnlock(&vrec_cachep->mutex);
+    free(new_entryp);
+    return;
+  }
+  while (vrec_cachep->stats.byte_ct + entry_byte_ct > vrec_cachep->stats.byte_budget) {
+    VrecCacheEvictLru(vrec_cachep);
+  }
+  if (vrec_cachep->stats.entry_ct >= vrec_cachep->bucket_ct) {
+    VrecCacheGrowBuckets(vrec_cachep);
+  }
+  PgenVrecCacheEntry** bucketp = &(vrec_cachep->buckets[VrecCacheBucketIdx(file_id, vidx, is_ldbase_genovec, vrec_cachep->bucket_ct)]);
+  new_entryp->hash_next = *bucketp;
+  *bucketp = new_entryp;
+  VrecCacheLruPushFront(new_entryp, vrec_cachep);
+  vrec_cachep->stats.entry_ct += 1;
+  vrec_cachep->stats.byte_ct += entry_byte_ct;
+  VrecCacheUnlock(&vrec_cachep->mutex);
+}
+
+PglErr PgenVrecCacheCreate(uintptr_t byte_budget, PgenVrecCacheFlags flags, PgenVrecCache** vrec_cachepp) {
+  *vrec_cachepp = nullptr;
+  PgenVrecCache* vrec_cachep = S_CAST(PgenVrecCache*, malloc(sizeof(PgenVrecCache)));
+  if (unlikely(!vrec_cachep)) {
+    return kPglRetNomem;
+  }
+  vrec_cachep->buckets = S_CAST(PgenVrecCacheEntry**, calloc(kVrecCacheInitBucketCt, sizeof(intptr_t)));
+  if (unlikely(!vrec_cachep->buckets)) {
+    free(vrec_cachep);
+    return kPglRetNomem;
+  }
+  VrecCacheMutexInit(&vrec_cachep->mutex);
+  vrec_cachep->bucket_ct = kVrecCacheInitBucketCt;
+  vrec_cachep->refcount = 1;
+  vrec_cachep->flags = flags;
+  vrec_cachep->files = nullptr;
+  vrec_cachep->file_ct = 0;
+  vrec_cachep->file_capacity = 0;
+  vrec_cachep->lru_head = nullptr;
+  vrec_cachep->lru_tail = nullptr;
+  memset(&vrec_cachep->stats, 0, sizeof(PgenVrecCacheStats));
+  vrec_cachep->stats.byte_budget = byte_budget;
+  *vrec_cachepp = vrec_cachep;
+  return kPglRetSuccess;
+}
+
+void PgenVrecCacheRelease(PgenVrecCache** vrec_cachepp) {
+  PgenVrecCache* vrec_cachep = *vrec_cachepp;
+  if (!vrec_cachep) {
+    return;
+  }
+  *vrec_cachepp = nullptr;
+  VrecCacheLock(&vrec_cachep->mutex);
+  const uint32_t remaining_refcount = --vrec_cachep->refcount;
+  VrecCacheUnlock(&vrec_cachep->mutex);
+  if (remaining_refcount) {
+    return;
+  }
+  PgenVrecCacheEntry* entryp = vrec_cachep->lru_head;
+  while (entryp) {
+    PgenVrecCacheEntry* next_entryp = entryp->lru_next;
+    free(entryp);
+    entryp = next_entryp;
+  }
+  VrecCacheMutexDestroy(&vrec_cachep->mutex);
+  free_cond(vrec_cachep->files);
+  free(vrec_cachep->buckets);
+  free(vrec_cachep);
+}
+
+void PgenVrecCacheGetStats(PgenVrecCache* vrec_cachep, PgenVrecCacheStats* statsp) {
+  VrecCacheLock(&vrec_cachep->mutex);
+  *statsp = vrec_cachep->stats;
+  VrecCacheUnlock(&vrec_cachep->mutex);
+}
+
+PglErr PgfiAttachVrecCache(const char* fname, PgenVrecCache* vrec_cachep, PgenFileInfo* pgfip) {
+  if (unlikely(pgfip->vrec_cache)) {
+    return kPglRetImproperFunctionCall;
+  }
+  struct stat statbuf;
+  if (unlikely(stat(fname, &statbuf))) {
+    return kPglRetOpenFail;
+  }
+  PgenVrecCacheFile cur_file;
+  cur_file.dev = statbuf.st_dev;
+  cur_file.ino = statbuf.st_ino;
+  cur_file.size = statbuf.st_size;
+  cur_file.mtime = statbuf.st_mtime;
+  cur_file.unshared = !statbuf.st_ino;
+  VrecCacheLock(&vrec_cachep->mutex);
+  const uint32_t file_ct = vrec_cachep->file_ct;
+  uint32_t file_id = 0;
+  if (!cur_file.unshared) {
+    for (; file_id != file_ct; ++file_id) {
+      const PgenVrecCacheFile* filep = &(vrec_cachep->files[file_id]);
+      if ((!filep->unshared) && (filep->ino == cur_file.ino) && (filep->dev == cur_file.dev) && (filep->size == cur_file.size) && (filep->mtime == cur_file.mtime)) {
+        break;
+      }
     }
-  } while (load_variant_ct);
+  } else {
+    file_id = file_ct;
+  }
+  if (file_id == file_ct) {
+    if (file_ct == vrec_cachep->file_capacity) {
+      const uint32_t new_capacity = file_ct? (2 * file_ct) : 16;
+      PgenVrecCacheFile* new_files = S_CAST(PgenVrecCacheFile*, realloc(vrec_cachep->files, new_capacity * sizeof(PgenVrecCacheFile)));
+      if (unlikely(!new_files)) {
+        VrecCacheUnlock(&vrec_cachep->mutex);
+        return kPglRetNomem;
+      }
+      vrec_cachep->files = new_files;
+      vrec_cachep->file_capacity = new_capacity;
+    }
+    vrec_cachep->files[file_ct] = cur_file;
+    vrec_cachep->file_ct = file_ct + 1;
+  }
+  vrec_cachep->refcount += 1;
+  VrecCacheUnlock(&vrec_cachep->mutex);
+  pgfip->vrec_cache = vrec_cachep;
+  pgfip->vrec_cache_file_id = file_id;
   return kPglRetSuccess;
 }
 
+// The reader-side cache hooks below only apply in per-variant fread mode, and
+// stay out of the way of read-ahead.
+static inline PgenVrecCache* GetPgrVrecCache(const PgenReaderMain* pgrp) {
+  if ((!pgrp->fi.vrec_cache) || pgrp->fi.block_base || pgrp->readahead) {
+    return nullptr;
+  }
+  return pgrp->fi.vrec_cache;
+}
+
+static inline PgenVrecCache* GetPgrLdbaseCache(const PgenReaderMain* pgrp) {
+  PgenVrecCache* vrec_cachep = GetPgrVrecCache(pgrp);
+  if (vrec_cachep && (vrec_cachep->flags & kfPgenVrecCacheLdbaseGenovec)) {
+    return vrec_cachep;
+  }
+  return nullptr;
+}
+
+// On hit, fills raw_genovec (vector-aligned) with the unsubsetted LD base
+// genovec, updates fp_vidx as if it had been read, and returns 1.
+static uint32_t LdbaseCacheGet(uint32_t ldbase_vidx, PgenReaderMain* pgrp, uintptr_t* raw_genovec) {
+  PgenVrecCache* vrec_cachep = GetPgrLdbaseCache(pgrp);
+  if ((!vrec_cachep) || (!VrecCacheGet(pgrp->fi.vrec_cache_file_id, ldbase_vidx, 1, vrec_cachep, raw_genovec))) {
+    return 0;
+  }
+  pgrp->fp_vidx = ldbase_vidx + 1;
+  return 1;
+}
+
+static void LdbaseCachePut(uint32_t ldbase_vidx, const uintptr_t* raw_genovec, PgenReaderMain* pgrp) {
+  PgenVrecCache* vrec_cachep = GetPgrLdbaseCache(pgrp);
+  if (vrec_cachep) {
+    VrecCachePut(pgrp->fi.vrec_cache_file_id, ldbase_vidx, 1, raw_genovec, NypCtToVecCt(pgrp->fi.raw_sample_ct) * kBytesPerVec, vrec_cachep);
+  }
+}
+
 
 void PreinitPgr(PgenReader* pgr_ptr) {
   PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
   pgrp->ff = nullptr;
+  pgrp->readahead = nullptr;
+  pgrp->zstream = nullptr;
+  pgrp->fi.vrec_cache = nullptr;
 }
 
 PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip, PgenReader* pgr_ptr, unsigned char* pgr_alloc) {
@@ -1683,17 +3299,22 @@ PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip,
     }
     // now that arbitrary info can be stored between header and first variant
     // record, always seek.
-    uint64_t seek_pos;
-    if (pgfip->var_fpos) {
-      seek_pos = pgfip->var_fpos[0];
-    } else {
-      seek_pos = pgfip->const_fpos_offset;
-    }
-    if (unlikely(fseeko(pgrp->ff, seek_pos, SEEK_SET))) {
+    if (unlikely(fseeko(pgrp->ff, GetPgfiFpos(pgfip, 0), SEEK_SET))) {
       return kPglRetReadFail;
     }
   }
   pgrp->fi = *pgfip;  // struct copy
+  // belongs to pgfip
+  pgrp->fi.zstream = nullptr;
+  pgrp->readahead = nullptr;
+  pgrp->zstream = nullptr;
+  pgrp->fpos_cache_vidx = UINT32_MAX;
+  if (pgrp->fi.vrec_cache) {
+    PgenVrecCache* vrec_cachep = pgrp->fi.vrec_cache;
+    VrecCacheLock(&vrec_cachep->mutex);
+    vrec_cachep->refcount += 1;
+    VrecCacheUnlock(&vrec_cachep->mutex);
+  }
   if (fname) {
     // Mode 3 per-reader load buffer
     pgrp->fread_buf = pgr_alloc_iter;
@@ -1778,6 +3399,273 @@ PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip,
   return kPglRetSuccess;
 }
 
+#ifndef NO_PGEN_IO_POOL
+// Slot states.  A slot is "zombie" when the reader skipped past its variant
+// while the read was still in flight; it can't be reused until that read
+// completes.
+CONSTI32(kPgrReadaheadSlotFree, 0);
+CONSTI32(kPgrReadaheadSlotQueued, 1);
+CONSTI32(kPgrReadaheadSlotHeld, 2);
+CONSTI32(kPgrReadaheadSlotZombie, 3);
+
+struct PgrReadaheadStruct {
+  PgenIoPool* io_poolp;
+  int32_t fd;
+
+  // Schedule generator state.  Variants are emitted in increasing order,
+  // except that an LD base variant is emitted just before the first variant
+  // which needs it (unless we expect it to already be in the reader's LD
+  // cache).
+  const uintptr_t* variant_include;
+  uint32_t next_vidx;
+  uint32_t vidx_end;
+  uint32_t pending_vidx;  // UINT32_MAX if none
+  uint32_t sim_ldbase_vidx;
+
+  uint32_t window_size;
+  uintptr_t slot_byte_ct;
+  unsigned char* slot_bufs;
+  PgenIoTicket* slot_tickets;
+  uint32_t* slot_vidxs;
+  unsigned char* slot_states;
+
+  // Queued slots form a FIFO starting at fifo_start.
+  uint32_t fifo_start;
+  uint32_t fifo_ct;
+  uint32_t held_slot;  // UINT32_MAX if none
+
+  PgrReadaheadStats stats;
+};
+
+static uint32_t ReadaheadNextScheduled(const unsigned char* vrtypes, PgrReadahead* rap) {
+  uint32_t vidx = rap->pending_vidx;
+  if (vidx != UINT32_MAX) {
+    rap->pending_vidx = UINT32_MAX;
+    return vidx;
+  }
+  vidx = rap->next_vidx;
+  const uint32_t vidx_end = rap->vidx_end;
+  if ((vidx != vidx_end) && rap->variant_include) {
+    vidx = AdvBoundedTo1Bit(rap->variant_include, vidx, vidx_end);
+  }
+  if (vidx == vidx_end) {
+    rap->next_vidx = vidx_end;
+    return UINT32_MAX;
+  }
+  rap->next_vidx = vidx + 1;
+  if (vrtypes && VrtypeLdCompressed(vrtypes[vidx])) {
+    const uint32_t ldbase_vidx = GetLdbaseVidx(vrtypes, vidx);
+    if (ldbase_vidx != rap->sim_ldbase_vidx) {
+      rap->sim_ldbase_vidx = ldbase_vidx;
+      rap->pending_vidx = vidx;
+      return ldbase_vidx;
+    }
+  } else {
+    rap->sim_ldbase_vidx = vidx;
+  }
+  return vidx;
+}
+
+static void ReadaheadTopUp(const PgenFileInfo* pgfip, uint32_t min_vidx, PgrReadahead* rap) {
+  const uint32_t window_size = rap->window_size;
+  while (rap->fifo_ct != window_size) {
+    uint32_t slot_idx = rap->fifo_start + rap->fifo_ct;
+    if (slot_idx >= window_size) {
+      slot_idx -= window_size;
+    }
+    const uint32_t slot_state = rap->slot_states[slot_idx];
+    if (slot_state != kPgrReadaheadSlotFree) {
+      if ((slot_state != kPgrReadaheadSlotZombie) || (!PgenIoTicketIsDone(&(rap->slot_tickets[slot_idx]), rap->io_poolp))) {
+        return;
+      }
+      rap->slot_states[slot_idx] = kPgrReadaheadSlotFree;
+    }
+    uint32_t vidx;
+    do {
+      vidx = ReadaheadNextScheduled(pgfip->vrtypes, rap);
+      if (vidx == UINT32_MAX) {
+        return;
+      }
+    } while (vidx < min_vidx);
+    rap->slot_vidxs[slot_idx] = vidx;
+    rap->slot_states[slot_idx] = kPgrReadaheadSlotQueued;
+    PgenIoTicket* ticketp = &(rap->slot_tickets[slot_idx]);
+    PgenIoTicketInit(ticketp);
+    PgenIoPoolSubmit(rap->fd, GetPgfiFpos(pgfip, vidx), GetPgfiVrecWidth(pgfip, vidx), &(rap->slot_bufs[slot_idx * rap->slot_byte_ct]), ticketp, rap->io_poolp);
+    rap->fifo_ct += 1;
+  }
+}
+
+// Replacement for the fseeko()/fread() part of InitReadPtrs() when
+// read-ahead is active.
+static BoolErr ReadaheadFetch(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp) {
+  PgrReadahead* rap = pgrp->readahead;
+  const uint32_t window_size = rap->window_size;
+  if (rap->held_slot != UINT32_MAX) {
+    rap->slot_states[rap->held_slot] = kPgrReadaheadSlotFree;
+    rap->held_slot = UINT32_MAX;
+  }
+  while (rap->fifo_ct && (rap->slot_vidxs[rap->fifo_start] < vidx)) {
+    const uint32_t slot_idx = rap->fifo_start;
+    rap->slot_states[slot_idx] = PgenIoTicketIsDone(&(rap->slot_tickets[slot_idx]), rap->io_poolp)? kPgrReadaheadSlotFree : kPgrReadaheadSlotZombie;
+    rap->fifo_start = (slot_idx + 1 == window_size)? 0 : (slot_idx + 1);
+    rap->fifo_ct -= 1;
+  }
+  ReadaheadTopUp(&(pgrp->fi), vidx, rap);
+  pgrp->fp_vidx = vidx + 1;
+  if (rap->fifo_ct && (rap->slot_vidxs[rap->fifo_start] == vidx)) {
+    const uint32_t slot_idx = rap->fifo_start;
+    PgenIoTicket* ticketp = &(rap->slot_tickets[slot_idx]);
+    if (!PgenIoTicketIsDone(ticketp, rap->io_poolp)) {
+      const uint64_t start_ns = PgenIoNanoseconds();
+      rap->stats.stall_ct += 1;
+      if (unlikely(PgenIoPoolWait(ticketp, rap->io_poolp))) {
+        return 1;
+      }
+      rap->stats.stall_ns += PgenIoNanoseconds() - start_ns;
+    } else if (unlikely(PgenIoPoolWait(ticketp, rap->io_poolp))) {
+      // just picks up the error code
+      return 1;
+    }
+    rap->stats.hit_ct += 1;
+    rap->slot_states[slot_idx] = kPgrReadaheadSlotHeld;
+    rap->held_slot = slot_idx;
+    rap->fifo_start = (slot_idx + 1 == window_size)? 0 : (slot_idx + 1);
+    rap->fifo_ct -= 1;
+    unsigned char* slot_buf = &(rap->slot_bufs[slot_idx * rap->slot_byte_ct]);
+    *fread_pp = slot_buf;
+    *fread_endp = &(slot_buf[GetPgfiVrecWidth(&(pgrp->fi), vidx)]);
+    return 0;
+  }
+  // Not in the window; read synchronously.
+  rap->stats.miss_ct += 1;
+  const uintptr_t cur_vrec_width = GetPgfiVrecWidth(&(pgrp->fi), vidx);
+  const uint64_t start_ns = PgenIoNanoseconds();
+  if (unlikely(PreadFull(rap->fd, GetPgrFpos(vidx, pgrp), cur_vrec_width, pgrp->fread_buf))) {
+    return 1;
+  }
+  rap->stats.stall_ns += PgenIoNanoseconds() - start_ns;
+  *fread_pp = pgrp->fread_buf;
+  *fread_endp = &(pgrp->fread_buf[cur_vrec_width]);
+  return 0;
+}
+
+PglErr PgrReadaheadStart(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t window_size, uint32_t io_thread_ct, PgenReader* pgr_ptr) {
+  PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
+  PgrReadaheadStop(pgr_ptr);
+  if (unlikely((!pgrp->ff) || (!window_size) || (!io_thread_ct) || (variant_uidx_start > variant_uidx_end) || (variant_uidx_end > pgrp->fi.raw_variant_ct))) {
+    return kPglRetImproperFunctionCall;
+  }
+  if (pgrp->fi.zframe_fpos) {
+    // Raw reads can't be scheduled in storage mode 0x12; the per-reader
+    // decompressor already streams sequential requests efficiently.
+    return kPglRetNotYetSupported;
+  }
+  const PgenFileInfo* pgfip = &(pgrp->fi);
+  // Slot size: largest record we could schedule.  Include the LD base of the
+  // first variant, which may precede variant_uidx_start.
+  uintptr_t slot_byte_ct = 0;
+  if (variant_uidx_start != variant_uidx_end) {
+    uint32_t scan_start = variant_uidx_start;
+    if (pgfip->vrtypes && VrtypeLdCompressed(pgfip->vrtypes[scan_start])) {
+      scan_start = GetLdbaseVidx(pgfip->vrtypes, scan_start);
+    }
+    if (pgfip->const_vrec_width) {
+      slot_byte_ct = pgfip->const_vrec_width;
+    } else {
+      for (uint32_t vidx = scan_start; vidx != variant_uidx_end; ++vidx) {
+        const uintptr_t cur_vrec_width = GetPgfiVrecWidth(pgfip, vidx);
+        if (cur_vrec_width > slot_byte_ct) {
+          slot_byte_ct = cur_vrec_width;
+        }
+      }
+    }
+  }
+  slot_byte_ct = RoundUpPow2(slot_byte_ct, kCacheline);
+  PgrReadahead* rap = S_CAST(PgrReadahead*, malloc(sizeof(PgrReadahead)));
+  if (unlikely(!rap)) {
+    return kPglRetNomem;
+  }
+  rap->slot_bufs = nullptr;
+  rap->slot_tickets = S_CAST(PgenIoTicket*, malloc(window_size * sizeof(PgenIoTicket)));
+  rap->slot_vidxs = S_CAST(uint32_t*, malloc(window_size * sizeof(int32_t)));
+  rap->slot_states = S_CAST(unsigned char*, malloc(window_size));
+  if (unlikely((!rap->slot_tickets) || (!rap->slot_vidxs) || (!rap->slot_states) || (slot_byte_ct && cachealigned_malloc(slot_byte_ct * window_size, &rap->slot_bufs)))) {
+    goto PgrReadaheadStart_ret_NOMEM;
+  }
+  {
+    PglErr reterr = PgenIoPoolCreate(io_thread_ct, window_size, &rap->io_poolp);
+    if (unlikely(reterr)) {
+      free(rap->slot_states);
+      free(rap->slot_vidxs);
+      free(rap->slot_tickets);
+      aligned_free_cond(rap->slot_bufs);
+      free(rap);
+      return reterr;
+    }
+  }
+  rap->fd = fileno(pgrp->ff);
+  rap->variant_include = variant_include;
+  rap->next_vidx = variant_uidx_start;
+  rap->vidx_end = variant_uidx_end;
+  rap->pending_vidx = UINT32_MAX;
+  rap->sim_ldbase_vidx = UINT32_MAX;
+  rap->window_size = window_size;
+  rap->slot_byte_ct = slot_byte_ct;
+  memset(rap->slot_states, kPgrReadaheadSlotFree, window_size);
+  rap->fifo_start = 0;
+  rap->fifo_ct = 0;
+  rap->held_slot = UINT32_MAX;
+  memset(&rap->stats, 0, sizeof(PgrReadaheadStats));
+  pgrp->readahead = rap;
+  // Since pread() doesn't move the FILE* position, force the next
+  // non-read-ahead load to seek.
+  pgrp->fp_vidx = UINT32_MAX;
+  ReadaheadTopUp(pgfip, 0, rap);
+  return kPglRetSuccess;
+
+ PgrReadaheadStart_ret_NOMEM:
+  free_cond(rap->slot_states);
+  free_cond(rap->slot_vidxs);
+  free_cond(rap->slot_tickets);
+  aligned_free_cond(rap->slot_bufs);
+  free(rap);
+  return kPglRetNomem;
+}
+
+void PgrReadaheadStop(PgenReader* pgr_ptr) {
+  PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
+  PgrReadahead* rap = pgrp->readahead;
+  if (!rap) {
+    return;
+  }
+  // CleanupPgenIoPool() drains the queue before joining, so no read can
+  // still be writing to slot_bufs after this returns.
+  CleanupPgenIoPool(rap->io_poolp);
+  free(rap->slot_states);
+  free(rap->slot_vidxs);
+  free(rap->slot_tickets);
+  aligned_free_cond(rap->slot_bufs);
+  free(rap);
+  pgrp->readahead = nullptr;
+  pgrp->fp_vidx = UINT32_MAX;
+}
+
+void PgrGetReadaheadStats(const PgenReader* pgr_ptr, PgrReadaheadStats* statsp) {
+  const PgenReaderMain* pgrp = &GET_PRIVATE(*pgr_ptr, m);
+  if (!pgrp->readahead) {
+    memset(statsp, 0, sizeof(PgrReadaheadStats));
+    return;
+  }
+  *statsp = pgrp->readahead->stats;
+}
+#else
+static inline BoolErr ReadaheadFetch(__maybe_unused uint32_t vidx, __maybe_unused PgenReaderMain* pgrp, __maybe_unused const unsigned char** fread_pp, __maybe_unused const unsigned char** fread_endp) {
+  assert(0);
+  return 1;
+}
+#endif
+
 void PgrPlink1ToPlink2InplaceUnsafe(uint32_t sample_ct, uintptr_t* genovec) {
   // 00 -> 10, 01 -> 11, 10 -> 01, 11 -> 00
   // new low bit  = [old low] ^ [old high]
@@ -2373,20 +4261,48 @@ BoolErr InitReadPtrs(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char**
   if (block_base != nullptr) {
     // possible todo: special handling of end of vblock
     const uint64_t block_offset = pgrp->fi.block_offset;
-    *fread_pp = &(block_base[GetPgfiFpos(&(pgrp->fi), vidx) - block_offset]);
-    *fread_endp = &(block_base[GetPgfiFpos(&(pgrp->fi), vidx + 1) - block_offset]);
+    *fread_pp = &(block_base[GetPgrFpos(vidx, pgrp) - block_offset]);
+    *fread_endp = &((*fread_pp)[GetPgfiVrecWidth(&(pgrp->fi), vidx)]);
 
     // still a useful hint to LdLoadNecessary()
     pgrp->fp_vidx = vidx + 1;
 
     return 0;
   }
-  if (pgrp->fp_vidx != vidx) {
-    if (unlikely(fseeko(pgrp->ff, GetPgfiFpos(&(pgrp->fi), vidx), SEEK_SET))) {
+  if (pgrp->readahead) {
+    return ReadaheadFetch(vidx, pgrp, fread_pp, fread_endp);
+  }
+  const uintptr_t cur_vrec_width = GetPgfiVrecWidth(&(pgrp->fi), vidx);
+  PgenVrecCache* vrec_cachep = pgrp->fi.vrec_cache;
+  if (vrec_cachep) {
+    if (VrecCacheGet(pgrp->fi.vrec_cache_file_id, vidx, 0, vrec_cachep, pgrp->fread_buf)) {
+      *fread_pp = pgrp->fread_buf;
+      *fread_endp = &(pgrp->fread_buf[cur_vrec_width]);
+      // fp_vidx no longer tracks the file position in this case, so we
+      // always seek below.
+      pgrp->fp_vidx = vidx + 1;
+      return 0;
+    }
+  }
+#ifndef NO_PGEN_ZSTD
+  if (pgrp->fi.zframe_fpos) {
+    if (unlikely(PgrZstdRead(vidx, cur_vrec_width, pgrp->fread_buf, pgrp))) {
+      return 1;
+    }
+    *fread_pp = pgrp->fread_buf;
+    *fread_endp = &(pgrp->fread_buf[cur_vrec_width]);
+    pgrp->fp_vidx = vidx + 1;
+    if (vrec_cachep) {
+      VrecCachePut(pgrp->fi.vrec_cache_file_id, vidx, 0, pgrp->fread_buf, cur_vrec_width, vrec_cachep);
+    }
+    return 0;
+  }
+#endif
+  if ((pgrp->fp_vidx != vidx) || vrec_cachep) {
+    if (unlikely(fseeko(pgrp->ff, GetPgrFpos(vidx, pgrp), SEEK_SET))) {
       return 1;
     }
   }
-  const uintptr_t cur_vrec_width = GetPgfiVrecWidth(&(pgrp->fi), vidx);
 #ifdef __LP64__
   if (unlikely(fread_checked(pgrp->fread_buf, cur_vrec_width, pgrp->ff))) {
     if (feof_unlocked(pgrp->ff)) {
@@ -2406,6 +4322,9 @@ BoolErr InitReadPtrs(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char**
   *fread_pp = pgrp->fread_buf;
   *fread_endp = &(pgrp->fread_buf[cur_vrec_width]);
   pgrp->fp_vidx = vidx + 1;
+  if (vrec_cachep) {
+    VrecCachePut(pgrp->fi.vrec_cache_file_id, vidx, 0, pgrp->fread_buf, cur_vrec_width, vrec_cachep);
+  }
   return 0;
 }
 
@@ -2438,21 +4357,50 @@ uint32_t LdLoadNecessary(uint32_t cur_vidx, PgenReaderMain* pgrp) {
 // no explicit reload of ldbase is needed for next variant if we're extracting
 // the same sample subset.  (Reload is occasionally needed if next variant is
 // multiallelic or phased, we only prevent that when convenient.)
-PglErr LdLoadAndCopyGenovecSubset(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, uint32_t vidx, PgenReaderMain* pgrp, uintptr_t* dest) {
+// Loads (subsetted) pgrp->ldbase_vidx into dest, and sets ldbase_stypes
+// accordingly.  Consults pgrp->fi.vrec_cache when appropriate.
+PglErr LdLoadGenovecSubsetMain(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, PgenReaderMain* pgrp, uintptr_t* __restrict dest) {
+  const uint32_t ldbase_vidx = pgrp->ldbase_vidx;
   const uint32_t raw_sample_ct = pgrp->fi.raw_sample_ct;
-  if (LdLoadNecessary(vidx, pgrp)) {
-    const uint32_t ldbase_vidx = pgrp->ldbase_vidx;
-    const unsigned char* fread_ptr;
-    const unsigned char* fread_end;
-    if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
-      return kPglRetReadFail;
+  const uint32_t subsetting_required = (sample_ct != raw_sample_ct);
+  if (subsetting_required) {
+    if (LdbaseCacheGet(ldbase_vidx, pgrp, pgrp->ldbase_raw_genovec)) {
+      CopyNyparrNonemptySubset(pgrp->ldbase_raw_genovec, sample_include, raw_sample_ct, sample_ct, dest);
+      pgrp->ldbase_stypes = kfPgrLdcacheNyp | kfPgrLdcacheRawNyp;
+      return kPglRetSuccess;
     }
-    const uint32_t vrtype = pgrp->fi.vrtypes[ldbase_vidx];
-    PglErr reterr = ParseNonLdGenovecSubsetUnsafe(fread_end, sample_include, sample_include_cumulative_popcounts, sample_ct, vrtype, &fread_ptr, pgrp, dest);
-    pgrp->ldbase_stypes = ((sample_ct != raw_sample_ct) && (!(vrtype & 4)))? (kfPgrLdcacheNyp | kfPgrLdcacheRawNyp) : kfPgrLdcacheNyp;
+  } else if (LdbaseCacheGet(ldbase_vidx, pgrp, dest)) {
+    pgrp->ldbase_stypes = kfPgrLdcacheNyp;
+    return kPglRetSuccess;
+  }
+  const unsigned char* fread_ptr;
+  const unsigned char* fread_end;
+  if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
+    return kPglRetReadFail;
+  }
+  const uint32_t vrtype = pgrp->fi.vrtypes[ldbase_vidx];
+  // bugfix (6 Mar 2019): ldbase_raw_genovec is only filled in (!difflist) &&
+  //   subsetting_required case; (!difflist) isn't enough
+  const uint32_t raw_genovec_saved = subsetting_required && (!(vrtype & 4));
+  pgrp->ldbase_stypes = raw_genovec_saved? (kfPgrLdcacheNyp | kfPgrLdcacheRawNyp) : kfPgrLdcacheNyp;
+  const PglErr reterr = ParseNonLdGenovecSubsetUnsafe(fread_end, sample_include, sample_include_cumulative_popcounts, sample_ct, vrtype, &fread_ptr, pgrp, dest);
+  if (!reterr) {
+    if (!subsetting_required) {
+      LdbaseCachePut(ldbase_vidx, dest, pgrp);
+    } else if (raw_genovec_saved) {
+      LdbaseCachePut(ldbase_vidx, pgrp->ldbase_raw_genovec, pgrp);
+    }
+  }
+  return reterr;
+}
+
+PglErr LdLoadAndCopyGenovecSubset(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, uint32_t vidx, PgenReaderMain* pgrp, uintptr_t* dest) {
+  if (LdLoadNecessary(vidx, pgrp)) {
+    const PglErr reterr = LdLoadGenovecSubsetMain(sample_include, sample_include_cumulative_popcounts, sample_ct, pgrp, dest);
     CopyNyparr(dest, sample_ct, pgrp->ldbase_genovec);
     return reterr;
   }
+  const uint32_t raw_sample_ct = pgrp->fi.raw_sample_ct;
   if (pgrp->ldbase_stypes & kfPgrLdcacheNyp) {
     CopyNyparr(pgrp->ldbase_genovec, sample_ct, dest);
   } else {
@@ -2557,15 +4505,19 @@ PglErr LdLoadAndCopyRawGenovec(uint32_t subsetting_required, uint32_t vidx, Pgen
   const uint32_t genovec_byte_ct = NypCtToVecCt(pgrp->fi.raw_sample_ct) * kBytesPerVec;
   if (LdLoadNecessary(vidx, pgrp) || (subsetting_required && (!(pgrp->ldbase_stypes & kfPgrLdcacheRawNyp)))) {
     const uint32_t ldbase_vidx = pgrp->ldbase_vidx;
+    uintptr_t* raw_genovec = pgrp->ldbase_raw_genovec;
+    pgrp->ldbase_stypes = kfPgrLdcacheRawNyp;
+    if (LdbaseCacheGet(ldbase_vidx, pgrp, raw_genovec)) {
+      memcpy(dest, raw_genovec, genovec_byte_ct);
+      return kPglRetSuccess;
+    }
     const unsigned char* fread_ptr;
     const unsigned char* fread_end;
     if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
       return kPglRetReadFail;
     }
     const uint32_t vrtype = pgrp->fi.vrtypes[ldbase_vidx];
-    pgrp->ldbase_stypes = kfPgrLdcacheRawNyp;
     assert((vrtype & 7) != 5); // all-hom-ref can't be ldbase
-    uintptr_t* raw_genovec = pgrp->ldbase_raw_genovec;
     PglErr reterr;
     if (!(vrtype & 4)) {
       reterr = Parse1or2bitGenoarrUnsafe(fread_end, vrtype, &fread_ptr, pgrp, raw_genovec);
@@ -2574,6 +4526,9 @@ PglErr LdLoadAndCopyRawGenovec(uint32_t subsetting_required, uint32_t vidx, Pgen
       vecset(raw_genovec, vrtype_low2 * kMask5555, DivUp(genovec_byte_ct, kBytesPerVec));
       reterr = ParseAndApplyDifflist(fread_end, &fread_ptr, pgrp, raw_genovec);
     }
+    if (!reterr) {
+      LdbaseCachePut(ldbase_vidx, raw_genovec, pgrp);
+    }
     memcpy(dest, raw_genovec, genovec_byte_ct);
     return reterr;
   }
@@ -2702,7 +4657,7 @@ PglErr LdLoadMinimalSubsetIfNecessary(const uintptr_t* __restrict sample_include
     return kPglRetSuccess;
   }
   const uint32_t ldbase_vidx = pgrp->ldbase_vidx;
-  const uint64_t cur_vidx_fpos = pgrp->fi.var_fpos[ldbase_vidx];
+  const uint64_t cur_vidx_fpos = GetPgrFpos(ldbase_vidx, pgrp);
   const uint32_t ldbase_vrtype = pgrp->fi.vrtypes[ldbase_vidx];
   const uint32_t raw_sample_ct = pgrp->fi.raw_sample_ct;
   const uint32_t subsetting_required = (sample_ct != raw_sample_ct);
@@ -2715,7 +4670,7 @@ PglErr LdLoadMinimalSubsetIfNecessary(const uintptr_t* __restrict sample_include
     {
       const uint64_t block_offset = pgrp->fi.block_offset;
       fread_ptr = &(block_base[cur_vidx_fpos - block_offset]);
-      fread_end = &(block_base[pgrp->fi.var_fpos[ldbase_vidx + 1] - block_offset]);
+      fread_end = &(fread_ptr[GetPgfiVrecWidth(&(pgrp->fi), ldbase_vidx)]);
     }
     if (!(ldbase_vrtype & 4)) {
       reterr = Parse1or2bitGenoarrUnsafe(fread_end, ldbase_vrtype, &fread_ptr, pgrp, raw_genovec);
@@ -2728,11 +4683,45 @@ PglErr LdLoadMinimalSubsetIfNecessary(const uintptr_t* __restrict sample_include
       return kPglRetSuccess;
     }
     pgrp->fp_vidx = ldbase_vidx + 1;
+  } else if (pgrp->readahead) {
+    if (unlikely(ReadaheadFetch(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
+      return kPglRetReadFail;
+    }
+    if (!(ldbase_vrtype & 4)) {
+      reterr = Parse1or2bitGenoarrUnsafe(fread_end, ldbase_vrtype, &fread_ptr, pgrp, raw_genovec);
+      goto LdLoadMinimalSubsetIfNecessary_genovec_finish;
+    }
+  } else if (pgrp->fi.vrec_cache) {
+    if (!(ldbase_vrtype & 4)) {
+      if (LdbaseCacheGet(ldbase_vidx, pgrp, raw_genovec)) {
+        goto LdLoadMinimalSubsetIfNecessary_genovec_finish;
+      }
+      if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
+        return kPglRetReadFail;
+      }
+      reterr = Parse1or2bitGenoarrUnsafe(fread_end, ldbase_vrtype, &fread_ptr, pgrp, raw_genovec);
+      if (!reterr) {
+        LdbaseCachePut(ldbase_vidx, raw_genovec, pgrp);
+      }
+      goto LdLoadMinimalSubsetIfNecessary_genovec_finish;
+    }
+    if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
+      return kPglRetReadFail;
+    }
+  } else if (pgrp->fi.zframe_fpos) {
+    // zstd-compressed records; InitReadPtrs() handles decompression.
+    if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
+      return kPglRetReadFail;
+    }
+    if (!(ldbase_vrtype & 4)) {
+      reterr = Parse1or2bitGenoarrUnsafe(fread_end, ldbase_vrtype, &fread_ptr, pgrp, raw_genovec);
+      goto LdLoadMinimalSubsetIfNecessary_genovec_finish;
+    }
   } else {
-    if (unlikely(fseeko(pgrp->ff, pgrp->fi.var_fpos[ldbase_vidx], SEEK_SET))) {
+    if (unlikely(fseeko(pgrp->ff, cur_vidx_fpos, SEEK_SET))) {
       return kPglRetReadFail;
     }
-    const uintptr_t cur_vrec_width = pgrp->fi.var_fpos[ldbase_vidx + 1] - cur_vidx_fpos;
+    const uintptr_t cur_vrec_width = GetPgfiVrecWidth(&(pgrp->fi), ldbase_vidx);
     pgrp->fp_vidx = ldbase_vidx + 1;
     if (!(ldbase_vrtype & 7)) {
       // don't actually need to fread the whole record in this case
@@ -3219,17 +5208,7 @@ PglErr CountparseOnebitSubset(const unsigned char* fread_end, const uintptr_t* _
 // only called by GetBasicGenotypeCounts(), usually LdLoadAndCopy... is better
 PglErr LdLoadGenovecSubsetIfNecessary(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, uint32_t vidx, PgenReaderMain* pgrp) {
   if (LdLoadNecessary(vidx, pgrp)) {
-    const uint32_t ldbase_vidx = pgrp->ldbase_vidx;
-    const unsigned char* fread_ptr;
-    const unsigned char* fread_end;
-    if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
-      return kPglRetReadFail;
-    }
-    const uint32_t vrtype = pgrp->fi.vrtypes[ldbase_vidx];
-    // bugfix (6 Mar 2019): ldbase_raw_genovec is only filled in (!difflist) &&
-    //   subsetting_required case; (!difflist) isn't enough
-    pgrp->ldbase_stypes = ((vrtype & 4) || (sample_ct == pgrp->fi.raw_sample_ct))? kfPgrLdcacheNyp : (kfPgrLdcacheNyp | kfPgrLdcacheRawNyp);
-    return ParseNonLdGenovecSubsetUnsafe(fread_end, sample_include, sample_include_cumulative_popcounts, sample_ct, vrtype, &fread_ptr, pgrp, pgrp->ldbase_genovec);
+    return LdLoadGenovecSubsetMain(sample_include, sample_include_cumulative_popcounts, sample_ct, pgrp, pgrp->ldbase_genovec);
   }
   if (!(pgrp->ldbase_stypes & kfPgrLdcacheNyp)) {
     if (pgrp->ldbase_stypes & kfPgrLdcacheDifflist) {
@@ -3370,6 +5349,28 @@ PglErr PgrGetCounts(const uintptr_t* __restrict sample_include, const uintptr_t*
 }
 
 // Ok for nyp_vvec to be unaligned.
+#ifdef USE_AVX512
+uint32_t CountNypVec6(const VecW* nyp_vvec, uintptr_t nyp_word, uint32_t vec_ct) {
+  assert(!(vec_ct % 6));
+  const VecZ m1 = VCONST_Z(kMask5555);
+  const VecZ xor_zvec = {nyp_word, nyp_word, nyp_word, nyp_word, nyp_word, nyp_word, nyp_word, nyp_word};
+  const VecZ* nyp_zvec_iter = R_CAST(const VecZ*, nyp_vvec);
+  const VecZ* nyp_zvec_stop = &(nyp_zvec_iter[vec_ct / 2]);
+  VecZ acc0 = vecz_setzero();
+  VecZ acc1 = vecz_setzero();
+  // vec_ct / 2 is a multiple of 3.
+  for (; nyp_zvec_iter != nyp_zvec_stop; nyp_zvec_iter = &(nyp_zvec_iter[3])) {
+    const VecZ loader0 = vecz_loadu(&(nyp_zvec_iter[0])) ^ xor_zvec;
+    const VecZ loader1 = vecz_loadu(&(nyp_zvec_iter[1])) ^ xor_zvec;
+    const VecZ loader2 = vecz_loadu(&(nyp_zvec_iter[2])) ^ xor_zvec;
+    // 0x02: ~(a | b) & c
+    acc0 = acc0 + vecz_popcnt64(vecz_ternlog(loader0, loader0 >> 1, m1, 0x02));
+    acc1 = acc1 + vecz_popcnt64(vecz_ternlog(loader1, loader1 >> 1, m1, 0x02));
+    acc0 = acc0 + vecz_popcnt64(vecz_ternlog(loader2, loader2 >> 1, m1, 0x02));
+  }
+  return HsumZ(acc0 + acc1);
+}
+#else
 uint32_t CountNypVec6(const VecW* nyp_vvec, uintptr_t nyp_word, uint32_t vec_ct) {
   assert(!(vec_ct % 6));
   const VecW m0 = vecw_setzero();
@@ -3415,6 +5416,7 @@ uint32_t CountNypVec6(const VecW* nyp_vvec, uintptr_t nyp_word, uint32_t vec_ct)
     prev_sad_result = vecw_bytesum(inner_acc, m0);
   }
 }
+#endif
 
 // Ok for nyparr to be unaligned.  Ok if unsafe to read trailing bytes of
 // nyparr.
@@ -5241,6 +7243,196 @@ PglErr IMPLPgrGetInv1(const uintptr_t* __restrict sample_include, const uint32_t
   return reterr;
 }
 
+// variant_uidx_basep/cur_bitsp hold the BitIter1() state when variant
+// selection is via variant_include, so a run can be split into several calls.
+//
+// Hardcall-only reads keep the most recent LD base in its own dest row and
+// apply each following LD-compressed variant's difflist to a copy of that row,
+// so the base is decoded once per run and never round-trips through
+// pgrp->ldbase_genovec.  pgrp's LD cache is only brought up to date when a
+// variant has to take the general path, and at the end of the call.
+static PglErr Get1BatchMain(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, const uintptr_t* __restrict variant_include, const uint32_t* __restrict variant_uidxs, uint32_t variant_uidx_start, uint32_t variant_ct, uint32_t allele_idx, PgenReaderMain* pgrp, uintptr_t dest_word_stride, uintptr_t* __restrict variant_uidx_basep, uintptr_t* __restrict cur_bitsp, uintptr_t* __restrict dest) {
+  // Resolve the allele dispatch once.  When the file has no multiallelic
+  // variants, every variant goes through the hardcall path.
+  const uint32_t invert = (allele_idx == 0);
+  const uint32_t simple_only = invert || (allele_idx == UINT32_MAX) || ((allele_idx == 1) && (!pgrp->fi.allele_idx_offsets));
+  const unsigned char* vrtypes = pgrp->fi.vrtypes;
+  const uint32_t subsetting_required = (sample_ct != pgrp->fi.raw_sample_ct);
+  // Inversion of the base row is deferred until it's no longer needed as a
+  // base.
+  uintptr_t* batch_ldbase_row = nullptr;
+  uint32_t batch_ldbase_vidx = UINT32_MAX;
+  uint32_t batch_ldbase_raw_saved = 0;
+  uint32_t batch_ldbase_synced = 1;
+  uintptr_t* dest_iter = dest;
+  PglErr reterr = kPglRetSuccess;
+  for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+    uint32_t vidx;
+    if (variant_uidxs) {
+      vidx = variant_uidxs[variant_idx];
+    } else if (variant_include) {
+      vidx = BitIter1(variant_include, variant_uidx_basep, cur_bitsp);
+    } else {
+      vidx = variant_uidx_start + variant_idx;
+    }
+    assert(vidx < pgrp->fi.raw_variant_ct);
+    const uint32_t vrtype = GetPgfiVrtype(&(pgrp->fi), vidx);
+    const uint32_t maintrack_vrtype = vrtype & 7;
+    if (simple_only || ((allele_idx == 1) && (!VrtypeMultiallelicHc(vrtype)))) {
+      if (!VrtypeLdCompressed(maintrack_vrtype)) {
+        const unsigned char* fread_ptr;
+        const unsigned char* fread_end;
+        if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
+          reterr = kPglRetReadFail;
+          goto Get1BatchMain_ret_1;
+        }
+        reterr = ParseNonLdGenovecSubsetUnsafe(fread_end, sample_include, sample_include_cumulative_popcounts, sample_ct, maintrack_vrtype, &fread_ptr, pgrp, dest_iter);
+        if (unlikely(reterr)) {
+          goto Get1BatchMain_ret_1;
+        }
+        if (vrtype == kPglVrtypePlink1) {
+          PgrPlink1ToPlink2InplaceUnsafe(sample_ct, dest_iter);
+        } else {
+          const uint32_t raw_genovec_overwritten = subsetting_required && (!(maintrack_vrtype & 4));
+          if (raw_genovec_overwritten) {
+            // same bookkeeping as ReadGenovecSubsetUnsafe()
+            pgrp->ldbase_stypes &= ~kfPgrLdcacheRawNyp;
+            batch_ldbase_raw_saved = 0;
+          }
+          if (vrtypes && VrtypeLdCompressed(vrtypes[vidx + 1])) {
+            if (batch_ldbase_row && invert) {
+              GenovecInvertUnsafe(sample_ct, batch_ldbase_row);
+            }
+            batch_ldbase_row = dest_iter;
+            batch_ldbase_vidx = vidx;
+            batch_ldbase_raw_saved = raw_genovec_overwritten;
+            batch_ldbase_synced = 0;
+            dest_iter = &(dest_iter[dest_word_stride]);
+            continue;
+          }
+        }
+      } else if (batch_ldbase_row && (GetLdbaseVidx(vrtypes, vidx) == batch_ldbase_vidx)) {
+        CopyNyparr(batch_ldbase_row, sample_ct, dest_iter);
+        const unsigned char* fread_ptr;
+        const unsigned char* fread_end;
+        if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
+          reterr = kPglRetReadFail;
+          goto Get1BatchMain_ret_1;
+        }
+        reterr = ParseAndApplyDifflistSubset(fread_end, sample_include, sample_include_cumulative_popcounts, sample_ct, &fread_ptr, pgrp, dest_iter);
+        if (unlikely(reterr)) {
+          goto Get1BatchMain_ret_1;
+        }
+        if (maintrack_vrtype == 3) {
+          GenovecInvertUnsafe(sample_ct, dest_iter);
+        }
+      } else {
+        // LD base wasn't part of this run (or was superseded); let
+        // ReadGenovecSubsetUnsafe() consult/refill pgrp's LD cache.
+        if (batch_ldbase_row) {
+          if (!batch_ldbase_synced) {
+            CopyNyparr(batch_ldbase_row, sample_ct, pgrp->ldbase_genovec);
+            pgrp->ldbase_vidx = batch_ldbase_vidx;
+            pgrp->ldbase_stypes = batch_ldbase_raw_saved? (kfPgrLdcacheNyp | kfPgrLdcacheRawNyp) : kfPgrLdcacheNyp;
+          }
+          if (invert) {
+            GenovecInvertUnsafe(sample_ct, batch_ldbase_row);
+          }
+          batch_ldbase_row = nullptr;
+          batch_ldbase_synced = 1;
+        }
+        reterr = ReadGenovecSubsetUnsafe(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, pgrp, nullptr, nullptr, dest_iter);
+        if (unlikely(reterr)) {
+          goto Get1BatchMain_ret_1;
+        }
+      }
+      if (invert) {
+        GenovecInvertUnsafe(sample_ct, dest_iter);
+      }
+    } else {
+      // Get1Multiallelic() may need the LD base via pgrp's cache.
+      if (batch_ldbase_row) {
+        if (!batch_ldbase_synced) {
+          CopyNyparr(batch_ldbase_row, sample_ct, pgrp->ldbase_genovec);
+          pgrp->ldbase_vidx = batch_ldbase_vidx;
+          pgrp->ldbase_stypes = batch_ldbase_raw_saved? (kfPgrLdcacheNyp | kfPgrLdcacheRawNyp) : kfPgrLdcacheNyp;
+        }
+        batch_ldbase_row = nullptr;
+        batch_ldbase_synced = 1;
+      }
+      reterr = Get1Multiallelic(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, allele_idx, pgrp, nullptr, nullptr, nullptr, dest_iter, nullptr);
+      if (unlikely(reterr)) {
+        goto Get1BatchMain_ret_1;
+      }
+    }
+    dest_iter = &(dest_iter[dest_word_stride]);
+  }
+ Get1BatchMain_ret_1:
+  if (batch_ldbase_row) {
+    if (!batch_ldbase_synced) {
+      CopyNyparr(batch_ldbase_row, sample_ct, pgrp->ldbase_genovec);
+      pgrp->ldbase_vidx = batch_ldbase_vidx;
+      pgrp->ldbase_stypes = batch_ldbase_raw_saved? (kfPgrLdcacheNyp | kfPgrLdcacheRawNyp) : kfPgrLdcacheNyp;
+    }
+    if (invert) {
+      GenovecInvertUnsafe(sample_ct, batch_ldbase_row);
+    }
+  }
+  return reterr;
+}
+
+PglErr IMPLPgrGet1Batch(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, const uintptr_t* __restrict variant_include, const uint32_t* __restrict variant_uidxs, uint32_t variant_uidx_start, uint32_t variant_ct, uint32_t allele_idx, PgenReaderMain* pgrp, uintptr_t dest_word_stride, uintptr_t* __restrict dest) {
+  if ((!sample_ct) || (!variant_ct)) {
+    return kPglRetSuccess;
+  }
+  uintptr_t variant_uidx_base = 0;
+  uintptr_t cur_bits = 0;
+  if ((!variant_uidxs) && variant_include) {
+    BitIter1Start(variant_include, variant_uidx_start, &variant_uidx_base, &cur_bits);
+  }
+  return Get1BatchMain(sample_include, sample_include_cumulative_popcounts, sample_ct, variant_include, variant_uidxs, variant_uidx_start, variant_ct, allele_idx, pgrp, dest_word_stride, &variant_uidx_base, &cur_bits, dest);
+}
+
+PglErr PgrGet1BatchTransposed(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, const uintptr_t* __restrict variant_include, const uint32_t* __restrict variant_uidxs, uint32_t variant_uidx_start, uint32_t variant_ct, uint32_t allele_idx, PgenReader* pgr_ptr, uintptr_t* __restrict vmaj_buf, VecW* transpose_buf, uintptr_t dest_word_stride, uintptr_t* __restrict dest) {
+  if ((!sample_ct) || (!variant_ct)) {
+    return kPglRetSuccess;
+  }
+  PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
+  const uint32_t* sample_include_cumulative_popcounts = GetSicp(pssi);
+  const uint32_t sample_ctaw2 = NypCtToAlignedWordCt(sample_ct);
+  const uint32_t variant_batch_ct = DivUp(variant_ct, kPglNypTransposeBatch);
+  const uint32_t sample_batch_ct = DivUp(sample_ct, kPglNypTransposeBatch);
+  uintptr_t variant_uidx_base = 0;
+  uintptr_t cur_bits = 0;
+  if ((!variant_uidxs) && variant_include) {
+    BitIter1Start(variant_include, variant_uidx_start, &variant_uidx_base, &cur_bits);
+  }
+  uint32_t variant_batch_size = kPglNypTransposeBatch;
+  for (uint32_t variant_batch_idx = 0; variant_batch_idx != variant_batch_ct; ++variant_batch_idx) {
+    if (variant_batch_idx == variant_batch_ct - 1) {
+      variant_batch_size = ModNz(variant_ct, kPglNypTransposeBatch);
+    }
+    const uint32_t variant_idx_offset = variant_batch_idx * kPglNypTransposeBatch;
+    const uint32_t* batch_variant_uidxs = variant_uidxs? (&(variant_uidxs[variant_idx_offset])) : nullptr;
+    PglErr reterr = Get1BatchMain(sample_include, sample_include_cumulative_popcounts, sample_ct, variant_include, batch_variant_uidxs, variant_uidx_start + variant_idx_offset, variant_batch_size, allele_idx, pgrp, sample_ctaw2, &variant_uidx_base, &cur_bits, vmaj_buf);
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+    const uintptr_t* vmaj_iter = vmaj_buf;
+    uintptr_t* smaj_iter = &(dest[variant_batch_idx * kPglNypTransposeWords]);
+    uint32_t sample_batch_size = kPglNypTransposeBatch;
+    for (uint32_t sample_batch_idx = 0; sample_batch_idx != sample_batch_ct; ++sample_batch_idx) {
+      if (sample_batch_idx == sample_batch_ct - 1) {
+        sample_batch_size = ModNz(sample_ct, kPglNypTransposeBatch);
+      }
+      TransposeNypblock(vmaj_iter, sample_ctaw2, dest_word_stride, variant_batch_size, sample_batch_size, smaj_iter, transpose_buf);
+      vmaj_iter = &(vmaj_iter[kPglNypTransposeWords]);
+      smaj_iter = &(smaj_iter[kPglNypTransposeBatch * dest_word_stride]);
+    }
+  }
+  return kPglRetSuccess;
+}
+
 // Assumes allele_idx0 < allele_idx1, and allele_idx0 < 2.  Rotates hardcalls
 // such that, if no multiallelic hardcalls are present, 0 = 0/0, 1 = 0/1,
 // 2 = 1/1, and 3 = anything else.
@@ -10153,10 +12345,48 @@ PglErr ValidateDosage16(const unsigned char* fread_end, uint32_t vidx, PgenReade
 }
 
 static_assert(kPglVblockSize == 65536, "PgrValidate() needs to have an error message updated.");
+#ifndef NO_PGEN_ZSTD
+// Checks that each storage-mode-0x12 frame decompresses to exactly the
+// records the header says it contains.
+static PglErr PgrZstdValidateFrames(PgenReaderMain* pgrp, char* errstr_buf) {
+  const PgenFileInfo* fip = &(pgrp->fi);
+  const uint32_t variant_ct = fip->raw_variant_ct;
+  const uint32_t zframe_ct = fip->zframe_ct;
+  PgenZstdStream* zsp = pgrp->zstream;
+  if (!zsp) {
+    zsp = CreatePgenZstdStream();
+    if (unlikely(!zsp)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Out of memory.\n");
+      return kPglRetNomem;
+    }
+    pgrp->zstream = zsp;
+  }
+  for (uint32_t frame_idx = 0; frame_idx != zframe_ct; ++frame_idx) {
+    const uint32_t vidx_end = MINV(variant_ct, (frame_idx + 1) * kPglZframeSize);
+    PgenZstdStreamOpenFrame(fip, frame_idx, zsp);
+    if (unlikely(PgenZstdStreamRead(pgrp->ff, -1, GetPgfiFpos(fip, vidx_end) - zsp->lfpos, nullptr, zsp) ||
+                 PgenZstdStreamFinish(pgrp->ff, -1, zsp))) {
+      zsp->frame_idx = UINT32_MAX;
+      if (errno) {
+        FillPgenReadErrstrFromErrno(errstr_buf);
+        return kPglRetReadFail;
+      }
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen zstd frame %u is inconsistent with variant record length index.\n", frame_idx);
+      return kPglRetMalformedInput;
+    }
+  }
+  return kPglRetSuccess;
+}
+#endif
+
 PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf) {
   PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
   // Performs all validation which isn't done by pgfi_init_phase{1,2}() and
   // PgrInit().
+#ifndef NO_PGEN_IO_POOL
+  // This walks the file with fread(), so read-ahead would just get in the way.
+  PgrReadaheadStop(pgr_ptr);
+#endif
   const uintptr_t* allele_idx_offsets = pgrp->fi.allele_idx_offsets;
   const uint32_t variant_ct = pgrp->fi.raw_variant_ct;
   const uint32_t sample_ct = pgrp->fi.raw_sample_ct;
@@ -10218,7 +12448,18 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
   }
 #endif
   // todo: modify this check when phase sets are implemented
-  const uint64_t expected_fsize = pgrp->fi.var_fpos[variant_ct];
+  uint64_t expected_fsize = GetPgfiFpos(&(pgrp->fi), variant_ct);
+#ifndef NO_PGEN_ZSTD
+  if (pgrp->fi.zframe_fpos) {
+    // The physical size was checked against the frame index during
+    // PgfiInitPhase2().
+    const PglErr reterr = PgrZstdValidateFrames(pgrp, errstr_buf);
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+    expected_fsize = fsize;
+  }
+#endif
   if (unlikely(expected_fsize != fsize)) {
     snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen header indicates that file size should be %" PRIu64 " bytes, but actual file size is %" PRIu64 " bytes.\n", expected_fsize, fsize);
     return kPglRetMalformedInput;
@@ -10234,7 +12475,7 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
     // validate the random-access index.
     const uint64_t* fpos_index = R_CAST(const uint64_t*, &(pgrp->fi.block_base[12]));
     for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
-      if (unlikely(fpos_index[vblock_idx] != pgrp->fi.var_fpos[vblock_idx * kPglVblockSize])) {
+      if (unlikely(fpos_index[vblock_idx] != GetPgfiFpos(&(pgrp->fi), vblock_idx * S_CAST(uintptr_t, kPglVblockSize)))) {
         snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen header vblock-start index is inconsistent with variant record length index.\n");
         return kPglRetMalformedInput;
       }
@@ -10256,7 +12497,7 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
         FillPgenReadErrstr(ff, errstr_buf);
         return kPglRetReadFail;
       }
-      if (unlikely(vblock_start_fpos != pgrp->fi.var_fpos[vblock_idx * kPglVblockSize])) {
+      if (unlikely(vblock_start_fpos != GetPgfiFpos(&(pgrp->fi), vblock_idx * S_CAST(uintptr_t, kPglVblockSize)))) {
         snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen header vblock-start index is inconsistent with variant record length index.\n");
         return kPglRetMalformedInput;
       }
@@ -10388,6 +12629,29 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
 
 BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp) {
   // memory is the responsibility of the caller
+#ifndef NO_PGEN_IO_POOL
+  // must happen before shared_ff is closed
+  CleanupPgenIoPool(pgfip->io_pool);
+  pgfip->io_pool = nullptr;
+#endif
+  PgenVrecCacheRelease(&pgfip->vrec_cache);
+#ifndef NO_PGEN_ZSTD
+  free_cond(pgfip->zframe_fpos);
+  pgfip->zframe_fpos = nullptr;
+  CleanupPgenZstdStream(pgfip->zstream);
+  pgfip->zstream = nullptr;
+#endif
+#ifndef NO_MMAP
+  if (pgfip->pgi_base) {
+    munmap(K_CAST(unsigned char*, pgfip->pgi_base), pgfip->pgi_size);
+    pgfip->pgi_base = nullptr;
+  }
+  if (pgfip->vsum_base) {
+    munmap(K_CAST(unsigned char*, pgfip->vsum_base), pgfip->vsum_size);
+    pgfip->vsum_base = nullptr;
+    pgfip->vsums = nullptr;
+  }
+#endif
   if (pgfip->shared_ff) {
     if (unlikely(fclose_null(&pgfip->shared_ff))) {
       if (*reterrp == kPglRetSuccess) {
@@ -10407,9 +12671,17 @@ BoolErr CleanupPgr(PgenReader* pgr_ptr, PglErr* reterrp) {
   PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
   // assume file is open if pgr.ff is not null
   // memory is the responsibility of the caller for now
+  PgenVrecCacheRelease(&pgrp->fi.vrec_cache);
+#ifndef NO_PGEN_ZSTD
+  CleanupPgenZstdStream(pgrp->zstream);
+  pgrp->zstream = nullptr;
+#endif
   if (!pgrp->ff) {
     return 0;
   }
+#ifndef NO_PGEN_IO_POOL
+  PgrReadaheadStop(pgr_ptr);
+#endif
   if (fclose_null(&(pgrp->ff))) {
     if (*reterrp == kPglRetSuccess) {
       *reterrp = kPglRetReadFail;
@@ -38,6 +38,12 @@ namespace plink2 {
 #  define NO_MMAP
 #endif
 
+// Background pread()-based I/O (PgenIoPool, and the per-variant read-ahead
+// engine built on top of it) is currently POSIX-only.
+#ifdef _WIN32
+#  define NO_PGEN_IO_POOL
+#endif
+
 FLAGSET_DEF_START()
   kfPgrLdcache0,
   kfPgrLdcacheNyp = (1 << 0),
@@ -47,6 +53,24 @@ FLAGSET_DEF_START()
   kfPgrLdcacheBasicGenocounts = (1 << 3)
 FLAGSET_DEF_END(PgrLdcacheFlags);
 
+FLAGSET_DEF_START()
+  kfPgenVrecCache0,
+  // Also cache the fully-expanded genovec of each LD base variant loaded
+  // through the cache, so readers skip re-parsing it.
+  kfPgenVrecCacheLdbaseGenovec = (1 << 0)
+FLAGSET_DEF_END(PgenVrecCacheFlags);
+
+// Opaque types; see PgenIoPoolCreate(), PgenVrecCacheCreate(), and
+// PgrReadaheadStart() below.
+typedef struct PgenIoPoolStruct PgenIoPool;
+typedef struct PgenVrecCacheStruct PgenVrecCache;
+typedef struct PgrReadaheadStruct PgrReadahead;
+typedef struct PgenZstdStreamStruct PgenZstdStream;
+
+// Number of variants per fpos_bases[] entry in compact-fpos mode.  Must be a
+// power of 2.
+CONSTI32(kPglFposBlockSize, 32);
+
 // PgenFileInfo and PgenReader are the main exported "classes".
 // Exported functions involving these data structure should all have
 // "pgfi"/"pgr" in their names.
@@ -71,13 +95,21 @@ typedef struct PgenFileInfoStruct {
 
   // size (raw_variant_ct + 1), so that the number of bytes of (zero-based)
   // variant n is var_fpos[n+1] - var_fpos[n].  nullptr if
-  // const_vrec_width is nonzero.
-  // It's not difficult to save some memory here (e.g. unless we're dealing
-  // with >256 TB files, it's trivial to go from 8 bytes down to 6 bytes per
-  // entry), but I doubt that's worth the trouble; let's worry about
-  // O(mn)-or-worse stuff, and on-disk stuff, first.
+  // const_vrec_width is nonzero, or if the compact representation below is in
+  // use.  Use GetPgfiFpos()/GetPgfiVrecWidth() unless you know which
+  // representation is active.
   uint64_t* var_fpos;
 
+  // Compact alternative to var_fpos[], requested via
+  // PgfiEnableCompactFpos().  fpos_bases[k] is the file offset of variant
+  // (k * kPglFposBlockSize), and vrec_lens[] stores each variant record's
+  // length in vrec_len_byte_ct bytes; so a lookup costs a prefix sum over at
+  // most kPglFposBlockSize - 1 lengths.  With 3-byte lengths, this is ~3.3
+  // bytes/variant instead of 8.  nullptr when var_fpos[] is used instead.
+  uint64_t* fpos_bases;
+  unsigned char* vrec_lens;
+  uint32_t vrec_len_byte_ct;
+
   // Variant record type codes.
   // base pointer is null if mode is 0x01-0x04 (const_vrtype != UINT32_MAX).
   // if not nullptr, required to be length >=
@@ -113,6 +145,41 @@ typedef struct PgenFileInfoStruct {
 #ifndef NO_MMAP
   uint64_t file_size;
 #endif
+
+  // Optional background I/O thread pool.  When non-null, PgfiMultiread()
+  // splits each block-load into chunks which are pread() in parallel; this
+  // mostly matters on high-latency network filesystems.  Owned by the
+  // original PgenFileInfo (copies made by PgrInit() must not free it).
+  PgenIoPool* io_pool;
+
+  // Optional size-bounded cache of variant records shared by all readers of
+  // this file (and possibly other files); see PgenVrecCacheCreate().  Only
+  // consulted in per-variant fread mode.  Reference-counted, so PgrInit()
+  // copies are fine.
+  PgenVrecCache* vrec_cache;
+  uint32_t vrec_cache_file_id;
+
+  // Non-null iff var_fpos/vrtypes point into a memory-mapped .pgi index (see
+  // PgfiInitPhase2Pgi()).  Owned by the original PgenFileInfo, like io_pool.
+  const unsigned char* pgi_base;
+  uint64_t pgi_size;
+
+  // Non-null iff a .vsum sidecar is attached (see PgfiAttachVariantSummary());
+  // vsums then has raw_variant_ct entries.  Owned by the original
+  // PgenFileInfo, like pgi_base.
+  const PgenVariantSummary* vsums;
+  const unsigned char* vsum_base;
+  uint64_t vsum_size;
+
+  // Storage mode 0x12 only (zframe_ct is zero otherwise): physical start of
+  // each zstd frame, followed by the file size.  var_fpos[] etc. are then
+  // offsets into the decompressed record stream.  zframe_fpos is loaded
+  // during phase 2, and is owned by the original PgenFileInfo, like io_pool.
+  // zstream is PgfiMultiread()'s lazily-allocated decompressor for the
+  // no-io_pool case; also owned by the original PgenFileInfo.
+  uint32_t zframe_ct;
+  uint64_t* zframe_fpos;
+  PgenZstdStream* zstream;
 } PgenFileInfo;
 
 typedef struct PgenReaderMainStruct {
@@ -129,8 +196,21 @@ typedef struct PgenReaderMainStruct {
   // ** per-variant fread()-only **
   FILE* ff;
   unsigned char* fread_buf;
+
+  // nullptr unless PgrReadaheadStart() has been called.
+  PgrReadahead* readahead;
+
+  // Storage mode 0x12: lazily-allocated decompressor, positioned somewhere
+  // in the current frame.  Sequential reads within a frame are then O(1).
+  PgenZstdStream* zstream;
   // ** end per-variant fread()-only **
 
+  // Compact-fpos mode only: file offset of variant fpos_cache_vidx, usually
+  // the successor of the last variant looked up.  Makes sequential access
+  // O(1) instead of a fpos_bases[] prefix sum.
+  uint32_t fpos_cache_vidx;
+  uint64_t fpos_cache;
+
   // if LD compression is present, cache the last non-LD-compressed variant
   uint32_t ldbase_vidx;
 
@@ -201,10 +281,24 @@ HEADER_INLINE uint32_t GetPgfiVrtype(const PgenFileInfo* pgfip, uint32_t vidx) {
   return pgfip->const_vrtype;
 }
 
+// vrec_lens[] is followed by at least 3 bytes of zero padding, so 4-byte
+// loads are safe.
+HEADER_INLINE uint32_t GetCompactVrecLen(const PgenFileInfo* pgfip, uintptr_t vidx) {
+  const uint32_t byte_ct = pgfip->vrec_len_byte_ct;
+  uint32_t vrec_len;
+  memcpy(&vrec_len, &(pgfip->vrec_lens[vidx * byte_ct]), sizeof(int32_t));
+  return vrec_len & (UINT32_MAX >> (32 - byte_ct * CHAR_BIT));
+}
+
+uint64_t GetCompactFpos(const PgenFileInfo* pgfip, uintptr_t vidx);
+
 HEADER_INLINE uint64_t GetPgfiFpos(const PgenFileInfo* pgfip, uintptr_t vidx) {
   if (pgfip->var_fpos) {
     return pgfip->var_fpos[vidx];
   }
+  if (pgfip->fpos_bases) {
+    return GetCompactFpos(pgfip, vidx);
+  }
   return pgfip->const_fpos_offset + pgfip->const_vrec_width * S_CAST(uint64_t, vidx);
 }
 
@@ -212,6 +306,9 @@ HEADER_INLINE uint32_t GetPgfiVrecWidth(const PgenFileInfo* pgfip, uint32_t vidx
   if (pgfip->var_fpos) {
     return pgfip->var_fpos[vidx + 1] - pgfip->var_fpos[vidx];
   }
+  if (pgfip->fpos_bases) {
+    return GetCompactVrecLen(pgfip, vidx);
+  }
   return pgfip->const_vrec_width;
 }
 
@@ -393,6 +490,8 @@ HEADER_INLINE void PgrSetBaseAndOffset0(unsigned char* block_base, uint32_t thre
 //   raw_sample_ct and raw_variant_ct should be UINT32_MAX if not previously
 //   known.
 //
+// Optional: PgfiEnableCompactFpos() (see below).
+//
 // Intermission: Caller obtains a block of pgfi_alloc_cacheline_ct * 64 bytes,
 //   64-byte aligned.  The cachealigned_malloc() function can be used for this
 //   purpose.  If necessary, pgfi.allele_idx_offsets and pgfi.nonref_flags
@@ -400,10 +499,10 @@ HEADER_INLINE void PgrSetBaseAndOffset0(unsigned char* block_base, uint32_t thre
 //   loaded during phase 2.
 //
 // Phase 2: Initialize most pointers in the PgenReader struct to appropriate
-//   positions in first_alloc.  For modes 0x10-0x11, load pgfi.var_fpos and
+//   positions in first_alloc.  For modes 0x10-0x12, load pgfi.var_fpos and
 //   pgfi.vrtypes, load/validate pgfi.allele_idx_offsets and pgfi.nonref_flags
 //   if appropriate, and initialize pgfi.gflags, pgfi.max_allele_ct, and
-//   pgfi.max_dosage_allele_ct.
+//   pgfi.max_dosage_allele_ct.  For mode 0x12, also load pgfi.zframe_fpos.
 //
 // Finally, if block-fread mode is being used, pgfi.block_base must be
 //   initialized to point to a memory large enough to handle the largest
@@ -430,6 +529,11 @@ void PreinitPgfi(PgenFileInfo* pgfip);
 //    doesn't share its inability to handle multiple queries at a time, but
 //    less performant for CPU-heavy operations on the whole genome.
 //
+// Mode 1 is not available for storage mode 0x12 (zstd-compressed variant
+// records).  Modes 2 and 3 decompress on the fly; in mode 2, each
+// PgfiMultiread() frame is decompressed on an io_pool thread when one is
+// attached.
+//
 // To specify mode 1, pass in use_mmap == 1 here.
 // To specify mode 2, pass in use_mmap == 0 here, and use_blockload == 1 during
 //   phase2.
@@ -440,10 +544,57 @@ void PreinitPgfi(PgenFileInfo* pgfip);
 //   raw_sample_ct must be in [1, 2^31 - 2].
 PglErr PgfiInitPhase1(const char* fname, uint32_t raw_variant_ct, uint32_t raw_sample_ct, uint32_t use_mmap, PgenHeaderCtrl* header_ctrl_ptr, PgenFileInfo* pgfip, uintptr_t* pgfi_alloc_cacheline_ct_ptr, char* errstr_buf);
 
+// May be called between phase 1 and phase 2.  If the file has variable-width
+// records, phase 2 then fills the compact fpos_bases[]/vrec_lens[]
+// representation instead of var_fpos[]; this cuts the offset table's memory
+// footprint by more than half, at the cost of slower random access
+// (sequential access through a PgenReader is unaffected).
+// *pgfi_alloc_cacheline_ct_ptr is updated to include a decode buffer of up to
+// 512 KiB that's only used during phase 2, and phase 2's vblock_idx_start must
+// be zero.  No-op for fixed-width files; PgfiInitPhase2Pgi() ignores it,
+// since the mapped index supplies a flat var_fpos[].
+void PgfiEnableCompactFpos(PgenHeaderCtrl header_ctrl, PgenFileInfo* pgfip, uintptr_t* pgfi_alloc_cacheline_ct_ptr);
+
 // If allele_cts_already_loaded is set, but they're present in the file,
 // they'll be validated; similarly for nonref_flags_already_loaded.
 PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_loaded, uint32_t nonref_flags_already_loaded, uint32_t use_blockload, uint32_t vblock_idx_start, uint32_t vidx_end, uint32_t* max_vrec_width_ptr, PgenFileInfo* pgfip, unsigned char* pgfi_alloc, uintptr_t* pgr_alloc_cacheline_ct_ptr, char* errstr_buf);
 
+// .pgi sidecar index: precomputed var_fpos[], vrtypes[], allele counts, and
+// nonref flags for a variable-width .pgen, laid out so they can be used
+// directly from a read-only mapping.  Opening a .pgen with a valid index is
+// O(1) (apart from allele-count/nonref-flag copying/validation), and only the
+// index pages covering variants actually accessed are ever read from disk.
+// The index records the .pgen's size and mtime, and its var_fpos[] entries
+// must agree with the .pgen's vblock offset table; otherwise it's considered
+// stale.
+//
+// PgfiInitPhase2Pgi() is an alternative to PgfiInitPhase2() for variable-width
+// .pgen files, and must be called at the same point (immediately after
+// PgfiInitPhase1()).  Since var_fpos[] and vrtypes[] aren't copied, no
+// pgfi_alloc is needed, and it's always equivalent to vblock_idx_start == 0,
+// vidx_end == raw_variant_ct.
+// Returns kPglRetSkipped, leaving pgfip unchanged, if the .pgen is
+// fixed-width, pgenlib was compiled without mmap support, or the index is
+// missing (errstr_buf set to the empty string), or if the index is invalid or
+// stale (errstr_buf contains a warning).  The caller should fall back on
+// PgfiInitPhase2() in that case.
+PglErr PgfiInitPhase2Pgi(const char* pgen_fname, const char* pgi_fname, PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_loaded, uint32_t nonref_flags_already_loaded, uint32_t use_blockload, uint32_t* max_vrec_width_ptr, PgenFileInfo* pgfip, uintptr_t* pgr_alloc_cacheline_ct_ptr, char* errstr_buf);
+
+// Writes a .pgi index for a variable-width .pgen.  pgfip must have been fully
+// initialized by PgfiInitPhase2() (with vblock_idx_start == 0 and vidx_end ==
+// raw_variant_ct) or PgfiInitPhase2Pgi(); if the .pgen stores allele counts,
+// pgfip->allele_idx_offsets must be valid, and similarly for nonref_flags.
+PglErr PgfiWritePgi(const char* pgen_fname, const char* pgi_fname, PgenHeaderCtrl header_ctrl, uint32_t max_vrec_width, const PgenFileInfo* pgfip, char* errstr_buf);
+
+// Maps a .vsum sidecar (see PgenVsumHeader) written alongside the .pgen, and
+// points pgfip->vsums at its records.  Can be called any time after
+// PgfiInitPhase2() or PgfiInitPhase2Pgi(); the mapping is released by
+// CleanupPgfi().
+// Returns kPglRetSkipped, leaving pgfip unchanged, if pgenlib was compiled
+// without mmap support or the sidecar is missing (errstr_buf set to the empty
+// string), or if it's invalid or stale (errstr_buf contains a warning).
+PglErr PgfiAttachVariantSummary(const char* pgen_fname, const char* vsum_fname, PgenFileInfo* pgfip, char* errstr_buf);
+
 
 uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const PgenFileInfo* pgfip, uint32_t variant_ct, uint32_t block_size);
 
@@ -454,6 +605,102 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
 //   ensure multiple per-variant readers still works.)
 PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip);
 
+// PgenIoPool: a small set of background threads which service pread()
+// requests.  Each request is associated with a PgenIoTicket; the submitter
+// waits on the ticket, and the time spent waiting is recorded as stall time.
+//
+// These use malloc() instead of caller-provided memory, since the
+// allocations are small and thread creation has to happen anyway.
+typedef struct PgenIoTicketStruct {
+  // These should not be touched directly while requests are in flight.
+  uint32_t pending_ct;
+  uint32_t failed;
+  int32_t errno_val;
+} PgenIoTicket;
+
+typedef struct PgenIoPoolStatsStruct {
+  uint64_t request_ct;
+  uint64_t byte_ct;
+  // number of PgenIoPoolWait() calls which actually had to block, and the
+  // total time spent blocked
+  uint64_t stall_ct;
+  uint64_t stall_ns;
+} PgenIoPoolStats;
+
+HEADER_INLINE void PgenIoTicketInit(PgenIoTicket* ticketp) {
+  ticketp->pending_ct = 0;
+  ticketp->failed = 0;
+  ticketp->errno_val = 0;
+}
+
+// Default chunk size used when PgfiMultiread() fans out a single contiguous
+// read.
+CONSTI32(kPgenIoChunkSize, 1 << 20);
+
+#ifndef NO_PGEN_IO_POOL
+// thread_ct must be positive.  queue_capacity bounds the number of queued
+// (not yet started) requests; PgenIoPoolSubmit() blocks when it's exceeded.
+PglErr PgenIoPoolCreate(uint32_t thread_ct, uint32_t queue_capacity, PgenIoPool** io_poolpp);
+
+// fd must remain open until the ticket has been waited on.
+void PgenIoPoolSubmit(int32_t fd, uint64_t fpos, uintptr_t byte_ct, unsigned char* dst, PgenIoTicket* ticketp, PgenIoPool* io_poolp);
+
+// Blocks until all requests associated with the ticket are complete.  On
+// failure, errno is set to the failing pread()'s errno (0 on premature EOF).
+BoolErr PgenIoPoolWait(PgenIoTicket* ticketp, PgenIoPool* io_poolp);
+
+// Nonblocking check.
+uint32_t PgenIoTicketIsDone(PgenIoTicket* ticketp, PgenIoPool* io_poolp);
+
+void PgenIoPoolGetStats(PgenIoPool* io_poolp, PgenIoPoolStats* statsp);
+
+// Joins all threads and frees the pool; all tickets must have been waited on
+// first.  Safe to call on nullptr.
+void CleanupPgenIoPool(PgenIoPool* io_poolp);
+
+// Convenience wrapper: creates a pool and attaches it to pgfip, so that
+// subsequent PgfiMultiread() calls use it.  Freed by CleanupPgfi().  Only
+// valid in block-fread mode.
+PglErr PgfiAttachIoPool(uint32_t thread_ct, PgenFileInfo* pgfip);
+#endif
+
+// PgenVrecCache: thread-safe LRU cache of raw variant records, keyed on
+// (file, variant index), with an overall byte budget.  This is aimed at
+// services which make many small random-access queries against the same
+// files through short-lived per-variant-fread readers; the LD base variant
+// and its difflist would otherwise be reloaded and reparsed by every reader.
+// Lookups copy the record into the reader's own buffer, so entries can be
+// evicted at any time.
+typedef struct PgenVrecCacheStatsStruct {
+  uint64_t record_hit_ct;
+  uint64_t record_miss_ct;
+  // only updated when kfPgenVrecCacheLdbaseGenovec is set
+  uint64_t ldbase_hit_ct;
+  uint64_t ldbase_miss_ct;
+  uint64_t evict_ct;
+  uintptr_t entry_ct;
+  uintptr_t byte_ct;
+  uintptr_t byte_budget;
+} PgenVrecCacheStats;
+
+// The new cache has a reference count of 1.
+PglErr PgenVrecCacheCreate(uintptr_t byte_budget, PgenVrecCacheFlags flags, PgenVrecCache** vrec_cachepp);
+
+// Decrements the reference count, freeing the cache when it hits zero, and
+// sets *vrec_cachepp to nullptr.  Safe to call on nullptr.
+void PgenVrecCacheRelease(PgenVrecCache** vrec_cachepp);
+
+void PgenVrecCacheGetStats(PgenVrecCache* vrec_cachep, PgenVrecCacheStats* statsp);
+
+// Attaches vrec_cachep (acquiring a reference) to pgfip.  Must be called
+// after PgfiInitPhase2() and before PgrInit().  Files are identified by
+// device/inode/size/mtime, so independently opened PgenFileInfos for the same
+// file share entries; on filesystems without inode numbers, each attachment
+// gets its own namespace.
+// The reference is released by CleanupPgfi(), and by CleanupPgr() for each
+// reader initialized from pgfip.
+PglErr PgfiAttachVrecCache(const char* fname, PgenVrecCache* vrec_cachep, PgenFileInfo* pgfip);
+
 
 void PreinitPgr(PgenReader* pgr_ptr);
 
@@ -486,6 +733,45 @@ void PreinitPgr(PgenReader* pgr_ptr);
 // max_vrec_width ignored when using mode 1 or 2.
 PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip, PgenReader* pgr_ptr, unsigned char* pgr_alloc);
 
+typedef struct PgrReadaheadStatsStruct {
+  // records served from the read-ahead window
+  uint64_t hit_ct;
+  // records which weren't in the window (e.g. out-of-order requests, or LD
+  // base variants we didn't predict), and were read synchronously
+  uint64_t miss_ct;
+  // hits which had to wait for their read to complete
+  uint64_t stall_ct;
+  // total time spent waiting on I/O, including synchronous misses
+  uint64_t stall_ns;
+} PgrReadaheadStats;
+
+#ifndef NO_PGEN_IO_POOL
+// Mode 3 (per-variant fread) only.  Starts asynchronous read-ahead of the
+// variants in variant_include[] (nullptr = all variants) in
+// [variant_uidx_start, variant_uidx_end), in increasing order; up to
+// window_size records are kept in flight on io_thread_ct background threads.
+// LD base variants which would otherwise need to be loaded separately are
+// also scheduled.
+//
+// Requests which don't match the schedule are still handled correctly
+// (they're just read synchronously), so the schedule only has to be a good
+// guess.  However, a pointer returned by a PgrGet...() call into the
+// variant's raw record is only valid until the next PgrGet...() call, just
+// like with fread_buf.
+//
+// Any previous read-ahead is stopped first.  Read-ahead is also stopped by
+// CleanupPgr() and PgrValidate().
+// Returns kPglRetNotYetSupported for storage mode 0x12 (zstd-compressed
+// records).
+PglErr PgrReadaheadStart(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t window_size, uint32_t io_thread_ct, PgenReader* pgr_ptr);
+
+// Safe to call when read-ahead isn't active.
+void PgrReadaheadStop(PgenReader* pgr_ptr);
+
+// Zero-fills *statsp if read-ahead isn't active.
+void PgrGetReadaheadStats(const PgenReader* pgr_ptr, PgrReadaheadStats* statsp);
+#endif
+
 // practically all these functions require genovec to be allocated up to
 // vector, not word, boundary
 void PgrPlink1ToPlink2InplaceUnsafe(uint32_t sample_ct, uintptr_t* genovec);
@@ -595,6 +881,48 @@ HEADER_INLINE PglErr PgrGet2(const uintptr_t* __restrict sample_include, PgrSamp
   return IMPLPgrGet2(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, allele_idx0, allele_idx1, pgrp, genovec);
 }
 
+// Batch loader.  Decodes variant_ct variants in one call, resolving the
+// sample subset and allele dispatch once.  Each LD base in the run is decoded
+// once, directly into its dest row, and the difflists of the LD-compressed
+// variants that follow it are applied to copies of that row.
+//
+// Variant selection:
+// * If variant_uidxs is non-null, it lists the variants to load, in output
+//   order (repeats and arbitrary order ok).
+// * Otherwise, if variant_include is non-null, the variants are the first
+//   variant_ct set bits of variant_include at or after variant_uidx_start.
+// * Otherwise, the variants are
+//   [variant_uidx_start, variant_uidx_start + variant_ct).
+// All indexes must be less than raw_variant_ct.
+//
+// allele_idx has PgrGet1() semantics; pass UINT32_MAX to get PgrGet() output
+// (all ALT alleles treated as equivalent) instead.
+//
+// Output is variant-major: variant i's nypvec starts at
+// dest[i * dest_word_stride].  dest_word_stride must be a multiple of
+// kWordsPerVec and at least NypCtToWordCt(sample_ct).
+
+PglErr IMPLPgrGet1Batch(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, const uintptr_t* __restrict variant_include, const uint32_t* __restrict variant_uidxs, uint32_t variant_uidx_start, uint32_t variant_ct, uint32_t allele_idx, PgenReaderMain* pgrp, uintptr_t dest_word_stride, uintptr_t* __restrict dest);
+
+HEADER_INLINE PglErr PgrGet1Batch(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, const uintptr_t* __restrict variant_include, const uint32_t* __restrict variant_uidxs, uint32_t variant_uidx_start, uint32_t variant_ct, uint32_t allele_idx, PgenReader* pgr_ptr, uintptr_t dest_word_stride, uintptr_t* __restrict dest) {
+  PgenReaderMain* pgrp = &GET_PRIVATE(*pgr_ptr, m);
+  const uint32_t* sample_include_cumulative_popcounts = GET_PRIVATE(pssi, cumulative_popcounts);
+  return IMPLPgrGet1Batch(sample_include, sample_include_cumulative_popcounts, sample_ct, variant_include, variant_uidxs, variant_uidx_start, variant_ct, allele_idx, pgrp, dest_word_stride, dest);
+}
+
+// Sample-major version of PgrGet1Batch().  Variants are loaded
+// kPglNypTransposeBatch at a time into vmaj_buf (which must have room for
+// kPglNypTransposeBatch rows of NypCtToVecCt(sample_ct) vectors), and then
+// transposed with TransposeNypblock() into dest, where sample i's nypvec
+// starts at dest[i * dest_word_stride].  LD bases are decoded once per
+// kPglNypTransposeBatch-variant block, as in PgrGet1Batch().
+// * transpose_buf must be vector-aligned with size kPglNypTransposeBufbytes.
+// * dest_word_stride must be at least
+//   kPglNypTransposeWords * DivUp(variant_ct, kPglNypTransposeBatch).
+// * dest must have room for RoundUpPow2(sample_ct, 4) rows.
+// * Trailing nyps of each dest row (past variant_ct) are not zeroed out.
+PglErr PgrGet1BatchTransposed(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, const uintptr_t* __restrict variant_include, const uint32_t* __restrict variant_uidxs, uint32_t variant_uidx_start, uint32_t variant_ct, uint32_t allele_idx, PgenReader* pgr_ptr, uintptr_t* __restrict vmaj_buf, VecW* transpose_buf, uintptr_t dest_word_stride, uintptr_t* __restrict dest);
+
 void PreinitPgv(PgenVariant* pgvp);
 
 PglErr PgrGetM(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, PgenReader* pgr_ptr, PgenVariant* pgvp);
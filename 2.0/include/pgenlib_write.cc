@@ -17,6 +17,15 @@
 
 #include "pgenlib_write.h"
 
+#include <errno.h>
+#include <sys/types.h>  // fstat()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>  // fsync(), copy_file_range()
+
+#if defined(__linux__) && defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 27))
+#  define PGL_COPY_FILE_RANGE
+#endif
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -46,9 +55,42 @@ void GenovecInvertCopyUnsafe(const uintptr_t* __restrict genovec, uint32_t sampl
 
 void PreinitSpgw(STPgenWriter* spgwp) {
   *GetPgenOutfilep(spgwp) = nullptr;
+  GetPwcp(spgwp)->zw = nullptr;
 }
 
-PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict allele_idx_offsets, uintptr_t* explicit_nonref_flags, uint32_t variant_ct, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, uint32_t vrec_len_byte_ct, PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
+// Flushes stdio buffers and asks the OS to commit the file, so that nothing
+// written afterwards can reach the disk first.
+static BoolErr PwcSyncFile(FILE* outfile) {
+  if (unlikely(fflush(outfile))) {
+    return 1;
+  }
+#ifndef _WIN32
+  if (unlikely(fsync(fileno(outfile)))) {
+    return 1;
+  }
+#endif
+  return 0;
+}
+
+// Number of header bytes following the 12-byte fixed-size part, i.e. the
+// vblock_fpos array and the per-vblock vrtype/vrec_len/nonref_flags tables.
+static uintptr_t PwcHeaderTableByteCt(uint32_t variant_ct, uint32_t vrec_len_byte_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage) {
+  const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
+  uintptr_t byte_ct = vblock_ct * sizeof(int64_t) + variant_ct * S_CAST(uintptr_t, vrec_len_byte_ct);
+  if (phase_dosage_gflags) {
+    // 8-bit vrtypes
+    byte_ct += variant_ct;
+  } else {
+    // 4-bit vrtypes
+    byte_ct += DivUp(variant_ct, 2);
+  }
+  if (nonref_flags_storage == 3) {
+    byte_ct += DivUp(variant_ct, CHAR_BIT);
+  }
+  return byte_ct;
+}
+
+static PglErr PwcInitFields(const uintptr_t* __restrict allele_idx_offsets, uintptr_t* explicit_nonref_flags, uint32_t variant_ct, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, uint32_t vrec_len_byte_ct, PgenWriterCommon* pwcp) {
   pwcp->allele_idx_offsets = allele_idx_offsets;
   pwcp->explicit_nonref_flags = nullptr;
   if (nonref_flags_storage == 3) {
@@ -60,6 +102,10 @@ PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict a
   pwcp->variant_ct = variant_ct;
   pwcp->sample_ct = sample_ct;
   pwcp->phase_dosage_gflags = phase_dosage_gflags;
+  pwcp->vsums = nullptr;
+  pwcp->vsum_fname = nullptr;
+  pwcp->ld_search = nullptr;
+  pwcp->zw = nullptr;
 #ifndef NDEBUG
   pwcp->vblock_fpos = nullptr;
   pwcp->vrec_len_buf = nullptr;
@@ -72,8 +118,19 @@ PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict a
   pwcp->ldbase_raregeno = nullptr;
   pwcp->ldbase_difflist_sample_ids = nullptr;
 #endif
+  pwcp->vrec_len_byte_ct = vrec_len_byte_ct;
   pwcp->vidx = 0;
+  pwcp->append_vidx_start = 0;
+  pwcp->append_fname = nullptr;
+  pwcp->append_tmp_active = 0;
+  return kPglRetSuccess;
+}
 
+PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict allele_idx_offsets, uintptr_t* explicit_nonref_flags, uint32_t variant_ct, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, uint32_t vrec_len_byte_ct, PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
+  const PglErr reterr = PwcInitFields(allele_idx_offsets, explicit_nonref_flags, variant_ct, sample_ct, phase_dosage_gflags, nonref_flags_storage, vrec_len_byte_ct, pwcp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
   FILE* pgen_outfile = fopen(fname, FOPEN_WB);
   *pgen_outfile_ptr = pgen_outfile;
   if (unlikely(!pgen_outfile)) {
@@ -84,20 +141,8 @@ PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict a
   fwrite_unlocked(&(pwcp->sample_ct), sizeof(int32_t), 1, pgen_outfile);
 
   const unsigned char control_byte = (vrec_len_byte_ct - 1) + (4 * (phase_dosage_gflags != 0)) + (nonref_flags_storage << 6);
-  pwcp->vrec_len_byte_ct = vrec_len_byte_ct;
   fwrite_unlocked(&control_byte, 1, 1, pgen_outfile);
-  const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
-  uintptr_t header_bytes_left = vblock_ct * sizeof(int64_t) + variant_ct * vrec_len_byte_ct;
-  if (phase_dosage_gflags) {
-    // 8-bit vrtypes
-    header_bytes_left += variant_ct;
-  } else {
-    // 4-bit vrtypes
-    header_bytes_left += DivUp(variant_ct, 2);
-  }
-  if (nonref_flags_storage == 3) {
-    header_bytes_left += DivUp(variant_ct, CHAR_BIT);
-  }
+  uintptr_t header_bytes_left = PwcHeaderTableByteCt(variant_ct, vrec_len_byte_ct, phase_dosage_gflags, nonref_flags_storage);
 
   // this should be the position of the first variant
   pwcp->vblock_fpos_offset = 12 + header_bytes_left;
@@ -119,7 +164,7 @@ PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict a
   return kPglRetSuccess;
 }
 
-uint32_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t max_vrec_len) {
+uint32_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t max_vrec_len, uintptr_t vrec_len_byte_ct) {
   // vblock_fpos
   const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
   uint32_t cachelines_required = Int64CtToCachelineCt(vblock_ct);
@@ -127,7 +172,6 @@ uint32_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct, uint32_t sample_c
   // vrec_len_buf
   // overlapping uint32_t writes used, so (variant_ct * vrec_len_byte_ct) might
   // not be enough
-  const uintptr_t vrec_len_byte_ct = BytesToRepresentNzU32(max_vrec_len);
   cachelines_required += DivUp((variant_ct - 1) * vrec_len_byte_ct + sizeof(int32_t), kCacheline);
 
   // vrtype_buf
@@ -159,11 +203,9 @@ uint32_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct, uint32_t sample_c
   return cachelines_required;
 }
 
-static_assert(kPglMaxAlleleCt == 255, "Need to update SpgwInitPhase1().");
-PglErr SpgwInitPhase1(const char* __restrict fname, const uintptr_t* __restrict allele_idx_offsets, uintptr_t* __restrict explicit_nonref_flags, uint32_t variant_ct, uint32_t sample_ct, uint32_t optional_max_allele_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, STPgenWriter* spgwp, uintptr_t* alloc_cacheline_ct_ptr, uint32_t* max_vrec_len_ptr) {
-  assert(variant_ct);
-  assert(sample_ct);
-
+static_assert(kPglMaxAlleleCt == 255, "Need to update SpgwMaxVrecLen().");
+// Covers variants [vidx_start, vidx_end).
+static PglErr SpgwMaxVrecLen(const uintptr_t* __restrict allele_idx_offsets, uint32_t vidx_start, uint32_t vidx_end, uint32_t sample_ct, uint32_t optional_max_allele_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t* max_vrec_len_ptr) {
   // separate from MpgwInitPhase1's version of this computation since the
   // latter wants a better bound on the compressed size of an entire vblock
   // than max_vrec_len * kPglVblockSize...
@@ -172,13 +214,13 @@ PglErr SpgwInitPhase1(const char* __restrict fname, const uintptr_t* __restrict
   if (allele_idx_offsets) {
     if (optional_max_allele_ct) {
       max_alt_ct_p1 = optional_max_allele_ct;
-    } else if (allele_idx_offsets[variant_ct] != 2 * variant_ct) {
-      assert(allele_idx_offsets[0] == 0);
-      assert(allele_idx_offsets[variant_ct] > 2 * variant_ct);
+    } else if (allele_idx_offsets[vidx_end] - allele_idx_offsets[vidx_start] != 2 * (vidx_end - vidx_start)) {
+      assert(vidx_start || (allele_idx_offsets[0] == 0));
+      assert(allele_idx_offsets[vidx_end] - allele_idx_offsets[vidx_start] > 2 * (vidx_end - vidx_start));
       // could add this as a parameter, since caller should know...
       max_alt_ct_p1 = 3;
-      uintptr_t prev_offset = 0;
-      for (uint32_t vidx = 1; vidx <= variant_ct; ++vidx) {
+      uintptr_t prev_offset = allele_idx_offsets[vidx_start];
+      for (uint32_t vidx = vidx_start + 1; vidx <= vidx_end; ++vidx) {
         const uintptr_t cur_offset = allele_idx_offsets[vidx];
         if (cur_offset - prev_offset > max_alt_ct_p1) {
           max_alt_ct_p1 = cur_offset - prev_offset;
@@ -215,17 +257,105 @@ PglErr SpgwInitPhase1(const char* __restrict fname, const uintptr_t* __restrict
   }
 #endif
   *max_vrec_len_ptr = max_vrec_len;
+  return kPglRetSuccess;
+}
+
+PglErr SpgwInitPhase1(const char* __restrict fname, const uintptr_t* __restrict allele_idx_offsets, uintptr_t* __restrict explicit_nonref_flags, uint32_t variant_ct, uint32_t sample_ct, uint32_t optional_max_allele_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, STPgenWriter* spgwp, uintptr_t* alloc_cacheline_ct_ptr, uint32_t* max_vrec_len_ptr) {
+  assert(variant_ct);
+  assert(sample_ct);
+  PglErr reterr = SpgwMaxVrecLen(allele_idx_offsets, 0, variant_ct, sample_ct, optional_max_allele_ct, phase_dosage_gflags, max_vrec_len_ptr);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  const uint32_t max_vrec_len = *max_vrec_len_ptr;
   const uintptr_t vrec_len_byte_ct = BytesToRepresentNzU32(max_vrec_len);
 
   PgenWriterCommon* pwcp = GetPwcp(spgwp);
   FILE** pgen_outfilep = GetPgenOutfilep(spgwp);
-  PglErr reterr = PwcInitPhase1(fname, allele_idx_offsets, explicit_nonref_flags, variant_ct, sample_ct, phase_dosage_gflags, nonref_flags_storage, vrec_len_byte_ct, pwcp, pgen_outfilep);
+  reterr = PwcInitPhase1(fname, allele_idx_offsets, explicit_nonref_flags, variant_ct, sample_ct, phase_dosage_gflags, nonref_flags_storage, vrec_len_byte_ct, pwcp, pgen_outfilep);
   if (!reterr) {
-    *alloc_cacheline_ct_ptr = CountSpgwAllocCachelinesRequired(variant_ct, sample_ct, phase_dosage_gflags, max_vrec_len);
+    *alloc_cacheline_ct_ptr = CountSpgwAllocCachelinesRequired(variant_ct, sample_ct, phase_dosage_gflags, max_vrec_len, vrec_len_byte_ct);
   }
   return reterr;
 }
 
+PglErr SpgwInitPhase1Append(const char* __restrict fname, const uintptr_t* __restrict allele_idx_offsets, uintptr_t* __restrict explicit_nonref_flags, uint32_t append_variant_ct, uint32_t sample_ct, uint32_t optional_max_allele_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, STPgenWriter* spgwp, uintptr_t* alloc_cacheline_ct_ptr, uint32_t* max_vrec_len_ptr, uint32_t* prev_variant_ct_ptr) {
+  assert(append_variant_ct);
+  assert(sample_ct);
+  FILE** pgen_outfilep = GetPgenOutfilep(spgwp);
+  // The original is only read from; see SpgwInitPhase2Append().
+  FILE* pgen_outfile = fopen(fname, FOPEN_RB);
+  *pgen_outfilep = pgen_outfile;
+  if (unlikely(!pgen_outfile)) {
+    return kPglRetOpenFail;
+  }
+  // CleanupSpgw() consults these whenever the file is open.
+  PgenWriterCommon* pwcp = GetPwcp(spgwp);
+  pwcp->append_fname = nullptr;
+  pwcp->append_tmp_active = 0;
+  unsigned char header[12];
+  if (unlikely(!fread_unlocked(header, 12, 1, pgen_outfile))) {
+    return kPglRetReadFail;
+  }
+  if (unlikely(!memequal_k(header, "l\x1b", 2))) {
+    return kPglRetMalformedInput;
+  }
+  // Fixed-width modes could be supported by rewriting the whole file, but
+  // that's what we're trying to avoid.
+  if (unlikely(header[2] != 0x10)) {
+    return kPglRetNotYetSupported;
+  }
+  uint32_t prev_variant_ct;
+  uint32_t file_sample_ct;
+  memcpy(&prev_variant_ct, &(header[3]), sizeof(int32_t));
+  memcpy(&file_sample_ct, &(header[7]), sizeof(int32_t));
+  const uint32_t prev_header_ctrl = header[11];
+  if (unlikely(!prev_variant_ct)) {
+    return kPglRetMalformedInput;
+  }
+  // alt allele counts and the special vrtype/vrec_len encodings are never
+  // written by this library
+  if (unlikely(prev_header_ctrl & 0x38)) {
+    return kPglRetNotYetSupported;
+  }
+  if (unlikely((file_sample_ct != sample_ct) || ((prev_header_ctrl >> 6) != nonref_flags_storage))) {
+    return kPglRetInconsistentInput;
+  }
+  if (unlikely(append_variant_ct > 0x7ffffffdU - prev_variant_ct)) {
+    return kPglRetImproperFunctionCall;
+  }
+  *prev_variant_ct_ptr = prev_variant_ct;
+  const uint32_t variant_ct = prev_variant_ct + append_variant_ct;
+  PglErr reterr = SpgwMaxVrecLen(allele_idx_offsets, prev_variant_ct, variant_ct, sample_ct, optional_max_allele_ct, phase_dosage_gflags, max_vrec_len_ptr);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  const uint32_t max_vrec_len = *max_vrec_len_ptr;
+  // The whole header is rewritten, so it's fine for the vrec_len and vrtype
+  // widths to grow; they just can't shrink.
+  const uintptr_t vrec_len_byte_ct = MAXV(BytesToRepresentNzU32(max_vrec_len), 1 + (prev_header_ctrl & 3));
+  if ((prev_header_ctrl & 4) && (!phase_dosage_gflags)) {
+    // Only the vrtype width depends on the exact value.
+    phase_dosage_gflags = kfPgenGlobalHardcallPhasePresent;
+  }
+  reterr = PwcInitFields(allele_idx_offsets, explicit_nonref_flags, variant_ct, sample_ct, phase_dosage_gflags, nonref_flags_storage, vrec_len_byte_ct, pwcp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  pwcp->vidx = prev_variant_ct;
+  pwcp->append_vidx_start = prev_variant_ct;
+  const uintptr_t fname_slen = strlen(fname);
+  if (unlikely(pgl_malloc(2 * fname_slen + 6, &pwcp->append_fname))) {
+    return kPglRetNomem;
+  }
+  memcpy(pwcp->append_fname, fname, fname_slen + 1);
+  char* tmp_fname = &(pwcp->append_fname[fname_slen + 1]);
+  memcpy(tmp_fname, fname, fname_slen);
+  memcpy(&(tmp_fname[fname_slen]), ".tmp", 5);
+  *alloc_cacheline_ct_ptr = CountSpgwAllocCachelinesRequired(variant_ct, sample_ct, phase_dosage_gflags, max_vrec_len, vrec_len_byte_ct);
+  return kPglRetSuccess;
+}
+
 static_assert(kPglMaxAlleleCt == 255, "Need to update MpgwInitPhase1().");
 void MpgwInitPhase1(const uintptr_t* __restrict allele_idx_offsets, uint32_t variant_ct, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uintptr_t* alloc_base_cacheline_ct_ptr, uint64_t* alloc_per_thread_cacheline_ct_ptr, uint32_t* vrec_len_byte_ct_ptr, uint64_t* vblock_cacheline_ct_ptr) {
   assert(variant_ct);
@@ -450,6 +580,212 @@ void SpgwInitPhase2(uint32_t max_vrec_len, STPgenWriter* spgwp, unsigned char* s
   PwcInitPhase2(fwrite_cacheline_ct, 1, &pwcp, spgw_alloc);
 }
 
+PglErr SpgwInitPhase2Append(uint32_t max_vrec_len, STPgenWriter* spgwp, unsigned char* spgw_alloc) {
+  SpgwInitPhase2(max_vrec_len, spgwp, spgw_alloc);
+  PgenWriterCommon* pwcp = GetPwcp(spgwp);
+  FILE* pgen_outfile = *GetPgenOutfilep(spgwp);
+  const uint32_t prev_variant_ct = pwcp->append_vidx_start;
+  unsigned char prev_header_ctrl;
+  if (unlikely(fseeko(pgen_outfile, 11, SEEK_SET) ||
+               (!fread_unlocked(&prev_header_ctrl, 1, 1, pgen_outfile)))) {
+    return kPglRetReadFail;
+  }
+  // Load the existing header tables, converting to the (possibly wider)
+  // vrtype and vrec_len widths we'll write.  fwrite_buf is free to use as
+  // scratch space.
+  const uint32_t prev_vblock_ct = DivUp(prev_variant_ct, kPglVblockSize);
+  uint64_t* vblock_fpos = pwcp->vblock_fpos;
+  if (unlikely(!fread_unlocked(vblock_fpos, prev_vblock_ct * sizeof(int64_t), 1, pgen_outfile))) {
+    return kPglRetReadFail;
+  }
+  const uint32_t prev_vrtype_is_8bit = (prev_header_ctrl >> 2) & 1;
+  const uint32_t prev_vrec_len_byte_ct = 1 + (prev_header_ctrl & 3);
+  const uint32_t vrtype_is_8bit = (pwcp->phase_dosage_gflags != 0);
+  const uintptr_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
+  unsigned char* vrtype_buf = R_CAST(unsigned char*, pwcp->vrtype_buf);
+  unsigned char* vrec_len_buf = pwcp->vrec_len_buf;
+  unsigned char* explicit_nonref_flags_alias = R_CAST(unsigned char*, pwcp->explicit_nonref_flags);
+  unsigned char* scratch = pwcp->fwrite_buf;
+  const uint32_t vrec_len_chunk_size = kPglFwriteBlockSize / sizeof(int32_t);
+  for (uint32_t vblock_idx = 0; vblock_idx != prev_vblock_ct; ++vblock_idx) {
+    const uint32_t vidx_start = vblock_idx * kPglVblockSize;
+    const uint32_t vblock_size = MINV(prev_variant_ct - vidx_start, kPglVblockSize);
+    if (prev_vrtype_is_8bit == vrtype_is_8bit) {
+      unsigned char* vrtype_dst = &(vrtype_buf[vrtype_is_8bit? vidx_start : (vidx_start / 2)]);
+      if (unlikely(!fread_unlocked(vrtype_dst, vrtype_is_8bit? vblock_size : DivUp(vblock_size, 2), 1, pgen_outfile))) {
+        return kPglRetReadFail;
+      }
+      if ((!vrtype_is_8bit) && (vblock_size % 2)) {
+        // new vrtypes are ORed into vrtype_buf
+        vrtype_dst[vblock_size / 2] &= 15;
+      }
+    } else {
+      // 4-bit -> 8-bit
+      if (unlikely(!fread_unlocked(scratch, DivUp(vblock_size, 2), 1, pgen_outfile))) {
+        return kPglRetReadFail;
+      }
+      unsigned char* vrtype_dst = &(vrtype_buf[vidx_start]);
+      for (uint32_t uii = 0; uii != vblock_size; ++uii) {
+        vrtype_dst[uii] = (scratch[uii / 2] >> (4 * (uii % 2))) & 15;
+      }
+    }
+    if (prev_vrec_len_byte_ct == vrec_len_byte_ct) {
+      if (unlikely(!fread_unlocked(&(vrec_len_buf[vidx_start * vrec_len_byte_ct]), vblock_size * vrec_len_byte_ct, 1, pgen_outfile))) {
+        return kPglRetReadFail;
+      }
+    } else {
+      for (uint32_t chunk_start = 0; chunk_start < vblock_size; chunk_start += vrec_len_chunk_size) {
+        const uint32_t chunk_size = MINV(vblock_size - chunk_start, vrec_len_chunk_size);
+        if (unlikely(!fread_unlocked(scratch, chunk_size * prev_vrec_len_byte_ct, 1, pgen_outfile))) {
+          return kPglRetReadFail;
+        }
+        unsigned char* vrec_len_dst = &(vrec_len_buf[(vidx_start + chunk_start) * vrec_len_byte_ct]);
+        for (uint32_t uii = 0; uii != chunk_size; ++uii) {
+          SubU32Store(SubU32Load(&(scratch[uii * prev_vrec_len_byte_ct]), prev_vrec_len_byte_ct), vrec_len_byte_ct, &(vrec_len_dst[uii * vrec_len_byte_ct]));
+        }
+      }
+    }
+    if (explicit_nonref_flags_alias) {
+      const uint32_t full_byte_ct = vblock_size / CHAR_BIT;
+      const uint32_t trailing_bit_ct = vblock_size % CHAR_BIT;
+      if (unlikely(!fread_unlocked(scratch, full_byte_ct + (trailing_bit_ct != 0), 1, pgen_outfile))) {
+        return kPglRetReadFail;
+      }
+      unsigned char* nonref_dst = &(explicit_nonref_flags_alias[vidx_start / CHAR_BIT]);
+      memcpy(nonref_dst, scratch, full_byte_ct);
+      if (trailing_bit_ct) {
+        // preserve any flags the caller has already filled in for the
+        // appended variants
+        const unsigned char prev_mask = (1U << trailing_bit_ct) - 1;
+        nonref_dst[full_byte_ct] = (nonref_dst[full_byte_ct] & (~prev_mask)) | (scratch[full_byte_ct] & prev_mask);
+      }
+    }
+  }
+  const uint64_t prev_first_fpos = vblock_fpos[0];
+  if (unlikely(fseeko(pgen_outfile, 0, SEEK_END))) {
+    return kPglRetReadFail;
+  }
+  const uint64_t fsize = ftello(pgen_outfile);
+  uint64_t records_end = prev_first_fpos;
+  for (uint32_t vidx = 0; vidx != prev_variant_ct; ++vidx) {
+    records_end += SubU32Load(&(vrec_len_buf[vidx * vrec_len_byte_ct]), vrec_len_byte_ct);
+  }
+  if (unlikely(fsize < records_end)) {
+    return kPglRetMalformedInput;
+  }
+
+  const uint32_t variant_ct = pwcp->variant_ct;
+  const uint32_t nonref_flags_storage = prev_header_ctrl >> 6;
+  const unsigned char control_byte = (vrec_len_byte_ct - 1) + (4 * vrtype_is_8bit) + (nonref_flags_storage << 6);
+  const uintptr_t header_table_byte_ct = PwcHeaderTableByteCt(variant_ct, vrec_len_byte_ct, pwcp->phase_dosage_gflags, nonref_flags_storage);
+  // Every append changes the header table layout (the last vblock's vrtype
+  // and vrec_len sections grow, or a new vblock_fpos entry shifts everything
+  // after it), so the header can't be rewritten in place without a window
+  // where the original is invalid.  Instead, the new file is always built
+  // under a temporary name and renamed over the original by SpgwFinish().
+  // If the larger header still fits in front of the existing records, they
+  // keep their offsets (so a filesystem with reflink support can share their
+  // blocks); otherwise they're moved back far enough for the header to
+  // double, rounded up to a 4 KiB multiple for the same reason.
+  uint64_t new_first_fpos = prev_first_fpos;
+  if (12 + header_table_byte_ct > prev_first_fpos) {
+    new_first_fpos += RoundUpPow2(12 + 2 * S_CAST(uint64_t, header_table_byte_ct) - prev_first_fpos, 4096);
+  }
+  const uint64_t delta = new_first_fpos - prev_first_fpos;
+  const char* tmp_fname = &(pwcp->append_fname[strlen(pwcp->append_fname) + 1]);
+  FILE* tmp_outfile = fopen(tmp_fname, FOPEN_WB);
+  if (unlikely(!tmp_outfile)) {
+    return kPglRetOpenFail;
+  }
+  PglErr reterr = kPglRetSuccess;
+  {
+    // Fixed-size part of the header, then zeroes; the tables are written by
+    // SpgwFinish().
+    memcpy(scratch, "l\x1b\x10", 3);
+    memcpy(&(scratch[3]), &variant_ct, sizeof(int32_t));
+    memcpy(&(scratch[7]), &(pwcp->sample_ct), sizeof(int32_t));
+    scratch[11] = control_byte;
+    memset(&(scratch[12]), 0, kPglFwriteBlockSize - 12);
+    for (uint64_t bytes_left = new_first_fpos; bytes_left; ) {
+      const uintptr_t cur_byte_ct = MINV(bytes_left, kPglFwriteBlockSize);
+      if (unlikely(fwrite_checked(scratch, cur_byte_ct, tmp_outfile))) {
+        goto SpgwInitPhase2Append_ret_WRITE_FAIL;
+      }
+      memset(scratch, 0, 12);
+      bytes_left -= cur_byte_ct;
+    }
+    if (unlikely(fflush(tmp_outfile))) {
+      goto SpgwInitPhase2Append_ret_WRITE_FAIL;
+    }
+    uint64_t src_fpos = prev_first_fpos;
+    uint64_t dst_fpos = new_first_fpos;
+#ifdef PGL_COPY_FILE_RANGE
+    {
+      // Copied in-kernel; the stdio buffers are bypassed, which is fine since
+      // both offsets are explicit and tmp_outfile was just flushed.
+      const int32_t src_fd = fileno(pgen_outfile);
+      const int32_t dst_fd = fileno(tmp_outfile);
+      while (src_fpos != records_end) {
+        loff_t src_off = src_fpos;
+        loff_t dst_off = dst_fpos;
+        const ssize_t cur_byte_ct = copy_file_range(src_fd, &src_off, dst_fd, &dst_off, MINV(records_end - src_fpos, 0x40000000), 0);
+        if (cur_byte_ct <= 0) {
+          if (unlikely(!cur_byte_ct)) {
+            goto SpgwInitPhase2Append_ret_READ_FAIL;
+          }
+          if (unlikely((errno != EXDEV) && (errno != ENOSYS) && (errno != EINVAL) && (errno != EOPNOTSUPP))) {
+            goto SpgwInitPhase2Append_ret_WRITE_FAIL;
+          }
+          // Not supported for this pair of files; copy the rest below.
+          break;
+        }
+        src_fpos += cur_byte_ct;
+        dst_fpos += cur_byte_ct;
+      }
+    }
+#endif
+    if (src_fpos != records_end) {
+      if (unlikely(fseeko(pgen_outfile, src_fpos, SEEK_SET))) {
+        goto SpgwInitPhase2Append_ret_READ_FAIL;
+      }
+      for (uint64_t bytes_left = records_end - src_fpos; bytes_left; ) {
+        const uintptr_t cur_byte_ct = MINV(bytes_left, kPglFwriteBlockSize);
+        if (unlikely(!fread_unlocked(scratch, cur_byte_ct, 1, pgen_outfile))) {
+          goto SpgwInitPhase2Append_ret_READ_FAIL;
+        }
+        if (unlikely(fwrite_checked(scratch, cur_byte_ct, tmp_outfile))) {
+          goto SpgwInitPhase2Append_ret_WRITE_FAIL;
+        }
+        bytes_left -= cur_byte_ct;
+      }
+    }
+    // Bytes after records_end in the original (e.g. left behind by an
+    // interrupted session that predates this scheme) are dropped here.
+    if (unlikely(fseeko(tmp_outfile, records_end + delta, SEEK_SET))) {
+      goto SpgwInitPhase2Append_ret_WRITE_FAIL;
+    }
+    fclose(pgen_outfile);
+    *GetPgenOutfilep(spgwp) = tmp_outfile;
+    pwcp->append_tmp_active = 1;
+    for (uint32_t vblock_idx = 0; vblock_idx != prev_vblock_ct; ++vblock_idx) {
+      vblock_fpos[vblock_idx] += delta;
+    }
+    pwcp->vblock_fpos_offset = records_end + delta;
+    return kPglRetSuccess;
+  }
+  while (0) {
+  SpgwInitPhase2Append_ret_READ_FAIL:
+    reterr = kPglRetReadFail;
+    break;
+  SpgwInitPhase2Append_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  }
+  fclose(tmp_outfile);
+  remove(tmp_fname);
+  return reterr;
+}
+
 PglErr MpgwInitPhase2(const char* __restrict fname, const uintptr_t* __restrict allele_idx_offsets, uintptr_t* __restrict explicit_nonref_flags, uint32_t variant_ct, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, uint32_t vrec_len_byte_ct, uintptr_t vblock_cacheline_ct, uint32_t thread_ct, unsigned char* mpgw_alloc, MTPgenWriter* mpgwp) {
   assert(thread_ct);
   const uintptr_t pwc_byte_ct = RoundUpPow2(sizeof(PgenWriterCommon), kCacheline);
@@ -811,12 +1147,25 @@ uint32_t SaveOnebit(const uintptr_t* __restrict genovec, uint32_t common2_code,
   }
 }
 
+static inline void InitVariantSummary(STD_ARRAY_KREF(uint32_t, 4) genocounts, PgenVariantSummary* vsump) {
+  memcpy(vsump->geno_cts, &(genocounts[0]), 4 * sizeof(int32_t));
+  vsump->dosage_sums[0] = (genocounts[0] * 2 + genocounts[1]) * 16384LLU;
+  vsump->dosage_sums[1] = (genocounts[2] * 2 + genocounts[1]) * 16384LLU;
+  vsump->phased_het_ct = 0;
+  vsump->dosage_ct = 0;
+}
+
 // returns vrec_len
-uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint32_t vidx, PgenWriterCommon* pwcp, uint32_t* het_ct_ptr, uint32_t* altxy_ct_ptr, unsigned char* vrtype_ptr) {
+// ld_allowed == 0 forces a new LD base; this is used by the multi-candidate
+// LD-base search.
+static uint32_t AppendBiallelicGenovecMainInternal(const uintptr_t* __restrict genovec, uint32_t vidx, uint32_t ld_allowed, PgenWriterCommon* pwcp, uint32_t* het_ct_ptr, uint32_t* altxy_ct_ptr, unsigned char* vrtype_ptr) {
   const uint32_t sample_ct = pwcp->sample_ct;
   assert((!(sample_ct % kBitsPerWordD2)) || (!(genovec[sample_ct / kBitsPerWordD2] >> (2 * (sample_ct % kBitsPerWordD2)))));
   STD_ARRAY_DECL(uint32_t, 4, genocounts);
   GenoarrCountFreqsUnsafe(genovec, sample_ct, genocounts);
+  if (pwcp->vsums) {
+    InitVariantSummary(genocounts, &(pwcp->vsums[vidx]));
+  }
   if (het_ct_ptr) {
     *het_ct_ptr = genocounts[1];
     if (altxy_ct_ptr) {
@@ -861,7 +1210,7 @@ uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint
     // er, need to use a relative offset in the multithreaded case, absolute
     // position isn't known
     pwcp->vblock_fpos[vidx / kPglVblockSize] = pwcp->vblock_fpos_offset + S_CAST(uintptr_t, pwcp->fwrite_bufp - pwcp->fwrite_buf);
-  } else if (difflist_len > sample_ctd64) {
+  } else if (ld_allowed && (difflist_len > sample_ctd64)) {
     // do not use LD compression if there are at least this many differences.
     // tune this threshold in the future.
     const uint32_t ld_diff_threshold = difflist_viable? (difflist_len - sample_ctd64) : max_difflist_len;
@@ -923,8 +1272,213 @@ uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint
   return vrec_len;
 }
 
+uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint32_t vidx, PgenWriterCommon* pwcp, uint32_t* het_ct_ptr, uint32_t* altxy_ct_ptr, unsigned char* vrtype_ptr) {
+  return AppendBiallelicGenovecMainInternal(genovec, vidx, (vidx != pwcp->append_vidx_start), pwcp, het_ct_ptr, altxy_ct_ptr, vrtype_ptr);
+}
+
+uintptr_t PgenLdSearchCachelineCt(uint32_t sample_ct, uint32_t window_max) {
+  const uintptr_t slot_ct = window_max + 1;
+  uintptr_t cachelines_required = DivUp(sizeof(PgenLdSearch), kCacheline);
+  cachelines_required += DivUp(slot_ct * (sizeof(intptr_t) * 2 + sizeof(int32_t) + 1), kCacheline);
+  cachelines_required += slot_ct * NypCtToCachelineCt(sample_ct);
+  // trial re-encoding of up to window_max + 1 records, plus one record of
+  // overrun before the size check kicks in
+  const uintptr_t max_main_vrec_len = NypCtToByteCt(sample_ct) + (5 + sizeof(AlleleCode)) * kPglDifflistGroupSize;
+  cachelines_required += DivUp((window_max + 2) * max_main_vrec_len, kCacheline);
+  return cachelines_required;
+}
+
+void PwcInitLdSearch(uint32_t window_max, unsigned char* ld_search_alloc, PgenWriterCommon* pwcp) {
+  const uint32_t sample_ct = pwcp->sample_ct;
+  const uintptr_t slot_ct = window_max + 1;
+  unsigned char* alloc_iter = ld_search_alloc;
+  PgenLdSearch* ldsp = R_CAST(PgenLdSearch*, alloc_iter);
+  alloc_iter = &(alloc_iter[RoundUpPow2(sizeof(PgenLdSearch), kCacheline)]);
+  ldsp->slot_genovecs = R_CAST(uintptr_t**, alloc_iter);
+  ldsp->rec_offsets = R_CAST(uintptr_t*, &(alloc_iter[slot_ct * sizeof(intptr_t)]));
+  ldsp->trial_vrec_lens = R_CAST(uint32_t*, &(alloc_iter[slot_ct * (2 * sizeof(intptr_t))]));
+  ldsp->trial_vrtypes = &(alloc_iter[slot_ct * (2 * sizeof(intptr_t) + sizeof(int32_t))]);
+  alloc_iter = &(alloc_iter[DivUp(slot_ct * (sizeof(intptr_t) * 2 + sizeof(int32_t) + 1), kCacheline) * kCacheline]);
+  const uintptr_t genovec_byte_alloc = NypCtToCachelineCt(sample_ct) * kCacheline;
+  for (uintptr_t slot_idx = 0; slot_idx != slot_ct; ++slot_idx) {
+    ldsp->slot_genovecs[slot_idx] = R_CAST(uintptr_t*, alloc_iter);
+    alloc_iter = &(alloc_iter[genovec_byte_alloc]);
+  }
+  ldsp->scratch = alloc_iter;
+  ldsp->next_bufp = nullptr;
+  ldsp->window_max = window_max;
+  ldsp->window_len = 0;
+  ldsp->next_vidx = UINT32_MAX;
+  pwcp->ld_search = ldsp;
+}
+
+void MpgwEnableLdSearch(uint32_t window_max, unsigned char* ld_search_alloc, MTPgenWriter* mpgwp) {
+  const uint32_t thread_ct = mpgwp->thread_ct;
+  const uintptr_t per_thread_byte_ct = PgenLdSearchCachelineCt(mpgwp->pwcs[0]->sample_ct, window_max) * kCacheline;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    PwcInitLdSearch(window_max, &(ld_search_alloc[tidx * per_thread_byte_ct]), mpgwp->pwcs[tidx]);
+  }
+}
+
+// Unlike the plain appenders, this can overwrite a previously-set entry.
+static void PwcSetVrecLenAndType(uint32_t vidx, uint32_t vrec_len, unsigned char vrtype, PgenWriterCommon* pwcp) {
+  const uintptr_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
+  SubU32Store(vrec_len, vrec_len_byte_ct, &(pwcp->vrec_len_buf[vidx * vrec_len_byte_ct]));
+  if (!pwcp->phase_dosage_gflags) {
+    // a vrtype_buf word never straddles two variant blocks, so this is safe
+    // in the multithreaded case
+    uintptr_t* vrtype_wordp = &(pwcp->vrtype_buf[vidx / kBitsPerWordD4]);
+    const uint32_t bit_shift = 4 * (vidx % kBitsPerWordD4);
+    *vrtype_wordp = ((*vrtype_wordp) & (~((15 * k1LU) << bit_shift))) | (S_CAST(uintptr_t, vrtype) << bit_shift);
+  } else {
+    R_CAST(unsigned char*, pwcp->vrtype_buf)[vidx] = vrtype;
+  }
+}
+
+// Re-encodes window entries [cand_widx, window_len) followed by genovec
+// (variant window_len) into ldsp->scratch, with window entry cand_widx
+// promoted to an LD base.  Returns the encoded byte count, or byte_limit if
+// that was reached first (the encoding is then incomplete).  Leaves
+// pwcp->fwrite_bufp pointing into scratch; the caller must restore it.
+static uintptr_t LdSearchTrial(const uintptr_t* __restrict genovec, uint32_t first_window_vidx, uint32_t cand_widx, uintptr_t byte_limit, PgenWriterCommon* pwcp) {
+  PgenLdSearch* ldsp = pwcp->ld_search;
+  uintptr_t** slot_genovecs = ldsp->slot_genovecs;
+  const uint32_t window_len = ldsp->window_len;
+  unsigned char* scratch = ldsp->scratch;
+  uint32_t* trial_vrec_lens = ldsp->trial_vrec_lens;
+  unsigned char* trial_vrtypes = ldsp->trial_vrtypes;
+  pwcp->fwrite_bufp = scratch;
+  for (uint32_t widx = cand_widx; widx <= window_len; ++widx) {
+    if (S_CAST(uintptr_t, pwcp->fwrite_bufp - scratch) >= byte_limit) {
+      return byte_limit;
+    }
+    const uintptr_t* cur_genovec = (widx == window_len)? genovec : slot_genovecs[widx];
+    const uint32_t trial_idx = widx - cand_widx;
+    trial_vrec_lens[trial_idx] = AppendBiallelicGenovecMainInternal(cur_genovec, first_window_vidx + widx, (widx != cand_widx), pwcp, nullptr, nullptr, &(trial_vrtypes[trial_idx]));
+  }
+  const uintptr_t byte_ct = pwcp->fwrite_bufp - scratch;
+  return MINV(byte_ct, byte_limit);
+}
+
+// The .pgen format only permits LD compression against the most recent
+// non-LD-compressed variant in the same variant block, so a writer can't point
+// at an arbitrary earlier variant.  What it *can* do is pick which variants
+// become LD bases, and the default greedy rule (keep the current base until a
+// variant can't be LD-compressed against it) tends to keep each base for too
+// long when LD decays gradually.  So, when variant vidx has just started a new
+// base, we consider each variant that was LD-compressed against the previous
+// base (up to window_max of them) as an alternative base, re-encode the tail
+// of the buffer under the best alternative, and keep the result if it's
+// smaller.
+static void LdSearchUpdate(const uintptr_t* __restrict genovec, unsigned char* vrec_start, uint32_t vidx, unsigned char vrtype, PgenWriterCommon* pwcp) {
+  PgenLdSearch* ldsp = pwcp->ld_search;
+  uint32_t window_len = ldsp->window_len;
+  if ((vidx != ldsp->next_vidx) || (vrec_start != ldsp->next_bufp) || (!(vidx % kPglVblockSize))) {
+    // new variant block, buffer was flushed, or a different append function
+    // was used since the last call
+    window_len = 0;
+  }
+  ldsp->next_vidx = vidx + 1;
+  ldsp->next_bufp = pwcp->fwrite_bufp;
+  const uint32_t sample_ct = pwcp->sample_ct;
+  const uint32_t genovec_word_ct = NypCtToWordCt(sample_ct);
+  uintptr_t** slot_genovecs = ldsp->slot_genovecs;
+  uintptr_t* rec_offsets = ldsp->rec_offsets;
+  unsigned char* fwrite_buf = pwcp->fwrite_buf;
+  if ((vrtype & 6) == 2) {
+    // LD-compressed against the current base; becomes a candidate.
+    if (window_len == ldsp->window_max) {
+      uintptr_t* recycled_genovec = slot_genovecs[0];
+      for (uint32_t widx = 1; widx != window_len; ++widx) {
+        slot_genovecs[widx - 1] = slot_genovecs[widx];
+        rec_offsets[widx - 1] = rec_offsets[widx];
+      }
+      --window_len;
+      slot_genovecs[window_len] = recycled_genovec;
+    }
+    memcpy(slot_genovecs[window_len], genovec, genovec_word_ct * sizeof(intptr_t));
+    rec_offsets[window_len] = vrec_start - fwrite_buf;
+    ldsp->window_len = window_len + 1;
+    return;
+  }
+  ldsp->window_len = window_len;
+  if (!window_len) {
+    return;
+  }
+  const uint32_t first_window_vidx = vidx - window_len;
+  unsigned char* orig_end = pwcp->fwrite_bufp;
+  STD_ARRAY_DECL(uint32_t, 4, orig_ldbase_genocounts);
+  STD_ARRAY_COPY(pwcp->ldbase_genocounts, 4, orig_ldbase_genocounts);
+  uint32_t best_widx = UINT32_MAX;
+  uintptr_t best_savings = 0;
+  const uint32_t max_diff_ct = sample_ct / kPglMaxDifflistLenDivisor;
+  for (uint32_t widx = 0; widx != window_len; ++widx) {
+    // cheap filter: the current variant must be LD-compressible against the
+    // candidate
+    uint32_t ld_diff_ct;
+    uint32_t ld_inv_diff_ct;
+    CountLdAndInvertedLdDiffs(slot_genovecs[widx], genovec, sample_ct, &ld_diff_ct, &ld_inv_diff_ct);
+    if ((ld_diff_ct >= max_diff_ct) && (ld_inv_diff_ct >= max_diff_ct)) {
+      continue;
+    }
+    const uintptr_t orig_byte_ct = orig_end - (&(fwrite_buf[rec_offsets[widx]]));
+    const uintptr_t trial_byte_ct = LdSearchTrial(genovec, first_window_vidx, widx, orig_byte_ct - best_savings, pwcp);
+    if (trial_byte_ct + best_savings < orig_byte_ct) {
+      best_savings = orig_byte_ct - trial_byte_ct;
+      best_widx = widx;
+    }
+  }
+  if (best_widx == UINT32_MAX) {
+    // no improvement; restore state as of the end of the original encoding
+    pwcp->fwrite_bufp = orig_end;
+    STD_ARRAY_COPY(orig_ldbase_genocounts, 4, pwcp->ldbase_genocounts);
+    memcpy(pwcp->ldbase_genovec, genovec, genovec_word_ct * sizeof(intptr_t));
+    pwcp->ldbase_common_geno = UINT32_MAX;
+    ldsp->window_len = 0;
+    return;
+  }
+  unsigned char* trial_start = &(fwrite_buf[rec_offsets[best_widx]]);
+  const uintptr_t trial_byte_ct = LdSearchTrial(genovec, first_window_vidx, best_widx, ~k0LU, pwcp);
+  memcpy(trial_start, ldsp->scratch, trial_byte_ct);
+  pwcp->fwrite_bufp = &(trial_start[trial_byte_ct]);
+  ldsp->next_bufp = pwcp->fwrite_bufp;
+  // Variants LD-compressed against the final base of the new encoding form
+  // the next window.
+  const uint32_t* trial_vrec_lens = ldsp->trial_vrec_lens;
+  const unsigned char* trial_vrtypes = ldsp->trial_vrtypes;
+  const uint32_t trial_ct = window_len + 1 - best_widx;
+  const uint32_t first_trial_vidx = first_window_vidx + best_widx;
+  uint32_t new_window_start = 0;
+  for (uint32_t uii = 0; uii != trial_ct; ++uii) {
+    PwcSetVrecLenAndType(first_trial_vidx + uii, trial_vrec_lens[uii], trial_vrtypes[uii], pwcp);
+    if ((trial_vrtypes[uii] & 6) != 2) {
+      new_window_start = uii + 1;
+    }
+  }
+  uintptr_t cur_rec_offset = trial_start - fwrite_buf;
+  for (uint32_t uii = 0; uii != new_window_start; ++uii) {
+    cur_rec_offset += trial_vrec_lens[uii];
+  }
+  uint32_t new_window_len = 0;
+  for (uint32_t uii = new_window_start; uii != trial_ct; ++uii) {
+    const uint32_t widx = best_widx + uii;
+    if (widx == window_len) {
+      memcpy(slot_genovecs[new_window_len], genovec, genovec_word_ct * sizeof(intptr_t));
+    } else {
+      uintptr_t* tmp_genovec = slot_genovecs[new_window_len];
+      slot_genovecs[new_window_len] = slot_genovecs[widx];
+      slot_genovecs[widx] = tmp_genovec;
+    }
+    rec_offsets[new_window_len] = cur_rec_offset;
+    cur_rec_offset += trial_vrec_lens[uii];
+    ++new_window_len;
+  }
+  ldsp->window_len = new_window_len;
+}
+
 void PwcAppendBiallelicGenovec(const uintptr_t* __restrict genovec, PgenWriterCommon* pwcp) {
   const uint32_t vidx = pwcp->vidx;
+  unsigned char* vrec_start = pwcp->fwrite_bufp;
   unsigned char vrtype;
   const uint32_t vrec_len = PwcAppendBiallelicGenovecMain(genovec, vidx, pwcp, nullptr, nullptr, &vrtype);
   const uintptr_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
@@ -937,6 +1491,182 @@ void PwcAppendBiallelicGenovec(const uintptr_t* __restrict genovec, PgenWriterCo
   } else {
     R_CAST(unsigned char*, pwcp->vrtype_buf)[vidx] = vrtype;
   }
+  if (pwcp->ld_search) {
+    LdSearchUpdate(genovec, vrec_start, vidx, vrtype, pwcp);
+  }
+}
+
+#ifndef NO_PGEN_ZSTD
+struct PgenZstdWriterStruct {
+  ZSTD_CCtx* cctx;
+  // zframe_ct + 1 entries; see {4c} in pgenlib_misc.h.
+  uint64_t* zframe_fpos;
+  unsigned char* out_buf;
+  uintptr_t out_buf_size;
+  uint64_t table_fpos;
+  // Logical (decompressed-stream) position of the next record byte, and
+  // physical position of the next compressed byte.
+  uint64_t lfpos;
+  uint64_t pfpos;
+  // Logical bounds of the current frame.  frame_lend is UINT64_MAX until all
+  // of the frame's record lengths are known.
+  uint64_t frame_lstart;
+  uint64_t frame_lend;
+  uint32_t zframe_ct;
+  uint32_t frame_idx;
+};
+
+PglErr PwcEnableZstd(int32_t level, uint32_t thread_ct, PgenWriterCommon* pwcp, FILE* pgen_outfile) {
+  if (unlikely(pwcp->vidx || pwcp->zw)) {
+    return kPglRetImproperFunctionCall;
+  }
+  const uint32_t zframe_ct = DivUp(pwcp->variant_ct, kPglZframeSize);
+  const uintptr_t table_byte_ct = (zframe_ct + 1) * sizeof(int64_t);
+  const uintptr_t out_buf_size = ZSTD_CStreamOutSize();
+  PgenZstdWriter* zwp = S_CAST(PgenZstdWriter*, malloc(RoundUpPow2(sizeof(PgenZstdWriter), kCacheline) + RoundUpPow2(table_byte_ct, kCacheline) + out_buf_size));
+  if (unlikely(!zwp)) {
+    return kPglRetNomem;
+  }
+  unsigned char* alloc_iter = &(R_CAST(unsigned char*, zwp)[RoundUpPow2(sizeof(PgenZstdWriter), kCacheline)]);
+  zwp->zframe_fpos = R_CAST(uint64_t*, alloc_iter);
+  alloc_iter = &(alloc_iter[RoundUpPow2(table_byte_ct, kCacheline)]);
+  zwp->out_buf = alloc_iter;
+  zwp->out_buf_size = out_buf_size;
+  zwp->cctx = ZSTD_createCCtx();
+  if (unlikely(!zwp->cctx)) {
+    free(zwp);
+    return kPglRetNomem;
+  }
+  if (unlikely(ZSTD_isError(ZSTD_CCtx_setParameter(zwp->cctx, ZSTD_c_compressionLevel, level)))) {
+    ZSTD_freeCCtx(zwp->cctx);
+    free(zwp);
+    return kPglRetImproperFunctionCall;
+  }
+#ifdef ZSTD_MULTITHREAD
+  if (thread_ct > 1) {
+    // Failure is harmless; we just compress in the foreground.
+    ZSTD_CCtx_setParameter(zwp->cctx, ZSTD_c_nbWorkers, thread_ct);
+  }
+#else
+  (void)thread_ct;
+#endif
+  pwcp->zw = zwp;
+  // Patch the storage mode byte, and reserve space for the frame offset
+  // table; it's filled in by PwcFinish().
+  const uint64_t table_fpos = pwcp->vblock_fpos_offset;
+  ZeroU64Arr(zframe_ct + 1, zwp->zframe_fpos);
+  if (unlikely(fseeko(pgen_outfile, 2, SEEK_SET) ||
+               (putc_unlocked(0x12, pgen_outfile) == EOF) ||
+               fseeko(pgen_outfile, 0, SEEK_END))) {
+    return kPglRetWriteFail;
+  }
+  if (unlikely(S_CAST(uint64_t, ftello(pgen_outfile)) != table_fpos)) {
+    return kPglRetImproperFunctionCall;
+  }
+  if (unlikely(fwrite_checked(zwp->zframe_fpos, table_byte_ct, pgen_outfile))) {
+    return kPglRetWriteFail;
+  }
+  zwp->table_fpos = table_fpos;
+  const uint64_t first_frame_fpos = table_fpos + table_byte_ct;
+  zwp->zframe_fpos[0] = first_frame_fpos;
+  zwp->lfpos = first_frame_fpos;
+  zwp->pfpos = first_frame_fpos;
+  zwp->frame_lstart = first_frame_fpos;
+  zwp->frame_lend = UINT64_MAX;
+  zwp->zframe_ct = zframe_ct;
+  zwp->frame_idx = 0;
+  pwcp->vblock_fpos_offset = first_frame_fpos;
+  return kPglRetSuccess;
+}
+
+static void CleanupPwcZstd(PgenWriterCommon* pwcp) {
+  PgenZstdWriter* zwp = pwcp->zw;
+  if (zwp) {
+    ZSTD_freeCCtx(zwp->cctx);
+    free(zwp);
+    pwcp->zw = nullptr;
+  }
+}
+
+static BoolErr PwcZstdCompress(const unsigned char* src, uintptr_t byte_ct, ZSTD_EndDirective mode, PgenZstdWriter* zwp, FILE* pgen_outfile) {
+  ZSTD_inBuffer zib = {src, byte_ct, 0};
+  while (1) {
+    ZSTD_outBuffer zob = {zwp->out_buf, zwp->out_buf_size, 0};
+    const uintptr_t remaining = ZSTD_compressStream2(zwp->cctx, &zob, &zib, mode);
+    if (unlikely(ZSTD_isError(remaining))) {
+      return 1;
+    }
+    if (zob.pos) {
+      if (unlikely(fwrite_checked(zwp->out_buf, zob.pos, pgen_outfile))) {
+        return 1;
+      }
+      zwp->pfpos += zob.pos;
+    }
+    if (mode == ZSTD_e_end) {
+      if (!remaining) {
+        return 0;
+      }
+    } else if (zib.pos == zib.size) {
+      return 0;
+    }
+  }
+}
+
+// Appends byte_ct bytes of variant records to the compressed stream.  All
+// variants before vidx_end must have their final record lengths in
+// vrec_len_buf; this is what lets us close frames at the right spots.
+static BoolErr PwcZstdWrite(const unsigned char* src, uintptr_t byte_ct, uint32_t vidx_end, PgenWriterCommon* pwcp, FILE* pgen_outfile) {
+  PgenZstdWriter* zwp = pwcp->zw;
+  const uint32_t zframe_ct = zwp->zframe_ct;
+  while (1) {
+    if ((zwp->frame_lend == UINT64_MAX) && (zwp->frame_idx != zframe_ct)) {
+      const uint32_t frame_vidx_start = zwp->frame_idx * kPglZframeSize;
+      const uint32_t frame_vidx_end = MINV(frame_vidx_start + kPglZframeSize, pwcp->variant_ct);
+      if (vidx_end >= frame_vidx_end) {
+        const unsigned char* vrec_len_buf = pwcp->vrec_len_buf;
+        const uint32_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
+        uint64_t frame_lend = zwp->frame_lstart;
+        for (uint32_t vidx = frame_vidx_start; vidx != frame_vidx_end; ++vidx) {
+          frame_lend += SubU32Load(&(vrec_len_buf[vidx * S_CAST(uintptr_t, vrec_len_byte_ct)]), vrec_len_byte_ct);
+        }
+        zwp->frame_lend = frame_lend;
+      }
+    }
+    if (zwp->lfpos == zwp->frame_lend) {
+      if (unlikely(PwcZstdCompress(nullptr, 0, ZSTD_e_end, zwp, pgen_outfile))) {
+        return 1;
+      }
+      zwp->frame_idx += 1;
+      zwp->zframe_fpos[zwp->frame_idx] = zwp->pfpos;
+      zwp->frame_lstart = zwp->lfpos;
+      zwp->frame_lend = UINT64_MAX;
+      continue;
+    }
+    if (!byte_ct) {
+      return 0;
+    }
+    assert(zwp->frame_idx != zframe_ct);
+    uintptr_t cur_byte_ct = byte_ct;
+    if (zwp->frame_lend != UINT64_MAX) {
+      cur_byte_ct = MINV(cur_byte_ct, zwp->frame_lend - zwp->lfpos);
+    }
+    if (unlikely(PwcZstdCompress(src, cur_byte_ct, ZSTD_e_continue, zwp, pgen_outfile))) {
+      return 1;
+    }
+    src = &(src[cur_byte_ct]);
+    byte_ct -= cur_byte_ct;
+    zwp->lfpos += cur_byte_ct;
+  }
+}
+#endif
+
+static inline BoolErr PwcWriteRecords(const unsigned char* src, uintptr_t byte_ct, __maybe_unused uint32_t vidx_end, __maybe_unused PgenWriterCommon* pwcp, FILE* pgen_outfile) {
+#ifndef NO_PGEN_ZSTD
+  if (pwcp->zw) {
+    return PwcZstdWrite(src, byte_ct, vidx_end, pwcp, pgen_outfile);
+  }
+#endif
+  return fwrite_checked(src, byte_ct, pgen_outfile);
 }
 
 BoolErr SpgwFlush(STPgenWriter* spgwp) {
@@ -944,7 +1674,7 @@ BoolErr SpgwFlush(STPgenWriter* spgwp) {
   if (pwcp->fwrite_bufp >= &(pwcp->fwrite_buf[kPglFwriteBlockSize])) {
     const uintptr_t cur_byte_ct = pwcp->fwrite_bufp - pwcp->fwrite_buf;
     FILE** pgen_outfilep = GetPgenOutfilep(spgwp);
-    if (unlikely(fwrite_checked(pwcp->fwrite_buf, cur_byte_ct, *pgen_outfilep))) {
+    if (unlikely(PwcWriteRecords(pwcp->fwrite_buf, cur_byte_ct, pwcp->vidx, pwcp, *pgen_outfilep))) {
       return 1;
     }
     pwcp->vblock_fpos_offset += cur_byte_ct;
@@ -1104,6 +1834,9 @@ uint32_t PwcAppendBiallelicDifflistLimitedMain(const uintptr_t* __restrict rareg
   GenoarrCountFreqsUnsafe(raregeno, difflist_len, genocounts);
   assert(!genocounts[difflist_common_geno]);
   genocounts[difflist_common_geno] = sample_ct - difflist_len;
+  if (pwcp->vsums) {
+    InitVariantSummary(genocounts, &(pwcp->vsums[vidx]));
+  }
   uint32_t second_most_common_geno = difflist_common_geno? 0 : 1;
   uint32_t second_largest_geno_ct = genocounts[second_most_common_geno];
   for (uint32_t cur_geno = second_most_common_geno + 1; cur_geno != 4; ++cur_geno) {
@@ -1127,7 +1860,7 @@ uint32_t PwcAppendBiallelicDifflistLimitedMain(const uintptr_t* __restrict rareg
   STD_ARRAY_REF(uint32_t, 4) ldbase_genocounts = pwcp->ldbase_genocounts;
   if (!(vidx % kPglVblockSize)) {
     pwcp->vblock_fpos[vidx / kPglVblockSize] = pwcp->vblock_fpos_offset + S_CAST(uintptr_t, pwcp->fwrite_bufp - pwcp->fwrite_buf);
-  } else if (difflist_len > sample_ctd64) {
+  } else if ((difflist_len > sample_ctd64) && (vidx != pwcp->append_vidx_start)) {
     const uint32_t ld_diff_threshold = difflist_viable? (difflist_len - sample_ctd64) : max_difflist_len;
     // number of changes between current genovec and LD reference is bounded
     // below by sum(genocounts[x] - ldbase_genocounts[x]) / 2
@@ -2045,6 +2778,9 @@ void PwcAppendBiallelicGenovecHphase(const uintptr_t* __restrict genovec, const
   const uint32_t phasepresent_ct = phasepresent? PopcountWords(phasepresent, sample_ctl) : het_ct;
   if (phasepresent_ct) {
     AppendHphase(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pwcp, vrtype_dest, &vrec_len);
+    if (pwcp->vsums) {
+      pwcp->vsums[vidx].phased_het_ct = phasepresent_ct;
+    }
   }
   SubU32Store(vrec_len, vrec_len_byte_ct, vrec_len_dest);
 }
@@ -2067,6 +2803,9 @@ BoolErr PwcAppendMultiallelicGenovecHphase(const uintptr_t* __restrict genovec,
     if (unlikely(AppendHphase(genovec_hets, phasepresent, phaseinfo, het_ct, phasepresent_ct, pwcp, vrtype_dest, &vrec_len))) {
       return 1;
     }
+    if (pwcp->vsums) {
+      pwcp->vsums[vidx].phased_het_ct = phasepresent_ct;
+    }
   }
   pwcp->vidx += 1;
   const uintptr_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
@@ -2074,6 +2813,37 @@ BoolErr PwcAppendMultiallelicGenovecHphase(const uintptr_t* __restrict genovec,
   return 0;
 }
 
+// Replaces the hardcall-based dosage sums initialized by
+// InitVariantSummary(), mirroring GetBasicGenotypeCountsAndDosage16s().
+// dosage_main may contain 65535 (missing) values in the fixed-width case.
+static void UpdateVariantSummaryDosage(const uintptr_t* __restrict genovec, const uintptr_t* __restrict dosage_present, const uint16_t* dosage_main, uint32_t sample_ct, uint32_t dosage_ct, PgenVariantSummary* vsump) {
+  uint64_t alt1_dosage = 0;
+  uint32_t dosage_nm_ct = 0;
+  uint32_t replaced_nm_ct = 0;
+  uint32_t replaced_alt1_ct = 0;
+  uintptr_t sample_uidx_base = 0;
+  uintptr_t dosage_present_bits = dosage_present[0];
+  for (uint32_t dosage_idx = 0; dosage_idx != dosage_ct; ++dosage_idx) {
+    const uintptr_t sample_uidx = BitIter1(dosage_present, &sample_uidx_base, &dosage_present_bits);
+    const uint32_t hardcall_code = GetNyparrEntry(genovec, sample_uidx);
+    if (hardcall_code != 3) {
+      ++replaced_nm_ct;
+      replaced_alt1_ct += hardcall_code;
+    }
+    const uint32_t cur_dosage_val = dosage_main[dosage_idx];
+    if (cur_dosage_val != 65535) {
+      alt1_dosage += cur_dosage_val;
+      ++dosage_nm_ct;
+    }
+  }
+  const uint32_t* geno_cts = vsump->geno_cts;
+  alt1_dosage += (2 * geno_cts[2] + geno_cts[1] - replaced_alt1_ct) * 16384LLU;
+  const uint32_t nm_ct = dosage_nm_ct + sample_ct - geno_cts[3] - replaced_nm_ct;
+  vsump->dosage_sums[0] = nm_ct * 32768LLU - alt1_dosage;
+  vsump->dosage_sums[1] = alt1_dosage;
+  vsump->dosage_ct = dosage_ct;
+}
+
 // ok if dosage_present trailing bits set
 BoolErr AppendDosage16(const uintptr_t* __restrict dosage_present, const uint16_t* dosage_main, uint32_t dosage_ct, uint32_t dphase_ct, PgenWriterCommon* pwcp, unsigned char* vrtype_ptr, uint32_t* vrec_len_ptr) {
   const uint32_t sample_ct = pwcp->sample_ct;
@@ -2110,6 +2880,7 @@ BoolErr AppendDosage16(const uintptr_t* __restrict dosage_present, const uint16_
 BoolErr PwcAppendBiallelicGenovecDosage16(const uintptr_t* __restrict genovec, const uintptr_t* __restrict dosage_present, const uint16_t* dosage_main, uint32_t dosage_ct, PgenWriterCommon* pwcp) {
   // safe to call this even when entire file has no phase/dosage info
   const uint32_t vidx = pwcp->vidx;
+  unsigned char* vrec_start = pwcp->fwrite_bufp;
   unsigned char vrtype;
   uint32_t vrec_len = PwcAppendBiallelicGenovecMain(genovec, vidx, pwcp, nullptr, nullptr, &vrtype);
   const uintptr_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
@@ -2119,6 +2890,9 @@ BoolErr PwcAppendBiallelicGenovecDosage16(const uintptr_t* __restrict genovec, c
     if (unlikely(AppendDosage16(dosage_present, dosage_main, dosage_ct, 0, pwcp, &vrtype, &vrec_len))) {
       return 1;
     }
+    if (pwcp->vsums) {
+      UpdateVariantSummaryDosage(genovec, dosage_present, dosage_main, pwcp->sample_ct, dosage_ct, &(pwcp->vsums[vidx]));
+    }
   }
   SubU32Store(vrec_len, vrec_len_byte_ct, vrec_len_dest);
   if (!pwcp->phase_dosage_gflags) {
@@ -2126,6 +2900,9 @@ BoolErr PwcAppendBiallelicGenovecDosage16(const uintptr_t* __restrict genovec, c
   } else {
     R_CAST(unsigned char*, pwcp->vrtype_buf)[vidx] = vrtype;
   }
+  if ((!dosage_ct) && pwcp->ld_search) {
+    LdSearchUpdate(genovec, vrec_start, vidx, vrtype, pwcp);
+  }
   return 0;
 }
 
@@ -2148,11 +2925,17 @@ BoolErr PwcAppendBiallelicGenovecHphaseDosage16(const uintptr_t* __restrict geno
   const uint32_t phasepresent_ct = phasepresent? PopcountWords(phasepresent, sample_ctl) : het_ct;
   if (phasepresent_ct) {
     AppendHphase(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pwcp, vrtype_dest, &vrec_len);
+    if (pwcp->vsums) {
+      pwcp->vsums[vidx].phased_het_ct = phasepresent_ct;
+    }
   }
   if (dosage_ct) {
     if (unlikely(AppendDosage16(dosage_present, dosage_main, dosage_ct, 0, pwcp, vrtype_dest, &vrec_len))) {
       return 1;
     }
+    if (pwcp->vsums) {
+      UpdateVariantSummaryDosage(genovec, dosage_present, dosage_main, pwcp->sample_ct, dosage_ct, &(pwcp->vsums[vidx]));
+    }
   }
   SubU32Store(vrec_len, vrec_len_byte_ct, vrec_len_dest);
   return 0;
@@ -2194,11 +2977,17 @@ BoolErr PwcAppendBiallelicGenovecDphase16(const uintptr_t* __restrict genovec, c
   const uint32_t phasepresent_ct = phasepresent? PopcountWords(phasepresent, sample_ctl) : het_ct;
   if (phasepresent_ct) {
     AppendHphase(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pwcp, vrtype_dest, &vrec_len);
+    if (pwcp->vsums) {
+      pwcp->vsums[vidx].phased_het_ct = phasepresent_ct;
+    }
   }
   if (dosage_ct) {
     if (unlikely(AppendDosage16(dosage_present, dosage_main, dosage_ct, dphase_ct, pwcp, vrtype_dest, &vrec_len))) {
       return 1;
     }
+    if (pwcp->vsums) {
+      UpdateVariantSummaryDosage(genovec, dosage_present, dosage_main, pwcp->sample_ct, dosage_ct, &(pwcp->vsums[vidx]));
+    }
     if (dphase_ct) {
       if (unlikely(AppendDphase16(dosage_present, dphase_present, dphase_delta, dosage_ct, dphase_ct, pwcp, vrtype_dest, &vrec_len))) {
         return 1;
@@ -2209,10 +2998,73 @@ BoolErr PwcAppendBiallelicGenovecDphase16(const uintptr_t* __restrict genovec, c
   return 0;
 }
 
+// Closes the .pgen, then writes the .vsum sidecar.
+static PglErr PwcFinishVariantSummary(const PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
+  // The .pgen's size and mtime must be final before they're recorded.
+  FILE* pgen_outfile = *pgen_outfile_ptr;
+  struct stat statbuf;
+  if (unlikely(fflush(pgen_outfile) || fstat(fileno(pgen_outfile), &statbuf))) {
+    fclose_null(pgen_outfile_ptr);
+    return kPglRetWriteFail;
+  }
+  if (unlikely(fclose_null(pgen_outfile_ptr))) {
+    return kPglRetWriteFail;
+  }
+  const uint32_t variant_ct = pwcp->variant_ct;
+  PgenVsumHeader header;
+  memset(&header, 0, sizeof(PgenVsumHeader));
+  memcpy(header.magic, "l\x1bV\x01", 4);
+  header.variant_ct = variant_ct;
+  header.sample_ct = pwcp->sample_ct;
+  header.record_byte_ct = sizeof(PgenVariantSummary);
+  header.pgen_fsize = statbuf.st_size;
+  header.pgen_mtime = statbuf.st_mtime;
+  header.vblock_fpos_hash = PglVsumHashVblockFpos(pwcp->vblock_fpos, DivUp(variant_ct, kPglVblockSize), kPglVsumHashSeed);
+  FILE* vsum_outfile = fopen(pwcp->vsum_fname, FOPEN_WB);
+  if (unlikely(!vsum_outfile)) {
+    return kPglRetOpenFail;
+  }
+  if (unlikely(fwrite_checked(&header, sizeof(PgenVsumHeader), vsum_outfile) ||
+               fwrite_checked(pwcp->vsums, variant_ct * S_CAST(uintptr_t, sizeof(PgenVariantSummary)), vsum_outfile))) {
+    fclose(vsum_outfile);
+    return kPglRetWriteFail;
+  }
+  return fclose_null(&vsum_outfile)? kPglRetWriteFail : kPglRetSuccess;
+}
+
+// Completes an append by renaming the rebuilt file over the original, once
+// it's entirely on disk.
+static PglErr PwcFinishAppend(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
+  char* fname = pwcp->append_fname;
+  const char* tmp_fname = &(fname[strlen(fname) + 1]);
+  PglErr reterr = kPglRetSuccess;
+  if (unlikely(PwcSyncFile(*pgen_outfile_ptr) || fclose_null(pgen_outfile_ptr) || rename(tmp_fname, fname))) {
+    if (*pgen_outfile_ptr) {
+      fclose_null(pgen_outfile_ptr);
+    }
+    remove(tmp_fname);
+    reterr = kPglRetWriteFail;
+  }
+  free(fname);
+  pwcp->append_fname = nullptr;
+  return reterr;
+}
+
 PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
   const uint32_t variant_ct = pwcp->variant_ct;
   assert(pwcp->vidx == variant_ct);
   FILE* pgen_outfile = *pgen_outfile_ptr;
+#ifndef NO_PGEN_ZSTD
+  PgenZstdWriter* zwp = pwcp->zw;
+  if (zwp) {
+    assert(zwp->frame_idx == zwp->zframe_ct);
+    if (unlikely(fseeko(pgen_outfile, zwp->table_fpos, SEEK_SET) ||
+                 fwrite_checked(zwp->zframe_fpos, (zwp->zframe_ct + 1) * sizeof(int64_t), pgen_outfile))) {
+      return kPglRetWriteFail;
+    }
+    CleanupPwcZstd(pwcp);
+  }
+#endif
   if (unlikely(fseeko(pgen_outfile, 12, SEEK_SET))) {
     return kPglRetWriteFail;
   }
@@ -2231,6 +3083,12 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
   for (; ; vrec_len_buf_iter = &(vrec_len_buf_iter[vrec_iter_incr])) {
     if (vrec_len_buf_iter >= vrec_len_buf_last) {
       if (vrec_len_buf_iter > vrec_len_buf_last) {
+        if (pwcp->append_vidx_start) {
+          return PwcFinishAppend(pwcp, pgen_outfile_ptr);
+        }
+        if (pwcp->vsums) {
+          return PwcFinishVariantSummary(pwcp, pgen_outfile_ptr);
+        }
         return fclose_null(pgen_outfile_ptr)? kPglRetWriteFail : kPglRetSuccess;
       }
       const uint32_t vblock_size = ModNz(variant_ct, kPglVblockSize);
@@ -2263,7 +3121,7 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
 PglErr SpgwFinish(STPgenWriter* spgwp) {
   PgenWriterCommon* pwcp = GetPwcp(spgwp);
   FILE** pgen_outfilep = GetPgenOutfilep(spgwp);
-  if (unlikely(fwrite_checked(pwcp->fwrite_buf, pwcp->fwrite_bufp - pwcp->fwrite_buf, *pgen_outfilep))) {
+  if (unlikely(PwcWriteRecords(pwcp->fwrite_buf, pwcp->fwrite_bufp - pwcp->fwrite_buf, pwcp->vidx, pwcp, *pgen_outfilep))) {
     return kPglRetWriteFail;
   }
   return PwcFinish(pwcp, pgen_outfilep);
@@ -2281,12 +3139,18 @@ PglErr MpgwFlush(MTPgenWriter* mpgwp) {
   uint64_t* vblock_fpos = pwcp->vblock_fpos;
   FILE* pgen_outfile = mpgwp->pgen_outfile;
   const uint32_t vidx_incr = (thread_ct - 1) * kPglVblockSize;
+#ifdef NO_PGEN_ZSTD
   uint64_t cur_vblock_fpos = ftello(pgen_outfile);
+#else
+  // vblock_fpos values refer to the decompressed stream in mode 0x12.
+  uint64_t cur_vblock_fpos = pwcp->zw? pwcp->zw->lfpos : ftello(pgen_outfile);
+#endif
   for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
     vblock_fpos[(vidx / kPglVblockSize) + tidx] = cur_vblock_fpos;
     PgenWriterCommon* cur_pwcp = mpgwp->pwcs[tidx];
     uintptr_t cur_vblock_byte_ct = cur_pwcp->fwrite_bufp - cur_pwcp->fwrite_buf;
-    if (unlikely(fwrite_checked(cur_pwcp->fwrite_buf, cur_vblock_byte_ct, pgen_outfile))) {
+    const uint32_t vblock_vidx_end = MINV(vidx + (tidx + 1) * kPglVblockSize, variant_ct);
+    if (unlikely(PwcWriteRecords(cur_pwcp->fwrite_buf, cur_vblock_byte_ct, vblock_vidx_end, pwcp, pgen_outfile))) {
       return kPglRetWriteFail;
     }
     cur_pwcp->vidx += vidx_incr;
@@ -2307,6 +3171,23 @@ BoolErr CleanupSpgw(STPgenWriter* spgwp, PglErr* reterrp) {
   if (!(*pgen_outfilep)) {
     return 0;
   }
+  PgenWriterCommon* pwcp = GetPwcp(spgwp);
+#ifndef NO_PGEN_ZSTD
+  CleanupPwcZstd(pwcp);
+#endif
+  if (pwcp->append_fname) {
+    // Abandoned append.  The original .pgen was never written to, so all
+    // that's left is removing the partial <fname>.tmp.
+    if (pwcp->append_tmp_active) {
+      fclose_null(pgen_outfilep);
+      remove(&(pwcp->append_fname[strlen(pwcp->append_fname) + 1]));
+    }
+    free(pwcp->append_fname);
+    pwcp->append_fname = nullptr;
+    if (!(*pgen_outfilep)) {
+      return 0;
+    }
+  }
   if (!fclose_null(pgen_outfilep)) {
     return 0;
   }
@@ -2321,6 +3202,9 @@ BoolErr CleanupMpgw(MTPgenWriter* mpgwp, PglErr* reterrp) {
   if ((!mpgwp) || (!mpgwp->pgen_outfile)) {
     return 0;
   }
+#ifndef NO_PGEN_ZSTD
+  CleanupPwcZstd(mpgwp->pwcs[0]);
+#endif
   if (!fclose_null(&(mpgwp->pgen_outfile))) {
     return 0;
   }
@@ -26,6 +26,25 @@
 namespace plink2 {
 #endif
 
+// State for PwcAppendBiallelicGenovec()'s optional multi-candidate LD-base
+// search; see SpgwEnableLdSearch().
+typedef struct PgenLdSearchStruct {
+  // window_max + 1 genovec slots; the first window_len are the variants
+  // immediately preceding next_vidx, all LD-compressed against the current
+  // base.
+  uintptr_t** slot_genovecs;
+  uintptr_t* rec_offsets;  // relative to fwrite_buf
+  uint32_t* trial_vrec_lens;
+  unsigned char* trial_vrtypes;
+  unsigned char* scratch;
+  unsigned char* next_bufp;
+  uint32_t window_max;
+  uint32_t window_len;
+  uint32_t next_vidx;
+} PgenLdSearch;
+
+typedef struct PgenZstdWriterStruct PgenZstdWriter;
+
 typedef struct PgenWriterCommonStruct {
   // was marked noncopyable, but, well, gcc 9 caught me cheating (memcpying the
   // whole struct) in the multithreaded writer implementation.  So, copyable
@@ -42,6 +61,18 @@ typedef struct PgenWriterCommonStruct {
   const uintptr_t* allele_idx_offsets;
   uintptr_t* explicit_nonref_flags;  // usually nullptr
 
+  // optional .vsum sidecar output (see SpgwEnableVariantSummary()); vsums
+  // must have variant_ct entries
+  PgenVariantSummary* vsums;
+  const char* vsum_fname;
+
+  // optional; see SpgwEnableLdSearch()
+  PgenLdSearch* ld_search;
+
+  // optional; see SpgwEnableZstd().  Only the first PgenWriterCommon of a
+  // multithreaded writer uses this.
+  PgenZstdWriter* zw;
+
   // needed for multiallelic-phased case
   uintptr_t* genovec_hets_buf;
 
@@ -72,6 +103,17 @@ typedef struct PgenWriterCommonStruct {
   uintptr_t vrec_len_byte_ct;
 
   uint32_t vidx;
+
+  // Index of the first variant written in this session; nonzero only in
+  // append mode.  LD compression against earlier variants is prohibited since
+  // the previous session's LD base isn't known.
+  uint32_t append_vidx_start;
+
+  // Append mode only.  append_fname is a malloc'd "<fname>\0<fname>.tmp"
+  // pair; append_tmp_active is set once the output file is <fname>.tmp, which
+  // SpgwFinish() renames over the original.
+  char* append_fname;
+  uint32_t append_tmp_active;
 } PgenWriterCommon;
 
 // Given packed arrays of unphased biallelic genotypes in uncompressed plink2
@@ -151,6 +193,38 @@ PglErr SpgwInitPhase1(const char* __restrict fname, const uintptr_t* __restrict
 
 void SpgwInitPhase2(uint32_t max_vrec_len, STPgenWriter* spgwp, unsigned char* spgw_alloc);
 
+// Append mode: reopens fname, which must be a finished storage-mode-0x10
+// .pgen with sample_ct samples and the same nonref_flags_storage value, to
+// write append_variant_ct more variants after the existing ones.
+// *prev_variant_ct_ptr is set to the number of variants already present, and
+// allele_idx_offsets/explicit_nonref_flags are indexed by absolute variant
+// index (so they must cover prev_variant_ct + append_variant_ct variants).
+// The existing variants' nonref flags are filled in by
+// SpgwInitPhase2Append().
+// The original .pgen is opened read-only and never modified: the new file is
+// built as <fname>.tmp (overwriting any stale copy) and renamed over the
+// original at the end of SpgwFinish(), after it has been synced.  If the
+// session is abandoned or killed at any point, the original is intact;
+// CleanupSpgw() removes <fname>.tmp.
+// Existing variant records keep their offsets unless the larger header doesn't
+// fit in front of them; in that case, enough slack is left for the variant
+// count to double before they need to be moved again.  The existing records
+// are copied with copy_file_range() where available, so on filesystems with
+// reflink support (btrfs, XFS, etc.) the cost of an append is still roughly
+// proportional to the number of appended variants plus the header; elsewhere,
+// it includes an in-kernel copy of the existing file.
+// Bytes after the last record described by the header (e.g. left by an
+// interrupted append) are discarded.
+// Returns kPglRetNotYetSupported for other storage modes and
+// kPglRetInconsistentInput on sample count or nonref_flags_storage mismatch.
+// Variant summaries (SpgwEnableVariantSummary()) and zstd compression are not
+// supported in append mode.
+PglErr SpgwInitPhase1Append(const char* __restrict fname, const uintptr_t* __restrict allele_idx_offsets, uintptr_t* __restrict explicit_nonref_flags, uint32_t append_variant_ct, uint32_t sample_ct, uint32_t optional_max_allele_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t nonref_flags_storage, STPgenWriter* spgwp, uintptr_t* alloc_cacheline_ct_ptr, uint32_t* max_vrec_len_ptr, uint32_t* prev_variant_ct_ptr);
+
+// Loads the existing header tables, and copies the existing variant records
+// into <fname>.tmp.
+PglErr SpgwInitPhase2Append(uint32_t max_vrec_len, STPgenWriter* spgwp, unsigned char* spgw_alloc);
+
 // moderately likely that there isn't enough memory to use the maximum number
 // of threads, so this returns per-thread memory requirements before forcing
 // the caller to specify thread count
@@ -309,6 +383,71 @@ HEADER_INLINE PglErr SpgwAppendBiallelicGenovecDphase16(const uintptr_t* __restr
   return kPglRetSuccess;
 }
 
+// Requests a .vsum sidecar (per-variant summary statistics; see
+// PgenVariantSummary) alongside the .pgen.  Must be called after
+// {Spgw,Mpgw}InitPhase2() and before the first variant is appended.  vsums
+// must have room for variant_ct entries, and it and vsum_fname must remain
+// valid until SpgwFinish()/the last MpgwFlush(), which writes the sidecar
+// immediately after closing the .pgen.
+HEADER_INLINE void SpgwEnableVariantSummary(const char* vsum_fname, PgenVariantSummary* vsums, STPgenWriter* spgwp) {
+  PgenWriterCommon* pwcp = &GET_PRIVATE(*spgwp, pwc);
+  pwcp->vsums = vsums;
+  pwcp->vsum_fname = vsum_fname;
+}
+
+HEADER_INLINE void MpgwEnableVariantSummary(const char* vsum_fname, PgenVariantSummary* vsums, MTPgenWriter* mpgwp) {
+  const uint32_t thread_ct = mpgwp->thread_ct;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    mpgwp->pwcs[tidx]->vsums = vsums;
+    mpgwp->pwcs[tidx]->vsum_fname = vsum_fname;
+  }
+}
+
+// Requests a wider search for LD-compression bases: whenever a hardcall-only
+// biallelic variant appended with {Spgw,Pwc}AppendBiallelicGenovec() (or
+// PwcAppendBiallelicGenovecDosage16() with dosage_ct == 0) can't be
+// LD-compressed against the current base, each of the (up to window_max)
+// preceding variants that were LD-compressed against that base is also
+// considered as a replacement base, and the recent records are re-encoded if
+// that saves space.  The output remains a standard .pgen.
+// ld_search_alloc must be cacheline-aligned with
+// PgenLdSearchCachelineCt(sample_ct, window_max) cachelines (per thread, in
+// the multithreaded case).  Must be called after {Spgw,Mpgw}InitPhase2() and
+// before the first variant is appended.
+CONSTI32(kPglLdSearchWindowDefault, 8);
+
+uintptr_t PgenLdSearchCachelineCt(uint32_t sample_ct, uint32_t window_max);
+
+void PwcInitLdSearch(uint32_t window_max, unsigned char* ld_search_alloc, PgenWriterCommon* pwcp);
+
+HEADER_INLINE void SpgwEnableLdSearch(uint32_t window_max, unsigned char* ld_search_alloc, STPgenWriter* spgwp) {
+  PgenWriterCommon* pwcp = &GET_PRIVATE(*spgwp, pwc);
+  PwcInitLdSearch(window_max, ld_search_alloc, pwcp);
+}
+
+void MpgwEnableLdSearch(uint32_t window_max, unsigned char* ld_search_alloc, MTPgenWriter* mpgwp);
+
+#ifndef NO_PGEN_ZSTD
+// Requests storage mode 0x12: variant records are zstd-compressed, in
+// independently decodable frames of kPglZframeSize variants so that random
+// access remains cheap.  level is a zstd compression level; if thread_ct > 1
+// and zstd was built with multithreading support, frames are compressed in
+// the background while later variants are being encoded.  Must be called
+// after {Spgw,Mpgw}InitPhase2() and before the first variant is appended.
+// The compressor state is malloc()ed, and freed by SpgwFinish()/the last
+// MpgwFlush() or CleanupSpgw()/CleanupMpgw().
+PglErr PwcEnableZstd(int32_t level, uint32_t thread_ct, PgenWriterCommon* pwcp, FILE* pgen_outfile);
+
+HEADER_INLINE PglErr SpgwEnableZstd(int32_t level, uint32_t thread_ct, STPgenWriter* spgwp) {
+  PgenWriterCommon* pwcp = &GET_PRIVATE(*spgwp, pwc);
+  return PwcEnableZstd(level, thread_ct, pwcp, GET_PRIVATE(*spgwp, pgen_outfile));
+}
+
+HEADER_INLINE PglErr MpgwEnableZstd(int32_t level, uint32_t thread_ct, MTPgenWriter* mpgwp) {
+  return PwcEnableZstd(level, thread_ct, mpgwp->pwcs[0], mpgwp->pgen_outfile);
+}
+#endif
+
 // Backfills header info, then closes the file.
 PglErr SpgwFinish(STPgenWriter* spgwp);
 
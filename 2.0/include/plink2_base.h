@@ -147,6 +147,13 @@
 #      if defined(__BMI__) && defined(__BMI2__) && defined(__LZCNT__)
 #        include <immintrin.h>
 #        define USE_AVX2
+#        if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+// VecW stays 256 bits wide in this build; USE_AVX512 just enables the
+// native-vector-popcount versions of the hottest counting kernels
+// (PopcountWords(), Count3FreqVec6(), CountSubset3FreqVec6(),
+// CountNypVec6()).
+#          define USE_AVX512
+#        endif
 #      else
 // Graceful downgrade, in case -march=native misfires on a VM.  See
 // https://github.com/chrchang/plink-ng/issues/155 .
@@ -1073,6 +1080,45 @@ HEADER_INLINE VecU16 vecu16_blendv(VecU16 aa, VecU16 bb, VecU16 mask) {
   return R_CAST(VecU16, _mm256_blendv_epi8(R_CAST(__m256i, aa), R_CAST(__m256i, bb), R_CAST(__m256i, mask)));
 }
 
+#    ifdef USE_AVX512
+// 512-bit vector type for the USE_AVX512 kernels.  Shifts, bitwise ops, and
+// adds go through the vector extension instead of the corresponding
+// intrinsics; gcc 12's avx512fintrin.h wrappers for the latter trigger
+// spurious -Wuninitialized warnings.
+typedef uintptr_t VecZ __attribute__ ((vector_size (64)));
+#      define VCONST_Z(xx) {xx, xx, xx, xx, xx, xx, xx, xx}
+
+HEADER_INLINE VecZ vecz_setzero() {
+  return R_CAST(VecZ, _mm512_setzero_si512());
+}
+
+HEADER_INLINE VecZ vecz_loadu(const void* mem_addr) {
+  return R_CAST(VecZ, _mm512_loadu_si512(mem_addr));
+}
+
+// Loads 32 bytes into the low half, zeroes the high half.
+HEADER_INLINE VecZ vecz_loadu_lo(const void* mem_addr) {
+  return R_CAST(VecZ, _mm512_maskz_loadu_epi64(0x0f, mem_addr));
+}
+
+// Copies an aligned VecW into both halves.
+HEADER_INLINE VecZ vecz_broadcast_vecw(const VecW* mem_addr) {
+  return R_CAST(VecZ, _mm512_maskz_broadcast_i64x4(0xff, *R_CAST(const __m256i*, mem_addr)));
+}
+
+HEADER_INLINE VecZ vecz_popcnt64(VecZ vv) {
+  return R_CAST(VecZ, _mm512_popcnt_epi64(R_CAST(__m512i, vv)));
+}
+
+// Bit (4a + 2b + c) of imm8 is the output for input bits (a, b, c); e.g. 0x80
+// is a & b & c.
+#      define vecz_ternlog(aa, bb, cc, imm8) R_CAST(VecZ, _mm512_ternarylogic_epi64(R_CAST(__m512i, aa), R_CAST(__m512i, bb), R_CAST(__m512i, cc), imm8))
+
+HEADER_INLINE uintptr_t HsumZ(VecZ vv) {
+  return vv[0] + vv[1] + vv[2] + vv[3] + vv[4] + vv[5] + vv[6] + vv[7];
+}
+#    endif
+
 #  else  // !USE_AVX2
 
 #    define VCONST_W(xx) {xx, xx}
@@ -35,6 +35,9 @@ void PreinitBgzfRawMtStream(BgzfRawMtDecompressStream* bgzfp) {
 }
 
 const char kShortErrInvalidBgzf[] = "Malformed BGZF block";
+const char kShortErrInvalidBgzfIndex[] = "Malformed tabix/CSI index";
+
+static const char kShortErrBgzfIndexDepth[] = "CSI index depth > 10 unsupported, since bin numbers would exceed 32 bits";
 
 CONSTI32(kBgzfRawMtStreamRetargetCode, 0x7fffffff);
 static_assert(kBgzfRawMtStreamRetargetCode > kMaxBgzfCompressedBlockSize, "kBgzfRawMtStreamRetargetCode must be outside the valid locked_start range.");
@@ -477,7 +480,10 @@ PglErr BgzfRawMtStreamRead(unsigned char* dst_end, BgzfRawMtDecompressStream* bg
   return BgzfReadJoinAndRespawn(dst_end, bgzfp, dst_iterp, errmsgp);
 }
 
-PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bgzfp, FILE* next_ff, const char** errmsgp) {
+// Common part of BgzfRawMtStreamRetarget() and BgzfRawMtStreamSeek().  When
+// next_ff is null, the current file is repositioned to byte coffset, which
+// must be the start of a BGZF block.
+static PglErr BgzfRawMtStreamRestart(const char* header, uint64_t coffset, BgzfRawMtDecompressStream* bgzfp, FILE* next_ff, const char** errmsgp) {
   BgzfMtReadBody* bodyp = &bgzfp->body;
   ThreadGroup* tgp = &bgzfp->tg;
   if (!bgzfp->eof) {
@@ -509,11 +515,19 @@ PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bg
   BgzfMtReadCommWithR* next_cwr = bodyp->cwr[next_producer_parity];
   next_cwr->locked_start = kBgzfRawMtStreamRetargetCode;
   if (next_ff == nullptr) {
-    rewind(bodyp->ff);
+    if (!coffset) {
+      rewind(bodyp->ff);
+    } else if (unlikely(fseeko(bodyp->ff, coffset, SEEK_SET))) {
+      return kPglRetRewindFail;
+    }
     // bugfix (8 Feb 2020): need to explicitly read the first 16 bytes.
     if (unlikely(!fread_unlocked(bodyp->in, 16, 1, bodyp->ff))) {
       return kPglRetRewindFail;
     }
+    if (unlikely(!IsBgzfHeader(bodyp->in))) {
+      *errmsgp = kShortErrInvalidBgzf;
+      return kPglRetDecompressFail;
+    }
   } else {
     // Caller is responsible for closing previous bodyp->ff, etc.
     bodyp->ff = next_ff;
@@ -526,6 +540,41 @@ PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bg
   return BgzfReadJoinAndRespawn(nullptr, bgzfp, nullptr, errmsgp);
 }
 
+PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bgzfp, FILE* next_ff, const char** errmsgp) {
+  return BgzfRawMtStreamRestart(header, 0, bgzfp, next_ff, errmsgp);
+}
+
+PglErr BgzfRawMtStreamSeek(uint64_t virtual_offset, BgzfRawMtDecompressStream* bgzfp, const char** errmsgp) {
+  PglErr reterr = BgzfRawMtStreamRestart(nullptr, virtual_offset >> 16, bgzfp, nullptr, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  const uint32_t uoffset = virtual_offset & 0xffff;
+  if (!uoffset) {
+    return kPglRetSuccess;
+  }
+  // Discard the first uoffset decompressed bytes.  This is less than one
+  // block, so no need to be clever.
+  unsigned char* discard_buf = S_CAST(unsigned char*, malloc(uoffset));
+  if (unlikely(!discard_buf)) {
+    return kPglRetNomem;
+  }
+  unsigned char* discard_end = &(discard_buf[uoffset]);
+  unsigned char* discard_iter = discard_buf;
+  do {
+    reterr = BgzfRawMtStreamRead(discard_end, bgzfp, &discard_iter, errmsgp);
+  } while ((!reterr) && (discard_iter != discard_end) && (!bgzfp->eof));
+  free(discard_buf);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (unlikely(discard_iter != discard_end)) {
+    *errmsgp = kShortErrInvalidBgzf;
+    return kPglRetDecompressFail;
+  }
+  return kPglRetSuccess;
+}
+
 void CleanupBgzfRawMtStream(BgzfRawMtDecompressStream* bgzfp) {
   uint32_t decompress_thread_ct = GetThreadCtTg(&bgzfp->tg);
   if (decompress_thread_ct) {
@@ -549,10 +598,1010 @@ void CleanupBgzfRawMtStream(BgzfRawMtDecompressStream* bgzfp) {
 }
 
 
+void PreinitBgzfIndex(BgzfIndex* bgzf_idxp) {
+  bgzf_idxp->buf = nullptr;
+  bgzf_idxp->ref_starts = nullptr;
+  bgzf_idxp->names = nullptr;
+  bgzf_idxp->ref_ct = 0;
+}
+
+// Returns nullptr if fewer than byte_ct bytes remain.  idx_iter == nullptr is
+// passed through, so a sequence of reads only needs to be checked once.
+static inline const unsigned char* IdxRead(const unsigned char* idx_iter, const unsigned char* idx_end, uint32_t byte_ct, void* dst) {
+  if ((!idx_iter) || (S_CAST(uintptr_t, idx_end - idx_iter) < byte_ct)) {
+    return nullptr;
+  }
+  memcpy(dst, idx_iter, byte_ct);
+  return &(idx_iter[byte_ct]);
+}
+
+static inline const unsigned char* IdxSkip(const unsigned char* idx_iter, const unsigned char* idx_end, uint64_t byte_ct) {
+  if ((!idx_iter) || (S_CAST(uint64_t, idx_end - idx_iter) < byte_ct)) {
+    return nullptr;
+  }
+  return &(idx_iter[byte_ct]);
+}
+
+// Loads and decompresses the entire file.  Returns kPglRetSkipped if it
+// can't be opened.
+static PglErr LoadBgzfFile(const char* fname, unsigned char** bufp, uintptr_t* buf_sizep, const char** errmsgp) {
+  unsigned char* raw_buf = nullptr;
+  struct libdeflate_decompressor* ldc = nullptr;
+  FILE* ff = fopen(fname, FOPEN_RB);
+  PglErr reterr = kPglRetSuccess;
+  {
+    if (!ff) {
+      return kPglRetSkipped;
+    }
+    if (unlikely(fseeko(ff, 0, SEEK_END))) {
+      goto LoadBgzfFile_ret_READ_FAIL;
+    }
+    const int64_t raw_size = ftello(ff);
+    if (unlikely(raw_size < 0)) {
+      goto LoadBgzfFile_ret_READ_FAIL;
+    }
+    if (unlikely((raw_size < 28) || (S_CAST(uint64_t, raw_size) > (~k0LU) / 2))) {
+      goto LoadBgzfFile_ret_INVALID;
+    }
+    rewind(ff);
+    raw_buf = S_CAST(unsigned char*, malloc(raw_size));
+    if (unlikely(!raw_buf)) {
+      goto LoadBgzfFile_ret_NOMEM;
+    }
+    if (unlikely(!fread_unlocked(raw_buf, raw_size, 1, ff))) {
+      goto LoadBgzfFile_ret_READ_FAIL;
+    }
+    // First pass: validate block boundaries and determine decompressed size.
+    uintptr_t buf_size = 0;
+    for (uintptr_t raw_pos = 0; raw_pos != S_CAST(uintptr_t, raw_size); ) {
+      const uintptr_t raw_remaining = raw_size - raw_pos;
+      if (unlikely((raw_remaining < 28) || (!IsBgzfHeader(&(raw_buf[raw_pos]))))) {
+        goto LoadBgzfFile_ret_INVALID;
+      }
+      uint16_t bsize_m1;
+      memcpy(&bsize_m1, &(raw_buf[raw_pos + 16]), 2);
+      if (unlikely((bsize_m1 < 25) || (raw_remaining <= bsize_m1))) {
+        goto LoadBgzfFile_ret_INVALID;
+      }
+      uint32_t isize;
+      memcpy(&isize, &(raw_buf[raw_pos + bsize_m1 - 3]), 4);
+      if (unlikely(isize > kMaxBgzfDecompressedBlockSize)) {
+        goto LoadBgzfFile_ret_INVALID;
+      }
+      buf_size += isize;
+      raw_pos += bsize_m1 + 1;
+    }
+    // Trailing zero bytes simplify the parser's bounds checks.
+    unsigned char* buf = S_CAST(unsigned char*, malloc(buf_size + 8));
+    if (unlikely(!buf)) {
+      goto LoadBgzfFile_ret_NOMEM;
+    }
+    *bufp = buf;
+    memset(&(buf[buf_size]), 0, 8);
+    ldc = libdeflate_alloc_decompressor();
+    if (unlikely(!ldc)) {
+      goto LoadBgzfFile_ret_NOMEM;
+    }
+    unsigned char* buf_iter = buf;
+    for (uintptr_t raw_pos = 0; raw_pos != S_CAST(uintptr_t, raw_size); ) {
+      uint16_t bsize_m1;
+      memcpy(&bsize_m1, &(raw_buf[raw_pos + 16]), 2);
+      uint32_t isize;
+      memcpy(&isize, &(raw_buf[raw_pos + bsize_m1 - 3]), 4);
+      if (unlikely(libdeflate_deflate_decompress(ldc, &(raw_buf[raw_pos + 18]), bsize_m1 - 25, buf_iter, isize, nullptr))) {
+        goto LoadBgzfFile_ret_INVALID;
+      }
+      buf_iter = &(buf_iter[isize]);
+      raw_pos += bsize_m1 + 1;
+    }
+    *buf_sizep = buf_size;
+  }
+  while (0) {
+  LoadBgzfFile_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  LoadBgzfFile_ret_READ_FAIL:
+    *errmsgp = strerror(errno);
+    reterr = kPglRetReadFail;
+    break;
+  LoadBgzfFile_ret_INVALID:
+    *errmsgp = kShortErrInvalidBgzfIndex;
+    reterr = kPglRetMalformedInput;
+    break;
+  }
+  if (ldc) {
+    libdeflate_free_decompressor(ldc);
+  }
+  free_cond(raw_buf);
+  fclose(ff);
+  return reterr;
+}
+
+PglErr LoadBgzfIndex(const char* data_fname, BgzfIndex* bgzf_idxp, const char** errmsgp) {
+  const uint32_t data_fname_slen = strlen(data_fname);
+  char* idx_fname = S_CAST(char*, malloc(data_fname_slen + 5));
+  if (unlikely(!idx_fname)) {
+    return kPglRetNomem;
+  }
+  char* idx_fname_ext = memcpya(idx_fname, data_fname, data_fname_slen);
+  snprintf(idx_fname_ext, 5, ".tbi");
+  uintptr_t buf_size;
+  PglErr reterr = LoadBgzfFile(idx_fname, &bgzf_idxp->buf, &buf_size, errmsgp);
+  uint32_t is_csi = 0;
+  if (reterr == kPglRetSkipped) {
+    snprintf(idx_fname_ext, 5, ".csi");
+    reterr = LoadBgzfFile(idx_fname, &bgzf_idxp->buf, &buf_size, errmsgp);
+    is_csi = 1;
+  }
+  free(idx_fname);
+  if (reterr) {
+    CleanupBgzfIndex(bgzf_idxp);
+    return reterr;
+  }
+  {
+    const unsigned char* idx_iter = bgzf_idxp->buf;
+    const unsigned char* idx_end = &(idx_iter[buf_size]);
+    if (unlikely((buf_size < 8) || (!memequal(idx_iter, is_csi? "CSI\1" : "TBI\1", 4)))) {
+      goto LoadBgzfIndex_ret_INVALID;
+    }
+    idx_iter = &(idx_iter[4]);
+    int32_t n_ref;
+    uint32_t min_shift = 14;
+    uint32_t depth = 5;
+    // Tabix header fields: format, col_seq, col_beg, col_end, meta, skip.
+    const uint32_t tbx_skip = 6 * sizeof(int32_t);
+    int32_t l_nm;
+    if (!is_csi) {
+      idx_iter = IdxRead(idx_iter, idx_end, 4, &n_ref);
+      idx_iter = IdxSkip(idx_iter, idx_end, tbx_skip);
+      if (unlikely(!idx_iter)) {
+        goto LoadBgzfIndex_ret_INVALID;
+      }
+      idx_iter = IdxRead(idx_iter, idx_end, 4, &l_nm);
+      if (unlikely((!idx_iter) || (l_nm < 0))) {
+        goto LoadBgzfIndex_ret_INVALID;
+      }
+      bgzf_idxp->names = R_CAST(const char*, idx_iter);
+      idx_iter = IdxSkip(idx_iter, idx_end, l_nm);
+    } else {
+      int32_t min_shift_i32;
+      int32_t depth_i32;
+      int32_t l_aux;
+      idx_iter = IdxRead(idx_iter, idx_end, 4, &min_shift_i32);
+      idx_iter = IdxRead(idx_iter, idx_end, 4, &depth_i32);
+      idx_iter = IdxRead(idx_iter, idx_end, 4, &l_aux);
+      if (unlikely((!idx_iter) || (min_shift_i32 < 0) || (depth_i32 < 0) || (min_shift_i32 + 3 * S_CAST(int64_t, depth_i32) > 62) || (l_aux < 0))) {
+        goto LoadBgzfIndex_ret_INVALID;
+      }
+      if (unlikely(depth_i32 > kBgzfIndexMaxDepth)) {
+        *errmsgp = kShortErrBgzfIndexDepth;
+        reterr = kPglRetNotYetSupported;
+        goto LoadBgzfIndex_ret_1;
+      }
+      min_shift = min_shift_i32;
+      depth = depth_i32;
+      const unsigned char* aux_end = IdxSkip(idx_iter, idx_end, l_aux);
+      if (unlikely(!aux_end)) {
+        goto LoadBgzfIndex_ret_INVALID;
+      }
+      if (S_CAST(uint32_t, l_aux) < tbx_skip + sizeof(int32_t)) {
+        // No sequence names (e.g. BAM-style CSI).
+        reterr = kPglRetSkipped;
+        goto LoadBgzfIndex_ret_1;
+      }
+      memcpy(&l_nm, &(idx_iter[tbx_skip]), 4);
+      if (unlikely((l_nm < 0) || (S_CAST(uint32_t, l_nm) > l_aux - tbx_skip - sizeof(int32_t)))) {
+        goto LoadBgzfIndex_ret_INVALID;
+      }
+      bgzf_idxp->names = R_CAST(const char*, &(idx_iter[tbx_skip + sizeof(int32_t)]));
+      idx_iter = IdxRead(aux_end, idx_end, 4, &n_ref);
+    }
+    if (unlikely((!idx_iter) || (n_ref < 0) || (l_nm && bgzf_idxp->names[l_nm - 1]))) {
+      goto LoadBgzfIndex_ret_INVALID;
+    }
+    // Verify that there are exactly n_ref names.
+    {
+      const char* names_iter = bgzf_idxp->names;
+      const char* names_end = &(names_iter[S_CAST(uint32_t, l_nm)]);
+      for (int32_t ref_idx = 0; ref_idx != n_ref; ++ref_idx) {
+        if (unlikely(names_iter == names_end)) {
+          goto LoadBgzfIndex_ret_INVALID;
+        }
+        names_iter = &(names_iter[strlen(names_iter) + 1]);
+      }
+    }
+    bgzf_idxp->ref_starts = S_CAST(const unsigned char**, malloc((n_ref + 1) * sizeof(intptr_t)));
+    if (unlikely(!bgzf_idxp->ref_starts)) {
+      goto LoadBgzfIndex_ret_NOMEM;
+    }
+    const uint32_t bin_header_size = is_csi? 16 : 8;
+    for (int32_t ref_idx = 0; ref_idx != n_ref; ++ref_idx) {
+      bgzf_idxp->ref_starts[ref_idx] = idx_iter;
+      int32_t n_bin;
+      idx_iter = IdxRead(idx_iter, idx_end, 4, &n_bin);
+      if (unlikely((!idx_iter) || (n_bin < 0))) {
+        goto LoadBgzfIndex_ret_INVALID;
+      }
+      for (int32_t bin_idx = 0; bin_idx != n_bin; ++bin_idx) {
+        int32_t n_chunk;
+        idx_iter = IdxSkip(idx_iter, idx_end, bin_header_size - 4);
+        if (unlikely(!idx_iter)) {
+          goto LoadBgzfIndex_ret_INVALID;
+        }
+        idx_iter = IdxRead(idx_iter, idx_end, 4, &n_chunk);
+        if (unlikely((!idx_iter) || (n_chunk < 0))) {
+          goto LoadBgzfIndex_ret_INVALID;
+        }
+        idx_iter = IdxSkip(idx_iter, idx_end, n_chunk * 16LLU);
+        if (unlikely(!idx_iter)) {
+          goto LoadBgzfIndex_ret_INVALID;
+        }
+      }
+      if (!is_csi) {
+        int32_t n_intv;
+        idx_iter = IdxRead(idx_iter, idx_end, 4, &n_intv);
+        if (unlikely((!idx_iter) || (n_intv < 0))) {
+          goto LoadBgzfIndex_ret_INVALID;
+        }
+        idx_iter = IdxSkip(idx_iter, idx_end, n_intv * 8LLU);
+        if (unlikely(!idx_iter)) {
+          goto LoadBgzfIndex_ret_INVALID;
+        }
+      }
+    }
+    bgzf_idxp->ref_starts[n_ref] = idx_iter;
+    bgzf_idxp->ref_ct = n_ref;
+    bgzf_idxp->min_shift = min_shift;
+    bgzf_idxp->depth = depth;
+    bgzf_idxp->is_csi = is_csi;
+  }
+  while (0) {
+  LoadBgzfIndex_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  LoadBgzfIndex_ret_INVALID:
+    *errmsgp = kShortErrInvalidBgzfIndex;
+    reterr = kPglRetMalformedInput;
+    break;
+  }
+ LoadBgzfIndex_ret_1:
+  if (reterr) {
+    CleanupBgzfIndex(bgzf_idxp);
+  }
+  return reterr;
+}
+
+uint64_t BgzfIndexQuery(const BgzfIndex* bgzf_idxp, uint32_t ref_idx, uint64_t beg, uint64_t end) {
+  const uint32_t min_shift = bgzf_idxp->min_shift;
+  const uint32_t depth = bgzf_idxp->depth;
+  const uint32_t is_csi = bgzf_idxp->is_csi;
+  // Bins are numbered level-by-level; level l starts at ((8^l) - 1) / 7, and
+  // its bins have size 2^(min_shift + 3 * (depth - l)).  LoadBgzfIndex()
+  // guarantees depth <= kBgzfIndexMaxDepth, so every real bin number fits in
+  // 32 bits, but the count itself is computed in 64 bits.
+  const uint64_t bin_ct = ((1LLU << (3 * (depth + 1))) - 1) / 7;
+  if (end > BgzfIndexMaxPos(bgzf_idxp)) {
+    end = BgzfIndexMaxPos(bgzf_idxp);
+  }
+  if (beg >= end) {
+    return UINT64_MAX;
+  }
+  const unsigned char* ref_start = bgzf_idxp->ref_starts[ref_idx];
+  // Lower bound on the virtual offset of any record overlapping beg.
+  // * tabix: linear index entry for beg's 16 KiB window.
+  // * CSI: loffset of the smallest bin containing beg that is present.
+  uint64_t min_off = 0;
+  uint32_t bin_ct_present;
+  memcpy(&bin_ct_present, ref_start, 4);
+  const unsigned char* idx_iter = &(ref_start[4]);
+  uint32_t min_off_level = 0;
+  for (uint32_t bin_idx = 0; bin_idx != bin_ct_present; ++bin_idx) {
+    uint32_t bin;
+    memcpy(&bin, idx_iter, 4);
+    uint64_t loffset = 0;
+    if (is_csi) {
+      memcpy(&loffset, &(idx_iter[4]), 8);
+      idx_iter = &(idx_iter[12]);
+    } else {
+      idx_iter = &(idx_iter[4]);
+    }
+    uint32_t n_chunk;
+    memcpy(&n_chunk, idx_iter, 4);
+    idx_iter = &(idx_iter[4 + 16 * S_CAST(uintptr_t, n_chunk)]);
+    if ((!is_csi) || (bin >= bin_ct)) {
+      continue;
+    }
+    uint32_t level = 0;
+    uint32_t level_start = 0;
+    while (bin >= level_start * 8 + 1) {
+      level_start = level_start * 8 + 1;
+      ++level;
+    }
+    const uint32_t shift = min_shift + 3 * (depth - level);
+    if (((beg >> shift) == bin - level_start) && (level >= min_off_level)) {
+      min_off = loffset;
+      min_off_level = level;
+    }
+  }
+  if (!is_csi) {
+    uint32_t n_intv;
+    memcpy(&n_intv, idx_iter, 4);
+    if (n_intv) {
+      uint64_t window_idx = beg >> min_shift;
+      if (window_idx >= n_intv) {
+        window_idx = n_intv - 1;
+      }
+      memcpy(&min_off, &(idx_iter[4 + 8 * window_idx]), 8);
+    }
+  }
+
+  uint64_t result = UINT64_MAX;
+  idx_iter = &(ref_start[4]);
+  for (uint32_t bin_idx = 0; bin_idx != bin_ct_present; ++bin_idx) {
+    uint32_t bin;
+    memcpy(&bin, idx_iter, 4);
+    idx_iter = &(idx_iter[is_csi? 12 : 4]);
+    uint32_t n_chunk;
+    memcpy(&n_chunk, idx_iter, 4);
+    const unsigned char* chunks = &(idx_iter[4]);
+    idx_iter = &(chunks[16 * S_CAST(uintptr_t, n_chunk)]);
+    // Skip pseudo-bin (mapped/unmapped counts).
+    if (bin >= bin_ct) {
+      continue;
+    }
+    uint32_t level = 0;
+    uint32_t level_start = 0;
+    while (bin >= level_start * 8 + 1) {
+      level_start = level_start * 8 + 1;
+      ++level;
+    }
+    const uint32_t shift = min_shift + 3 * (depth - level);
+    const uint64_t bin_offset = bin - level_start;
+    if (((bin_offset << shift) >= end) || (((bin_offset + 1) << shift) <= beg)) {
+      continue;
+    }
+    for (uint32_t chunk_idx = 0; chunk_idx != n_chunk; ++chunk_idx) {
+      uint64_t chunk_beg;
+      uint64_t chunk_end;
+      memcpy(&chunk_beg, &(chunks[16 * chunk_idx]), 8);
+      memcpy(&chunk_end, &(chunks[16 * chunk_idx + 8]), 8);
+      if ((chunk_end > min_off) && (chunk_beg < result)) {
+        result = chunk_beg;
+      }
+    }
+  }
+  return result;
+}
+
+void CleanupBgzfIndex(BgzfIndex* bgzf_idxp) {
+  free_cond(bgzf_idxp->ref_starts);
+  bgzf_idxp->ref_starts = nullptr;
+  free_cond(bgzf_idxp->buf);
+  bgzf_idxp->buf = nullptr;
+  bgzf_idxp->names = nullptr;
+  bgzf_idxp->ref_ct = 0;
+}
+
+
+void PreinitBgzfIndexWriter(BgzfIndexWriter* bgzf_iwp) {
+  memset(bgzf_iwp, 0, sizeof(BgzfIndexWriter));
+}
+
+void CleanupBgzfIndexWriter(BgzfIndexWriter* bgzf_iwp) {
+  free_cond(bgzf_iwp->block_csizes);
+  free_cond(bgzf_iwp->partial_line);
+  free_cond(bgzf_iwp->chunks);
+  free_cond(bgzf_iwp->linear);
+  free_cond(bgzf_iwp->ref_linear_starts);
+  free_cond(bgzf_iwp->ref_record_cts);
+  free_cond(bgzf_iwp->names);
+  PreinitBgzfIndexWriter(bgzf_iwp);
+}
+
+static const char kBgzfIwNomem[] = "out of memory";
+
+// Doubles *capacity_ptr (to at least min_capacity) if ct has reached it.
+// Returns the possibly-moved array, or nullptr on allocation failure (in
+// which case arr is still valid).
+static void* BgzfIwReserve(void* arr, uintptr_t elem_size, uintptr_t ct, uintptr_t min_capacity, uintptr_t* capacity_ptr) {
+  if (ct < *capacity_ptr) {
+    return arr;
+  }
+  uintptr_t new_capacity = 2 * (*capacity_ptr);
+  if (new_capacity < min_capacity) {
+    new_capacity = min_capacity;
+  }
+  void* new_arr = realloc(arr, new_capacity * elem_size);
+  if (new_arr) {
+    *capacity_ptr = new_capacity;
+  }
+  return new_arr;
+}
+
+// Bin of the smallest [depth]-level index interval containing [beg, end).
+static uint32_t BgzfReg2Bin(uint64_t beg, uint64_t end, uint32_t min_shift, uint32_t depth) {
+  --end;
+  uint32_t shift = min_shift;
+  uint32_t level_start = ((1U << (3 * depth)) - 1) / 7;
+  for (uint32_t level = depth; level; --level) {
+    if ((beg >> shift) == (end >> shift)) {
+      return level_start + (beg >> shift);
+    }
+    shift += 3;
+    level_start = (level_start - 1) >> 3;
+  }
+  return 0;
+}
+
+static uint32_t BgzfBinLevel(uint32_t bin, uint32_t* level_start_ptr) {
+  uint32_t level = 0;
+  uint32_t level_start = 0;
+  while (bin >= level_start * 8 + 1) {
+    level_start = level_start * 8 + 1;
+    ++level;
+  }
+  *level_start_ptr = level_start;
+  return level;
+}
+
+// Start of the 0-based col_idx'th tab-delimited field, or nullptr if the line
+// has fewer fields.
+static const char* BgzfIwCol(const char* line_start, const char* line_end, uint32_t col_idx) {
+  for (; col_idx; --col_idx) {
+    const char* tab = S_CAST(const char*, memchr(line_start, '\t', line_end - line_start));
+    if (!tab) {
+      return nullptr;
+    }
+    line_start = &(tab[1]);
+  }
+  return line_start;
+}
+
+static const char* BgzfIwColEnd(const char* col_start, const char* line_end) {
+  const char* tab = S_CAST(const char*, memchr(col_start, '\t', line_end - col_start));
+  return tab? tab : line_end;
+}
+
+static void BgzfIwHeaderLine(const char* line_start, const char* line_end, BgzfIndexWriter* iwp) {
+  const uint32_t line_slen = line_end - line_start;
+  if ((!iwp->line_idx) && StrStartsWith0(line_start, "##fileformat=VCF", line_slen)) {
+    iwp->is_vcf = 1;
+    return;
+  }
+  if (!StrStartsWith0(line_start, "#CHROM", line_slen)) {
+    return;
+  }
+  iwp->header_seen = 1;
+  iwp->pos_col_idx = UINT32_MAX;
+  iwp->ref_col_idx = UINT32_MAX;
+  iwp->info_col_idx = UINT32_MAX;
+  const char* col_start = line_start;
+  for (uint32_t col_idx = 0; ; ++col_idx) {
+    const char* col_end = BgzfIwColEnd(col_start, line_end);
+    const uint32_t col_slen = col_end - col_start;
+    if (strequal_k(col_start, "POS", col_slen)) {
+      iwp->pos_col_idx = col_idx;
+    } else if (strequal_k(col_start, "REF", col_slen)) {
+      iwp->ref_col_idx = col_idx;
+    } else if (strequal_k(col_start, "INFO", col_slen)) {
+      iwp->info_col_idx = col_idx;
+    }
+    if (col_end == line_end) {
+      break;
+    }
+    col_start = &(col_end[1]);
+  }
+  if (!iwp->is_vcf) {
+    iwp->ref_col_idx = UINT32_MAX;
+    iwp->info_col_idx = UINT32_MAX;
+  }
+}
+
+// Returns 1 iff chrom is already a (non-current) reference sequence.
+static uint32_t BgzfIwChromSeen(const char* chrom, uint32_t chrom_slen, const BgzfIndexWriter* iwp) {
+  const char* names_iter = iwp->names;
+  const char* names_end = &(names_iter[iwp->names_blen]);
+  while (names_iter != names_end) {
+    const uint32_t name_slen = strlen(names_iter);
+    if ((name_slen == chrom_slen) && memequal(names_iter, chrom, chrom_slen)) {
+      return 1;
+    }
+    names_iter = &(names_iter[name_slen + 1]);
+  }
+  return 0;
+}
+
+static BoolErr BgzfIwNewRef(const char* chrom, uint32_t chrom_slen, BgzfIndexWriter* iwp) {
+  const uint32_t ref_ct = iwp->ref_ct;
+  if (ref_ct == iwp->ref_capacity) {
+    const uint32_t new_capacity = ref_ct? (2 * ref_ct) : 32;
+    uintptr_t* new_starts = S_CAST(uintptr_t*, realloc(iwp->ref_linear_starts, (new_capacity + 1) * sizeof(intptr_t)));
+    if (!new_starts) {
+      return 1;
+    }
+    iwp->ref_linear_starts = new_starts;
+    uint64_t* new_record_cts = S_CAST(uint64_t*, realloc(iwp->ref_record_cts, new_capacity * sizeof(int64_t)));
+    if (!new_record_cts) {
+      return 1;
+    }
+    iwp->ref_record_cts = new_record_cts;
+    iwp->ref_capacity = new_capacity;
+  }
+  const uintptr_t names_blen = iwp->names_blen;
+  if (names_blen + chrom_slen + 1 > iwp->names_capacity) {
+    char* new_names = S_CAST(char*, BgzfIwReserve(iwp->names, 1, iwp->names_capacity, names_blen + chrom_slen + 1 + 1024, &iwp->names_capacity));
+    if (!new_names) {
+      return 1;
+    }
+    iwp->names = new_names;
+  }
+  memcpyx(&(iwp->names[names_blen]), chrom, chrom_slen, '\0');
+  iwp->cur_name_offset = names_blen;
+  iwp->names_blen = names_blen + chrom_slen + 1;
+  iwp->ref_linear_starts[ref_ct] = iwp->linear_ct;
+  iwp->ref_record_cts[ref_ct] = 0;
+  iwp->ref_ct = ref_ct + 1;
+  iwp->prev_beg = 0;
+  return 0;
+}
+
+// line_end points to the line's '\n' (or one past its last character, for an
+// unterminated last line), and the character there must not be a digit.
+static void BgzfIwLine(const char* line_start, const char* line_end, uint64_t line_ubeg, uint64_t line_uend, BgzfIndexWriter* iwp) {
+  const char* text_end = line_end;
+  if ((text_end != line_start) && (text_end[-1] == '\r')) {
+    --text_end;
+  }
+  if ((*line_start == '#') || (text_end == line_start)) {
+    if (*line_start == '#') {
+      BgzfIwHeaderLine(line_start, text_end, iwp);
+    }
+    ++iwp->line_idx;
+    return;
+  }
+  ++iwp->line_idx;
+  if (!iwp->header_seen) {
+    iwp->skip_reason = "no #CHROM header line";
+    return;
+  }
+  if (iwp->pos_col_idx == UINT32_MAX) {
+    iwp->skip_reason = "no POS column";
+    return;
+  }
+  const char* chrom_end = BgzfIwColEnd(line_start, text_end);
+  const uint32_t chrom_slen = chrom_end - line_start;
+  const char* pos_start = BgzfIwCol(line_start, text_end, iwp->pos_col_idx);
+  uint32_t pos;
+  if ((!pos_start) || ScanUintCapped(pos_start, 0x7fffffff, &pos)) {
+    iwp->skip_reason = "invalid POS value";
+    return;
+  }
+  const uint64_t beg = pos? (pos - 1) : 0;
+  uint64_t end = beg + 1;
+  if (iwp->ref_col_idx != UINT32_MAX) {
+    const char* ref_start = BgzfIwCol(line_start, text_end, iwp->ref_col_idx);
+    if (ref_start) {
+      const uint32_t ref_slen = BgzfIwColEnd(ref_start, text_end) - ref_start;
+      if (ref_slen > 1) {
+        end = beg + ref_slen;
+      }
+    }
+  }
+  if (iwp->info_col_idx != UINT32_MAX) {
+    const char* info_start = BgzfIwCol(line_start, text_end, iwp->info_col_idx);
+    if (info_start) {
+      const char* info_end = BgzfIwColEnd(info_start, text_end);
+      for (const char* key_iter = info_start; key_iter < info_end; ) {
+        const char* key_end = S_CAST(const char*, memchr(key_iter, ';', info_end - key_iter));
+        if (!key_end) {
+          key_end = info_end;
+        }
+        if (StrStartsWith(key_iter, "END=", key_end - key_iter)) {
+          // END is 1-based inclusive, so it's also the 0-based half-open end.
+          uint32_t info_end_val;
+          if ((!ScanUintCapped(&(key_iter[4]), 0x7fffffff, &info_end_val)) && (info_end_val > beg)) {
+            end = info_end_val;
+          }
+          break;
+        }
+        key_iter = &(key_end[1]);
+      }
+    }
+  }
+
+  uint32_t is_new_chrom = 1;
+  if (iwp->ref_ct) {
+    const char* cur_name = &(iwp->names[iwp->cur_name_offset]);
+    is_new_chrom = (!memequal(line_start, cur_name, chrom_slen)) || cur_name[chrom_slen];
+  }
+  if (is_new_chrom) {
+    if (BgzfIwChromSeen(line_start, chrom_slen, iwp)) {
+      iwp->skip_reason = "chromosomes are not contiguous";
+      return;
+    }
+    if (BgzfIwNewRef(line_start, chrom_slen, iwp)) {
+      iwp->skip_reason = kBgzfIwNomem;
+      return;
+    }
+  }
+  if (beg < iwp->prev_beg) {
+    iwp->skip_reason = "positions are not sorted";
+    return;
+  }
+  iwp->prev_beg = beg;
+  if (end > iwp->max_end) {
+    iwp->max_end = end;
+  }
+  const uint32_t ref_idx = iwp->ref_ct - 1;
+  iwp->ref_record_cts[ref_idx] += 1;
+
+  const uint32_t bin = BgzfReg2Bin(beg, end, kBgzfIndexMinShift, kBgzfIndexBuildDepth);
+  const uintptr_t chunk_ct = iwp->chunk_ct;
+  BgzfIndexChunk* last_chunk = chunk_ct? (&(iwp->chunks[chunk_ct - 1])) : nullptr;
+  if (last_chunk && (last_chunk->ref_idx == ref_idx) && (last_chunk->bin == bin) && (last_chunk->end == line_ubeg)) {
+    last_chunk->end = line_uend;
+  } else {
+    BgzfIndexChunk* new_chunks = S_CAST(BgzfIndexChunk*, BgzfIwReserve(iwp->chunks, sizeof(BgzfIndexChunk), chunk_ct, 4096, &iwp->chunk_capacity));
+    if (!new_chunks) {
+      iwp->skip_reason = kBgzfIwNomem;
+      return;
+    }
+    iwp->chunks = new_chunks;
+    BgzfIndexChunk* new_chunk = &(new_chunks[chunk_ct]);
+    new_chunk->ref_idx = ref_idx;
+    new_chunk->bin = bin;
+    new_chunk->beg = line_ubeg;
+    new_chunk->end = line_uend;
+    iwp->chunk_ct = chunk_ct + 1;
+  }
+
+  const uintptr_t linear_start = iwp->ref_linear_starts[ref_idx];
+  const uintptr_t window_last = linear_start + ((end - 1) >> kBgzfIndexMinShift);
+  if (window_last >= iwp->linear_ct) {
+    if (window_last >= iwp->linear_capacity) {
+      uint64_t* new_linear = S_CAST(uint64_t*, BgzfIwReserve(iwp->linear, sizeof(int64_t), iwp->linear_capacity, window_last + 1, &iwp->linear_capacity));
+      if (!new_linear) {
+        iwp->skip_reason = kBgzfIwNomem;
+        return;
+      }
+      iwp->linear = new_linear;
+    }
+    for (uintptr_t window_idx = iwp->linear_ct; window_idx <= window_last; ++window_idx) {
+      iwp->linear[window_idx] = UINT64_MAX;
+    }
+    iwp->linear_ct = window_last + 1;
+  }
+  for (uintptr_t window_idx = linear_start + (beg >> kBgzfIndexMinShift); window_idx <= window_last; ++window_idx) {
+    if (iwp->linear[window_idx] == UINT64_MAX) {
+      iwp->linear[window_idx] = line_ubeg;
+    }
+  }
+}
+
+static BoolErr BgzfIwSavePartial(const char* buf, uintptr_t len, BgzfIndexWriter* iwp) {
+  const uintptr_t new_len = iwp->partial_line_len + len;
+  // Leave room for the terminator appended by WriteBgzfIndex().
+  if (new_len + 1 > iwp->partial_line_capacity) {
+    char* new_partial = S_CAST(char*, BgzfIwReserve(iwp->partial_line, 1, iwp->partial_line_capacity, new_len + 1, &iwp->partial_line_capacity));
+    if (!new_partial) {
+      return 1;
+    }
+    iwp->partial_line = new_partial;
+  }
+  memcpy(&(iwp->partial_line[iwp->partial_line_len]), buf, len);
+  iwp->partial_line_len = new_len;
+  return 0;
+}
+
+// Called by BgzfWrite() on the producer thread, before buf is copied into the
+// compression slots.
+static void BgzfIwScan(const char* buf, uintptr_t len, BgzfIndexWriter* iwp) {
+  const uint64_t uoffset = iwp->uoffset;
+  iwp->uoffset = uoffset + len;
+  if (iwp->skip_reason) {
+    return;
+  }
+  const char* buf_end = &(buf[len]);
+  const char* line_start = buf;
+  if (iwp->partial_line_len) {
+    const char* nl = S_CAST(const char*, memchr(buf, '\n', len));
+    if (!nl) {
+      if (BgzfIwSavePartial(buf, len, iwp)) {
+        iwp->skip_reason = kBgzfIwNomem;
+      }
+      return;
+    }
+    line_start = &(nl[1]);
+    if (BgzfIwSavePartial(buf, line_start - buf, iwp)) {
+      iwp->skip_reason = kBgzfIwNomem;
+      return;
+    }
+    const char* partial_line = iwp->partial_line;
+    BgzfIwLine(partial_line, &(partial_line[iwp->partial_line_len - 1]), iwp->partial_line_uoffset, uoffset + (line_start - buf), iwp);
+    iwp->partial_line_len = 0;
+  }
+  while (!iwp->skip_reason) {
+    const char* nl = S_CAST(const char*, memchr(line_start, '\n', buf_end - line_start));
+    if (!nl) {
+      if (line_start != buf_end) {
+        iwp->partial_line_uoffset = uoffset + (line_start - buf);
+        if (BgzfIwSavePartial(line_start, buf_end - line_start, iwp)) {
+          iwp->skip_reason = kBgzfIwNomem;
+        }
+      }
+      return;
+    }
+    const char* next_line_start = &(nl[1]);
+    BgzfIwLine(line_start, nl, uoffset + (line_start - buf), uoffset + (next_line_start - buf), iwp);
+    line_start = next_line_start;
+  }
+}
+
+static int32_t BgzfIndexChunkCmp(const void* aa, const void* bb) {
+  const BgzfIndexChunk* chunk_a = S_CAST(const BgzfIndexChunk*, aa);
+  const BgzfIndexChunk* chunk_b = S_CAST(const BgzfIndexChunk*, bb);
+  if (chunk_a->ref_idx != chunk_b->ref_idx) {
+    return (chunk_a->ref_idx < chunk_b->ref_idx)? -1 : 1;
+  }
+  if (chunk_a->bin != chunk_b->bin) {
+    return (chunk_a->bin < chunk_b->bin)? -1 : 1;
+  }
+  return (chunk_a->beg < chunk_b->beg)? -1 : (chunk_a->beg > chunk_b->beg);
+}
+
+static inline unsigned char* IdxAppendU32(uint32_t val, unsigned char* idx_iter) {
+  memcpy(idx_iter, &val, 4);
+  return &(idx_iter[4]);
+}
+
+static inline unsigned char* IdxAppendU64(uint64_t val, unsigned char* idx_iter) {
+  memcpy(idx_iter, &val, 8);
+  return &(idx_iter[8]);
+}
+
+PglErr WriteBgzfIndex(const char* data_fname, BgzfIndexWriter* bgzf_iwp, uint32_t* is_csi_ptr, const char** errmsgp) {
+  BgzfIndexWriter* iwp = bgzf_iwp;
+  uint64_t* coffsets = nullptr;
+  unsigned char* idx_buf = nullptr;
+  char* idx_fname = nullptr;
+  BgzfCompressStream idx_bgzf;
+  PreinitBgzfCompressStream(&idx_bgzf);
+  PglErr reterr = kPglRetSuccess;
+  {
+    if ((!iwp->skip_reason) && iwp->partial_line_len) {
+      iwp->partial_line[iwp->partial_line_len] = '\n';
+      BgzfIwLine(iwp->partial_line, &(iwp->partial_line[iwp->partial_line_len]), iwp->partial_line_uoffset, iwp->uoffset, iwp);
+      iwp->partial_line_len = 0;
+    }
+    if ((!iwp->skip_reason) && (!iwp->header_seen)) {
+      iwp->skip_reason = "no #CHROM header line";
+    }
+    if ((!iwp->skip_reason) && iwp->block_nomem) {
+      iwp->skip_reason = kBgzfIwNomem;
+    }
+    if (iwp->skip_reason) {
+      *errmsgp = iwp->skip_reason;
+      reterr = kPglRetSkipped;
+      goto WriteBgzfIndex_ret_1;
+    }
+    // Compressed offset of each block start, and of the EOF marker block.
+    const uintptr_t block_ct = iwp->block_ct;
+    coffsets = S_CAST(uint64_t*, malloc((block_ct + 1) * sizeof(int64_t)));
+    if (unlikely(!coffsets)) {
+      goto WriteBgzfIndex_ret_NOMEM;
+    }
+    coffsets[0] = 0;
+    for (uintptr_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+      coffsets[block_idx + 1] = coffsets[block_idx] + iwp->block_csizes[block_idx];
+    }
+    if (unlikely(iwp->uoffset > block_ct * S_CAST(uint64_t, kBgzfInputBlockSize))) {
+      // Caller wrote more than was compressed.
+      reterr = kPglRetImproperFunctionCall;
+      goto WriteBgzfIndex_ret_1;
+    }
+    const uint32_t is_csi = (iwp->max_end > (1LLU << (kBgzfIndexMinShift + 3 * 5)));
+    *is_csi_ptr = is_csi;
+    const uint32_t depth = is_csi? kBgzfIndexBuildDepth : 5;
+    const uint32_t bin_ct = ((1LLU << (3 * (depth + 1))) - 1) / 7;
+
+    // Translate bins to the final depth, and offsets to virtual offsets.
+    BgzfIndexChunk* chunks = iwp->chunks;
+    const uintptr_t raw_chunk_ct = iwp->chunk_ct;
+    for (uintptr_t chunk_idx = 0; chunk_idx != raw_chunk_ct; ++chunk_idx) {
+      BgzfIndexChunk* chunkp = &(chunks[chunk_idx]);
+      if (!is_csi) {
+        // Level-0 bins of the build depth are only needed past 2^29.
+        uint32_t level_start;
+        const uint32_t level = BgzfBinLevel(chunkp->bin, &level_start);
+        assert(level);
+        chunkp->bin = ((1U << (3 * (level - 1))) - 1) / 7 + (chunkp->bin - level_start);
+      }
+      chunkp->beg = (coffsets[chunkp->beg / kBgzfInputBlockSize] << 16) | (chunkp->beg % kBgzfInputBlockSize);
+      chunkp->end = (coffsets[chunkp->end / kBgzfInputBlockSize] << 16) | (chunkp->end % kBgzfInputBlockSize);
+    }
+    qsort(chunks, raw_chunk_ct, sizeof(BgzfIndexChunk), BgzfIndexChunkCmp);
+    // Merge same-bin chunks which meet in a BGZF block, as htslib does, and
+    // count the distinct bins.
+    uintptr_t chunk_ct = 0;
+    uintptr_t bin_total = 0;
+    for (uintptr_t chunk_idx = 0; chunk_idx != raw_chunk_ct; ++chunk_idx) {
+      const BgzfIndexChunk* chunkp = &(chunks[chunk_idx]);
+      if (chunk_ct) {
+        BgzfIndexChunk* prev_chunkp = &(chunks[chunk_ct - 1]);
+        if ((prev_chunkp->ref_idx == chunkp->ref_idx) && (prev_chunkp->bin == chunkp->bin)) {
+          if ((prev_chunkp->end >> 16) == (chunkp->beg >> 16)) {
+            if (chunkp->end > prev_chunkp->end) {
+              prev_chunkp->end = chunkp->end;
+            }
+            continue;
+          }
+          chunks[chunk_ct++] = *chunkp;
+          continue;
+        }
+      }
+      chunks[chunk_ct++] = *chunkp;
+      ++bin_total;
+    }
+    // Linear index: empty windows inherit their predecessor's offset.
+    const uint32_t ref_ct = iwp->ref_ct;
+    uint64_t* linear = iwp->linear;
+    if (ref_ct) {
+      iwp->ref_linear_starts[ref_ct] = iwp->linear_ct;
+    }
+    for (uint32_t ref_idx = 0; ref_idx != ref_ct; ++ref_idx) {
+      uint64_t prev_voffset = 0;
+      const uintptr_t linear_end = iwp->ref_linear_starts[ref_idx + 1];
+      for (uintptr_t window_idx = iwp->ref_linear_starts[ref_idx]; window_idx != linear_end; ++window_idx) {
+        const uint64_t uoffset = linear[window_idx];
+        if (uoffset != UINT64_MAX) {
+          prev_voffset = (coffsets[uoffset / kBgzfInputBlockSize] << 16) | (uoffset % kBgzfInputBlockSize);
+        }
+        linear[window_idx] = prev_voffset;
+      }
+    }
+
+    // See the tabix and CSIv1 specifications for the layout.  Every reference
+    // sequence also gets htslib's pseudo-bin, with its offset range and record
+    // count.
+    const uint32_t bin_header_size = is_csi? 16 : 8;
+    const uintptr_t tbx_header_size = 7 * sizeof(int32_t) + iwp->names_blen;
+    uint64_t idx_size = 4 + tbx_header_size + 8;
+    if (is_csi) {
+      idx_size += 4 * sizeof(int32_t);
+    } else {
+      idx_size += sizeof(int32_t) + iwp->linear_ct * sizeof(int64_t) + ref_ct * sizeof(int32_t);
+    }
+    idx_size += ref_ct * (sizeof(int32_t) + bin_header_size + 2 * 16) + bin_total * bin_header_size + chunk_ct * 16;
+    if (unlikely(idx_size > (~k0LU) / 2)) {
+      goto WriteBgzfIndex_ret_NOMEM;
+    }
+    idx_buf = S_CAST(unsigned char*, malloc(idx_size));
+    if (unlikely(!idx_buf)) {
+      goto WriteBgzfIndex_ret_NOMEM;
+    }
+    unsigned char* idx_iter = idx_buf;
+    if (!is_csi) {
+      idx_iter = memcpyua(idx_iter, "TBI\1", 4);
+      idx_iter = IdxAppendU32(ref_ct, idx_iter);
+    } else {
+      idx_iter = memcpyua(idx_iter, "CSI\1", 4);
+      idx_iter = IdxAppendU32(kBgzfIndexMinShift, idx_iter);
+      idx_iter = IdxAppendU32(depth, idx_iter);
+      idx_iter = IdxAppendU32(tbx_header_size, idx_iter);
+    }
+    // format (0 = generic, 2 = VCF), col_seq, col_beg, col_end, meta, skip
+    idx_iter = IdxAppendU32(iwp->is_vcf? 2 : 0, idx_iter);
+    idx_iter = IdxAppendU32(1, idx_iter);
+    idx_iter = IdxAppendU32(iwp->pos_col_idx + 1, idx_iter);
+    idx_iter = IdxAppendU32(iwp->is_vcf? 0 : (iwp->pos_col_idx + 1), idx_iter);
+    idx_iter = IdxAppendU32('#', idx_iter);
+    idx_iter = IdxAppendU32(0, idx_iter);
+    idx_iter = IdxAppendU32(iwp->names_blen, idx_iter);
+    idx_iter = memcpyua(idx_iter, iwp->names, iwp->names_blen);
+    if (is_csi) {
+      idx_iter = IdxAppendU32(ref_ct, idx_iter);
+    }
+    const BgzfIndexChunk* chunk_iter = chunks;
+    const BgzfIndexChunk* chunks_end = &(chunks[chunk_ct]);
+    for (uint32_t ref_idx = 0; ref_idx != ref_ct; ++ref_idx) {
+      const BgzfIndexChunk* ref_chunks_end = chunk_iter;
+      uint32_t ref_bin_ct = 0;
+      uint64_t ref_voffset_beg = UINT64_MAX;
+      uint64_t ref_voffset_end = 0;
+      for (; (ref_chunks_end != chunks_end) && (ref_chunks_end->ref_idx == ref_idx); ++ref_chunks_end) {
+        if ((ref_chunks_end == chunk_iter) || (ref_chunks_end[-1].bin != ref_chunks_end->bin)) {
+          ++ref_bin_ct;
+        }
+        if (ref_chunks_end->beg < ref_voffset_beg) {
+          ref_voffset_beg = ref_chunks_end->beg;
+        }
+        if (ref_chunks_end->end > ref_voffset_end) {
+          ref_voffset_end = ref_chunks_end->end;
+        }
+      }
+      const uint64_t* ref_linear = &(linear[iwp->ref_linear_starts[ref_idx]]);
+      const uintptr_t ref_linear_ct = iwp->ref_linear_starts[ref_idx + 1] - iwp->ref_linear_starts[ref_idx];
+      idx_iter = IdxAppendU32(ref_bin_ct + 1, idx_iter);
+      while (chunk_iter != ref_chunks_end) {
+        const uint32_t bin = chunk_iter->bin;
+        const BgzfIndexChunk* bin_chunks_end = chunk_iter;
+        do {
+          ++bin_chunks_end;
+        } while ((bin_chunks_end != ref_chunks_end) && (bin_chunks_end->bin == bin));
+        idx_iter = IdxAppendU32(bin, idx_iter);
+        if (is_csi) {
+          // Linear-index offset of the bin's first window.
+          uint32_t level_start;
+          const uint32_t level = BgzfBinLevel(bin, &level_start);
+          const uint64_t first_window = S_CAST(uint64_t, bin - level_start) << (3 * (depth - level));
+          idx_iter = IdxAppendU64((first_window < ref_linear_ct)? ref_linear[first_window] : 0, idx_iter);
+        }
+        idx_iter = IdxAppendU32(bin_chunks_end - chunk_iter, idx_iter);
+        for (; chunk_iter != bin_chunks_end; ++chunk_iter) {
+          idx_iter = IdxAppendU64(chunk_iter->beg, idx_iter);
+          idx_iter = IdxAppendU64(chunk_iter->end, idx_iter);
+        }
+      }
+      idx_iter = IdxAppendU32(bin_ct + 1, idx_iter);
+      if (is_csi) {
+        idx_iter = IdxAppendU64(0, idx_iter);
+      }
+      idx_iter = IdxAppendU32(2, idx_iter);
+      idx_iter = IdxAppendU64(ref_voffset_beg, idx_iter);
+      idx_iter = IdxAppendU64(ref_voffset_end, idx_iter);
+      idx_iter = IdxAppendU64(iwp->ref_record_cts[ref_idx], idx_iter);
+      idx_iter = IdxAppendU64(0, idx_iter);
+      if (!is_csi) {
+        idx_iter = IdxAppendU32(ref_linear_ct, idx_iter);
+        idx_iter = memcpyua(idx_iter, ref_linear, ref_linear_ct * sizeof(int64_t));
+      }
+    }
+    // n_no_coor
+    idx_iter = IdxAppendU64(0, idx_iter);
+    assert(S_CAST(uint64_t, idx_iter - idx_buf) == idx_size);
+
+    const uint32_t data_fname_slen = strlen(data_fname);
+    idx_fname = S_CAST(char*, malloc(data_fname_slen + 5));
+    if (unlikely(!idx_fname)) {
+      goto WriteBgzfIndex_ret_NOMEM;
+    }
+    memcpy(memcpya(idx_fname, data_fname, data_fname_slen), is_csi? ".csi" : ".tbi", 5);
+    reterr = InitBgzfCompressStreamEx(idx_fname, 0, kBgzfDefaultClvl, 1, &idx_bgzf);
+    if (unlikely(reterr)) {
+      if (reterr == kPglRetOpenFail) {
+        *errmsgp = strerror(errno);
+      }
+      goto WriteBgzfIndex_ret_1;
+    }
+    if (unlikely(BgzfWrite(R_CAST(const char*, idx_buf), idx_size, &idx_bgzf))) {
+      goto WriteBgzfIndex_ret_WRITE_FAIL;
+    }
+    if (unlikely(CleanupBgzfCompressStream(&idx_bgzf, &reterr) || errno)) {
+      goto WriteBgzfIndex_ret_WRITE_FAIL;
+    }
+  }
+  while (0) {
+  WriteBgzfIndex_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  WriteBgzfIndex_ret_WRITE_FAIL:
+    *errmsgp = strerror(errno);
+    reterr = kPglRetWriteFail;
+    break;
+  }
+ WriteBgzfIndex_ret_1:
+  CleanupBgzfCompressStream(&idx_bgzf, &reterr);
+  free_cond(idx_fname);
+  free_cond(idx_buf);
+  free_cond(coffsets);
+  return reterr;
+}
+
 void PreinitBgzfCompressStream(BgzfCompressStream* cstream_ptr) {
   BgzfCompressStreamMain* bgzfp = GetBgzfp(cstream_ptr);
   bgzfp->ff = nullptr;
   bgzfp->threads = nullptr;
+  bgzfp->iwp = nullptr;
 }
 
 static const unsigned char kBgzfEofBlock[] = "\37\213\10\4\0\0\0\0\0\377\6\0\102\103\2\0\33\0\3\0\0\0\0\0\0\0\0";
@@ -640,8 +1689,8 @@ THREAD_FUNC_DECL BgzfCompressWriterThread(void* raw_arg) {
     }
     // hold mutex during write operation
 #endif
+    const uint32_t nbytes = cww->nbytes;
     if (ff) {
-      const uint32_t nbytes = cww->nbytes;
       if (nbytes) {
         if (unlikely(!fwrite_unlocked(cww->cbuf, nbytes, 1, ff))) {
           context->write_errno = errno;
@@ -651,6 +1700,17 @@ THREAD_FUNC_DECL BgzfCompressWriterThread(void* raw_arg) {
         }
       }
     }
+    BgzfIndexWriter* iwp = context->iwp;
+    if (iwp && nbytes) {
+      uint32_t* new_csizes = S_CAST(uint32_t*, BgzfIwReserve(iwp->block_csizes, sizeof(int32_t), iwp->block_ct, 1024, &iwp->block_capacity));
+      if (new_csizes) {
+        iwp->block_csizes = new_csizes;
+        new_csizes[iwp->block_ct] = nbytes;
+        iwp->block_ct += 1;
+      } else {
+        iwp->block_nomem = 1;
+      }
+    }
     const uint32_t eof = cww->eof;
     cww->nbytes = UINT32_MAX;
 #ifdef _WIN32
@@ -686,6 +1746,7 @@ PglErr InitBgzfCompressStreamEx(const char* out_fname, uint32_t do_append, uint3
     return kPglRetImproperFunctionCall;
   }
   bgzfp->slot_ct = 0;
+  bgzfp->iwp = nullptr;
   bgzfp->ff = fopen(out_fname, do_append? FOPEN_AB : FOPEN_WB);
   if (unlikely(!bgzfp->ff)) {
     // slot_ct set to 0, so we'll immediately segfault on write attempt
@@ -879,6 +1940,9 @@ BoolErr BgzfWrite(const char* buf, uintptr_t len, BgzfCompressStream* cstream_pt
     errno = bgzfp->write_errno;
     return 1;
   }
+  if (bgzfp->iwp) {
+    BgzfIwScan(buf, len, bgzfp->iwp);
+  }
   uint32_t slot_idx = bgzfp->partial_slot_idx;
   BgzfCompressCommWithP* cwp = bgzfp->cwps[slot_idx];
   uint32_t dst_offset = bgzfp->partial_nbytes;
@@ -923,6 +1987,15 @@ BoolErr BgzfWrite(const char* buf, uintptr_t len, BgzfCompressStream* cstream_pt
   return 0;
 }
 
+PglErr AttachBgzfIndexWriter(BgzfCompressStream* cstream_ptr, BgzfIndexWriter* bgzf_iwp) {
+  BgzfCompressStreamMain* bgzfp = GetBgzfp(cstream_ptr);
+  if ((!bgzfp->slot_ct) || bgzfp->iwp || bgzfp->partial_nbytes || bgzfp->partial_slot_idx) {
+    return kPglRetImproperFunctionCall;
+  }
+  bgzfp->iwp = bgzf_iwp;
+  return kPglRetSuccess;
+}
+
 BoolErr CleanupBgzfCompressStream(BgzfCompressStream* cstream_ptr, PglErr* reterrp) {
   BgzfCompressStreamMain* bgzfp = GetBgzfp(cstream_ptr);
   pthread_t* threads = bgzfp->threads;
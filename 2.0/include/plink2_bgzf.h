@@ -163,9 +163,129 @@ HEADER_INLINE PglErr BgzfRawMtStreamRewind(BgzfRawMtDecompressStream* bgzfp, con
   return BgzfRawMtStreamRetarget(nullptr, bgzfp, nullptr, errmsgp);
 }
 
+// Repositions the stream at the given BGZF virtual offset, i.e. (compressed
+// offset of block start) << 16 | (offset within decompressed block).  ff must
+// be seekable.
+PglErr BgzfRawMtStreamSeek(uint64_t virtual_offset, BgzfRawMtDecompressStream* bgzfp, const char** errmsgp);
+
 void CleanupBgzfRawMtStream(BgzfRawMtDecompressStream* bgzfp);
 
 
+// Minimal tabix (.tbi) and CSI index reader, just sufficient to look up where
+// a region's records start.  See the SAMtools "tabix.pdf" and "CSIv1.pdf"
+// specifications.
+typedef struct BgzfIndexStruct {
+  // Entire decompressed index.  ref_starts[] and names point into it.
+  unsigned char* buf;
+  // ref_starts[i] points to the n_bin field of reference sequence i, and
+  // ref_starts[ref_ct] points to the end of the last one.
+  const unsigned char** ref_starts;
+  // Null-terminated reference sequence names, in index (= file) order.
+  const char* names;
+  uint32_t ref_ct;
+  uint32_t min_shift;
+  uint32_t depth;
+  uint32_t is_csi;
+} BgzfIndex;
+
+extern const char kShortErrInvalidBgzfIndex[];
+
+// Deepest CSI index accepted: at depth 11, bin numbers no longer fit in the
+// format's 32-bit fields.
+CONSTI32(kBgzfIndexMaxDepth, 10);
+
+void PreinitBgzfIndex(BgzfIndex* bgzf_idxp);
+
+// Looks for <data_fname>.tbi, then <data_fname>.csi.  Returns kPglRetSkipped
+// if neither exists, or if a CSI index lacks the tabix-style sequence-name
+// metadata.
+PglErr LoadBgzfIndex(const char* data_fname, BgzfIndex* bgzf_idxp, const char** errmsgp);
+
+// Returns the smallest virtual offset which may contain a record on reference
+// sequence ref_idx overlapping [beg, end) (0-based, as in the index), or
+// UINT64_MAX if the index has no such chunk.
+uint64_t BgzfIndexQuery(const BgzfIndex* bgzf_idxp, uint32_t ref_idx, uint64_t beg, uint64_t end);
+
+// Largest end coordinate the index can represent.
+HEADER_INLINE uint64_t BgzfIndexMaxPos(const BgzfIndex* bgzf_idxp) {
+  return 1LLU << (bgzf_idxp->min_shift + 3 * bgzf_idxp->depth);
+}
+
+void CleanupBgzfIndex(BgzfIndex* bgzf_idxp);
+
+// Tabix/CSI index construction for position-sorted text written through a
+// BgzfCompressStream.  Each line is parsed as it's handed to BgzfWrite():
+// - Lines starting with '#' are metadata.  The last one starting with
+//   "#CHROM" names the columns; the first column is the chromosome, and the
+//   one named POS (1-based) is the start position.
+// - If the first line starts with "##fileformat=VCF", the index is VCF-style,
+//   and each record's end is derived from REF's length or INFO/END.
+//   Otherwise, records have length 1.
+// Bins are assigned as if the index had depth kBgzfIndexBuildDepth; when
+// everything fits below 2^29, it's written as a .tbi with tabix's depth 5,
+// otherwise as a .csi.
+CONSTI32(kBgzfIndexMinShift, 14);
+CONSTI32(kBgzfIndexBuildDepth, 6);
+
+typedef struct BgzfIndexChunkStruct {
+  uint32_t ref_idx;
+  uint32_t bin;
+  // Uncompressed offsets until WriteBgzfIndex() converts them.
+  uint64_t beg;
+  uint64_t end;
+} BgzfIndexChunk;
+
+typedef struct BgzfIndexWriterStruct {
+  // Writer thread only, until it's joined: compressed size of each BGZF block.
+  uint32_t* block_csizes;
+  uintptr_t block_ct;
+  uintptr_t block_capacity;
+  uint32_t block_nomem;
+
+  // Producer thread only.
+  // Set when the text turns out to be unindexable; parsing stops at that
+  // point.
+  const char* skip_reason;
+  uint64_t uoffset;  // uncompressed bytes seen so far
+  uint64_t partial_line_uoffset;
+  char* partial_line;  // unterminated line carried over between writes
+  uintptr_t partial_line_len;
+  uintptr_t partial_line_capacity;
+  uint32_t line_idx;
+  uint32_t is_vcf;
+  uint32_t header_seen;
+  uint32_t pos_col_idx;  // 0-based
+  uint32_t ref_col_idx;  // vcf only
+  uint32_t info_col_idx;  // vcf only
+  uint32_t max_col_idx;
+
+  BgzfIndexChunk* chunks;
+  uintptr_t chunk_ct;
+  uintptr_t chunk_capacity;
+  // Concatenated linear indexes (uncompressed offset of the first record
+  // overlapping each 16 KiB window, UINT64_MAX if none yet).
+  uint64_t* linear;
+  uintptr_t linear_ct;
+  uintptr_t linear_capacity;
+  // ref_linear_starts[i] = start of reference sequence i's linear index.
+  uintptr_t* ref_linear_starts;
+  uint64_t* ref_record_cts;
+  uint32_t ref_ct;
+  uint32_t ref_capacity;
+  // Null-terminated chromosome names, in file order.
+  char* names;
+  uintptr_t names_blen;
+  uintptr_t names_capacity;
+  uintptr_t cur_name_offset;
+  uint64_t prev_beg;
+  uint64_t max_end;
+} BgzfIndexWriter;
+
+void PreinitBgzfIndexWriter(BgzfIndexWriter* bgzf_iwp);
+
+void CleanupBgzfIndexWriter(BgzfIndexWriter* bgzf_iwp);
+
+
 // Compression strategy:
 // - We have N compression-job memory slots, where N is the smallest power of 2
 //   >= 4 * compressor_thread_ct.  (This could be adjusted and/or separately
@@ -241,6 +361,9 @@ struct BgzfCompressStreamMainStruct {
 
   BgzfCompressorContext* compressor_args;  // n elements
 
+  // nullptr unless AttachBgzfIndexWriter() was called.
+  BgzfIndexWriter* iwp;
+
   // Atomically read/updated, guaranteed to be on its own cacheline.
   uintptr_t* next_job_idxp;
 
@@ -287,6 +410,18 @@ BoolErr BgzfWrite(const char* buf, uintptr_t len, BgzfCompressStream* cstream_pt
 
 BoolErr CleanupBgzfCompressStream(BgzfCompressStream* cstream_ptr, PglErr* reterrp);
 
+// Must be called between a successful InitBgzfCompressStreamEx() call (with
+// clvl != 0 and do_append == 0) and the first BgzfWrite().  bgzf_iwp must have
+// been preinitialized, and must outlive the stream.
+PglErr AttachBgzfIndexWriter(BgzfCompressStream* cstream_ptr, BgzfIndexWriter* bgzf_iwp);
+
+// Call after CleanupBgzfCompressStream() succeeds.  Writes <data_fname>.tbi,
+// or <data_fname>.csi if a record extends past 2^29; *is_csi_ptr is set
+// accordingly.  Returns kPglRetSkipped, with *errmsgp describing why, if the
+// text couldn't be indexed (unsorted, missing #CHROM header or POS column,
+// etc.); errno is set on write-fail.
+PglErr WriteBgzfIndex(const char* data_fname, BgzfIndexWriter* bgzf_iwp, uint32_t* is_csi_ptr, const char** errmsgp);
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
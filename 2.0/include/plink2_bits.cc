@@ -478,6 +478,39 @@ uintptr_t PopcountVecsAvx2(const VecW* bit_vvec, uintptr_t vec_ct) {
   return HsumW(cnt);
 }
 
+#  ifdef USE_AVX512
+uintptr_t PopcountVecsAvx512(const VecW* bit_vvec, uintptr_t vec_ct) {
+  // VPOPCNTQ makes the Harley-Seal carry-save tree unnecessary; two
+  // accumulators are enough to hide its latency.
+  const VecZ* bit_zvec_iter = R_CAST(const VecZ*, bit_vvec);
+  const VecZ* bit_zvec_stop = &(bit_zvec_iter[vec_ct / 2]);
+  VecZ acc0 = vecz_setzero();
+  VecZ acc1 = vecz_setzero();
+  if (vec_ct & 2) {
+    acc0 = vecz_popcnt64(vecz_loadu(bit_zvec_iter++));
+  }
+  while (bit_zvec_iter != bit_zvec_stop) {
+    acc0 = acc0 + vecz_popcnt64(vecz_loadu(bit_zvec_iter++));
+    acc1 = acc1 + vecz_popcnt64(vecz_loadu(bit_zvec_iter++));
+  }
+  if (vec_ct & 1) {
+    acc1 = acc1 + vecz_popcnt64(vecz_loadu_lo(bit_zvec_iter));
+  }
+  return HsumZ(acc0 + acc1);
+}
+
+uintptr_t PopcountVecsAvx512Intersect(const VecW* __restrict vvec1_iter, const VecW* __restrict vvec2_iter, uintptr_t vec_ct) {
+  // vec_ct must be even.
+  const VecZ* zvec1_iter = R_CAST(const VecZ*, vvec1_iter);
+  const VecZ* zvec2_iter = R_CAST(const VecZ*, vvec2_iter);
+  VecZ acc = vecz_setzero();
+  for (uintptr_t zvec_idx = 0; zvec_idx != vec_ct / 2; ++zvec_idx) {
+    acc = acc + vecz_popcnt64(vecz_loadu(&(zvec1_iter[zvec_idx])) & vecz_loadu(&(zvec2_iter[zvec_idx])));
+  }
+  return HsumZ(acc);
+}
+
+#  endif
 uintptr_t PopcountVecsAvx2Intersect(const VecW* __restrict vvec1_iter, const VecW* __restrict vvec2_iter, uintptr_t vec_ct) {
   // See popcnt_avx2() in libpopcnt.  vec_ct must be a multiple of 16.
   VecW cnt = vecw_setzero();
@@ -519,7 +552,11 @@ uintptr_t PopcountWordsIntersect(const uintptr_t* __restrict bitvec1_iter, const
   const uintptr_t block_ct = word_ct / (16 * kWordsPerVec);
   uintptr_t tot = 0;
   if (block_ct) {
+#  ifdef USE_AVX512
+    tot = PopcountVecsAvx512Intersect(R_CAST(const VecW*, bitvec1_iter), R_CAST(const VecW*, bitvec2_iter), block_ct * 16);
+#  else
     tot = PopcountVecsAvx2Intersect(R_CAST(const VecW*, bitvec1_iter), R_CAST(const VecW*, bitvec2_iter), block_ct * 16);
+#  endif
     bitvec1_iter = &(bitvec1_iter[block_ct * (16 * kWordsPerVec)]);
     bitvec2_iter = &(bitvec2_iter[block_ct * (16 * kWordsPerVec)]);
   }
@@ -184,6 +184,11 @@ HEADER_INLINE uintptr_t HsumW(VecW vv) {
 // overhead for vec_ct < 16.
 uintptr_t PopcountVecsAvx2(const VecW* bit_vvec, uintptr_t vec_ct);
 
+#  ifdef USE_AVX512
+// No restrictions on vec_ct.
+uintptr_t PopcountVecsAvx512(const VecW* bit_vvec, uintptr_t vec_ct);
+#  endif
+
 HEADER_INLINE uintptr_t PopcountWords(const uintptr_t* bitvec, uintptr_t word_ct) {
   // Efficiently popcounts bitvec[0..(word_ct - 1)].  In the 64-bit case,
   // bitvec[] must be 16-byte aligned.
@@ -194,7 +199,11 @@ HEADER_INLINE uintptr_t PopcountWords(const uintptr_t* bitvec, uintptr_t word_ct
     assert(VecIsAligned(bitvec));
     const uintptr_t remainder = word_ct % kWordsPerVec;
     const uintptr_t main_block_word_ct = word_ct - remainder;
+#  ifdef USE_AVX512
+    tot = PopcountVecsAvx512(R_CAST(const VecW*, bitvec), main_block_word_ct / kWordsPerVec);
+#  else
     tot = PopcountVecsAvx2(R_CAST(const VecW*, bitvec), main_block_word_ct / kWordsPerVec);
+#  endif
     bitvec = &(bitvec[main_block_word_ct]);
     word_ct = remainder;
   }
@@ -0,0 +1,954 @@
+// This library is part of PLINK 2.00, copyright (C) 2005-2021 Shaun Purcell,
+// Christopher Chang.
+//
+// This library is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <errno.h>
+#include "plink2_gzmt.h"
+
+#ifdef __cplusplus
+namespace plink2 {
+#endif
+
+const char kShortErrGzMtInvalid[] = "invalid deflate data in gzipped file";
+const char kShortErrGzMtTruncated[] = "gzipped file appears to be truncated";
+const char kShortErrGzMtCrc[] = "gzipped file failed CRC check";
+static const char kShortErrGzMtHeader[] = "invalid gzip member header";
+
+// Output-buffer slack: one maximal match, plus the overrun of the 4-symbol
+// copy loop.
+CONSTI32(kGzMtSymSlack, 264);
+// Padding after the compressed bytes, so that GzMtPeek() can always load 8
+// bytes.
+CONSTI32(kGzMtInPad, 16);
+
+CONSTI32(kGzMtLitlenRootBits, 10);
+CONSTI32(kGzMtOffsetRootBits, 8);
+CONSTI32(kGzMtPrecodeRootBits, 7);
+
+// Decoder return values.
+CONSTI32(kGzMtOk, 0);
+CONSTI32(kGzMtInvalid, 1);
+CONSTI32(kGzMtNeedInput, 2);
+CONSTI32(kGzMtNomem, 3);
+
+// Table entries:
+//   direct: (symbol << 16) | codeword length
+//   subtable pointer: (subtable offset << 16) | 0x8000 | (subtable bits << 8)
+//   invalid: symbol 0xffff (out of range for every alphabet), length 0
+static const uint32_t kGzMtInvalidEntry = 0xffff0000U;
+
+static const uint16_t kGzMtLenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const unsigned char kGzMtLenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t kGzMtOffsetBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const unsigned char kGzMtOffsetExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const unsigned char kGzMtPrecodeOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// Returns at least 57 not-yet-consumed bits.
+static inline uint64_t GzMtPeek(const unsigned char* in, uint64_t bitpos) {
+  uint64_t ull;
+  memcpy(&ull, &(in[bitpos / CHAR_BIT]), sizeof(int64_t));
+  return ull >> (bitpos % CHAR_BIT);
+}
+
+static inline uint32_t GzMtDecodeSym(const uint32_t* table, uint32_t root_bits, uint64_t bits, uint32_t* nbitsp) {
+  uint32_t entry = table[bits & ((1U << root_bits) - 1)];
+  uint32_t nbits = 0;
+  if (entry & 0x8000) {
+    nbits = root_bits;
+    entry = table[(entry >> 16) + ((bits >> root_bits) & ((1U << ((entry >> 8) & 15)) - 1))];
+  }
+  *nbitsp = nbits + (entry & 15);
+  return entry >> 16;
+}
+
+// Builds a canonical-Huffman decoding table, applying zlib's validity rules:
+// over-subscribed codes are always rejected, and incomplete codes are only
+// accepted for the litlen and offset alphabets, when there's a single
+// codeword of length 1.  (An empty code is accepted, but every lookup then
+// fails.)
+static BoolErr GzMtBuildTable(const unsigned char* lens, uint32_t sym_ct, uint32_t root_bits, uint32_t table_size, uint32_t is_precode, uint32_t* table) {
+  uint32_t counts[16];
+  memset(counts, 0, 16 * sizeof(int32_t));
+  for (uint32_t sym = 0; sym != sym_ct; ++sym) {
+    counts[lens[sym]] += 1;
+  }
+  counts[0] = 0;
+  uint32_t max_len = 15;
+  while (max_len && (!counts[max_len])) {
+    --max_len;
+  }
+  const uint32_t root_size = 1U << root_bits;
+  if (!max_len) {
+    for (uint32_t uii = 0; uii != root_size; ++uii) {
+      table[uii] = kGzMtInvalidEntry;
+    }
+    return 0;
+  }
+  int32_t left = 1;
+  for (uint32_t len = 1; len != 16; ++len) {
+    left = 2 * left - S_CAST(int32_t, counts[len]);
+    if (left < 0) {
+      return 1;
+    }
+  }
+  if (left) {
+    if (is_precode || (max_len != 1)) {
+      return 1;
+    }
+    for (uint32_t uii = 0; uii != root_size; ++uii) {
+      table[uii] = kGzMtInvalidEntry;
+    }
+  }
+  uint32_t offsets[16];
+  offsets[1] = 0;
+  for (uint32_t len = 1; len != 15; ++len) {
+    offsets[len + 1] = offsets[len] + counts[len];
+  }
+  uint16_t sorted_syms[288];
+  for (uint32_t sym = 0; sym != sym_ct; ++sym) {
+    const uint32_t len = lens[sym];
+    if (len) {
+      sorted_syms[offsets[len]] = sym;
+      offsets[len] += 1;
+    }
+  }
+  uint32_t remaining[16];
+  memcpy(remaining, counts, 16 * sizeof(int32_t));
+  uint32_t next_free = root_size;
+  uint32_t cur_prefix = UINT32_MAX;
+  uint32_t sub_start = 0;
+  uint32_t sub_bits = 0;
+  uint32_t code = 0;
+  const uint16_t* sorted_syms_iter = sorted_syms;
+  for (uint32_t len = 1; len <= max_len; ++len) {
+    for (uint32_t uii = 0; uii != counts[len]; ++uii, ++code) {
+      const uint32_t sym = *sorted_syms_iter++;
+      // Deflate codewords are packed starting from their most significant
+      // bit.
+      uint32_t rev = 0;
+      for (uint32_t bit_idx = 0; bit_idx != len; ++bit_idx) {
+        rev |= ((code >> bit_idx) & 1) << (len - 1 - bit_idx);
+      }
+      if (len <= root_bits) {
+        const uint32_t entry = (sym << 16) | len;
+        for (uint32_t table_idx = rev; table_idx < root_size; table_idx += 1U << len) {
+          table[table_idx] = entry;
+        }
+      } else {
+        const uint32_t prefix = rev & (root_size - 1);
+        if (prefix != cur_prefix) {
+          // Same subtable-size logic as zlib's inflate_table().
+          uint32_t cur_bits = len - root_bits;
+          int32_t sub_left = 1 << cur_bits;
+          while (cur_bits + root_bits < max_len) {
+            sub_left -= remaining[cur_bits + root_bits];
+            if (sub_left <= 0) {
+              break;
+            }
+            ++cur_bits;
+            sub_left *= 2;
+          }
+          if (next_free + (1U << cur_bits) > table_size) {
+            return 1;
+          }
+          sub_start = next_free;
+          sub_bits = cur_bits;
+          next_free += 1U << cur_bits;
+          table[prefix] = (sub_start << 16) | 0x8000 | (cur_bits << 8);
+          cur_prefix = prefix;
+        }
+        const uint32_t sub_len = len - root_bits;
+        const uint32_t entry = (sym << 16) | sub_len;
+        for (uint32_t table_idx = rev >> root_bits; table_idx < (1U << sub_bits); table_idx += 1U << sub_len) {
+          table[sub_start + table_idx] = entry;
+        }
+      }
+      remaining[len] -= 1;
+    }
+    code *= 2;
+  }
+  return 0;
+}
+
+static void GzMtBuildFixedTables(GzMtInflateTables* fixed_tables) {
+  unsigned char lens[288];
+  memset(lens, 8, 144);
+  memset(&(lens[144]), 9, 112);
+  memset(&(lens[256]), 7, 24);
+  memset(&(lens[280]), 8, 8);
+  // Can't fail.
+  GzMtBuildTable(lens, 288, kGzMtLitlenRootBits, kGzMtLitlenTableSize, 0, fixed_tables->litlen);
+  memset(lens, 5, 32);
+  GzMtBuildTable(lens, 32, kGzMtOffsetRootBits, kGzMtOffsetTableSize, 0, fixed_tables->offset);
+}
+
+// Output cursor.  Symbols before out_start are the window prefix.
+typedef struct GzMtOutStruct {
+  GzMtChunk* chunkp;
+  uint16_t* out_start;
+  uint16_t* out_iter;
+  uint16_t* out_limit;
+  uint32_t window_avail;
+} GzMtOut;
+
+static BoolErr GzMtGrowOut(GzMtOut* outp) {
+  GzMtChunk* chunkp = outp->chunkp;
+  const uintptr_t new_capacity = chunkp->sym_capacity * 2;
+  uint16_t* new_syms = S_CAST(uint16_t*, realloc(chunkp->syms, (kDeflateWindowSize + new_capacity + kGzMtSymSlack) * sizeof(int16_t)));
+  if (!new_syms) {
+    return 1;
+  }
+  const uintptr_t out_ct = outp->out_iter - outp->out_start;
+  chunkp->syms = new_syms;
+  chunkp->sym_capacity = new_capacity;
+  outp->out_start = &(new_syms[kDeflateWindowSize]);
+  outp->out_iter = &(outp->out_start[out_ct]);
+  outp->out_limit = &(outp->out_start[new_capacity]);
+  return 0;
+}
+
+static inline uint32_t IsGzMtTextByte(uint32_t sym) {
+  return ((sym - 32) < 95) || (sym == '\t') || (sym == '\n') || (sym == '\r');
+}
+
+// *bitposp must point just past the block type.
+static uint32_t GzMtReadDynamicHeader(const unsigned char* in, uint64_t in_bitlen, uint64_t* bitposp, GzMtInflateTables* tables) {
+  uint64_t bitpos = *bitposp;
+  uint64_t bits = GzMtPeek(in, bitpos);
+  const uint32_t litlen_ct = 257 + (bits & 31);
+  const uint32_t offset_ct = 1 + ((bits >> 5) & 31);
+  const uint32_t precode_ct = 4 + ((bits >> 10) & 15);
+  if ((litlen_ct > 286) || (offset_ct > 30)) {
+    return kGzMtInvalid;
+  }
+  bitpos += 14;
+  bits = GzMtPeek(in, bitpos);
+  unsigned char precode_lens[19];
+  memset(precode_lens, 0, 19);
+  for (uint32_t uii = 0; uii != precode_ct; ++uii) {
+    precode_lens[kGzMtPrecodeOrder[uii]] = (bits >> (3 * uii)) & 7;
+  }
+  bitpos += 3 * precode_ct;
+  if (bitpos > in_bitlen) {
+    return kGzMtNeedInput;
+  }
+  if (GzMtBuildTable(precode_lens, 19, kGzMtPrecodeRootBits, kGzMtPrecodeTableSize, 1, tables->precode)) {
+    return kGzMtInvalid;
+  }
+  unsigned char lens[286 + 30];
+  const uint32_t len_ct = litlen_ct + offset_ct;
+  uint32_t len_idx = 0;
+  while (len_idx < len_ct) {
+    if (bitpos > in_bitlen) {
+      return kGzMtNeedInput;
+    }
+    bits = GzMtPeek(in, bitpos);
+    const uint32_t entry = tables->precode[bits & ((1U << kGzMtPrecodeRootBits) - 1)];
+    const uint32_t sym = entry >> 16;
+    if (sym > 18) {
+      return kGzMtInvalid;
+    }
+    const uint32_t nbits = entry & 15;
+    bitpos += nbits;
+    bits >>= nbits;
+    if (sym < 16) {
+      lens[len_idx++] = sym;
+      continue;
+    }
+    uint32_t rep_ct;
+    unsigned char rep_val = 0;
+    if (sym == 16) {
+      if (!len_idx) {
+        return kGzMtInvalid;
+      }
+      rep_val = lens[len_idx - 1];
+      rep_ct = 3 + (bits & 3);
+      bitpos += 2;
+    } else if (sym == 17) {
+      rep_ct = 3 + (bits & 7);
+      bitpos += 3;
+    } else {
+      rep_ct = 11 + (bits & 127);
+      bitpos += 7;
+    }
+    if (len_idx + rep_ct > len_ct) {
+      return kGzMtInvalid;
+    }
+    memset(&(lens[len_idx]), rep_val, rep_ct);
+    len_idx += rep_ct;
+  }
+  if (bitpos > in_bitlen) {
+    return kGzMtNeedInput;
+  }
+  // Must be able to end the block.
+  if ((!lens[256]) ||
+      GzMtBuildTable(lens, litlen_ct, kGzMtLitlenRootBits, kGzMtLitlenTableSize, 0, tables->litlen) ||
+      GzMtBuildTable(&(lens[litlen_ct]), offset_ct, kGzMtOffsetRootBits, kGzMtOffsetTableSize, 0, tables->offset)) {
+    return kGzMtInvalid;
+  }
+  *bitposp = bitpos;
+  return kGzMtOk;
+}
+
+// Decodes symbols through end-of-block.  If text_check is set, all literals
+// must be printable ASCII, tab, CR, or LF.
+static uint32_t GzMtInflateHuffman(const unsigned char* in, uint64_t in_bitlen, const uint32_t* litlen_table, const uint32_t* offset_table, uint32_t text_check, uint64_t* bitposp, GzMtOut* outp) {
+  uint64_t bitpos = *bitposp;
+  uint16_t* out_iter = outp->out_iter;
+  uint16_t* out_limit = outp->out_limit;
+  const uintptr_t window_avail = outp->window_avail;
+  while (1) {
+    if (unlikely(bitpos > in_bitlen)) {
+      return kGzMtNeedInput;
+    }
+    if (unlikely(out_iter >= out_limit)) {
+      outp->out_iter = out_iter;
+      if (GzMtGrowOut(outp)) {
+        return kGzMtNomem;
+      }
+      out_iter = outp->out_iter;
+      out_limit = outp->out_limit;
+    }
+    uint64_t bits = GzMtPeek(in, bitpos);
+    uint32_t nbits;
+    const uint32_t litlen_sym = GzMtDecodeSym(litlen_table, kGzMtLitlenRootBits, bits, &nbits);
+    if (litlen_sym < 256) {
+      if (text_check && (!IsGzMtTextByte(litlen_sym))) {
+        return kGzMtInvalid;
+      }
+      *out_iter++ = litlen_sym;
+      bitpos += nbits;
+      continue;
+    }
+    if (litlen_sym == 256) {
+      bitpos += nbits;
+      break;
+    }
+    if (litlen_sym > 285) {
+      return kGzMtInvalid;
+    }
+    // At most 15 + 5 + 15 + 13 = 48 bits for the whole match.
+    bits >>= nbits;
+    uint32_t consumed_bit_ct = nbits;
+    const uint32_t len_code = litlen_sym - 257;
+    const uint32_t len_extra_bit_ct = kGzMtLenExtra[len_code];
+    const uint32_t match_len = kGzMtLenBase[len_code] + (bits & ((1U << len_extra_bit_ct) - 1));
+    bits >>= len_extra_bit_ct;
+    consumed_bit_ct += len_extra_bit_ct;
+    const uint32_t offset_sym = GzMtDecodeSym(offset_table, kGzMtOffsetRootBits, bits, &nbits);
+    if (offset_sym > 29) {
+      return kGzMtInvalid;
+    }
+    bits >>= nbits;
+    consumed_bit_ct += nbits;
+    const uint32_t offset_extra_bit_ct = kGzMtOffsetExtra[offset_sym];
+    const uintptr_t offset = kGzMtOffsetBase[offset_sym] + (bits & ((1U << offset_extra_bit_ct) - 1));
+    bitpos += consumed_bit_ct + offset_extra_bit_ct;
+    if (offset > S_CAST(uintptr_t, out_iter - outp->out_start) + window_avail) {
+      return kGzMtInvalid;
+    }
+    const uint16_t* src = &(out_iter[-S_CAST(intptr_t, offset)]);
+    uint16_t* copy_end = &(out_iter[match_len]);
+    if (offset >= 4) {
+      do {
+        memcpy(out_iter, src, 4 * sizeof(int16_t));
+        out_iter = &(out_iter[4]);
+        src = &(src[4]);
+      } while (out_iter < copy_end);
+    } else {
+      do {
+        *out_iter++ = *src++;
+      } while (out_iter < copy_end);
+    }
+    out_iter = copy_end;
+  }
+  if (unlikely(bitpos > in_bitlen)) {
+    // End-of-block code was (partly) read from the padding.
+    return kGzMtNeedInput;
+  }
+  outp->out_iter = out_iter;
+  *bitposp = bitpos;
+  return kGzMtOk;
+}
+
+// *bitposp must point just past the block type.
+static uint32_t GzMtInflateStored(const unsigned char* in, uint64_t in_bitlen, uint64_t* bitposp, GzMtOut* outp) {
+  const uintptr_t in_size = in_bitlen / CHAR_BIT;
+  const uintptr_t byte_pos = DivUp(*bitposp, CHAR_BIT);
+  if (byte_pos + 4 > in_size) {
+    return kGzMtNeedInput;
+  }
+  const uint32_t len = in[byte_pos] | (S_CAST(uint32_t, in[byte_pos + 1]) << 8);
+  const uint32_t nlen = in[byte_pos + 2] | (S_CAST(uint32_t, in[byte_pos + 3]) << 8);
+  if (len != (nlen ^ 0xffff)) {
+    return kGzMtInvalid;
+  }
+  if (byte_pos + 4 + len > in_size) {
+    return kGzMtNeedInput;
+  }
+  while (S_CAST(uintptr_t, outp->out_limit - outp->out_iter) < len) {
+    if (GzMtGrowOut(outp)) {
+      return kGzMtNomem;
+    }
+  }
+  const unsigned char* src = &(in[byte_pos + 4]);
+  uint16_t* out_iter = outp->out_iter;
+  for (uint32_t uii = 0; uii != len; ++uii) {
+    out_iter[uii] = src[uii];
+  }
+  outp->out_iter = &(out_iter[len]);
+  *bitposp = (byte_pos + 4 + len) * CHAR_BIT;
+  return kGzMtOk;
+}
+
+// Decodes one block starting at *bitposp.  On success, *bitposp is advanced
+// past it.  On failure, the output cursor may have moved.
+static uint32_t GzMtInflateBlock(const unsigned char* in, uint64_t in_bitlen, uint32_t text_check, const GzMtInflateTables* fixed_tables, GzMtInflateTables* tables, uint64_t* bitposp, uint32_t* is_finalp, GzMtOut* outp) {
+  uint64_t bitpos = *bitposp;
+  if (bitpos + 3 > in_bitlen) {
+    return kGzMtNeedInput;
+  }
+  const uint32_t block_header = GzMtPeek(in, bitpos) & 7;
+  *is_finalp = block_header & 1;
+  bitpos += 3;
+  const uint32_t block_type = block_header >> 1;
+  uint32_t retval;
+  if (block_type == 2) {
+    retval = GzMtReadDynamicHeader(in, in_bitlen, &bitpos, tables);
+    if (retval) {
+      return retval;
+    }
+    retval = GzMtInflateHuffman(in, in_bitlen, tables->litlen, tables->offset, text_check, &bitpos, outp);
+  } else if (block_type == 1) {
+    retval = GzMtInflateHuffman(in, in_bitlen, fixed_tables->litlen, fixed_tables->offset, text_check, &bitpos, outp);
+  } else if (block_type == 0) {
+    retval = GzMtInflateStored(in, in_bitlen, &bitpos, outp);
+  } else {
+    return kGzMtInvalid;
+  }
+  if (!retval) {
+    *bitposp = bitpos;
+  }
+  return retval;
+}
+
+static void GzMtDecodeChunk(const GzRawMtDecompressStream* gzmtp, const GzMtInflateTables* fixed_tables, uint32_t is_first, GzMtInflateTables* tables, GzMtChunk* chunkp) {
+  const unsigned char* in = gzmtp->in;
+  const uint64_t in_bitlen = S_CAST(uint64_t, gzmtp->in_size) * CHAR_BIT;
+  const uint64_t stop_bitpos = chunkp->stop_bitpos;
+  chunkp->status = kGzMtChunkFail;
+  chunkp->nomem = 0;
+  chunkp->sym_ct = 0;
+  uint16_t* prefix = chunkp->syms;
+  GzMtOut out;
+  out.chunkp = chunkp;
+  out.out_start = &(prefix[kDeflateWindowSize]);
+  out.out_iter = out.out_start;
+  out.out_limit = &(out.out_start[chunkp->sym_capacity]);
+  uint64_t bitpos = chunkp->search_bitpos;
+  uint32_t is_final = 0;
+  uint32_t retval;
+  if (is_first) {
+    // Exact decode, with the real window.
+    const uint32_t window_len = gzmtp->window_len;
+    const unsigned char* window = gzmtp->window;
+    for (uint32_t uii = kDeflateWindowSize - window_len; uii != kDeflateWindowSize; ++uii) {
+      prefix[uii] = window[uii];
+    }
+    out.window_avail = window_len;
+    chunkp->start_bitpos = bitpos;
+    retval = GzMtInflateBlock(in, in_bitlen, 0, fixed_tables, tables, &bitpos, &is_final, &out);
+  } else {
+    // Window symbol k stands for the kth byte of the (unknown) window.
+    for (uint32_t uii = 0; uii != kDeflateWindowSize; ++uii) {
+      prefix[uii] = 256 + uii;
+    }
+    out.window_avail = kDeflateWindowSize;
+    // Find the first position where a non-final dynamic-Huffman block header
+    // is followed by a valid block with text-like literals.
+    while (1) {
+      if ((bitpos >= stop_bitpos) || (bitpos + 17 > in_bitlen)) {
+        return;
+      }
+      const uint64_t bits = GzMtPeek(in, bitpos);
+      if (((bits & 7) == 4) && (((bits >> 3) & 31) < 30) && (((bits >> 8) & 31) < 30)) {
+        uint64_t block_end = bitpos;
+        retval = GzMtInflateBlock(in, in_bitlen, 1, fixed_tables, tables, &block_end, &is_final, &out);
+        if (!retval) {
+          chunkp->start_bitpos = bitpos;
+          bitpos = block_end;
+          break;
+        }
+        if (retval == kGzMtNomem) {
+          chunkp->nomem = 1;
+          return;
+        }
+        out.out_iter = out.out_start;
+      }
+      ++bitpos;
+    }
+  }
+  while (1) {
+    if (retval) {
+      if (retval == kGzMtNeedInput) {
+        chunkp->status = kGzMtChunkIncomplete;
+        break;
+      }
+      chunkp->nomem = (retval == kGzMtNomem);
+      return;
+    }
+    if (is_final) {
+      chunkp->status = kGzMtChunkMemberEnd;
+      break;
+    }
+    if (bitpos >= stop_bitpos) {
+      chunkp->status = kGzMtChunkBoundary;
+      break;
+    }
+    const uintptr_t block_sym_start = out.out_iter - out.out_start;
+    retval = GzMtInflateBlock(in, in_bitlen, 0, fixed_tables, tables, &bitpos, &is_final, &out);
+    if (retval) {
+      // Roll back the partial block.
+      out.out_iter = &(out.out_start[block_sym_start]);
+    }
+  }
+  chunkp->end_bitpos = bitpos;
+  chunkp->sym_ct = out.out_iter - out.out_start;
+}
+
+THREAD_FUNC_DECL GzRawMtStreamThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  GzRawMtDecompressStream* context = S_CAST(GzRawMtDecompressStream*, arg->sharedp->context);
+  const uint32_t tidx = arg->tidx;
+  const uint32_t thread_ct = GetThreadCt(arg->sharedp);
+  GzMtInflateTables* tables = &(context->tables[tidx]);
+  const GzMtInflateTables* fixed_tables = &(context->tables[thread_ct]);
+  do {
+    const uint32_t parity = context->worker_parity;
+    if (tidx < context->batch_chunk_cts[parity]) {
+      GzMtDecodeChunk(context, fixed_tables, (tidx == 0), tables, &(context->chunks[parity * thread_ct + tidx]));
+    }
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+static void GzMtResolve(const uint16_t* syms, const unsigned char* window, uintptr_t ct, unsigned char* dst) {
+  for (uintptr_t ulii = 0; ulii != ct; ++ulii) {
+    const uint32_t sym = syms[ulii];
+    dst[ulii] = (sym < 256)? sym : window[sym - 256];
+  }
+}
+
+// Loads compressed bytes until in_size >= target_size (capped at in_capacity)
+// or EOF.
+static PglErr GzMtFill(uintptr_t target_size, GzRawMtDecompressStream* gzmtp, const char** errmsgp) {
+  if (target_size > gzmtp->in_capacity) {
+    target_size = gzmtp->in_capacity;
+  }
+  uintptr_t in_size = gzmtp->in_size;
+  if ((!gzmtp->in_eof) && (in_size < target_size)) {
+    in_size += fread_unlocked(&(gzmtp->in[in_size]), 1, target_size - in_size, gzmtp->ff);
+    if (in_size < target_size) {
+      if (unlikely(ferror_unlocked(gzmtp->ff))) {
+        *errmsgp = strerror(errno);
+        return kPglRetReadFail;
+      }
+      gzmtp->in_eof = 1;
+    }
+    gzmtp->in_size = in_size;
+  }
+  memset(&(gzmtp->in[in_size]), 0, kGzMtInPad);
+  return kPglRetSuccess;
+}
+
+static void GzMtDiscard(uintptr_t byte_ct, GzRawMtDecompressStream* gzmtp) {
+  const uintptr_t remaining_ct = gzmtp->in_size - byte_ct;
+  memmove(gzmtp->in, &(gzmtp->in[byte_ct]), remaining_ct);
+  gzmtp->in_size = remaining_ct;
+}
+
+static uint32_t GzMtParseMemberHeader(const unsigned char* buf, uintptr_t size, uintptr_t* header_blenp) {
+  if (size < 10) {
+    return kGzMtNeedInput;
+  }
+  // ID1, ID2, CM=deflate, reserved flag bits unset
+  if ((buf[0] != 0x1f) || (buf[1] != 0x8b) || (buf[2] != 8) || (buf[3] & 0xe0)) {
+    return kGzMtInvalid;
+  }
+  const uint32_t flags = buf[3];
+  uintptr_t pos = 10;
+  if (flags & 4) {
+    // FEXTRA
+    if (pos + 2 > size) {
+      return kGzMtNeedInput;
+    }
+    pos += 2 + (buf[pos] | (S_CAST(uint32_t, buf[pos + 1]) << 8));
+  }
+  // FNAME, FCOMMENT
+  for (uint32_t flag = 8; flag != 32; flag *= 2) {
+    if (flags & flag) {
+      if (pos >= size) {
+        return kGzMtNeedInput;
+      }
+      const unsigned char* terminator = S_CAST(const unsigned char*, memchr(&(buf[pos]), 0, size - pos));
+      if (!terminator) {
+        return kGzMtNeedInput;
+      }
+      pos = terminator + 1 - buf;
+    }
+  }
+  if (flags & 2) {
+    // FHCRC
+    pos += 2;
+  }
+  if (pos > size) {
+    return kGzMtNeedInput;
+  }
+  *header_blenp = pos;
+  return kGzMtOk;
+}
+
+// Lays out the next batch in the parity-side chunk slots; threads must be
+// idle.  If new_member is set, in[0] must be the start of a gzip member (or
+// EOF); otherwise, decoding resumes at bit start_bit of in[0].  Sets
+// batch_chunk_cts[parity] to zero at clean EOF.
+static PglErr GzMtStartBatch(uint32_t parity, uint32_t new_member, uint32_t start_bit, GzRawMtDecompressStream* gzmtp, const char** errmsgp) {
+  const uint32_t thread_ct = GetThreadCtTg(&gzmtp->tg);
+  const uint32_t single_chunk = gzmtp->single_chunk;
+  uint32_t chunk_ct = single_chunk? 1 : thread_ct;
+  const uintptr_t chunk_csize = gzmtp->chunk_csize;
+  const uintptr_t target_size = single_chunk? gzmtp->in_capacity : (chunk_ct * chunk_csize + kGzMtLookahead);
+  PglErr reterr = GzMtFill(target_size, gzmtp, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (new_member) {
+    if (!gzmtp->in_size) {
+      gzmtp->batch_chunk_cts[parity] = 0;
+      return kPglRetSuccess;
+    }
+    uintptr_t header_blen;
+    uint32_t retval = GzMtParseMemberHeader(gzmtp->in, gzmtp->in_size, &header_blen);
+    if (retval == kGzMtNeedInput) {
+      reterr = GzMtFill(gzmtp->in_capacity, gzmtp, errmsgp);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+      retval = GzMtParseMemberHeader(gzmtp->in, gzmtp->in_size, &header_blen);
+    }
+    if (unlikely(retval)) {
+      *errmsgp = ((retval == kGzMtNeedInput) && gzmtp->in_eof)? kShortErrGzMtTruncated : kShortErrGzMtHeader;
+      return kPglRetDecompressFail;
+    }
+    GzMtDiscard(header_blen, gzmtp);
+    gzmtp->window_len = 0;
+    reterr = GzMtFill(target_size, gzmtp, errmsgp);
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+  }
+  // The last chunk runs to the end of the buffer when that's the end of the
+  // file, or when we're recovering from a block that didn't fit.
+  uint32_t last_chunk_unbounded = single_chunk;
+  if (gzmtp->in_eof) {
+    const uintptr_t full_chunk_ct = gzmtp->in_size / chunk_csize;
+    if (chunk_ct >= full_chunk_ct) {
+      chunk_ct = MAXV(full_chunk_ct, 1);
+      last_chunk_unbounded = 1;
+    }
+  }
+  GzMtChunk* chunks = &(gzmtp->chunks[parity * thread_ct]);
+  const uint64_t chunk_cbit_ct = S_CAST(uint64_t, chunk_csize) * CHAR_BIT;
+  for (uint32_t chunk_idx = 0; chunk_idx != chunk_ct; ++chunk_idx) {
+    GzMtChunk* chunkp = &(chunks[chunk_idx]);
+    chunkp->search_bitpos = chunk_idx? (chunk_idx * chunk_cbit_ct) : start_bit;
+    chunkp->stop_bitpos = (chunk_idx + 1) * chunk_cbit_ct;
+    chunkp->member_end = 0;
+  }
+  if (last_chunk_unbounded) {
+    chunks[chunk_ct - 1].stop_bitpos = ~0LLU;
+  }
+  gzmtp->single_chunk = 0;
+  gzmtp->batch_chunk_cts[parity] = chunk_ct;
+  return kPglRetSuccess;
+}
+
+// Waits for the in-flight batch, accepts the longest prefix of its chunks
+// that join up, makes that the part being consumed, and starts the next
+// batch (if any).
+static PglErr GzMtJoinAndRespawn(GzRawMtDecompressStream* gzmtp, const char** errmsgp) {
+  ThreadGroup* tgp = &gzmtp->tg;
+  JoinThreads(tgp);
+  gzmtp->unjoined = 0;
+  const uint32_t thread_ct = GetThreadCtTg(tgp);
+  const uint32_t parity = gzmtp->worker_parity;
+  GzMtChunk* chunks = &(gzmtp->chunks[parity * thread_ct]);
+  if (unlikely(chunks[0].status == kGzMtChunkFail)) {
+    if (chunks[0].nomem) {
+      return kPglRetNomem;
+    }
+    *errmsgp = kShortErrGzMtInvalid;
+    return kPglRetDecompressFail;
+  }
+  const uint32_t chunk_ct = gzmtp->batch_chunk_cts[parity];
+  uint32_t accepted_ct = 1;
+  for (; accepted_ct != chunk_ct; ++accepted_ct) {
+    const GzMtChunk* prev_chunkp = &(chunks[accepted_ct - 1]);
+    const GzMtChunk* cur_chunkp = &(chunks[accepted_ct]);
+    if ((prev_chunkp->status != kGzMtChunkBoundary) || (cur_chunkp->status == kGzMtChunkFail) || (cur_chunkp->start_bitpos != prev_chunkp->end_bitpos)) {
+      break;
+    }
+  }
+  // Thread the window through the accepted chunks.
+  unsigned char* window = gzmtp->window;
+  uintptr_t sym_tot = 0;
+  for (uint32_t chunk_idx = 0; chunk_idx != accepted_ct; ++chunk_idx) {
+    GzMtChunk* chunkp = &(chunks[chunk_idx]);
+    memcpy(chunkp->window, window, kDeflateWindowSize);
+    const uintptr_t sym_ct = chunkp->sym_ct;
+    const uint16_t* out_syms = &(chunkp->syms[kDeflateWindowSize]);
+    if (sym_ct >= kDeflateWindowSize) {
+      GzMtResolve(&(out_syms[sym_ct - kDeflateWindowSize]), chunkp->window, kDeflateWindowSize, window);
+    } else {
+      memmove(window, &(window[sym_ct]), kDeflateWindowSize - sym_ct);
+      GzMtResolve(out_syms, chunkp->window, sym_ct, &(window[kDeflateWindowSize - sym_ct]));
+    }
+    sym_tot += sym_ct;
+  }
+  gzmtp->window_len = MINV(gzmtp->window_len + sym_tot, kDeflateWindowSize);
+  GzMtChunk* last_chunkp = &(chunks[accepted_ct - 1]);
+  const uint64_t cbit_ct = last_chunkp->end_bitpos - chunks[0].start_bitpos;
+  if (sym_tot >= kGzMtChunkTargetBlen / 8) {
+    // Adapt chunk size to the observed compression ratio.
+    uint64_t new_chunk_csize = (kGzMtChunkTargetBlen * cbit_ct) / (sym_tot * CHAR_BIT);
+    if (new_chunk_csize < kGzMtMinChunkCsize) {
+      new_chunk_csize = kGzMtMinChunkCsize;
+    } else if (new_chunk_csize > kGzMtMaxChunkCsize) {
+      new_chunk_csize = kGzMtMaxChunkCsize;
+    }
+    gzmtp->chunk_csize = new_chunk_csize;
+  }
+  gzmtp->consume_parity = parity;
+  gzmtp->consume_chunk_idx = 0;
+  gzmtp->consume_chunk_end = accepted_ct;
+  gzmtp->consume_pos = 0;
+
+  uint64_t next_bitpos = last_chunkp->end_bitpos;
+  const uint32_t new_member = (last_chunkp->status == kGzMtChunkMemberEnd);
+  if (new_member) {
+    next_bitpos = RoundUpPow2(next_bitpos, CHAR_BIT);
+  } else if (!cbit_ct) {
+    // Couldn't finish a single block.
+    if (unlikely(gzmtp->in_eof)) {
+      *errmsgp = kShortErrGzMtTruncated;
+      return kPglRetDecompressFail;
+    }
+    const uintptr_t new_capacity = gzmtp->in_capacity * 2;
+    unsigned char* new_in = S_CAST(unsigned char*, realloc(gzmtp->in, new_capacity + kGzMtInPad));
+    if (unlikely(!new_in)) {
+      return kPglRetNomem;
+    }
+    gzmtp->in = new_in;
+    gzmtp->in_capacity = new_capacity;
+    gzmtp->single_chunk = 1;
+  }
+  GzMtDiscard(next_bitpos / CHAR_BIT, gzmtp);
+  if (new_member) {
+    PglErr reterr = GzMtFill(8, gzmtp, errmsgp);
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+    if (unlikely(gzmtp->in_size < 8)) {
+      *errmsgp = kShortErrGzMtTruncated;
+      return kPglRetDecompressFail;
+    }
+    memcpy(&(last_chunkp->member_crc), gzmtp->in, sizeof(int32_t));
+    memcpy(&(last_chunkp->member_isize), &(gzmtp->in[4]), sizeof(int32_t));
+    last_chunkp->member_end = 1;
+    GzMtDiscard(8, gzmtp);
+  }
+  PglErr reterr = GzMtStartBatch(1 - parity, new_member, next_bitpos % CHAR_BIT, gzmtp, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (gzmtp->batch_chunk_cts[1 - parity]) {
+    gzmtp->worker_parity = 1 - parity;
+    if (unlikely(SpawnThreads(tgp))) {
+      return kPglRetThreadCreateFail;
+    }
+    gzmtp->unjoined = 1;
+  }
+  return kPglRetSuccess;
+}
+
+void PreinitGzRawMtStream(GzRawMtDecompressStream* gzmtp) {
+  PreinitThreads(&gzmtp->tg);
+  gzmtp->in = nullptr;
+  gzmtp->window = nullptr;
+  gzmtp->tables = nullptr;
+  gzmtp->chunks = nullptr;
+  gzmtp->unjoined = 0;
+}
+
+// Assumes threads are joined, and ff points to the start of the file (or
+// the first in_size bytes have been loaded).
+static PglErr GzMtStart(GzRawMtDecompressStream* gzmtp, const char** errmsgp) {
+  gzmtp->in_eof = 0;
+  gzmtp->single_chunk = 0;
+  gzmtp->window_len = 0;
+  memset(gzmtp->window, 0, kDeflateWindowSize);
+  gzmtp->consume_chunk_idx = 0;
+  gzmtp->consume_chunk_end = 0;
+  gzmtp->consume_pos = 0;
+  gzmtp->crc = 0;
+  gzmtp->isize = 0;
+  PglErr reterr = GzMtStartBatch(0, 1, 0, gzmtp, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (gzmtp->batch_chunk_cts[0]) {
+    gzmtp->worker_parity = 0;
+    if (unlikely(SpawnThreads(&gzmtp->tg))) {
+      return kPglRetThreadCreateFail;
+    }
+    gzmtp->unjoined = 1;
+  }
+  return kPglRetSuccess;
+}
+
+PglErr GzRawMtStreamInit(const char* header, uint32_t header_blen, uint32_t decompress_thread_ct, FILE* ff, GzRawMtDecompressStream* gzmtp, const char** errmsgp) {
+  PreinitGzRawMtStream(gzmtp);
+  gzmtp->ff = ff;
+  const uint32_t thread_ct = MINV(decompress_thread_ct, kMaxGzDecompressThreads);
+  if (unlikely(SetThreadCt(thread_ct, &gzmtp->tg))) {
+    return kPglRetNomem;
+  }
+  const uint32_t slot_ct = 2 * thread_ct;
+  gzmtp->in_capacity = thread_ct * kGzMtMaxChunkCsize + kGzMtLookahead;
+  gzmtp->in = S_CAST(unsigned char*, malloc(gzmtp->in_capacity + kGzMtInPad));
+  gzmtp->window = S_CAST(unsigned char*, malloc(kDeflateWindowSize));
+  gzmtp->tables = S_CAST(GzMtInflateTables*, malloc((thread_ct + 1) * sizeof(GzMtInflateTables)));
+  // Chunk structs, followed by their windows.
+  gzmtp->chunks = S_CAST(GzMtChunk*, malloc(slot_ct * (sizeof(GzMtChunk) + kDeflateWindowSize)));
+  if (unlikely((!gzmtp->in) || (!gzmtp->window) || (!gzmtp->tables) || (!gzmtp->chunks))) {
+    return kPglRetNomem;
+  }
+  unsigned char* chunk_windows = R_CAST(unsigned char*, &(gzmtp->chunks[slot_ct]));
+  for (uint32_t slot_idx = 0; slot_idx != slot_ct; ++slot_idx) {
+    gzmtp->chunks[slot_idx].syms = nullptr;
+    gzmtp->chunks[slot_idx].window = &(chunk_windows[slot_idx * S_CAST(uintptr_t, kDeflateWindowSize)]);
+  }
+  const uintptr_t initial_sym_capacity = kGzMtChunkTargetBlen + kGzMtChunkTargetBlen / 4;
+  for (uint32_t slot_idx = 0; slot_idx != slot_ct; ++slot_idx) {
+    GzMtChunk* chunkp = &(gzmtp->chunks[slot_idx]);
+    chunkp->syms = S_CAST(uint16_t*, malloc((kDeflateWindowSize + initial_sym_capacity + kGzMtSymSlack) * sizeof(int16_t)));
+    if (unlikely(!chunkp->syms)) {
+      return kPglRetNomem;
+    }
+    chunkp->sym_capacity = initial_sym_capacity;
+  }
+  GzMtBuildFixedTables(&(gzmtp->tables[thread_ct]));
+  memcpy(gzmtp->in, header, header_blen);
+  gzmtp->in_size = header_blen;
+  // Initial guess: 8x compression ratio.
+  gzmtp->chunk_csize = kGzMtChunkTargetBlen / 8;
+  SetThreadFuncAndData(GzRawMtStreamThread, gzmtp, &gzmtp->tg);
+  return GzMtStart(gzmtp, errmsgp);
+}
+
+PglErr GzRawMtStreamRead(unsigned char* dst_end, GzRawMtDecompressStream* gzmtp, unsigned char** dst_iterp, const char** errmsgp) {
+  unsigned char* dst_iter = *dst_iterp;
+  const uint32_t thread_ct = GetThreadCtTg(&gzmtp->tg);
+  PglErr reterr = kPglRetSuccess;
+  while (1) {
+    if (gzmtp->consume_chunk_idx != gzmtp->consume_chunk_end) {
+      GzMtChunk* chunkp = &(gzmtp->chunks[gzmtp->consume_parity * thread_ct + gzmtp->consume_chunk_idx]);
+      const uintptr_t consume_pos = gzmtp->consume_pos;
+      uintptr_t cur_ct = chunkp->sym_ct - consume_pos;
+      const uintptr_t dst_capacity = dst_end - dst_iter;
+      if (cur_ct > dst_capacity) {
+        cur_ct = dst_capacity;
+      }
+      GzMtResolve(&(chunkp->syms[kDeflateWindowSize + consume_pos]), chunkp->window, cur_ct, dst_iter);
+      gzmtp->crc = libdeflate_crc32(gzmtp->crc, dst_iter, cur_ct);
+      gzmtp->isize += cur_ct;
+      dst_iter = &(dst_iter[cur_ct]);
+      if (consume_pos + cur_ct != chunkp->sym_ct) {
+        gzmtp->consume_pos = consume_pos + cur_ct;
+        break;
+      }
+      if (chunkp->member_end) {
+        if (unlikely((gzmtp->crc != chunkp->member_crc) || (gzmtp->isize != chunkp->member_isize))) {
+          *errmsgp = kShortErrGzMtCrc;
+          reterr = kPglRetDecompressFail;
+          break;
+        }
+        gzmtp->crc = 0;
+        gzmtp->isize = 0;
+      }
+      gzmtp->consume_chunk_idx += 1;
+      gzmtp->consume_pos = 0;
+      if (dst_iter == dst_end) {
+        break;
+      }
+      continue;
+    }
+    if (!gzmtp->unjoined) {
+      // eof
+      break;
+    }
+    reterr = GzMtJoinAndRespawn(gzmtp, errmsgp);
+    if (unlikely(reterr)) {
+      break;
+    }
+  }
+  *dst_iterp = dst_iter;
+  return reterr;
+}
+
+PglErr GzRawMtStreamRewind(GzRawMtDecompressStream* gzmtp, const char** errmsgp) {
+  if (gzmtp->unjoined) {
+    JoinThreads(&gzmtp->tg);
+    gzmtp->unjoined = 0;
+  }
+  if (unlikely(fseeko(gzmtp->ff, 0, SEEK_SET))) {
+    return kPglRetRewindFail;
+  }
+  gzmtp->in_size = 0;
+  return GzMtStart(gzmtp, errmsgp);
+}
+
+void CleanupGzRawMtStream(GzRawMtDecompressStream* gzmtp) {
+  const uint32_t slot_ct = 2 * GetThreadCtTg(&gzmtp->tg);
+  CleanupThreads(&gzmtp->tg);
+  gzmtp->unjoined = 0;
+  if (gzmtp->chunks) {
+    for (uint32_t slot_idx = 0; slot_idx != slot_ct; ++slot_idx) {
+      free_cond(gzmtp->chunks[slot_idx].syms);
+    }
+    free(gzmtp->chunks);
+    gzmtp->chunks = nullptr;
+  }
+  free_cond(gzmtp->tables);
+  gzmtp->tables = nullptr;
+  free_cond(gzmtp->window);
+  gzmtp->window = nullptr;
+  free_cond(gzmtp->in);
+  gzmtp->in = nullptr;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,171 @@
+#ifndef __PLINK2_GZMT_H__
+#define __PLINK2_GZMT_H__
+
+// This library is part of PLINK 2.00, copyright (C) 2005-2021 Shaun Purcell,
+// Christopher Chang.
+//
+// This library is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Multithreaded decompression of ordinary (non-BGZF) gzip files.
+//
+// A deflate stream is sequentially dependent in two ways: block boundaries
+// aren't byte-aligned or marked, and back-references can reach up to 32 KiB
+// into earlier output.  Following pugz (Kerbiriou and Chikhi, "Parallel
+// decompression of gzip-compressed files and random access to DNA sequences",
+// 2019), each batch of compressed input is split into up to thread_ct chunks.
+// Worker 0 decodes the first chunk exactly.  Each other worker scans forward
+// from its chunk's nominal start for a dynamic-Huffman block header that
+// decodes to plausible text, and continues from there without knowing the
+// preceding window; its output is stored as 16-bit symbols, where values
+// >= 256 refer to the unknown window.  These are resolved in order once the
+// preceding chunks are known.
+//
+// A speculative chunk is only accepted if the preceding chunk stopped exactly
+// where the speculative decode started; otherwise the next batch resumes
+// (exactly) from the end of the last accepted chunk.  So a bad guess costs
+// time, but never correctness.  Member CRC32s and lengths are also verified.
+//
+// The decoder itself is a small table-driven inflater in the style of
+// libdeflate's; libdeflate proper can only decode complete buffers, with no
+// way to supply an unknown window.  libdeflate_crc32() is used for the
+// checksums.
+
+#include "plink2_string.h"
+#include "plink2_thread.h"
+#include "../libdeflate/libdeflate.h"
+
+#ifdef __cplusplus
+namespace plink2 {
+#endif
+
+CONSTI32(kMaxGzDecompressThreads, 8);
+CONSTI32(kDeflateWindowSize, 32768);
+
+// Chunk sizes are adjusted to the observed compression ratio, aiming for this
+// many decompressed bytes per chunk.
+CONSTI32(kGzMtChunkTargetBlen, 1048576);
+CONSTI32(kGzMtMinChunkCsize, 32768);
+CONSTI32(kGzMtMaxChunkCsize, 1048576);
+// Extra compressed bytes loaded past the last chunk's nominal end, so it can
+// usually finish its last block.
+CONSTI32(kGzMtLookahead, 131072);
+
+// Decoding tables: 10-bit (litlen) and 8-bit (offset) primary tables, with
+// subtables for longer codewords.  Sizes are comfortable upper bounds; see
+// zlib's examples/enough.c.
+CONSTI32(kGzMtLitlenTableSize, 2048);
+CONSTI32(kGzMtOffsetTableSize, 1024);
+CONSTI32(kGzMtPrecodeTableSize, 128);
+
+typedef struct GzMtInflateTablesStruct {
+  uint32_t litlen[kGzMtLitlenTableSize];
+  uint32_t offset[kGzMtOffsetTableSize];
+  uint32_t precode[kGzMtPrecodeTableSize];
+} GzMtInflateTables;
+
+// GzMtChunk.status values.
+CONSTI32(kGzMtChunkFail, 0);
+// Stopped at the first block boundary at or after stop_bitpos.
+CONSTI32(kGzMtChunkBoundary, 1);
+// Ran out of input; end_bitpos is the start of the unfinished block.
+CONSTI32(kGzMtChunkIncomplete, 2);
+// Finished the final block of a gzip member.
+CONSTI32(kGzMtChunkMemberEnd, 3);
+
+typedef struct GzMtChunkStruct {
+  // Consumer -> worker.  Bit positions are relative to
+  // GzRawMtDecompressStream.in.
+  // For the first chunk in a batch, decoding starts exactly at
+  // search_bitpos; otherwise, this is where the block-header search starts.
+  uint64_t search_bitpos;
+  uint64_t stop_bitpos;
+
+  // Worker -> consumer.
+  // kDeflateWindowSize window symbols, followed by sym_capacity output
+  // symbols (plus a bit of copy slack).  Grown by the worker as needed.
+  uint16_t* syms;
+  uintptr_t sym_capacity;
+  uintptr_t sym_ct;
+  uint64_t start_bitpos;
+  uint64_t end_bitpos;
+  uint32_t status;
+  uint32_t nomem;
+
+  // Consumer-only.  window points to kDeflateWindowSize bytes: the output
+  // immediately preceding this chunk.
+  unsigned char* window;
+  uint32_t member_end;
+  uint32_t member_crc;
+  uint32_t member_isize;
+} GzMtChunk;
+
+typedef struct GzRawMtDecompressStreamStruct {
+  // Borrowed from consumer, not closed by CleanupGzRawMtStream().
+  FILE* ff;
+
+  // Compressed bytes, followed by at least 16 zero bytes of padding.
+  unsigned char* in;
+  uintptr_t in_capacity;
+  uintptr_t in_size;
+  uint32_t in_eof;
+  uint32_t chunk_csize;
+  // Set after the first chunk failed to finish a single block; the next
+  // batch is then a single chunk spanning the (enlarged) buffer.
+  uint32_t single_chunk;
+
+  // Last kDeflateWindowSize bytes of output through the end of the most
+  // recently stitched batch (right-aligned; only the final window_len bytes
+  // are valid).
+  unsigned char* window;
+  uint32_t window_len;
+
+  GzMtInflateTables* tables;  // one per thread, plus fixed-code tables
+  GzMtChunk* chunks;  // [parity * thread_ct + chunk_idx]
+  uint32_t worker_parity;
+  uint32_t batch_chunk_cts[2];
+
+  uint32_t consume_parity;
+  uint32_t consume_chunk_idx;
+  uint32_t consume_chunk_end;
+  uintptr_t consume_pos;
+  uint32_t crc;
+  uint32_t isize;
+  uint32_t unjoined;
+
+  ThreadGroup tg;  // stores thread_ct
+} GzRawMtDecompressStream;
+
+extern const char kShortErrGzMtInvalid[];
+extern const char kShortErrGzMtTruncated[];
+extern const char kShortErrGzMtCrc[];
+
+void PreinitGzRawMtStream(GzRawMtDecompressStream* gzmtp);
+
+// header[] must contain the first header_blen bytes of the file, and ff must
+// point immediately after them.  decompress_thread_ct must be at least 2; it
+// is reduced to kMaxGzDecompressThreads if necessary.
+PglErr GzRawMtStreamInit(const char* header, uint32_t header_blen, uint32_t decompress_thread_ct, FILE* ff, GzRawMtDecompressStream* gzmtp, const char** errmsgp);
+
+PglErr GzRawMtStreamRead(unsigned char* dst_end, GzRawMtDecompressStream* gzmtp, unsigned char** dst_iterp, const char** errmsgp);
+
+PglErr GzRawMtStreamRewind(GzRawMtDecompressStream* gzmtp, const char** errmsgp);
+
+void CleanupGzRawMtStream(GzRawMtDecompressStream* gzmtp);
+
+#ifdef __cplusplus
+}  // namespace plink2
+#endif
+
+#endif  // __PLINK2_GZMT_H__
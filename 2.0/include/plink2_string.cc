@@ -1097,13 +1097,754 @@ static const double kPositivePowTen16[] = {1, 1.0e16, 1.0e32, 1.0e48, 1.0e64, 1.
 static const double kNegativePow10[] = {1, 1.0e-1, 1.0e-2, 1.0e-3, 1.0e-4, 1.0e-5, 1.0e-6, 1.0e-7, 1.0e-8, 1.0e-9, 1.0e-10, 1.0e-11, 1.0e-12, 1.0e-13, 1.0e-14, 1.0e-15};
 static const double kNegativePowTen16[] = {1, 1.0e-16, 1.0e-32, 1.0e-48, 1.0e-64, 1.0e-80, 1.0e-96, 1.0e-112};
 
+#ifdef __LP64__
+// kPow10Floor128[2 * (e - kPow10Floor128Min)] and its successor are the high
+// and low words of floor(10^e * 2^(127 - floor(log2(10^e)))), i.e. the
+// leading 128 bits of 10^e, for e in [-342, 324].  ScanadvDouble() uses them
+// directly (Eisel-Lemire), while dtoa_r() adds 1 (Schubfach).
+CONSTI32(kPow10Floor128Min, -342);
+CONSTI32(kPow10Floor128Max, 324);
+
+static const uint64_t kPow10Floor128[] = {
+  0xeef453d6923bd65aLLU, 0x113faa2906a13b3fLLU,
+  0x9558b4661b6565f8LLU, 0x4ac7ca59a424c507LLU,
+  0xbaaee17fa23ebf76LLU, 0x5d79bcf00d2df649LLU,
+  0xe95a99df8ace6f53LLU, 0xf4d82c2c107973dcLLU,
+  0x91d8a02bb6c10594LLU, 0x79071b9b8a4be869LLU,
+  0xb64ec836a47146f9LLU, 0x9748e2826cdee284LLU,
+  0xe3e27a444d8d98b7LLU, 0xfd1b1b2308169b25LLU,
+  0x8e6d8c6ab0787f72LLU, 0xfe30f0f5e50e20f7LLU,
+  0xb208ef855c969f4fLLU, 0xbdbd2d335e51a935LLU,
+  0xde8b2b66b3bc4723LLU, 0xad2c788035e61382LLU,
+  0x8b16fb203055ac76LLU, 0x4c3bcb5021afcc31LLU,
+  0xaddcb9e83c6b1793LLU, 0xdf4abe242a1bbf3dLLU,
+  0xd953e8624b85dd78LLU, 0xd71d6dad34a2af0dLLU,
+  0x87d4713d6f33aa6bLLU, 0x8672648c40e5ad68LLU,
+  0xa9c98d8ccb009506LLU, 0x680efdaf511f18c2LLU,
+  0xd43bf0effdc0ba48LLU, 0x0212bd1b2566def2LLU,
+  0x84a57695fe98746dLLU, 0x014bb630f7604b57LLU,
+  0xa5ced43b7e3e9188LLU, 0x419ea3bd35385e2dLLU,
+  0xcf42894a5dce35eaLLU, 0x52064cac828675b9LLU,
+  0x818995ce7aa0e1b2LLU, 0x7343efebd1940993LLU,
+  0xa1ebfb4219491a1fLLU, 0x1014ebe6c5f90bf8LLU,
+  0xca66fa129f9b60a6LLU, 0xd41a26e077774ef6LLU,
+  0xfd00b897478238d0LLU, 0x8920b098955522b4LLU,
+  0x9e20735e8cb16382LLU, 0x55b46e5f5d5535b0LLU,
+  0xc5a890362fddbc62LLU, 0xeb2189f734aa831dLLU,
+  0xf712b443bbd52b7bLLU, 0xa5e9ec7501d523e4LLU,
+  0x9a6bb0aa55653b2dLLU, 0x47b233c92125366eLLU,
+  0xc1069cd4eabe89f8LLU, 0x999ec0bb696e840aLLU,
+  0xf148440a256e2c76LLU, 0xc00670ea43ca250dLLU,
+  0x96cd2a865764dbcaLLU, 0x380406926a5e5728LLU,
+  0xbc807527ed3e12bcLLU, 0xc605083704f5ecf2LLU,
+  0xeba09271e88d976bLLU, 0xf7864a44c633682eLLU,
+  0x93445b8731587ea3LLU, 0x7ab3ee6afbe0211dLLU,
+  0xb8157268fdae9e4cLLU, 0x5960ea05bad82964LLU,
+  0xe61acf033d1a45dfLLU, 0x6fb92487298e33bdLLU,
+  0x8fd0c16206306babLLU, 0xa5d3b6d479f8e056LLU,
+  0xb3c4f1ba87bc8696LLU, 0x8f48a4899877186cLLU,
+  0xe0b62e2929aba83cLLU, 0x331acdabfe94de87LLU,
+  0x8c71dcd9ba0b4925LLU, 0x9ff0c08b7f1d0b14LLU,
+  0xaf8e5410288e1b6fLLU, 0x07ecf0ae5ee44dd9LLU,
+  0xdb71e91432b1a24aLLU, 0xc9e82cd9f69d6150LLU,
+  0x892731ac9faf056eLLU, 0xbe311c083a225cd2LLU,
+  0xab70fe17c79ac6caLLU, 0x6dbd630a48aaf406LLU,
+  0xd64d3d9db981787dLLU, 0x092cbbccdad5b108LLU,
+  0x85f0468293f0eb4eLLU, 0x25bbf56008c58ea5LLU,
+  0xa76c582338ed2621LLU, 0xaf2af2b80af6f24eLLU,
+  0xd1476e2c07286faaLLU, 0x1af5af660db4aee1LLU,
+  0x82cca4db847945caLLU, 0x50d98d9fc890ed4dLLU,
+  0xa37fce126597973cLLU, 0xe50ff107bab528a0LLU,
+  0xcc5fc196fefd7d0cLLU, 0x1e53ed49a96272c8LLU,
+  0xff77b1fcbebcdc4fLLU, 0x25e8e89c13bb0f7aLLU,
+  0x9faacf3df73609b1LLU, 0x77b191618c54e9acLLU,
+  0xc795830d75038c1dLLU, 0xd59df5b9ef6a2417LLU,
+  0xf97ae3d0d2446f25LLU, 0x4b0573286b44ad1dLLU,
+  0x9becce62836ac577LLU, 0x4ee367f9430aec32LLU,
+  0xc2e801fb244576d5LLU, 0x229c41f793cda73fLLU,
+  0xf3a20279ed56d48aLLU, 0x6b43527578c1110fLLU,
+  0x9845418c345644d6LLU, 0x830a13896b78aaa9LLU,
+  0xbe5691ef416bd60cLLU, 0x23cc986bc656d553LLU,
+  0xedec366b11c6cb8fLLU, 0x2cbfbe86b7ec8aa8LLU,
+  0x94b3a202eb1c3f39LLU, 0x7bf7d71432f3d6a9LLU,
+  0xb9e08a83a5e34f07LLU, 0xdaf5ccd93fb0cc53LLU,
+  0xe858ad248f5c22c9LLU, 0xd1b3400f8f9cff68LLU,
+  0x91376c36d99995beLLU, 0x23100809b9c21fa1LLU,
+  0xb58547448ffffb2dLLU, 0xabd40a0c2832a78aLLU,
+  0xe2e69915b3fff9f9LLU, 0x16c90c8f323f516cLLU,
+  0x8dd01fad907ffc3bLLU, 0xae3da7d97f6792e3LLU,
+  0xb1442798f49ffb4aLLU, 0x99cd11cfdf41779cLLU,
+  0xdd95317f31c7fa1dLLU, 0x40405643d711d583LLU,
+  0x8a7d3eef7f1cfc52LLU, 0x482835ea666b2572LLU,
+  0xad1c8eab5ee43b66LLU, 0xda3243650005eecfLLU,
+  0xd863b256369d4a40LLU, 0x90bed43e40076a82LLU,
+  0x873e4f75e2224e68LLU, 0x5a7744a6e804a291LLU,
+  0xa90de3535aaae202LLU, 0x711515d0a205cb36LLU,
+  0xd3515c2831559a83LLU, 0x0d5a5b44ca873e03LLU,
+  0x8412d9991ed58091LLU, 0xe858790afe9486c2LLU,
+  0xa5178fff668ae0b6LLU, 0x626e974dbe39a872LLU,
+  0xce5d73ff402d98e3LLU, 0xfb0a3d212dc8128fLLU,
+  0x80fa687f881c7f8eLLU, 0x7ce66634bc9d0b99LLU,
+  0xa139029f6a239f72LLU, 0x1c1fffc1ebc44e80LLU,
+  0xc987434744ac874eLLU, 0xa327ffb266b56220LLU,
+  0xfbe9141915d7a922LLU, 0x4bf1ff9f0062baa8LLU,
+  0x9d71ac8fada6c9b5LLU, 0x6f773fc3603db4a9LLU,
+  0xc4ce17b399107c22LLU, 0xcb550fb4384d21d3LLU,
+  0xf6019da07f549b2bLLU, 0x7e2a53a146606a48LLU,
+  0x99c102844f94e0fbLLU, 0x2eda7444cbfc426dLLU,
+  0xc0314325637a1939LLU, 0xfa911155fefb5308LLU,
+  0xf03d93eebc589f88LLU, 0x793555ab7eba27caLLU,
+  0x96267c7535b763b5LLU, 0x4bc1558b2f3458deLLU,
+  0xbbb01b9283253ca2LLU, 0x9eb1aaedfb016f16LLU,
+  0xea9c227723ee8bcbLLU, 0x465e15a979c1cadcLLU,
+  0x92a1958a7675175fLLU, 0x0bfacd89ec191ec9LLU,
+  0xb749faed14125d36LLU, 0xcef980ec671f667bLLU,
+  0xe51c79a85916f484LLU, 0x82b7e12780e7401aLLU,
+  0x8f31cc0937ae58d2LLU, 0xd1b2ecb8b0908810LLU,
+  0xb2fe3f0b8599ef07LLU, 0x861fa7e6dcb4aa15LLU,
+  0xdfbdcece67006ac9LLU, 0x67a791e093e1d49aLLU,
+  0x8bd6a141006042bdLLU, 0xe0c8bb2c5c6d24e0LLU,
+  0xaecc49914078536dLLU, 0x58fae9f773886e18LLU,
+  0xda7f5bf590966848LLU, 0xaf39a475506a899eLLU,
+  0x888f99797a5e012dLLU, 0x6d8406c952429603LLU,
+  0xaab37fd7d8f58178LLU, 0xc8e5087ba6d33b83LLU,
+  0xd5605fcdcf32e1d6LLU, 0xfb1e4a9a90880a64LLU,
+  0x855c3be0a17fcd26LLU, 0x5cf2eea09a55067fLLU,
+  0xa6b34ad8c9dfc06fLLU, 0xf42faa48c0ea481eLLU,
+  0xd0601d8efc57b08bLLU, 0xf13b94daf124da26LLU,
+  0x823c12795db6ce57LLU, 0x76c53d08d6b70858LLU,
+  0xa2cb1717b52481edLLU, 0x54768c4b0c64ca6eLLU,
+  0xcb7ddcdda26da268LLU, 0xa9942f5dcf7dfd09LLU,
+  0xfe5d54150b090b02LLU, 0xd3f93b35435d7c4cLLU,
+  0x9efa548d26e5a6e1LLU, 0xc47bc5014a1a6dafLLU,
+  0xc6b8e9b0709f109aLLU, 0x359ab6419ca1091bLLU,
+  0xf867241c8cc6d4c0LLU, 0xc30163d203c94b62LLU,
+  0x9b407691d7fc44f8LLU, 0x79e0de63425dcf1dLLU,
+  0xc21094364dfb5636LLU, 0x985915fc12f542e4LLU,
+  0xf294b943e17a2bc4LLU, 0x3e6f5b7b17b2939dLLU,
+  0x979cf3ca6cec5b5aLLU, 0xa705992ceecf9c42LLU,
+  0xbd8430bd08277231LLU, 0x50c6ff782a838353LLU,
+  0xece53cec4a314ebdLLU, 0xa4f8bf5635246428LLU,
+  0x940f4613ae5ed136LLU, 0x871b7795e136be99LLU,
+  0xb913179899f68584LLU, 0x28e2557b59846e3fLLU,
+  0xe757dd7ec07426e5LLU, 0x331aeada2fe589cfLLU,
+  0x9096ea6f3848984fLLU, 0x3ff0d2c85def7621LLU,
+  0xb4bca50b065abe63LLU, 0x0fed077a756b53a9LLU,
+  0xe1ebce4dc7f16dfbLLU, 0xd3e8495912c62894LLU,
+  0x8d3360f09cf6e4bdLLU, 0x64712dd7abbbd95cLLU,
+  0xb080392cc4349decLLU, 0xbd8d794d96aacfb3LLU,
+  0xdca04777f541c567LLU, 0xecf0d7a0fc5583a0LLU,
+  0x89e42caaf9491b60LLU, 0xf41686c49db57244LLU,
+  0xac5d37d5b79b6239LLU, 0x311c2875c522ced5LLU,
+  0xd77485cb25823ac7LLU, 0x7d633293366b828bLLU,
+  0x86a8d39ef77164bcLLU, 0xae5dff9c02033197LLU,
+  0xa8530886b54dbdebLLU, 0xd9f57f830283fdfcLLU,
+  0xd267caa862a12d66LLU, 0xd072df63c324fd7bLLU,
+  0x8380dea93da4bc60LLU, 0x4247cb9e59f71e6dLLU,
+  0xa46116538d0deb78LLU, 0x52d9be85f074e608LLU,
+  0xcd795be870516656LLU, 0x67902e276c921f8bLLU,
+  0x806bd9714632dff6LLU, 0x00ba1cd8a3db53b6LLU,
+  0xa086cfcd97bf97f3LLU, 0x80e8a40eccd228a4LLU,
+  0xc8a883c0fdaf7df0LLU, 0x6122cd128006b2cdLLU,
+  0xfad2a4b13d1b5d6cLLU, 0x796b805720085f81LLU,
+  0x9cc3a6eec6311a63LLU, 0xcbe3303674053bb0LLU,
+  0xc3f490aa77bd60fcLLU, 0xbedbfc4411068a9cLLU,
+  0xf4f1b4d515acb93bLLU, 0xee92fb5515482d44LLU,
+  0x991711052d8bf3c5LLU, 0x751bdd152d4d1c4aLLU,
+  0xbf5cd54678eef0b6LLU, 0xd262d45a78a0635dLLU,
+  0xef340a98172aace4LLU, 0x86fb897116c87c34LLU,
+  0x9580869f0e7aac0eLLU, 0xd45d35e6ae3d4da0LLU,
+  0xbae0a846d2195712LLU, 0x8974836059cca109LLU,
+  0xe998d258869facd7LLU, 0x2bd1a438703fc94bLLU,
+  0x91ff83775423cc06LLU, 0x7b6306a34627ddcfLLU,
+  0xb67f6455292cbf08LLU, 0x1a3bc84c17b1d542LLU,
+  0xe41f3d6a7377eecaLLU, 0x20caba5f1d9e4a93LLU,
+  0x8e938662882af53eLLU, 0x547eb47b7282ee9cLLU,
+  0xb23867fb2a35b28dLLU, 0xe99e619a4f23aa43LLU,
+  0xdec681f9f4c31f31LLU, 0x6405fa00e2ec94d4LLU,
+  0x8b3c113c38f9f37eLLU, 0xde83bc408dd3dd04LLU,
+  0xae0b158b4738705eLLU, 0x9624ab50b148d445LLU,
+  0xd98ddaee19068c76LLU, 0x3badd624dd9b0957LLU,
+  0x87f8a8d4cfa417c9LLU, 0xe54ca5d70a80e5d6LLU,
+  0xa9f6d30a038d1dbcLLU, 0x5e9fcf4ccd211f4cLLU,
+  0xd47487cc8470652bLLU, 0x7647c3200069671fLLU,
+  0x84c8d4dfd2c63f3bLLU, 0x29ecd9f40041e073LLU,
+  0xa5fb0a17c777cf09LLU, 0xf468107100525890LLU,
+  0xcf79cc9db955c2ccLLU, 0x7182148d4066eeb4LLU,
+  0x81ac1fe293d599bfLLU, 0xc6f14cd848405530LLU,
+  0xa21727db38cb002fLLU, 0xb8ada00e5a506a7cLLU,
+  0xca9cf1d206fdc03bLLU, 0xa6d90811f0e4851cLLU,
+  0xfd442e4688bd304aLLU, 0x908f4a166d1da663LLU,
+  0x9e4a9cec15763e2eLLU, 0x9a598e4e043287feLLU,
+  0xc5dd44271ad3cdbaLLU, 0x40eff1e1853f29fdLLU,
+  0xf7549530e188c128LLU, 0xd12bee59e68ef47cLLU,
+  0x9a94dd3e8cf578b9LLU, 0x82bb74f8301958ceLLU,
+  0xc13a148e3032d6e7LLU, 0xe36a52363c1faf01LLU,
+  0xf18899b1bc3f8ca1LLU, 0xdc44e6c3cb279ac1LLU,
+  0x96f5600f15a7b7e5LLU, 0x29ab103a5ef8c0b9LLU,
+  0xbcb2b812db11a5deLLU, 0x7415d448f6b6f0e7LLU,
+  0xebdf661791d60f56LLU, 0x111b495b3464ad21LLU,
+  0x936b9fcebb25c995LLU, 0xcab10dd900beec34LLU,
+  0xb84687c269ef3bfbLLU, 0x3d5d514f40eea742LLU,
+  0xe65829b3046b0afaLLU, 0x0cb4a5a3112a5112LLU,
+  0x8ff71a0fe2c2e6dcLLU, 0x47f0e785eaba72abLLU,
+  0xb3f4e093db73a093LLU, 0x59ed216765690f56LLU,
+  0xe0f218b8d25088b8LLU, 0x306869c13ec3532cLLU,
+  0x8c974f7383725573LLU, 0x1e414218c73a13fbLLU,
+  0xafbd2350644eeacfLLU, 0xe5d1929ef90898faLLU,
+  0xdbac6c247d62a583LLU, 0xdf45f746b74abf39LLU,
+  0x894bc396ce5da772LLU, 0x6b8bba8c328eb783LLU,
+  0xab9eb47c81f5114fLLU, 0x066ea92f3f326564LLU,
+  0xd686619ba27255a2LLU, 0xc80a537b0efefebdLLU,
+  0x8613fd0145877585LLU, 0xbd06742ce95f5f36LLU,
+  0xa798fc4196e952e7LLU, 0x2c48113823b73704LLU,
+  0xd17f3b51fca3a7a0LLU, 0xf75a15862ca504c5LLU,
+  0x82ef85133de648c4LLU, 0x9a984d73dbe722fbLLU,
+  0xa3ab66580d5fdaf5LLU, 0xc13e60d0d2e0ebbaLLU,
+  0xcc963fee10b7d1b3LLU, 0x318df905079926a8LLU,
+  0xffbbcfe994e5c61fLLU, 0xfdf17746497f7052LLU,
+  0x9fd561f1fd0f9bd3LLU, 0xfeb6ea8bedefa633LLU,
+  0xc7caba6e7c5382c8LLU, 0xfe64a52ee96b8fc0LLU,
+  0xf9bd690a1b68637bLLU, 0x3dfdce7aa3c673b0LLU,
+  0x9c1661a651213e2dLLU, 0x06bea10ca65c084eLLU,
+  0xc31bfa0fe5698db8LLU, 0x486e494fcff30a62LLU,
+  0xf3e2f893dec3f126LLU, 0x5a89dba3c3efccfaLLU,
+  0x986ddb5c6b3a76b7LLU, 0xf89629465a75e01cLLU,
+  0xbe89523386091465LLU, 0xf6bbb397f1135823LLU,
+  0xee2ba6c0678b597fLLU, 0x746aa07ded582e2cLLU,
+  0x94db483840b717efLLU, 0xa8c2a44eb4571cdcLLU,
+  0xba121a4650e4ddebLLU, 0x92f34d62616ce413LLU,
+  0xe896a0d7e51e1566LLU, 0x77b020baf9c81d17LLU,
+  0x915e2486ef32cd60LLU, 0x0ace1474dc1d122eLLU,
+  0xb5b5ada8aaff80b8LLU, 0x0d819992132456baLLU,
+  0xe3231912d5bf60e6LLU, 0x10e1fff697ed6c69LLU,
+  0x8df5efabc5979c8fLLU, 0xca8d3ffa1ef463c1LLU,
+  0xb1736b96b6fd83b3LLU, 0xbd308ff8a6b17cb2LLU,
+  0xddd0467c64bce4a0LLU, 0xac7cb3f6d05ddbdeLLU,
+  0x8aa22c0dbef60ee4LLU, 0x6bcdf07a423aa96bLLU,
+  0xad4ab7112eb3929dLLU, 0x86c16c98d2c953c6LLU,
+  0xd89d64d57a607744LLU, 0xe871c7bf077ba8b7LLU,
+  0x87625f056c7c4a8bLLU, 0x11471cd764ad4972LLU,
+  0xa93af6c6c79b5d2dLLU, 0xd598e40d3dd89bcfLLU,
+  0xd389b47879823479LLU, 0x4aff1d108d4ec2c3LLU,
+  0x843610cb4bf160cbLLU, 0xcedf722a585139baLLU,
+  0xa54394fe1eedb8feLLU, 0xc2974eb4ee658828LLU,
+  0xce947a3da6a9273eLLU, 0x733d226229feea32LLU,
+  0x811ccc668829b887LLU, 0x0806357d5a3f525fLLU,
+  0xa163ff802a3426a8LLU, 0xca07c2dcb0cf26f7LLU,
+  0xc9bcff6034c13052LLU, 0xfc89b393dd02f0b5LLU,
+  0xfc2c3f3841f17c67LLU, 0xbbac2078d443ace2LLU,
+  0x9d9ba7832936edc0LLU, 0xd54b944b84aa4c0dLLU,
+  0xc5029163f384a931LLU, 0x0a9e795e65d4df11LLU,
+  0xf64335bcf065d37dLLU, 0x4d4617b5ff4a16d5LLU,
+  0x99ea0196163fa42eLLU, 0x504bced1bf8e4e45LLU,
+  0xc06481fb9bcf8d39LLU, 0xe45ec2862f71e1d6LLU,
+  0xf07da27a82c37088LLU, 0x5d767327bb4e5a4cLLU,
+  0x964e858c91ba2655LLU, 0x3a6a07f8d510f86fLLU,
+  0xbbe226efb628afeaLLU, 0x890489f70a55368bLLU,
+  0xeadab0aba3b2dbe5LLU, 0x2b45ac74ccea842eLLU,
+  0x92c8ae6b464fc96fLLU, 0x3b0b8bc90012929dLLU,
+  0xb77ada0617e3bbcbLLU, 0x09ce6ebb40173744LLU,
+  0xe55990879ddcaabdLLU, 0xcc420a6a101d0515LLU,
+  0x8f57fa54c2a9eab6LLU, 0x9fa946824a12232dLLU,
+  0xb32df8e9f3546564LLU, 0x47939822dc96abf9LLU,
+  0xdff9772470297ebdLLU, 0x59787e2b93bc56f7LLU,
+  0x8bfbea76c619ef36LLU, 0x57eb4edb3c55b65aLLU,
+  0xaefae51477a06b03LLU, 0xede622920b6b23f1LLU,
+  0xdab99e59958885c4LLU, 0xe95fab368e45ecedLLU,
+  0x88b402f7fd75539bLLU, 0x11dbcb0218ebb414LLU,
+  0xaae103b5fcd2a881LLU, 0xd652bdc29f26a119LLU,
+  0xd59944a37c0752a2LLU, 0x4be76d3346f0495fLLU,
+  0x857fcae62d8493a5LLU, 0x6f70a4400c562ddbLLU,
+  0xa6dfbd9fb8e5b88eLLU, 0xcb4ccd500f6bb952LLU,
+  0xd097ad07a71f26b2LLU, 0x7e2000a41346a7a7LLU,
+  0x825ecc24c873782fLLU, 0x8ed400668c0c28c8LLU,
+  0xa2f67f2dfa90563bLLU, 0x728900802f0f32faLLU,
+  0xcbb41ef979346bcaLLU, 0x4f2b40a03ad2ffb9LLU,
+  0xfea126b7d78186bcLLU, 0xe2f610c84987bfa8LLU,
+  0x9f24b832e6b0f436LLU, 0x0dd9ca7d2df4d7c9LLU,
+  0xc6ede63fa05d3143LLU, 0x91503d1c79720dbbLLU,
+  0xf8a95fcf88747d94LLU, 0x75a44c6397ce912aLLU,
+  0x9b69dbe1b548ce7cLLU, 0xc986afbe3ee11abaLLU,
+  0xc24452da229b021bLLU, 0xfbe85badce996168LLU,
+  0xf2d56790ab41c2a2LLU, 0xfae27299423fb9c3LLU,
+  0x97c560ba6b0919a5LLU, 0xdccd879fc967d41aLLU,
+  0xbdb6b8e905cb600fLLU, 0x5400e987bbc1c920LLU,
+  0xed246723473e3813LLU, 0x290123e9aab23b68LLU,
+  0x9436c0760c86e30bLLU, 0xf9a0b6720aaf6521LLU,
+  0xb94470938fa89bceLLU, 0xf808e40e8d5b3e69LLU,
+  0xe7958cb87392c2c2LLU, 0xb60b1d1230b20e04LLU,
+  0x90bd77f3483bb9b9LLU, 0xb1c6f22b5e6f48c2LLU,
+  0xb4ecd5f01a4aa828LLU, 0x1e38aeb6360b1af3LLU,
+  0xe2280b6c20dd5232LLU, 0x25c6da63c38de1b0LLU,
+  0x8d590723948a535fLLU, 0x579c487e5a38ad0eLLU,
+  0xb0af48ec79ace837LLU, 0x2d835a9df0c6d851LLU,
+  0xdcdb1b2798182244LLU, 0xf8e431456cf88e65LLU,
+  0x8a08f0f8bf0f156bLLU, 0x1b8e9ecb641b58ffLLU,
+  0xac8b2d36eed2dac5LLU, 0xe272467e3d222f3fLLU,
+  0xd7adf884aa879177LLU, 0x5b0ed81dcc6abb0fLLU,
+  0x86ccbb52ea94baeaLLU, 0x98e947129fc2b4e9LLU,
+  0xa87fea27a539e9a5LLU, 0x3f2398d747b36224LLU,
+  0xd29fe4b18e88640eLLU, 0x8eec7f0d19a03aadLLU,
+  0x83a3eeeef9153e89LLU, 0x1953cf68300424acLLU,
+  0xa48ceaaab75a8e2bLLU, 0x5fa8c3423c052dd7LLU,
+  0xcdb02555653131b6LLU, 0x3792f412cb06794dLLU,
+  0x808e17555f3ebf11LLU, 0xe2bbd88bbee40bd0LLU,
+  0xa0b19d2ab70e6ed6LLU, 0x5b6aceaeae9d0ec4LLU,
+  0xc8de047564d20a8bLLU, 0xf245825a5a445275LLU,
+  0xfb158592be068d2eLLU, 0xeed6e2f0f0d56712LLU,
+  0x9ced737bb6c4183dLLU, 0x55464dd69685606bLLU,
+  0xc428d05aa4751e4cLLU, 0xaa97e14c3c26b886LLU,
+  0xf53304714d9265dfLLU, 0xd53dd99f4b3066a8LLU,
+  0x993fe2c6d07b7fabLLU, 0xe546a8038efe4029LLU,
+  0xbf8fdb78849a5f96LLU, 0xde98520472bdd033LLU,
+  0xef73d256a5c0f77cLLU, 0x963e66858f6d4440LLU,
+  0x95a8637627989aadLLU, 0xdde7001379a44aa8LLU,
+  0xbb127c53b17ec159LLU, 0x5560c018580d5d52LLU,
+  0xe9d71b689dde71afLLU, 0xaab8f01e6e10b4a6LLU,
+  0x9226712162ab070dLLU, 0xcab3961304ca70e8LLU,
+  0xb6b00d69bb55c8d1LLU, 0x3d607b97c5fd0d22LLU,
+  0xe45c10c42a2b3b05LLU, 0x8cb89a7db77c506aLLU,
+  0x8eb98a7a9a5b04e3LLU, 0x77f3608e92adb242LLU,
+  0xb267ed1940f1c61cLLU, 0x55f038b237591ed3LLU,
+  0xdf01e85f912e37a3LLU, 0x6b6c46dec52f6688LLU,
+  0x8b61313bbabce2c6LLU, 0x2323ac4b3b3da015LLU,
+  0xae397d8aa96c1b77LLU, 0xabec975e0a0d081aLLU,
+  0xd9c7dced53c72255LLU, 0x96e7bd358c904a21LLU,
+  0x881cea14545c7575LLU, 0x7e50d64177da2e54LLU,
+  0xaa242499697392d2LLU, 0xdde50bd1d5d0b9e9LLU,
+  0xd4ad2dbfc3d07787LLU, 0x955e4ec64b44e864LLU,
+  0x84ec3c97da624ab4LLU, 0xbd5af13bef0b113eLLU,
+  0xa6274bbdd0fadd61LLU, 0xecb1ad8aeacdd58eLLU,
+  0xcfb11ead453994baLLU, 0x67de18eda5814af2LLU,
+  0x81ceb32c4b43fcf4LLU, 0x80eacf948770ced7LLU,
+  0xa2425ff75e14fc31LLU, 0xa1258379a94d028dLLU,
+  0xcad2f7f5359a3b3eLLU, 0x096ee45813a04330LLU,
+  0xfd87b5f28300ca0dLLU, 0x8bca9d6e188853fcLLU,
+  0x9e74d1b791e07e48LLU, 0x775ea264cf55347dLLU,
+  0xc612062576589ddaLLU, 0x95364afe032a819dLLU,
+  0xf79687aed3eec551LLU, 0x3a83ddbd83f52204LLU,
+  0x9abe14cd44753b52LLU, 0xc4926a9672793542LLU,
+  0xc16d9a0095928a27LLU, 0x75b7053c0f178293LLU,
+  0xf1c90080baf72cb1LLU, 0x5324c68b12dd6338LLU,
+  0x971da05074da7beeLLU, 0xd3f6fc16ebca5e03LLU,
+  0xbce5086492111aeaLLU, 0x88f4bb1ca6bcf584LLU,
+  0xec1e4a7db69561a5LLU, 0x2b31e9e3d06c32e5LLU,
+  0x9392ee8e921d5d07LLU, 0x3aff322e62439fcfLLU,
+  0xb877aa3236a4b449LLU, 0x09befeb9fad487c2LLU,
+  0xe69594bec44de15bLLU, 0x4c2ebe687989a9b3LLU,
+  0x901d7cf73ab0acd9LLU, 0x0f9d37014bf60a10LLU,
+  0xb424dc35095cd80fLLU, 0x538484c19ef38c94LLU,
+  0xe12e13424bb40e13LLU, 0x2865a5f206b06fb9LLU,
+  0x8cbccc096f5088cbLLU, 0xf93f87b7442e45d3LLU,
+  0xafebff0bcb24aafeLLU, 0xf78f69a51539d748LLU,
+  0xdbe6fecebdedd5beLLU, 0xb573440e5a884d1bLLU,
+  0x89705f4136b4a597LLU, 0x31680a88f8953030LLU,
+  0xabcc77118461cefcLLU, 0xfdc20d2b36ba7c3dLLU,
+  0xd6bf94d5e57a42bcLLU, 0x3d32907604691b4cLLU,
+  0x8637bd05af6c69b5LLU, 0xa63f9a49c2c1b10fLLU,
+  0xa7c5ac471b478423LLU, 0x0fcf80dc33721d53LLU,
+  0xd1b71758e219652bLLU, 0xd3c36113404ea4a8LLU,
+  0x83126e978d4fdf3bLLU, 0x645a1cac083126e9LLU,
+  0xa3d70a3d70a3d70aLLU, 0x3d70a3d70a3d70a3LLU,
+  0xccccccccccccccccLLU, 0xccccccccccccccccLLU,
+  0x8000000000000000LLU, 0x0000000000000000LLU,
+  0xa000000000000000LLU, 0x0000000000000000LLU,
+  0xc800000000000000LLU, 0x0000000000000000LLU,
+  0xfa00000000000000LLU, 0x0000000000000000LLU,
+  0x9c40000000000000LLU, 0x0000000000000000LLU,
+  0xc350000000000000LLU, 0x0000000000000000LLU,
+  0xf424000000000000LLU, 0x0000000000000000LLU,
+  0x9896800000000000LLU, 0x0000000000000000LLU,
+  0xbebc200000000000LLU, 0x0000000000000000LLU,
+  0xee6b280000000000LLU, 0x0000000000000000LLU,
+  0x9502f90000000000LLU, 0x0000000000000000LLU,
+  0xba43b74000000000LLU, 0x0000000000000000LLU,
+  0xe8d4a51000000000LLU, 0x0000000000000000LLU,
+  0x9184e72a00000000LLU, 0x0000000000000000LLU,
+  0xb5e620f480000000LLU, 0x0000000000000000LLU,
+  0xe35fa931a0000000LLU, 0x0000000000000000LLU,
+  0x8e1bc9bf04000000LLU, 0x0000000000000000LLU,
+  0xb1a2bc2ec5000000LLU, 0x0000000000000000LLU,
+  0xde0b6b3a76400000LLU, 0x0000000000000000LLU,
+  0x8ac7230489e80000LLU, 0x0000000000000000LLU,
+  0xad78ebc5ac620000LLU, 0x0000000000000000LLU,
+  0xd8d726b7177a8000LLU, 0x0000000000000000LLU,
+  0x878678326eac9000LLU, 0x0000000000000000LLU,
+  0xa968163f0a57b400LLU, 0x0000000000000000LLU,
+  0xd3c21bcecceda100LLU, 0x0000000000000000LLU,
+  0x84595161401484a0LLU, 0x0000000000000000LLU,
+  0xa56fa5b99019a5c8LLU, 0x0000000000000000LLU,
+  0xcecb8f27f4200f3aLLU, 0x0000000000000000LLU,
+  0x813f3978f8940984LLU, 0x4000000000000000LLU,
+  0xa18f07d736b90be5LLU, 0x5000000000000000LLU,
+  0xc9f2c9cd04674edeLLU, 0xa400000000000000LLU,
+  0xfc6f7c4045812296LLU, 0x4d00000000000000LLU,
+  0x9dc5ada82b70b59dLLU, 0xf020000000000000LLU,
+  0xc5371912364ce305LLU, 0x6c28000000000000LLU,
+  0xf684df56c3e01bc6LLU, 0xc732000000000000LLU,
+  0x9a130b963a6c115cLLU, 0x3c7f400000000000LLU,
+  0xc097ce7bc90715b3LLU, 0x4b9f100000000000LLU,
+  0xf0bdc21abb48db20LLU, 0x1e86d40000000000LLU,
+  0x96769950b50d88f4LLU, 0x1314448000000000LLU,
+  0xbc143fa4e250eb31LLU, 0x17d955a000000000LLU,
+  0xeb194f8e1ae525fdLLU, 0x5dcfab0800000000LLU,
+  0x92efd1b8d0cf37beLLU, 0x5aa1cae500000000LLU,
+  0xb7abc627050305adLLU, 0xf14a3d9e40000000LLU,
+  0xe596b7b0c643c719LLU, 0x6d9ccd05d0000000LLU,
+  0x8f7e32ce7bea5c6fLLU, 0xe4820023a2000000LLU,
+  0xb35dbf821ae4f38bLLU, 0xdda2802c8a800000LLU,
+  0xe0352f62a19e306eLLU, 0xd50b2037ad200000LLU,
+  0x8c213d9da502de45LLU, 0x4526f422cc340000LLU,
+  0xaf298d050e4395d6LLU, 0x9670b12b7f410000LLU,
+  0xdaf3f04651d47b4cLLU, 0x3c0cdd765f114000LLU,
+  0x88d8762bf324cd0fLLU, 0xa5880a69fb6ac800LLU,
+  0xab0e93b6efee0053LLU, 0x8eea0d047a457a00LLU,
+  0xd5d238a4abe98068LLU, 0x72a4904598d6d880LLU,
+  0x85a36366eb71f041LLU, 0x47a6da2b7f864750LLU,
+  0xa70c3c40a64e6c51LLU, 0x999090b65f67d924LLU,
+  0xd0cf4b50cfe20765LLU, 0xfff4b4e3f741cf6dLLU,
+  0x82818f1281ed449fLLU, 0xbff8f10e7a8921a4LLU,
+  0xa321f2d7226895c7LLU, 0xaff72d52192b6a0dLLU,
+  0xcbea6f8ceb02bb39LLU, 0x9bf4f8a69f764490LLU,
+  0xfee50b7025c36a08LLU, 0x02f236d04753d5b4LLU,
+  0x9f4f2726179a2245LLU, 0x01d762422c946590LLU,
+  0xc722f0ef9d80aad6LLU, 0x424d3ad2b7b97ef5LLU,
+  0xf8ebad2b84e0d58bLLU, 0xd2e0898765a7deb2LLU,
+  0x9b934c3b330c8577LLU, 0x63cc55f49f88eb2fLLU,
+  0xc2781f49ffcfa6d5LLU, 0x3cbf6b71c76b25fbLLU,
+  0xf316271c7fc3908aLLU, 0x8bef464e3945ef7aLLU,
+  0x97edd871cfda3a56LLU, 0x97758bf0e3cbb5acLLU,
+  0xbde94e8e43d0c8ecLLU, 0x3d52eeed1cbea317LLU,
+  0xed63a231d4c4fb27LLU, 0x4ca7aaa863ee4bddLLU,
+  0x945e455f24fb1cf8LLU, 0x8fe8caa93e74ef6aLLU,
+  0xb975d6b6ee39e436LLU, 0xb3e2fd538e122b44LLU,
+  0xe7d34c64a9c85d44LLU, 0x60dbbca87196b616LLU,
+  0x90e40fbeea1d3a4aLLU, 0xbc8955e946fe31cdLLU,
+  0xb51d13aea4a488ddLLU, 0x6babab6398bdbe41LLU,
+  0xe264589a4dcdab14LLU, 0xc696963c7eed2dd1LLU,
+  0x8d7eb76070a08aecLLU, 0xfc1e1de5cf543ca2LLU,
+  0xb0de65388cc8ada8LLU, 0x3b25a55f43294bcbLLU,
+  0xdd15fe86affad912LLU, 0x49ef0eb713f39ebeLLU,
+  0x8a2dbf142dfcc7abLLU, 0x6e3569326c784337LLU,
+  0xacb92ed9397bf996LLU, 0x49c2c37f07965404LLU,
+  0xd7e77a8f87daf7fbLLU, 0xdc33745ec97be906LLU,
+  0x86f0ac99b4e8dafdLLU, 0x69a028bb3ded71a3LLU,
+  0xa8acd7c0222311bcLLU, 0xc40832ea0d68ce0cLLU,
+  0xd2d80db02aabd62bLLU, 0xf50a3fa490c30190LLU,
+  0x83c7088e1aab65dbLLU, 0x792667c6da79e0faLLU,
+  0xa4b8cab1a1563f52LLU, 0x577001b891185938LLU,
+  0xcde6fd5e09abcf26LLU, 0xed4c0226b55e6f86LLU,
+  0x80b05e5ac60b6178LLU, 0x544f8158315b05b4LLU,
+  0xa0dc75f1778e39d6LLU, 0x696361ae3db1c721LLU,
+  0xc913936dd571c84cLLU, 0x03bc3a19cd1e38e9LLU,
+  0xfb5878494ace3a5fLLU, 0x04ab48a04065c723LLU,
+  0x9d174b2dcec0e47bLLU, 0x62eb0d64283f9c76LLU,
+  0xc45d1df942711d9aLLU, 0x3ba5d0bd324f8394LLU,
+  0xf5746577930d6500LLU, 0xca8f44ec7ee36479LLU,
+  0x9968bf6abbe85f20LLU, 0x7e998b13cf4e1ecbLLU,
+  0xbfc2ef456ae276e8LLU, 0x9e3fedd8c321a67eLLU,
+  0xefb3ab16c59b14a2LLU, 0xc5cfe94ef3ea101eLLU,
+  0x95d04aee3b80ece5LLU, 0xbba1f1d158724a12LLU,
+  0xbb445da9ca61281fLLU, 0x2a8a6e45ae8edc97LLU,
+  0xea1575143cf97226LLU, 0xf52d09d71a3293bdLLU,
+  0x924d692ca61be758LLU, 0x593c2626705f9c56LLU,
+  0xb6e0c377cfa2e12eLLU, 0x6f8b2fb00c77836cLLU,
+  0xe498f455c38b997aLLU, 0x0b6dfb9c0f956447LLU,
+  0x8edf98b59a373fecLLU, 0x4724bd4189bd5eacLLU,
+  0xb2977ee300c50fe7LLU, 0x58edec91ec2cb657LLU,
+  0xdf3d5e9bc0f653e1LLU, 0x2f2967b66737e3edLLU,
+  0x8b865b215899f46cLLU, 0xbd79e0d20082ee74LLU,
+  0xae67f1e9aec07187LLU, 0xecd8590680a3aa11LLU,
+  0xda01ee641a708de9LLU, 0xe80e6f4820cc9495LLU,
+  0x884134fe908658b2LLU, 0x3109058d147fdcddLLU,
+  0xaa51823e34a7eedeLLU, 0xbd4b46f0599fd415LLU,
+  0xd4e5e2cdc1d1ea96LLU, 0x6c9e18ac7007c91aLLU,
+  0x850fadc09923329eLLU, 0x03e2cf6bc604ddb0LLU,
+  0xa6539930bf6bff45LLU, 0x84db8346b786151cLLU,
+  0xcfe87f7cef46ff16LLU, 0xe612641865679a63LLU,
+  0x81f14fae158c5f6eLLU, 0x4fcb7e8f3f60c07eLLU,
+  0xa26da3999aef7749LLU, 0xe3be5e330f38f09dLLU,
+  0xcb090c8001ab551cLLU, 0x5cadf5bfd3072cc5LLU,
+  0xfdcb4fa002162a63LLU, 0x73d9732fc7c8f7f6LLU,
+  0x9e9f11c4014dda7eLLU, 0x2867e7fddcdd9afaLLU,
+  0xc646d63501a1511dLLU, 0xb281e1fd541501b8LLU,
+  0xf7d88bc24209a565LLU, 0x1f225a7ca91a4226LLU,
+  0x9ae757596946075fLLU, 0x3375788de9b06958LLU,
+  0xc1a12d2fc3978937LLU, 0x0052d6b1641c83aeLLU,
+  0xf209787bb47d6b84LLU, 0xc0678c5dbd23a49aLLU,
+  0x9745eb4d50ce6332LLU, 0xf840b7ba963646e0LLU,
+  0xbd176620a501fbffLLU, 0xb650e5a93bc3d898LLU,
+  0xec5d3fa8ce427affLLU, 0xa3e51f138ab4cebeLLU,
+  0x93ba47c980e98cdfLLU, 0xc66f336c36b10137LLU,
+  0xb8a8d9bbe123f017LLU, 0xb80b0047445d4184LLU,
+  0xe6d3102ad96cec1dLLU, 0xa60dc059157491e5LLU,
+  0x9043ea1ac7e41392LLU, 0x87c89837ad68db2fLLU,
+  0xb454e4a179dd1877LLU, 0x29babe4598c311fbLLU,
+  0xe16a1dc9d8545e94LLU, 0xf4296dd6fef3d67aLLU,
+  0x8ce2529e2734bb1dLLU, 0x1899e4a65f58660cLLU,
+  0xb01ae745b101e9e4LLU, 0x5ec05dcff72e7f8fLLU,
+  0xdc21a1171d42645dLLU, 0x76707543f4fa1f73LLU,
+  0x899504ae72497ebaLLU, 0x6a06494a791c53a8LLU,
+  0xabfa45da0edbde69LLU, 0x0487db9d17636892LLU,
+  0xd6f8d7509292d603LLU, 0x45a9d2845d3c42b6LLU,
+  0x865b86925b9bc5c2LLU, 0x0b8a2392ba45a9b2LLU,
+  0xa7f26836f282b732LLU, 0x8e6cac7768d7141eLLU,
+  0xd1ef0244af2364ffLLU, 0x3207d795430cd926LLU,
+  0x8335616aed761f1fLLU, 0x7f44e6bd49e807b8LLU,
+  0xa402b9c5a8d3a6e7LLU, 0x5f16206c9c6209a6LLU,
+  0xcd036837130890a1LLU, 0x36dba887c37a8c0fLLU,
+  0x802221226be55a64LLU, 0xc2494954da2c9789LLU,
+  0xa02aa96b06deb0fdLLU, 0xf2db9baa10b7bd6cLLU,
+  0xc83553c5c8965d3dLLU, 0x6f92829494e5acc7LLU,
+  0xfa42a8b73abbf48cLLU, 0xcb772339ba1f17f9LLU,
+  0x9c69a97284b578d7LLU, 0xff2a760414536efbLLU,
+  0xc38413cf25e2d70dLLU, 0xfef5138519684abaLLU,
+  0xf46518c2ef5b8cd1LLU, 0x7eb258665fc25d69LLU,
+  0x98bf2f79d5993802LLU, 0xef2f773ffbd97a61LLU,
+  0xbeeefb584aff8603LLU, 0xaafb550ffacfd8faLLU,
+  0xeeaaba2e5dbf6784LLU, 0x95ba2a53f983cf38LLU,
+  0x952ab45cfa97a0b2LLU, 0xdd945a747bf26183LLU,
+  0xba756174393d88dfLLU, 0x94f971119aeef9e4LLU,
+  0xe912b9d1478ceb17LLU, 0x7a37cd5601aab85dLLU,
+  0x91abb422ccb812eeLLU, 0xac62e055c10ab33aLLU,
+  0xb616a12b7fe617aaLLU, 0x577b986b314d6009LLU,
+  0xe39c49765fdf9d94LLU, 0xed5a7e85fda0b80bLLU,
+  0x8e41ade9fbebc27dLLU, 0x14588f13be847307LLU,
+  0xb1d219647ae6b31cLLU, 0x596eb2d8ae258fc8LLU,
+  0xde469fbd99a05fe3LLU, 0x6fca5f8ed9aef3bbLLU,
+  0x8aec23d680043beeLLU, 0x25de7bb9480d5854LLU,
+  0xada72ccc20054ae9LLU, 0xaf561aa79a10ae6aLLU,
+  0xd910f7ff28069da4LLU, 0x1b2ba1518094da04LLU,
+  0x87aa9aff79042286LLU, 0x90fb44d2f05d0842LLU,
+  0xa99541bf57452b28LLU, 0x353a1607ac744a53LLU,
+  0xd3fa922f2d1675f2LLU, 0x42889b8997915ce8LLU,
+  0x847c9b5d7c2e09b7LLU, 0x69956135febada11LLU,
+  0xa59bc234db398c25LLU, 0x43fab9837e699095LLU,
+  0xcf02b2c21207ef2eLLU, 0x94f967e45e03f4bbLLU,
+  0x8161afb94b44f57dLLU, 0x1d1be0eebac278f5LLU,
+  0xa1ba1ba79e1632dcLLU, 0x6462d92a69731732LLU,
+  0xca28a291859bbf93LLU, 0x7d7b8f7503cfdcfeLLU,
+  0xfcb2cb35e702af78LLU, 0x5cda735244c3d43eLLU,
+  0x9defbf01b061adabLLU, 0x3a0888136afa64a7LLU,
+  0xc56baec21c7a1916LLU, 0x088aaa1845b8fdd0LLU,
+  0xf6c69a72a3989f5bLLU, 0x8aad549e57273d45LLU,
+  0x9a3c2087a63f6399LLU, 0x36ac54e2f678864bLLU,
+  0xc0cb28a98fcf3c7fLLU, 0x84576a1bb416a7ddLLU,
+  0xf0fdf2d3f3c30b9fLLU, 0x656d44a2a11c51d5LLU,
+  0x969eb7c47859e743LLU, 0x9f644ae5a4b1b325LLU,
+  0xbc4665b596706114LLU, 0x873d5d9f0dde1feeLLU,
+  0xeb57ff22fc0c7959LLU, 0xa90cb506d155a7eaLLU,
+  0x9316ff75dd87cbd8LLU, 0x09a7f12442d588f2LLU,
+  0xb7dcbf5354e9beceLLU, 0x0c11ed6d538aeb2fLLU,
+  0xe5d3ef282a242e81LLU, 0x8f1668c8a86da5faLLU,
+  0x8fa475791a569d10LLU, 0xf96e017d694487bcLLU,
+  0xb38d92d760ec4455LLU, 0x37c981dcc395a9acLLU,
+  0xe070f78d3927556aLLU, 0x85bbe253f47b1417LLU,
+  0x8c469ab843b89562LLU, 0x93956d7478ccec8eLLU,
+  0xaf58416654a6babbLLU, 0x387ac8d1970027b2LLU,
+  0xdb2e51bfe9d0696aLLU, 0x06997b05fcc0319eLLU,
+  0x88fcf317f22241e2LLU, 0x441fece3bdf81f03LLU,
+  0xab3c2fddeeaad25aLLU, 0xd527e81cad7626c3LLU,
+  0xd60b3bd56a5586f1LLU, 0x8a71e223d8d3b074LLU,
+  0x85c7056562757456LLU, 0xf6872d5667844e49LLU,
+  0xa738c6bebb12d16cLLU, 0xb428f8ac016561dbLLU,
+  0xd106f86e69d785c7LLU, 0xe13336d701beba52LLU,
+  0x82a45b450226b39cLLU, 0xecc0024661173473LLU,
+  0xa34d721642b06084LLU, 0x27f002d7f95d0190LLU,
+  0xcc20ce9bd35c78a5LLU, 0x31ec038df7b441f4LLU,
+  0xff290242c83396ceLLU, 0x7e67047175a15271LLU,
+  0x9f79a169bd203e41LLU, 0x0f0062c6e984d386LLU,
+  0xc75809c42c684dd1LLU, 0x52c07b78a3e60868LLU,
+  0xf92e0c3537826145LLU, 0xa7709a56ccdf8a82LLU,
+  0x9bbcc7a142b17ccbLLU, 0x88a66076400bb691LLU,
+  0xc2abf989935ddbfeLLU, 0x6acff893d00ea435LLU,
+  0xf356f7ebf83552feLLU, 0x0583f6b8c4124d43LLU,
+  0x98165af37b2153deLLU, 0xc3727a337a8b704aLLU,
+  0xbe1bf1b059e9a8d6LLU, 0x744f18c0592e4c5cLLU,
+  0xeda2ee1c7064130cLLU, 0x1162def06f79df73LLU,
+  0x9485d4d1c63e8be7LLU, 0x8addcb5645ac2ba8LLU,
+  0xb9a74a0637ce2ee1LLU, 0x6d953e2bd7173692LLU,
+  0xe8111c87c5c1ba99LLU, 0xc8fa8db6ccdd0437LLU,
+  0x910ab1d4db9914a0LLU, 0x1d9c9892400a22a2LLU,
+  0xb54d5e4a127f59c8LLU, 0x2503beb6d00cab4bLLU,
+  0xe2a0b5dc971f303aLLU, 0x2e44ae64840fd61dLLU,
+  0x8da471a9de737e24LLU, 0x5ceaecfed289e5d2LLU,
+  0xb10d8e1456105dadLLU, 0x7425a83e872c5f47LLU,
+  0xdd50f1996b947518LLU, 0xd12f124e28f77719LLU,
+  0x8a5296ffe33cc92fLLU, 0x82bd6b70d99aaa6fLLU,
+  0xace73cbfdc0bfb7bLLU, 0x636cc64d1001550bLLU,
+  0xd8210befd30efa5aLLU, 0x3c47f7e05401aa4eLLU,
+  0x8714a775e3e95c78LLU, 0x65acfaec34810a71LLU,
+  0xa8d9d1535ce3b396LLU, 0x7f1839a741a14d0dLLU,
+  0xd31045a8341ca07cLLU, 0x1ede48111209a050LLU,
+  0x83ea2b892091e44dLLU, 0x934aed0aab460432LLU,
+  0xa4e4b66b68b65d60LLU, 0xf81da84d5617853fLLU,
+  0xce1de40642e3f4b9LLU, 0x36251260ab9d668eLLU,
+  0x80d2ae83e9ce78f3LLU, 0xc1d72b7c6b426019LLU,
+  0xa1075a24e4421730LLU, 0xb24cf65b8612f81fLLU,
+  0xc94930ae1d529cfcLLU, 0xdee033f26797b627LLU,
+  0xfb9b7cd9a4a7443cLLU, 0x169840ef017da3b1LLU,
+  0x9d412e0806e88aa5LLU, 0x8e1f289560ee864eLLU,
+  0xc491798a08a2ad4eLLU, 0xf1a6f2bab92a27e2LLU,
+  0xf5b5d7ec8acb58a2LLU, 0xae10af696774b1dbLLU,
+  0x9991a6f3d6bf1765LLU, 0xacca6da1e0a8ef29LLU,
+  0xbff610b0cc6edd3fLLU, 0x17fd090a58d32af3LLU,
+  0xeff394dcff8a948eLLU, 0xddfc4b4cef07f5b0LLU,
+  0x95f83d0a1fb69cd9LLU, 0x4abdaf101564f98eLLU,
+  0xbb764c4ca7a4440fLLU, 0x9d6d1ad41abe37f1LLU,
+  0xea53df5fd18d5513LLU, 0x84c86189216dc5edLLU,
+  0x92746b9be2f8552cLLU, 0x32fd3cf5b4e49bb4LLU,
+  0xb7118682dbb66a77LLU, 0x3fbc8c33221dc2a1LLU,
+  0xe4d5e82392a40515LLU, 0x0fabaf3feaa5334aLLU,
+  0x8f05b1163ba6832dLLU, 0x29cb4d87f2a7400eLLU,
+  0xb2c71d5bca9023f8LLU, 0x743e20e9ef511012LLU,
+  0xdf78e4b2bd342cf6LLU, 0x914da9246b255416LLU,
+  0x8bab8eefb6409c1aLLU, 0x1ad089b6c2f7548eLLU,
+  0xae9672aba3d0c320LLU, 0xa184ac2473b529b1LLU,
+  0xda3c0f568cc4f3e8LLU, 0xc9e5d72d90a2741eLLU,
+  0x8865899617fb1871LLU, 0x7e2fa67c7a658892LLU,
+  0xaa7eebfb9df9de8dLLU, 0xddbb901b98feeab7LLU,
+  0xd51ea6fa85785631LLU, 0x552a74227f3ea565LLU,
+  0x8533285c936b35deLLU, 0xd53a88958f87275fLLU,
+  0xa67ff273b8460356LLU, 0x8a892abaf368f137LLU,
+  0xd01fef10a657842cLLU, 0x2d2b7569b0432d85LLU,
+  0x8213f56a67f6b29bLLU, 0x9c3b29620e29fc73LLU,
+  0xa298f2c501f45f42LLU, 0x8349f3ba91b47b8fLLU,
+  0xcb3f2f7642717713LLU, 0x241c70a936219a73LLU,
+  0xfe0efb53d30dd4d7LLU, 0xed238cd383aa0110LLU,
+  0x9ec95d1463e8a506LLU, 0xf4363804324a40aaLLU,
+  0xc67bb4597ce2ce48LLU, 0xb143c6053edcd0d5LLU,
+  0xf81aa16fdc1b81daLLU, 0xdd94b7868e94050aLLU,
+  0x9b10a4e5e9913128LLU, 0xca7cf2b4191c8326LLU,
+  0xc1d4ce1f63f57d72LLU, 0xfd1c2f611f63a3f0LLU,
+  0xf24a01a73cf2dccfLLU, 0xbc633b39673c8cecLLU,
+  0x976e41088617ca01LLU, 0xd5be0503e085d813LLU,
+  0xbd49d14aa79dbc82LLU, 0x4b2d8644d8a74e18LLU,
+  0xec9c459d51852ba2LLU, 0xddf8e7d60ed1219eLLU,
+  0x93e1ab8252f33b45LLU, 0xcabb90e5c942b503LLU,
+  0xb8da1662e7b00a17LLU, 0x3d6a751f3b936243LLU,
+  0xe7109bfba19c0c9dLLU, 0x0cc512670a783ad4LLU,
+  0x906a617d450187e2LLU, 0x27fb2b80668b24c5LLU,
+  0xb484f9dc9641e9daLLU, 0xb1f9f660802dedf6LLU,
+  0xe1a63853bbd26451LLU, 0x5e7873f8a0396973LLU,
+  0x8d07e33455637eb2LLU, 0xdb0b487b6423e1e8LLU,
+  0xb049dc016abc5e5fLLU, 0x91ce1a9a3d2cda62LLU,
+  0xdc5c5301c56b75f7LLU, 0x7641a140cc7810fbLLU,
+  0x89b9b3e11b6329baLLU, 0xa9e904c87fcb0a9dLLU,
+  0xac2820d9623bf429LLU, 0x546345fa9fbdcd44LLU,
+  0xd732290fbacaf133LLU, 0xa97c177947ad4095LLU,
+  0x867f59a9d4bed6c0LLU, 0x49ed8eabcccc485dLLU,
+  0xa81f301449ee8c70LLU, 0x5c68f256bfff5a74LLU,
+  0xd226fc195c6a2f8cLLU, 0x73832eec6fff3111LLU,
+  0x83585d8fd9c25db7LLU, 0xc831fd53c5ff7eabLLU,
+  0xa42e74f3d032f525LLU, 0xba3e7ca8b77f5e55LLU,
+  0xcd3a1230c43fb26fLLU, 0x28ce1bd2e55f35ebLLU,
+  0x80444b5e7aa7cf85LLU, 0x7980d163cf5b81b3LLU,
+  0xa0555e361951c366LLU, 0xd7e105bcc332621fLLU,
+  0xc86ab5c39fa63440LLU, 0x8dd9472bf3fefaa7LLU,
+  0xfa856334878fc150LLU, 0xb14f98f6f0feb951LLU,
+  0x9c935e00d4b9d8d2LLU, 0x6ed1bf9a569f33d3LLU,
+  0xc3b8358109e84f07LLU, 0x0a862f80ec4700c8LLU,
+  0xf4a642e14c6262c8LLU, 0xcd27bb612758c0faLLU,
+  0x98e7e9cccfbd7dbdLLU, 0x8038d51cb897789cLLU,
+  0xbf21e44003acdd2cLLU, 0xe0470a63e6bd56c3LLU,
+  0xeeea5d5004981478LLU, 0x1858ccfce06cac74LLU,
+  0x95527a5202df0ccbLLU, 0x0f37801e0c43ebc8LLU,
+  0xbaa718e68396cffdLLU, 0xd30560258f54e6baLLU,
+  0xe950df20247c83fdLLU, 0x47c6b82ef32a2069LLU,
+  0x91d28b7416cdd27eLLU, 0x4cdc331d57fa5441LLU,
+  0xb6472e511c81471dLLU, 0xe0133fe4adf8e952LLU,
+  0xe3d8f9e563a198e5LLU, 0x58180fddd97723a6LLU,
+  0x8e679c2f5e44ff8fLLU, 0x570f09eaa7ea7648LLU,
+  0xb201833b35d63f73LLU, 0x2cd2cc6551e513daLLU,
+  0xde81e40a034bcf4fLLU, 0xf8077f7ea65e58d1LLU,
+  0x8b112e86420f6191LLU, 0xfb04afaf27faf782LLU,
+  0xadd57a27d29339f6LLU, 0x79c5db9af1f9b563LLU,
+  0xd94ad8b1c7380874LLU, 0x18375281ae7822bcLLU,
+  0x87cec76f1c830548LLU, 0x8f2293910d0b15b5LLU,
+  0xa9c2794ae3a3c69aLLU, 0xb2eb3875504ddb22LLU,
+  0xd433179d9c8cb841LLU, 0x5fa60692a46151ebLLU,
+  0x849feec281d7f328LLU, 0xdbc7c41ba6bcd333LLU,
+  0xa5c7ea73224deff3LLU, 0x12b9b522906c0800LLU,
+  0xcf39e50feae16befLLU, 0xd768226b34870a00LLU,
+  0x81842f29f2cce375LLU, 0xe6a1158300d46640LLU,
+  0xa1e53af46f801c53LLU, 0x60495ae3c1097fd0LLU,
+  0xca5e89b18b602368LLU, 0x385bb19cb14bdfc4LLU,
+  0xfcf62c1dee382c42LLU, 0x46729e03dd9ed7b5LLU,
+  0x9e19db92b4e31ba9LLU, 0x6c07a2c26a8346d1LLU
+};
+
+static const double kExactPow10[] = {1, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22};
+
+static inline uint64_t MultiplyU64To128(uint64_t aa, uint64_t bb, uint64_t* lo_ptr) {
+  const unsigned __int128 product = S_CAST(unsigned __int128, aa) * bb;
+  *lo_ptr = S_CAST(uint64_t, product);
+  return S_CAST(uint64_t, product >> 64);
+}
+
+// Eisel-Lemire conversion of digits * 10^e10, where digits is nonzero and
+// e10 is in [-342, 308].  Returns 1 when the result can't be determined
+// cheaply (rounding too close to call, or subnormal/overflowing result); the
+// caller must then fall back on strtod().
+static BoolErr EiselLemire(uint64_t digits, int32_t e10, uint32_t is_negative, double* valp) {
+  const uint64_t* pow10_words = &(kPow10Floor128[2 * (e10 - kPow10Floor128Min)]);
+  int32_t lz = 63 - bsrw(digits);
+  digits <<= lz;
+  uint64_t lower;
+  uint64_t upper = MultiplyU64To128(digits, pow10_words[0], &lower);
+  // The table entries are truncated, so the true product may be slightly
+  // larger.  Only look at the second word when that could carry into the
+  // bits we keep.
+  if (((upper & 0x1ff) == 0x1ff) && (lower + digits < lower)) {
+    uint64_t product_low;
+    const uint64_t product_middle2 = MultiplyU64To128(digits, pow10_words[1], &product_low);
+    const uint64_t product_middle = lower + product_middle2;
+    upper += (product_middle < lower);
+    if ((product_middle + 1 == 0) && ((upper & 0x1ff) == 0x1ff) && (product_low + digits < product_low)) {
+      return 1;
+    }
+    lower = product_middle;
+  }
+  const uint64_t upperbit = upper >> 63;
+  uint64_t mantissa = upper >> (upperbit + 9);
+  lz += 1 ^ upperbit;
+  if ((!lower) && (!(upper & 0x1ff)) && ((mantissa & 3) == 1)) {
+    // possible round-half-even tie
+    return 1;
+  }
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= (1LLU << 53)) {
+    mantissa = 1LLU << 52;
+    --lz;
+  }
+  mantissa &= ~(1LLU << 52);
+  // ((152170 + 65536) * e10) >> 16 == floor(log2(10^e10))
+  const int64_t biased_exponent = (((152170 + 65536) * S_CAST(int64_t, e10)) >> 16) + 1024 + 63 - lz;
+  if ((biased_exponent < 1) || (biased_exponent > 2046)) {
+    return 1;
+  }
+  mantissa |= S_CAST(uint64_t, biased_exponent) << 52;
+  mantissa |= S_CAST(uint64_t, is_negative) << 63;
+  memcpy(valp, &mantissa, 8);
+  return 0;
+}
+#endif
+
 CXXCONST_CP ScanadvDouble(const char* str_iter, double* valp) {
   // requires first character to be nonspace (to succeed; it fails without
   //   segfaulting on space/eoln/null)
   // don't care about hexadecimal
-  // ok to lose last ~2 bits of precision
+  // 64-bit builds round correctly (Clinger fast path, then Eisel-Lemire, then
+  //   strtod() for the rare remaining cases); 32-bit builds may lose the last
+  //   ~2 bits of precision
   // ok if behavior undefined on >1GB strings in 32-bit case, >2GB for 64-bit
   // fail on nan/infinity/overflow instead of usual strtod behavior
+#ifdef __LP64__
+  const char* num_start = str_iter;
+  uint32_t digits_truncated = 0;
+#endif
   uint32_t cur_char_code = ctou32(*str_iter);
   const uint32_t is_negative = (cur_char_code == 45);
   if (is_negative || (cur_char_code == 43)) {
@@ -1130,19 +1871,22 @@ CXXCONST_CP ScanadvDouble(const char* str_iter, double* valp) {
       }
       digits = digits * 10 + cur_digit;
     } while (digits < 10000000000000000LL);
-    // we have 17 significant digits; count the rest, but don't worry about
-    // contents
-    // (could keep ~19 instead, but if we're systematically losing the last two
-    // bits of precision anyway...)
+    // we have 17 significant digits; count the rest, and note whether any of
+    // them are nonzero (if so, the strtod() fallback handles this case
+    // exactly)
     const char* last_sig_fig_ptr = str_iter;
-    do {
+    cur_digit = ctou32(*(++str_iter)) - 48;
+    while (cur_digit < 10) {
+      digits_truncated |= cur_digit;
       cur_digit = ctou32(*(++str_iter)) - 48;
-    } while (cur_digit < 10);
+    }
     e10 = S_CAST(intptr_t, str_iter - last_sig_fig_ptr) - 1;
     if (cur_digit == 0xfffffffeU) {
-      do {
+      cur_digit = ctou32(*(++str_iter)) - 48;
+      while (cur_digit < 10) {
+        digits_truncated |= cur_digit;
         cur_digit = ctou32(*(++str_iter)) - 48;
-      } while (cur_digit < 10);
+      }
     }
     goto ScanadvDouble_parse_exponent;
   }
@@ -1166,9 +1910,11 @@ CXXCONST_CP ScanadvDouble(const char* str_iter, double* valp) {
     digits = digits * 10 + cur_digit;
     if (digits >= 10000000000000000LL) {
       e10 = -S_CAST(intptr_t, str_iter - dot_ptr);
-      do {
+      cur_digit = ctou32(*(++str_iter)) - 48;
+      while (cur_digit < 10) {
+        digits_truncated |= cur_digit;
         cur_digit = ctou32(*(++str_iter)) - 48;
-      } while (cur_digit < 10);
+      }
       break;
     }
   }
@@ -1320,6 +2066,42 @@ CXXCONST_CP ScanadvDouble(const char* str_iter, double* valp) {
     *valp = 0;
     return S_CAST(CXXCONST_CP, str_iter);
   }
+#ifdef __LP64__
+  if (!digits_truncated) {
+    if ((digits <= (1LL << 53)) && (e10 >= -22) && (e10 <= 22)) {
+      // Clinger fast path: both operands are exact, so the single
+      // multiplication/division rounds correctly.
+      double dxx = S_CAST(double, digits);
+      if (e10 < 0) {
+        dxx /= kExactPow10[-e10];
+      } else {
+        dxx *= kExactPow10[e10];
+      }
+      *valp = is_negative? -dxx : dxx;
+      return S_CAST(CXXCONST_CP, str_iter);
+    }
+    if (e10 < kPow10Floor128Min) {
+      // digits < 10^17, so this is below half the smallest subnormal
+      *valp = is_negative? -0.0 : 0.0;
+      return S_CAST(CXXCONST_CP, str_iter);
+    }
+    if (e10 > 308) {
+      return nullptr;
+    }
+    if (!EiselLemire(digits, e10, is_negative, valp)) {
+      return S_CAST(CXXCONST_CP, str_iter);
+    }
+  }
+  // Rare: >17 nonzero significant digits, an Eisel-Lemire ambiguity, or a
+  // subnormal/overflowing result.  strtod() parses exactly the prefix we just
+  // validated.
+  const double dxx = strtod(num_start, nullptr);
+  if (fabs(dxx) > DBL_MAX) {
+    return nullptr;
+  }
+  *valp = dxx;
+  return S_CAST(CXXCONST_CP, str_iter);
+#else
   if (is_negative) {
     digits = -digits;
   }
@@ -1361,6 +2143,7 @@ CXXCONST_CP ScanadvDouble(const char* str_iter, double* valp) {
   }
   *valp = dxx;
   return S_CAST(CXXCONST_CP, str_iter);
+#endif
 }
 
 CXXCONST_CP ScanadvLn(const char* str_iter, double* ln_ptr) {
@@ -1861,6 +2644,41 @@ const char* CsvLexK(const char* str_iter, const uint32_t* col_types, const uint3
 }
 #endif
 
+#ifdef __LP64__
+uint32_t CountTokens(const char* str_iter) {
+  // Token starts are the 0->1 transitions of the (byte > 32) mask; the line
+  // ends at the first byte < 32 which isn't a tab.  Treating the byte before
+  // str_iter as a delimiter means a partial leading token is still counted,
+  // as it is by the scalar version.
+  const uintptr_t starting_addr = R_CAST(uintptr_t, str_iter);
+  const VecUc* str_viter = R_CAST(const VecUc*, RoundDownPow2(starting_addr, kBytesPerVec));
+  const VecUc vvec_all_tab = vecuc_set1(9);
+  const VecUc vvec_all95 = vecuc_set1(95);
+  const VecUc vvec_all96 = vecuc_set1(96);
+  const uint32_t leading_byte_ct = starting_addr - R_CAST(uintptr_t, str_viter);
+  const uint32_t leading_mask = S_CAST(Vec8thUint, UINT32_MAX << leading_byte_ct);
+  VecUc cur_vvec = *str_viter;
+  VecUc tab_vvec = (cur_vvec == vvec_all_tab);
+  uint32_t token_bytes = leading_mask & vecuc_movemask(vecuc_adds(cur_vvec, vvec_all95));
+  uint32_t terminating_bytes = leading_mask & S_CAST(Vec8thUint, ~(vecuc_movemask(vecuc_adds(cur_vvec, vvec_all96)) | vecuc_movemask(tab_vvec)));
+  uint32_t prev_token_highbit = 0;
+  uint32_t token_ct = 0;
+  while (1) {
+    uint32_t token_starts = token_bytes & (~((token_bytes << 1) | prev_token_highbit));
+    if (terminating_bytes) {
+      token_starts &= (terminating_bytes & (-terminating_bytes)) - 1;
+      return token_ct + PopcountVec8thUint(token_starts);
+    }
+    token_ct += PopcountVec8thUint(token_starts);
+    prev_token_highbit = token_bytes >> (kBytesPerVec - 1);
+    ++str_viter;
+    cur_vvec = *str_viter;
+    tab_vvec = (cur_vvec == vvec_all_tab);
+    token_bytes = vecuc_movemask(vecuc_adds(cur_vvec, vvec_all95));
+    terminating_bytes = S_CAST(Vec8thUint, ~(vecuc_movemask(vecuc_adds(cur_vvec, vvec_all96)) | vecuc_movemask(tab_vvec)));
+  }
+}
+#else
 uint32_t CountTokens(const char* str_iter) {
   uint32_t token_ct = 0;
   str_iter = FirstNonTspace(str_iter);
@@ -1870,6 +2688,156 @@ uint32_t CountTokens(const char* str_iter) {
   }
   return token_ct;
 }
+#endif
+
+void ClassifyTextBytes(const char* buf, uintptr_t byte_ct, uintptr_t* __restrict newline_bits, uintptr_t* __restrict tab_bits, uintptr_t* __restrict space_bits, uintptr_t* __restrict token_start_bits) {
+  const uintptr_t word_ct = DivUp(byte_ct, kBitsPerWord);
+  uintptr_t prev_token_highbit = 0;
+  uintptr_t widx = 0;
+#ifdef __LP64__
+  const uintptr_t fullword_ct = byte_ct / kBitsPerWord;
+  const VecUc vvec_all_nl = vecuc_set1(10);
+  const VecUc vvec_all_tab = vecuc_set1(9);
+  const VecUc vvec_all_space = vecuc_set1(32);
+  const VecUc vvec_all95 = vecuc_set1(95);
+  const char* buf_iter = buf;
+  for (; widx != fullword_ct; ++widx) {
+    uintptr_t newline_word = 0;
+    uintptr_t tab_word = 0;
+    uintptr_t space_word = 0;
+    uintptr_t token_word = 0;
+    for (uint32_t vidx = 0; vidx != kBitsPerWord / kBytesPerVec; ++vidx) {
+      const VecUc cur_vvec = vecuc_loadu(buf_iter);
+      buf_iter = &(buf_iter[kBytesPerVec]);
+      const VecUc nl_vvec = (cur_vvec == vvec_all_nl);
+      const VecUc tab_vvec = (cur_vvec == vvec_all_tab);
+      const VecUc space_vvec = (cur_vvec == vvec_all_space);
+      const uint32_t shift = vidx * kBytesPerVec;
+      newline_word |= S_CAST(uintptr_t, vecuc_movemask(nl_vvec)) << shift;
+      tab_word |= S_CAST(uintptr_t, vecuc_movemask(tab_vvec)) << shift;
+      space_word |= S_CAST(uintptr_t, vecuc_movemask(space_vvec)) << shift;
+      token_word |= S_CAST(uintptr_t, vecuc_movemask(vecuc_adds(cur_vvec, vvec_all95))) << shift;
+    }
+    newline_bits[widx] = newline_word;
+    tab_bits[widx] = tab_word;
+    space_bits[widx] = space_word;
+    token_start_bits[widx] = token_word & (~((token_word << 1) | prev_token_highbit));
+    prev_token_highbit = token_word >> (kBitsPerWord - 1);
+  }
+#endif
+  // Trailing partial word (or everything, in 32-bit builds).
+  for (; widx != word_ct; ++widx) {
+    const unsigned char* cur_buf = R_CAST(const unsigned char*, &(buf[widx * kBitsPerWord]));
+    const uint32_t cur_byte_ct = MINV(byte_ct - widx * kBitsPerWord, kBitsPerWord);
+    uintptr_t newline_word = 0;
+    uintptr_t tab_word = 0;
+    uintptr_t space_word = 0;
+    uintptr_t token_word = 0;
+    for (uint32_t uii = 0; uii != cur_byte_ct; ++uii) {
+      const uint32_t ucc = cur_buf[uii];
+      const uintptr_t cur_bit = k1LU << uii;
+      if (ucc > 32) {
+        token_word |= cur_bit;
+      } else if (ucc == 10) {
+        newline_word |= cur_bit;
+      } else if (ucc == 9) {
+        tab_word |= cur_bit;
+      } else if (ucc == 32) {
+        space_word |= cur_bit;
+      }
+    }
+    newline_bits[widx] = newline_word;
+    tab_bits[widx] = tab_word;
+    space_bits[widx] = space_word;
+    token_start_bits[widx] = token_word & (~((token_word << 1) | prev_token_highbit));
+    prev_token_highbit = token_word >> (kBitsPerWord - 1);
+  }
+}
+
+uintptr_t MaskNextTokenMult(const uintptr_t* __restrict token_start_bits, const uintptr_t* __restrict newline_bits, uintptr_t pos, uintptr_t end, uint32_t ct) {
+  // assert(ct);
+  ++pos;
+  if (pos >= end) {
+    return UINTPTR_MAX;
+  }
+  uintptr_t widx = pos / kBitsPerWord;
+  const uintptr_t leading_mask = (~k0LU) << (pos % kBitsPerWord);
+  uintptr_t token_starts = token_start_bits[widx] & leading_mask;
+  uintptr_t newlines = newline_bits[widx] & leading_mask;
+  while (1) {
+    if (newlines) {
+      token_starts &= (newlines & (-newlines)) - 1;
+    }
+    const uint32_t cur_ct = PopcountWord(token_starts);
+    if (cur_ct >= ct) {
+      const uintptr_t result = widx * kBitsPerWord + WordBitIdxToUidx(token_starts, ct - 1);
+      return (result < end)? result : UINTPTR_MAX;
+    }
+    if (newlines) {
+      return UINTPTR_MAX;
+    }
+    ct -= cur_ct;
+    ++widx;
+    if (widx * kBitsPerWord >= end) {
+      return UINTPTR_MAX;
+    }
+    token_starts = token_start_bits[widx];
+    newlines = newline_bits[widx];
+  }
+}
+
+uintptr_t MaskAdvToNthDelim(const uintptr_t* delim_bits, uintptr_t pos, uintptr_t end, uint32_t ct) {
+  // assert(ct);
+  if (pos >= end) {
+    return UINTPTR_MAX;
+  }
+  uintptr_t widx = pos / kBitsPerWord;
+  uintptr_t cur_bits = delim_bits[widx] & ((~k0LU) << (pos % kBitsPerWord));
+  while (1) {
+    const uint32_t cur_ct = PopcountWord(cur_bits);
+    if (cur_ct >= ct) {
+      const uintptr_t result = widx * kBitsPerWord + WordBitIdxToUidx(cur_bits, ct - 1);
+      return (result < end)? result : UINTPTR_MAX;
+    }
+    ct -= cur_ct;
+    ++widx;
+    if (widx * kBitsPerWord >= end) {
+      return UINTPTR_MAX;
+    }
+    cur_bits = delim_bits[widx];
+  }
+}
+
+uint32_t MaskCountTokens(const uintptr_t* __restrict token_start_bits, const uintptr_t* __restrict newline_bits, uintptr_t pos, uintptr_t end) {
+  if (pos >= end) {
+    return 0;
+  }
+  uintptr_t widx = pos / kBitsPerWord;
+  const uintptr_t last_widx = (end - 1) / kBitsPerWord;
+  const uintptr_t leading_mask = (~k0LU) << (pos % kBitsPerWord);
+  uintptr_t token_starts = token_start_bits[widx] & leading_mask;
+  uintptr_t newlines = newline_bits[widx] & leading_mask;
+  uint32_t token_ct = 0;
+  while (1) {
+    if (widx == last_widx) {
+      const uint32_t trailing_bit_ct = end % kBitsPerWord;
+      if (trailing_bit_ct) {
+        token_starts &= (k1LU << trailing_bit_ct) - 1;
+      }
+    }
+    if (newlines) {
+      token_starts &= (newlines & (-newlines)) - 1;
+      return token_ct + PopcountWord(token_starts);
+    }
+    token_ct += PopcountWord(token_starts);
+    if (widx == last_widx) {
+      return token_ct;
+    }
+    ++widx;
+    token_starts = token_start_bits[widx];
+    newlines = newline_bits[widx];
+  }
+}
 
 /*
 uint32_t CommaOrSpaceCountTokens(const char* str_iter, uint32_t comma_delim) {
@@ -2911,6 +3879,172 @@ char* lntoa_g(double ln_val, char* start) {
   return u32toa(xp10, start);
 }
 
+#ifdef __LP64__
+static inline uint64_t RoundToOdd(uint64_t g_hi, uint64_t g_lo, uint64_t cp) {
+  uint64_t x_lo;
+  const uint64_t x_hi = MultiplyU64To128(g_lo, cp, &x_lo);
+  uint64_t y_lo;
+  uint64_t y_hi = MultiplyU64To128(g_hi, cp, &y_lo);
+  y_lo += x_hi;
+  y_hi += (y_lo < x_hi);
+  return y_hi | (y_lo > 1);
+}
+
+// Schubfach (Giulietti, "The Schubfach way to render doubles"): returns the
+// shortest decimal significand (possibly with trailing zeroes) which rounds
+// to the positive finite double with the given IEEE fields, and sets *e10_ptr
+// to its decimal exponent.
+static uint64_t ShortestDecimal(uint64_t ieee_significand, uint32_t ieee_exponent, int32_t* e10_ptr) {
+  uint64_t cc;
+  int32_t qq;
+  if (ieee_exponent) {
+    cc = ieee_significand | (1LLU << 52);
+    qq = S_CAST(int32_t, ieee_exponent) - 1075;
+    // small integers
+    if ((qq <= 0) && (qq > -53) && (!(cc & ((1LLU << (-qq)) - 1)))) {
+      *e10_ptr = 0;
+      return cc >> (-qq);
+    }
+  } else {
+    cc = ieee_significand;
+    qq = -1074;
+  }
+  const uint32_t is_even = !(cc & 1);
+  const uint32_t lower_boundary_is_closer = (!ieee_significand) && (ieee_exponent > 1);
+  const uint64_t cbl = 4 * cc - 2 + lower_boundary_is_closer;
+  const uint64_t cb = 4 * cc;
+  const uint64_t cbr = 4 * cc + 2;
+  // (qq * 1262611) >> 22 == floor(log10(2^qq))
+  // (qq * 1262611 - 524031) >> 22 == floor(log10(0.75 * 2^qq))
+  const int32_t kk = (qq * 1262611 - (lower_boundary_is_closer? 524031 : 0)) >> 22;
+  // (e * 1741647) >> 19 == floor(log2(10^e))
+  const int32_t hh = qq + ((-kk * 1741647) >> 19) + 1;
+  const uint64_t* pow10_words = &(kPow10Floor128[2 * (-kk - kPow10Floor128Min)]);
+  const uint64_t g_lo = pow10_words[1] + 1;
+  const uint64_t g_hi = pow10_words[0] + (!g_lo);
+  const uint64_t vbl = RoundToOdd(g_hi, g_lo, cbl << hh);
+  const uint64_t vb = RoundToOdd(g_hi, g_lo, cb << hh);
+  const uint64_t vbr = RoundToOdd(g_hi, g_lo, cbr << hh);
+  const uint64_t lower = vbl + (!is_even);
+  const uint64_t upper = vbr - (!is_even);
+  const uint64_t ss = vb / 4;
+  if (ss >= 10) {
+    // At most one of the two one-digit-shorter candidates is in range.
+    const uint64_t sp = ss / 10;
+    const uint32_t up_inside = (lower <= 40 * sp);
+    const uint32_t wp_inside = (40 * sp + 40 <= upper);
+    if (up_inside != wp_inside) {
+      *e10_ptr = kk + 1;
+      return sp + wp_inside;
+    }
+  }
+  const uint32_t u_inside = (lower <= 4 * ss);
+  const uint32_t w_inside = (4 * ss + 4 <= upper);
+  *e10_ptr = kk;
+  if (u_inside != w_inside) {
+    return ss + w_inside;
+  }
+  const uint64_t mid = 4 * ss + 2;
+  const uint32_t round_up = (vb > mid) || ((vb == mid) && (ss & 1));
+  return ss + round_up;
+}
+
+char* dtoa_r(double dxx, char* start) {
+  uint64_t ieee_bits;
+  memcpy(&ieee_bits, &dxx, 8);
+  const uint32_t ieee_exponent = (ieee_bits >> 52) & 0x7ff;
+  const uint64_t ieee_significand = ieee_bits & ((1LLU << 52) - 1);
+  if (ieee_exponent == 0x7ff) {
+    if (ieee_significand) {
+      return strcpya_k(start, "nan");
+    }
+    if (ieee_bits >> 63) {
+      *start++ = '-';
+    }
+    return strcpya_k(start, "inf");
+  }
+  if (ieee_bits >> 63) {
+    *start++ = '-';
+  }
+  if ((!ieee_exponent) && (!ieee_significand)) {
+    *start = '0';
+    return &(start[1]);
+  }
+  int32_t e10;
+  uint64_t significand = ShortestDecimal(ieee_significand, ieee_exponent, &e10);
+  while (!(significand % 10)) {
+    significand /= 10;
+    ++e10;
+  }
+  char digits[20];
+  const uint32_t digit_ct = i64toa(significand, digits) - digits;
+  // Same layout rules as %g with precision max(digit_ct, 6), so values with
+  // six or fewer significant digits print exactly as dtoa_g() prints them.
+  const int32_t xp10 = e10 + S_CAST(int32_t, digit_ct) - 1;
+  if ((xp10 < -4) || (xp10 >= S_CAST(int32_t, MAXV(digit_ct, 6)))) {
+    *start++ = digits[0];
+    if (digit_ct > 1) {
+      *start++ = '.';
+      start = memcpya(start, &(digits[1]), digit_ct - 1);
+    }
+    uint32_t abs_xp10;
+    if (xp10 < 0) {
+      start = memcpya_k(start, "e-", 2);
+      abs_xp10 = -xp10;
+    } else {
+      start = memcpya_k(start, "e+", 2);
+      abs_xp10 = xp10;
+    }
+    if (abs_xp10 >= 100) {
+      const uint32_t quotient = abs_xp10 / 100;
+      *start++ = '0' + quotient;
+      abs_xp10 -= 100 * quotient;
+    }
+    return memcpya_k(start, &(kDigitPair[abs_xp10]), 2);
+  }
+  if (xp10 < 0) {
+    start = memcpya_k(start, "0.", 2);
+    start = memseta(start, '0', -xp10 - 1);
+    return memcpya(start, digits, digit_ct);
+  }
+  if (S_CAST(uint32_t, xp10) >= digit_ct - 1) {
+    start = memcpya(start, digits, digit_ct);
+    return memseta(start, '0', xp10 + 1 - digit_ct);
+  }
+  start = memcpya(start, digits, xp10 + 1);
+  *start++ = '.';
+  return memcpya(start, &(digits[xp10 + 1]), digit_ct - 1 - xp10);
+}
+#else
+char* dtoa_r(double dxx, char* start) {
+  // No 128-bit multiply; just search for the shortest round-tripping %g
+  // precision.
+  if (dxx != dxx) {
+    return strcpya_k(start, "nan");
+  }
+  if (fabs(dxx) > DBL_MAX) {
+    return strcpya_k(start, (dxx < 0)? "-inf" : "inf");
+  }
+  char wbuf[32];
+  uint32_t slen = 0;
+  for (int32_t precision = 6; precision <= 17; ++precision) {
+    slen = snprintf(wbuf, 32, "%.*g", precision, dxx);
+    if (strtod(wbuf, nullptr) == dxx) {
+      break;
+    }
+  }
+  return memcpya(start, wbuf, slen);
+}
+#endif
+
+char* lntoa_r(double ln_val, char* start) {
+  // log(DBL_MAX)
+  if ((ln_val < kLnNormalMin) || (ln_val > 709.782712893384)) {
+    return lntoa_g(ln_val, start);
+  }
+  return dtoa_r(exp(ln_val), start);
+}
+
 // Previously had specialized float-printing functions, but upon reflection it
 // makes sense to just promote to double like printf does.
 
@@ -766,7 +766,8 @@ HEADER_INLINE CXXCONST_CP FirstPrechar(const char* str_iter, uint32_t char_code)
 //     strchrnul_n_mov, incr_strchrnul_n_mov
 //   NextTokenMultFar
 //   AdvToNthDelimChecked, AdvToNthDelim, AdvToDelimOrEnd, Memrchr,
-//     LastSpaceOrEoln
+//     LastSpaceOrEoln, CountTokens
+//   ClassifyTextBytes (whole-buffer bitmasks; see below)
 
 /*
 #ifdef __LP64__
@@ -1352,11 +1353,44 @@ HEADER_INLINE const char* CsvLexK(const char* str_iter, const uint32_t* col_type
 }
 #endif
 
-// todo: movemask version of this
+// Counts tab/space-delimited tokens up to the end of the line (any byte < 32
+// other than tab).  Movemask-based on 64-bit builds.
 uint32_t CountTokens(const char* str_iter);
 
 // uint32_t CommaOrSpaceCountTokens(const char* str_iter, uint32_t comma_delim);
 
+// Buffer-at-a-time text classification, in the style of simdjson's "stage 1":
+// one pass over buf[0..byte_ct) sets
+//   bit i of newline_bits iff buf[i] == '\n',
+//   bit i of tab_bits iff buf[i] == '\t',
+//   bit i of space_bits iff buf[i] == ' ', and
+//   bit i of token_start_bits iff buf[i] is a token character (code > 32)
+//     which either starts the buffer or follows a non-token character.
+// Each output array must have room for DivUp(byte_ct, kBitsPerWord) words;
+// trailing bits of the last word are cleared.  buf need not be aligned, and
+// nothing past buf[byte_ct - 1] is read.
+// Since only the newline mask ends a line for the Mask...() helpers below, a
+// stray control character in the middle of a line acts like a delimiter
+// there, instead of a line terminator as it does for NextTokenMult() etc.
+void ClassifyTextBytes(const char* buf, uintptr_t byte_ct, uintptr_t* __restrict newline_bits, uintptr_t* __restrict tab_bits, uintptr_t* __restrict space_bits, uintptr_t* __restrict token_start_bits);
+
+// Mask-based analogues of NextTokenMult(), AdvToNthDelimChecked(), and
+// CountTokens().  Positions are byte offsets into the buffer passed to
+// ClassifyTextBytes(), and end (<= byte_ct) bounds the search.  UINTPTR_MAX
+// plays the role of nullptr.
+
+// Offset of the ct-th token start after pos, or UINTPTR_MAX if the line ends
+// first.  ct must be positive.
+uintptr_t MaskNextTokenMult(const uintptr_t* __restrict token_start_bits, const uintptr_t* __restrict newline_bits, uintptr_t pos, uintptr_t end, uint32_t ct);
+
+// Offset of the ct-th set bit of delim_bits at or after pos.  ct must be
+// positive.
+uintptr_t MaskAdvToNthDelim(const uintptr_t* delim_bits, uintptr_t pos, uintptr_t end, uint32_t ct);
+
+// Number of tokens between pos and the end of its line.  pos must not be in
+// the middle of a token (a line start is always fine).
+uint32_t MaskCountTokens(const uintptr_t* __restrict token_start_bits, const uintptr_t* __restrict newline_bits, uintptr_t pos, uintptr_t end);
+
 // empty multistr ok
 uint32_t CountAndMeasureMultistr(const char* multistr, uintptr_t* max_blen_ptr);
 
@@ -1393,6 +1427,9 @@ CONSTI32(kMaxFloatGSlen, 12);
 
 CONSTI32(kMaxDoubleGSlen, 13);
 
+// -2.2250738585072014e-308
+CONSTI32(kMaxDoubleRSlen, 24);
+
 // 1.23456e-2147483647
 CONSTI32(kMaxLnGSlen, 19);
 
@@ -1414,6 +1451,34 @@ static const double kLnNormalMin = -708.3964185322641;
 
 char* lntoa_g(double ln_val, char* start);
 
+// Shortest representation which parses back (with ScanadvDouble() or strtod())
+// to exactly the same double.  Layout follows %g with precision
+// max(<digit count>, 6), so e.g. 0.25 and 1e-05 print identically to dtoa_g(),
+// while 0.1234567 prints in full instead of as 0.123457.
+char* dtoa_r(double dxx, char* start);
+
+// dtoa_r(exp(ln_val)) when that's a normal double, lntoa_g() otherwise.
+char* lntoa_r(double ln_val, char* start);
+
+// For report writers with a shortest-round-trip (--output-roundtrip) mode.
+// dtoa_g() stays the default: dtoa_r() can't reproduce its output (any value
+// needing more than 6 significant digits prints in full), and on full-
+// precision report values it's ~2.5x slower and writes ~2x the bytes (see
+// Tests/BENCH_FLOAT_TEXT).
+HEADER_INLINE char* dtoa_gr(double dxx, uint32_t roundtrip, char* start) {
+  if (roundtrip) {
+    return dtoa_r(dxx, start);
+  }
+  return dtoa_g(dxx, start);
+}
+
+HEADER_INLINE char* lntoa_gr(double ln_val, uint32_t roundtrip, char* start) {
+  if (roundtrip) {
+    return lntoa_r(ln_val, start);
+  }
+  return lntoa_g(ln_val, start);
+}
+
 HEADER_INLINE void TrailingZeroesToSpaces(char* start) {
   --start;
   while (*start == '0') {
@@ -17,6 +17,13 @@
 #include <errno.h>
 #include "plink2_text.h"
 
+#ifndef NO_TEXT_MMAP
+#  include <sys/types.h>  // fstat()
+#  include <sys/stat.h>  // fstat()
+#  include <sys/mman.h>  // mmap(), madvise()
+#  include <unistd.h>  // sysconf()
+#endif
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -184,6 +191,15 @@ PglErr TextFileOpenInternal(const char* fname, uint32_t enforced_max_line_blen,
       const uint32_t magic4 = *R_CAST(uint32_t*, dst);
       if (IsZstdFrame(magic4)) {
         trbp->dst_len = 0;
+        if (txsp && (txsp->decompress_thread_ct > 1)) {
+          trbp->file_type = kFileZstdSeekable;
+          reterr = ZstRawMtStreamInit(trbp->ff, txsp->decompress_thread_ct, &txsp->rds.zst_seekable, &trbp->errmsg);
+          if (reterr != kPglRetSkipped) {
+            // success or real error
+            goto TextFileOpenInternal_ret_1;
+          }
+          reterr = kPglRetSuccess;
+        }
         trbp->file_type = kFileZstd;
         ZstRawDecompressStream* zstp;
         if (txfp) {
@@ -219,6 +235,12 @@ PglErr TextFileOpenInternal(const char* fname, uint32_t enforced_max_line_blen,
               goto TextFileOpenInternal_ret_1;
             }
           }
+        } else if (txsp && (txsp->decompress_thread_ct > 1)) {
+          trbp->file_type = kFileGzipMt;
+          reterr = GzRawMtStreamInit(dst, nbytes, txsp->decompress_thread_ct, trbp->ff, &txsp->rds.gzmt, &trbp->errmsg);
+          if (unlikely(reterr)) {
+            goto TextFileOpenInternal_ret_1;
+          }
         } else {
           trbp->file_type = kFileGzip;
           GzRawDecompressStream* gzp;
@@ -336,7 +358,19 @@ PglErr GzRawStreamRead(char* dst_end, FILE* ff, GzRawDecompressStream* gzp, char
         return kPglRetDecompressFail;
       }
       dst_iter = R_CAST(char*, dsp->next_out);
-      if (dsp->avail_in) {
+      if (zerr == Z_STREAM_END) {
+        // Concatenated gzip members are permitted by the spec, and zlib's
+        // inflate() stops at the end of each one.
+#ifdef NDEBUG
+        inflateReset(dsp);
+#else
+        const int errcode = inflateReset(dsp);
+        assert(errcode == Z_OK);
+#endif
+        if (dsp->avail_in) {
+          continue;
+        }
+      } else if (dsp->avail_in) {
         assert(dst_iter == dst_end);
         break;
       }
@@ -586,6 +620,11 @@ PglErr TextFileAdvance(textFILE* txf_ptr) {
           }
           break;
         }
+      case kFileZstdSeekable:
+      case kFileGzipMt:
+        // TextStream-only.
+        assert(0);
+        break;
       }
       basep->dst_len = dst_iter - dst;
       if (!basep->dst_len) {
@@ -756,7 +795,111 @@ void PreinitTextStream(TextStream* txs_ptr) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   EraseTextFileBase(&txsp->base);
   txsp->syncp = nullptr;
+  txsp->mmap_start = nullptr;
+}
+
+uint32_t g_text_mmap_disabled = 0;
+
+#ifndef NO_TEXT_MMAP
+// Bytes handed to the consumer per TextAdvance() call in zero-copy mode.
+CONSTI32(kTextMmapChunkSize, 8 * kDecompressChunkSize);
+
+// Maps the already-opened base.ff.  Returns 1 on success, 0 if the caller
+// should fall back to the reader thread (not a regular file, mmap() failure,
+// etc.).
+static uint32_t TextStreamMmapInit(TextStreamMain* txsp) {
+  if (g_text_mmap_disabled) {
+    return 0;
+  }
+  const int32_t fd = fileno(txsp->base.ff);
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) || (!S_ISREG(statbuf.st_mode)) || (!statbuf.st_size)) {
+    return 0;
+  }
+  const uintptr_t file_size = statbuf.st_size;
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const uintptr_t file_map_size = RoundUpPow2(file_size, page_size);
+  // Reserve an extra anonymous page after the file contents.  This gives the
+  // appended '\n' a home even when the file size is a multiple of the page
+  // size, and keeps the usual vector-load overreads past the final '\n' safe.
+  const uintptr_t alloc_size = file_map_size + page_size;
+  void* reserved = mmap(nullptr, alloc_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserved == MAP_FAILED) {
+    return 0;
+  }
+  void* file_map = mmap(reserved, file_map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+  if (file_map == MAP_FAILED) {
+    munmap(reserved, alloc_size);
+    return 0;
+  }
+  char* mmap_start = S_CAST(char*, file_map);
+  madvise(mmap_start, file_map_size, MADV_SEQUENTIAL);
+  char* mmap_end = &(mmap_start[file_size]);
+  if (mmap_end[-1] != '\n') {
+    *mmap_end++ = '\n';
+  }
+  txsp->mmap_start = mmap_start;
+  txsp->mmap_end = mmap_end;
+  txsp->mmap_alloc_size = alloc_size;
+  TextFileBase* basep = &txsp->base;
+  basep->consume_iter = mmap_start;
+  basep->consume_stop = mmap_start;
+  basep->reterr = kPglRetSuccess;
+  return 1;
+}
+
+static PglErr TextMmapAdvance(TextStreamMain* txsp) {
+  TextFileBase* basep = &txsp->base;
+  char* chunk_start = basep->consume_iter;
+  const uintptr_t remaining_byte_ct = txsp->mmap_end - chunk_start;
+  if (!remaining_byte_ct) {
+    basep->reterr = kPglRetEof;
+    return kPglRetEof;
+  }
+  const uint32_t enforced_max_line_blen = basep->enforced_max_line_blen;
+  char* chunk_end;
+  if (enforced_max_line_blen) {
+    const uintptr_t target_byte_ct = MINV(kTextMmapChunkSize, enforced_max_line_blen);
+    if (remaining_byte_ct <= target_byte_ct) {
+      chunk_end = txsp->mmap_end;
+    } else {
+      // Any line ending in [chunk_start, chunk_start + target_byte_ct) is
+      // short enough.  If there are none, the first line must be checked
+      // against the limit directly.
+      char* last_lf = Memrchr(chunk_start, '\n', target_byte_ct);
+      if (!last_lf) {
+        const uintptr_t search_byte_ct = MINV(remaining_byte_ct, enforced_max_line_blen) - target_byte_ct;
+        last_lf = S_CAST(char*, memchr(&(chunk_start[target_byte_ct]), '\n', search_byte_ct));
+        if (unlikely(!last_lf)) {
+          goto TextMmapAdvance_LONG_LINE;
+        }
+      }
+      chunk_end = &(last_lf[1]);
+    }
+  } else {
+    if (remaining_byte_ct <= S_CAST(uintptr_t, kMaxTokenBlen)) {
+      chunk_end = txsp->mmap_end;
+    } else {
+      char* last_delim = LastSpaceOrEoln(chunk_start, kMaxTokenBlen);
+      if (unlikely(!last_delim)) {
+        goto TextMmapAdvance_LONG_LINE;
+      }
+      chunk_end = &(last_delim[1]);
+    }
+  }
+  basep->consume_stop = chunk_end;
+  return kPglRetSuccess;
+ TextMmapAdvance_LONG_LINE:
+  basep->errmsg = kShortErrLongLine;
+  basep->reterr = kPglRetMalformedInput;
+  return kPglRetMalformedInput;
+}
+
+static void TextMmapCleanup(TextStreamMain* txsp) {
+  munmap(txsp->mmap_start, txsp->mmap_alloc_size);
+  txsp->mmap_start = nullptr;
 }
+#endif
 
 // This type of code is especially bug-prone (ESR would call it a "defect
 // attractor").  Goal is to get it right, and fast enough to be a major win
@@ -790,6 +933,7 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
 #endif
   const uint32_t enforced_max_line_blen = basep->enforced_max_line_blen;
   const char* new_fname = nullptr;
+  uint64_t bgzf_voffset = 0;
   const uint32_t is_token_stream = (enforced_max_line_blen == 0);
   while (1) {
     TxsInterrupt interrupt = kTxsInterruptNone;
@@ -982,6 +1126,22 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
           }
           break;
         }
+      case kFileZstdSeekable:
+        {
+          reterr = ZstRawMtStreamRead(R_CAST(unsigned char*, cur_read_stop), &rdsp->zst_seekable, R_CAST(unsigned char**, &cur_read_end), &syncp->errmsg);
+          if (unlikely(reterr)) {
+            goto TextStreamThread_MISC_FAIL;
+          }
+          break;
+        }
+      case kFileGzipMt:
+        {
+          reterr = GzRawMtStreamRead(R_CAST(unsigned char*, cur_read_stop), &rdsp->gzmt, R_CAST(unsigned char**, &cur_read_end), &syncp->errmsg);
+          if (unlikely(reterr)) {
+            goto TextStreamThread_MISC_FAIL;
+          }
+          break;
+        }
       }
       if (cur_read_end < cur_read_stop) {
         char* final_read_head = cur_read_end;
@@ -1145,6 +1305,7 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
     // must be in critical section here, or be holding the mutex.
     if (interrupt == kTxsInterruptRetarget) {
       new_fname = syncp->new_fname;
+      bgzf_voffset = syncp->bgzf_voffset;
       syncp->interrupt = kTxsInterruptNone;
       syncp->reterr = kPglRetSuccess;
     }
@@ -1161,7 +1322,21 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
     read_head = buf;
     if (!new_fname) {
       if (file_type == kFileBgzf) {
-        reterr = BgzfRawMtStreamRewind(&rdsp->bgzf, &syncp->errmsg);
+        if (!bgzf_voffset) {
+          reterr = BgzfRawMtStreamRewind(&rdsp->bgzf, &syncp->errmsg);
+        } else {
+          reterr = BgzfRawMtStreamSeek(bgzf_voffset, &rdsp->bgzf, &syncp->errmsg);
+        }
+        if (unlikely(reterr)) {
+          goto TextStreamThread_MISC_FAIL;
+        }
+      } else if (file_type == kFileZstdSeekable) {
+        reterr = ZstRawMtStreamRewind(&rdsp->zst_seekable, &syncp->errmsg);
+        if (unlikely(reterr)) {
+          goto TextStreamThread_MISC_FAIL;
+        }
+      } else if (file_type == kFileGzipMt) {
+        reterr = GzRawMtStreamRewind(&rdsp->gzmt, &syncp->errmsg);
         if (unlikely(reterr)) {
           goto TextStreamThread_MISC_FAIL;
         }
@@ -1206,7 +1381,11 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
           }
         }
       }
-      if (file_type != next_file_type) {
+      // A Zstd file may or may not be seekable, so the type-specific
+      // resources are always rebuilt when multithreaded decoding is an
+      // option.  The multithreaded gzip decoder doesn't support in-place
+      // retargeting either.
+      if ((file_type != next_file_type) || (file_type == kFileZstdSeekable) || (file_type == kFileGzipMt) || ((next_file_type == kFileZstd) && (context->decompress_thread_ct > 1))) {
         // Destroy old type-specific resources, and allocate new ones.
         if (file_type == kFileGzip) {
           free(rdsp->gz.in);
@@ -1216,6 +1395,10 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
         } else if (file_type == kFileZstd) {
           free_const(rdsp->zst.ib.src);
           ZSTD_freeDStream(rdsp->zst.ds);
+        } else if (file_type == kFileZstdSeekable) {
+          CleanupZstRawMtStream(&rdsp->zst_seekable);
+        } else if (file_type == kFileGzipMt) {
+          CleanupGzRawMtStream(&rdsp->gzmt);
         }
 
         if (unlikely(fclose(ff))) {
@@ -1231,6 +1414,15 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
           read_head = &(read_head[nbytes]);
           break;
         case kFileGzip:
+          if (context->decompress_thread_ct > 1) {
+            file_type = kFileGzipMt;
+            basep->file_type = file_type;
+            reterr = GzRawMtStreamInit(buf, nbytes, context->decompress_thread_ct, ff, &rdsp->gzmt, &syncp->errmsg);
+            if (unlikely(reterr)) {
+              goto TextStreamThread_MISC_FAIL;
+            }
+            break;
+          }
           if (unlikely(GzRawInit(buf, nbytes, &rdsp->gz))) {
             goto TextStreamThread_NOMEM;
           }
@@ -1243,10 +1435,28 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
           // bugfix (5 Oct 2019): forgot this break
           break;
         case kFileZstd:
+          if (context->decompress_thread_ct > 1) {
+            file_type = kFileZstdSeekable;
+            basep->file_type = file_type;
+            reterr = ZstRawMtStreamInit(ff, context->decompress_thread_ct, &rdsp->zst_seekable, &syncp->errmsg);
+            if (reterr != kPglRetSkipped) {
+              if (unlikely(reterr)) {
+                goto TextStreamThread_MISC_FAIL;
+              }
+              break;
+            }
+            file_type = kFileZstd;
+            basep->file_type = file_type;
+          }
           if (unlikely(ZstRawInit(buf, nbytes, &rdsp->zst))) {
             goto TextStreamThread_NOMEM;
           }
           break;
+        case kFileZstdSeekable:
+        case kFileGzipMt:
+          // not produced by type detection
+          assert(0);
+          break;
         }
       } else {
         switch (file_type) {
@@ -1287,6 +1497,11 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
             zstp->ib.pos = 0;
             break;
           }
+        case kFileZstdSeekable:
+        case kFileGzipMt:
+          // handled above
+          assert(0);
+          break;
         }
         if (unlikely(fclose(ff))) {
           fclose(next_ff);
@@ -1303,23 +1518,24 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
 
 const char kShortErrRfileInvalid[] = "TextStreamOpenEx can't be called with a closed or error-state textFILE";
 
-PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint32_t dst_capacity, uint32_t decompress_thread_ct, textFILE* txf_ptr, char* dst, TextStream* txs_ptr) {
+static PglErr TextStreamOpenInternal(const char* fname, uint32_t enforced_max_line_blen, uint32_t dst_capacity, uint32_t decompress_thread_ct, textFILE* txf_ptr, char* dst, uint32_t readonly, TextStream* txs_ptr) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   TextFileBase* txs_basep = &txsp->base;
   PglErr reterr = kPglRetSuccess;
   {
     txsp->decompress_thread_ct = decompress_thread_ct;
+    txsp->readonly = readonly;
     if (txf_ptr) {
       // Move-construct (unless there was an error, or file is not opened)
       if (unlikely((!TextFileIsOpen(txf_ptr)) || TextFileErrcode(txf_ptr))) {
         reterr = kPglRetImproperFunctionCall;
         txs_basep->errmsg = kShortErrRfileInvalid;
-        goto TextStreamOpenEx_ret_1;
+        goto TextStreamOpenInternal_ret_1;
       }
       if (unlikely(TextIsOpen(txs_ptr))) {
         reterr = kPglRetImproperFunctionCall;
         txs_basep->errmsg = kShortErrRfileAlreadyOpen;
-        goto TextStreamOpenEx_ret_1;
+        goto TextStreamOpenInternal_ret_1;
       }
       textFILEMain* txfp = GetTxfp(txf_ptr);
       *txs_basep = txfp->base;  // struct copy
@@ -1345,7 +1561,7 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
           reterr = BgzfRawMtStreamInit(nullptr, decompress_thread_ct, txs_basep->ff, &txfp->rds.bgzf, &txsp->rds.bgzf, &txs_basep->errmsg);
           if (unlikely(reterr)) {
             EraseTextFileBase(&txfp->base);
-            goto TextStreamOpenEx_ret_1;
+            goto TextStreamOpenInternal_ret_1;
           }
         }
       }
@@ -1358,12 +1574,17 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
         txs_basep->reterr = kPglRetEof;
         return kPglRetSuccess;
       }
-      goto TextStreamOpenEx_ret_1;
+      goto TextStreamOpenInternal_ret_1;
+    }
+#ifndef NO_TEXT_MMAP
+    if (readonly && (!txf_ptr) && (txs_basep->file_type == kFileUncompressed) && TextStreamMmapInit(txsp)) {
+      return kPglRetSuccess;
     }
+#endif
     assert(!txsp->syncp);
     TextStreamSync* syncp;
     if (unlikely(cachealigned_malloc(RoundUpPow2(sizeof(TextStreamSync), kCacheline), &syncp))) {
-      goto TextStreamOpenEx_ret_NOMEM;
+      goto TextStreamOpenInternal_ret_NOMEM;
     }
     txsp->syncp = syncp;
     dst = txs_basep->dst;
@@ -1375,6 +1596,7 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
     syncp->dst_reallocated = 0;
     syncp->interrupt = kTxsInterruptNone;
     syncp->new_fname = nullptr;
+    syncp->bgzf_voffset = 0;
 #ifdef _WIN32
     syncp->read_thread = nullptr;
     // apparently this can raise a low-memory exception in older Windows
@@ -1384,40 +1606,40 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
     syncp->reader_progress_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
     if (unlikely(!syncp->reader_progress_event)) {
       DeleteCriticalSection(&syncp->critical_section);
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
     syncp->consumer_progress_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
     if (unlikely(!syncp->consumer_progress_event)) {
       DeleteCriticalSection(&syncp->critical_section);
       CloseHandle(syncp->reader_progress_event);
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
     syncp->read_thread = R_CAST(HANDLE, _beginthreadex(nullptr, kDefaultThreadStack, TextStreamThread, txsp, 0, nullptr));
     if (unlikely(!syncp->read_thread)) {
       DeleteCriticalSection(&syncp->critical_section);
       CloseHandle(syncp->consumer_progress_event);
       CloseHandle(syncp->reader_progress_event);
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
 #else
     syncp->sync_init_state = 0;
     if (unlikely(pthread_mutex_init(&syncp->sync_mutex, nullptr))) {
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
     syncp->sync_init_state = 1;
     if (unlikely(pthread_cond_init(&syncp->reader_progress_condvar, nullptr))) {
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
     syncp->sync_init_state = 2;
     syncp->consumer_progress_state = 0;
     if (unlikely(pthread_cond_init(&syncp->consumer_progress_condvar, nullptr))) {
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
     syncp->sync_init_state = 3;
 #  ifndef __cplusplus
     pthread_attr_t smallstack_thread_attr;
     if (unlikely(pthread_attr_init(&smallstack_thread_attr))) {
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
     pthread_attr_setstacksize(&smallstack_thread_attr, kDefaultThreadStack);
 #  endif
@@ -1431,7 +1653,7 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
 #  ifndef __cplusplus
       pthread_attr_destroy(&smallstack_thread_attr);
 #  endif
-      goto TextStreamOpenEx_ret_THREAD_CREATE_FAIL;
+      goto TextStreamOpenInternal_ret_THREAD_CREATE_FAIL;
     }
 #  ifndef __cplusplus
     pthread_attr_destroy(&smallstack_thread_attr);
@@ -1440,28 +1662,42 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
 #endif
   }
   while (0) {
-  TextStreamOpenEx_ret_NOMEM:
+  TextStreamOpenInternal_ret_NOMEM:
     reterr = kPglRetNomem;
     break;
-  TextStreamOpenEx_ret_THREAD_CREATE_FAIL:
+  TextStreamOpenInternal_ret_THREAD_CREATE_FAIL:
     reterr = kPglRetThreadCreateFail;
     break;
   }
- TextStreamOpenEx_ret_1:
+ TextStreamOpenInternal_ret_1:
   txs_basep->reterr = reterr;
   return reterr;
 }
 
+PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint32_t dst_capacity, uint32_t decompress_thread_ct, textFILE* txf_ptr, char* dst, TextStream* txs_ptr) {
+  return TextStreamOpenInternal(fname, enforced_max_line_blen, dst_capacity, decompress_thread_ct, txf_ptr, dst, 0, txs_ptr);
+}
+
+PglErr TextStreamOpenReadonlyEx(const char* fname, uint32_t enforced_max_line_blen, uint32_t dst_capacity, uint32_t decompress_thread_ct, char* dst, TextStream* txs_ptr) {
+  return TextStreamOpenInternal(fname, enforced_max_line_blen, dst_capacity, decompress_thread_ct, nullptr, dst, 1, txs_ptr);
+}
+
 uint32_t TextDecompressThreadCt(const TextStream* txs_ptr) {
   const TextStreamMain* txsp = GetTxspK(txs_ptr);
   FileCompressionType file_type = txsp->base.file_type;
   if (file_type == kFileUncompressed) {
     return 0;
   }
-  if (file_type != kFileBgzf) {
-    return 1;
+  if (file_type == kFileBgzf) {
+    return GetThreadCtTg(&txsp->rds.bgzf.tg);
+  }
+  if (file_type == kFileZstdSeekable) {
+    return GetThreadCtTg(&txsp->rds.zst_seekable.tg);
   }
-  return GetThreadCtTg(&txsp->rds.bgzf.tg);
+  if (file_type == kFileGzipMt) {
+    return GetThreadCtTg(&txsp->rds.gzmt.tg);
+  }
+  return 1;
 }
 
 PglErr TextAdvance(TextStream* txs_ptr) {
@@ -1469,6 +1705,15 @@ PglErr TextAdvance(TextStream* txs_ptr) {
   TextFileBase* basep = &txsp->base;
   char* consume_iter = basep->consume_iter;
   TextStreamSync* syncp = txsp->syncp;
+  if (!syncp) {
+#ifndef NO_TEXT_MMAP
+    if (txsp->mmap_start) {
+      return TextMmapAdvance(txsp);
+    }
+#endif
+    // open failed
+    return basep->reterr;
+  }
 #ifdef _WIN32
   CRITICAL_SECTION* critical_sectionp = &syncp->critical_section;
   HANDLE consumer_progress_event = syncp->consumer_progress_event;
@@ -1689,9 +1934,37 @@ PglErr TextSkipNz(uintptr_t skip_ct, TextStream* txs_ptr) {
 #endif
 }
 
-PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
+static PglErr TextRetargetEx(const char* new_fname, uint64_t bgzf_voffset, TextStream* txs_ptr) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   TextFileBase* basep = &txsp->base;
+#ifndef NO_TEXT_MMAP
+  if (txsp->mmap_start) {
+    if (unlikely((basep->reterr != kPglRetSuccess) && (basep->reterr != kPglRetEof))) {
+      return basep->reterr;
+    }
+    TextMmapCleanup(txsp);
+    if (!new_fname) {
+      // Remap instead of just resetting consume_iter, so that in-place edits
+      // made by the consumer during the previous pass are discarded.
+      if (unlikely(!TextStreamMmapInit(txsp))) {
+        basep->errmsg = strerror(errno);
+        basep->reterr = kPglRetReadFail;
+        return kPglRetReadFail;
+      }
+      return kPglRetSuccess;
+    }
+    // The next file may be compressed, so just reopen from scratch.
+    char* dst = basep->dst_owned_by_consumer? basep->dst : nullptr;
+    const uint32_t enforced_max_line_blen = basep->enforced_max_line_blen;
+    const uint32_t dst_capacity = basep->dst_capacity;
+    if (unlikely(CleanupTextStream(txs_ptr, nullptr))) {
+      basep->errmsg = strerror(errno);
+      basep->reterr = kPglRetReadFail;
+      return kPglRetReadFail;
+    }
+    return TextStreamOpenReadonlyEx(new_fname, enforced_max_line_blen, dst_capacity, txsp->decompress_thread_ct, dst, txs_ptr);
+  }
+#endif
   TextStreamSync* syncp = txsp->syncp;
 #ifdef _WIN32
   CRITICAL_SECTION* critical_sectionp = &syncp->critical_section;
@@ -1724,6 +1997,7 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   // outweigh disadvantages, but I'll wait till --pmerge development to make a
   // decision since that's the main function that actually cares.
   syncp->new_fname = new_fname;
+  syncp->bgzf_voffset = bgzf_voffset;
   SetEvent(syncp->consumer_progress_event);
   LeaveCriticalSection(critical_sectionp);
 #else
@@ -1750,6 +2024,7 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   syncp->dst_reallocated = 0;
   syncp->interrupt = kTxsInterruptRetarget;
   syncp->new_fname = new_fname;
+  syncp->bgzf_voffset = bgzf_voffset;
   syncp->consumer_progress_state = 1;
   pthread_cond_signal(consumer_progress_condvarp);
   pthread_mutex_unlock(sync_mutexp);
@@ -1759,9 +2034,25 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   return kPglRetSuccess;
 }
 
+PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
+  return TextRetargetEx(new_fname, 0, txs_ptr);
+}
+
+PglErr TextSeekBgzf(uint64_t voffset, TextStream* txs_ptr) {
+  if (unlikely(!TextIsBgzf(txs_ptr))) {
+    return kPglRetImproperFunctionCall;
+  }
+  return TextRetargetEx(nullptr, voffset, txs_ptr);
+}
+
 BoolErr CleanupTextStream(TextStream* txs_ptr, PglErr* reterrp) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   TextFileBase* basep = &txsp->base;
+#ifndef NO_TEXT_MMAP
+  if (txsp->mmap_start) {
+    TextMmapCleanup(txsp);
+  }
+#endif
   TextStreamSync* syncp = txsp->syncp;
   if (syncp) {
 #ifdef _WIN32
@@ -1822,6 +2113,10 @@ BoolErr CleanupTextStream(TextStream* txs_ptr, PglErr* reterrp) {
         }
       } else if (basep->file_type == kFileBgzf) {
         CleanupBgzfRawMtStream(&txsp->rds.bgzf);
+      } else if (basep->file_type == kFileZstdSeekable) {
+        CleanupZstRawMtStream(&txsp->rds.zst_seekable);
+      } else if (basep->file_type == kFileGzipMt) {
+        CleanupGzRawMtStream(&txsp->rds.gzmt);
       } else {
         // plain gzip
         if (txsp->rds.gz.in) {
@@ -53,13 +53,13 @@
 //    but I've decided to phase out zlibWrapper thanks to compilation headaches
 //    and its static-linking requirement.
 // 2. decompresses-ahead, potentially with multiple threads.
-//    a. For now, multithreaded decompression can only kick in for bgzipped
-//       files.  However, if a clear use case exists, it should be possible to
-//       build a multithreaded Zstd decoder that isn't restricted to a Zstd
-//       sub-format; see
+//    a. Multithreaded decompression kicks in for bgzipped files, for Zstd
+//       files in the seekable format (which plink2 now writes by default; see
+//       ZstRawMtDecompressStream in plink2_zstfile.h), and, speculatively, for
+//       plain gzip files (see plink2_gzmt.h).  A
+//       multithreaded Zstd decoder that isn't restricted to a Zstd
+//       sub-format may be possible too; see
 //         https://github.com/facebook/zstd/issues/1702#issuecomment-515124700
-//       If you have such a use case, I recommend responding to Yann Collet in
-//       that GitHub issue.
 //    b. Tabix-based seek support was considered and rejected, since the tabix
 //       index only stores CHROM/POS, while plink2 also needs record numbers in
 //       its most critical use case (.pvar loading).  A suitable index format
@@ -92,6 +92,11 @@
 // 4. can be used with either a single fixed-size memory buffer (this plays
 //    well with plink2's memory allocation strategy), or dynamic resizing with
 //    malloc()/realloc() calls.
+// 5. when the consumer doesn't modify the text in place, skips the reader
+//    thread and buffer entirely for regular uncompressed files, handing out
+//    pointers straight into a private memory mapping of the file.  The page
+//    cache already *is* a read-ahead buffer in that case; copying out of it
+//    (and memmoving partial lines) is pure overhead.
 //
 // Two other readers are provided:
 // - A decompress-ahead token reader.  This also shards the tokens, for the
@@ -109,8 +114,14 @@
 #endif
 
 #include "plink2_bgzf.h"
+#include "plink2_gzmt.h"
 #include "plink2_zstfile.h"
 
+// Zero-copy TextStream mode requires mmap() and a 64-bit address space.
+#if defined(_WIN32) || !defined(__LP64__)
+#  define NO_TEXT_MMAP
+#endif
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -365,12 +376,16 @@ typedef struct TextStreamSyncStruct {
   uint32_t dst_reallocated;
   TxsInterrupt interrupt;
   const char* new_fname;
+  // BGZF virtual offset to restart from when new_fname is null; 0 = rewind.
+  uint64_t bgzf_voffset;
 } TextStreamSync;
 
 typedef union {
   GzRawDecompressStream gz;
   BgzfRawMtDecompressStream bgzf;
   ZstRawDecompressStream zst;
+  ZstRawMtDecompressStream zst_seekable;
+  GzRawMtDecompressStream gzmt;
 } RawMtDecompressStream;
 
 typedef struct TextStreamMainStruct {
@@ -378,6 +393,15 @@ typedef struct TextStreamMainStruct {
   RawMtDecompressStream rds;
   uint32_t decompress_thread_ct;
   TextStreamSync* syncp;
+  uint32_t readonly;
+  // Zero-copy mode iff mmap_start is non-null (only possible when readonly is
+  // set); syncp is null in that case, and base.consume_iter/consume_stop point
+  // into a private writable mapping of the whole file.  mmap_end points past the last '\n' (which may have
+  // been appended), and at least one zero-filled page follows the file
+  // contents.
+  char* mmap_start;
+  char* mmap_end;
+  uintptr_t mmap_alloc_size;
 } TextStreamMain;
 
 typedef struct TextStreamStruct {
@@ -401,6 +425,19 @@ void PreinitTextStream(TextStream* txs_ptr);
 //   smaller than what the textFILE was opened with.
 PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint32_t dst_capacity, uint32_t decompress_thread_ct, textFILE* txf_ptr, char* dst, TextStream* txs_ptr);
 
+// Variant of TextStreamOpenEx() for consumers which never modify the returned
+// lines/tokens in place.  When fname (or a later TextRetarget() target) is a
+// regular uncompressed file, it's memory-mapped instead of being read by a
+// background thread, and dst is left untouched.  Line/token length limits are
+// enforced in the same way.
+// In-place edits are still *safe*, since the mapping is copy-on-write, but
+// each touched page then costs a fault and a copy; that's slower than the
+// reader thread, which is why this isn't the default.
+PglErr TextStreamOpenReadonlyEx(const char* fname, uint32_t enforced_max_line_blen, uint32_t dst_capacity, uint32_t decompress_thread_ct, char* dst, TextStream* txs_ptr);
+
+// Set to nonzero to always use the reader-thread path (--no-text-mmap).
+extern uint32_t g_text_mmap_disabled;
+
 HEADER_INLINE PglErr TextStreamOpen(const char* fname, TextStream* txs_ptr) {
   return TextStreamOpenEx(fname, kMaxLongLine, 0, NumCpu(nullptr), nullptr, nullptr, txs_ptr);
 }
@@ -413,6 +450,13 @@ HEADER_INLINE char* TextLineEnd(TextStream* txs_ptr) {
   return GET_PRIVATE(*txs_ptr, m).base.consume_iter;
 }
 
+// Points after the last loaded \n.  Lines before this are complete, and are
+// not moved or overwritten until the next TextAdvance() call, so they can be
+// handed off to worker threads.
+HEADER_INLINE char* TextConsumeStop(TextStream* txs_ptr) {
+  return GET_PRIVATE(*txs_ptr, m).base.consume_stop;
+}
+
 HEADER_INLINE int32_t TextIsOpen(const TextStream* txs_ptr) {
   return (GET_PRIVATE(*txs_ptr, m).base.ff != nullptr);
 }
@@ -598,8 +642,8 @@ HEADER_INLINE void TextSetPos(char* new_consume_iter, TextStream* txs_ptr) {
 
 
 HEADER_INLINE uint32_t TextIsMt(const TextStream* txs_ptr) {
-  // Only bgzf decoder is multithreaded for now.
-  return (GET_PRIVATE(*txs_ptr, m).base.file_type == kFileBgzf);
+  const FileCompressionType file_type = GET_PRIVATE(*txs_ptr, m).base.file_type;
+  return (file_type == kFileBgzf) || (file_type == kFileZstdSeekable) || (file_type == kFileGzipMt);
 }
 
 PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr);
@@ -608,6 +652,16 @@ HEADER_INLINE PglErr TextRewind(TextStream* txs_ptr) {
   return TextRetarget(nullptr, txs_ptr);
 }
 
+HEADER_INLINE uint32_t TextIsBgzf(const TextStream* txs_ptr) {
+  return (GET_PRIVATE(*txs_ptr, m).base.file_type == kFileBgzf);
+}
+
+// Like TextRewind(), but resumes at the given BGZF virtual offset (usually
+// from a tabix/CSI index, see LoadBgzfIndex()).  Afterward, call
+// TextNextLineUnsafe() etc. on TextLineEnd(), as at the start of the file.
+// Returns kPglRetImproperFunctionCall if TextIsBgzf() is false.
+PglErr TextSeekBgzf(uint64_t voffset, TextStream* txs_ptr);
+
 HEADER_INLINE const char* TextStreamError(const TextStream* txs_ptr) {
   return GET_PRIVATE(*txs_ptr, m).base.errmsg;
 }
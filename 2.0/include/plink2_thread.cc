@@ -18,6 +18,7 @@
 #include "plink2_thread.h"
 
 #ifndef _WIN32
+#  include <time.h>  // clock_gettime()
 #  include <unistd.h>  // sysconf()
 #endif
 
@@ -44,6 +45,168 @@ void WaitForAllObjects(uint32_t ct, HANDLE* objs) {
 }
 #endif
 
+uint32_t g_thread_perf = 0;
+
+static uint64_t g_thread_perf_io_ns[2] = {0, 0};
+
+static ThreadPerfPhase* g_thread_perf_phases = nullptr;
+
+uint64_t MonotonicNs() {
+#ifdef _WIN32
+  LARGE_INTEGER freq;
+  LARGE_INTEGER ct;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&ct);
+  const uint64_t ticks = ct.QuadPart;
+  const uint64_t ticks_per_sec = freq.QuadPart;
+  return (ticks / ticks_per_sec) * 1000000000LLU + ((ticks % ticks_per_sec) * 1000000000LLU) / ticks_per_sec;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(uint64_t, ts.tv_sec) * 1000000000LLU + S_CAST(uint64_t, ts.tv_nsec);
+#endif
+}
+
+// CPU time consumed by the calling thread.
+static uint64_t ThreadCpuNs() {
+#ifdef _WIN32
+  FILETIME creation_time;
+  FILETIME exit_time;
+  FILETIME kernel_time;
+  FILETIME user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return 0;
+  }
+  // 100-nanosecond units
+  const uint64_t kernel_ticks = (S_CAST(uint64_t, kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+  const uint64_t user_ticks = (S_CAST(uint64_t, user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+  return (kernel_ticks + user_ticks) * 100;
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts)) {
+    return 0;
+  }
+  return S_CAST(uint64_t, ts.tv_sec) * 1000000000LLU + S_CAST(uint64_t, ts.tv_nsec);
+#endif
+}
+
+void AddThreadPerfIoNs(uint32_t is_write, uint64_t ns) {
+  __atomic_fetch_add(&(g_thread_perf_io_ns[is_write]), ns, __ATOMIC_RELAXED);
+}
+
+static void ResetThreadPerfPhase(ThreadGroupMain* tgp) {
+  tgp->perf_first_spawn_ns = 0;
+  tgp->perf_last_join_ns = 0;
+  tgp->perf_critical_ns = 0;
+  tgp->perf_critical_cpu_ns = 0;
+  tgp->perf_join_wait_ns = 0;
+  tgp->perf_read_ns_start = __atomic_fetch_add(&(g_thread_perf_io_ns[0]), 0, __ATOMIC_RELAXED);
+  tgp->perf_write_ns_start = __atomic_fetch_add(&(g_thread_perf_io_ns[1]), 0, __ATOMIC_RELAXED);
+  tgp->perf_round_ct = 0;
+  if (tgp->threads) {
+    ThreadGroupControlBlock* cbp = GetCbp(&tgp->shared);
+    ThreadTaskSlot* task_slots = cbp->task_slots;
+    const uint32_t thread_ct = cbp->thread_ct;
+    for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+      task_slots[tidx].busy_ns = 0;
+      task_slots[tidx].wait_ns = 0;
+      task_slots[tidx].cpu_ns = 0;
+    }
+  }
+}
+
+// Must be called while the threads are joined.  Silently drops the phase on
+// allocation failure, since this is only diagnostic.
+static void FinishThreadPerfPhase(ThreadGroupMain* tgp) {
+  if (!tgp->perf_round_ct) {
+    return;
+  }
+  ThreadGroupControlBlock* cbp = GetCbp(&tgp->shared);
+  const uint32_t thread_ct = cbp->thread_ct;
+  ThreadPerfPhase* phasep = S_CAST(ThreadPerfPhase*, malloc(sizeof(ThreadPerfPhase) + 3 * thread_ct * sizeof(int64_t)));
+  if (phasep) {
+    phasep->func_name = tgp->perf_func_name? tgp->perf_func_name : "";
+    phasep->start_ns = tgp->perf_first_spawn_ns;
+    phasep->end_ns = tgp->perf_last_join_ns;
+    phasep->critical_ns = tgp->perf_critical_ns;
+    phasep->critical_cpu_ns = tgp->perf_critical_cpu_ns;
+    phasep->join_wait_ns = tgp->perf_join_wait_ns;
+    phasep->read_ns = __atomic_fetch_add(&(g_thread_perf_io_ns[0]), 0, __ATOMIC_RELAXED) - tgp->perf_read_ns_start;
+    phasep->write_ns = __atomic_fetch_add(&(g_thread_perf_io_ns[1]), 0, __ATOMIC_RELAXED) - tgp->perf_write_ns_start;
+    phasep->thread_ct = thread_ct;
+    phasep->round_ct = tgp->perf_round_ct;
+    uint64_t* thread_ns = R_CAST(uint64_t*, &(phasep[1]));
+    phasep->thread_ns = thread_ns;
+    const ThreadTaskSlot* task_slots = cbp->task_slots;
+    for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+      thread_ns[tidx] = task_slots[tidx].busy_ns;
+      thread_ns[thread_ct + tidx] = task_slots[tidx].wait_ns;
+      thread_ns[2 * thread_ct + tidx] = task_slots[tidx].cpu_ns;
+    }
+    ThreadPerfPhase* old_head = g_thread_perf_phases;
+    do {
+      phasep->next = old_head;
+    } while (!__atomic_compare_exchange_n(&g_thread_perf_phases, &old_head, phasep, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  }
+  ResetThreadPerfPhase(tgp);
+}
+
+void NextThreadPerfPhase(const char* func_name, ThreadGroup* tg_ptr) {
+  ThreadGroupMain* tgp = GetTgp(tg_ptr);
+  FinishThreadPerfPhase(tgp);
+  ResetThreadPerfPhase(tgp);
+  tgp->perf_func_name = func_name;
+}
+
+ThreadPerfPhase* GetThreadPerfPhases() {
+  return __atomic_load_n(&g_thread_perf_phases, __ATOMIC_ACQUIRE);
+}
+
+void CleanupThreadPerfPhases() {
+  ThreadPerfPhase* phasep = __atomic_exchange_n(&g_thread_perf_phases, nullptr, __ATOMIC_ACQ_REL);
+  while (phasep) {
+    ThreadPerfPhase* next = phasep->next;
+    free(phasep);
+    phasep = next;
+  }
+}
+
+uint64_t ThreadPerfBlockEnd(ThreadGroupFuncArg* tgfap) {
+  ThreadGroupControlBlock* cbp = GetCbp(tgfap->sharedp);
+  const uint64_t now_ns = MonotonicNs();
+  const uint64_t busy_ns = now_ns - cbp->perf_block_start_ns;
+  ThreadTaskSlot* slotp = &(cbp->task_slots[tgfap->tidx]);
+  slotp->busy_ns += busy_ns;
+  uint64_t prev_max_ns = __atomic_load_n(&cbp->perf_round_max_ns, __ATOMIC_RELAXED);
+  while (busy_ns > prev_max_ns) {
+    if (ATOMIC_COMPARE_EXCHANGE_N_U64(&cbp->perf_round_max_ns, &prev_max_ns, busy_ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+  const uint64_t cpu_ns = ThreadCpuNs() - slotp->block_cpu_start_ns;
+  slotp->cpu_ns += cpu_ns;
+  prev_max_ns = __atomic_load_n(&cbp->perf_round_max_cpu_ns, __ATOMIC_RELAXED);
+  while (cpu_ns > prev_max_ns) {
+    if (ATOMIC_COMPARE_EXCHANGE_N_U64(&cbp->perf_round_max_cpu_ns, &prev_max_ns, cpu_ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+  return now_ns;
+}
+
+void ThreadPerfBlockResume(uint64_t block_end_ns, ThreadGroupFuncArg* tgfap) {
+  ThreadGroupControlBlock* cbp = GetCbp(tgfap->sharedp);
+  // Wakeup latency is charged to the next block's busy time, so busy + wait
+  // never exceeds the phase's wall time.  (block_start isn't updated on the
+  // SpawnThreads() error-shutdown path.)
+  const uint64_t block_start_ns = cbp->perf_block_start_ns;
+  ThreadTaskSlot* slotp = &(cbp->task_slots[tgfap->tidx]);
+  if (block_start_ns > block_end_ns) {
+    slotp->wait_ns += block_start_ns - block_end_ns;
+  }
+  slotp->block_cpu_start_ns = ThreadCpuNs();
+}
+
 void PreinitThreads(ThreadGroup* tg_ptr) {
   ThreadGroupMain* tgp = GetTgp(tg_ptr);
   GetCbp(&tgp->shared)->is_last_block = 0;
@@ -51,6 +214,8 @@ void PreinitThreads(ThreadGroup* tg_ptr) {
   tgp->threads = nullptr;
   tgp->is_unjoined = 0;
   tgp->is_active = 0;
+  tgp->perf_func_name = nullptr;
+  ResetThreadPerfPhase(tgp);
 }
 
 uint32_t NumCpu(int32_t* known_procs_ptr) {
@@ -76,12 +241,15 @@ BoolErr SetThreadCt(uint32_t thread_ct, ThreadGroup* tg_ptr) {
   ThreadGroupMain* tgp = GetTgp(tg_ptr);
   assert(!tgp->is_active);
   if (tgp->threads) {
+    if (g_thread_perf) {
+      FinishThreadPerfPhase(tgp);
+    }
     free(tgp->threads);
     tgp->threads = nullptr;
   }
   assert(thread_ct && (thread_ct <= kMaxThreads));
 #ifdef _WIN32
-  unsigned char* memptr = S_CAST(unsigned char*, malloc(thread_ct * (sizeof(ThreadGroupFuncArg) + sizeof(HANDLE))));
+  unsigned char* memptr = S_CAST(unsigned char*, malloc(thread_ct * (sizeof(ThreadGroupFuncArg) + sizeof(HANDLE) + sizeof(ThreadTaskSlot)) + kCacheline));
   if (unlikely(!memptr)) {
     return 1;
   }
@@ -89,7 +257,7 @@ BoolErr SetThreadCt(uint32_t thread_ct, ThreadGroup* tg_ptr) {
   memset(tgp->threads, 0, thread_ct * sizeof(HANDLE));
   memptr = &(memptr[thread_ct * sizeof(HANDLE)]);
 #else
-  unsigned char* memptr = S_CAST(unsigned char*, malloc(thread_ct * (sizeof(pthread_t) + sizeof(ThreadGroupFuncArg))));
+  unsigned char* memptr = S_CAST(unsigned char*, malloc(thread_ct * (sizeof(pthread_t) + sizeof(ThreadGroupFuncArg) + sizeof(ThreadTaskSlot)) + kCacheline));
   if (unlikely(!memptr)) {
     return 1;
   }
@@ -102,16 +270,36 @@ BoolErr SetThreadCt(uint32_t thread_ct, ThreadGroup* tg_ptr) {
   ThreadGroupControlBlock* cbp = GetCbp(&tgp->shared);
   cbp->active_ct = 0;
   tgp->thread_args = R_CAST(ThreadGroupFuncArg*, memptr);
+  memptr = &(memptr[thread_ct * sizeof(ThreadGroupFuncArg)]);
+  cbp->task_slots = R_CAST(ThreadTaskSlot*, RoundUpPow2(R_CAST(uintptr_t, memptr), kCacheline));
 
   cbp->thread_ct = thread_ct;
+  SetThreadTaskCt(1, tg_ptr);
+  ResetThreadPerfPhase(tgp);
   return 0;
 }
 
+void SetThreadTaskCt(uint32_t task_ct, ThreadGroup* tg_ptr) {
+  ThreadGroupMain* tgp = GetTgp(tg_ptr);
+  assert(!tgp->is_unjoined);
+  ThreadGroupControlBlock* cbp = GetCbp(&tgp->shared);
+  const uint32_t thread_ct = cbp->thread_ct;
+  ThreadTaskSlot* task_slots = cbp->task_slots;
+  cbp->task_ct = task_ct;
+  uint64_t slice_start = 0;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    const uint64_t slice_end = (S_CAST(uint64_t, tidx + 1) * task_ct) / thread_ct;
+    task_slots[tidx].range = slice_start | (slice_end << 32);
+    slice_start = slice_end;
+  }
+}
+
 // Note that thread_ct is permitted to be less than tgp->shared.cb.thread_ct,
 // to support the SpawnThreads() error cases.
 void JoinThreadsInternal(uint32_t thread_ct, ThreadGroupMain* tgp) {
   assert(tgp->is_active);
   ThreadGroupControlBlock* cbp = GetCbp(&tgp->shared);
+  const uint64_t join_start_ns = g_thread_perf? MonotonicNs() : 0;
 #ifdef _WIN32
   if (!cbp->is_last_block) {
     WaitForSingleObject(cbp->cur_block_done_event, INFINITE);
@@ -145,6 +333,15 @@ void JoinThreadsInternal(uint32_t thread_ct, ThreadGroupMain* tgp) {
   }
 #endif
   tgp->is_unjoined = 0;
+  // StopThreads() rounds don't do any work.
+  if (join_start_ns && (cbp->is_last_block != 2)) {
+    const uint64_t join_end_ns = MonotonicNs();
+    tgp->perf_join_wait_ns += join_end_ns - join_start_ns;
+    tgp->perf_critical_ns += cbp->perf_round_max_ns;
+    tgp->perf_critical_cpu_ns += cbp->perf_round_max_cpu_ns;
+    tgp->perf_last_join_ns = join_end_ns;
+    tgp->perf_round_ct += 1;
+  }
 }
 
 #if defined(__cplusplus) && !defined(_WIN32)
@@ -159,6 +356,22 @@ BoolErr SpawnThreads(ThreadGroup* tg_ptr) {
   const uint32_t is_last_block = cbp->is_last_block;
   pthread_t* threads = tgp->threads;
   assert(threads != nullptr);
+  if (g_thread_perf) {
+    // Threads can't read these until they're released below.
+    const uint64_t block_start_ns = MonotonicNs();
+    if (!tgp->perf_first_spawn_ns) {
+      tgp->perf_first_spawn_ns = block_start_ns;
+    }
+    cbp->perf_block_start_ns = block_start_ns;
+    cbp->perf_round_max_ns = 0;
+    cbp->perf_round_max_cpu_ns = 0;
+    if (!was_active) {
+      // New threads' CPU clocks start at zero.
+      for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+        cbp->task_slots[tidx].block_cpu_start_ns = 0;
+      }
+    }
+  }
 #ifdef _WIN32
   if (!was_active) {
     cbp->spawn_ct = 0;
@@ -339,6 +552,9 @@ void CleanupThreads(ThreadGroup* tg_ptr) {
 #ifndef _WIN32
     assert(!cbp->active_ct);
 #endif
+    if (g_thread_perf) {
+      FinishThreadPerfPhase(tgp);
+    }
     cbp->thread_ct = 0;
     free(tgp->threads);
     tgp->threads = nullptr;
@@ -350,6 +566,10 @@ void CleanupThreads(ThreadGroup* tg_ptr) {
 #ifndef _WIN32
 BoolErr THREAD_BLOCK_FINISH(ThreadGroupFuncArg* tgfap) {
   ThreadGroupControlBlock* cbp = GetCbp(tgfap->sharedp);
+  uint64_t block_end_ns = 0;
+  if (g_thread_perf) {
+    block_end_ns = ThreadPerfBlockEnd(tgfap);
+  }
   if (cbp->is_last_block) {
     return 1;
   }
@@ -363,10 +583,63 @@ BoolErr THREAD_BLOCK_FINISH(ThreadGroupFuncArg* tgfap) {
     pthread_cond_wait(&cbp->start_next_condvar, &cbp->sync_mutex);
   }
   pthread_mutex_unlock(&cbp->sync_mutex);
+  if (block_end_ns) {
+    ThreadPerfBlockResume(block_end_ns, tgfap);
+  }
   return (cbp->is_last_block == 2);
 }
 #endif
 
+BoolErr ClaimThreadTask(ThreadGroupFuncArg* tgfap, uint32_t* task_idx_ptr) {
+  ThreadGroupControlBlock* cbp = GetCbp(tgfap->sharedp);
+  ThreadTaskSlot* task_slots = cbp->task_slots;
+  const uint32_t tidx = tgfap->tidx;
+  uint64_t* own_range_ptr = &(task_slots[tidx].range);
+  // Thieves may be updating our slot concurrently, so every access is atomic;
+  // relaxed ordering suffices since a stale value just causes the
+  // compare-exchange to fail and refresh it.
+  uint64_t own_range = __atomic_load_n(own_range_ptr, __ATOMIC_RELAXED);
+  while (S_CAST(uint32_t, own_range) != (own_range >> 32)) {
+    if (ATOMIC_COMPARE_EXCHANGE_N_U64(own_range_ptr, &own_range, own_range + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+      *task_idx_ptr = S_CAST(uint32_t, own_range);
+      return 0;
+    }
+  }
+  const uint32_t thread_ct = cbp->thread_ct;
+  while (1) {
+    uint32_t victim_tidx = 0;
+    uint32_t victim_remaining = 0;
+    uint64_t victim_range = 0;
+    uint32_t cur_tidx = tidx;
+    for (uint32_t uii = 1; uii < thread_ct; ++uii) {
+      if (++cur_tidx == thread_ct) {
+        cur_tidx = 0;
+      }
+      const uint64_t cur_range = __atomic_load_n(&(task_slots[cur_tidx].range), __ATOMIC_RELAXED);
+      const uint32_t cur_remaining = (cur_range >> 32) - S_CAST(uint32_t, cur_range);
+      if (cur_remaining > victim_remaining) {
+        victim_tidx = cur_tidx;
+        victim_remaining = cur_remaining;
+        victim_range = cur_range;
+      }
+    }
+    if (!victim_remaining) {
+      return 1;
+    }
+    const uint64_t victim_end = victim_range >> 32;
+    const uint64_t new_victim_end = victim_end - ((victim_remaining + 1) / 2);
+    const uint64_t new_victim_range = S_CAST(uint32_t, victim_range) | (new_victim_end << 32);
+    if (ATOMIC_COMPARE_EXCHANGE_N_U64(&(task_slots[victim_tidx].range), &victim_range, new_victim_range, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+      // Our own slot is empty, so no other thread writes to it until we
+      // install the rest of the stolen slice; other threads may still be
+      // reading it while scanning for a victim.
+      __atomic_store_n(own_range_ptr, (new_victim_end + 1) | (victim_end << 32), __ATOMIC_RELAXED);
+      *task_idx_ptr = new_victim_end;
+      return 0;
+    }
+  }
+}
+
 void UpdateU64IfSmaller(uint64_t newval, uint64_t* oldval_ptr) {
   uint64_t oldval = *oldval_ptr;
   while (oldval > newval) {
@@ -75,6 +75,8 @@
 #  define __atomic_fetch_add(ptr, val, memorder) __sync_fetch_and_add((ptr), (val))
 #  define __atomic_fetch_sub(ptr, val, memorder) __sync_fetch_and_sub((ptr), (val))
 #  define __atomic_sub_fetch(ptr, val, memorder) __sync_sub_and_fetch((ptr), (val))
+#  define __atomic_load_n(ptr, memorder) __sync_fetch_and_add((ptr), 0)
+#  define __atomic_store_n(ptr, val, memorder) S_CAST(void, __sync_lock_test_and_set((ptr), (val)))
 
 HEADER_INLINE uint32_t ATOMIC_COMPARE_EXCHANGE_N_U32(uint32_t* ptr, uint32_t* expected, uint32_t desired, __maybe_unused int weak, __maybe_unused int success_memorder, __maybe_unused int failure_memorder) {
   const uint32_t new_expected = __sync_val_compare_and_swap(ptr, *expected, desired);
@@ -123,6 +125,20 @@ CONSTI32(kDefaultThreadStack, 524288);
 CONSTI32(kDefaultThreadStack, 131072);
 #endif
 
+// One per thread, padded to a cacheline to avoid false sharing.  The low 32
+// bits of range are the next unclaimed task index, and the high 32 bits are
+// the end of the thread's current slice.  The remaining fields are only
+// updated when g_thread_perf is set; block_cpu_start_ns is the thread's CPU
+// clock when it was released for the current block.
+typedef struct ThreadTaskSlotStruct {
+  uint64_t range;
+  uint64_t busy_ns;
+  uint64_t wait_ns;
+  uint64_t cpu_ns;
+  uint64_t block_cpu_start_ns;
+  unsigned char padding[kCacheline - 5 * sizeof(int64_t)];
+} ThreadTaskSlot;
+
 typedef struct ThreadGroupControlBlockStruct {
   // Neither thread-functions nor the thread-group owner should touch these
   // variables directly.
@@ -136,12 +152,21 @@ typedef struct ThreadGroupControlBlockStruct {
   pthread_cond_t start_next_condvar;
 #endif
   uint32_t active_ct;
+  ThreadTaskSlot* task_slots;
 
   // Thread-functions can safely read from these.
   uint32_t thread_ct;
+  uint32_t task_ct;
 
   // 1 = process last block and exit; 2 = immediate termination requested
   uint32_t is_last_block;
+
+  // --perf-log bookkeeping.  block_start is written by the owner before the
+  // threads are released; round_max is the slowest thread's busy time in the
+  // current block, and round_max_cpu is the largest thread CPU time.
+  uint64_t perf_block_start_ns;
+  uint64_t perf_round_max_ns;
+  uint64_t perf_round_max_cpu_ns;
 } ThreadGroupControlBlock;
 
 typedef struct ThreadGroupSharedStruct {
@@ -174,6 +199,18 @@ typedef struct ThreadGroupMainStruct {
 #ifndef _WIN32
   uint32_t sync_init_state;
 #endif
+
+  // --perf-log phase state; a phase runs from one SetThreadFuncAndData() call
+  // to the next (or to SetThreadCt()/CleanupThreads()).
+  const char* perf_func_name;
+  uint64_t perf_first_spawn_ns;
+  uint64_t perf_last_join_ns;
+  uint64_t perf_critical_ns;
+  uint64_t perf_critical_cpu_ns;
+  uint64_t perf_join_wait_ns;
+  uint64_t perf_read_ns_start;
+  uint64_t perf_write_ns_start;
+  uint32_t perf_round_ct;
 } ThreadGroupMain;
 
 typedef struct ThreadGroupStruct {
@@ -204,14 +241,71 @@ HEADER_INLINE uint32_t GetThreadCtTg(const ThreadGroup* tg_ptr) {
   return GET_PRIVATE(tgp->shared, cb).thread_ct;
 }
 
-HEADER_INLINE void SetThreadFuncAndData(THREAD_FUNCPTR_T(start_routine), void* shared_context, ThreadGroup* tg_ptr) {
+// Thread-utilization instrumentation, enabled by --perf-log.
+//
+// When g_thread_perf is set, each thread records the time it spends between
+// being released and reaching THREAD_BLOCK_FINISH() (busy), and the time it
+// spends waiting there for the next block (wait).  The owner records how long
+// it waits in JoinThreads(), and the slowest thread's busy time per block
+// (critical path).  Each thread's CPU time per block is also recorded, along
+// with the largest one per block; unlike the wall-clock numbers, these don't
+// depend on whether the host has a free core for every thread, so they show
+// how well the work was divided even on an oversubscribed machine.
+// Main-thread pgen read and output-stream write time is
+// accumulated separately via AddThreadPerfIoNs(), and attributed to whichever
+// phases were open at the time.
+//
+// Completed phases are pushed onto a global list, which is safe even when
+// thread groups are owned by threads other than the main one.
+extern uint32_t g_thread_perf;
+
+uint64_t MonotonicNs();
+
+void AddThreadPerfIoNs(uint32_t is_write, uint64_t ns);
+
+typedef struct ThreadPerfPhaseStruct {
+  struct ThreadPerfPhaseStruct* next;
+  const char* func_name;
+  uint64_t start_ns;
+  uint64_t end_ns;
+  uint64_t critical_ns;
+  uint64_t critical_cpu_ns;
+  uint64_t join_wait_ns;
+  uint64_t read_ns;
+  uint64_t write_ns;
+  uint32_t thread_ct;
+  uint32_t round_ct;
+  // Points into the same allocation.  [0..thread_ct) = busy time,
+  // [thread_ct..2 * thread_ct) = wait time, [2 * thread_ct..3 * thread_ct) =
+  // CPU time.
+  uint64_t* thread_ns;
+} ThreadPerfPhase;
+
+// Closes the thread group's current phase (if any threads have run since it
+// was opened), and opens a new one with the given name.  func_name must be a
+// string literal.
+void NextThreadPerfPhase(const char* func_name, ThreadGroup* tg_ptr);
+
+// Returns all completed phases, newest first.  Not safe to call while any
+// instrumented thread group is alive.
+ThreadPerfPhase* GetThreadPerfPhases();
+
+void CleanupThreadPerfPhases();
+
+HEADER_INLINE void SetThreadFuncAndDataNamed(THREAD_FUNCPTR_T(start_routine), const char* func_name, void* shared_context, ThreadGroup* tg_ptr) {
   ThreadGroupMain* tgp = &GET_PRIVATE(*tg_ptr, m);
   assert(!tgp->is_active);
   tgp->shared.context = shared_context;
   GET_PRIVATE(tgp->shared, cb).is_last_block = 0;
   tgp->thread_func_ptr = start_routine;
+  if (g_thread_perf) {
+    NextThreadPerfPhase(func_name, tg_ptr);
+  }
 }
 
+// Macro so that --perf-log can label phases with the thread function's name.
+#define SetThreadFuncAndData(start_routine, shared_context, tg_ptr) SetThreadFuncAndDataNamed(start_routine, #start_routine, shared_context, tg_ptr)
+
 // Equivalent to SetThreadFuncAndData() with unchanged
 // start_routine/shared_context.  Ok to call this "unnecessarily".
 HEADER_INLINE void ReinitThreads(ThreadGroup* tg_ptr) {
@@ -240,6 +334,47 @@ HEADER_INLINE uint32_t IsLastBlock(const ThreadGroup* tg_ptr) {
   return GET_PRIVATE(tgp->shared, cb).is_last_block;
 }
 
+// Work-stealing tasks.
+//
+// Most thread functions split each block with a fixed
+// (tidx * ct) / thread_ct partition, which leaves threads idle at
+// THREAD_BLOCK_FINISH() when per-item cost is skewed (multiallelic variants,
+// Firth fallbacks, rare-variant pair corrections, ...).  Instead, the owner
+// can split the block into task_ct tasks with SetThreadTaskCt() before each
+// SpawnThreads() call, and the thread function can then loop on
+//   while (!ClaimThreadTask(arg, &task_idx)) { ... }
+// Each thread starts with a contiguous slice of [0, task_ct) (so memory
+// locality matches the fixed partition when there's no skew), and takes tasks
+// from the front of its slice.  Once its slice is empty, it steals the back
+// half of the largest remaining slice.  Every task index is claimed exactly
+// once per block, but in no particular order.
+//
+// Tasks per thread when there's enough work to go around; large enough for
+// stealing to smooth out typical skew, small enough that per-task setup
+// doesn't matter.
+CONSTI32(kThreadTasksPerThread, 16);
+
+HEADER_INLINE uint32_t ThreadTaskCt(uintptr_t item_ct, uint32_t thread_ct) {
+  if (thread_ct == 1) {
+    return 1;
+  }
+  const uint32_t max_task_ct = thread_ct * kThreadTasksPerThread;
+  if (item_ct < max_task_ct) {
+    return item_ct? item_ct : 1;
+  }
+  return max_task_ct;
+}
+
+// Must be called while the threads are joined.
+void SetThreadTaskCt(uint32_t task_ct, ThreadGroup* tg_ptr);
+
+HEADER_INLINE uint32_t GetThreadTaskCt(const ThreadGroupShared* sharedp) {
+  return GET_PRIVATE(*sharedp, cb).task_ct;
+}
+
+// Returns 1 when no tasks are left in the current block.
+BoolErr ClaimThreadTask(ThreadGroupFuncArg* tgfap, uint32_t* task_idx_ptr);
+
 #if defined(__cplusplus) && !defined(_WIN32)
 class Plink2ThreadStartup {
 public:
@@ -274,9 +409,18 @@ void StopThreads(ThreadGroup* tg_ptr);
 
 void CleanupThreads(ThreadGroup* tg_ptr);
 
+// Returns the current time, for ThreadPerfBlockResume().
+uint64_t ThreadPerfBlockEnd(ThreadGroupFuncArg* tgfap);
+
+void ThreadPerfBlockResume(uint64_t block_end_ns, ThreadGroupFuncArg* tgfap);
+
 #ifdef _WIN32
 HEADER_INLINE BoolErr THREAD_BLOCK_FINISH(ThreadGroupFuncArg* tgfap) {
   ThreadGroupControlBlock* cbp = &(GET_PRIVATE(*tgfap->sharedp, cb));
+  uint64_t block_end_ns = 0;
+  if (g_thread_perf) {
+    block_end_ns = ThreadPerfBlockEnd(tgfap);
+  }
   if (cbp->is_last_block) {
     return 1;
   }
@@ -285,6 +429,9 @@ HEADER_INLINE BoolErr THREAD_BLOCK_FINISH(ThreadGroupFuncArg* tgfap) {
     SetEvent(cbp->cur_block_done_event);
   }
   WaitForSingleObject(cbp->start_next_events[start_next_parity], INFINITE);
+  if (block_end_ns) {
+    ThreadPerfBlockResume(block_end_ns, tgfap);
+  }
   return (cbp->is_last_block == 2);
 }
 #else
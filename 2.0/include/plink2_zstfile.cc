@@ -205,6 +205,334 @@ BoolErr CleanupZstRfile(zstRFILE* zrf_ptr, PglErr* reterrp) {
   return 0;
 }
 
+void PreinitZstRawMtStream(ZstRawMtDecompressStream* zstmtp) {
+  PreinitThreads(&zstmtp->tg);
+  zstmtp->frame_csizes = nullptr;
+  ZeroPtrArr(kMaxZstDecompressThreads, zstmtp->dctxs);
+  zstmtp->in_bufs = nullptr;
+  zstmtp->out_bufs = nullptr;
+  zstmtp->unjoined = 0;
+}
+
+const char kShortErrZstSeekTableMismatch[] = "Zstd frame size doesn't match seek table";
+
+THREAD_FUNC_DECL ZstRawMtStreamThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  ZstRawMtDecompressStream* context = S_CAST(ZstRawMtDecompressStream*, arg->sharedp->context);
+  const uint32_t tidx = arg->tidx;
+  const uint32_t thread_ct = GetThreadCt(arg->sharedp);
+  ZSTD_DCtx* dctx = context->dctxs[tidx];
+  const uint32_t* frame_csizes = context->frame_csizes;
+  const uint32_t* frame_dsizes = context->frame_dsizes;
+  const uintptr_t max_frame_csize = context->max_frame_csize;
+  const uintptr_t max_frame_dsize = context->max_frame_dsize;
+  do {
+    const uint32_t parity = context->worker_parity;
+    if (tidx < context->batch_frame_cts[parity]) {
+      const uint32_t frame_idx = context->batch_frame_starts[parity] + tidx;
+      const uintptr_t slot_idx = parity * thread_ct + tidx;
+      const size_t retval = ZSTD_decompressDCtx(dctx, &(context->out_bufs[slot_idx * max_frame_dsize]), max_frame_dsize, &(context->in_bufs[slot_idx * max_frame_csize]), frame_csizes[frame_idx]);
+      if (unlikely(ZSTD_isError(retval))) {
+        context->errmsgs[parity][tidx] = ZSTD_getErrorName(retval);
+      } else if (unlikely(retval != frame_dsizes[frame_idx])) {
+        context->errmsgs[parity][tidx] = kShortErrZstSeekTableMismatch;
+      }
+    }
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+// Reads the compressed bytes of the next (up to) thread_ct frames into the
+// parity-side input slots.  ff must point to the start of frame
+// next_load_frame_idx.
+static PglErr ZstMtLoadBatch(uint32_t parity, ZstRawMtDecompressStream* zstmtp, const char** errmsgp) {
+  const uint32_t thread_ct = GetThreadCtTg(&zstmtp->tg);
+  const uint32_t frame_start = zstmtp->next_load_frame_idx;
+  const uint32_t frame_ct = MINV(thread_ct, zstmtp->frame_ct - frame_start);
+  const uintptr_t max_frame_csize = zstmtp->max_frame_csize;
+  unsigned char* in_iter = &(zstmtp->in_bufs[parity * thread_ct * max_frame_csize]);
+  for (uint32_t uii = 0; uii != frame_ct; ++uii) {
+    if (unlikely(!fread_unlocked(in_iter, zstmtp->frame_csizes[frame_start + uii], 1, zstmtp->ff))) {
+      if (feof_unlocked(zstmtp->ff)) {
+        *errmsgp = kShortErrZstSeekTableMismatch;
+        return kPglRetDecompressFail;
+      }
+      *errmsgp = strerror(errno);
+      return kPglRetReadFail;
+    }
+    in_iter = &(in_iter[max_frame_csize]);
+  }
+  zstmtp->batch_frame_starts[parity] = frame_start;
+  zstmtp->batch_frame_cts[parity] = frame_ct;
+  zstmtp->next_load_frame_idx = frame_start + frame_ct;
+  return kPglRetSuccess;
+}
+
+// Assumes threads are joined.  Starts decompressing the first batch, and
+// loads the second.
+static PglErr ZstMtStart(ZstRawMtDecompressStream* zstmtp, const char** errmsgp) {
+  if (unlikely(fseeko(zstmtp->ff, 0, SEEK_SET))) {
+    return kPglRetRewindFail;
+  }
+  zstmtp->next_load_frame_idx = 0;
+  PglErr reterr = ZstMtLoadBatch(0, zstmtp, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  zstmtp->consume_frame_idx = 0;
+  zstmtp->consume_frame_end = 0;
+  zstmtp->worker_parity = 0;
+  if (unlikely(SpawnThreads(&zstmtp->tg))) {
+    return kPglRetThreadCreateFail;
+  }
+  zstmtp->unjoined = 1;
+  return ZstMtLoadBatch(1, zstmtp, errmsgp);
+}
+
+PglErr ZstRawMtStreamInit(FILE* ff, uint32_t decompress_thread_ct, ZstRawMtDecompressStream* zstmtp, const char** errmsgp) {
+  PreinitZstRawMtStream(zstmtp);
+  zstmtp->ff = ff;
+  const int64_t orig_fpos = ftello(ff);
+  unsigned char* entries_buf = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  {
+    // 1. Find and validate the seek table.
+    if ((orig_fpos < 0) || fseeko(ff, 0, SEEK_END)) {
+      // Not seekable, e.g. a pipe.
+      goto ZstRawMtStreamInit_ret_SKIP;
+    }
+    const int64_t fsize = ftello(ff);
+    if (fsize < 8 + kZstSeekTableFooterSize) {
+      goto ZstRawMtStreamInit_ret_SKIP;
+    }
+    unsigned char footer[kZstSeekTableFooterSize];
+    if (unlikely(fseeko(ff, fsize - kZstSeekTableFooterSize, SEEK_SET) ||
+                 (!fread_unlocked(footer, kZstSeekTableFooterSize, 1, ff)))) {
+      goto ZstRawMtStreamInit_ret_READ_FAIL;
+    }
+    uint32_t frame_ct;
+    memcpy(&frame_ct, footer, sizeof(int32_t));
+    const uint32_t descriptor = footer[4];
+    uint32_t magic;
+    memcpy(&magic, &(footer[5]), sizeof(int32_t));
+    // Bits 2-6 of the descriptor are reserved, and must be zero.
+    if ((magic != kZstSeekableMagic) || (descriptor & 0x7c) || (frame_ct < 2)) {
+      goto ZstRawMtStreamInit_ret_SKIP;
+    }
+    // Ignore checksums if present.
+    const uint32_t entry_size = kZstSeekTableEntrySize + 4 * (descriptor >> 7);
+    const uint64_t entries_size = S_CAST(uint64_t, frame_ct) * entry_size;
+    const uint64_t table_frame_size = 8 + entries_size + kZstSeekTableFooterSize;
+    if (table_frame_size > S_CAST(uint64_t, fsize)) {
+      goto ZstRawMtStreamInit_ret_SKIP;
+    }
+    unsigned char table_header[8];
+    if (unlikely(fseeko(ff, fsize - table_frame_size, SEEK_SET) ||
+                 (!fread_unlocked(table_header, 8, 1, ff)))) {
+      goto ZstRawMtStreamInit_ret_READ_FAIL;
+    }
+    uint32_t table_magic;
+    memcpy(&table_magic, table_header, sizeof(int32_t));
+    uint32_t table_payload_size;
+    memcpy(&table_payload_size, &(table_header[4]), sizeof(int32_t));
+    if ((table_magic != kZstSeekTableSkippableMagic) || (table_payload_size != table_frame_size - 8)) {
+      goto ZstRawMtStreamInit_ret_SKIP;
+    }
+    entries_buf = S_CAST(unsigned char*, malloc(entries_size));
+    zstmtp->frame_csizes = S_CAST(uint32_t*, malloc(2 * frame_ct * sizeof(int32_t)));
+    if (unlikely((!entries_buf) || (!zstmtp->frame_csizes))) {
+      goto ZstRawMtStreamInit_ret_NOMEM;
+    }
+    if (unlikely(!fread_unlocked(entries_buf, entries_size, 1, ff))) {
+      goto ZstRawMtStreamInit_ret_READ_FAIL;
+    }
+    uint32_t* frame_csizes = zstmtp->frame_csizes;
+    uint32_t* frame_dsizes = &(frame_csizes[frame_ct]);
+    uint64_t csize_sum = 0;
+    uint32_t max_frame_csize = 0;
+    uint32_t max_frame_dsize = 0;
+    const unsigned char* entries_iter = entries_buf;
+    for (uint32_t frame_idx = 0; frame_idx != frame_ct; ++frame_idx) {
+      uint32_t csize;
+      memcpy(&csize, entries_iter, sizeof(int32_t));
+      uint32_t dsize;
+      memcpy(&dsize, &(entries_iter[4]), sizeof(int32_t));
+      entries_iter = &(entries_iter[entry_size]);
+      frame_csizes[frame_idx] = csize;
+      frame_dsizes[frame_idx] = dsize;
+      csize_sum += csize;
+      if (csize > max_frame_csize) {
+        max_frame_csize = csize;
+      }
+      if (dsize > max_frame_dsize) {
+        max_frame_dsize = dsize;
+      }
+      if (!csize) {
+        goto ZstRawMtStreamInit_ret_SKIP;
+      }
+    }
+    free(entries_buf);
+    entries_buf = nullptr;
+    // The table must account for the whole file; this rejects e.g. files
+    // with other frames appended after a seekable .zst was written.
+    if ((csize_sum + table_frame_size != S_CAST(uint64_t, fsize)) || (max_frame_csize > kMaxZstMtFrameBlen) || (max_frame_dsize > kMaxZstMtFrameBlen)) {
+      goto ZstRawMtStreamInit_ret_SKIP;
+    }
+    zstmtp->frame_dsizes = frame_dsizes;
+    zstmtp->frame_ct = frame_ct;
+    // Round up to a cacheline so that different slots don't share one.
+    zstmtp->max_frame_csize = RoundUpPow2(max_frame_csize, kCacheline);
+    zstmtp->max_frame_dsize = RoundUpPow2(MAXV(max_frame_dsize, 1), kCacheline);
+
+    // 2. Allocate per-thread resources and launch.
+    uint32_t thread_ct = MINV(decompress_thread_ct, kMaxZstDecompressThreads);
+    if (thread_ct > frame_ct) {
+      thread_ct = frame_ct;
+    }
+    if (unlikely(SetThreadCt(thread_ct, &zstmtp->tg))) {
+      goto ZstRawMtStreamInit_ret_NOMEM;
+    }
+    for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+      zstmtp->dctxs[tidx] = ZSTD_createDCtx();
+      if (unlikely(!zstmtp->dctxs[tidx])) {
+        goto ZstRawMtStreamInit_ret_NOMEM;
+      }
+      zstmtp->errmsgs[0][tidx] = nullptr;
+      zstmtp->errmsgs[1][tidx] = nullptr;
+    }
+    zstmtp->in_bufs = S_CAST(unsigned char*, malloc(2 * S_CAST(uintptr_t, thread_ct) * zstmtp->max_frame_csize));
+    zstmtp->out_bufs = S_CAST(unsigned char*, malloc(2 * S_CAST(uintptr_t, thread_ct) * zstmtp->max_frame_dsize));
+    if (unlikely((!zstmtp->in_bufs) || (!zstmtp->out_bufs))) {
+      goto ZstRawMtStreamInit_ret_NOMEM;
+    }
+    SetThreadFuncAndData(ZstRawMtStreamThread, zstmtp, &zstmtp->tg);
+    reterr = ZstMtStart(zstmtp, errmsgp);
+  }
+  while (0) {
+  ZstRawMtStreamInit_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  ZstRawMtStreamInit_ret_READ_FAIL:
+    *errmsgp = strerror(errno);
+    reterr = kPglRetReadFail;
+    break;
+  ZstRawMtStreamInit_ret_SKIP:
+    free_cond(zstmtp->frame_csizes);
+    zstmtp->frame_csizes = nullptr;
+    if (orig_fpos >= 0) {
+      if (unlikely(fseeko(ff, orig_fpos, SEEK_SET))) {
+        *errmsgp = strerror(errno);
+        reterr = kPglRetReadFail;
+        break;
+      }
+    }
+    reterr = kPglRetSkipped;
+    break;
+  }
+  free_cond(entries_buf);
+  return reterr;
+}
+
+// Waits for the in-flight batch, makes it the one being consumed, and starts
+// the next one (if any).
+static PglErr ZstMtJoinAndRespawn(ZstRawMtDecompressStream* zstmtp, const char** errmsgp) {
+  ThreadGroup* tgp = &zstmtp->tg;
+  JoinThreads(tgp);
+  zstmtp->unjoined = 0;
+  const uint32_t parity = zstmtp->worker_parity;
+  const uint32_t batch_frame_ct = zstmtp->batch_frame_cts[parity];
+  for (uint32_t tidx = 0; tidx != batch_frame_ct; ++tidx) {
+    if (unlikely(zstmtp->errmsgs[parity][tidx])) {
+      *errmsgp = zstmtp->errmsgs[parity][tidx];
+      return kPglRetDecompressFail;
+    }
+  }
+  zstmtp->consume_parity = parity;
+  zstmtp->consume_frame_idx = zstmtp->batch_frame_starts[parity];
+  zstmtp->consume_frame_end = zstmtp->consume_frame_idx + batch_frame_ct;
+  zstmtp->consume_slot_idx = 0;
+  zstmtp->consume_pos = 0;
+  if (zstmtp->batch_frame_cts[1 - parity]) {
+    zstmtp->worker_parity = 1 - parity;
+    if (unlikely(SpawnThreads(tgp))) {
+      return kPglRetThreadCreateFail;
+    }
+    zstmtp->unjoined = 1;
+    // The just-joined batch's input slots are free now.
+    return ZstMtLoadBatch(parity, zstmtp, errmsgp);
+  }
+  return kPglRetSuccess;
+}
+
+PglErr ZstRawMtStreamRead(unsigned char* dst_end, ZstRawMtDecompressStream* zstmtp, unsigned char** dst_iterp, const char** errmsgp) {
+  unsigned char* dst_iter = *dst_iterp;
+  const uint32_t thread_ct = GetThreadCtTg(&zstmtp->tg);
+  const uintptr_t max_frame_dsize = zstmtp->max_frame_dsize;
+  while (1) {
+    if (zstmtp->consume_frame_idx != zstmtp->consume_frame_end) {
+      const uint32_t consume_pos = zstmtp->consume_pos;
+      const uint32_t frame_remaining = zstmtp->frame_dsizes[zstmtp->consume_frame_idx] - consume_pos;
+      const uintptr_t slot_idx = zstmtp->consume_parity * thread_ct + zstmtp->consume_slot_idx;
+      const unsigned char* src = &(zstmtp->out_bufs[slot_idx * max_frame_dsize + consume_pos]);
+      const uintptr_t dst_capacity = dst_end - dst_iter;
+      if (frame_remaining > dst_capacity) {
+        memcpy(dst_iter, src, dst_capacity);
+        zstmtp->consume_pos = consume_pos + dst_capacity;
+        dst_iter = dst_end;
+        break;
+      }
+      dst_iter = memcpyua(dst_iter, src, frame_remaining);
+      zstmtp->consume_frame_idx += 1;
+      zstmtp->consume_slot_idx += 1;
+      zstmtp->consume_pos = 0;
+      if (dst_iter == dst_end) {
+        break;
+      }
+      continue;
+    }
+    if (!zstmtp->unjoined) {
+      // eof
+      break;
+    }
+    PglErr reterr = ZstMtJoinAndRespawn(zstmtp, errmsgp);
+    if (unlikely(reterr)) {
+      *dst_iterp = dst_iter;
+      return reterr;
+    }
+  }
+  *dst_iterp = dst_iter;
+  return kPglRetSuccess;
+}
+
+PglErr ZstRawMtStreamRewind(ZstRawMtDecompressStream* zstmtp, const char** errmsgp) {
+  if (zstmtp->unjoined) {
+    JoinThreads(&zstmtp->tg);
+    zstmtp->unjoined = 0;
+  }
+  for (uint32_t tidx = 0; tidx != kMaxZstDecompressThreads; ++tidx) {
+    zstmtp->errmsgs[0][tidx] = nullptr;
+    zstmtp->errmsgs[1][tidx] = nullptr;
+  }
+  return ZstMtStart(zstmtp, errmsgp);
+}
+
+void CleanupZstRawMtStream(ZstRawMtDecompressStream* zstmtp) {
+  CleanupThreads(&zstmtp->tg);
+  zstmtp->unjoined = 0;
+  for (uint32_t tidx = 0; tidx != kMaxZstDecompressThreads; ++tidx) {
+    if (zstmtp->dctxs[tidx]) {
+      ZSTD_freeDCtx(zstmtp->dctxs[tidx]);
+      zstmtp->dctxs[tidx] = nullptr;
+    }
+  }
+  free_cond(zstmtp->in_bufs);
+  zstmtp->in_bufs = nullptr;
+  free_cond(zstmtp->out_bufs);
+  zstmtp->out_bufs = nullptr;
+  free_cond(zstmtp->frame_csizes);
+  zstmtp->frame_csizes = nullptr;
+}
+
 #ifdef __cplusplus
 }
 #endif
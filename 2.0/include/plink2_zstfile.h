@@ -25,6 +25,7 @@
 // a struct instead of a pointer-to-struct.
 
 #include "plink2_base.h"
+#include "plink2_thread.h"
 
 #ifdef STATIC_ZSTD
 #  include "../zstd/lib/zstd.h"
@@ -39,18 +40,104 @@
 namespace plink2 {
 #endif
 
-// may add kFileZstdSeekable later
+// kFileZstdSeekable is only used by TextStream, and only when the file has a
+// usable seek table and more than one decompression thread was requested;
+// GetFileType() and textFILE report kFileZstd for all Zstd files.  Similarly,
+// kFileGzipMt is only used by TextStream, for plain-gzip files decoded with
+// more than one thread.
 ENUM_U31_DEF_START()
   kFileUncompressed,
   kFileGzip,
   kFileBgzf,
-  kFileZstd
+  kFileZstd,
+  kFileZstdSeekable,
+  kFileGzipMt
 ENUM_U31_DEF_END(FileCompressionType);
 
 HEADER_INLINE uint32_t IsZstdFrame(uint32_t magic4) {
   return (magic4 == ZSTD_MAGICNUMBER) || ((magic4 & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START);
 }
 
+// Zstd seekable format (see contrib/seekable_format in the zstd repository):
+// the payload is a sequence of independently decodable frames, followed by a
+// skippable frame listing each frame's compressed and decompressed size, and
+// ending in a 9-byte footer.  Ordinary decoders just skip the table.
+CONSTI32(kZstSeekTableFooterSize, 9);
+CONSTI32(kZstSeekTableEntrySize, 8);  // without checksum
+static const uint32_t kZstSeekTableSkippableMagic = 0x184d2a5eU;
+static const uint32_t kZstSeekableMagic = 0x8f92eab1U;
+
+// Multithreaded decoder for seekable Zstd files.  Worker threads decompress
+// one batch of up to thread_ct whole frames while the consumer copies the
+// previous batch out in order; the consumer also reads the next batch's
+// compressed bytes while the workers are busy.  Every frame in flight needs
+// its own input and output buffer, so files with frames larger than
+// kMaxZstMtFrameBlen are left to the single-threaded decoder.
+CONSTI32(kMaxZstDecompressThreads, 8);
+CONSTI32(kMaxZstMtFrameBlen, 1 << 26);
+
+typedef struct ZstRawMtDecompressStreamStruct {
+  // Borrowed from consumer, not closed by CleanupZstRawMtStream().
+  FILE* ff;
+
+  // Seek table.  frame_dsizes points into the same allocation as
+  // frame_csizes.
+  uint32_t* frame_csizes;
+  uint32_t* frame_dsizes;
+  uint32_t frame_ct;
+  uint32_t max_frame_csize;
+  uint32_t max_frame_dsize;
+
+  ZSTD_DCtx* dctxs[kMaxZstDecompressThreads];
+  // 2 * thread_ct slots of max_frame_csize (resp. max_frame_dsize) bytes,
+  // indexed by parity * thread_ct + tidx.
+  unsigned char* in_bufs;
+  unsigned char* out_bufs;
+
+  // Consumer -> workers.
+  uint32_t worker_parity;
+  uint32_t batch_frame_starts[2];
+  uint32_t batch_frame_cts[2];
+
+  // Workers -> consumer.  Non-null iff the corresponding frame failed to
+  // decompress.
+  const char* errmsgs[2][kMaxZstDecompressThreads];
+
+  // Consumer-only.
+  uint32_t next_load_frame_idx;
+  uint32_t consume_parity;
+  uint32_t consume_frame_idx;
+  uint32_t consume_frame_end;
+  uint32_t consume_slot_idx;
+  uint32_t consume_pos;
+  uint32_t unjoined;
+
+  ThreadGroup tg;
+} ZstRawMtDecompressStream;
+
+extern const char kShortErrZstSeekTableMismatch[];
+
+void PreinitZstRawMtStream(ZstRawMtDecompressStream* zstmtp);
+
+// ff can point anywhere in the file.  Returns kPglRetSkipped, with the file
+// position restored and nothing left allocated, when the file doesn't end in
+// a seek table which covers the entire rest of the file (e.g. pipes, files
+// written by other tools, or plink2 output that was appended to), has fewer
+// than two frames, or has an oversized frame.  Otherwise, decompression of
+// the first batch is already underway when this returns.
+// decompress_thread_ct must be positive.  It is automatically reduced to
+// kMaxZstDecompressThreads if necessary.
+// On other errors, CleanupZstRawMtStream() must still be called.
+PglErr ZstRawMtStreamInit(FILE* ff, uint32_t decompress_thread_ct, ZstRawMtDecompressStream* zstmtp, const char** errmsgp);
+
+// Same contract as BgzfRawMtStreamRead(): *dst_iterp is only left short of
+// dst_end at eof.
+PglErr ZstRawMtStreamRead(unsigned char* dst_end, ZstRawMtDecompressStream* zstmtp, unsigned char** dst_iterp, const char** errmsgp);
+
+PglErr ZstRawMtStreamRewind(ZstRawMtDecompressStream* zstmtp, const char** errmsgp);
+
+void CleanupZstRawMtStream(ZstRawMtDecompressStream* zstmtp);
+
 typedef struct zstRFILEMainStruct {
   FILE* ff;
   ZSTD_DStream* zds;
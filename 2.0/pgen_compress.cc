@@ -33,19 +33,23 @@ int32_t main(int32_t argc, char** argv) {
 "pgen_compress <input .bed or .pgen> <output filename> [sample_ct]\n"
 "  (sample_ct is required when loading a .bed file)\n"
 "pgen_compress -u <input .pgen> <output .bed>\n"
+"pgen_compress -a <input .bed or .pgen> <existing .pgen> [sample_ct]\n"
+"  (appends the input's variants to the existing .pgen)\n"
             , stdout);
       goto main_ret_INVALID_CMDLINE;
     }
     const uint32_t decompress = (argv[1][0] == '-') && (argv[1][1] == 'u') && (argv[1][2] == '\0');
+    const uint32_t append = (argv[1][0] == '-') && (argv[1][1] == 'a') && (argv[1][2] == '\0');
+    const uint32_t flag_ct = decompress || append;
     uint32_t sample_ct = 0xffffffffU;
-    if (S_CAST(uint32_t, argc) == 4 + decompress) {
-      if (ScanPosintDefcap(argv[3 + decompress], &sample_ct)) {
+    if (S_CAST(uint32_t, argc) == 4 + flag_ct) {
+      if (ScanPosintDefcap(argv[3 + flag_ct], &sample_ct)) {
         goto main_ret_INVALID_CMDLINE;
       }
     }
     char errstr_buf[kPglErrstrBufBlen];
     uintptr_t cur_alloc_cacheline_ct;
-    reterr = PgfiInitPhase1(argv[1 + decompress], 0xffffffffU, sample_ct, use_mmap, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, errstr_buf);
+    reterr = PgfiInitPhase1(argv[1 + flag_ct], 0xffffffffU, sample_ct, use_mmap, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, errstr_buf);
     if (reterr) {
       fputs(errstr_buf, stderr);
       goto main_ret_1;
@@ -75,13 +79,25 @@ int32_t main(int32_t argc, char** argv) {
     }
 
     // modify this when trying block-fread
-    reterr = PgrInit(use_mmap? nullptr : argv[1 + decompress], max_vrec_width, &pgfi, &pgr, pgr_alloc);
+    reterr = PgrInit(use_mmap? nullptr : argv[1 + flag_ct], max_vrec_width, &pgfi, &pgr, pgr_alloc);
     if (reterr) {
       fprintf(stderr, "pgr_init error %u\n", S_CAST(uint32_t, reterr));
       goto main_ret_1;
     }
+#ifndef NO_PGEN_IO_POOL
+    // Both loops below visit every variant in order, so we can keep a window
+    // of upcoming records in flight.  (Not applicable to zstd-compressed
+    // records.)
+    if (!pgfi.zframe_ct) {
+      reterr = PgrReadaheadStart(nullptr, 0, variant_ct, 64, 2, &pgr);
+      if (reterr) {
+        fprintf(stderr, "readahead init error %u\n", S_CAST(uint32_t, reterr));
+        goto main_ret_1;
+      }
+    }
+#endif
 
-    if (S_CAST(uint32_t, argc) == 4 + decompress) {
+    if (S_CAST(uint32_t, argc) == 4 + flag_ct) {
       printf("%u variant%s detected.\n", variant_ct, (variant_ct == 1)? "" : "s");
     } else {
       printf("%u variant%s and %u sample%s detected.\n", variant_ct, (variant_ct == 1)? "" : "s", sample_ct, (sample_ct == 1)? "" : "s");
@@ -130,7 +146,12 @@ int32_t main(int32_t argc, char** argv) {
     write_sample_ct = sample_ct;
 #endif
     uint32_t max_vrec_len;
-    reterr = SpgwInitPhase1(argv[2], nullptr, nullptr, variant_ct, write_sample_ct, 0, kfPgenGlobal0, 2, &spgw, &cur_alloc_cacheline_ct, &max_vrec_len);
+    uint32_t prev_variant_ct = 0;
+    if (append) {
+      reterr = SpgwInitPhase1Append(argv[3], nullptr, nullptr, variant_ct, write_sample_ct, 0, kfPgenGlobal0, 2, &spgw, &cur_alloc_cacheline_ct, &max_vrec_len, &prev_variant_ct);
+    } else {
+      reterr = SpgwInitPhase1(argv[2], nullptr, nullptr, variant_ct, write_sample_ct, 0, kfPgenGlobal0, 2, &spgw, &cur_alloc_cacheline_ct, &max_vrec_len);
+    }
     if (reterr) {
       fprintf(stderr, "compression phase 1 error %u\n", S_CAST(uint32_t, reterr));
       goto main_ret_1;
@@ -138,7 +159,16 @@ int32_t main(int32_t argc, char** argv) {
     if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &spgw_alloc)) {
       goto main_ret_NOMEM;
     }
-    SpgwInitPhase2(max_vrec_len, &spgw, spgw_alloc);
+    if (append) {
+      reterr = SpgwInitPhase2Append(max_vrec_len, &spgw, spgw_alloc);
+      if (reterr) {
+        fprintf(stderr, "append phase 2 error %u\n", S_CAST(uint32_t, reterr));
+        goto main_ret_1;
+      }
+      printf("Appending to %u existing variant%s.\n", prev_variant_ct, (prev_variant_ct == 1)? "" : "s");
+    } else {
+      SpgwInitPhase2(max_vrec_len, &spgw, spgw_alloc);
+    }
 
     const uint32_t max_simple_difflist_len = sample_ct / kBitsPerWordD2;
     const uint32_t max_returned_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
@@ -196,7 +226,10 @@ int32_t main(int32_t argc, char** argv) {
   }
   printf("\n");
 
-  SpgwFinish(&spgw);
+  reterr = SpgwFinish(&spgw);
+  if (reterr) {
+    fprintf(stderr, "finish error %u\n", S_CAST(uint32_t, reterr));
+  }
   while (0) {
   main_ret_NOMEM:
     reterr = kPglRetNomem;
@@ -577,6 +577,31 @@ void DoublesToDosage16(const double* doublearr, uint32_t sample_ct, uint32_t har
   *dosage_ct_ptr = dosage_main_iter - dosage_main;
 }
 
+static PgenVrecCache* g_shared_vrec_cache = nullptr;
+
+PglErr SetSharedVrecCache(uintptr_t byte_budget, uint32_t cache_ldbase_genovecs) {
+  PgenVrecCacheRelease(&g_shared_vrec_cache);
+  if (!byte_budget) {
+    return kPglRetSuccess;
+  }
+  return PgenVrecCacheCreate(byte_budget, cache_ldbase_genovecs? kfPgenVrecCacheLdbaseGenovec : kfPgenVrecCache0, &g_shared_vrec_cache);
+}
+
+PglErr AttachSharedVrecCache(const char* fname, PgenFileInfo* pgfip) {
+  if (!g_shared_vrec_cache) {
+    return kPglRetSuccess;
+  }
+  return PgfiAttachVrecCache(fname, g_shared_vrec_cache, pgfip);
+}
+
+void GetSharedVrecCacheStats(PgenVrecCacheStats* statsp) {
+  if (!g_shared_vrec_cache) {
+    memset(statsp, 0, sizeof(PgenVrecCacheStats));
+    return;
+  }
+  PgenVrecCacheGetStats(g_shared_vrec_cache, statsp);
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -17,7 +17,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
-#include "include/pgenlib_misc.h"
+#include "include/pgenlib_read.h"
 
 #ifdef __cplusplus
 namespace plink2 {
@@ -95,6 +95,21 @@ void FloatsToDosage16(const float* floatarr, uint32_t sample_ct, uint32_t hard_c
 
 void DoublesToDosage16(const double* doublearr, uint32_t sample_ct, uint32_t hard_call_halfdist, uintptr_t* genoarr, uintptr_t* dosage_present, uint16_t* dosage_main, uint32_t* dosage_ct_ptr);
 
+// Process-wide PgenVrecCache shared by every reader opened through the
+// Python and R bindings, so that many small queries against the same .pgen
+// don't keep rereading and reparsing the same records.  byte_budget == 0
+// disables it; readers which already hold a reference to the old cache keep
+// using it until they're closed.
+// Not thread-safe; callers are expected to hold the GIL or equivalent.
+PglErr SetSharedVrecCache(uintptr_t byte_budget, uint32_t cache_ldbase_genovecs);
+
+// Attaches the shared cache, if one is active, to pgfip.  Must be called
+// between PgfiInitPhase2() and PgrInit().
+PglErr AttachSharedVrecCache(const char* fname, PgenFileInfo* pgfip);
+
+// Zero-fills *statsp if no shared cache is active.
+void GetSharedVrecCacheStats(PgenVrecCacheStats* statsp);
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -217,6 +217,27 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// SetPgenCache
+void SetPgenCache(double byte_budget, bool cache_ldbase_genovecs);
+RcppExport SEXP _pgenlibr_SetPgenCache(SEXP byte_budgetSEXP, SEXP cache_ldbase_genovecsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type byte_budget(byte_budgetSEXP);
+    Rcpp::traits::input_parameter< bool >::type cache_ldbase_genovecs(cache_ldbase_genovecsSEXP);
+    SetPgenCache(byte_budget, cache_ldbase_genovecs);
+    return R_NilValue;
+END_RCPP
+}
+// GetPgenCacheStats
+List GetPgenCacheStats();
+RcppExport SEXP _pgenlibr_GetPgenCacheStats() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(GetPgenCacheStats());
+    return rcpp_result_gen;
+END_RCPP
+}
 // NewPvar
 SEXP NewPvar(String filename);
 RcppExport SEXP _pgenlibr_NewPvar(SEXP filenameSEXP) {
@@ -295,6 +316,8 @@ static const R_CallMethodDef CallEntries[] = {
     {"_pgenlibr_ReadList", (DL_FUNC) &_pgenlibr_ReadList, 3},
     {"_pgenlibr_VariantScores", (DL_FUNC) &_pgenlibr_VariantScores, 3},
     {"_pgenlibr_ClosePgen", (DL_FUNC) &_pgenlibr_ClosePgen, 1},
+    {"_pgenlibr_SetPgenCache", (DL_FUNC) &_pgenlibr_SetPgenCache, 2},
+    {"_pgenlibr_GetPgenCacheStats", (DL_FUNC) &_pgenlibr_GetPgenCacheStats, 0},
     {"_pgenlibr_NewPvar", (DL_FUNC) &_pgenlibr_NewPvar, 1},
     {"_pgenlibr_GetVariantId", (DL_FUNC) &_pgenlibr_GetVariantId, 2},
     {"_pgenlibr_GetVariantsById", (DL_FUNC) &_pgenlibr_GetVariantsById, 2},
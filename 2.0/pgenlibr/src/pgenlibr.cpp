@@ -158,6 +158,9 @@ void RPgenReader::Load(String filename, Nullable<List> pvar,
     // were ALT1, but otherwise everything works properly.
     stop("Multiallelic variants and phase/dosage info simultaneously present; pvar required in this case");
   }
+  if (plink2::AttachSharedVrecCache(fname, _info_ptr) != plink2::kPglRetSuccess) {
+    stop("Failed to attach shared record cache");
+  }
   _state_ptr = static_cast<plink2::PgenReader*>(malloc(sizeof(plink2::PgenReader)));
   if (!_state_ptr) {
     stop("Out of memory");
@@ -532,22 +535,34 @@ void RPgenReader::ReadIntList(IntegerMatrix buf, IntegerVector variant_subset) {
   // assume that buf has the correct dimensions
   const uintptr_t vsubset_size = variant_subset.size();
   const uint32_t raw_variant_ct = _info_ptr->raw_variant_ct;
+  const uintptr_t sample_ctaw2 = plink2::NypCtToAlignedWordCt(_subset_size);
+  // Validate and convert kPglNypTransposeBatch indexes at a time, then let
+  // PgrGet1Batch() decode the whole batch into _multivar_vmaj_geno_buf.
+  uint32_t batch_variant_idxs[plink2::kPglNypTransposeBatch];
   int32_t* buf_iter = &buf[0];
-  for (uintptr_t col_idx = 0; col_idx != vsubset_size; ++col_idx) {
-    uint32_t variant_idx = variant_subset[col_idx] - 1;
-    if (static_cast<uint32_t>(variant_idx) >= raw_variant_ct) {
-      char errstr_buf[256];
-      sprintf(errstr_buf, "variant_subset element out of range (%d; must be 1..%u)", variant_idx + 1, raw_variant_ct);
-      stop(errstr_buf);
+  for (uintptr_t col_idx_start = 0; col_idx_start < vsubset_size; col_idx_start += plink2::kPglNypTransposeBatch) {
+    const uint32_t batch_size = MINV(vsubset_size - col_idx_start, static_cast<uintptr_t>(plink2::kPglNypTransposeBatch));
+    for (uint32_t uii = 0; uii != batch_size; ++uii) {
+      uint32_t variant_idx = variant_subset[col_idx_start + uii] - 1;
+      if (static_cast<uint32_t>(variant_idx) >= raw_variant_ct) {
+        char errstr_buf[256];
+        sprintf(errstr_buf, "variant_subset element out of range (%d; must be 1..%u)", variant_idx + 1, raw_variant_ct);
+        stop(errstr_buf);
+      }
+      batch_variant_idxs[uii] = variant_idx;
     }
-    plink2::PglErr reterr = PgrGet(_subset_include_vec, _subset_index, _subset_size, variant_idx, _state_ptr, _pgv.genovec);
+    plink2::PglErr reterr = PgrGet1Batch(_subset_include_vec, _subset_index, _subset_size, nullptr, batch_variant_idxs, 0, batch_size, UINT32_MAX, _state_ptr, sample_ctaw2, _multivar_vmaj_geno_buf);
     if (reterr != plink2::kPglRetSuccess) {
       char errstr_buf[256];
-      sprintf(errstr_buf, "PgrGet() error %d", static_cast<int>(reterr));
+      sprintf(errstr_buf, "PgrGet1Batch() error %d", static_cast<int>(reterr));
       stop(errstr_buf);
     }
-    plink2::GenoarrLookup256x4bx4(_pgv.genovec, kGenoRInt32Quads, _subset_size, buf_iter);
-    buf_iter = &(buf_iter[_subset_size]);
+    const uintptr_t* vmaj_iter = _multivar_vmaj_geno_buf;
+    for (uint32_t uii = 0; uii != batch_size; ++uii) {
+      plink2::GenoarrLookup256x4bx4(vmaj_iter, kGenoRInt32Quads, _subset_size, buf_iter);
+      vmaj_iter = &(vmaj_iter[sample_ctaw2]);
+      buf_iter = &(buf_iter[_subset_size]);
+    }
   }
 }
 
@@ -922,3 +937,29 @@ void ClosePgen(List pgen) {
   XPtr<class RPgenReader> rp = as<XPtr<class RPgenReader> >(pgen[1]);
   rp->Close();
 }
+
+// Process-wide record cache shared by all pgen objects opened afterwards; see
+// SetSharedVrecCache().  byte_budget = 0 disables it.
+// [[Rcpp::export]]
+void SetPgenCache(double byte_budget, bool cache_ldbase_genovecs = true) {
+  if ((byte_budget < 0) || (byte_budget > static_cast<double>(~static_cast<uintptr_t>(0)))) {
+    stop("byte_budget out of range");
+  }
+  if (plink2::SetSharedVrecCache(static_cast<uintptr_t>(byte_budget), cache_ldbase_genovecs) != plink2::kPglRetSuccess) {
+    stop("Out of memory");
+  }
+}
+
+// [[Rcpp::export]]
+List GetPgenCacheStats() {
+  plink2::PgenVrecCacheStats stats;
+  plink2::GetSharedVrecCacheStats(&stats);
+  return List::create(_["record_hits"] = static_cast<double>(stats.record_hit_ct),
+                      _["record_misses"] = static_cast<double>(stats.record_miss_ct),
+                      _["ldbase_hits"] = static_cast<double>(stats.ldbase_hit_ct),
+                      _["ldbase_misses"] = static_cast<double>(stats.ldbase_miss_ct),
+                      _["evictions"] = static_cast<double>(stats.evict_ct),
+                      _["entries"] = static_cast<double>(stats.entry_ct),
+                      _["bytes"] = static_cast<double>(stats.byte_ct),
+                      _["byte_budget"] = static_cast<double>(stats.byte_budget));
+}
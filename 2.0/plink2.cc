@@ -54,6 +54,8 @@ static const char ver_str[] = "PLINK v2.00a3"
 #  ifdef USE_AVX2
 #    ifdef USE_CUDA
     " CUDA"
+#    elif defined(USE_AVX512)
+    " AVX512"
 #    else
     " AVX2"
 #    endif
@@ -81,7 +83,7 @@ static const char ver_str2[] =
 #ifndef USE_MKL
   "      "
 #endif
-#ifdef USE_AVX2
+#if defined(USE_AVX2) && (defined(USE_CUDA) || !defined(USE_AVX512))
   "  "
 #endif
 #ifndef NOLAPACK
@@ -92,10 +94,10 @@ static const char ver_str2[] =
 static const char errstr_append[] = "For more info, try \"" PROG_NAME_STR " --help <flag name>\" or \"" PROG_NAME_STR " --help | more\".\n";
 
 #ifndef NOLAPACK
-static const char notestr_null_calc2[] = "Commands include --rm-dup list, --make-bpgen, --export, --freq, --geno-counts,\n--sample-counts, --missing, --hardy, --het, --fst, --indep-pairwise, --ld,\n--sample-diff, --make-king, --king-cutoff, --pmerge, --pgen-diff,\n--write-samples, --write-snplist, --make-grm-list, --pca, --glm, --adjust-file,\n--score, --variant-score, --genotyping-rate, --pgen-info, --validate, and\n--zst-decompress.\n\n\"" PROG_NAME_STR " --help | more\" describes all functions.\n";
+static const char notestr_null_calc2[] = "Commands include --rm-dup list, --make-bpgen, --export, --freq, --geno-counts,\n--sample-counts, --missing, --hardy, --het, --fst, --indep-pairwise, --ld,\n--sample-diff, --make-king, --king-cutoff, --pmerge, --pgen-diff,\n--write-samples, --write-snplist, --make-grm-list, --pca, --glm, --adjust-file,\n--score, --variant-score, --genotyping-rate, --pgen-info, --make-pgi,\n--make-pvar-cache, --validate, and --zst-decompress.\n\n\"" PROG_NAME_STR " --help | more\" describes all functions.\n";
 #else
 // no --pca
-static const char notestr_null_calc2[] = "Commands include --rm-dup list, --make-bpgen, --export, --freq, --geno-counts,\n--sample-counts, --missing, --hardy, --het, --fst, --indep-pairwise, --ld,\n--sample-diff, --make-king, --king-cutoff, --pmerge, --pgen-diff,\n--write-samples, --write-snplist, --make-grm-list, --glm, --adjust-file,\n--score, --variant-score, --genotyping-rate, --pgen-info, --validate, and\n--zst-decompress.\n\n\"" PROG_NAME_STR " --help | more\" describes all functions.\n";
+static const char notestr_null_calc2[] = "Commands include --rm-dup list, --make-bpgen, --export, --freq, --geno-counts,\n--sample-counts, --missing, --hardy, --het, --fst, --indep-pairwise, --ld,\n--sample-diff, --make-king, --king-cutoff, --pmerge, --pgen-diff,\n--write-samples, --write-snplist, --make-grm-list, --glm, --adjust-file,\n--score, --variant-score, --genotyping-rate, --pgen-info, --make-pgi,\n--make-pvar-cache, --validate, and --zst-decompress.\n\n\"" PROG_NAME_STR " --help | more\" describes all functions.\n";
 #endif
 
 // multiallelics-already-joined + terminating null
@@ -179,7 +181,9 @@ FLAGSET64_DEF_START()
   kfCommand1Het = (1 << 24),
   kfCommand1Fst = (1 << 25),
   kfCommand1Pmerge = (1 << 26),
-  kfCommand1PgenDiff = (1 << 27)
+  kfCommand1PgenDiff = (1 << 27),
+  kfCommand1MakePgi = (1 << 28),
+  kfCommand1MakePvarCache = (1 << 29)
 FLAGSET64_DEF_END(Command1Flags);
 
 void PgenInfoPrint(const char* pgenname, const PgenFileInfo* pgfip, PgenHeaderCtrl header_ctrl, uint32_t max_allele_ct) {
@@ -269,6 +273,62 @@ PglErr PgenInfoStandalone(const char* pgenname) {
   return reterr;
 }
 
+// Writes {pgenname}.pgi, which is automatically used on later .pgen loads.
+PglErr WritePgenIndex(const char* flagname, const char* pgenname) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PgenFileInfo pgfi;
+  PglErr reterr = kPglRetSuccess;
+  PreinitPgfi(&pgfi);
+  {
+    PgenHeaderCtrl header_ctrl;
+    uintptr_t cur_alloc_cacheline_ct;
+    reterr = PgfiInitPhase1(pgenname, UINT32_MAX, UINT32_MAX, 0, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, g_logbuf);
+    if (unlikely(reterr)) {
+      if ((reterr == kPglRetSampleMajorBed) || (reterr == kPglRetImproperFunctionCall)) {
+        logerrprintf("Warning: Skipping %s since a .bed file was provided.\n", flagname);
+        reterr = kPglRetSuccess;
+      } else {
+        logerrputsb();
+      }
+      goto WritePgenIndex_ret_1;
+    }
+    if (pgfi.const_vrec_width) {
+      logerrprintfww("Warning: Skipping %s, since %s has fixed-width variant records (no index needed).\n", flagname, pgenname);
+      goto WritePgenIndex_ret_1;
+    }
+    const uint32_t raw_variant_ct = pgfi.raw_variant_ct;
+    const uint32_t pgenname_slen = strlen(pgenname);
+    unsigned char* pgfi_alloc;
+    char* pgi_fname;
+    if (unlikely(bigstack_alloc_uc(cur_alloc_cacheline_ct * kCacheline, &pgfi_alloc) ||
+                 bigstack_alloc_w(raw_variant_ct + 1, &pgfi.allele_idx_offsets) ||
+                 bigstack_alloc_w(BitCtToWordCt(raw_variant_ct), &pgfi.nonref_flags) ||
+                 bigstack_alloc_c(pgenname_slen + 5, &pgi_fname))) {
+      reterr = kPglRetNomem;
+      goto WritePgenIndex_ret_1;
+    }
+    uintptr_t pgr_alloc_cacheline_ct = 0;
+    uint32_t max_vrec_width;
+    reterr = PgfiInitPhase2(header_ctrl, 0, 0, 1, 0, raw_variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &pgr_alloc_cacheline_ct, g_logbuf);
+    if (unlikely(reterr)) {
+      logerrputsb();
+      goto WritePgenIndex_ret_1;
+    }
+    snprintf(memcpya(pgi_fname, pgenname, pgenname_slen), 5, ".pgi");
+    reterr = PgfiWritePgi(pgenname, pgi_fname, header_ctrl, max_vrec_width, &pgfi, g_logbuf);
+    if (unlikely(reterr)) {
+      WordWrapB(0);
+      logerrputsb();
+      goto WritePgenIndex_ret_1;
+    }
+    logprintfww("%s: Index written to %s .\n", flagname, pgi_fname);
+  }
+ WritePgenIndex_ret_1:
+  CleanupPgfi2(pgenname, &pgfi, &reterr);
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
 typedef struct Plink2CmdlineStruct {
   NONCOPYABLE(Plink2CmdlineStruct);
   MiscFlags misc_flags;
@@ -375,6 +435,7 @@ typedef struct Plink2CmdlineStruct {
   uint32_t filter_min_allele_ct;
   uint32_t filter_max_allele_ct;
   uint32_t bed_border_bp;
+  uint32_t pgen_io_thread_ct;
 
   char* var_filter_exceptions_flattened;
   char* varid_template_str;
@@ -819,6 +880,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
       if (unlikely(reterr)) {
         goto Plink2Core_ret_1;
       }
+      BigstackPhaseEnd(".psam load");
 
       // todo: add option to discard loaded SIDs
       raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
@@ -875,10 +937,11 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
       const uint32_t xheader_needed = (pcp->exportf_info.flags & (kfExportfVcf | kfExportfBcf))? 1 : 0;
       const uint32_t qualfilter_needed = xheader_needed || ((pcp->rmdup_mode != kRmDup0) && (pcp->rmdup_mode <= kRmDupExcludeMismatch));
 
-      reterr = LoadPvar(pvarname, pcp->var_filter_exceptions_flattened, pcp->varid_template_str, pcp->varid_multi_template_str, pcp->varid_multi_nonsnp_template_str, pcp->missing_varid_match, pcp->require_info_flattened, pcp->require_no_info_flattened, &(pcp->extract_if_info_expr), &(pcp->exclude_if_info_expr), pcp->misc_flags, pcp->pvar_psam_flags, xheader_needed, qualfilter_needed, pcp->var_min_qual, pcp->splitpar_bound1, pcp->splitpar_bound2, pcp->new_variant_id_max_allele_slen, (pcp->filter_flags / kfFilterSnpsOnly) & 3, !(pcp->dependency_flags & kfFilterNoSplitChr), pcp->filter_min_allele_ct, pcp->filter_max_allele_ct, pcp->max_thread_ct, cip, &max_variant_id_slen, &info_reload_slen, &vpos_sortstatus, &xheader, &variant_include, &variant_bps, &variant_ids_mutable, &allele_idx_offsets, K_CAST(const char***, &allele_storage_mutable), &pvar_qual_present, &pvar_quals, &pvar_filter_present, &pvar_filter_npass, &pvar_filter_storage_mutable, &nonref_flags, &variant_cms, &chr_idxs, &raw_variant_ct, &variant_ct, &max_allele_ct, &max_allele_slen, &xheader_blen, &info_flags, &max_filter_slen);
+      reterr = LoadPvar(pvarname, pcp->var_filter_exceptions_flattened, pcp->varid_template_str, pcp->varid_multi_template_str, pcp->varid_multi_nonsnp_template_str, pcp->missing_varid_match, pcp->require_info_flattened, pcp->require_no_info_flattened, &(pcp->extract_if_info_expr), &(pcp->exclude_if_info_expr), pcp->misc_flags, pcp->pvar_psam_flags, xheader_needed, qualfilter_needed, pcp->var_min_qual, pcp->splitpar_bound1, pcp->splitpar_bound2, pcp->new_variant_id_max_allele_slen, (pcp->filter_flags / kfFilterSnpsOnly) & 3, !(pcp->dependency_flags & kfFilterNoSplitChr), pcp->filter_min_allele_ct, pcp->filter_max_allele_ct, !pgenname[0], pcp->from_bp, pcp->to_bp, pcp->max_thread_ct, cip, &max_variant_id_slen, &info_reload_slen, &vpos_sortstatus, &xheader, &variant_include, &variant_bps, &variant_ids_mutable, &allele_idx_offsets, K_CAST(const char***, &allele_storage_mutable), &pvar_qual_present, &pvar_quals, &pvar_filter_present, &pvar_filter_npass, &pvar_filter_storage_mutable, &nonref_flags, &variant_cms, &chr_idxs, &raw_variant_ct, &variant_ct, &max_allele_ct, &max_allele_slen, &xheader_blen, &info_flags, &max_filter_slen);
       if (unlikely(reterr)) {
         goto Plink2Core_ret_1;
       }
+      BigstackPhaseEnd(".pvar load");
       if (unlikely(!variant_ct)) {
         // conditionally permit this?
         if (raw_variant_ct) {
@@ -922,7 +985,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           }
         }
         if ((!pvar_renamed) && (make_plink2_flags & kfMakePvar)) {
-          OutnameZstSet(".pvar", pcp->pvar_psam_flags & kfPvarZs, outname_end);
+          OutnameCstreamSet(".pvar", pcp->pvar_psam_flags & kfPvarZs, pcp->pvar_psam_flags & kfPvarBgz, outname_end);
           // pvar_renamed = RealpathIdentical();
           if (RealpathIdentical(outname, g_textbuf, &(g_textbuf[kPglFnamesize + 64]))) {
             logerrputs("Warning: .pvar input and output filenames match.  Appending '~' to input\nfilename.\n");
@@ -994,10 +1057,6 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
       }
       pgfi.allele_idx_offsets = allele_idx_offsets;
       pgfi.max_allele_ct = max_allele_ct;
-      unsigned char* pgfi_alloc;
-      if (unlikely(bigstack_alloc_uc(cur_alloc_cacheline_ct * kCacheline, &pgfi_alloc))) {
-        goto Plink2Core_ret_NOMEM;
-      }
       const uint32_t nonref_flags_already_loaded = (nonref_flags != nullptr);
       if (!nonref_flags_already_loaded) {
         const uint32_t nonref_flags_status_shifted = header_ctrl & 192;
@@ -1014,10 +1073,44 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
       }
       pgfi.nonref_flags = nonref_flags;
       uint32_t max_vrec_width;
-      // only practical effect of setting use_blockload to zero here is that
-      // pgr_alloc_cacheline_ct is overestimated by
-      // DivUp(max_vrec_width, kCacheline).
-      reterr = PgfiInitPhase2(header_ctrl, 1, nonref_flags_already_loaded, 1, 0, raw_variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &pgr_alloc_cacheline_ct, g_logbuf);
+      reterr = kPglRetSkipped;
+      if (!pgfi.const_vrec_width) {
+        // Use {pgenname}.pgi (see --make-pgi) when it's present and current,
+        // so var_fpos[]/vrtypes[] don't have to be decoded and copied.
+        const uint32_t pgenname_slen = strlen(pgenname);
+        char* pgi_fname;
+        if (unlikely(bigstack_alloc_c(pgenname_slen + 5, &pgi_fname))) {
+          goto Plink2Core_ret_NOMEM;
+        }
+        snprintf(memcpya(pgi_fname, pgenname, pgenname_slen), 5, ".pgi");
+        reterr = PgfiInitPhase2Pgi(pgenname, pgi_fname, header_ctrl, 1, nonref_flags_already_loaded, 1, &max_vrec_width, &pgfi, &pgr_alloc_cacheline_ct, g_logbuf);
+        if (reterr == kPglRetSkipped) {
+          if (g_logbuf[0]) {
+            WordWrapB(0);
+            logerrputsb();
+          }
+        } else if (unlikely(reterr)) {
+          WordWrapB(0);
+          logerrputsb();
+          goto Plink2Core_ret_1;
+        }
+      }
+      if (reterr == kPglRetSkipped) {
+        // Switch to the compact record-offset table when the flat one would
+        // take more than 1/8 of the workspace.  This slows random access a
+        // bit, but sequential access is unaffected.
+        if (S_CAST(uint64_t, raw_variant_ct) * (8 * sizeof(int64_t)) > bigstack_left()) {
+          PgfiEnableCompactFpos(header_ctrl, &pgfi, &cur_alloc_cacheline_ct);
+        }
+        unsigned char* pgfi_alloc;
+        if (unlikely(bigstack_alloc_uc(cur_alloc_cacheline_ct * kCacheline, &pgfi_alloc))) {
+          goto Plink2Core_ret_NOMEM;
+        }
+        // only practical effect of setting use_blockload to zero here is that
+        // pgr_alloc_cacheline_ct is overestimated by
+        // DivUp(max_vrec_width, kCacheline).
+        reterr = PgfiInitPhase2(header_ctrl, 1, nonref_flags_already_loaded, 1, 0, raw_variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &pgr_alloc_cacheline_ct, g_logbuf);
+      }
       if (unlikely(reterr)) {
         WordWrapB(0);
         logerrputsb();
@@ -1027,6 +1120,39 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         logerrputs("Error: .pgen file contains multiallelic variants, while .pvar does not.\n");
         goto Plink2Core_ret_INCONSISTENT_INPUT;
       }
+      {
+        // {pgenname}.vsum (see --make-pgen 'vsum') lets
+        // LoadAlleleAndGenoCounts() skip genotype decoding when all samples
+        // are included.
+        const uint32_t pgenname_slen = strlen(pgenname);
+        char* vsum_fname;
+        if (unlikely(bigstack_alloc_c(pgenname_slen + 6, &vsum_fname))) {
+          goto Plink2Core_ret_NOMEM;
+        }
+        snprintf(memcpya(vsum_fname, pgenname, pgenname_slen), 6, ".vsum");
+        reterr = PgfiAttachVariantSummary(pgenname, vsum_fname, &pgfi, g_logbuf);
+        if (reterr == kPglRetSkipped) {
+          if (g_logbuf[0]) {
+            WordWrapB(0);
+            logerrputsb();
+          }
+          reterr = kPglRetSuccess;
+        } else if (unlikely(reterr)) {
+          WordWrapB(0);
+          logerrputsb();
+          goto Plink2Core_ret_1;
+        }
+        BigstackReset(vsum_fname);
+      }
+#ifndef NO_PGEN_IO_POOL
+      if (pcp->pgen_io_thread_ct) {
+        // All PgenMtLoadInit()/PgfiMultiread() users pick this up.
+        reterr = PgfiAttachIoPool(pcp->pgen_io_thread_ct, &pgfi);
+        if (unlikely(reterr)) {
+          goto Plink2Core_ret_1;
+        }
+      }
+#endif
       if (pcp->misc_flags & kfMiscRealRefAlleles) {
         if (unlikely(nonref_flags && (!AllBitsAreOne(nonref_flags, raw_variant_ct)))) {
           // technically a lie, it's okay if a .bed is first converted to .pgen
@@ -1621,6 +1747,63 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
       }
     }
 
+    BigstackPhaseEnd("initialization and filtering");
+    if (pcp->misc_flags & kfMiscDryRun) {
+      logprintf("--dry-run: %u sample%s and %u variant%s remaining.\n", sample_ct, (sample_ct == 1)? "" : "s", variant_ct, (variant_ct == 1)? "" : "s");
+      const uint64_t resident_bytes = BigstackUsage();
+      logprintf("--dry-run: %" PRIu64 " MiB of workspace currently in use (high-water mark %" PRIu64 " MiB).\n", (resident_bytes + 1048575) >> 20, (S_CAST(uint64_t, BigstackPeak()) + 1048575) >> 20);
+      Command1Flags unsized_commands = pcp->command_flags1 & (~(kfCommand1WriteSamples | kfCommand1Validate | kfCommand1PgenInfo));
+      // Allele frequency arrays are allocated ahead of the sized commands.
+      uint64_t afreq_bytes = 0;
+      if (pgenname[0]) {
+        const uint32_t maj_alleles_needed = MajAllelesAreNeeded(pcp->command_flags1, pcp->pca_flags, pcp->glm_info.flags);
+        if (maj_alleles_needed || DecentAlleleFreqsAreNeeded(pcp->command_flags1, pcp->het_flags, pcp->score_info.flags) || IndecentAlleleFreqsAreNeeded(pcp->command_flags1, pcp->min_maf, pcp->max_maf)) {
+          const uintptr_t raw_allele_ct = allele_idx_offsets? allele_idx_offsets[raw_variant_ct] : (2 * raw_variant_ct);
+          afreq_bytes = RoundUpPow2((raw_allele_ct - raw_variant_ct) * sizeof(double), kCacheline);
+          if (maj_alleles_needed) {
+            afreq_bytes += RoundUpPow2(raw_variant_ct * sizeof(AlleleCode), kCacheline);
+          }
+        }
+      }
+      uint64_t max_command_bytes = 0;
+      if ((pcp->command_flags1 & (kfCommand1MakeKing | kfCommand1KingCutoff)) && (!king_cutoff_fprefix) && (!pcp->king_table_subset_fname) && (!(pcp->king_flags & kfKingRelCheck)) && pgenname[0] && (sample_ct >= 2) && variant_ct) {
+        KingWorkspace kw;
+        KingWorkspacePlan(&pii.sii, variant_include, cip, raw_sample_ct, sample_ct, raw_variant_ct, pcp->king_cutoff, pcp->king_flags, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, pgr_alloc_cacheline_ct, &kw);
+        // Non-autosomal variants are still counted here, so this can be a
+        // slight overestimate.
+        const uint64_t multiread_bytes = PgfiMultireadGetCachelineReq(variant_include, &pgfi, variant_ct, kPglVblockSize) * kCacheline;
+        uint64_t king_bytes = KingWorkspaceReq(&kw, multiread_bytes);
+        if (pcp->king_cutoff != -1) {
+          // prev_sample_include
+          king_bytes += BitCtToCachelineCt(raw_sample_ct) * kCacheline;
+        }
+        logprintf("--dry-run: KING-robust computation needs ~%" PRIu64 " MiB for a single pass.\n", (king_bytes + 1048575) >> 20);
+        max_command_bytes = king_bytes;
+        unsized_commands &= ~(kfCommand1MakeKing | kfCommand1KingCutoff);
+      }
+      if (((pcp->command_flags1 & kfCommand1MakeRel) || GrmKeepIsNeeded(pcp->command_flags1, pcp->pca_flags)) && pgenname[0] && (sample_ct >= 2)) {
+        GrmWorkspace gw;
+        GrmWorkspacePlan(variant_include, cip, raw_sample_ct, sample_ct, raw_variant_ct, max_allele_ct, (allele_idx_offsets != nullptr), pgfi.gflags, pcp->grm_flags, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, &gw);
+        const uint64_t grm_bytes = gw.byte_ct;
+        logprintf("--dry-run: GRM construction needs ~%" PRIu64 " MiB.\n", (grm_bytes + 1048575) >> 20);
+        if (max_command_bytes < grm_bytes) {
+          max_command_bytes = grm_bytes;
+        }
+        unsized_commands &= ~kfCommand1MakeRel;
+      }
+      if (unsized_commands) {
+        logputs("--dry-run: Other requested commands size their buffers to the available\nworkspace, and have no fixed requirement.\n");
+      }
+      // InitBigstack() reserves the last 576 bytes, and can lose up to a
+      // cacheline to alignment.
+      uint64_t suggested_mib = (resident_bytes + afreq_bytes + max_command_bytes + 576 + kCacheline + 1048575) >> 20;
+      if (suggested_mib < kBigstackMinMib) {
+        suggested_mib = kBigstackMinMib;
+      }
+      logprintf("--dry-run: Suggested minimum --memory value: %" PRIu64 ".  Skipping analysis.\n", suggested_mib);
+      goto Plink2Core_ret_1;
+    }
+
     char* loop_cats_outname_endp1_backup = &(outname_end[1]);
     uintptr_t* loop_cats_sample_include_backup = nullptr;
     uintptr_t* loop_cats_founder_info_backup = nullptr;
@@ -1984,6 +2167,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          BigstackPhaseEnd("allele/genotype counting");
           if (pcp->command_flags1 & kfCommand1GenotypingRate) {
             // possible todo: also report this opportunistically
             // (variant_missing_hc_cts filled for other reasons).  worth
@@ -2137,6 +2321,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
               if (unlikely(reterr)) {
                 goto Plink2Core_ret_1;
               }
+              BigstackPhaseEnd("--hardy");
               if (!(pcp->command_flags1 & (~(kfCommand1GenotypingRate | kfCommand1AlleleFreq | kfCommand1GenoCounts | kfCommand1MissingReport | kfCommand1Hardy | kfCommand1WriteSamples | kfCommand1Validate | kfCommand1PgenInfo | kfCommand1RmDupList)))) {
                 continue;
               }
@@ -2221,6 +2406,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          BigstackPhaseEnd("--make-king-table");
         } else {
           if (king_cutoff_fprefix) {
             reterr = KingCutoffBatch(&pii.sii, raw_sample_ct, pcp->king_cutoff, sample_include, king_cutoff_fprefix, &sample_ct);
@@ -2230,6 +2416,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          BigstackPhaseEnd("--make-king");
           if (pcp->king_cutoff != -1) {
             snprintf(outname_end, kMaxOutfnameExtBlen, ".king.cutoff.in.id");
             reterr = WriteSampleIds(sample_include, &pii.sii, outname, sample_ct);
@@ -2255,6 +2442,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        BigstackPhaseEnd("--make-rel/--make-grm");
         // Retire --rel-cutoff, since --king-cutoff is pretty clearly better.
         // KING-robust has significant systematic biases when interracial
         // couples are involved, though.  Still may be okay for first-degree
@@ -2336,6 +2524,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        BigstackPhaseEnd("--pca");
       }
 #endif
 
@@ -2565,6 +2754,14 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          BigstackPhaseEnd("--make-[b]pgen/--make-bed");
+          if (make_plink2_flags & kfMakePgenIndex) {
+            snprintf(outname_end, kMaxOutfnameExtBlen, ".pgen");
+            reterr = WritePgenIndex((make_plink2_flags & kfMakePvar)? "--make-pgen" : "--make-bpgen", outname);
+            if (unlikely(reterr)) {
+              goto Plink2Core_ret_1;
+            }
+          }
           // no BigstackReset needed here, since allele_presents only needed
           // if 'trim-alts', and later operations are prohibited in that case
         }
@@ -2574,6 +2771,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          BigstackPhaseEnd("--export");
         }
 
         if (variant_bps_backup) {
@@ -2613,6 +2811,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        BigstackPhaseEnd("--indep-pairwise");
       }
 
       if (pcp->command_flags1 & kfCommand1Ld) {
@@ -2641,6 +2840,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        BigstackPhaseEnd("--score");
       }
       if (pcp->command_flags1 & kfCommand1Vscore) {
         reterr = Vscore(variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, sample_include, &pii.sii, sex_male, allele_freqs, pcp->vscore_fname, &(pcp->vscore_col_idx_range_list), raw_variant_ct, variant_ct, raw_sample_ct, sample_ct, max_allele_slen, pcp->vscore_flags, pcp->xchr_model, pcp->max_thread_ct, pgr_alloc_cacheline_ct, &pgfi, outname, outname_end);
@@ -2659,6 +2859,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        BigstackPhaseEnd("--glm");
       }
     }
   }
@@ -2694,6 +2895,13 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
   free_cond(covar_names);
   free_cond(pheno_names);
   CleanupPgr2(".pgen file", &simple_pgr, &reterr);
+#ifndef NO_PGEN_IO_POOL
+  if (pgfi.io_pool) {
+    PgenIoPoolStats io_stats;
+    PgenIoPoolGetStats(pgfi.io_pool, &io_stats);
+    logprintf("--pgen-io-threads: %" PRIu64 " read%s (%" PRIu64 " MiB); %" PRIu64 " block-load wait%s totaling %.3f sec.\n", io_stats.request_ct, (io_stats.request_ct == 1)? "" : "s", io_stats.byte_ct >> 20, io_stats.stall_ct, (io_stats.stall_ct == 1)? "" : "s", u63tod(io_stats.stall_ns) * 1e-9);
+  }
+#endif
   CleanupPgfi2(".pgen file", &pgfi, &reterr);
   // no BigstackReset() needed?
   return reterr;
@@ -3112,7 +3320,7 @@ static_assert(kChrOffsetMT == 3, "--chr-set/--cow/... assume kChrOffsetMT == 3."
 }  // namespace plink2
 #endif
 
-#if defined(CPU_CHECK_SSE42) || defined(CPU_CHECK_AVX2)
+#if defined(CPU_CHECK_SSE42) || defined(CPU_CHECK_AVX2) || defined(CPU_CHECK_AVX512)
 int RealMain(int argc, char** argv) {
 #else
 int main(int argc, char** argv) {
@@ -3160,6 +3368,9 @@ int main(int argc, char** argv) {
   PmergeInfo pmerge_info;
   const char* flagname_p = nullptr;
   char* king_cutoff_fprefix = nullptr;
+  char* perf_log_fname = nullptr;
+  char* spill_dirname = nullptr;
+  uint64_t perf_log_start_ns = 0;
   char* const_fid = nullptr;
   char* import_single_chr_str = nullptr;
   char* ox_missing_code = nullptr;
@@ -3606,6 +3817,7 @@ int main(int argc, char** argv) {
     pc.filter_min_allele_ct = 0;
     pc.filter_max_allele_ct = UINT32_MAX;
     pc.bed_border_bp = 0;
+    pc.pgen_io_thread_ct = 0;
     double import_dosage_certainty = 0.0;
     int32_t vcf_min_gq = -1;
     int32_t vcf_min_dp = -1;
@@ -3626,6 +3838,8 @@ int main(int argc, char** argv) {
     uint32_t notchr_present = 0;
     uint32_t permit_multiple_inclusion_filters = 0;
     uint32_t memory_require = 0;
+    BigstackFlags bigstack_flags = kfBigstack0;
+    uint32_t output_roundtrip = 0;
 #ifdef USE_MKL
     uint32_t mkl_native = 0;
 #endif
@@ -4479,6 +4693,9 @@ int main(int argc, char** argv) {
             goto main_ret_INVALID_CMDLINE_WWA;
           }
           pc.dosage_erase_thresh = S_CAST(int32_t, dosage_erase_frac * ((1 + kSmallEpsilon) * kDosageMid));
+        } else if (strequal_k_unsafe(flagname_p2, "ry-run")) {
+          pc.misc_flags |= kfMiscDryRun;
+          goto main_param_zero;
         } else if (strequal_k_unsafe(flagname_p2, "ummy")) {
           if (unlikely(load_params || xload)) {
             goto main_ret_INVALID_CMDLINE_INPUT_CONFLICT;
@@ -4991,7 +5208,7 @@ int main(int argc, char** argv) {
 
       case 'f':
         if (strequal_k_unsafe(flagname_p2, "req")) {
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 5))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 6))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t bins_only = 0;
@@ -5000,6 +5217,8 @@ int main(int argc, char** argv) {
             const uint32_t cur_modif_slen = strlen(cur_modif);
             if (strequal_k(cur_modif, "zs", cur_modif_slen)) {
               pc.freq_rpt_flags |= kfAlleleFreqZs;
+            } else if (strequal_k(cur_modif, "bgz", cur_modif_slen)) {
+              pc.freq_rpt_flags |= kfAlleleFreqBgz;
             } else if (strequal_k(cur_modif, "counts", cur_modif_slen)) {
               pc.freq_rpt_flags |= kfAlleleFreqCounts;
             } else if (strequal_k(cur_modif, "case-control", cur_modif_slen)) {
@@ -5055,15 +5274,23 @@ int main(int argc, char** argv) {
               logerrputs("Error: --freq 'bins-only' must be used with 'refbins[-file]=' and/or\n'alt1bins[-file]='.\n");
               goto main_ret_INVALID_CMDLINE_A;
             }
-            if (unlikely(pc.freq_rpt_flags & (kfAlleleFreqZs | kfAlleleFreqColAll))) {
-              logerrputs("Error: --freq 'bins-only' cannot be used with 'zs' or 'cols=' (which only\naffect the main report).\n");
+            if (unlikely(pc.freq_rpt_flags & (kfAlleleFreqZs | kfAlleleFreqBgz | kfAlleleFreqColAll))) {
+              logerrputs("Error: --freq 'bins-only' cannot be used with 'zs', 'bgz', or 'cols=' (which\nonly affect the main report).\n");
               goto main_ret_INVALID_CMDLINE_A;
             }
             pc.freq_rpt_flags |= kfAlleleFreqBinsOnly;
           }
+          if (unlikely((pc.freq_rpt_flags & (kfAlleleFreqZs | kfAlleleFreqBgz)) == (kfAlleleFreqZs | kfAlleleFreqBgz))) {
+            logerrputs("Error: --freq 'zs' and 'bgz' modifiers cannot be used together.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (!(pc.freq_rpt_flags & kfAlleleFreqColAll)) {
             pc.freq_rpt_flags |= kfAlleleFreqColDefault;
           }
+          if (pc.freq_rpt_flags & kfAlleleFreqBgz) {
+            // tabix index needs these
+            pc.freq_rpt_flags |= kfAlleleFreqColChrom | kfAlleleFreqColPos;
+          }
           pc.command_flags1 |= kfCommand1AlleleFreq;
           pc.dependency_flags |= kfFilterAllReq;
         } else if (strequal_k_unsafe(flagname_p2, "rom")) {
@@ -5370,7 +5597,7 @@ int main(int argc, char** argv) {
           pc.command_flags1 |= kfCommand1GenoCounts;
           pc.dependency_flags |= kfFilterAllReq;
         } else if (strequal_k_unsafe(flagname_p2, "lm")) {
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 18))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 19))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t explicit_firth_fallback = 0;
@@ -5380,6 +5607,8 @@ int main(int argc, char** argv) {
             const uint32_t cur_modif_slen = strlen(cur_modif);
             if (strequal_k(cur_modif, "zs", cur_modif_slen)) {
               pc.glm_info.flags |= kfGlmZs;
+            } else if (strequal_k(cur_modif, "bgz", cur_modif_slen)) {
+              pc.glm_info.flags |= kfGlmBgz;
             } else if (strequal_k(cur_modif, "omit-ref", cur_modif_slen) ||
                        strequal_k(cur_modif, "a0-ref", cur_modif_slen)) {
               pc.glm_info.flags |= kfGlmOmitRef;
@@ -5543,6 +5772,14 @@ int main(int argc, char** argv) {
           if (!pc.glm_info.cols) {
             pc.glm_info.cols = kfGlmColDefault;
           }
+          if (pc.glm_info.flags & kfGlmBgz) {
+            if (unlikely(pc.glm_info.flags & kfGlmZs)) {
+              logerrputs("Error: --glm 'zs' and 'bgz' modifiers cannot be used together.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            // tabix index needs these
+            pc.glm_info.cols |= kfGlmColChrom | kfGlmColPos;
+          }
           if (unlikely((explicit_firth_fallback && (pc.glm_info.flags & (kfGlmNoFirth | kfGlmFirth))) || ((pc.glm_info.flags & (kfGlmNoFirth | kfGlmFirth)) == (kfGlmNoFirth | kfGlmFirth)))) {
             logerrputs("Error: Conflicting --glm arguments.\n");
             goto main_ret_INVALID_CMDLINE_A;
@@ -5687,6 +5924,8 @@ int main(int argc, char** argv) {
             const uint32_t cur_modif_slen = strlen(cur_modif);
             if (strequal_k(cur_modif, "zs", cur_modif_slen)) {
               pc.hardy_flags |= kfHardyZs;
+            } else if (strequal_k(cur_modif, "bgz", cur_modif_slen)) {
+              pc.hardy_flags |= kfHardyBgz;
             } else if (strequal_k(cur_modif, "midp", cur_modif_slen)) {
               pc.hardy_flags |= kfHardyMidp;
             } else if (strequal_k(cur_modif, "redundant", cur_modif_slen)) {
@@ -5709,9 +5948,17 @@ int main(int argc, char** argv) {
               goto main_ret_INVALID_CMDLINE_WWA;
             }
           }
+          if (unlikely((pc.hardy_flags & (kfHardyZs | kfHardyBgz)) == (kfHardyZs | kfHardyBgz))) {
+            logerrputs("Error: --hardy 'zs' and 'bgz' modifiers cannot be used together.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (!(pc.hardy_flags & kfHardyColAll)) {
             pc.hardy_flags |= kfHardyColDefault;
           }
+          if (pc.hardy_flags & kfHardyBgz) {
+            // tabix index needs these
+            pc.hardy_flags |= kfHardyColChrom | kfHardyColPos;
+          }
           pc.command_flags1 |= kfCommand1Hardy;
           pc.dependency_flags |= kfFilterAllReq;
         } else if (strequal_k_unsafe(flagname_p2, "we")) {
@@ -6467,16 +6714,42 @@ int main(int argc, char** argv) {
 
       case 'm':
         if (strequal_k_unsafe(flagname_p2, "emory")) {
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 2))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 4))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
-          uint32_t mb_modif_idx = 1;
-          if (param_ct == 2) {
-            if (unlikely(CheckExtraParam(&(argvk[arg_idx]), "require", &mb_modif_idx))) {
-              goto main_ret_INVALID_CMDLINE_A;
+          uint32_t mb_modif_idx = 0;
+          for (uint32_t param_idx = 1; param_idx <= param_ct; ++param_idx) {
+            const char* cur_modif = argvk[arg_idx + param_idx];
+            const uint32_t cur_modif_slen = strlen(cur_modif);
+            if (strequal_k(cur_modif, "require", cur_modif_slen)) {
+              memory_require = 1;
+            } else if (strequal_k(cur_modif, "hugepages", cur_modif_slen)) {
+              bigstack_flags |= kfBigstackHugetlb;
+            } else if (strequal_k(cur_modif, "thp", cur_modif_slen)) {
+              bigstack_flags |= kfBigstackThp;
+            } else if (strequal_k(cur_modif, "numa-interleave", cur_modif_slen)) {
+              bigstack_flags |= kfBigstackNumaInterleave;
+            } else if (likely(!mb_modif_idx)) {
+              mb_modif_idx = param_idx;
+            } else {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --memory argument '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
             }
-            memory_require = 1;
           }
+          if (unlikely(!mb_modif_idx)) {
+            logerrputs("Error: --memory requires a workspace size.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+          if (unlikely((bigstack_flags & kfBigstackHugetlb) && (bigstack_flags & kfBigstackThp))) {
+            logerrputs("Error: --memory 'hugepages' and 'thp' modifiers cannot be used together.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+#ifndef __linux__
+          if (unlikely(bigstack_flags)) {
+            logerrputs("Error: --memory 'hugepages', 'thp', and 'numa-interleave' modifiers are only\nsupported on Linux.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+#endif
           const char* mb_modif = argvk[arg_idx + mb_modif_idx];
           if (unlikely(ScanPosintptrx(mb_modif, R_CAST(uintptr_t*, &malloc_size_mib)))) {
             snprintf(g_logbuf, kLogbufSize, "Error: Invalid --memory argument '%s'.\n", mb_modif);
@@ -6564,7 +6837,7 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-bpgen cannot be used with --keep-autoconv.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 7))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 11))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t varid_semicolon = 0;
@@ -6631,6 +6904,14 @@ int main(int argc, char** argv) {
               make_plink2_flags |= kfMakePgenEraseDosage;
             } else if (strequal_k(cur_modif, "fill-missing-from-dosage", cur_modif_slen)) {
               make_plink2_flags |= kfMakePgenFillMissingFromDosage;
+            } else if (strequal_k(cur_modif, "pgi", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenIndex;
+            } else if (strequal_k(cur_modif, "vsum", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenVsum;
+            } else if (strequal_k(cur_modif, "ld-search", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenLdSearch;
+            } else if (strequal_k(cur_modif, "pzs", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenZs;
             } else {
               snprintf(g_logbuf, kLogbufSize, "Error: Invalid --make-bpgen argument '%s'.\n", cur_modif);
               goto main_ret_INVALID_CMDLINE_WWA;
@@ -6640,6 +6921,10 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-bpgen 'trim-alts' and 'erase-alt2+' modifiers cannot be used\ntogether.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (unlikely((make_plink2_flags & kfMakePgenZs) && (make_plink2_flags & (kfMakePgenFormatBase * 3)))) {
+            logerrputs("Error: --make-bpgen 'pzs' modifier cannot be used with format=.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (varid_semicolon) {
             if (unlikely((make_plink2_flags & kfMakePlink2VaridDup) || (varid_semicolon & (varid_semicolon - 1)))) {
               logerrputs("Error: --make-bpgen 'varid-split', 'varid-split-dup', 'varid-dup', and\n'varid-join' modifiers are mutually exclusive.\n");
@@ -6682,7 +6967,7 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-pgen cannot be used with --keep-autoconv.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 9))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 14))) {
             goto main_ret_INVALID_CMDLINE_A;
           }
           uint32_t explicit_pvar_cols = 0;
@@ -6693,6 +6978,8 @@ int main(int argc, char** argv) {
             const uint32_t cur_modif_slen = strlen(cur_modif);
             if (strequal_k(cur_modif, "vzs", cur_modif_slen)) {
               pc.pvar_psam_flags |= kfPvarZs;
+            } else if (strequal_k(cur_modif, "vbgz", cur_modif_slen)) {
+              pc.pvar_psam_flags |= kfPvarBgz;
             } else if (StrStartsWith0(cur_modif, "pvar-cols=", cur_modif_slen)) {
               if (unlikely(explicit_pvar_cols)) {
                 logerrputs("Error: Multiple --make-pgen pvar-cols= modifiers.\n");
@@ -6764,6 +7051,14 @@ int main(int argc, char** argv) {
               make_plink2_flags |= kfMakePgenEraseDosage;
             } else if (strequal_k(cur_modif, "fill-missing-from-dosage", cur_modif_slen)) {
               make_plink2_flags |= kfMakePgenFillMissingFromDosage;
+            } else if (strequal_k(cur_modif, "pgi", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenIndex;
+            } else if (strequal_k(cur_modif, "vsum", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenVsum;
+            } else if (strequal_k(cur_modif, "ld-search", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenLdSearch;
+            } else if (strequal_k(cur_modif, "pzs", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenZs;
             } else if (likely(StrStartsWith0(cur_modif, "psam-cols=", cur_modif_slen))) {
               if (unlikely(explicit_psam_cols)) {
                 logerrputs("Error: Multiple --make-pgen psam-cols= modifiers.\n");
@@ -6783,6 +7078,10 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-pgen 'trim-alts' and 'erase-alt2+' modifiers cannot be used\ntogether.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (unlikely((make_plink2_flags & kfMakePgenZs) && (make_plink2_flags & (kfMakePgenFormatBase * 3)))) {
+            logerrputs("Error: --make-pgen 'pzs' modifier cannot be used with format=.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (varid_semicolon) {
             if (unlikely((make_plink2_flags & kfMakePlink2VaridDup) || (varid_semicolon & (varid_semicolon - 1)))) {
               logerrputs("Error: --make-pgen 'varid-split', 'varid-split-dup', 'varid-dup', and\n'varid-join' modifiers are mutually exclusive.\n");
@@ -6813,6 +7112,17 @@ int main(int argc, char** argv) {
           make_plink2_flags |= kfMakePgen | kfMakePvar | kfMakePsam;
           pc.command_flags1 |= kfCommand1MakePlink2;
           pc.dependency_flags |= kfFilterAllReq;
+        } else if (strequal_k_unsafe(flagname_p2, "ake-pgi")) {
+          pc.command_flags1 |= kfCommand1MakePgi;
+          goto main_param_zero;
+        } else if (strequal_k_unsafe(flagname_p2, "ake-pvar-cache")) {
+#ifdef NO_MMAP
+          logerrputs("Error: --make-pvar-cache is not supported on this platform.\n");
+          goto main_ret_INVALID_CMDLINE_A;
+#else
+          pc.command_flags1 |= kfCommand1MakePvarCache;
+          goto main_param_zero;
+#endif
         } else if (strequal_k_unsafe(flagname_p2, "ake-just-bim")) {
           if (unlikely(make_plink2_flags & (kfMakeBed | kfMakePgen))) {
             logerrputs("Error: --make-just-... cannot be used with --make-bed/--make-[b]pgen.\n");
@@ -6847,7 +7157,7 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-just-... cannot be used with --make-bed/--make-[b]pgen.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 2))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 3))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t explicit_cols = 0;
@@ -6856,6 +7166,8 @@ int main(int argc, char** argv) {
             const uint32_t cur_modif_slen = strlen(cur_modif);
             if (strequal_k(cur_modif, "zs", cur_modif_slen)) {
               pc.pvar_psam_flags |= kfPvarZs;
+            } else if (strequal_k(cur_modif, "bgz", cur_modif_slen)) {
+              pc.pvar_psam_flags |= kfPvarBgz;
             } else if (likely(StrStartsWith0(cur_modif, "cols=", cur_modif_slen))) {
               if (unlikely(explicit_cols)) {
                 logerrputs("Error: Multiple --make-just-pvar cols= modifiers.\n");
@@ -8049,6 +8361,9 @@ int main(int argc, char** argv) {
           mkl_native = 1;
 #endif
           goto main_param_zero;
+        } else if (strequal_k_unsafe(flagname_p2, "o-text-mmap")) {
+          g_text_mmap_disabled = 1;
+          goto main_param_zero;
         } else if (likely(strequal_k_unsafe(flagname_p2, "o-id-header"))) {
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 1))) {
             goto main_ret_INVALID_CMDLINE_2A;
@@ -8147,6 +8462,9 @@ int main(int argc, char** argv) {
           // quasi-bugfix (2 Jan 2021): make this apply to .fam files
           memcpy(g_legacy_output_missing_pheno, cur_modif, cur_modif_slen + 1);
           memcpy(g_output_missing_pheno, cur_modif, cur_modif_slen + 1);
+        } else if (strequal_k_unsafe(flagname_p2, "utput-roundtrip")) {
+          output_roundtrip = 1;
+          goto main_param_zero;
         } else if (unlikely(!strequal_k_unsafe(flagname_p2, "ut"))) {
           // --out is a special case due to logging
           goto main_ret_INVALID_CMDLINE_UNRECOGNIZED;
@@ -8227,6 +8545,24 @@ int main(int argc, char** argv) {
             goto main_ret_OPEN_FAIL;
           }
           memcpy(pvarname, fname, slen + 1);
+        } else if (strequal_k_unsafe(flagname_p2, "var-cache")) {
+#ifdef NO_MMAP
+          logerrputs("Error: --pvar-cache is not supported on this platform.\n");
+          goto main_ret_INVALID_CMDLINE_A;
+#else
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          if (param_ct) {
+            const char* cur_modif = argvk[arg_idx + 1];
+            if (unlikely(strcmp(cur_modif, "verify"))) {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pvar-cache argument '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+            pc.misc_flags |= kfMiscPvarCacheVerify;
+          }
+          pc.misc_flags |= kfMiscPvarCache;
+#endif
         } else if (strequal_k_unsafe(flagname_p2, "heno")) {
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 2))) {
             goto main_ret_INVALID_CMDLINE_2A;
@@ -8305,6 +8641,16 @@ int main(int argc, char** argv) {
           if (unlikely(reterr)) {
             goto main_ret_1;
           }
+        } else if (strequal_k_unsafe(flagname_p2, "erf-log")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          reterr = AllocFname(argvk[arg_idx + 1], flagname_p, 0, &perf_log_fname);
+          if (unlikely(reterr)) {
+            goto main_ret_1;
+          }
+          g_thread_perf = 1;
+          perf_log_start_ns = MonotonicNs();
         } else if (strequal_k_unsafe(flagname_p2, "filter")) {
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
             goto main_ret_INVALID_CMDLINE_2A;
@@ -8454,6 +8800,19 @@ int main(int argc, char** argv) {
           pc.command_flags1 |= kfCommand1PgenInfo;
           pc.dependency_flags |= kfFilterAllReq;
           goto main_param_zero;
+        } else if (strequal_k_unsafe(flagname_p2, "gen-io-threads")) {
+#ifdef NO_PGEN_IO_POOL
+          logerrputs("Error: --pgen-io-threads is not supported on this platform.\n");
+          goto main_ret_INVALID_CMDLINE_A;
+#else
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          if (unlikely(ScanPosintCappedx(argvk[arg_idx + 1], kMaxThreads, &pc.pgen_io_thread_ct))) {
+            snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pgen-io-threads argument '%s'.\n", argvk[arg_idx + 1]);
+            goto main_ret_INVALID_CMDLINE_WWA;
+          }
+#endif
         } else if (strequal_k_unsafe(flagname_p2, "merge")) {
           if (unlikely(import_flags & kfImportKeepAutoconv)) {
             logerrputs("Error: --pmerge cannot be used with --keep-autoconv.\n");
@@ -9069,6 +9428,21 @@ int main(int argc, char** argv) {
               goto main_ret_INVALID_CMDLINE_WWA;
             }
           }
+        } else if (strequal_k_unsafe(flagname_p2, "pill-dir")) {
+#ifdef _WIN32
+          logerrputs("Error: --spill-dir is not supported on Windows.\n");
+          goto main_ret_INVALID_CMDLINE_A;
+#else
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          // room for "/plink2-spill-XXXXXX"
+          reterr = AllocFname(argvk[arg_idx + 1], flagname_p, 20, &spill_dirname);
+          if (unlikely(reterr)) {
+            goto main_ret_1;
+          }
+          g_spill_dirname = spill_dirname;
+#endif
         } else if (strequal_k_unsafe(flagname_p2, "plit-par")) {
           if (unlikely(pc.misc_flags & (kfMiscMergePar | kfMiscMergeX))) {
             logerrputs("Error: --split-par cannot be used with --merge-par/--merge-x.\n");
@@ -10337,7 +10711,7 @@ int main(int argc, char** argv) {
         break;
 
       case 'z':
-        if (likely(strequal_k_unsafe(flagname_p2, "st-level"))) {
+        if (strequal_k_unsafe(flagname_p2, "st-level")) {
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
@@ -10351,6 +10725,25 @@ int main(int argc, char** argv) {
             snprintf(g_logbuf, kLogbufSize, "Error: Invalid --zst-level argument '%s'.\n", cur_modif);
             goto main_ret_INVALID_CMDLINE_WWA;
           }
+        } else if (strequal_k_unsafe(flagname_p2, "st-pipeline")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 2))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          g_zst_pipe_thread_ct = 2;
+          if (param_ct) {
+            const char* cur_modif = argvk[arg_idx + 1];
+            if (unlikely(ScanPosintCappedx(cur_modif, kMaxThreads, &g_zst_pipe_thread_ct))) {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --zst-pipeline thread count '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+            if (param_ct == 2) {
+              cur_modif = argvk[arg_idx + 2];
+              if (unlikely(ScanPosintCappedx(cur_modif, 22, &g_zst_pipe_level))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --zst-pipeline compression level '%s'.\n", cur_modif);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+            }
+          }
         } else {
           goto main_ret_INVALID_CMDLINE_UNRECOGNIZED;
         }
@@ -10369,6 +10762,15 @@ int main(int argc, char** argv) {
       outname_end = &(outname[6]);
     }
 
+    if (output_roundtrip) {
+      pc.freq_rpt_flags |= kfAlleleFreqRoundtrip;
+      pc.king_flags |= kfKingRoundtrip;
+      pc.glm_info.flags |= kfGlmRoundtrip;
+    }
+    if (unlikely((pc.pvar_psam_flags & (kfPvarZs | kfPvarBgz)) == (kfPvarZs | kfPvarBgz))) {
+      logerrputs("Error: .pvar output cannot be both zstd- and BGZF-compressed.\n");
+      goto main_ret_INVALID_CMDLINE_A;
+    }
     pc.dependency_flags |= pc.filter_flags;
     const uint32_t skip_main = (!pc.command_flags1) && (!(xload & (kfXloadVcf | kfXloadBcf | kfXloadOxBgen | kfXloadOxHaps | kfXloadOxSample | kfXloadPlink1Dosage | kfXloadGenDummy)));
     const uint32_t batch_job = (adjust_file_info.fname != nullptr);
@@ -10460,6 +10862,10 @@ int main(int argc, char** argv) {
       logerrputs("Error: --chr-override requires an explicit chromosome set.\n");
       goto main_ret_INVALID_CMDLINE_A;
     }
+    if (unlikely((pc.misc_flags & kfMiscPvarCache) && xload)) {
+      logerrputs("Error: --pvar-cache requires an existing .pvar/.bim file.\n");
+      goto main_ret_INVALID_CMDLINE_A;
+    }
     if (unlikely((xload & kfXloadPlink1Dosage) && (!(load_params & kfLoadParamsPsam)))) {
       logerrputs("Error: --import-dosage requires a .fam file.\n");
       goto main_ret_INVALID_CMDLINE_A;
@@ -10538,7 +10944,7 @@ int main(int argc, char** argv) {
       rseeds = nullptr;
     }
 
-    if (unlikely(CmdlineParsePhase3(0, malloc_size_mib, memory_require, &pcm, &bigstack_ua))) {
+    if (unlikely(CmdlineParsePhase3(0, malloc_size_mib, memory_require, bigstack_flags, &pcm, &bigstack_ua))) {
       goto main_ret_NOMEM;
     }
     g_input_missing_geno_ptr = &(g_one_char_strs[2 * ctou32(input_missing_geno_char)]);
@@ -10584,6 +10990,22 @@ int main(int argc, char** argv) {
         goto main_ret_INVALID_CMDLINE;
       }
       reterr = PgenInfoStandalone(pgenname);
+    } else if (pc.command_flags1 & kfCommand1MakePgi) {
+      // also doesn't require .psam/.pvar
+      if (unlikely((pc.command_flags1 != kfCommand1MakePgi) || xload || (!(load_params & kfLoadParamsPgen)))) {
+        logerrputs("Error: --make-pgi must be run by itself on an existing .pgen file.\n");
+        goto main_ret_INVALID_CMDLINE_A;
+      }
+      reterr = WritePgenIndex("--make-pgi", pgenname);
+#ifndef NO_MMAP
+    } else if (pc.command_flags1 & kfCommand1MakePvarCache) {
+      // doesn't require .pgen/.psam
+      if (unlikely((pc.command_flags1 != kfCommand1MakePvarCache) || xload || pc.dependency_flags || (!(load_params & kfLoadParamsPvar)))) {
+        logerrputs("Error: --make-pvar-cache must be run by itself on an existing .pvar/.bim file.\n");
+        goto main_ret_INVALID_CMDLINE_A;
+      }
+      reterr = MakePvarCache(pvarname, pc.misc_flags, pc.max_thread_ct, &chr_info);
+#endif
     } else {
       if (unlikely(pc.dependency_flags && (!(pc.command_flags1 & (~kfCommand1Pmerge))))) {
         logerrputs("Error: Basic file conversions do not support regular filter or transform\noperations.  Rerun your command with --make-bed/--make-[b]pgen.\n");
@@ -10638,7 +11060,7 @@ int main(int argc, char** argv) {
             g_zst_level = 1;
           }
           if (is_vcf) {
-            reterr = VcfToPgen(pgenname, (load_params & kfLoadParamsPsam)? psamname : nullptr, const_fid, vcf_dosage_import_field, pc.misc_flags, import_flags, no_samples_ok, pc.hard_call_thresh, pc.dosage_erase_thresh, import_dosage_certainty, id_delim, idspace_to, vcf_min_gq, vcf_min_dp, vcf_max_dp, vcf_half_call, pc.fam_cols, pc.max_thread_ct, outname, convname_end, &chr_info, &pgen_generated, &psam_generated);
+            reterr = VcfToPgen(pgenname, (load_params & kfLoadParamsPsam)? psamname : nullptr, const_fid, vcf_dosage_import_field, pc.misc_flags, import_flags, no_samples_ok, pc.hard_call_thresh, pc.dosage_erase_thresh, import_dosage_certainty, id_delim, idspace_to, vcf_min_gq, vcf_min_dp, vcf_max_dp, vcf_half_call, pc.fam_cols, pc.from_bp, pc.to_bp, pc.max_thread_ct, outname, convname_end, &chr_info, &pgen_generated, &psam_generated);
           } else {
             reterr = BcfToPgen(pgenname, (load_params & kfLoadParamsPsam)? psamname : nullptr, const_fid, vcf_dosage_import_field, pc.misc_flags, import_flags, no_samples_ok, pc.hard_call_thresh, pc.dosage_erase_thresh, import_dosage_certainty, id_delim, idspace_to, vcf_min_gq, vcf_min_dp, vcf_max_dp, vcf_half_call, pc.fam_cols, pc.max_thread_ct, outname, convname_end, &chr_info, &pgen_generated, &psam_generated);
           }
@@ -10796,6 +11218,15 @@ int main(int argc, char** argv) {
     break;
   }
  main_ret_1:
+  LogCstreamNotes();
+  LogBigstackPeak();
+  if (perf_log_fname) {
+    // Still worth writing after most errors.
+    const PglErr perf_log_reterr = WriteThreadPerfLog(perf_log_fname, perf_log_start_ns);
+    if (!reterr) {
+      reterr = perf_log_reterr;
+    }
+  }
   if (reterr == kPglRetNomemCustomMsg) {
     if (g_failed_alloc_attempt_size) {
       logerrprintf("Failed allocation size: %" PRIuPTR "\n", g_failed_alloc_attempt_size);
@@ -10816,6 +11247,9 @@ int main(int argc, char** argv) {
     break;
   }
  main_ret_NOLOG:
+  CleanupThreadPerfPhases();
+  free_cond(perf_log_fname);
+  free_cond(spill_dirname);
   free_cond(vcf_dosage_import_field);
   free_cond(ox_missing_code);
   free_cond(import_single_chr_str);
@@ -10916,8 +11350,12 @@ int main(int argc, char** argv) {
   if (CleanupLogfile(print_end_time) && (!reterr)) {
     reterr = kPglRetWriteFail;
   }
+  CleanupSpills();
+#ifndef NO_MMAP
+  CleanupPvarCache();
+#endif
   if (bigstack_ua) {
-    free(bigstack_ua);
+    CleanupBigstack(bigstack_ua);
   }
   return S_CAST(int32_t, reterr);
 }
@@ -28,6 +28,13 @@
 #include <time.h>  // time(), ctime()
 #include <unistd.h>  // getcwd(), gethostname(), sysconf(), fstat()
 
+#ifndef _WIN32
+#  include <sys/mman.h>  // mmap(), madvise()
+#endif
+#ifdef __linux__
+#  include <sys/syscall.h>  // SYS_mbind
+#endif
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -546,6 +553,139 @@ BoolErr CleanupLogfile(uint32_t print_end_time) {
 unsigned char* g_bigstack_base = nullptr;
 unsigned char* g_bigstack_end = nullptr;
 
+unsigned char* g_bigstack_initial_base = nullptr;
+unsigned char* g_bigstack_initial_end = nullptr;
+uintptr_t g_bigstack_end_cap_blen = 0;
+
+static uintptr_t g_bigstack_phase_peak = 0;
+static uintptr_t g_bigstack_phase_elastic_peak = 0;
+static uintptr_t g_bigstack_prev_phases_peak = 0;
+static uintptr_t g_bigstack_prev_phases_elastic_peak = 0;
+
+// Live elastic buffers.  A buffer is forgotten as soon as it's no longer inside
+// the in-use part of the workspace, so nothing needs to be called when it's
+// freed.  Rarely more than two are live at once; any beyond the limit are just
+// counted as fixed usage.
+CONSTI32(kBigstackElasticSlotCt, 4);
+static unsigned char* g_bigstack_elastic_bufs[kBigstackElasticSlotCt];
+static uintptr_t g_bigstack_elastic_blens[kBigstackElasticSlotCt];
+static uint32_t g_bigstack_elastic_ct = 0;
+
+void BigstackNoteUsage(uintptr_t fixed_byte_ct, uintptr_t elastic_byte_ct) {
+  if (fixed_byte_ct > g_bigstack_phase_peak) {
+    g_bigstack_phase_peak = fixed_byte_ct;
+  }
+  if (elastic_byte_ct > g_bigstack_phase_elastic_peak) {
+    g_bigstack_phase_elastic_peak = elastic_byte_ct;
+  }
+}
+
+static uintptr_t OverlapBlen(const unsigned char* start, const unsigned char* end, const unsigned char* range_start, const unsigned char* range_end) {
+  if (start < range_start) {
+    start = range_start;
+  }
+  if (end > range_end) {
+    end = range_end;
+  }
+  return (end > start)? S_CAST(uintptr_t, end - start) : 0;
+}
+
+void BigstackNoteExtent(const void* base_in_use, const void* end_in_use) {
+  if (!g_bigstack_initial_base) {
+    return;
+  }
+  const unsigned char* base = S_CAST(const unsigned char*, base_in_use);
+  const unsigned char* end = S_CAST(const unsigned char*, end_in_use);
+  const uintptr_t usage = BigstackExtentUsage(base, end);
+  uintptr_t elastic_usage = 0;
+  for (uint32_t slot_idx = 0; slot_idx != g_bigstack_elastic_ct; ) {
+    const unsigned char* buf_start = g_bigstack_elastic_bufs[slot_idx];
+    const unsigned char* buf_end = &(buf_start[g_bigstack_elastic_blens[slot_idx]]);
+    const uintptr_t cur_overlap = OverlapBlen(buf_start, buf_end, g_bigstack_initial_base, base) + OverlapBlen(buf_start, buf_end, end, g_bigstack_initial_end);
+    if (!cur_overlap) {
+      --g_bigstack_elastic_ct;
+      g_bigstack_elastic_bufs[slot_idx] = g_bigstack_elastic_bufs[g_bigstack_elastic_ct];
+      g_bigstack_elastic_blens[slot_idx] = g_bigstack_elastic_blens[g_bigstack_elastic_ct];
+      continue;
+    }
+    elastic_usage += cur_overlap;
+    ++slot_idx;
+  }
+  BigstackNoteUsage(usage - elastic_usage, elastic_usage);
+}
+
+static void RegisterElasticBuf(unsigned char* buf, uintptr_t blen) {
+  if (g_bigstack_elastic_ct != kBigstackElasticSlotCt) {
+    g_bigstack_elastic_bufs[g_bigstack_elastic_ct] = buf;
+    g_bigstack_elastic_blens[g_bigstack_elastic_ct] = blen;
+    ++g_bigstack_elastic_ct;
+  }
+}
+
+// Registered before the pointer moves, so that the allocation itself is never
+// counted as fixed usage.
+void* BigstackAllocElastic(uintptr_t size) {
+  size = RoundUpPow2(size, kCacheline);
+  unsigned char* alloc_ptr = g_bigstack_base;
+  RegisterElasticBuf(alloc_ptr, size);
+  return bigstack_alloc_raw(size);
+}
+
+void* BigstackEndAllocElastic(uintptr_t size) {
+  size = RoundUpPow2(size, kEndAllocAlign);
+  RegisterElasticBuf(&(g_bigstack_end[-S_CAST(intptr_t, size)]), size);
+  return bigstack_end_alloc_raw(size);
+}
+
+// Round up, so that a nonzero usage never shows up as 0 MiB.
+static void LogBigstackMarks(const char* label, uintptr_t fixed_peak, uintptr_t elastic_peak, uintptr_t total_blen) {
+  char* write_iter = strcpya_k(g_logbuf, "Workspace high-water mark (");
+  write_iter = strcpya(write_iter, label);
+  write_iter = strcpya_k(write_iter, "): ");
+  write_iter = wtoa(DivUp(fixed_peak, 1048576), write_iter);
+  write_iter = strcpya_k(write_iter, " MiB");
+  if (total_blen) {
+    write_iter = strcpya_k(write_iter, " of ");
+    write_iter = wtoa(total_blen / 1048576, write_iter);
+    write_iter = strcpya_k(write_iter, " MiB");
+  }
+  if (elastic_peak) {
+    write_iter = strcpya_k(write_iter, ", plus ");
+    write_iter = wtoa(DivUp(elastic_peak, 1048576), write_iter);
+    write_iter = strcpya_k(write_iter, " MiB of buffers sized to the available workspace");
+  }
+  strcpy_k(write_iter, ".\n");
+  logputs_silent(g_logbuf);
+}
+
+void BigstackPhaseEnd(const char* phase_name) {
+  BigstackNotePeak();
+  if (g_bigstack_phase_peak > g_bigstack_prev_phases_peak) {
+    g_bigstack_prev_phases_peak = g_bigstack_phase_peak;
+  }
+  if (g_bigstack_phase_elastic_peak > g_bigstack_prev_phases_elastic_peak) {
+    g_bigstack_prev_phases_elastic_peak = g_bigstack_phase_elastic_peak;
+  }
+  LogBigstackMarks(phase_name, g_bigstack_phase_peak, g_bigstack_phase_elastic_peak, 0);
+  g_bigstack_phase_peak = 0;
+  g_bigstack_phase_elastic_peak = 0;
+  BigstackNotePeak();
+}
+
+uintptr_t BigstackPeak() {
+  BigstackNotePeak();
+  return MAXV(g_bigstack_phase_peak, g_bigstack_prev_phases_peak);
+}
+
+void LogBigstackPeak() {
+  if (!g_bigstack_initial_base) {
+    return;
+  }
+  const uintptr_t fixed_peak = BigstackPeak();
+  const uintptr_t elastic_peak = MAXV(g_bigstack_phase_elastic_peak, g_bigstack_prev_phases_elastic_peak);
+  LogBigstackMarks("overall", fixed_peak, elastic_peak, g_bigstack_initial_end - g_bigstack_initial_base);
+}
+
 uintptr_t DetectMib() {
   int64_t llxx;
   // return zero if detection failed
@@ -582,7 +722,127 @@ uintptr_t GetDefaultAllocMib() {
   return (total_mib / 2);
 }
 
-PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr) {
+#ifdef __linux__
+// Size of the bigstack mapping when it was allocated with mmap() instead of
+// malloc(), zero otherwise.
+static uintptr_t g_bigstack_mmap_size = 0;
+
+CONSTI32(kBigstackHugepageBytes, 2 * 1048576);
+
+CONSTI32(kMaxNumaNodes, 1024);
+
+// Best-effort MPOL_INTERLEAVE across all online NUMA nodes; must be called
+// before any page in the range is touched.  Returns the number of nodes the
+// range was interleaved across (0 if mbind() failed or there's only one).
+static uint32_t InterleaveNuma(void* addr, uintptr_t len) {
+  FILE* infile = fopen("/sys/devices/system/node/online", FOPEN_RB);
+  if (!infile) {
+    return 0;
+  }
+  char buf[256];
+  const char* read_iter = fgets(buf, 256, infile);
+  fclose(infile);
+  if (!read_iter) {
+    return 0;
+  }
+  // Extra word in case the kernel's off-by-one maxnode handling reads one
+  // more bit than requested.
+  uintptr_t nodemask[kMaxNumaNodes / kBitsPerWord + 1];
+  ZeroWArr(kMaxNumaNodes / kBitsPerWord + 1, nodemask);
+  uint32_t node_ct = 0;
+  // Comma-separated ranges, e.g. "0-3,6".
+  while (1) {
+    char* parse_end;
+    const uint32_t range_start = strtoul(read_iter, &parse_end, 10);
+    if ((parse_end == read_iter) || (range_start >= kMaxNumaNodes)) {
+      break;
+    }
+    uint32_t range_end = range_start;
+    read_iter = parse_end;
+    if (*read_iter == '-') {
+      ++read_iter;
+      range_end = strtoul(read_iter, &parse_end, 10);
+      read_iter = parse_end;
+      if (range_end >= kMaxNumaNodes) {
+        range_end = kMaxNumaNodes - 1;
+      }
+    }
+    for (uint32_t node_idx = range_start; node_idx <= range_end; ++node_idx) {
+      SetBit(node_idx, nodemask);
+      ++node_ct;
+    }
+    if (*read_iter != ',') {
+      break;
+    }
+    ++read_iter;
+  }
+  if (node_ct < 2) {
+    return 0;
+  }
+  // 3 = MPOL_INTERLEAVE in <linux/mempolicy.h>; calling the syscall directly
+  // avoids a libnuma dependency.
+  if (syscall(SYS_mbind, addr, len, 3, nodemask, S_CAST(uintptr_t, kMaxNumaNodes), 0)) {
+    return 0;
+  }
+  return node_ct;
+}
+
+// Returns nullptr on failure.  On MAP_HUGETLB failure, this switches *flags_ptr
+// over to transparent huge pages and retries.
+static unsigned char* MmapBigstack(uintptr_t byte_ct, BigstackFlags* flags_ptr) {
+  byte_ct = RoundUpPow2(byte_ct, kBigstackHugepageBytes);
+  if ((*flags_ptr) & kfBigstackHugetlb) {
+    void* mapped = mmap(nullptr, byte_ct, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapped != MAP_FAILED) {
+      g_bigstack_mmap_size = byte_ct;
+      return S_CAST(unsigned char*, mapped);
+    }
+    logerrprintfww("Warning: Failed to map %" PRIuPTR " MiB of explicit huge pages for the main workspace (is /proc/sys/vm/nr_hugepages large enough?); falling back to transparent huge pages.\n", byte_ct / 1048576);
+    *flags_ptr = (*flags_ptr & (~kfBigstackHugetlb)) | kfBigstackThp;
+  }
+  // Over-map by one huge page, and trim the ends so that the arena is
+  // huge-page-aligned.
+  const uintptr_t padded_byte_ct = byte_ct + kBigstackHugepageBytes;
+  void* mapped = mmap(nullptr, padded_byte_ct, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  unsigned char* raw_start = S_CAST(unsigned char*, mapped);
+  unsigned char* aligned_start = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, raw_start), kBigstackHugepageBytes));
+  const uintptr_t head_byte_ct = aligned_start - raw_start;
+  if (head_byte_ct) {
+    munmap(raw_start, head_byte_ct);
+  }
+  const uintptr_t tail_byte_ct = kBigstackHugepageBytes - head_byte_ct;
+  if (tail_byte_ct) {
+    munmap(&(aligned_start[byte_ct]), tail_byte_ct);
+  }
+  g_bigstack_mmap_size = byte_ct;
+  return aligned_start;
+}
+#endif
+
+static unsigned char* AllocBigstackRaw(uintptr_t byte_ct, __maybe_unused BigstackFlags* flags_ptr) {
+#ifdef __linux__
+  if (*flags_ptr) {
+    return MmapBigstack(byte_ct, flags_ptr);
+  }
+#endif
+  return S_CAST(unsigned char*, malloc(byte_ct));
+}
+
+void CleanupBigstack(unsigned char* bigstack_ua) {
+#ifdef __linux__
+  if (g_bigstack_mmap_size) {
+    munmap(bigstack_ua, g_bigstack_mmap_size);
+    g_bigstack_mmap_size = 0;
+    return;
+  }
+#endif
+  free(bigstack_ua);
+}
+
+PglErr InitBigstack(uintptr_t malloc_size_mib, BigstackFlags flags, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr) {
   // guarantee contiguous malloc space outside of main workspace
   unsigned char* bubble;
 
@@ -598,14 +858,14 @@ PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr,
 #endif
   // don't use pgl_malloc here since we don't automatically want to set
   // g_failed_alloc_attempt_size on failure
-  unsigned char* bigstack_ua = S_CAST(unsigned char*, malloc(malloc_size_mib * 1048576 * sizeof(char)));
+  unsigned char* bigstack_ua = AllocBigstackRaw(malloc_size_mib * 1048576 * sizeof(char), &flags);
   // this is thwarted by overcommit, but still better than nothing...
   while (!bigstack_ua) {
     malloc_size_mib = (malloc_size_mib * 3) / 4;
     if (malloc_size_mib < kBigstackMinMib) {
       malloc_size_mib = kBigstackMinMib;
     }
-    bigstack_ua = S_CAST(unsigned char*, malloc(malloc_size_mib * 1048576 * sizeof(char)));
+    bigstack_ua = AllocBigstackRaw(malloc_size_mib * 1048576 * sizeof(char), &flags);
     if (unlikely((!bigstack_ua) && (malloc_size_mib == kBigstackMinMib))) {
       // switch to "goto cleanup" pattern if any more exit points are needed
       g_failed_alloc_attempt_size = kBigstackMinMib * 1048576;
@@ -613,11 +873,45 @@ PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr,
       return kPglRetNomem;
     }
   }
+#ifdef __linux__
+  if (flags) {
+    // Both of these must happen before the first page is touched.
+    if ((flags & kfBigstackThp) && unlikely(madvise(bigstack_ua, g_bigstack_mmap_size, MADV_HUGEPAGE))) {
+      logerrputs("Warning: madvise(MADV_HUGEPAGE) failed on the main workspace (transparent huge\npages may be disabled in this kernel).\n");
+      flags &= ~kfBigstackThp;
+    }
+    uint32_t numa_node_ct = 0;
+    if (flags & kfBigstackNumaInterleave) {
+      numa_node_ct = InterleaveNuma(bigstack_ua, g_bigstack_mmap_size);
+    }
+    char* write_iter = strcpya_k(g_logbuf, "Main workspace backing: ");
+    if (flags & kfBigstackHugetlb) {
+      write_iter = strcpya_k(write_iter, "explicit huge pages");
+    } else if (flags & kfBigstackThp) {
+      write_iter = strcpya_k(write_iter, "transparent huge pages");
+    } else {
+      write_iter = strcpya_k(write_iter, "standard pages");
+    }
+    if (flags & kfBigstackNumaInterleave) {
+      if (numa_node_ct) {
+        write_iter = strcpya_k(write_iter, ", interleaved across ");
+        write_iter = u32toa(numa_node_ct, write_iter);
+        write_iter = strcpya_k(write_iter, " NUMA nodes");
+      } else {
+        write_iter = strcpya_k(write_iter, " (NUMA interleaving unavailable)");
+      }
+    }
+    strcpy_k(write_iter, ".\n");
+    logputsb();
+  }
+#endif
   // force 64-byte align to make cache line sensitivity work
   unsigned char* bigstack_initial_base = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, bigstack_ua), kCacheline));
   g_bigstack_base = bigstack_initial_base;
   // last 576 bytes now reserved for g_one_char_strs + overread buffer
   g_bigstack_end = &(bigstack_initial_base[RoundDownPow2(malloc_size_mib * 1048576 - 576 - S_CAST(uintptr_t, bigstack_initial_base - bigstack_ua), kCacheline)]);
+  g_bigstack_initial_base = g_bigstack_base;
+  g_bigstack_initial_end = g_bigstack_end;
   free(bubble);
   uintptr_t* one_char_iter = R_CAST(uintptr_t*, g_bigstack_end);
 #ifdef __LP64__
@@ -755,6 +1049,126 @@ BoolErr bigstack_calloc_cpp(uintptr_t ct, char**** cpp_arr_ptr) {
   return 0;
 }
 
+const char* g_spill_dirname = nullptr;
+
+#ifndef _WIN32
+typedef struct SpillBlockStruct {
+  struct SpillBlockStruct* next;
+  void* addr;
+  uintptr_t byte_ct;
+} SpillBlock;
+
+static SpillBlock* g_spill_blocks = nullptr;
+#endif
+
+BoolErr SpillAlloc(__maybe_unused uintptr_t size, __maybe_unused uint32_t is_sequential, __maybe_unused const char* purpose, __maybe_unused void* alloc_ptr) {
+#ifdef _WIN32
+  return 1;
+#else
+  if (!g_spill_dirname) {
+    return 1;
+  }
+  const uintptr_t byte_ct = RoundUpPow2(MAXV(size, 1), kCacheline);
+  // --spill-dir parser guarantees this fits
+  char fname[kPglFnamesize];
+  snprintf(fname, kPglFnamesize, "%s/plink2-spill-XXXXXX", g_spill_dirname);
+  SpillBlock* new_block;
+  if (unlikely(pgl_malloc(sizeof(SpillBlock), &new_block))) {
+    return 1;
+  }
+  const int32_t fd = mkstemp(fname);
+  if (unlikely(fd == -1)) {
+    logerrprintfww("Warning: Failed to create spill file in %s: %s.\n", g_spill_dirname, strerror(errno));
+    free(new_block);
+    return 1;
+  }
+  // The mapping keeps the file alive; unlinking now guarantees cleanup even
+  // if we crash.
+  unlink(fname);
+  int32_t err_code = 0;
+  if (ftruncate(fd, byte_ct)) {
+    err_code = errno;
+  }
+#  ifdef __linux__
+  // Reserve the blocks up front, so that a full disk is reported here instead
+  // of raising SIGBUS in the middle of the computation.
+  if (!err_code) {
+    err_code = posix_fallocate(fd, 0, byte_ct);
+  }
+#  endif
+  void* mapped = MAP_FAILED;
+  if (!err_code) {
+    mapped = mmap(nullptr, byte_ct, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+      err_code = errno;
+    }
+  }
+  close(fd);
+  if (unlikely(mapped == MAP_FAILED)) {
+    logerrprintfww("Warning: Failed to allocate %" PRIuPTR " MiB of spill space in %s: %s.\n", DivUp(byte_ct, 1048576), g_spill_dirname, strerror(err_code));
+    free(new_block);
+    return 1;
+  }
+  if (is_sequential) {
+    madvise(mapped, byte_ct, MADV_SEQUENTIAL);
+  }
+  new_block->next = g_spill_blocks;
+  new_block->addr = mapped;
+  new_block->byte_ct = byte_ct;
+  g_spill_blocks = new_block;
+  logprintfww("%s: Workspace exhausted; using %" PRIuPTR " MiB of file-backed spill space in %s (expect reduced speed).\n", purpose, DivUp(byte_ct, 1048576), g_spill_dirname);
+  *S_CAST(void**, alloc_ptr) = mapped;
+  return 0;
+#endif
+}
+
+BoolErr BigstackAllocOrSpill(uintptr_t size, uint32_t zero_fill, uint32_t is_sequential, const char* purpose, void* alloc_ptr, uint32_t* is_spilled_ptr) {
+  void* bigstack_ptr = bigstack_alloc(size);
+  if (bigstack_ptr) {
+    if (zero_fill) {
+      memset(bigstack_ptr, 0, size);
+    }
+    *S_CAST(void**, alloc_ptr) = bigstack_ptr;
+    *is_spilled_ptr = 0;
+    return 0;
+  }
+  *is_spilled_ptr = 1;
+  // fresh file-backed mappings are already zero-filled
+  if (SpillAlloc(size, is_sequential, purpose, alloc_ptr)) {
+    return 1;
+  }
+  // Don't report the workspace request that was satisfied by the spill if a
+  // later allocation fails.
+  g_failed_alloc_attempt_size = 0;
+  return 0;
+}
+
+uint32_t SpillFree(__maybe_unused const void* ptr) {
+#ifndef _WIN32
+  for (SpillBlock** block_ptr = &g_spill_blocks; *block_ptr; block_ptr = &((*block_ptr)->next)) {
+    SpillBlock* cur_block = *block_ptr;
+    if (cur_block->addr == ptr) {
+      munmap(cur_block->addr, cur_block->byte_ct);
+      *block_ptr = cur_block->next;
+      free(cur_block);
+      return 1;
+    }
+  }
+#endif
+  return 0;
+}
+
+void CleanupSpills() {
+#ifndef _WIN32
+  while (g_spill_blocks) {
+    SpillBlock* next_block = g_spill_blocks->next;
+    munmap(g_spill_blocks->addr, g_spill_blocks->byte_ct);
+    free(g_spill_blocks);
+    g_spill_blocks = next_block;
+  }
+#endif
+}
+
 BoolErr bigstack_end_calloc_uc(uintptr_t ct, unsigned char** uc_arr_ptr) {
   *uc_arr_ptr = S_CAST(unsigned char*, bigstack_end_alloc(ct));
   if (unlikely(!(*uc_arr_ptr))) {
@@ -2148,7 +2562,11 @@ uintptr_t FindNth1BitFrom(const uintptr_t* bitvec, uintptr_t cur_pos, uintptr_t
 #ifdef USE_AVX2
   while (forward_ct > kBitsPerWord * (16 * kWordsPerVec)) {
     uljj = (forward_ct - 1) / (kBitsPerWord * kWordsPerVec);
+#  ifdef USE_AVX512
+    ulkk = PopcountVecsAvx512(vptr, uljj);
+#  else
     ulkk = PopcountVecsAvx2(vptr, uljj);
+#  endif
     vptr = &(vptr[uljj]);
     forward_ct -= ulkk;
   }
@@ -4046,7 +4464,7 @@ PglErr CmdlineParsePhase2(const char* ver_str, const char* errstr_append, const
   return reterr;
 }
 
-PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, uint32_t memory_require, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr) {
+PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, uint32_t memory_require, BigstackFlags bigstack_flags, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr) {
   PglErr reterr = kPglRetSuccess;
   {
     if (pcmp->subst_argv) {
@@ -4096,7 +4514,7 @@ PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib,
     }
     logputsb();
     uintptr_t malloc_mib_final;
-    if (unlikely(InitBigstack(malloc_size_mib, &malloc_mib_final, bigstack_ua_ptr))) {
+    if (unlikely(InitBigstack(malloc_size_mib, bigstack_flags, &malloc_mib_final, bigstack_ua_ptr))) {
       goto CmdlineParsePhase3_ret_NOMEM;
     }
     if (malloc_size_mib != malloc_mib_final) {
@@ -4559,6 +4977,142 @@ PglErr ParseColDescriptor(const char* col_descriptor_iter, const char* supported
   return reterr;
 }
 
+static int32_t ThreadPerfPhaseCmp(const void* aa, const void* bb) {
+  const uint64_t start_a = (*S_CAST(const ThreadPerfPhase* const*, aa))->start_ns;
+  const uint64_t start_b = (*S_CAST(const ThreadPerfPhase* const*, bb))->start_ns;
+  return (start_a > start_b) - (start_a < start_b);
+}
+
+static char* AppendPerfMs(const char* key, uint64_t ns, char* write_iter) {
+  *write_iter++ = '"';
+  write_iter = strcpya(write_iter, key);
+  write_iter = strcpya_k(write_iter, "\": ");
+  return dtoa_g(u63tod(ns) * 1.0e-6, write_iter);
+}
+
+PglErr WriteThreadPerfLog(const char* outname, uint64_t run_start_ns) {
+  FILE* outfile = nullptr;
+  const ThreadPerfPhase** phases = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uint64_t run_end_ns = MonotonicNs();
+    uint32_t phase_ct = 0;
+    for (const ThreadPerfPhase* phasep = GetThreadPerfPhases(); phasep; phasep = phasep->next) {
+      ++phase_ct;
+    }
+    // Plain malloc, since bigstack may not be available here.
+    if (phase_ct) {
+      phases = S_CAST(const ThreadPerfPhase**, malloc(phase_ct * sizeof(intptr_t)));
+      if (unlikely(!phases)) {
+        goto WriteThreadPerfLog_ret_NOMEM;
+      }
+      const ThreadPerfPhase* phasep = GetThreadPerfPhases();
+      for (uint32_t phase_idx = 0; phase_idx != phase_ct; ++phase_idx, phasep = phasep->next) {
+        phases[phase_idx] = phasep;
+      }
+      qsort(phases, phase_ct, sizeof(intptr_t), ThreadPerfPhaseCmp);
+    }
+    if (unlikely(fopen_checked(outname, FOPEN_WB, &outfile))) {
+      goto WriteThreadPerfLog_ret_OPEN_FAIL;
+    }
+    char* textbuf = g_textbuf;
+    char* textbuf_flush = &(textbuf[kMaxMediumLine]);
+    char* write_iter = strcpya_k(textbuf, "{\n  ");
+    write_iter = AppendPerfMs("wall_ms", run_end_ns - run_start_ns, write_iter);
+    write_iter = strcpya_k(write_iter, ",\n  \"phases\": [");
+    for (uint32_t phase_idx = 0; phase_idx != phase_ct; ++phase_idx) {
+      const ThreadPerfPhase* phasep = phases[phase_idx];
+      const uint32_t thread_ct = phasep->thread_ct;
+      const uint64_t phase_wall_ns = phasep->end_ns - phasep->start_ns;
+      if (phase_idx) {
+        *write_iter++ = ',';
+      }
+      write_iter = strcpya_k(write_iter, "\n    {\"func\": \"");
+      write_iter = strcpya(write_iter, phasep->func_name);
+      write_iter = strcpya_k(write_iter, "\", \"thread_ct\": ");
+      write_iter = u32toa(thread_ct, write_iter);
+      write_iter = strcpya_k(write_iter, ", \"round_ct\": ");
+      write_iter = u32toa(phasep->round_ct, write_iter);
+      write_iter = strcpya_k(write_iter, ", ");
+      write_iter = AppendPerfMs("start_ms", phasep->start_ns - run_start_ns, write_iter);
+      write_iter = strcpya_k(write_iter, ", ");
+      write_iter = AppendPerfMs("wall_ms", phase_wall_ns, write_iter);
+      write_iter = strcpya_k(write_iter, ", ");
+      write_iter = AppendPerfMs("critical_ms", phasep->critical_ns, write_iter);
+      write_iter = strcpya_k(write_iter, ", ");
+      write_iter = AppendPerfMs("critical_cpu_ms", phasep->critical_cpu_ns, write_iter);
+      write_iter = strcpya_k(write_iter, ", ");
+      write_iter = AppendPerfMs("main_read_ms", phasep->read_ns, write_iter);
+      write_iter = strcpya_k(write_iter, ", ");
+      write_iter = AppendPerfMs("main_write_ms", phasep->write_ns, write_iter);
+      write_iter = strcpya_k(write_iter, ", ");
+      write_iter = AppendPerfMs("main_join_wait_ms", phasep->join_wait_ns, write_iter);
+      const uint64_t* thread_ns = phasep->thread_ns;
+      uint64_t busy_ns_sum = 0;
+      for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+        busy_ns_sum += thread_ns[tidx];
+      }
+      // Fraction of the phase's thread-time spent between release and
+      // THREAD_BLOCK_FINISH().
+      double utilization = 0.0;
+      if (phase_wall_ns) {
+        utilization = u63tod(busy_ns_sum) / (u63tod(phase_wall_ns) * u31tod(thread_ct));
+      }
+      write_iter = strcpya_k(write_iter, ", \"utilization\": ");
+      write_iter = dtoa_g(utilization, write_iter);
+      // Same ratio computed from thread CPU time, i.e. the utilization the
+      // phase would reach with a dedicated core per thread.
+      uint64_t cpu_ns_sum = 0;
+      for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+        cpu_ns_sum += thread_ns[2 * thread_ct + tidx];
+      }
+      double cpu_balance = 0.0;
+      if (phasep->critical_cpu_ns) {
+        cpu_balance = u63tod(cpu_ns_sum) / (u63tod(phasep->critical_cpu_ns) * u31tod(thread_ct));
+      }
+      write_iter = strcpya_k(write_iter, ", \"cpu_balance\": ");
+      write_iter = dtoa_g(cpu_balance, write_iter);
+      for (uint32_t array_idx = 0; array_idx != 3; ++array_idx) {
+        if (unlikely(fwrite_ck(textbuf_flush, outfile, &write_iter))) {
+          goto WriteThreadPerfLog_ret_WRITE_FAIL;
+        }
+        write_iter = strcpya(write_iter, (array_idx == 0)? ", \"thread_busy_ms\": [" : ((array_idx == 1)? ", \"thread_wait_ms\": [" : ", \"thread_cpu_ms\": ["));
+        const uint64_t* cur_ns = &(thread_ns[array_idx * thread_ct]);
+        for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+          if (tidx) {
+            write_iter = strcpya_k(write_iter, ", ");
+          }
+          write_iter = dtoa_g(u63tod(cur_ns[tidx]) * 1.0e-6, write_iter);
+          if (unlikely(fwrite_ck(textbuf_flush, outfile, &write_iter))) {
+            goto WriteThreadPerfLog_ret_WRITE_FAIL;
+          }
+        }
+        *write_iter++ = ']';
+      }
+      *write_iter++ = '}';
+    }
+    write_iter = strcpya_k(write_iter, "\n  ]\n}\n");
+    if (unlikely(fclose_flush_null(textbuf_flush, write_iter, &outfile))) {
+      goto WriteThreadPerfLog_ret_WRITE_FAIL;
+    }
+    logprintfww("--perf-log: Thread utilization summary (%u phase%s) written to %s .\n", phase_ct, (phase_ct == 1)? "" : "s", outname);
+  }
+  while (0) {
+  WriteThreadPerfLog_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  WriteThreadPerfLog_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  WriteThreadPerfLog_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  }
+  fclose_cond(outfile);
+  free_cond(phases);
+  return reterr;
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -431,20 +431,91 @@ uintptr_t DetectMib();
 
 uintptr_t GetDefaultAllocMib();
 
-// caller is responsible for freeing bigstack_ua
-PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr);
+FLAGSET_DEF_START()
+  kfBigstack0,
+  // madvise(MADV_HUGEPAGE) on the arena.
+  kfBigstackThp = (1 << 0),
+  // mmap(MAP_HUGETLB); falls back to kfBigstackThp if the reserved huge-page
+  // pool is too small.
+  kfBigstackHugetlb = (1 << 1),
+  // Interleave pages across all online NUMA nodes.
+  kfBigstackNumaInterleave = (1 << 2)
+FLAGSET_DEF_END(BigstackFlags);
+
+// Nonzero flags are only supported on Linux.  Caller is responsible for
+// calling CleanupBigstack(bigstack_ua).
+PglErr InitBigstack(uintptr_t malloc_size_mib, BigstackFlags flags, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr);
+
+void CleanupBigstack(unsigned char* bigstack_ua);
 
 
 HEADER_INLINE uintptr_t bigstack_left() {
   return g_bigstack_end - g_bigstack_base;
 }
 
+// High-water-mark accounting.  Every bigstack_alloc...()/bigstack_end_alloc...()
+// call, and every helper below which moves g_bigstack_base/g_bigstack_end,
+// records usage after the move.  Code which carves out workspace through local
+// pointers (e.g. LoadPvar's tmp_alloc_base/tmp_alloc_end, or CalcKing's
+// king_counts) must call BigstackNoteExtent() or BigstackNoteUsage() itself.
+// Buffers sized from bigstack_left() (text-stream line buffers, pair
+// buffers, etc.) would make every loader look like it needs most of the
+// workspace; they're allocated with BigstackAllocElastic() and reported
+// separately.
+// g_bigstack_initial_{base,end} are the values InitBigstack() set.
+extern unsigned char* g_bigstack_initial_base;
+extern unsigned char* g_bigstack_initial_end;
+
+// Nonzero while BigstackEndCap() is in effect.
+extern uintptr_t g_bigstack_end_cap_blen;
+
+// Usage if g_bigstack_base were base_in_use and g_bigstack_end were
+// end_in_use.
+HEADER_INLINE uintptr_t BigstackExtentUsage(const void* base_in_use, const void* end_in_use) {
+  return S_CAST(uintptr_t, S_CAST(const unsigned char*, base_in_use) - g_bigstack_initial_base) + S_CAST(uintptr_t, g_bigstack_initial_end - S_CAST(const unsigned char*, end_in_use));
+}
+
+HEADER_INLINE uintptr_t BigstackUsage() {
+  return BigstackExtentUsage(g_bigstack_base, &(g_bigstack_end[g_bigstack_end_cap_blen]));
+}
+
+// For workspace that doesn't form a single extent.  Elastic buffers must be
+// excluded from fixed_byte_ct.
+void BigstackNoteUsage(uintptr_t fixed_byte_ct, uintptr_t elastic_byte_ct);
+
+// Records BigstackExtentUsage(base_in_use, end_in_use), with any live elastic
+// buffers in that extent counted separately.
+void BigstackNoteExtent(const void* base_in_use, const void* end_in_use);
+
+HEADER_INLINE void BigstackNotePeak() {
+  BigstackNoteExtent(g_bigstack_base, &(g_bigstack_end[g_bigstack_end_cap_blen]));
+}
+
+// Same as bigstack_alloc_raw_rd()/bigstack_end_alloc_raw_rd(), except that the
+// buffer is counted as elastic instead of fixed usage until it's freed.
+void* BigstackAllocElastic(uintptr_t size);
+
+void* BigstackEndAllocElastic(uintptr_t size);
+
+// Writes the current phase's high-water marks to the log (not stdout), and
+// starts a new phase.
+void BigstackPhaseEnd(const char* phase_name);
+
+// Overall high-water mark so far, including the current phase, excluding
+// elastic buffers.
+uintptr_t BigstackPeak();
+
+// Writes the overall high-water marks to the log (not stdout).  No-op if
+// InitBigstack() hasn't been called.
+void LogBigstackPeak();
+
 HEADER_INLINE void* bigstack_alloc_raw(uintptr_t size) {
   // Assumes caller has already forced size to a multiple of
   // kCacheline, and verified that enough space is available.
   assert(!(size % kCacheline));
   unsigned char* alloc_ptr = g_bigstack_base;
   g_bigstack_base += size;
+  BigstackNotePeak();
   return alloc_ptr;
 }
 
@@ -452,6 +523,7 @@ HEADER_INLINE void* bigstack_alloc_raw_rd(uintptr_t size) {
   // Same as bigstack_alloc_raw(), except for rounding up size.
   unsigned char* alloc_ptr = g_bigstack_base;
   g_bigstack_base += RoundUpPow2(size, kCacheline);
+  BigstackNotePeak();
   return alloc_ptr;
 }
 
@@ -643,6 +715,25 @@ BoolErr bigstack_calloc_kcp(uintptr_t ct, const char*** kcp_arr_ptr);
 
 BoolErr bigstack_calloc_cpp(uintptr_t ct, char**** cpp_arr_ptr);
 
+// --spill-dir overflow tier.  When g_spill_dirname is set, SpillAlloc() maps a
+// zero-filled block backed by an (immediately unlinked) file in that
+// directory, and BigstackAllocOrSpill() uses it for requests the workspace
+// can't satisfy.  *is_spilled_ptr tells the caller which happened, so it can
+// favor sequential access; is_sequential also passes MADV_SEQUENTIAL to the
+// kernel.  Spilled blocks are released by SpillFree() or CleanupSpills(), not
+// by BigstackReset().  Always fails on Windows.
+extern const char* g_spill_dirname;
+
+BoolErr SpillAlloc(uintptr_t size, uint32_t is_sequential, const char* purpose, void* alloc_ptr);
+
+BoolErr BigstackAllocOrSpill(uintptr_t size, uint32_t zero_fill, uint32_t is_sequential, const char* purpose, void* alloc_ptr, uint32_t* is_spilled_ptr);
+
+// Returns 1 and releases the block if ptr was returned by SpillAlloc(), 0
+// (doing nothing) otherwise.
+uint32_t SpillFree(const void* ptr);
+
+void CleanupSpills();
+
 HEADER_INLINE BoolErr bigstack_calloc_c(uintptr_t ct, char** c_arr_ptr) {
   return bigstack_calloc_uc(ct, R_CAST(unsigned char**, c_arr_ptr));
 }
@@ -687,10 +778,13 @@ template <class T> BoolErr BigstackAllocX(uintptr_t ct, T** x_arr_ptr) {
 
 HEADER_INLINE void BigstackReset(void* new_base) {
   g_bigstack_base = S_CAST(unsigned char*, new_base);
+  BigstackNotePeak();
 }
 
 HEADER_INLINE void BigstackEndReset(void* new_end) {
   g_bigstack_end = S_CAST(unsigned char*, new_end);
+  g_bigstack_end_cap_blen = 0;
+  BigstackNotePeak();
 }
 
 HEADER_INLINE void BigstackDoubleReset(void* new_base, void* new_end) {
@@ -704,35 +798,41 @@ HEADER_INLINE void BigstackFinalizeW(__maybe_unused const uintptr_t* wptr, uintp
   assert(wptr == R_CAST(const uintptr_t*, g_bigstack_base));
   g_bigstack_base += RoundUpPow2(ct * sizeof(intptr_t), kCacheline);
   assert(g_bigstack_base <= g_bigstack_end);
+  BigstackNotePeak();
 }
 
 HEADER_INLINE void BigstackFinalizeU32(__maybe_unused const uint32_t* u32ptr, uintptr_t ct) {
   assert(u32ptr == R_CAST(const uint32_t*, g_bigstack_base));
   g_bigstack_base += RoundUpPow2(ct * sizeof(int32_t), kCacheline);
   assert(g_bigstack_base <= g_bigstack_end);
+  BigstackNotePeak();
 }
 
 HEADER_INLINE void BigstackFinalizeU64(__maybe_unused const uint64_t* u64ptr, uintptr_t ct) {
   assert(u64ptr == R_CAST(const uint64_t*, g_bigstack_base));
   g_bigstack_base += RoundUpPow2(ct * sizeof(int64_t), kCacheline);
   assert(g_bigstack_base <= g_bigstack_end);
+  BigstackNotePeak();
 }
 
 HEADER_INLINE void BigstackFinalizeC(__maybe_unused const char* cptr, uintptr_t ct) {
   assert(cptr == R_CAST(const char*, g_bigstack_base));
   g_bigstack_base += RoundUpPow2(ct, kCacheline);
   assert(g_bigstack_base <= g_bigstack_end);
+  BigstackNotePeak();
 }
 
 HEADER_INLINE void BigstackFinalizeCp(__maybe_unused const char* const* cpptr, uintptr_t ct) {
   assert(cpptr == R_CAST(const char* const*, g_bigstack_base));
   g_bigstack_base += RoundUpPow2(ct * sizeof(intptr_t), kCacheline);
   assert(g_bigstack_base <= g_bigstack_end);
+  BigstackNotePeak();
 }
 
 
 HEADER_INLINE void BigstackBaseSet(const void* unaligned_base) {
   g_bigstack_base = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, unaligned_base), kCacheline));
+  BigstackNotePeak();
 }
 
 // When using BigstackBaseSet() after a loop where tmp_alloc_end is fixed, the
@@ -741,6 +841,7 @@ HEADER_INLINE void BigstackBaseSet(const void* unaligned_base) {
 // instead.
 HEADER_INLINE BoolErr BigstackBaseSetChecked(const void* unaligned_base) {
   g_bigstack_base = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, unaligned_base), kCacheline));
+  BigstackNotePeak();
   return (g_bigstack_base > g_bigstack_end);
 }
 
@@ -751,6 +852,7 @@ HEADER_INLINE unsigned char* BigstackEndRoundedDown() {
 HEADER_INLINE void BigstackShrinkTop(const void* rebase, uintptr_t new_size) {
   // could assert that this doesn't go in the wrong direction?
   g_bigstack_base = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, rebase) + new_size, kCacheline));
+  BigstackNotePeak();
 }
 
 // ensure vector-alignment
@@ -758,6 +860,16 @@ CONSTI32(kEndAllocAlign, MAXV(kBytesPerVec, 16));
 
 HEADER_INLINE void BigstackEndSet(const void* unaligned_end) {
   g_bigstack_end = R_CAST(unsigned char*, RoundDownPow2(R_CAST(uintptr_t, unaligned_end), kEndAllocAlign));
+  g_bigstack_end_cap_blen = 0;
+  BigstackNotePeak();
+}
+
+// Temporarily lowers g_bigstack_end to limit allocations, without counting
+// [new_end, old g_bigstack_end) as in use.  BigstackEndReset() or
+// BigstackEndSet() lifts the cap.
+HEADER_INLINE void BigstackEndCap(void* new_end) {
+  g_bigstack_end_cap_blen += S_CAST(uintptr_t, g_bigstack_end - S_CAST(unsigned char*, new_end));
+  g_bigstack_end = S_CAST(unsigned char*, new_end);
 }
 
 // assumes size is divisible by kEndAllocAlign
@@ -765,11 +877,13 @@ HEADER_INLINE void BigstackEndSet(const void* unaligned_end) {
 HEADER_INLINE void* bigstack_end_alloc_raw(uintptr_t size) {
   assert(!(size % kEndAllocAlign));
   g_bigstack_end -= size;
+  BigstackNotePeak();
   return g_bigstack_end;
 }
 
 HEADER_INLINE void* bigstack_end_alloc_raw_rd(uintptr_t size) {
   g_bigstack_end -= RoundUpPow2(size, kEndAllocAlign);
+  BigstackNotePeak();
   return g_bigstack_end;
 }
 
@@ -1852,7 +1966,7 @@ HEADER_INLINE void InvalidArg(const char* cur_arg) {
   logpreprintfww("Error: Unrecognized flag ('%s').\n", cur_arg);
 }
 
-PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, uint32_t memory_require, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr);
+PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, uint32_t memory_require, BigstackFlags bigstack_flags, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr);
 
 void CleanupPlink2CmdlineMeta(Plink2CmdlineMeta* pcmp);
 
@@ -1916,6 +2030,11 @@ PglErr SearchHeaderLine(const char* header_line_iter, const char* const* search_
 // are "cols=").  supported_ids is a multistr.
 PglErr ParseColDescriptor(const char* col_descriptor_iter, const char* supported_ids, const char* cur_flag_name, uint32_t first_col_shifted, uint32_t default_cols_mask, uint32_t prohibit_empty, void* result_ptr);
 
+// Writes the --perf-log JSON summary of all completed thread-group phases, in
+// start order.  run_start_ns is the MonotonicNs() value phase offsets are
+// measured from.
+PglErr WriteThreadPerfLog(const char* outname, uint64_t run_start_ns);
+
 
 // this is technically application-dependent, but let's keep this simple for
 // now
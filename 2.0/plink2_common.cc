@@ -42,6 +42,24 @@ void InitPedigreeIdInfo(MiscFlags misc_flags, PedigreeIdInfo* piip) {
   piip->parental_id_info.max_maternal_id_blen = 2;
 }
 
+uintptr_t PgvAllocReq(uint32_t sample_ct, uint32_t multiallelic_needed, PgenGlobalFlags gflags) {
+  const uintptr_t bitarray_alloc = BitCtToCachelineCt(sample_ct) * kCacheline;
+  uintptr_t byte_ct = NypCtToCachelineCt(sample_ct) * kCacheline;
+  if (multiallelic_needed) {
+    byte_ct += 2 * bitarray_alloc + RoundUpPow2(sample_ct * sizeof(AlleleCode), kCacheline) + RoundUpPow2(sample_ct * 2 * sizeof(AlleleCode), kCacheline);
+  }
+  if (gflags & (kfPgenGlobalHardcallPhasePresent | kfPgenGlobalDosagePhasePresent)) {
+    byte_ct += 2 * bitarray_alloc;
+  }
+  if (gflags & kfPgenGlobalDosagePresent) {
+    byte_ct += bitarray_alloc + RoundUpPow2(sample_ct * sizeof(Dosage), kCacheline);
+    if (gflags & kfPgenGlobalDosagePhasePresent) {
+      byte_ct += bitarray_alloc + RoundUpPow2(sample_ct * sizeof(SDosage), kCacheline);
+    }
+  }
+  return byte_ct;
+}
+
 BoolErr BigstackAllocPgv(uint32_t sample_ct, uint32_t multiallelic_needed, PgenGlobalFlags gflags, PgenVariant* pgvp) {
   const uint32_t sample_ctl2 = NypCtToWordCt(sample_ct);
   if (unlikely(bigstack_alloc_w(sample_ctl2, &(pgvp->genovec)))) {
@@ -1917,6 +1935,71 @@ PglErr TryToAddChrName(const char* chr_name, const char* file_descrip, uintptr_t
   return kPglRetSuccess;
 }
 
+uint64_t BgzfIndexScanStart(const char* fname, const char* file_descrip, const ChrInfo* cip, uint32_t allow_extra_chrs, int32_t from_bp, int32_t to_bp, uint32_t* kept_ref_ct_ptr) {
+  BgzfIndex bgzf_idx;
+  PreinitBgzfIndex(&bgzf_idx);
+  const char* errmsg = nullptr;
+  const PglErr reterr = LoadBgzfIndex(fname, &bgzf_idx, &errmsg);
+  if (reterr) {
+    if (reterr != kPglRetSkipped) {
+      if (reterr == kPglRetNomem) {
+        errmsg = "Out of memory";
+      }
+      logerrprintfww("Warning: Ignoring tabix/CSI index for %s (%s).\n", file_descrip, errmsg);
+    }
+    return UINT64_MAX;
+  }
+  uint64_t voffset = UINT64_MAX;
+  const uint32_t ref_ct = bgzf_idx.ref_ct;
+  uint32_t first_kept_ref_idx = UINT32_MAX;
+  uint32_t kept_ref_ct = 0;
+  const char* name_iter = bgzf_idx.names;
+  for (uint32_t ref_idx = 0; ref_idx != ref_ct; ++ref_idx) {
+    const uint32_t name_slen = strlen(name_iter);
+    const uint32_t chr_code = GetChrCode(name_iter, cip, name_slen);
+    uint32_t is_kept;
+    if (!IsI32Neg(chr_code)) {
+      is_kept = IsSet(cip->chr_mask, chr_code);
+    } else {
+      if ((chr_code == UINT32_MAXM1) || (!allow_extra_chrs) || (name_iter[0] == '#') || (name_slen > kMaxIdSlen)) {
+        // Let the full scan report the error.
+        goto BgzfIndexScanStart_ret_1;
+      }
+      // Same rule as TryToAddChrName().
+      uint32_t in_name_stack = 0;
+      for (const LlStr* name_stack_ptr = cip->incl_excl_name_stack; name_stack_ptr; name_stack_ptr = name_stack_ptr->next) {
+        if (!strcmp(name_iter, name_stack_ptr->str)) {
+          in_name_stack = 1;
+          break;
+        }
+      }
+      is_kept = (in_name_stack == cip->is_include_stack);
+    }
+    if (is_kept) {
+      if (first_kept_ref_idx == UINT32_MAX) {
+        first_kept_ref_idx = ref_idx;
+      }
+      ++kept_ref_ct;
+    }
+    name_iter = &(name_iter[name_slen + 1]);
+  }
+  if ((!kept_ref_ct) || ((kept_ref_ct == ref_ct) && (from_bp == -1))) {
+    goto BgzfIndexScanStart_ret_1;
+  }
+  if (kept_ref_ct == 1) {
+    const uint64_t beg = (from_bp > 0)? (from_bp - 1) : 0;
+    const uint64_t end = (to_bp == -1)? BgzfIndexMaxPos(&bgzf_idx) : (S_CAST(uint64_t, to_bp) + 1);
+    voffset = BgzfIndexQuery(&bgzf_idx, first_kept_ref_idx, beg, end);
+  }
+  if (voffset == UINT64_MAX) {
+    voffset = BgzfIndexQuery(&bgzf_idx, first_kept_ref_idx, 0, BgzfIndexMaxPos(&bgzf_idx));
+  }
+  *kept_ref_ct_ptr = kept_ref_ct;
+ BgzfIndexScanStart_ret_1:
+  CleanupBgzfIndex(&bgzf_idx);
+  return voffset;
+}
+
 
 /*
 uintptr_t count_11_vecs(const VecW* geno_vvec, uintptr_t vec_ct) {
@@ -2967,6 +3050,32 @@ uintptr_t GetMhcWordCt(uintptr_t sample_ct) {
   return RoundUpPow2(patch_01_max_word_ct, kWordsPerVec) + RoundUpPow2(patch_10_max_word_ct, kWordsPerVec);
 }
 
+uintptr_t PgenMtLoadThreadCachelineCt(uint32_t sample_ct, uintptr_t pgr_alloc_cacheline_ct, uintptr_t thread_xalloc_cacheline_ct, uint32_t genovecs_needed, uint32_t mhc_needed, uint32_t phase_needed, uint32_t dosage_needed, uint32_t dphase_needed) {
+  // pgr_pps, read_variant_uidx_starts_ptr, (*pgr_pps)[tidx], pgr_alloc;
+  //   deliberately a slight overestimate
+  const uintptr_t pgr_struct_alloc = RoundUpPow2(sizeof(PgenReader), kCacheline);
+  uintptr_t thread_alloc_cacheline_ct = 1 + 1 + (pgr_struct_alloc / kCacheline) + pgr_alloc_cacheline_ct + thread_xalloc_cacheline_ct;
+  if (genovecs_needed) {
+    const uint32_t sample_ctcl = BitCtToCachelineCt(sample_ct);
+    // todo: multiallelic dosage
+    const uintptr_t dosage_main_cl = DivUp(sample_ct, (kCacheline / sizeof(Dosage)));
+    thread_alloc_cacheline_ct += 1 + NypCtToCachelineCt(sample_ct);
+    if (mhc_needed) {
+      thread_alloc_cacheline_ct += 1 + DivUp(GetMhcWordCt(sample_ct), kWordsPerCacheline);
+    }
+    if (phase_needed) {
+      thread_alloc_cacheline_ct += 2 + sample_ctcl;
+    }
+    if (dosage_needed) {
+      thread_alloc_cacheline_ct += 2 + sample_ctcl + dosage_main_cl;
+      if (dphase_needed) {
+        thread_alloc_cacheline_ct += 2 + sample_ctcl + dosage_main_cl;
+      }
+    }
+  }
+  return thread_alloc_cacheline_ct;
+}
+
 PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint32_t variant_ct, uintptr_t bytes_avail, uintptr_t pgr_alloc_cacheline_ct, uintptr_t thread_xalloc_cacheline_ct, uintptr_t per_variant_xalloc_byte_ct, uintptr_t per_alt_allele_xalloc_byte_ct, PgenFileInfo* pgfip, uint32_t* calc_thread_ct_ptr, uintptr_t*** genovecs_ptr, uintptr_t*** mhc_ptr, uintptr_t*** phasepresent_ptr, uintptr_t*** phaseinfo_ptr, uintptr_t*** dosage_present_ptr, Dosage*** dosage_mains_ptr, uintptr_t*** dphase_present_ptr, SDosage*** dphase_delta_ptr, uint32_t* read_block_size_ptr, uintptr_t* max_alt_allele_block_size_ptr, STD_ARRAY_REF(unsigned char*, 2) main_loadbufs, PgenReader*** pgr_pps, uint32_t** read_variant_uidx_starts_ptr) {
   uintptr_t cachelines_avail = bytes_avail / kCacheline;
   uint32_t read_block_size = kPglVblockSize;
@@ -3016,36 +3125,12 @@ PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint
     *calc_thread_ct_ptr = calc_thread_ct;
   }
 
-  // pgr_pps, read_variant_uidx_starts_ptr, (*pgr_pps)[tidx], pgr_alloc;
-  //   deliberately a slight overestimate
+  const uintptr_t thread_alloc_cacheline_ct = PgenMtLoadThreadCachelineCt(sample_ct, pgr_alloc_cacheline_ct, thread_xalloc_cacheline_ct, (genovecs_ptr != nullptr), (mhc_ptr != nullptr), (phasepresent_ptr != nullptr), (dosage_present_ptr != nullptr), (dphase_present_ptr != nullptr));
   const uintptr_t pgr_struct_alloc = RoundUpPow2(sizeof(PgenReader), kCacheline);
-  uintptr_t thread_alloc_cacheline_ct = 1 + 1 + (pgr_struct_alloc / kCacheline) + pgr_alloc_cacheline_ct + thread_xalloc_cacheline_ct;
-
   const uint32_t sample_ctcl2 = NypCtToCachelineCt(sample_ct);
   const uint32_t sample_ctcl = BitCtToCachelineCt(sample_ct);
-
-  // todo: multiallelic dosage
   const uintptr_t dosage_main_cl = DivUp(sample_ct, (kCacheline / sizeof(Dosage)));
-  uintptr_t mhc_cl = 0;
-  if (genovecs_ptr) {
-    thread_alloc_cacheline_ct += 1 + sample_ctcl2;
-    if (mhc_ptr) {
-      mhc_cl = DivUp(GetMhcWordCt(sample_ct), kWordsPerCacheline);
-      thread_alloc_cacheline_ct += 1 + mhc_cl;
-    }
-    if (phasepresent_ptr) {
-      assert(phaseinfo_ptr);
-      thread_alloc_cacheline_ct += 2 + sample_ctcl;
-    }
-    if (dosage_present_ptr) {
-      assert(dosage_mains_ptr);
-      thread_alloc_cacheline_ct += 2 + sample_ctcl + dosage_main_cl;
-      if (dphase_present_ptr) {
-        assert(dphase_delta_ptr);
-        thread_alloc_cacheline_ct += 2 + sample_ctcl + dosage_main_cl;
-      }
-    }
-  }
+  const uintptr_t mhc_cl = mhc_ptr? DivUp(GetMhcWordCt(sample_ct), kWordsPerCacheline) : 0;
   if (thread_alloc_cacheline_ct * calc_thread_ct > cachelines_avail) {
     if (thread_alloc_cacheline_ct > cachelines_avail) {
       return kPglRetNomem;
@@ -3071,13 +3156,16 @@ PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint
       *mhc_ptr = S_CAST(uintptr_t**, bigstack_alloc_raw(array_of_ptrs_alloc));
     }
     if (phasepresent_ptr) {
+      assert(phaseinfo_ptr);
       *phasepresent_ptr = S_CAST(uintptr_t**, bigstack_alloc_raw(array_of_ptrs_alloc));
       *phaseinfo_ptr = S_CAST(uintptr_t**, bigstack_alloc_raw(array_of_ptrs_alloc));
     }
     if (dosage_present_ptr) {
+      assert(dosage_mains_ptr);
       *dosage_present_ptr = S_CAST(uintptr_t**, bigstack_alloc_raw(array_of_ptrs_alloc));
       *dosage_mains_ptr = S_CAST(Dosage**, bigstack_alloc_raw(array_of_ptrs_alloc));
       if (dphase_present_ptr) {
+        assert(dphase_delta_ptr);
         *dphase_present_ptr = S_CAST(uintptr_t**, bigstack_alloc_raw(array_of_ptrs_alloc));
         *dphase_delta_ptr = S_CAST(SDosage**, bigstack_alloc_raw(array_of_ptrs_alloc));
       }
@@ -3133,7 +3221,11 @@ uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup*
     }
   }
   *read_block_idxp = read_block_idx;
+  const uint64_t perf_start_ns = g_thread_perf? MonotonicNs() : 0;
   *reterrp = PgfiMultiread(variant_include, offset, offset + cur_read_block_size, cur_block_write_ct, pgfip);
+  if (perf_start_ns) {
+    AddThreadPerfIoNs(0, MonotonicNs() - perf_start_ns);
+  }
   return cur_block_write_ct;
 }
 
@@ -137,7 +137,10 @@ FLAGSET64_DEF_START()
   kfMiscIidSid = (1LLU << 39),
   kfMiscPhenoIidOnly = (1LLU << 40),
   kfMiscCovarIidOnly = (1LLU << 41),
-  kfMiscAllowBadLd = (1LLU << 42)
+  kfMiscAllowBadLd = (1LLU << 42),
+  kfMiscDryRun = (1LLU << 43),
+  kfMiscPvarCache = (1LLU << 44),
+  kfMiscPvarCacheVerify = (1LLU << 45)
 FLAGSET64_DEF_END(MiscFlags);
 
 FLAGSET64_DEF_START()
@@ -225,7 +228,8 @@ FLAGSET_DEF_START()
   kfPsamColPheno1 = (1 << 18),
   kfPsamColPhenos = (1 << 19),
   kfPsamColDefault = (kfPsamColMaybefid | kfPsamColMaybesid | kfPsamColMaybeparents | kfPsamColSex | kfPsamColPhenos),
-  kfPsamColAll = ((kfPsamColPhenos * 2) - kfPsamColMaybefid)
+  kfPsamColAll = ((kfPsamColPhenos * 2) - kfPsamColMaybefid),
+  kfPvarBgz = (1 << 20)
 FLAGSET_DEF_END(PvarPsamFlags);
 
 // may want to rename FidPresent to FidMayBePresent
@@ -337,6 +341,9 @@ HEADER_INLINE BoolErr bigstack_end_alloc_dphase(uintptr_t ct, SDosage** dphase_a
   return !(*dphase_arr_ptr);
 }
 
+// Bytes BigstackAllocPgv() takes from the bottom of g_bigstack.
+uintptr_t PgvAllocReq(uint32_t sample_ct, uint32_t multiallelic_needed, PgenGlobalFlags gflags);
+
 BoolErr BigstackAllocPgv(uint32_t sample_ct, uint32_t multiallelic_needed, PgenGlobalFlags gflags, PgenVariant* pgvp);
 
 // remainder must be in [1, 16383].
@@ -806,6 +813,16 @@ HEADER_INLINE PglErr GetOrAddChrCodeDestructive(const char* file_descrip, uintpt
   return GetOrAddChrCode(chr_name, file_descrip, line_idx, chr_name_end - chr_name, allow_extra_chrs, cip, chr_idx_ptr);
 }
 
+// If fname is BGZF-compressed and has a tabix or CSI index, and the
+// chromosome filter excludes at least one indexed sequence (or --from-bp/
+// --to-bp narrow the only one kept), returns the BGZF virtual offset of the
+// first record that may be kept, and sets *kept_ref_ct_ptr to the number of
+// indexed sequences that may be kept.  Otherwise, returns UINT64_MAX.
+// Index-loading problems only produce a warning, since the caller can always
+// fall back on a full scan.  Caller is responsible for verifying that fname is
+// BGZF.
+uint64_t BgzfIndexScanStart(const char* fname, const char* file_descrip, const ChrInfo* cip, uint32_t allow_extra_chrs, int32_t from_bp, int32_t to_bp, uint32_t* kept_ref_ct_ptr);
+
 // Assumes sample_ct positive.  Does not require trailing bits to be clear.
 uint32_t AllGenoEqual(const uintptr_t* genoarr, uint32_t sample_ct);
 
@@ -1059,6 +1076,10 @@ uintptr_t GetMaxAltAlleleBlockSize(const uintptr_t* variant_include, const uintp
 // for analysis of major histocompatibility complex genomic data...
 uintptr_t GetMhcWordCt(uintptr_t sample_ct);
 
+// Per-thread cachelines reserved by PgenMtLoadInit() (including the caller's
+// thread_xalloc_cacheline_ct), given which per-thread buffers are requested.
+uintptr_t PgenMtLoadThreadCachelineCt(uint32_t sample_ct, uintptr_t pgr_alloc_cacheline_ct, uintptr_t thread_xalloc_cacheline_ct, uint32_t genovecs_needed, uint32_t mhc_needed, uint32_t phase_needed, uint32_t dosage_needed, uint32_t dphase_needed);
+
 // sample_ct not relevant if genovecs_ptr == nullptr
 // only possible error is kPglRetNomem for now
 PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint32_t variant_ct, uintptr_t bytes_avail, uintptr_t pgr_alloc_cacheline_ct, uintptr_t thread_xalloc_cacheline_ct, uintptr_t per_variant_xalloc_byte_ct, uintptr_t per_alt_allele_xalloc_byte_ct, PgenFileInfo* pgfip, uint32_t* calc_thread_ct_ptr, uintptr_t*** genovecs_ptr, uintptr_t*** mhc_ptr, uintptr_t*** phasepresent_ptr, uintptr_t*** phaseinfo_ptr, uintptr_t*** dosage_present_ptr, Dosage*** dosage_mains_ptr, uintptr_t*** dphase_present_ptr, SDosage*** dphase_delta_ptr, uint32_t* read_block_size_ptr, uintptr_t* max_alt_allele_block_size_ptr, STD_ARRAY_REF(unsigned char*, 2) main_loadbufs, PgenReader*** pgr_pps, uint32_t** read_variant_uidx_starts_ptr);
@@ -1188,6 +1209,14 @@ HEADER_INLINE void OutnameZstSet(const char* ext, uint32_t output_zst, char* out
   }
 }
 
+// output_zst and output_bgz must not both be set.
+HEADER_INLINE void OutnameCstreamSet(const char* ext, uint32_t output_zst, uint32_t output_bgz, char* outname_end) {
+  OutnameZstSet(ext, output_zst, outname_end);
+  if (output_bgz) {
+    strcpy_k(&(outname_end[strlen(ext)]), ".gz");
+  }
+}
+
 ENUM_U31_DEF_START()
   kVfilterExtract,
   kVfilterExtractIntersect,
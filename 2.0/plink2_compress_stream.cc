@@ -23,9 +23,16 @@ namespace plink2 {
 
 uint32_t g_zst_level = 0;
 
+uint32_t g_zst_pipe_thread_ct = 0;
+
+uint32_t g_zst_pipe_level = 0;
+
 PglErr InitCstreamNoop(const char* out_fname, uint32_t do_append, char* overflow_buf, CompressStreamState* css_ptr) {
   // css_ptr->z_outfile = nullptr;
   css_ptr->cctx = nullptr;
+  css_ptr->seek_table = nullptr;
+  css_ptr->pipe = nullptr;
+  css_ptr->bgz = nullptr;
   // can't use fopen_checked since we need to be able to append
   css_ptr->outfile = fopen(out_fname, do_append? FOPEN_AB : FOPEN_WB);
   if (unlikely(!css_ptr->outfile)) {
@@ -37,23 +44,399 @@ PglErr InitCstreamNoop(const char* out_fname, uint32_t do_append, char* overflow
   return kPglRetSuccess;
 }
 
-PglErr InitCstreamZstd(const char* out_fname, uint32_t do_append, __maybe_unused uint32_t thread_ct, uintptr_t overflow_buf_size, char* overflow_buf, unsigned char* compress_wkspace, CompressStreamState* css_ptr) {
+// Appends a (compressed size, decompressed size) entry to the seek table, if
+// there is one.
+static void CstreamAppendSeekEntry(uint32_t frame_cbyte_ct, uint32_t frame_dbyte_ct, CompressStreamState* css_ptr) {
+  uint32_t* seek_table = css_ptr->seek_table;
+  if (!seek_table) {
+    return;
+  }
+  const uint32_t frame_ct = css_ptr->seek_table_frame_ct;
+  if (frame_ct == css_ptr->seek_table_frame_capacity) {
+    const uint32_t new_capacity = frame_ct * 2;
+    seek_table = S_CAST(uint32_t*, realloc(seek_table, new_capacity * 2 * sizeof(int32_t)));
+    if (!seek_table) {
+      free(css_ptr->seek_table);
+      css_ptr->seek_table = nullptr;
+      return;
+    }
+    css_ptr->seek_table = seek_table;
+    css_ptr->seek_table_frame_capacity = new_capacity;
+  }
+  seek_table[2 * frame_ct] = frame_cbyte_ct;
+  seek_table[2 * frame_ct + 1] = frame_dbyte_ct;
+  css_ptr->seek_table_frame_ct = frame_ct + 1;
+}
+
+THREAD_FUNC_DECL CstreamPipeThread(void* raw_arg) {
+  CompressStreamState* css_ptr = S_CAST(CompressStreamState*, raw_arg);
+  CstreamPipe* pipe = css_ptr->pipe;
+  ZSTD_CCtx* cctx = css_ptr->cctx;
+  FILE* outfile = css_ptr->outfile;
+  uint64_t last_ns = MonotonicNs();
+  for (uint32_t slot_idx = 0; ; ) {
+    CstreamPipeSlot* slot = &(pipe->slots[slot_idx]);
+#ifdef _WIN32
+    WaitForSingleObject(slot->filled_event, INFINITE);
+#else
+    pthread_mutex_lock(&(slot->mutex));
+    while (slot->nbytes == UINT32_MAX) {
+      pthread_cond_wait(&(slot->condvar), &(slot->mutex));
+    }
+    // The main thread won't touch this slot again until we reopen it, so we
+    // don't need to hold the mutex while compressing.
+    pthread_mutex_unlock(&(slot->mutex));
+#endif
+    const uint64_t wake_ns = MonotonicNs();
+    pipe->compressor_idle_ns += wake_ns - last_ns;
+    const uint32_t nbytes = slot->nbytes;
+    const uint32_t eof = slot->eof;
+    // Always emit at least one frame, so that empty output is still a valid
+    // .zst file.
+    if ((nbytes || (!pipe->frame_ct)) && (!pipe->write_errno)) {
+      const size_t frame_cbyte_ct = ZSTD_compress2(cctx, pipe->cbuf, pipe->cbuf_size, slot->buf, nbytes);
+      if (unlikely(ZSTD_isError(frame_cbyte_ct))) {
+        pipe->write_errno = -1;
+      } else if (unlikely(!fwrite_unlocked(pipe->cbuf, frame_cbyte_ct, 1, outfile))) {
+        pipe->write_errno = errno? errno : -1;
+      } else {
+        css_ptr->cbyte_ct += frame_cbyte_ct;
+        CstreamAppendSeekEntry(frame_cbyte_ct, nbytes, css_ptr);
+        pipe->frame_ct += 1;
+        pipe->dbyte_ct += nbytes;
+      }
+    }
+    last_ns = MonotonicNs();
+    pipe->compressor_busy_ns += last_ns - wake_ns;
+#ifdef _WIN32
+    slot->nbytes = UINT32_MAX;
+    SetEvent(slot->open_event);
+#else
+    pthread_mutex_lock(&(slot->mutex));
+    slot->nbytes = UINT32_MAX;
+    pthread_cond_signal(&(slot->condvar));
+    pthread_mutex_unlock(&(slot->mutex));
+#endif
+    if (eof) {
+      THREAD_RETURN;
+    }
+    if (++slot_idx == kCstreamPipeSlotCt) {
+      slot_idx = 0;
+    }
+  }
+}
+
+static void DestroyCstreamPipeSlots(uint32_t slot_ct, CstreamPipe* pipe) {
+  for (uint32_t slot_idx = 0; slot_idx != slot_ct; ++slot_idx) {
+    CstreamPipeSlot* slot = &(pipe->slots[slot_idx]);
+#ifdef _WIN32
+    CloseHandle(slot->filled_event);
+    CloseHandle(slot->open_event);
+#else
+    pthread_mutex_destroy(&(slot->mutex));
+    pthread_cond_destroy(&(slot->condvar));
+#endif
+  }
+}
+
+// On failure, nothing is allocated and the caller falls back to compressing on
+// the main thread.
+static BoolErr InitCstreamPipe(const char* out_fname, CompressStreamState* css_ptr) {
+  const uintptr_t pipe_aligned_size = RoundUpPow2(sizeof(CstreamPipe), kCacheline);
+  const uintptr_t cbuf_size = ZSTD_compressBound(kCompressStreamFrameBlen);
+  const uintptr_t cbuf_aligned_size = RoundUpPow2(cbuf_size, kCacheline);
+  const uintptr_t fname_blen = strlen(out_fname) + 1;
+  unsigned char* raw_alloc;
+  if (cachealigned_malloc(pipe_aligned_size + kCstreamPipeSlotCt * S_CAST(uintptr_t, kCompressStreamFrameBlen) + cbuf_aligned_size + fname_blen, &raw_alloc)) {
+    return 1;
+  }
+  CstreamPipe* pipe = R_CAST(CstreamPipe*, raw_alloc);
+  unsigned char* alloc_iter = &(raw_alloc[pipe_aligned_size]);
+  for (uint32_t slot_idx = 0; slot_idx != kCstreamPipeSlotCt; ++slot_idx) {
+    CstreamPipeSlot* slot = &(pipe->slots[slot_idx]);
+    slot->buf = R_CAST(char*, alloc_iter);
+    alloc_iter = &(alloc_iter[kCompressStreamFrameBlen]);
+    slot->nbytes = UINT32_MAX;
+    slot->eof = 0;
+#ifdef _WIN32
+    slot->filled_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    // The main thread starts out writing to slot 0 without waiting.
+    slot->open_event = CreateEvent(nullptr, FALSE, slot_idx? TRUE : FALSE, nullptr);
+    if (unlikely((!slot->filled_event) || (!slot->open_event))) {
+      if (slot->filled_event) {
+        CloseHandle(slot->filled_event);
+      }
+      if (slot->open_event) {
+        CloseHandle(slot->open_event);
+      }
+      DestroyCstreamPipeSlots(slot_idx, pipe);
+      aligned_free(raw_alloc);
+      return 1;
+    }
+#else
+    if (unlikely(pthread_mutex_init(&(slot->mutex), nullptr))) {
+      DestroyCstreamPipeSlots(slot_idx, pipe);
+      aligned_free(raw_alloc);
+      return 1;
+    }
+    if (unlikely(pthread_cond_init(&(slot->condvar), nullptr))) {
+      pthread_mutex_destroy(&(slot->mutex));
+      DestroyCstreamPipeSlots(slot_idx, pipe);
+      aligned_free(raw_alloc);
+      return 1;
+    }
+#endif
+  }
+  pipe->cbuf = alloc_iter;
+  pipe->cbuf_size = cbuf_size;
+  pipe->fname = R_CAST(char*, &(alloc_iter[cbuf_aligned_size]));
+  memcpy(pipe->fname, out_fname, fname_blen);
+  pipe->partial_slot_idx = 0;
+  pipe->partial_nbytes = 0;
+  pipe->main_stall_ct = 0;
+  pipe->main_stall_ns = 0;
+  pipe->write_errno = 0;
+  pipe->frame_ct = 0;
+  pipe->dbyte_ct = 0;
+  pipe->compressor_busy_ns = 0;
+  pipe->compressor_idle_ns = 0;
+  css_ptr->pipe = pipe;
+#ifdef _WIN32
+  pipe->thread = R_CAST(HANDLE, _beginthreadex(nullptr, kDefaultThreadStack, CstreamPipeThread, css_ptr, 0, nullptr));
+  if (unlikely(!pipe->thread)) {
+#else
+  if (unlikely(pthread_create(&(pipe->thread), &g_thread_startup.smallstack_thread_attr, CstreamPipeThread, css_ptr))) {
+#endif
+    css_ptr->pipe = nullptr;
+    DestroyCstreamPipeSlots(kCstreamPipeSlotCt, pipe);
+    aligned_free(raw_alloc);
+    return 1;
+  }
+  return 0;
+}
+
+// Closed-stream summaries, in close order.
+typedef struct CstreamPipeStatsStruct {
+  struct CstreamPipeStatsStruct* next;
+  char* fname;
+  uint32_t frame_ct;
+  uint32_t main_stall_ct;
+  uint64_t dbyte_ct;
+  uint64_t main_stall_ns;
+  uint64_t compressor_busy_ns;
+  uint64_t compressor_idle_ns;
+} CstreamPipeStats;
+
+static CstreamPipeStats* g_cstream_pipe_stats = nullptr;
+static CstreamPipeStats** g_cstream_pipe_stats_tailp = &g_cstream_pipe_stats;
+
+// BGZF index results, in close order.
+typedef struct CstreamIndexNoteStruct {
+  struct CstreamIndexNoteStruct* next;
+  char* text;
+  uint32_t is_warning;
+} CstreamIndexNote;
+
+static CstreamIndexNote* g_cstream_index_notes = nullptr;
+static CstreamIndexNote** g_cstream_index_notes_tailp = &g_cstream_index_notes;
+
+// Silently drops the note if we're out of memory.
+static void AppendCstreamIndexNote(uint32_t is_warning, const char* fname, const char* detail) {
+  const uintptr_t text_blen = strlen(fname) + strlen(detail) + 32;
+  CstreamIndexNote* notep = S_CAST(CstreamIndexNote*, malloc(sizeof(CstreamIndexNote) + text_blen));
+  if (!notep) {
+    return;
+  }
+  notep->next = nullptr;
+  notep->text = R_CAST(char*, &(notep[1]));
+  notep->is_warning = is_warning;
+  if (is_warning) {
+    snprintf(notep->text, text_blen, "Warning: %s not indexed (%s).\n", fname, detail);
+  } else {
+    snprintf(notep->text, text_blen, "Index written to %s%s .\n", fname, detail);
+  }
+  *g_cstream_index_notes_tailp = notep;
+  g_cstream_index_notes_tailp = &(notep->next);
+}
+
+void LogCstreamNotes() {
+  CstreamIndexNote* notep = g_cstream_index_notes;
+  while (notep) {
+    if (notep->is_warning) {
+      logerrprintfww("%s", notep->text);
+    } else {
+      logprintfww("%s", notep->text);
+    }
+    CstreamIndexNote* next = notep->next;
+    free(notep);
+    notep = next;
+  }
+  g_cstream_index_notes = nullptr;
+  g_cstream_index_notes_tailp = &g_cstream_index_notes;
+
+  CstreamPipeStats* statsp = g_cstream_pipe_stats;
+  while (statsp) {
+    logputs_silent("--zst-pipeline: ");
+    logputs_silent(statsp->fname);
+    char stats_buf[256];
+    snprintf(stats_buf, 256, ": %u frame%s, %" PRIu64 " bytes; main thread stalled %u time%s (%.3fs); compressor busy %.3fs, idle %.3fs.\n", statsp->frame_ct, (statsp->frame_ct == 1)? "" : "s", statsp->dbyte_ct, statsp->main_stall_ct, (statsp->main_stall_ct == 1)? "" : "s", u63tod(statsp->main_stall_ns) * 1e-9, u63tod(statsp->compressor_busy_ns) * 1e-9, u63tod(statsp->compressor_idle_ns) * 1e-9);
+    logputs_silent(stats_buf);
+    CstreamPipeStats* next = statsp->next;
+    free(statsp);
+    statsp = next;
+  }
+  g_cstream_pipe_stats = nullptr;
+  g_cstream_pipe_stats_tailp = &g_cstream_pipe_stats;
+}
+
+// Hands the current slot to the compressor thread.
+static void CstreamPipeSubmit(uint32_t eof, CstreamPipe* pipe) {
+  CstreamPipeSlot* slot = &(pipe->slots[pipe->partial_slot_idx]);
+  slot->eof = eof;
+#ifdef _WIN32
+  slot->nbytes = pipe->partial_nbytes;
+  SetEvent(slot->filled_event);
+#else
+  pthread_mutex_lock(&(slot->mutex));
+  slot->nbytes = pipe->partial_nbytes;
+  pthread_cond_signal(&(slot->condvar));
+  pthread_mutex_unlock(&(slot->mutex));
+#endif
+}
+
+// Submits the current (full) slot, and waits for the next one to open up.
+static BoolErr CstreamPipeAdvance(CstreamPipe* pipe) {
+  CstreamPipeSubmit(0, pipe);
+  uint32_t slot_idx = pipe->partial_slot_idx + 1;
+  if (slot_idx == kCstreamPipeSlotCt) {
+    slot_idx = 0;
+  }
+  pipe->partial_slot_idx = slot_idx;
+  pipe->partial_nbytes = 0;
+  CstreamPipeSlot* slot = &(pipe->slots[slot_idx]);
+#ifdef _WIN32
+  if (WaitForSingleObject(slot->open_event, 0) != WAIT_OBJECT_0) {
+    const uint64_t start_ns = MonotonicNs();
+    WaitForSingleObject(slot->open_event, INFINITE);
+    pipe->main_stall_ns += MonotonicNs() - start_ns;
+    pipe->main_stall_ct += 1;
+  }
+#else
+  pthread_mutex_lock(&(slot->mutex));
+  if (slot->nbytes != UINT32_MAX) {
+    const uint64_t start_ns = MonotonicNs();
+    do {
+      pthread_cond_wait(&(slot->condvar), &(slot->mutex));
+    } while (slot->nbytes != UINT32_MAX);
+    pipe->main_stall_ns += MonotonicNs() - start_ns;
+    pipe->main_stall_ct += 1;
+  }
+  pthread_mutex_unlock(&(slot->mutex));
+#endif
+  // Safe to read now: the compressor thread only sets this before reopening a
+  // slot.
+  return (pipe->write_errno != 0);
+}
+
+static BoolErr CstreamPipeWrite(const char* buf, uintptr_t len, CstreamPipe* pipe) {
+  uint32_t dst_offset = pipe->partial_nbytes;
+  while (dst_offset + len >= kCompressStreamFrameBlen) {
+    const uint32_t ncopy = kCompressStreamFrameBlen - dst_offset;
+    memcpy(&(pipe->slots[pipe->partial_slot_idx].buf[dst_offset]), buf, ncopy);
+    pipe->partial_nbytes = kCompressStreamFrameBlen;
+    if (unlikely(CstreamPipeAdvance(pipe))) {
+      return 1;
+    }
+    buf = &(buf[ncopy]);
+    len -= ncopy;
+    dst_offset = 0;
+  }
+  memcpy(&(pipe->slots[pipe->partial_slot_idx].buf[dst_offset]), buf, len);
+  pipe->partial_nbytes = dst_offset + len;
+  return 0;
+}
+
+// Submits the final slot, joins the compressor thread, logs the stall
+// summary, and frees the pipe.  Returns 1 if any frame failed to compress or
+// write.
+static BoolErr CloseCstreamPipe(CompressStreamState* css_ptr) {
+  CstreamPipe* pipe = css_ptr->pipe;
+  CstreamPipeSubmit(1, pipe);
+#ifdef _WIN32
+  WaitForSingleObject(pipe->thread, INFINITE);
+  CloseHandle(pipe->thread);
+#else
+  pthread_join(pipe->thread, nullptr);
+#endif
+  // Summary is logged later, since we're probably in the middle of a
+  // "Writing... done." line.  Skip it if we're out of memory.
+  const uintptr_t fname_blen = strlen(pipe->fname) + 1;
+  CstreamPipeStats* statsp = S_CAST(CstreamPipeStats*, malloc(sizeof(CstreamPipeStats) + fname_blen));
+  if (statsp) {
+    statsp->next = nullptr;
+    statsp->fname = R_CAST(char*, &(statsp[1]));
+    memcpy(statsp->fname, pipe->fname, fname_blen);
+    statsp->frame_ct = pipe->frame_ct;
+    statsp->main_stall_ct = pipe->main_stall_ct;
+    statsp->dbyte_ct = pipe->dbyte_ct;
+    statsp->main_stall_ns = pipe->main_stall_ns;
+    statsp->compressor_busy_ns = pipe->compressor_busy_ns;
+    statsp->compressor_idle_ns = pipe->compressor_idle_ns;
+    *g_cstream_pipe_stats_tailp = statsp;
+    g_cstream_pipe_stats_tailp = &(statsp->next);
+  }
+  const int32_t write_errno = pipe->write_errno;
+  DestroyCstreamPipeSlots(kCstreamPipeSlotCt, pipe);
+  aligned_free(pipe);
+  css_ptr->pipe = nullptr;
+  if (write_errno) {
+    if (write_errno != -1) {
+      errno = write_errno;
+    }
+    return 1;
+  }
+  return 0;
+}
+
+PglErr InitCstreamZstd(const char* out_fname, uint32_t do_append, uint32_t thread_ct, uintptr_t overflow_buf_size, char* overflow_buf, unsigned char* compress_wkspace, CompressStreamState* css_ptr) {
   css_ptr->outfile = nullptr;
   css_ptr->cctx = ZSTD_createCCtx();
   if (unlikely(!css_ptr->cctx)) {
     return kPglRetNomem;
   }
-  __maybe_unused size_t retval = ZSTD_CCtx_setParameter(css_ptr->cctx, ZSTD_c_compressionLevel, g_zst_level);
+  const uint32_t pipe_thread_ct = g_zst_pipe_thread_ct;
+  if (pipe_thread_ct) {
+    // Pipelined mode: the compressor thread compresses one whole frame per
+    // ZSTD_compress2() call; with more than one thread requested, zstd's own
+    // workers split each frame.
+    thread_ct = (pipe_thread_ct > 1)? pipe_thread_ct : 0;
+  }
+  __maybe_unused size_t retval = ZSTD_CCtx_setParameter(css_ptr->cctx, ZSTD_c_compressionLevel, (pipe_thread_ct && g_zst_pipe_level)? g_zst_pipe_level : g_zst_level);
   assert(!ZSTD_isError(retval));
 #ifdef ZSTD_MULTITHREAD
   // ignore failure; if zstd is dynamically linked and was built without MT
   // support, so be it
   ZSTD_CCtx_setParameter(css_ptr->cctx, ZSTD_c_nbWorkers, thread_ct);
+  // Default job size exceeds kCompressStreamFrameBlen, which would serialize
+  // compression of each frame.
+  ZSTD_CCtx_setParameter(css_ptr->cctx, ZSTD_c_jobSize, kCompressStreamFrameBlen / 4);
 #endif
+  // Appending would bury the existing seek table mid-file, so don't bother
+  // writing a new one.
+  css_ptr->seek_table = nullptr;
+  css_ptr->seek_table_frame_ct = 0;
+  css_ptr->seek_table_frame_capacity = 64;
+  if (!do_append) {
+    css_ptr->seek_table = S_CAST(uint32_t*, malloc(css_ptr->seek_table_frame_capacity * 2 * sizeof(int32_t)));
+  }
+  css_ptr->frame_dbyte_ct = 0;
+  css_ptr->cbyte_ct = 0;
+  css_ptr->frame_cbyte_start = 0;
   css_ptr->outfile = fopen(out_fname, do_append? FOPEN_AB : FOPEN_WB);
   if (unlikely(!css_ptr->outfile)) {
     logputs("\n");
     logerrprintfww(kErrprintfFopen, out_fname, strerror(errno));
+    free_cond(css_ptr->seek_table);
     ZSTD_freeCCtx(css_ptr->cctx);  // might return an error later?
     return kPglRetOpenFail;
   }
@@ -61,6 +444,12 @@ PglErr InitCstreamZstd(const char* out_fname, uint32_t do_append, __maybe_unused
   css_ptr->output.size = CstreamWkspaceReq(overflow_buf_size);
   css_ptr->output.pos = 0;
   css_ptr->overflow_buf = overflow_buf;
+  css_ptr->pipe = nullptr;
+  css_ptr->bgz = nullptr;
+  if (pipe_thread_ct) {
+    // If this fails, we just compress on the main thread.
+    InitCstreamPipe(out_fname, css_ptr);
+  }
   return kPglRetSuccess;
 }
 
@@ -88,7 +477,96 @@ PglErr InitCstreamAlloc(const char* out_fname, uint32_t do_append, uint32_t outp
   return reterr;
 }
 
-BoolErr ForceUncompressedCswrite(CompressStreamState* css_ptr, char** writep_ptr) {
+PglErr InitCstreamBgz(const char* out_fname, uint32_t thread_ct, char* overflow_buf, CompressStreamState* css_ptr) {
+  css_ptr->outfile = nullptr;
+  css_ptr->cctx = nullptr;
+  css_ptr->seek_table = nullptr;
+  css_ptr->pipe = nullptr;
+  const uintptr_t fname_blen = strlen(out_fname) + 1;
+  CstreamBgz* bgz = S_CAST(CstreamBgz*, malloc(sizeof(CstreamBgz) + fname_blen));
+  css_ptr->bgz = bgz;
+  if (unlikely(!bgz)) {
+    return kPglRetNomem;
+  }
+  PreinitBgzfCompressStream(&bgz->bgzf);
+  PreinitBgzfIndexWriter(&bgz->iw);
+  bgz->fname = R_CAST(char*, &(bgz[1]));
+  memcpy(bgz->fname, out_fname, fname_blen);
+  PglErr reterr = InitBgzfCompressStreamEx(out_fname, 0, kBgzfDefaultClvl, thread_ct, &bgz->bgzf);
+  if (likely(!reterr)) {
+    reterr = AttachBgzfIndexWriter(&bgz->bgzf, &bgz->iw);
+  }
+  if (unlikely(reterr)) {
+    if (reterr == kPglRetOpenFail) {
+      logputs("\n");
+      logerrprintfww(kErrprintfFopen, out_fname, strerror(errno));
+    }
+    CleanupBgzfCompressStream(&bgz->bgzf, &reterr);
+    free(bgz);
+    css_ptr->bgz = nullptr;
+    return reterr;
+  }
+  css_ptr->overflow_buf = overflow_buf;
+  return kPglRetSuccess;
+}
+
+PglErr InitCstreamBgzAlloc(const char* out_fname, uint32_t thread_ct, uintptr_t overflow_buf_size, CompressStreamState* css_ptr, char** cswritepp) {
+  char* overflow_buf;
+  if (unlikely(bigstack_alloc_c(overflow_buf_size, &overflow_buf))) {
+    return kPglRetNomem;
+  }
+  PglErr reterr = InitCstreamBgz(out_fname, thread_ct, overflow_buf, css_ptr);
+  *cswritepp = overflow_buf;
+  return reterr;
+}
+
+// Flushes the remaining text, joins the compressor threads, and writes the
+// index.  An unindexable file is only a warning, but failure to write the
+// index is treated like any other write failure.
+static BoolErr CloseCstreamBgz(CompressStreamState* css_ptr, char* writep) {
+  CstreamBgz* bgz = css_ptr->bgz;
+  char* overflow_buf = css_ptr->overflow_buf;
+  css_ptr->overflow_buf = nullptr;
+  css_ptr->bgz = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  // Safe to ignore this error-return, since the write errno is also reported
+  // by CleanupBgzfCompressStream().
+  BgzfWrite(overflow_buf, writep - overflow_buf, &bgz->bgzf);
+  BoolErr write_fail = CleanupBgzfCompressStream(&bgz->bgzf, &reterr);
+  if ((!write_fail) && errno) {
+    write_fail = 1;
+  }
+  if (!write_fail) {
+    uint32_t is_csi = 0;
+    const char* errmsg = nullptr;
+    reterr = WriteBgzfIndex(bgz->fname, &bgz->iw, &is_csi, &errmsg);
+    if (!reterr) {
+      AppendCstreamIndexNote(0, bgz->fname, is_csi? ".csi" : ".tbi");
+    } else if (reterr == kPglRetSkipped) {
+      AppendCstreamIndexNote(1, bgz->fname, errmsg);
+    } else if (reterr == kPglRetNomem) {
+      AppendCstreamIndexNote(1, bgz->fname, "out of memory");
+    } else {
+      write_fail = 1;
+    }
+  }
+  CleanupBgzfIndexWriter(&bgz->iw);
+  free(bgz);
+  return write_fail;
+}
+
+// --perf-log write-time accounting.
+static inline uint64_t CstreamPerfStart() {
+  return g_thread_perf? MonotonicNs() : 0;
+}
+
+static inline void CstreamPerfStop(uint64_t start_ns) {
+  if (start_ns) {
+    AddThreadPerfIoNs(1, MonotonicNs() - start_ns);
+  }
+}
+
+static BoolErr ForceUncompressedCswriteUntimed(CompressStreamState* css_ptr, char** writep_ptr) {
   char* writep = *writep_ptr;
   if (css_ptr->overflow_buf != writep) {
     if (unlikely(!fwrite_unlocked(css_ptr->overflow_buf, writep - css_ptr->overflow_buf, 1, css_ptr->outfile))) {
@@ -99,21 +577,95 @@ BoolErr ForceUncompressedCswrite(CompressStreamState* css_ptr, char** writep_ptr
   return 0;
 }
 
-BoolErr ForceCompressedCswrite(CompressStreamState* css_ptr, char** writep_ptr) {
+static BoolErr CstreamFlushOutput(CompressStreamState* css_ptr) {
+  if (unlikely(!fwrite_unlocked(css_ptr->output.dst, css_ptr->output.pos, 1, css_ptr->outfile))) {
+    return 1;
+  }
+  css_ptr->cbyte_ct += css_ptr->output.pos;
+  css_ptr->output.pos = 0;
+  return 0;
+}
+
+// Finishes the current frame, and appends its entry to the seek table.
+static BoolErr CstreamZstdEndFrame(CompressStreamState* css_ptr) {
+  ZSTD_inBuffer input = {nullptr, 0, 0};
+  while (1) {
+    const size_t retval = ZSTD_compressStream2(css_ptr->cctx, &css_ptr->output, &input, ZSTD_e_end);
+    assert(!ZSTD_isError(retval));
+    if (!retval) {
+      break;
+    }
+    if (css_ptr->output.pos >= kCompressStreamBlock) {
+      if (unlikely(CstreamFlushOutput(css_ptr))) {
+        return 1;
+      }
+    }
+  }
+  const uint64_t frame_cbyte_end = css_ptr->cbyte_ct + css_ptr->output.pos;
+  // A single frame's compressed size can't exceed ~ZSTD_compressBound(4 MiB).
+  CstreamAppendSeekEntry(frame_cbyte_end - css_ptr->frame_cbyte_start, css_ptr->frame_dbyte_ct, css_ptr);
+  css_ptr->frame_cbyte_start = frame_cbyte_end;
+  css_ptr->frame_dbyte_ct = 0;
+  return 0;
+}
+
+// Single ZSTD_compressStream2() call which never crosses a frame boundary.
+static BoolErr CstreamZstdContinue(CompressStreamState* css_ptr, ZSTD_inBuffer* input_ptr) {
+  const size_t full_size = input_ptr->size;
+  const size_t start_pos = input_ptr->pos;
+  const uint32_t frame_bytes_avail = kCompressStreamFrameBlen - css_ptr->frame_dbyte_ct;
+  if (full_size - start_pos > frame_bytes_avail) {
+    input_ptr->size = start_pos + frame_bytes_avail;
+  }
+  __maybe_unused size_t retval = ZSTD_compressStream2(css_ptr->cctx, &css_ptr->output, input_ptr, ZSTD_e_continue);
+  assert(!ZSTD_isError(retval));
+  input_ptr->size = full_size;
+  css_ptr->frame_dbyte_ct += input_ptr->pos - start_pos;
+  if (css_ptr->output.pos >= kCompressStreamBlock) {
+    if (unlikely(CstreamFlushOutput(css_ptr))) {
+      return 1;
+    }
+  }
+  if (css_ptr->frame_dbyte_ct == kCompressStreamFrameBlen) {
+    return CstreamZstdEndFrame(css_ptr);
+  }
+  return 0;
+}
+
+BoolErr ForceUncompressedCswrite(CompressStreamState* css_ptr, char** writep_ptr) {
+  const uint64_t perf_start_ns = CstreamPerfStart();
+  const BoolErr reterr = ForceUncompressedCswriteUntimed(css_ptr, writep_ptr);
+  CstreamPerfStop(perf_start_ns);
+  return reterr;
+}
+
+static BoolErr ForceCompressedCswriteUntimed(CompressStreamState* css_ptr, char** writep_ptr) {
   char* overflow_buf = css_ptr->overflow_buf;
   char* writep = *writep_ptr;
+  if (css_ptr->bgz) {
+    if (overflow_buf != writep) {
+      if (unlikely(BgzfWrite(overflow_buf, writep - overflow_buf, &css_ptr->bgz->bgzf))) {
+        return 1;
+      }
+      *writep_ptr = overflow_buf;
+    }
+    return 0;
+  }
+  if (css_ptr->pipe) {
+    if (overflow_buf != writep) {
+      if (unlikely(CstreamPipeWrite(overflow_buf, writep - overflow_buf, css_ptr->pipe))) {
+        return 1;
+      }
+      *writep_ptr = overflow_buf;
+    }
+    return 0;
+  }
   if (overflow_buf != writep) {
     const uintptr_t in_size = writep - overflow_buf;
     ZSTD_inBuffer input = {overflow_buf, in_size, 0};
     while (1) {
-      // todo: conditionally support seekable files
-      __maybe_unused size_t retval = ZSTD_compressStream2(css_ptr->cctx, &css_ptr->output, &input, ZSTD_e_continue);
-      assert(!ZSTD_isError(retval));
-      if (css_ptr->output.pos >= kCompressStreamBlock) {
-        if (unlikely(!fwrite_unlocked(css_ptr->output.dst, css_ptr->output.pos, 1, css_ptr->outfile))) {
-          return 1;
-        }
-        css_ptr->output.pos = 0;
+      if (unlikely(CstreamZstdContinue(css_ptr, &input))) {
+        return 1;
       }
       const uintptr_t bytes_left = input.size - input.pos;
       if (bytes_left < kCompressStreamBlock) {
@@ -126,6 +678,13 @@ BoolErr ForceCompressedCswrite(CompressStreamState* css_ptr, char** writep_ptr)
   return 0;
 }
 
+BoolErr ForceCompressedCswrite(CompressStreamState* css_ptr, char** writep_ptr) {
+  const uint64_t perf_start_ns = CstreamPerfStart();
+  const BoolErr reterr = ForceCompressedCswriteUntimed(css_ptr, writep_ptr);
+  CstreamPerfStop(perf_start_ns);
+  return reterr;
+}
+
 BoolErr CsputsStd(const char* readp, uint32_t byte_ct, CompressStreamState* css_ptr, char** writep_ptr) {
   char* writep = *writep_ptr;
   char* overflow_buf = css_ptr->overflow_buf;
@@ -141,24 +700,38 @@ BoolErr CsputsStd(const char* readp, uint32_t byte_ct, CompressStreamState* css_
       byte_ct -= cur_write_space;
       cur_write_space = 2 * kCompressStreamBlock;
     }
+  } else if (css_ptr->bgz) {
+    if (byte_ct > cur_write_space) {
+      BgzfCompressStream* bgzfp = &css_ptr->bgz->bgzf;
+      if (unlikely(BgzfWrite(overflow_buf, writep - overflow_buf, bgzfp) ||
+                   BgzfWrite(readp, byte_ct, bgzfp))) {
+        return 1;
+      }
+      *writep_ptr = overflow_buf;
+      return 0;
+    }
+  } else if (css_ptr->pipe) {
+    // No need to stage large writes in overflow_buf.
+    if (byte_ct > cur_write_space) {
+      if (unlikely(CstreamPipeWrite(overflow_buf, writep - overflow_buf, css_ptr->pipe) ||
+                   CstreamPipeWrite(readp, byte_ct, css_ptr->pipe))) {
+        return 1;
+      }
+      *writep_ptr = overflow_buf;
+      return 0;
+    }
   } else {
     while (byte_ct > cur_write_space) {
       memcpy(writep, readp, cur_write_space);
       ZSTD_inBuffer input = {overflow_buf, 2 * kCompressStreamBlock, 0};
       while (1) {
-        // todo: conditionally support seekable files
-        __maybe_unused size_t retval = ZSTD_compressStream2(css_ptr->cctx, &css_ptr->output, &input, ZSTD_e_continue);
-        assert(!ZSTD_isError(retval));
-        if (css_ptr->output.pos >= kCompressStreamBlock) {
-          if (unlikely(!fwrite_unlocked(css_ptr->output.dst, css_ptr->output.pos, 1, css_ptr->outfile))) {
-            return 1;
-          }
-          css_ptr->output.pos = 0;
+        if (unlikely(CstreamZstdContinue(css_ptr, &input))) {
+          return 1;
         }
         const uintptr_t bytes_left = input.size - input.pos;
         if (bytes_left < kCompressStreamBlock) {
           memmove(overflow_buf, &(overflow_buf[2 * kCompressStreamBlock - bytes_left]), bytes_left);
-          writep = &(overflow_buf[retval]);
+          writep = &(overflow_buf[bytes_left]);
           break;
         }
       }
@@ -173,31 +746,66 @@ BoolErr CsputsStd(const char* readp, uint32_t byte_ct, CompressStreamState* css_
 }
 
 BoolErr UncompressedCswriteCloseNull(CompressStreamState* css_ptr, char* writep) {
-  ForceUncompressedCswrite(css_ptr, &writep);
+  const uint64_t perf_start_ns = CstreamPerfStart();
+  ForceUncompressedCswriteUntimed(css_ptr, &writep);
   css_ptr->overflow_buf = nullptr;
   int32_t ii = ferror_unlocked(css_ptr->outfile);
   int32_t jj = fclose(css_ptr->outfile);
+  CstreamPerfStop(perf_start_ns);
   return ii || jj;
 }
 
-BoolErr CompressedCswriteCloseNull(CompressStreamState* css_ptr, char* writep) {
+static BoolErr CompressedCswriteCloseNullUntimed(CompressStreamState* css_ptr, char* writep) {
+  if (css_ptr->bgz) {
+    return CloseCstreamBgz(css_ptr, writep);
+  }
   char* overflow_buf = css_ptr->overflow_buf;
   const uintptr_t in_size = writep - overflow_buf;
-  ZSTD_inBuffer input = {overflow_buf, in_size, 0};
   BoolErr reterr = 0;
-  while (1) {
-    __maybe_unused size_t retval = ZSTD_compressStream2(css_ptr->cctx, &css_ptr->output, &input, ZSTD_e_end);
-    assert(!ZSTD_isError(retval));
-    if (css_ptr->output.pos) {
-      if (unlikely(!fwrite_unlocked(css_ptr->output.dst, css_ptr->output.pos, 1, css_ptr->outfile))) {
+  if (css_ptr->pipe) {
+    // On write failure, this still sends the compressor thread its exit
+    // signal.
+    reterr = CstreamPipeWrite(overflow_buf, in_size, css_ptr->pipe);
+    reterr = CloseCstreamPipe(css_ptr) || reterr;
+  } else {
+    ZSTD_inBuffer input = {overflow_buf, in_size, 0};
+    while (input.pos != input.size) {
+      if (unlikely(CstreamZstdContinue(css_ptr, &input))) {
         reterr = 1;
+        break;
       }
-      css_ptr->output.pos = 0;
     }
-    if (!retval) {
-      break;
+    // Always emit at least one frame, so that empty output is still a valid
+    // .zst file.
+    if ((!reterr) && (css_ptr->frame_dbyte_ct || (!css_ptr->frame_cbyte_start))) {
+      reterr = CstreamZstdEndFrame(css_ptr);
+    }
+    if ((!reterr) && css_ptr->output.pos) {
+      reterr = CstreamFlushOutput(css_ptr);
     }
   }
+  uint32_t* seek_table = css_ptr->seek_table;
+  if (seek_table) {
+    if (!reterr) {
+      // Skippable frame, in the format of zstd's contrib/seekable_format.
+      const uint32_t frame_ct = css_ptr->seek_table_frame_ct;
+      uint32_t header[2];
+      header[0] = kZstSeekTableSkippableMagic;
+      header[1] = frame_ct * kZstSeekTableEntrySize + kZstSeekTableFooterSize;
+      unsigned char footer[kZstSeekTableFooterSize];
+      memcpy(footer, &frame_ct, sizeof(int32_t));
+      // no checksums
+      footer[4] = 0;
+      memcpy(&(footer[5]), &kZstSeekableMagic, sizeof(int32_t));
+      if (unlikely((!fwrite_unlocked(header, sizeof(header), 1, css_ptr->outfile)) ||
+                   (!fwrite_unlocked(seek_table, frame_ct * kZstSeekTableEntrySize, 1, css_ptr->outfile)) ||
+                   (!fwrite_unlocked(footer, kZstSeekTableFooterSize, 1, css_ptr->outfile)))) {
+        reterr = 1;
+      }
+    }
+    free(seek_table);
+    css_ptr->seek_table = nullptr;
+  }
   ZSTD_freeCCtx(css_ptr->cctx);  // might return an error later?
   css_ptr->overflow_buf = nullptr;
   int32_t ii = ferror_unlocked(css_ptr->outfile);
@@ -205,6 +813,13 @@ BoolErr CompressedCswriteCloseNull(CompressStreamState* css_ptr, char* writep) {
   return reterr || ii || jj;
 }
 
+BoolErr CompressedCswriteCloseNull(CompressStreamState* css_ptr, char* writep) {
+  const uint64_t perf_start_ns = CstreamPerfStart();
+  const BoolErr reterr = CompressedCswriteCloseNullUntimed(css_ptr, writep);
+  CstreamPerfStop(perf_start_ns);
+  return reterr;
+}
+
 BoolErr CswriteCloseNull(CompressStreamState* css_ptr, char* writep) {
   if (IsUncompressedCstream(css_ptr)) {
     return UncompressedCswriteCloseNull(css_ptr, writep);
@@ -19,10 +19,11 @@
 
 
 // Successor to plink 1.9 pigz.h.  Provides a basic manually-buffered output
-// stream interface for zstd compression.  Not multithreaded yet, but the
-// interface is identical to the old multithreaded gzipper so we'll be able to
-// upgrade the backend later without making significant changes to other code.
+// stream interface for zstd compression.  By default, compression happens on
+// the calling thread (with zstd's own worker pool); --zst-pipeline moves it to
+// a dedicated background thread, see CstreamPipe below.
 
+#include "include/plink2_bgzf.h"
 #include "include/plink2_zstfile.h"
 #include "plink2_cmdline.h"
 
@@ -36,6 +37,77 @@ extern uint32_t g_zst_level;
 // todo: test different values, may want to increase on at least OS X...
 CONSTI32(kCompressStreamBlock, 131072);
 
+// Zstd output is split into independent frames of this many uncompressed
+// bytes, and a seek table is appended on close (see plink2_zstfile.h), so that
+// TextStream can decompress the result with multiple threads.  Relative to a
+// single frame, this costs well under 1% of compression ratio at the default
+// level.
+CONSTI32(kCompressStreamFrameBlen, 4 * 1048576);
+static_assert(kCompressStreamFrameBlen <= kMaxZstMtFrameBlen, "kCompressStreamFrameBlen too large for multithreaded decoder.");
+
+// Pipelined mode (--zst-pipeline):
+// - The main thread copies each flushed block of text into one of
+//   kCstreamPipeSlotCt frame-sized slots (triple buffering).
+// - A dedicated compressor/writer thread compresses each full slot as one
+//   independent frame, with a zstd worker count and level that don't depend on
+//   --threads, writes it, and records it in the seek table.
+// - The main thread only blocks when every slot is still waiting to be
+//   compressed; those stalls (and the compressor thread's idle time) are
+//   counted per stream, and summarized in the log at the end of the run.
+CONSTI32(kCstreamPipeSlotCt, 3);
+
+// 0 = pipelining disabled.
+extern uint32_t g_zst_pipe_thread_ct;
+
+// 0 = use g_zst_level.
+extern uint32_t g_zst_pipe_level;
+
+typedef struct CstreamPipeSlotStruct {
+  char* buf;  // kCompressStreamFrameBlen bytes
+  uint32_t nbytes;  // UINT32_MAX = open, otherwise filled
+  uint32_t eof;
+#ifdef _WIN32
+  HANDLE filled_event;
+  HANDLE open_event;
+#else
+  pthread_mutex_t mutex;
+  pthread_cond_t condvar;
+#endif
+} CstreamPipeSlot;
+
+typedef struct CstreamPipeStruct {
+  CstreamPipeSlot slots[kCstreamPipeSlotCt];
+  pthread_t thread;
+  unsigned char* cbuf;
+  uintptr_t cbuf_size;
+
+  // Main thread only.
+  uint32_t partial_slot_idx;  // this slot must be open
+  uint32_t partial_nbytes;  // always < kCompressStreamFrameBlen
+  uint32_t main_stall_ct;
+  uint64_t main_stall_ns;
+
+  // Compressor thread only, until it's joined.
+  int32_t write_errno;
+  uint32_t frame_ct;
+  uint64_t dbyte_ct;
+  uint64_t compressor_busy_ns;
+  uint64_t compressor_idle_ns;
+
+  // For the log summary.
+  char* fname;
+} CstreamPipe;
+
+// BGZF mode (e.g. --freq bgz): text is handed to a multithreaded
+// BgzfCompressStream instead of zstd, and a tabix/CSI index is built from the
+// #CHROM/POS columns as it goes; see BgzfIndexWriter.  The index is written
+// on close, and the result is logged by LogCstreamNotes().
+typedef struct CstreamBgzStruct {
+  BgzfCompressStream bgzf;
+  BgzfIndexWriter iw;
+  char* fname;
+} CstreamBgz;
+
 typedef struct CompressStreamStateStruct {
   NONCOPYABLE(CompressStreamStateStruct);
   // Usually compress text, so appropriate to define this as char*.
@@ -44,10 +116,29 @@ typedef struct CompressStreamStateStruct {
   FILE* outfile;
   ZSTD_CCtx* cctx;
   ZSTD_outBuffer output;
+
+  // Seek table under construction: (compressed size, decompressed size) pairs
+  // for each finished frame.  nullptr when no table will be written (append
+  // mode, or a failed allocation; the latter just costs the reader its
+  // multithreading).
+  uint32_t* seek_table;
+  uint32_t seek_table_frame_ct;
+  uint32_t seek_table_frame_capacity;
+  uint32_t frame_dbyte_ct;
+  // Compressed bytes written so far, and where the current frame started.
+  uint64_t cbyte_ct;
+  uint64_t frame_cbyte_start;
+
+  // nullptr unless pipelined.  In that case, the other zstd fields above
+  // belong to the compressor thread until it's joined.
+  CstreamPipe* pipe;
+
+  // nullptr unless BGZF.  cctx and outfile are unused in that case.
+  CstreamBgz* bgz;
 } CompressStreamState;
 
 HEADER_INLINE uint32_t IsUncompressedCstream(const CompressStreamState* css_ptr) {
-  return (css_ptr->cctx == nullptr);
+  return (css_ptr->cctx == nullptr) && (css_ptr->bgz == nullptr);
 }
 
 HEADER_INLINE void PreinitCstream(CompressStreamState* css_ptr) {
@@ -60,6 +151,15 @@ HEADER_INLINE uintptr_t CstreamWkspaceReq(uintptr_t overflow_buf_size) {
   return kCompressStreamBlock + MAXV(ZSTD_compressBound(overflow_buf_size), ZSTD_CStreamOutSize());
 }
 
+// Bytes InitCstreamAlloc() takes from the bottom of g_bigstack.
+HEADER_INLINE uintptr_t CstreamAllocReq(uintptr_t overflow_buf_size, uint32_t output_zst) {
+  uintptr_t byte_ct = RoundUpPow2(overflow_buf_size, kCacheline);
+  if (output_zst) {
+    byte_ct += RoundUpPow2(CstreamWkspaceReq(overflow_buf_size), kCacheline);
+  }
+  return byte_ct;
+}
+
 // overflow_buf must have space for at least kCompressStreamBlock + [max bytes
 // added between cswrite() calls] bytes.
 // compress_wkspace can be nullptr in no-compression case; otherwise it must
@@ -69,6 +169,13 @@ PglErr InitCstream(const char* out_fname, uint32_t do_append, uint32_t output_zs
 // Convenience interface which allocates from the bottom of g_bigstack.
 PglErr InitCstreamAlloc(const char* out_fname, uint32_t do_append, uint32_t output_zst, uint32_t thread_ct, uintptr_t overflow_buf_size, CompressStreamState* css_ptr, char** cswritepp);
 
+// BGZF output, with compression on thread_ct threads (clipped to
+// [1, kMaxBgzfCompressThreads]).  overflow_buf has the same requirements as
+// in the zstd case, but no compression workspace is needed.
+PglErr InitCstreamBgz(const char* out_fname, uint32_t thread_ct, char* overflow_buf, CompressStreamState* css_ptr);
+
+PglErr InitCstreamBgzAlloc(const char* out_fname, uint32_t thread_ct, uintptr_t overflow_buf_size, CompressStreamState* css_ptr, char** cswritepp);
+
 BoolErr ForceUncompressedCswrite(CompressStreamState* css_ptr, char** writep_ptr);
 
 // No longer guaranteed to consume entire input buffer, only reduces it to
@@ -113,6 +220,11 @@ HEADER_INLINE void CswriteCloseCond(CompressStreamState* css_ptr, char* writep)
   }
 }
 
+// Logs the results of BGZF index construction, and writes one (log-only) line
+// per pipelined stream, for streams closed since the last call; then clears
+// the lists.
+void LogCstreamNotes();
+
 
 #ifdef __cplusplus
 }  // namespace plink2
@@ -1,5 +1,5 @@
 // Mostly copied from libdeflate/lib/x86/cpu_features.c , except that we're
-// interested in different features (SSE4.2, AVX2).
+// interested in different features (SSE4.2, AVX2, AVX-512 VPOPCNTDQ).
 //
 // It's currently just used to print a more informative error message when e.g.
 // the AVX2 build is run on a machine that doesn't support it.  As a
@@ -35,7 +35,14 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#if defined(CPU_CHECK_SSE42) || defined(CPU_CHECK_AVX2)
+#if defined(CPU_CHECK_SSE42) || defined(CPU_CHECK_AVX2) || defined(CPU_CHECK_AVX512)
+
+#  ifdef CPU_CHECK_AVX512
+// AVX-512 build also requires everything the AVX2 build does.
+#    ifndef CPU_CHECK_AVX2
+#      define CPU_CHECK_AVX2
+#    endif
+#  endif
 
 #  include <stdio.h>
 #  include <stdlib.h>
@@ -120,6 +127,16 @@ int main(int argc, char** argv) {
     goto CpuCheck_ret_AVX2_FAIL;
   }
 #  endif
+#  ifdef CPU_CHECK_AVX512
+  // OS must save opmask, ZMM0-15 upper halves, and ZMM16-31 (XCR0 bits 5-7)
+  // bit 16 of EBX = AVX512F
+  // bit 14 of ECX = AVX512_VPOPCNTDQ
+  if (unlikely(((read_xcr(0) & 0xe0) != 0xe0) ||
+               (!(features_3 & 0x10000)) ||
+               (!(features_4 & 0x4000)))) {
+    goto CpuCheck_ret_AVX512_FAIL;
+  }
+#  endif
 
   return RealMain(argc, argv);
  CpuCheck_ret_SSE42_FAIL:
@@ -133,5 +150,10 @@ int main(int argc, char** argv) {
   fputs("Error: This plink2 build requires a processor which supports AVX2/Haswell\ninstructions, but only SSE4.2 is available.  Try a plain 64-bit build instead,\nor use the build_dynamic/ Makefile to produce a binary that takes advantage of\nSSE4.2 instructions but not AVX2.\n", stderr);
   exit(13);
 #  endif
+#  ifdef CPU_CHECK_AVX512
+ CpuCheck_ret_AVX512_FAIL:
+  fputs("Error: This plink2 build requires a processor which supports AVX-512\nVPOPCNTDQ instructions (e.g. Ice Lake or later), but only AVX2 is available.\nTry an AVX2 build instead.\n", stderr);
+  exit(13);
+#  endif
 }
-#endif  // CPU_CHECK_SSE42 || CPU_CHECK_AVX2
+#endif  // CPU_CHECK_SSE42 || CPU_CHECK_AVX2 || CPU_CHECK_AVX512
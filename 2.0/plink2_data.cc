@@ -546,7 +546,11 @@ PglErr WritePvar(const char* outname, const uintptr_t* variant_include, const Ch
       overflow_buf_size = 2 * kCompressStreamBlock;
     }
     const uint32_t output_zst = (pvar_psam_flags / kfPvarZs) & 1;
-    reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    if (pvar_psam_flags & kfPvarBgz) {
+      reterr = InitCstreamBgzAlloc(outname, thread_ct, overflow_buf_size, &css, &cswritep);
+    } else {
+      reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    }
     if (unlikely(reterr)) {
       goto WritePvar_ret_1;
     }
@@ -2486,6 +2490,109 @@ THREAD_FUNC_DECL LoadAlleleAndGenoCountsThread(void* raw_arg) {
   THREAD_RETURN;
 }
 
+static void AllelePresentsBytearrToBitarr(const unsigned char* allele_presents_bytearr, uintptr_t raw_allele_ct, uintptr_t* allele_presents) {
+  const uintptr_t raw_allele_ctl = BitCtToWordCt(raw_allele_ct);
+  allele_presents[raw_allele_ctl - 1] = 0;
+#ifdef __LP64__
+  const uintptr_t vec_ct = DivUp(raw_allele_ct, kBytesPerVec);
+  const VecUc* bytearr_alias = R_CAST(const VecUc*, allele_presents_bytearr);
+  Vec8thUint* allele_presents_alias = R_CAST(Vec8thUint*, allele_presents);
+  for (uintptr_t vec_idx = 0; vec_idx != vec_ct; ++vec_idx) {
+    allele_presents_alias[vec_idx] = vecuc_movemask(bytearr_alias[vec_idx]);
+  }
+#else
+  const uintptr_t twovec_ct = DivUp(raw_allele_ct, 8);
+  const uintptr_t* bytearr_iter = R_CAST(const uintptr_t*, allele_presents_bytearr);
+  unsigned char* allele_presents_iter = R_CAST(unsigned char*, allele_presents);
+  unsigned char* allele_presents_stop = &(allele_presents_iter[twovec_ct]);
+  for (; allele_presents_iter != allele_presents_stop; ++allele_presents_iter) {
+    // 31,23,15,7 -> 3,2,1,0: multiply by number with bits 0,7,14,21 set, then
+    // right-shift
+    uintptr_t cur_word = ((*bytearr_iter++) * 0x204081) >> 28;
+    cur_word |= ((*bytearr_iter++) * 0x204081) >> 24;
+    *allele_presents_iter = cur_word;
+  }
+#endif
+}
+
+// Fills the requested counts for every variant covered by pgfip->vsums (see
+// PgfiAttachVariantSummary()), and clears those variants from
+// variant_include_remaining.  Only valid when all samples are selected and no
+// founder-subset or imputation-r2 pass is needed.  chrX and chrY variants are
+// left for the main loop, since they require sex-specific counts.
+static uint32_t FillCountsFromVariantSummary(const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const PgenVariantSummary* vsums, uint32_t variant_ct, uint32_t sample_ct, uint32_t first_hap_uidx, uint32_t no_multiallelic_branch, unsigned char* allele_presents_bytearr, uint64_t* allele_ddosages, uint32_t* variant_missing_hc_cts, uint32_t* variant_missing_dosage_cts, uint32_t* variant_hethap_cts, STD_ARRAY_PTR_DECL(uint32_t, 3, raw_geno_cts), uintptr_t* variant_include_remaining) {
+  const uint32_t x_code = cip->xymt_codes[kChrOffsetX];
+  const uint32_t y_code = cip->xymt_codes[kChrOffsetY];
+  uintptr_t variant_uidx_base = 0;
+  uintptr_t cur_bits = variant_include[0];
+  uint32_t chr_end = 0;
+  uint32_t is_x_or_y = 0;
+  uint32_t is_nonxy_haploid = 0;
+  uint32_t summarized_ct = 0;
+  for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+    const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &cur_bits);
+    if (variant_uidx >= chr_end) {
+      const uint32_t chr_fo_idx = GetVariantChrFoIdx(cip, variant_uidx);
+      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+      chr_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+      is_x_or_y = (chr_idx == x_code) || (chr_idx == y_code);
+      is_nonxy_haploid = IsSet(cip->haploid_mask, chr_idx);
+    }
+    if (is_x_or_y) {
+      continue;
+    }
+    uintptr_t cur_allele_idx_offset = 2 * variant_uidx;
+    if (allele_idx_offsets) {
+      cur_allele_idx_offset = allele_idx_offsets[variant_uidx];
+      if ((allele_idx_offsets[variant_uidx + 1] - cur_allele_idx_offset != 2) && (!no_multiallelic_branch)) {
+        continue;
+      }
+    }
+    const PgenVariantSummary* vsump = &(vsums[variant_uidx]);
+    const uint64_t dosage0 = vsump->dosage_sums[0];
+    const uint64_t dosage1 = vsump->dosage_sums[1];
+    if (allele_presents_bytearr) {
+      if (dosage0) {
+        allele_presents_bytearr[cur_allele_idx_offset] = 128;
+      }
+      if (dosage1) {
+        allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
+      }
+    }
+    uint32_t hethap_ct = 0;
+    if (!is_nonxy_haploid) {
+      if (allele_ddosages) {
+        allele_ddosages[cur_allele_idx_offset] = dosage0 * 2;
+        allele_ddosages[cur_allele_idx_offset + 1] = dosage1 * 2;
+      }
+    } else {
+      hethap_ct = vsump->geno_cts[1];
+      if (allele_ddosages) {
+        allele_ddosages[cur_allele_idx_offset] = dosage0;
+        allele_ddosages[cur_allele_idx_offset + 1] = dosage1;
+      }
+    }
+    if (variant_missing_dosage_cts) {
+      variant_missing_dosage_cts[variant_uidx] = sample_ct - ((dosage0 + dosage1) / kDosageMax);
+    }
+    if (raw_geno_cts) {
+      STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
+      cur_raw_geno_cts[0] = vsump->geno_cts[0];
+      cur_raw_geno_cts[1] = vsump->geno_cts[1];
+      cur_raw_geno_cts[2] = vsump->geno_cts[2];
+    }
+    if (variant_missing_hc_cts) {
+      variant_missing_hc_cts[variant_uidx] = vsump->geno_cts[3];
+      if (variant_hethap_cts && (variant_uidx >= first_hap_uidx)) {
+        variant_hethap_cts[variant_uidx - first_hap_uidx] = hethap_ct;
+      }
+    }
+    ClearBit(variant_uidx, variant_include_remaining);
+    ++summarized_ct;
+  }
+  return summarized_ct;
+}
+
 PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t* founder_info, const uintptr_t* sex_nm, const uintptr_t* sex_male, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t founder_ct, uint32_t male_ct, uint32_t nosex_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t first_hap_uidx, uint32_t is_minimac3_r2, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, uintptr_t* allele_presents, uint64_t* allele_ddosages, uint64_t* founder_allele_ddosages, uint32_t* variant_missing_hc_cts, uint32_t* variant_missing_dosage_cts, uint32_t* variant_hethap_cts, STD_ARRAY_PTR_DECL(uint32_t, 3, raw_geno_cts), STD_ARRAY_PTR_DECL(uint32_t, 3, founder_raw_geno_cts), STD_ARRAY_PTR_DECL(uint32_t, 3, x_male_geno_cts), STD_ARRAY_PTR_DECL(uint32_t, 3, founder_x_male_geno_cts), STD_ARRAY_PTR_DECL(uint32_t, 3, x_nosex_geno_cts), STD_ARRAY_PTR_DECL(uint32_t, 3, founder_x_nosex_geno_cts), double* imp_r2_vals) {
   unsigned char* bigstack_mark = g_bigstack_base;
   unsigned char* bigstack_end_mark = g_bigstack_end;
@@ -2668,6 +2775,25 @@ PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t*
     } else {
       ctx.allele_presents_bytearr = nullptr;
     }
+    if (pgfip->vsums && (ctx.sample_ct == raw_sample_ct) && (!ctx.founder_info) && (!imp_r2_vals)) {
+      const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+      uintptr_t* variant_include_remaining;
+      if (unlikely(bigstack_alloc_w(raw_variant_ctl, &variant_include_remaining))) {
+        goto LoadAlleleAndGenoCounts_ret_NOMEM;
+      }
+      memcpy(variant_include_remaining, variant_include, raw_variant_ctl * sizeof(intptr_t));
+      const uint32_t no_multiallelic_branch = (!variant_hethap_cts) && (!allele_presents) && (!ctx.allele_ddosages);
+      const uint32_t summarized_ct = FillCountsFromVariantSummary(variant_include, cip, allele_idx_offsets, pgfip->vsums, variant_ct, raw_sample_ct, first_hap_uidx, no_multiallelic_branch, ctx.allele_presents_bytearr, ctx.allele_ddosages, variant_missing_hc_cts, variant_missing_dosage_cts, variant_hethap_cts, ctx.raw_geno_cts, variant_include_remaining);
+      if (summarized_ct == variant_ct) {
+        if (allele_presents) {
+          AllelePresentsBytearrToBitarr(ctx.allele_presents_bytearr, raw_allele_ct, allele_presents);
+        }
+        logputs("Calculating allele frequencies... done.\n");
+        goto LoadAlleleAndGenoCounts_ret_1;
+      }
+      variant_include = variant_include_remaining;
+      variant_ct -= summarized_ct;
+    }
 
     uint32_t unused_chr_code;
     uint32_t unused_chr_code2;
@@ -2763,28 +2889,7 @@ PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t*
       pgfip->block_base = main_loadbufs[parity];
     }
     if (allele_presents) {
-      const uintptr_t raw_allele_ctl = BitCtToWordCt(raw_allele_ct);
-      allele_presents[raw_allele_ctl - 1] = 0;
-#ifdef __LP64__
-      const uintptr_t vec_ct = DivUp(raw_allele_ct, kBytesPerVec);
-      VecUc* bytearr_alias = R_CAST(VecUc*, ctx.allele_presents_bytearr);
-      Vec8thUint* allele_presents_alias = R_CAST(Vec8thUint*, allele_presents);
-      for (uintptr_t vec_idx = 0; vec_idx != vec_ct; ++vec_idx) {
-        allele_presents_alias[vec_idx] = vecuc_movemask(bytearr_alias[vec_idx]);
-      }
-#else
-      const uintptr_t twovec_ct = DivUp(raw_allele_ct, 8);
-      uintptr_t* bytearr_iter = R_CAST(uintptr_t*, ctx.allele_presents_bytearr);
-      unsigned char* allele_presents_iter = R_CAST(unsigned char*, allele_presents);
-      unsigned char* allele_presents_stop = &(allele_presents_iter[twovec_ct]);
-      for (; allele_presents_iter != allele_presents_stop; ++allele_presents_iter) {
-        // 31,23,15,7 -> 3,2,1,0: multiply by number with bits 0,7,14,21 set,
-        // then right-shift
-        uintptr_t cur_word = ((*bytearr_iter++) * 0x204081) >> 28;
-        cur_word |= ((*bytearr_iter++) * 0x204081) >> 24;
-        *allele_presents_iter = cur_word;
-      }
-#endif
+      AllelePresentsBytearrToBitarr(ctx.allele_presents_bytearr, raw_allele_ct, allele_presents);
     }
     if (pct > 10) {
       putc_unlocked('\b', stdout);
@@ -3831,7 +3936,11 @@ PglErr WritePvarSplit(const char* outname, const uintptr_t* variant_include, con
       overflow_buf_size = 2 * kCompressStreamBlock;
     }
     const uint32_t output_zst = (pvar_psam_flags / kfPvarZs) & 1;
-    reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    if (pvar_psam_flags & kfPvarBgz) {
+      reterr = InitCstreamBgzAlloc(outname, thread_ct, overflow_buf_size, &css, &cswritep);
+    } else {
+      reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    }
     if (unlikely(reterr)) {
       goto WritePvarSplit_ret_1;
     }
@@ -4472,7 +4581,11 @@ PglErr WritePvarJoin(const char* outname, const uintptr_t* variant_include, cons
       overflow_buf_size = 2 * kCompressStreamBlock;
     }
     const uint32_t output_zst = (pvar_psam_flags / kfPvarZs) & 1;
-    reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    if (pvar_psam_flags & kfPvarBgz) {
+      reterr = InitCstreamBgzAlloc(outname, thread_ct, overflow_buf_size, &css, &cswritep);
+    } else {
+      reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    }
     if (unlikely(reterr)) {
       goto WritePvarJoin_ret_1;
     }
@@ -5847,17 +5960,10 @@ THREAD_FUNC_DECL MakePgenThread(void* raw_arg) {
       ZeroTrailingNyps(sample_ct, write_genovec);
       // todo: --set-me-missing, --zero-cluster, --fill-missing-with-ref
       if (spgwp) {
-        if (pwcp->fwrite_bufp >= &(pwcp->fwrite_buf[kPglFwriteBlockSize])) {
-          const uintptr_t cur_byte_ct = pwcp->fwrite_bufp - pwcp->fwrite_buf;
-          if (unlikely(fwrite_checked(pwcp->fwrite_buf, cur_byte_ct, GET_PRIVATE(*spgwp, pgen_outfile)))) {
-            ctx->write_reterr = kPglRetWriteFail;
-            ctx->write_errno = errno;
-            break;
-          }
-          // printf("vblock_fpos_offset: %llu\n", pwcp->vblock_fpos_offset);
-          pwcp->vblock_fpos_offset += cur_byte_ct;
-          // printf("%u %llu\n", write_idx + variant_idx_offset, pwcp->vblock_fpos_offset);
-          pwcp->fwrite_bufp = pwcp->fwrite_buf;
+        if (unlikely(SpgwFlush(spgwp))) {
+          ctx->write_reterr = kPglRetWriteFail;
+          ctx->write_errno = errno;
+          break;
         }
       }
       if ((!write_rare01_ct) && (!write_rare10_ct)) {
@@ -6161,6 +6267,29 @@ PglErr MakePgenRobust(const uintptr_t* sample_include, const uint32_t* new_sampl
         goto MakePgenRobust_ret_NOMEM;
       }
       SpgwInitPhase2(max_vrec_len, ctx.spgwp, spgw_alloc);
+      if (make_plink2_flags & kfMakePgenVsum) {
+        PgenVariantSummary* vsums = S_CAST(PgenVariantSummary*, bigstack_alloc(write_variant_ct * sizeof(PgenVariantSummary)));
+        char* vsum_fname;
+        if (unlikely((!vsums) ||
+                     bigstack_alloc_c(strlen(outname) + 6, &vsum_fname))) {
+          goto MakePgenRobust_ret_NOMEM;
+        }
+        snprintf(strcpya(vsum_fname, outname), 6, ".vsum");
+        SpgwEnableVariantSummary(vsum_fname, vsums, ctx.spgwp);
+      }
+      if (make_plink2_flags & kfMakePgenLdSearch) {
+        unsigned char* ld_search_alloc;
+        if (unlikely(bigstack_alloc_uc(PgenLdSearchCachelineCt(sample_ct, kPglLdSearchWindowDefault) * kCacheline, &ld_search_alloc))) {
+          goto MakePgenRobust_ret_NOMEM;
+        }
+        SpgwEnableLdSearch(kPglLdSearchWindowDefault, ld_search_alloc, ctx.spgwp);
+      }
+      if (make_plink2_flags & kfMakePgenZs) {
+        reterr = SpgwEnableZstd(g_zst_level, 1, ctx.spgwp);
+        if (unlikely(reterr)) {
+          goto MakePgenRobust_ret_1;
+        }
+      }
 
       const uint32_t sample_ctl2 = NypCtToWordCt(sample_ct);
       const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
@@ -6827,7 +6956,10 @@ PglErr MakePgenRobust(const uintptr_t* sample_include, const uint32_t* new_sampl
           }
         }
       }
-      SpgwFinish(ctx.spgwp);
+      reterr = SpgwFinish(ctx.spgwp);
+      if (unlikely(reterr)) {
+        goto MakePgenRobust_ret_WRITE_FAIL;
+      }
       if (pct > 10) {
         putc_unlocked('\b', stdout);
       }
@@ -6842,6 +6974,9 @@ PglErr MakePgenRobust(const uintptr_t* sample_include, const uint32_t* new_sampl
   MakePgenRobust_ret_PGR_FAIL:
     PgenErrPrintN(reterr);
     break;
+  MakePgenRobust_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
   MakePgenRobust_ret_THREAD_CREATE_FAIL:
     reterr = kPglRetThreadCreateFail;
     break;
@@ -6953,7 +7088,7 @@ PglErr MakePlink2NoVsort(const uintptr_t* sample_include, const PedigreeIdInfo*
       logputs("done.\n");
     }
     if (make_plink2_flags & kfMakePvar) {
-      OutnameZstSet(".pvar", pvar_psam_flags & kfPvarZs, outname_end);
+      OutnameCstreamSet(".pvar", pvar_psam_flags & kfPvarZs, pvar_psam_flags & kfPvarBgz, outname_end);
       logprintfww5("Writing %s ... ", outname);
       fflush(stdout);
       uint32_t nonref_flags_storage = 3;
@@ -7217,6 +7352,22 @@ PglErr MakePlink2NoVsort(const uintptr_t* sample_include, const PedigreeIdInfo*
           bigstack_alloc_wp(calc_thread_ct, &(ctx.loadbuf_thread_starts[1]))) {
         goto MakePlink2NoVsort_fallback;
       }
+      PgenVariantSummary* vsums = nullptr;
+      char* vsum_fname = nullptr;
+      if (make_plink2_flags & kfMakePgenVsum) {
+        vsums = S_CAST(PgenVariantSummary*, bigstack_alloc(variant_ct * sizeof(PgenVariantSummary)));
+        // outname + ".pgen.vsum"
+        if ((!vsums) ||
+            bigstack_alloc_c(S_CAST(uintptr_t, outname_end - outname) + 11, &vsum_fname)) {
+          goto MakePlink2NoVsort_fallback;
+        }
+      }
+      unsigned char* ld_search_alloc = nullptr;
+      if (make_plink2_flags & kfMakePgenLdSearch) {
+        if (bigstack_alloc_uc(PgenLdSearchCachelineCt(sample_ct, kPglLdSearchWindowDefault) * kCacheline * calc_thread_ct, &ld_search_alloc)) {
+          goto MakePlink2NoVsort_fallback;
+        }
+      }
       uint32_t nonref_flags_storage = 3;
       uintptr_t* nonref_flags_write = pgfip->nonref_flags;
       if (!nonref_flags_write) {
@@ -7400,6 +7551,19 @@ PglErr MakePlink2NoVsort(const uintptr_t* sample_include, const PedigreeIdInfo*
         }
         goto MakePlink2NoVsort_ret_1;
       }
+      if (vsums) {
+        snprintf(strcpya(vsum_fname, outname), 6, ".vsum");
+        MpgwEnableVariantSummary(vsum_fname, vsums, mpgwp);
+      }
+      if (ld_search_alloc) {
+        MpgwEnableLdSearch(kPglLdSearchWindowDefault, ld_search_alloc, mpgwp);
+      }
+      if (make_plink2_flags & kfMakePgenZs) {
+        reterr = MpgwEnableZstd(g_zst_level, max_thread_ct, mpgwp);
+        if (unlikely(reterr)) {
+          goto MakePlink2NoVsort_ret_1;
+        }
+      }
       if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
         goto MakePlink2NoVsort_ret_NOMEM;
       }
@@ -7930,7 +8094,11 @@ PglErr WritePvarResorted(const char* outname, const uintptr_t* variant_include,
       overflow_buf_size = 2 * kCompressStreamBlock;
     }
     const uint32_t output_zst = (pvar_psam_flags / kfPvarZs) & 1;
-    reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    if (pvar_psam_flags & kfPvarBgz) {
+      reterr = InitCstreamBgzAlloc(outname, thread_ct, overflow_buf_size, &css, &cswritep);
+    } else {
+      reterr = InitCstreamAlloc(outname, 0, output_zst, thread_ct, overflow_buf_size, &css, &cswritep);
+    }
     if (unlikely(reterr)) {
       goto WritePvarResorted_ret_1;
     }
@@ -8305,7 +8473,7 @@ PglErr MakePlink2Vsort(const uintptr_t* sample_include, const PedigreeIdInfo* pi
       logputs("done.\n");
     }
     if (make_plink2_flags & kfMakePvar) {
-      OutnameZstSet(".pvar", pvar_psam_flags & kfPvarZs, outname_end);
+      OutnameCstreamSet(".pvar", pvar_psam_flags & kfPvarZs, pvar_psam_flags & kfPvarBgz, outname_end);
       logprintfww5("Writing %s ... ", outname);
       fflush(stdout);
       uint32_t nonref_flags_storage = 3;
@@ -55,7 +55,11 @@ FLAGSET_DEF_START()
   kfMakePgenFormatBase = (1 << 18), // two bits
   kfMakePgenErasePhase = (1 << 20),
   kfMakePgenEraseDosage = (1 << 21),
-  kfMakePgenFillMissingFromDosage = (1 << 22)
+  kfMakePgenFillMissingFromDosage = (1 << 22),
+  kfMakePgenIndex = (1 << 23),
+  kfMakePgenVsum = (1 << 24),
+  kfMakePgenLdSearch = (1 << 25),
+  kfMakePgenZs = (1 << 26)
 FLAGSET_DEF_END(MakePlink2Flags);
 
 FLAGSET_DEF_START()
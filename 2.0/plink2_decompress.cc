@@ -29,13 +29,22 @@ PglErr InitTextStreamEx(const char* fname, uint32_t alloc_at_end, uint32_t enfor
   }
   char* dst;
   if (!alloc_at_end) {
-    dst = S_CAST(char*, bigstack_alloc_raw(dst_capacity));
+    dst = S_CAST(char*, BigstackAllocElastic(dst_capacity));
   } else {
-    dst = S_CAST(char*, bigstack_end_alloc_raw(dst_capacity));
+    dst = S_CAST(char*, BigstackEndAllocElastic(dst_capacity));
   }
   return TextStreamOpenEx(fname, enforced_max_line_blen, dst_capacity, decompress_thread_ct, nullptr, dst, txsp);
 }
 
+PglErr InitReadonlyTokenStream(const char* fname, uint32_t decompress_thread_ct, TokenStream* tksp) {
+  const uint32_t dst_capacity = kTokenStreamBlen;
+  if (unlikely(dst_capacity > bigstack_left())) {
+    return kPglRetNomem;
+  }
+  char* dst = S_CAST(char*, bigstack_alloc_raw(dst_capacity));
+  return TextStreamOpenReadonlyEx(fname, 0, dst_capacity, decompress_thread_ct, dst, &(tksp->txs));
+}
+
 void TextErrPrint(const char* file_descrip, const char* errmsg, PglErr reterr) {
   assert(reterr != kPglRetSuccess);
   if (reterr == kPglRetOpenFail) {
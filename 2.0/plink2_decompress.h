@@ -130,6 +130,10 @@ HEADER_INLINE PglErr InitTokenStream(const char* fname, uint32_t decompress_thre
   return InitTextStreamEx(fname, 0, 0, kTokenStreamBlen - kDecompressChunkSize, decompress_thread_ct, &(tksp->txs));
 }
 
+// For consumers which never modify the tokens in place; see
+// TextStreamOpenReadonlyEx().
+PglErr InitReadonlyTokenStream(const char* fname, uint32_t decompress_thread_ct, TokenStream* tksp);
+
 HEADER_INLINE void TokenStreamErrPrint(const char* file_descrip, const TokenStream* tksp) {
   PglErr reterr = TokenStreamErrcode(tksp);
   const char* errmsg = TokenStreamError(tksp);
@@ -4342,8 +4342,10 @@ PglErr ExportVcf(const uintptr_t* sample_include, const uint32_t* sample_include
   PglErr reterr = kPglRetSuccess;
   TextStream pvar_reload_txs;
   BgzfCompressStream bgzf;
+  BgzfIndexWriter bgzf_iw;
   PreinitTextStream(&pvar_reload_txs);
   PreinitBgzfCompressStream(&bgzf);
+  PreinitBgzfIndexWriter(&bgzf_iw);
   {
     {
       uint32_t clvl = 0;
@@ -4360,6 +4362,14 @@ PglErr ExportVcf(const uintptr_t* sample_include, const uint32_t* sample_include
         }
         goto ExportVcf_ret_1;
       }
+      // Build a tabix index alongside the .vcf.gz, unless we already know the
+      // positions are out of order.
+      if (clvl && (vpos_sortstatus == kfUnsortedVar0)) {
+        reterr = AttachBgzfIndexWriter(&bgzf, &bgzf_iw);
+        if (unlikely(reterr)) {
+          goto ExportVcf_ret_1;
+        }
+      }
     }
     const uint32_t max_chr_blen = GetMaxChrSlen(cip) + 1;
     // CHROM, POS, ID, REF, one ALT, eoln
@@ -6165,6 +6175,22 @@ PglErr ExportVcf(const uintptr_t* sample_include, const uint32_t* sample_include
     }
     fputs("\b\b", stdout);
     logputs("done.\n");
+    if ((exportf_flags & kfExportfBgz) && (vpos_sortstatus == kfUnsortedVar0)) {
+      uint32_t is_csi;
+      const char* errmsg = nullptr;
+      reterr = WriteBgzfIndex(outname, &bgzf_iw, &is_csi, &errmsg);
+      if (!reterr) {
+        logprintfww("Index written to %s%s .\n", outname, is_csi? ".csi" : ".tbi");
+      } else if (reterr == kPglRetSkipped) {
+        logerrprintfww("Warning: %s not indexed (%s).\n", outname, errmsg);
+        reterr = kPglRetSuccess;
+      } else {
+        if ((reterr != kPglRetNomem) && errmsg) {
+          logerrprintfww("Error: Failed to write index for %s: %s.\n", outname, errmsg);
+        }
+        goto ExportVcf_ret_1;
+      }
+    }
     if (invalid_allele_code_seen) {
       logerrputs("Warning: At least one VCF allele code violates the official specification;\nother tools may not accept the file.  (Valid codes must either start with a\n'<', only contain characters in {A,C,G,T,N,a,c,g,t,n}, be an isolated '*', or\nrepresent a breakend.)\n");
     }
@@ -6192,6 +6218,7 @@ PglErr ExportVcf(const uintptr_t* sample_include, const uint32_t* sample_include
  ExportVcf_ret_1:
   CleanupTextStream2(pvar_info_reload, &pvar_reload_txs, &reterr);
   CleanupBgzfCompressStream(&bgzf, &reterr);
+  CleanupBgzfIndexWriter(&bgzf_iw);
   BigstackReset(bigstack_mark);
   return reterr;
 }
@@ -376,7 +376,7 @@ PglErr ExtractExcludeFlagNorange(const char* const* variant_ids, const uint32_t*
     do {
       if (fnames_iter == fnames) {
         fname_tks = fnames_iter;
-        reterr = InitTokenStream(fnames_iter, decompress_thread_ct, &tks);
+        reterr = InitReadonlyTokenStream(fnames_iter, decompress_thread_ct, &tks);
         if (unlikely(reterr)) {
           goto ExtractExcludeFlagNorange_ret_TKSTREAM_FAIL;
         }
@@ -589,7 +589,7 @@ PglErr GlmLocalOpen(const char* local_covar_fname, const char* local_pvar_fname,
     if (bigstack_left() < dst_capacity) {
       goto GlmLocalOpen_ret_NOMEM;
     }
-    g_bigstack_base = R_CAST(unsigned char*, &(dst[dst_capacity]));
+    dst = S_CAST(char*, BigstackAllocElastic(dst_capacity));
     reterr = TextStreamOpenEx(nullptr, enforced_max_line_blen, dst_capacity, 1, &local_covar_txf, nullptr, local_covar_txsp);
     if (unlikely(reterr)) {
       TextStreamErrPrint(local_covar_fname, local_covar_txsp);
@@ -3507,6 +3507,10 @@ typedef struct GlmLogisticCtxStruct {
   uint16_t separation_found_y;
   float* local_covars_vcmaj_f[2];
   LogisticAuxResult* block_aux;
+
+  // Work-stealing task boundaries within the current block.
+  uint32_t* task_variant_uidx_starts;
+  uintptr_t* task_extra_allele_cts;
 } GlmLogisticCtx;
 
 THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
@@ -3531,7 +3535,6 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
   const uintptr_t* sex_male_collapsed = common->sex_male_collapsed;
   const ChrInfo* cip = common->cip;
   const uint32_t* subset_chr_fo_vidx_start = common->subset_chr_fo_vidx_start;
-  const uint32_t calc_thread_ct = GetThreadCt(arg->sharedp);
   const GlmFlags glm_flags = common->glm_flags;
   const uint32_t add_interactions = (glm_flags / kfGlmInteraction) & 1;
   const uint32_t hide_covar = (glm_flags / kfGlmHideCovar) & 1;
@@ -3573,30 +3576,42 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
   uint64_t new_err_info = 0;
   do {
     const uintptr_t cur_block_variant_ct = common->cur_block_variant_ct;
-    uint32_t variant_bidx = (tidx * cur_block_variant_ct) / calc_thread_ct;
-    const uint32_t variant_bidx_end = ((tidx + 1) * cur_block_variant_ct) / calc_thread_ct;
-    uintptr_t variant_uidx_base;
-    uintptr_t variant_include_bits;
-    BitIter1Start(variant_include, common->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
-
-    double* beta_se_iter = common->block_beta_se;
-    uintptr_t allele_bidx = variant_bidx;
-    if (max_extra_allele_ct) {
-      allele_bidx = variant_bidx + CountExtraAlleles(variant_include, allele_idx_offsets, common->read_variant_uidx_starts[0], common->read_variant_uidx_starts[tidx], 0);
-    }
-    if (beta_se_multiallelic_fused) {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
-    } else {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
-    }
-
-    LogisticAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
+    const uint32_t task_ct = GetThreadTaskCt(arg->sharedp);
+    uint32_t variant_bidx = 0;
+    uint32_t variant_bidx_end = 0;
+    uintptr_t variant_uidx_base = 0;
+    uintptr_t variant_include_bits = 0;
+    double* beta_se_iter = nullptr;
+    LogisticAuxResult* block_aux_iter = nullptr;
     const float* local_covars_iter = nullptr;
-    if (local_covar_ct) {
-      // &(nullptr[0]) is okay in C++, but undefined in C
-      local_covars_iter = &(ctx->local_covars_vcmaj_f[parity][variant_bidx * max_sample_ct * local_covar_ct]);
-    }
-    while (variant_bidx < variant_bidx_end) {
+    while (1) {
+      if (variant_bidx == variant_bidx_end) {
+        // Firth fallbacks and multiallelic variants make per-variant cost
+        // very uneven, so variants are claimed in small work-stealing tasks
+        // instead of one fixed range per thread.
+        uint32_t task_idx;
+        if (ClaimThreadTask(arg, &task_idx)) {
+          break;
+        }
+        variant_bidx = (S_CAST(uint64_t, task_idx) * cur_block_variant_ct) / task_ct;
+        variant_bidx_end = (S_CAST(uint64_t, task_idx + 1) * cur_block_variant_ct) / task_ct;
+        BitIter1Start(variant_include, ctx->task_variant_uidx_starts[task_idx], &variant_uidx_base, &variant_include_bits);
+        uintptr_t allele_bidx = variant_bidx;
+        if (max_extra_allele_ct) {
+          allele_bidx += ctx->task_extra_allele_cts[task_idx];
+        }
+        beta_se_iter = common->block_beta_se;
+        if (beta_se_multiallelic_fused) {
+          beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
+        } else {
+          beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
+        }
+        block_aux_iter = &(ctx->block_aux[allele_bidx]);
+        if (local_covar_ct) {
+          // &(nullptr[0]) is okay in C++, but undefined in C
+          local_covars_iter = &(ctx->local_covars_vcmaj_f[parity][variant_bidx * max_sample_ct * local_covar_ct]);
+        }
+      }
       const uint32_t variant_idx = variant_bidx + variant_idx_offset;
       const uint32_t chr_fo_idx = CountSortedSmallerU32(&(subset_chr_fo_vidx_start[1]), cip->chr_ct, variant_idx + 1);
       const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
@@ -5724,9 +5739,14 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     const uint32_t variant_ct = common->variant_ct;
 
     const GlmFlags glm_flags = glm_info_ptr->flags;
+    const uint32_t output_roundtrip = (glm_flags / kfGlmRoundtrip) & 1;
     const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
     // forced-singlethreaded
-    reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    if (glm_flags & kfGlmBgz) {
+      reterr = InitCstreamBgzAlloc(outname, 1, overflow_buf_size, &css, &cswritep);
+    } else {
+      reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    }
     if (unlikely(reterr)) {
       goto GlmLogistic_ret_1;
     }
@@ -5844,7 +5864,8 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     }
     // +1 is for top-level common->workspace_bufs
     const uint32_t dosage_is_present = pgfip->gflags & kfPgenGlobalDosagePresent;
-    uintptr_t thread_xalloc_cacheline_ct = (workspace_alloc / kCacheline) + 1;
+    // Work-stealing task boundary arrays are also carved from this.
+    uintptr_t thread_xalloc_cacheline_ct = (workspace_alloc / kCacheline) + 1 + DivUp(kThreadTasksPerThread * sizeof(int32_t), kCacheline) + DivUp(kThreadTasksPerThread * sizeof(intptr_t), kCacheline);
 
     uintptr_t per_variant_xalloc_byte_ct = max_sample_ct * local_covar_ct * sizeof(float);
     uintptr_t per_alt_allele_xalloc_byte_ct = sizeof(LogisticAuxResult);
@@ -5900,6 +5921,9 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
       common->workspace_bufs[tidx] = S_CAST(unsigned char*, bigstack_alloc_raw(workspace_alloc));
     }
+    const uint32_t max_task_ct = ThreadTaskCt(read_block_size, calc_thread_ct);
+    ctx->task_variant_uidx_starts = S_CAST(uint32_t*, bigstack_alloc_raw_rd(max_task_ct * sizeof(int32_t)));
+    ctx->task_extra_allele_cts = S_CAST(uintptr_t*, bigstack_alloc_raw_rd(max_task_ct * sizeof(intptr_t)));
     common->err_info = (~0LLU) << 32;
     SetThreadFuncAndData(GlmLogisticThread, ctx, &tg);
 
@@ -6084,7 +6108,17 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
       if (!IsLastBlock(&tg)) {
         common->cur_block_variant_ct = cur_block_variant_ct;
         const uint32_t uidx_start = read_block_idx * read_block_size;
-        ComputeUidxStartPartition(variant_include, cur_block_variant_ct, calc_thread_ct, uidx_start, common->read_variant_uidx_starts);
+        const uint32_t task_ct = ThreadTaskCt(cur_block_variant_ct, calc_thread_ct);
+        uint32_t* task_variant_uidx_starts = ctx->task_variant_uidx_starts;
+        ComputeUidxStartPartition(variant_include, cur_block_variant_ct, task_ct, uidx_start, task_variant_uidx_starts);
+        if (max_extra_allele_ct) {
+          uintptr_t* task_extra_allele_cts = ctx->task_extra_allele_cts;
+          task_extra_allele_cts[0] = 0;
+          for (uint32_t task_idx = 1; task_idx != task_ct; ++task_idx) {
+            task_extra_allele_cts[task_idx] = task_extra_allele_cts[task_idx - 1] + CountExtraAlleles(variant_include, allele_idx_offsets, task_variant_uidx_starts[task_idx - 1], task_variant_uidx_starts[task_idx], 0);
+          }
+        }
+        SetThreadTaskCt(task_ct, &tg);
         PgrCopyBaseAndOffset(pgfip, calc_thread_ct, common->pgr_ptrs);
         ctx->block_aux = logistic_block_aux_bufs[parity];
         common->block_beta_se = block_beta_se_bufs[parity];
@@ -6285,7 +6319,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                 if (a1_ct_col) {
                   *cswritep++ = '\t';
                   if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_dosage, cswritep);
+                    cswritep = dtoa_gr(auxp->a1_dosage, output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
                   }
@@ -6297,9 +6331,9 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                 if (a1_ct_cc_col) {
                   *cswritep++ = '\t';
                   if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_case_dosage, cswritep);
+                    cswritep = dtoa_gr(auxp->a1_case_dosage, output_roundtrip, cswritep);
                     *cswritep++ = '\t';
-                    cswritep = dtoa_g(auxp->a1_dosage - auxp->a1_case_dosage, cswritep);
+                    cswritep = dtoa_gr(auxp->a1_dosage - auxp->a1_case_dosage, output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA\tNA");
                   }
@@ -6323,7 +6357,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                 if (a1_freq_col) {
                   *cswritep++ = '\t';
                   if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), cswritep);
+                    cswritep = dtoa_gr(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
                   }
@@ -6331,9 +6365,9 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                 if (a1_freq_cc_col) {
                   *cswritep++ = '\t';
                   if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_case_dosage / S_CAST(double, auxp->case_allele_obs_ct), cswritep);
+                    cswritep = dtoa_gr(auxp->a1_case_dosage / S_CAST(double, auxp->case_allele_obs_ct), output_roundtrip, cswritep);
                     *cswritep++ = '\t';
-                    cswritep = dtoa_g((auxp->a1_dosage - auxp->a1_case_dosage) / S_CAST(double, auxp->allele_obs_ct - auxp->case_allele_obs_ct), cswritep);
+                    cswritep = dtoa_gr((auxp->a1_dosage - auxp->a1_case_dosage) / S_CAST(double, auxp->allele_obs_ct - auxp->case_allele_obs_ct), output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA\tNA");
                   }
@@ -6341,7 +6375,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                 if (mach_r2_col) {
                   *cswritep++ = '\t';
                   if (!suppress_mach_r2) {
-                    cswritep = dtoa_g(auxp->mach_r2, cswritep);
+                    cswritep = dtoa_gr(auxp->mach_r2, output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
                   }
@@ -6400,9 +6434,9 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                     *cswritep++ = '\t';
                     if (test_is_valid) {
                       if (report_beta_instead_of_odds_ratio) {
-                        cswritep = dtoa_g(beta, cswritep);
+                        cswritep = dtoa_gr(beta, output_roundtrip, cswritep);
                       } else {
-                        cswritep = lntoa_g(beta, cswritep);
+                        cswritep = lntoa_gr(beta, output_roundtrip, cswritep);
                       }
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
@@ -6411,7 +6445,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                   if (se_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(se, cswritep);
+                      cswritep = dtoa_gr(se, output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
@@ -6421,13 +6455,13 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                     if (test_is_valid) {
                       const double ci_halfwidth = ci_zt * se;
                       if (report_beta_instead_of_odds_ratio) {
-                        cswritep = dtoa_g(beta - ci_halfwidth, cswritep);
+                        cswritep = dtoa_gr(beta - ci_halfwidth, output_roundtrip, cswritep);
                         *cswritep++ = '\t';
-                        cswritep = dtoa_g(beta + ci_halfwidth, cswritep);
+                        cswritep = dtoa_gr(beta + ci_halfwidth, output_roundtrip, cswritep);
                       } else {
-                        cswritep = lntoa_g(beta - ci_halfwidth, cswritep);
+                        cswritep = lntoa_gr(beta - ci_halfwidth, output_roundtrip, cswritep);
                         *cswritep++ = '\t';
-                        cswritep = lntoa_g(beta + ci_halfwidth, cswritep);
+                        cswritep = lntoa_gr(beta + ci_halfwidth, output_roundtrip, cswritep);
                       }
                     } else {
                       cswritep = strcpya_k(cswritep, "NA\tNA");
@@ -6436,7 +6470,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                   if (z_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(permstat, cswritep);
+                      cswritep = dtoa_gr(permstat, output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
@@ -6456,7 +6490,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                   if (z_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(primary_se / u31tod(cur_constraint_ct), cswritep);
+                      cswritep = dtoa_gr(primary_se / u31tod(cur_constraint_ct), output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
@@ -6472,10 +6506,10 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
                   if (test_is_valid) {
                     if (report_neglog10p) {
                       double reported_val = (-kRecipLn10) * ln_pval;
-                      cswritep = dtoa_g(reported_val, cswritep);
+                      cswritep = dtoa_gr(reported_val, output_roundtrip, cswritep);
                     } else {
                       double reported_ln = MAXV(ln_pval, output_min_ln);
-                      cswritep = lntoa_g(reported_ln, cswritep);
+                      cswritep = lntoa_gr(reported_ln, output_roundtrip, cswritep);
                     }
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
@@ -7927,9 +7961,14 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     const uint32_t variant_ct = common->variant_ct;
 
     const GlmFlags glm_flags = glm_info_ptr->flags;
+    const uint32_t output_roundtrip = (glm_flags / kfGlmRoundtrip) & 1;
     const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
     // forced-singlethreaded
-    reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    if (glm_flags & kfGlmBgz) {
+      reterr = InitCstreamBgzAlloc(outname, 1, overflow_buf_size, &css, &cswritep);
+    } else {
+      reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    }
     if (unlikely(reterr)) {
       goto GlmLinear_ret_1;
     }
@@ -8454,7 +8493,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                 if (a1_ct_col) {
                   *cswritep++ = '\t';
                   if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_dosage, cswritep);
+                    cswritep = dtoa_gr(auxp->a1_dosage, output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
                   }
@@ -8466,7 +8505,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                 if (a1_freq_col) {
                   *cswritep++ = '\t';
                   if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), cswritep);
+                    cswritep = dtoa_gr(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
                   }
@@ -8474,7 +8513,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                 if (mach_r2_col) {
                   *cswritep++ = '\t';
                   if (!suppress_mach_r2) {
-                    cswritep = dtoa_g(auxp->mach_r2, cswritep);
+                    cswritep = dtoa_gr(auxp->mach_r2, output_roundtrip, cswritep);
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
                   }
@@ -8523,7 +8562,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                   if (beta_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(beta, cswritep);
+                      cswritep = dtoa_gr(beta, output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
@@ -8531,7 +8570,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                   if (se_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(se, cswritep);
+                      cswritep = dtoa_gr(se, output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
@@ -8540,9 +8579,9 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                     *cswritep++ = '\t';
                     if (test_is_valid) {
                       const double ci_halfwidth = ci_zt * se;
-                      cswritep = dtoa_g(beta - ci_halfwidth, cswritep);
+                      cswritep = dtoa_gr(beta - ci_halfwidth, output_roundtrip, cswritep);
                       *cswritep++ = '\t';
-                      cswritep = dtoa_g(beta + ci_halfwidth, cswritep);
+                      cswritep = dtoa_gr(beta + ci_halfwidth, output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA\tNA");
                     }
@@ -8550,7 +8589,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                   if (t_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(tstat, cswritep);
+                      cswritep = dtoa_gr(tstat, output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
@@ -8570,7 +8609,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                   if (t_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(primary_se / u31tod(cur_constraint_ct), cswritep);
+                      cswritep = dtoa_gr(primary_se / u31tod(cur_constraint_ct), output_roundtrip, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
@@ -8585,10 +8624,10 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
                   if (test_is_valid) {
                     if (report_neglog10p) {
                       const double reported_val = (-kRecipLn10) * ln_pval;
-                      cswritep = dtoa_g(reported_val, cswritep);
+                      cswritep = dtoa_gr(reported_val, output_roundtrip, cswritep);
                     } else {
                       const double reported_ln = MAXV(ln_pval, output_min_ln);
-                      cswritep = lntoa_g(reported_ln, cswritep);
+                      cswritep = lntoa_gr(reported_ln, output_roundtrip, cswritep);
                     }
                   } else {
                     cswritep = strcpya_k(cswritep, "NA");
@@ -10043,6 +10082,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
     const uint32_t variant_ct = common->variant_ct;
 
     const GlmFlags glm_flags = glm_info_ptr->flags;
+    const uint32_t output_roundtrip = (glm_flags / kfGlmRoundtrip) & 1;
     const uint32_t report_neglog10p = (glm_flags / kfGlmLog10) & 1;
     const uint32_t add_interactions = (glm_flags / kfGlmInteraction) & 1;
     const uint32_t domdev_present = (glm_flags & (kfGlmGenotypic | kfGlmHethom))? 1 : 0;
@@ -10155,6 +10195,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
     common->dosage_presents = nullptr;
     common->dosage_mains = nullptr;
     const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
+    const uint32_t output_bgz = (glm_flags / kfGlmBgz) & 1;
     // This cannot be less than what InitCstreamAlloc() actually allocates.
     uintptr_t cstream_alloc_size = RoundUpPow2(overflow_buf_size, kCacheline);
     if (output_zst) {
@@ -10303,13 +10344,19 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
         outname_end2 = strcpya_k(outname_end2, ".glm.linear");
         if (output_zst) {
           snprintf(outname_end2, 22, ".zst");
+        } else if (output_bgz) {
+          snprintf(outname_end2, 22, ".gz");
         } else {
           *outname_end2 = '\0';
         }
 
         // forced-singlethreaded
         char* cswritep;
-        reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &(css_arr[fidx]), &cswritep);
+        if (output_bgz) {
+          reterr = InitCstreamBgzAlloc(outname, 1, overflow_buf_size, &(css_arr[fidx]), &cswritep);
+        } else {
+          reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &(css_arr[fidx]), &cswritep);
+        }
         if (unlikely(reterr)) {
           goto GlmLinearBatch_ret_1;
         }
@@ -10667,7 +10714,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                     if (a1_ct_col) {
                       *cswritep++ = '\t';
                       if (!multi_a1) {
-                        cswritep = dtoa_g(auxp->a1_dosage, cswritep);
+                        cswritep = dtoa_gr(auxp->a1_dosage, output_roundtrip, cswritep);
                       } else {
                         cswritep = strcpya_k(cswritep, "NA");
                       }
@@ -10679,7 +10726,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                     if (a1_freq_col) {
                       *cswritep++ = '\t';
                       if (!multi_a1) {
-                        cswritep = dtoa_g(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), cswritep);
+                        cswritep = dtoa_gr(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), output_roundtrip, cswritep);
                       } else {
                         cswritep = strcpya_k(cswritep, "NA");
                       }
@@ -10687,7 +10734,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                     if (mach_r2_col) {
                       *cswritep++ = '\t';
                       if (!suppress_mach_r2) {
-                        cswritep = dtoa_g(auxp->mach_r2, cswritep);
+                        cswritep = dtoa_gr(auxp->mach_r2, output_roundtrip, cswritep);
                       } else {
                         cswritep = strcpya_k(cswritep, "NA");
                       }
@@ -10736,7 +10783,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                       if (beta_col) {
                         *cswritep++ = '\t';
                         if (test_is_valid) {
-                          cswritep = dtoa_g(beta, cswritep);
+                          cswritep = dtoa_gr(beta, output_roundtrip, cswritep);
                         } else {
                           cswritep = strcpya_k(cswritep, "NA");
                         }
@@ -10744,7 +10791,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                       if (se_col) {
                         *cswritep++ = '\t';
                         if (test_is_valid) {
-                          cswritep = dtoa_g(se, cswritep);
+                          cswritep = dtoa_gr(se, output_roundtrip, cswritep);
                         } else {
                           cswritep = strcpya_k(cswritep, "NA");
                         }
@@ -10753,9 +10800,9 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                         *cswritep++ = '\t';
                         if (test_is_valid) {
                           const double ci_halfwidth = ci_zt * se;
-                          cswritep = dtoa_g(beta - ci_halfwidth, cswritep);
+                          cswritep = dtoa_gr(beta - ci_halfwidth, output_roundtrip, cswritep);
                           *cswritep++ = '\t';
-                          cswritep = dtoa_g(beta + ci_halfwidth, cswritep);
+                          cswritep = dtoa_gr(beta + ci_halfwidth, output_roundtrip, cswritep);
                         } else {
                           cswritep = strcpya_k(cswritep, "NA\tNA");
                         }
@@ -10763,7 +10810,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                       if (t_col) {
                         *cswritep++ = '\t';
                         if (test_is_valid) {
-                          cswritep = dtoa_g(tstat, cswritep);
+                          cswritep = dtoa_gr(tstat, output_roundtrip, cswritep);
                         } else {
                           cswritep = strcpya_k(cswritep, "NA");
                         }
@@ -10783,7 +10830,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                       if (t_col) {
                         *cswritep++ = '\t';
                         if (test_is_valid) {
-                          cswritep = dtoa_g(primary_se / u31tod(cur_constraint_ct), cswritep);
+                          cswritep = dtoa_gr(primary_se / u31tod(cur_constraint_ct), output_roundtrip, cswritep);
                         } else {
                           cswritep = strcpya_k(cswritep, "NA");
                         }
@@ -10798,10 +10845,10 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
                       if (test_is_valid) {
                         if (report_neglog10p) {
                           const double reported_val = (-kRecipLn10) * ln_pval;
-                          cswritep = dtoa_g(reported_val, cswritep);
+                          cswritep = dtoa_gr(reported_val, output_roundtrip, cswritep);
                         } else {
                           const double reported_ln = MAXV(ln_pval, output_min_ln);
-                          cswritep = lntoa_g(reported_ln, cswritep);
+                          cswritep = lntoa_gr(reported_ln, output_roundtrip, cswritep);
                         }
                       } else {
                         cswritep = strcpya_k(cswritep, "NA");
@@ -10872,7 +10919,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
       completed_pheno_ct += subbatch_size;
     }
     outname_end[1] = '\0';
-    logprintfww("Results written to %s<phenotype name>.glm.linear%s .\n", outname, output_zst? ".zst" : "");
+    logprintfww("Results written to %s<phenotype name>.glm.linear%s .\n", outname, output_zst? ".zst" : (output_bgz? ".gz" : ""));
   }
   while (0) {
   GlmLinearBatch_ret_NOMEM:
@@ -10968,10 +11015,11 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     common.dosage_presents = nullptr;
     common.dosage_mains = nullptr;
     const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
+    const uint32_t output_bgz = (glm_flags / kfGlmBgz) & 1;
     const uint32_t perm_adapt = (glm_flags / kfGlmPerm) & 1;
     const uint32_t perms_total = perm_adapt? aperm_ptr->max : glm_info_ptr->mperm_ct;
     // <output prefix>.<pheno name>.glm.logistic.hybrid{,.perm,.mperm}[.zst]
-    uint32_t pheno_name_blen_capacity = kPglFnamesize - 21 - (4 * output_zst) - S_CAST(uintptr_t, outname_end - outname);
+    uint32_t pheno_name_blen_capacity = kPglFnamesize - 21 - (4 * (output_zst | output_bgz)) - S_CAST(uintptr_t, outname_end - outname);
     if (perms_total) {
       pheno_name_blen_capacity -= 6 - perm_adapt;
     }
@@ -11157,7 +11205,7 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
           if (unlikely(bigstack_calloc_w(raw_variant_ctl, &already_seen))) {
             goto GlmMain_ret_NOMEM;
           }
-          reterr = InitTokenStream(glm_info_ptr->condition_list_fname, MAXV(max_thread_ct - 1, 1), &tks);
+          reterr = InitReadonlyTokenStream(glm_info_ptr->condition_list_fname, MAXV(max_thread_ct - 1, 1), &tks);
           if (unlikely(reterr)) {
             goto GlmMain_ret_TKSTREAM_FAIL;
           }
@@ -12805,6 +12853,8 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
 
       if (output_zst) {
         snprintf(outname_end2, 22, ".zst");
+      } else if (output_bgz) {
+        snprintf(outname_end2, 22, ".gz");
       } else {
         *outname_end2 = '\0';
       }
@@ -59,7 +59,9 @@ FLAGSET_DEF_START()
   kfGlmLocalHaps = (1 << 23),
   kfGlmLocalCats1based = (1 << 24),
   kfGlmFirthResidualize = (1 << 25),
-  kfGlmCcResidualize = (1 << 26)
+  kfGlmCcResidualize = (1 << 26),
+  kfGlmRoundtrip = (1 << 27),
+  kfGlmBgz = (1 << 28)
 FLAGSET_DEF_END(GlmFlags);
 
 FLAGSET_DEF_START()
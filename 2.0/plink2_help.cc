@@ -145,6 +145,9 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "  --bcf <filename> ['dosage='<field>] :\n"
 "    Specify full name of .vcf{|.gz|.zst} or BCF2 file to import.\n"
 "    * These can be used with --psam/--fam.\n"
+"    * If a block-gzipped VCF has a tabix (.tbi) or CSI (.csi) index, --chr and\n"
+"      --from-bp/--to-bp use it to skip excluded regions.  (This also applies\n"
+"      to a block-gzipped --pvar file loaded without a .pgen.)\n"
 "    * By default, dosage information is not imported.  To import the GP field\n"
 "      (must be VCFv4.3-style 0..1, one probability per possible genotype), add\n"
 "      'dosage=GP' (or 'dosage=GP-force', see below).  To import Minimac3-style\n"
@@ -280,11 +283,13 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      be kept, under all circumstances.\n\n"
               );
     HelpPrint("make-pgen\0make-bpgen\0make-bed\0make-just-pvar\0make-just-psam\0", &help_ctrl, 1,
-"  --make-pgen ['vzs'] ['format='<code>] ['trim-alts'] ['erase-phase']\n"
-"              ['erase-dosage'] ['fill-missing-from-dosage']\n"
-"              ['pvar-cols='<col set desc>] ['psam-cols='<col set desc>]\n"
+"  --make-pgen [{vzs | vbgz}] ['format='<code>] ['trim-alts'] ['erase-phase']\n"
+"              ['erase-dosage'] ['fill-missing-from-dosage'] ['pgi']\n"
+"              ['vsum'] ['ld-search'] ['pzs'] ['pvar-cols='<col set desc>]\n"
+"              ['psam-cols='<col set desc>]\n"
 "  --make-bpgen ['vzs'] ['format='<code>] ['trim-alts'] ['erase-phase']\n"
-"               ['erase-dosage'] ['fill-missing-from-dosage']\n"
+"               ['erase-dosage'] ['fill-missing-from-dosage'] ['pgi']\n"
+"               ['vsum'] ['ld-search'] ['pzs']\n"
 "  --make-bed ['vzs'] ['trim-alts']\n"
                /*
 "  --make-pgen ['vzs'] ['format='<code>] [{trim-alts | erase-alt2+}]\n"
@@ -304,7 +309,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    * Unlike the automatic text-to-binary converters (which only heed\n"
 "      chromosome filters), this supports all of PLINK's filtering flags.\n"
 "    * The 'vzs' modifier causes the variant file (.pvar/.bim) to be\n"
-"      Zstd-compressed.\n"
+"      Zstd-compressed.  With --make-pgen, 'vbgz' block-gzips the .pvar instead\n"
+"      and (when it is position-sorted) writes a tabix index next to it.\n"
 "    * The 'format' modifier requests an uncompressed fixed-variant-width .pgen\n"
 "      file.  (These do not directly support multiallelic variants.)  The\n"
 "      following format code is currently supported:\n"
@@ -325,6 +331,23 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    * When a hardcall is missing but the corresponding dosage is present,\n"
 "      'fill-missing-from-dosage' causes the (Euclidean-)nearest hardcall to be\n"
 "      filled in, with ties broken in favor of the lower-index allele.\n"
+"    * The 'pgi' modifier causes a .pgen.pgi index to be written as well; see\n"
+"      --make-pgi below.\n"
+"    * The 'vsum' modifier causes a .pgen.vsum file to be written as well.  It\n"
+"      contains per-variant genotype counts and dosage sums over all samples,\n"
+"      which later runs use for allele frequency, missingness, and HWE\n"
+"      calculations (when no samples are filtered out) instead of decoding\n"
+"      genotype data.  chrX/chrY variants are still decoded.\n"
+"    * The 'ld-search' modifier causes the .pgen writer to consider up to 8\n"
+"      recent variants (instead of just the last uncompressed one) when\n"
+"      choosing LD-compression bases.  This usually produces a somewhat smaller\n"
+"      .pgen at the cost of a slower write; the file remains readable by any\n"
+"      PLINK 2 build.\n"
+"    * The 'pzs' modifier causes the .pgen's variant records to be\n"
+"      Zstd-compressed (level set by --zst-level), in independently decodable\n"
+"      4096-variant frames so that random access remains reasonably fast.\n"
+"      Such files cannot be read by older PLINK 2 builds or pgenlib builds\n"
+"      compiled without Zstd support.\n"
                /*
 "    * The 'multiallelics=' modifier (alias: 'm=') specifies a join or split\n"
 "      mode.  The following modes are currently supported:\n"
@@ -403,7 +426,7 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      The default is maybefid,maybesid,maybeparents,sex,phenos.\n\n"
               );
     HelpPrint("make-just-pvar\0make-just-psam\0make-just-bim\0make-just-fam\0write-cluster\n\0", &help_ctrl, 1,
-"  --make-just-pvar ['zs'] ['cols='<column set descriptor>]\n"
+"  --make-just-pvar [{zs | bgz}] ['cols='<column set descriptor>]\n"
 "  --make-just-psam ['cols='<column set descriptor>]\n"
 "  --make-just-bim ['zs']\n"
 "  --make-just-fam\n"
@@ -480,6 +503,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      'bcf',       handling of chromosome codes and male ploidy.\n"
 "      'bcf-4.2'    When the 'bgz' modifier is present, the VCF file is\n"
 "                   block-gzipped.  (This always happens with BCF output.)\n"
+"                   A position-sorted block-gzipped VCF also gets a .tbi (or,\n"
+"                   for positions past 2^29, .csi) index.\n"
 "                   The 'id-paste' modifier controls which .psam columns are\n"
 "                   used to construct sample IDs (choices are maybefid, fid,\n"
 "                   iid, maybesid, and sid; default is maybefid,iid,maybesid),\n"
@@ -520,7 +545,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
     // todo: add optional column for computed MAF (nothing here quite
     // corresponds to nonmajor_freqs when e.g. --maf-pseudocount is specified).
     HelpPrint("freq\0mach-r2-filter\0", &help_ctrl, 1,
-"  --freq ['zs'] ['counts'] ['cols='<column set descriptor>] ['bins-only']\n"
+"  --freq [{zs | bgz}] ['counts'] ['cols='<column set descriptor>]\n"
+"         ['bins-only']\n"
 "         ['refbins='<comma-separated bin boundaries> | 'refbins-file='<file>]\n"
 "         ['alt1bins='<comma-separated bin boundaries> | 'alt1bins-file='<file>]\n"
 "    Empirical allele frequency report.  By default, only founders are\n"
@@ -551,7 +577,9 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    'counts') file(s) are generated when 'refbins='/'refbins-file=' or\n"
 "    'alt1bins='/'alt1bins-file=' is present; these report the total number of\n"
 "    frequencies or counts in each left-closed, right-open interval.  (If you\n"
-"    only want these histogram(s), and not the main report, add 'bins-only'.)\n\n"
+"    only want these histogram(s), and not the main report, add 'bins-only'.)\n"
+"    The 'bgz' modifier block-gzips the main report (forcing the chrom and pos\n"
+"    columns), and writes a tabix index for it when variants are sorted.\n\n"
               );
     // this can't really handle dosages, so we specify "hardcall"
     HelpPrint("geno-counts\0freq\0freqx\frqx\0", &help_ctrl, 1,
@@ -687,7 +715,7 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    The default is chrom,nmiss,nobs,fmiss.\n\n"
               );
     HelpPrint("hardy\0", &help_ctrl, 1,
-"  --hardy ['zs'] ['midp'] ['redundant'] ['cols='<column set descriptor>]\n"
+"  --hardy [{zs | bgz}] ['midp'] ['redundant'] ['cols='<column set desc>]\n"
 "    Hardy-Weinberg exact test p-value report(s).\n"
 "    * By default, only founders are considered; change this with --nonfounders.\n"
 "    * chrX is now omitted from the main <output prefix>.hardy report.  Instead,\n"
@@ -701,6 +729,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      the 'redundant' modifier to force biallelic variant results to be\n"
 "      reported on two lines for parsing convenience.\n"
 "    * There is currently no special handling of case/control phenotypes.\n"
+"    * 'bgz' block-gzips the report(s) (forcing the chrom and pos columns), and\n"
+"      writes tabix indexes for them when variants are sorted.\n"
 "    Supported column sets are:\n"
 "      chrom: Chromosome ID.\n"
 "      pos: Base-pair coordinate.\n"
@@ -1127,7 +1157,7 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    variant ID(s) remain.\n\n"
                );
     HelpPrint("glm\0linear\0logistic\0assoc\0", &help_ctrl, 1,
-"  --glm ['zs'] ['omit-ref'] [{sex | no-x-sex}] ['log10'] ['pheno-ids']\n"
+"  --glm [{zs | bgz}] ['omit-ref'] [{sex | no-x-sex}] ['log10'] ['pheno-ids']\n"
 "        [{genotypic | hethom | dominant | recessive}] ['interaction']\n"
 "        ['hide-covar'] ['skip-invalid-pheno'] ['allow-no-covars']\n"
 "        [{intercept | cc-residualize | firth-residualize}]\n"
@@ -1151,6 +1181,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      variants, and no others.  The 'sex' modifier causes it to be added\n"
 "      everywhere (except chrY), while 'no-x-sex' excludes it entirely.\n"
 "    * The 'log10' modifier causes p-values to be reported in -log10(p) form.\n"
+"    * 'bgz' block-gzips the results (forcing the chrom and pos columns), and\n"
+"      writes a tabix index for each file when variants are sorted.\n"
 "    * 'pheno-ids' causes the samples used in each set of regressions to be\n"
 "      written to an .id file.  (When the samples differ on chrX or chrY, .x.id\n"
 "      and/or .y.id files are also written.)\n"
@@ -1396,6 +1428,21 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "  --pgen-info\n"
 "    Reports basic information about a .pgen file.\n\n"
                );
+    HelpPrint("make-pgi\0", &help_ctrl, 1,
+"  --make-pgi\n"
+"    Writes a <.pgen filename>.pgi variant-offset index.  When this index is\n"
+"    present and up-to-date, later runs use it to open the .pgen without\n"
+"    decoding its header.  This must be run by itself, and has no effect on\n"
+"    fixed-width .pgen files.\n\n"
+               );
+    HelpPrint("make-pvar-cache\0pvar-cache\0", &help_ctrl, 1,
+"  --make-pvar-cache\n"
+"    Writes a <.pvar filename>.pvc binary cache of the variant metadata.  When\n"
+"    this cache is present and up-to-date, later runs which don't filter or\n"
+"    rewrite variants while loading the .pvar map its contents instead of\n"
+"    parsing the text.  (INFO is still reread from the .pvar when needed.)\n"
+"    This must be run by itself.\n\n"
+               );
     HelpPrint("validate\0", &help_ctrl, 1,
 "  --validate\n"
 "    Validates all variant records in a .pgen file.\n\n"
@@ -2312,14 +2359,70 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "                       shape instead, and postprocess as necessary.\n"
                );
     HelpPrint("memory\0seed\0", &help_ctrl, 0,
-"  --memory <val> ['require'] : Set size, in MiB, of initial workspace malloc\n"
-"                               attempt.  To error out instead of reducing the\n"
-"                               request size when the initial attempt fails, add\n"
-"                               the 'require' modifier.\n"
+"  --memory <val> ['require'] ['hugepages' | 'thp'] ['numa-interleave'] :\n"
+"    Set size, in MiB, of initial workspace malloc attempt.  To error out\n"
+"    instead of reducing the request size when the initial attempt fails, add\n"
+"    the 'require' modifier.\n"
+"    The remaining modifiers (Linux only) change how the workspace is backed,\n"
+"    which can reduce TLB misses and remote-memory traffic in large\n"
+"    --make-rel/--make-king/etc. jobs:\n"
+"    * 'hugepages' maps it with explicit 2 MiB pages (MAP_HUGETLB; requires a\n"
+"      large enough /proc/sys/vm/nr_hugepages pool, otherwise 'thp' is used).\n"
+"    * 'thp' requests transparent huge pages (madvise(MADV_HUGEPAGE)).\n"
+"    * 'numa-interleave' spreads its pages across all online NUMA nodes.\n"
+"      (Without this, pages land on the node of the thread that first touches\n"
+"      them.)\n"
+"    Workspace high-water marks for each major step are written to the log.\n"
+"    Buffers which just take a fixed share of whatever is available (mostly\n"
+"    text-file line buffers) are listed separately.\n"
+               );
+    HelpPrint("spill-dir\0memory\0", &help_ctrl, 0,
+"  --spill-dir <dir>  : When the main workspace is too small for the GRM\n"
+"                       (--make-rel/--make-grm-list/--make-grm-bin/--pca), the\n"
+"                       --pca approx variant matrix, or a single-pass\n"
+"                       --make-king square matrix, back it with a temporary\n"
+"                       file in <dir> instead of failing.  This is much slower\n"
+"                       than RAM; use a fast local disk.  Not supported on\n"
+"                       Windows.\n"
+               );
+    HelpPrint("dry-run\0memory\0", &help_ctrl, 0,
+"  --dry-run          : Load the input files and apply filters, then report\n"
+"                       workspace requirements of the requested\n"
+"                       --make-rel/--make-grm/--make-king/--pca runs and a\n"
+"                       suggested --memory value, instead of running the\n"
+"                       analysis.\n"
                );
     HelpPrint("threads\0num_threads\0thread-num\0seed\0", &help_ctrl, 0,
 "  --threads <val>    : Set maximum number of compute threads.\n"
                );
+    HelpPrint("pgen-io-threads\0threads\0", &help_ctrl, 0,
+"  --pgen-io-threads <ct> : Read .pgen blocks with <ct> background pread()\n"
+"                           threads instead of a single fread() stream.  Mainly\n"
+"                           useful on high-latency network filesystems.  Total\n"
+"                           read-wait time is reported at the end of the run.\n"
+               );
+    HelpPrint("perf-log\0threads\0", &help_ctrl, 0,
+"  --perf-log <file>  : Write a JSON summary of multithreaded-phase performance\n"
+"                       to <file>.  Each thread group phase gets wall time,\n"
+"                       per-thread busy and barrier-wait time, critical-path\n"
+"                       time, and main-thread .pgen read / report write /\n"
+"                       join-wait time.  Per-thread CPU time and the\n"
+"                       resulting 'cpu_balance' (the utilization with one\n"
+"                       dedicated core per thread) are also reported, since\n"
+"                       wall-clock numbers are distorted when there are more\n"
+"                       threads than free cores.\n"
+               );
+    HelpPrint("pvar-cache\0make-pvar-cache\0", &help_ctrl, 0,
+"  --pvar-cache ['verify'] : Write <.pvar filename>.pvc (see --make-pvar-cache)\n"
+"                            if it's missing or out of date.  'verify' also\n"
+"                            checksums the entire cache before using it;\n"
+"                            normally only the .pvar's size, timestamp, and\n"
+"                            sampled contents are checked.\n"
+               );
+    HelpPrint("no-text-mmap\0", &help_ctrl, 0,
+"  --no-text-mmap     : Read uncompressed text files with a background thread\n"
+"                       instead of memory-mapping them.\n"
+               );
     HelpPrint("d\0covar-name\0exclude-snps\0pheno-name\0snps", &help_ctrl, 0,
 "  --d <char>         : Change variant/covariate range delimiter (normally '-').\n"
               );
@@ -2336,6 +2439,12 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "  --output-min-p <p> : Specify minimum p-value to write to reports.  (2.23e-308\n"
 "                       is useful for preventing underflow in some programs.)\n"
                );
+    HelpPrint("output-roundtrip\0", &help_ctrl, 0,
+"  --output-roundtrip : Write floating-point --freq, --glm, and\n"
+"                       --make-king[-table] report values with the fewest\n"
+"                       digits that parse back to the exact same double,\n"
+"                       instead of the default 6 significant digits.\n"
+               );
     HelpPrint("debug\0randmem\0", &help_ctrl, 0,
 "  --debug            : Use slower, more crash-resistant logging method.\n"
 "  --randmem          : Randomize initial workspace memory (helps catch\n"
@@ -2349,6 +2458,14 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
     HelpPrint("zst-level\0", &help_ctrl, 0,
 "  --zst-level <lvl>  : Set the Zstd compression level (1-22, default 3).\n"
                );
+    HelpPrint("zst-pipeline\0zst-level\0", &help_ctrl, 0,
+"  --zst-pipeline [thread ct] [lvl] :\n"
+"    Compress .zst reports on a dedicated background thread, so that the main\n"
+"    computation doesn't wait on compression.  The background compressor uses\n"
+"    the given number of threads (default 2) regardless of --threads, and the\n"
+"    given level (default: --zst-level setting).  Per-file stall statistics are\n"
+"    written to the log.\n"
+               );
     if (!param_ct) {
       fputs(
 "\nPrimary methods paper:\n"
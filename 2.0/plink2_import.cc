@@ -2647,7 +2647,7 @@ static const char kGpText[] = "GP";
 
 static_assert(!kVcfHalfCallReference, "VcfToPgen() assumes kVcfHalfCallReference == 0.");
 static_assert(kVcfHalfCallHaploid == 1, "VcfToPgen() assumes kVcfHalfCallHaploid == 1.");
-PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const char* const_fid, const char* dosage_import_field, MiscFlags misc_flags, ImportFlags import_flags, uint32_t no_samples_ok, uint32_t hard_call_thresh, uint32_t dosage_erase_thresh, double import_dosage_certainty, char id_delim, char idspace_to, int32_t vcf_min_gq, int32_t vcf_min_dp, int32_t vcf_max_dp, VcfHalfCall halfcall_mode, FamCol fam_cols, uint32_t max_thread_ct, char* outname, char* outname_end, ChrInfo* cip, uint32_t* pgen_generated_ptr, uint32_t* psam_generated_ptr) {
+PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const char* const_fid, const char* dosage_import_field, MiscFlags misc_flags, ImportFlags import_flags, uint32_t no_samples_ok, uint32_t hard_call_thresh, uint32_t dosage_erase_thresh, double import_dosage_certainty, char id_delim, char idspace_to, int32_t vcf_min_gq, int32_t vcf_min_dp, int32_t vcf_max_dp, VcfHalfCall halfcall_mode, FamCol fam_cols, int32_t from_bp, int32_t to_bp, uint32_t max_thread_ct, char* outname, char* outname_end, ChrInfo* cip, uint32_t* pgen_generated_ptr, uint32_t* psam_generated_ptr) {
   // Now performs a 2-pass load.  Yes, this can be slower than plink 1.9, but
   // it's necessary to use the Pgen_writer classes for now (since we need to
   // know upfront how many variants there are, and whether phase/dosage is
@@ -2974,13 +2974,39 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
     uint32_t max_qualfilterinfo_slen = 6;
     uint32_t phase_or_dosage_found = 0;
 
+    // If there's a tabix/CSI index, jump to the first record that can survive
+    // the chromosome (and --from-bp/--to-bp) filter, and stop after the last
+    // one.  The same jump is made on the second pass.  Line numbers in error
+    // messages are then relative to the #CHROM line.
+    uint32_t kept_ref_ct = UINT32_MAX;
+    const uint64_t index_voffset = TextIsBgzf(&vcf_txs)? BgzfIndexScanStart(vcfname, "--vcf file", cip, allow_extra_chrs, from_bp, to_bp, &kept_ref_ct) : UINT64_MAX;
+    const uint32_t index_to_bp = ((kept_ref_ct == 1) && (to_bp != -1))? to_bp : UINT32_MAX;
+    uint32_t kept_ref_seen_ct = 0;
+    uint32_t prev_kept_chr_code = UINT32_MAX;
+    if (index_voffset != UINT64_MAX) {
+      line_iter = AdvPastDelim(line_iter, '\n');
+      const uint32_t header_line_blen = line_iter - prev_line_start;
+      if (header_line_blen > max_line_blen) {
+        max_line_blen = header_line_blen;
+      }
+      reterr = TextSeekBgzf(index_voffset, &vcf_txs);
+      if (unlikely(reterr)) {
+        goto VcfToPgen_ret_TSTREAM_FAIL;
+      }
+      line_iter = TextLineEnd(&vcf_txs);
+      ++line_idx;
+      goto VcfToPgen_scan_index_start;
+    }
     while (1) {
       ++line_idx;
       line_iter = AdvPastDelim(line_iter, '\n');
-      const uint32_t prev_line_blen = line_iter - prev_line_start;
-      if (prev_line_blen > max_line_blen) {
-        max_line_blen = prev_line_blen;
+      {
+        const uint32_t prev_line_blen = line_iter - prev_line_start;
+        if (prev_line_blen > max_line_blen) {
+          max_line_blen = prev_line_blen;
+        }
       }
+    VcfToPgen_scan_index_start:
       reterr = TextNextLineUnsafe(&vcf_txs, &line_iter);
       if (reterr) {
         if (likely(reterr == kPglRetEof)) {
@@ -3101,10 +3127,25 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
         goto VcfToPgen_ret_1;
       }
       if (!IsSet(cip->chr_mask, cur_chr_code)) {
+        if (kept_ref_seen_ct == kept_ref_ct) {
+          // Past the last indexed sequence that may be kept.
+          break;
+        }
         ++variant_skip_ct;
         line_iter = info_end;
         continue;
       }
+      if (index_voffset != UINT64_MAX) {
+        if (cur_chr_code != prev_kept_chr_code) {
+          prev_kept_chr_code = cur_chr_code;
+          ++kept_ref_seen_ct;
+        }
+        // Records are position-sorted within each indexed sequence.
+        uint32_t cur_bp;
+        if ((index_to_bp != UINT32_MAX) && (!ScanUintDefcap(&(chr_code_end[1]), &cur_bp)) && (cur_bp > index_to_bp)) {
+          break;
+        }
+      }
       if (cur_max_allele_slen > max_allele_slen) {
         max_allele_slen = cur_max_allele_slen;
       }
@@ -3527,6 +3568,14 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
     unsigned char* geno_buf_iter = nullptr;
     unsigned char* cur_thread_byte_stop = nullptr;
     uint32_t parity = 0;
+    uint32_t index_seek_pending = 0;
+    if (index_voffset != UINT64_MAX) {
+      reterr = TextSeekBgzf(index_voffset, &vcf_txs);
+      if (unlikely(reterr)) {
+        goto VcfToPgen_ret_TSTREAM_FAIL;
+      }
+      index_seek_pending = 1;
+    }
     for (uint32_t vidx_start = 0; ; ) {
       uint32_t cur_block_write_ct = 0;
       if (!IsLastBlock(&tg)) {
@@ -3579,7 +3628,12 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
           }
         VcfToPgen_load_start:
           ++line_idx;
-          line_iter = AdvPastDelim(line_iter, '\n');
+          if (likely(!index_seek_pending)) {
+            line_iter = AdvPastDelim(line_iter, '\n');
+          } else {
+            line_iter = TextLineEnd(&vcf_txs);
+            index_seek_pending = 0;
+          }
           // In principle, it shouldn't be necessary to check the exact value
           // of reterr, but this may be useful for bug investigation.
           reterr = TextNextLineUnsafe(&vcf_txs, &line_iter);
@@ -14610,8 +14664,10 @@ PglErr LoadMap(const char* mapname, MiscFlags misc_flags, ChrInfo* cip, uint32_t
       logerrputs("Error: All variants in .map/.bim file skipped due to chromosome filter.\n");
       goto LoadMap_ret_INCONSISTENT_INPUT;
     }
+    // Per-block arrays, ID strings, and the line buffer.
+    BigstackNoteExtent(tmp_alloc_base, tmp_alloc_end);
     // true requirement is weaker, but whatever
-    g_bigstack_end = g_bigstack_base;
+    BigstackEndCap(g_bigstack_base);
     g_bigstack_base = TextStreamMemStart(&map_txs);
     if (unlikely(CleanupTextStream2(mapname, &map_txs, &reterr))) {
       goto LoadMap_ret_1;
@@ -14943,13 +14999,13 @@ PglErr Plink1DosageToPgen(const char* dosagename, const char* famname, const cha
       unsigned char* bigstack_end_mark2 = g_bigstack_end;
 
       // allow hash table to only use half of available memory
-      g_bigstack_end = &(g_bigstack_base[RoundDownPow2(bigstack_left() / 2, kEndAllocAlign)]);
+      BigstackEndCap(&(g_bigstack_base[RoundDownPow2(bigstack_left() / 2, kEndAllocAlign)]));
 
       reterr = AllocAndPopulateIdHtableMt(variant_already_seen, TO_CONSTCPCONSTP(variant_ids), map_variant_ct, bigstack_left() / 2, max_thread_ct, &variant_id_htable, nullptr, &variant_id_htable_size, nullptr);
       if (unlikely(reterr)) {
         goto Plink1DosageToPgen_ret_1;
       }
-      g_bigstack_end = bigstack_end_mark2;
+      BigstackEndReset(bigstack_end_mark2);
       ZeroWArr(map_variant_ctl, variant_already_seen);
     }
 
@@ -182,6 +182,24 @@ void ReflectMatrix(uint32_t dim, double* matrix) {
   }
 }
 
+// 4 KiB of doubles per block row.
+CONSTI32(kReflectBlockSize, 512);
+
+void ReflectMatrixBlocked(uint32_t dim, double* matrix) {
+  for (uint32_t block_row_start = 0; block_row_start < dim; block_row_start += kReflectBlockSize) {
+    const uint32_t block_row_end = MINV(block_row_start + kReflectBlockSize, dim);
+    for (uint32_t block_col_start = block_row_start; block_col_start < dim; block_col_start += kReflectBlockSize) {
+      const uint32_t block_col_end = MINV(block_col_start + kReflectBlockSize, dim);
+      for (uint32_t row_idx = block_row_start; row_idx != block_row_end; ++row_idx) {
+        double* write_row = &(matrix[S_CAST(uintptr_t, row_idx) * dim]);
+        for (uint32_t col_idx = MAXV(block_col_start, row_idx + 1); col_idx < block_col_end; ++col_idx) {
+          write_row[col_idx] = matrix[S_CAST(uintptr_t, col_idx) * dim + row_idx];
+        }
+      }
+    }
+  }
+}
+
 void ReflectFmatrix(uint32_t dim, uint32_t stride, float* matrix) {
   const uintptr_t stride_p1l = stride + 1;
   float* write_row = matrix;
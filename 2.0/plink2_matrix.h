@@ -162,6 +162,11 @@ static const double kMatrixSingularRcond = 1e-14;
 // Copies (C-order) lower-left to upper right.
 void ReflectMatrix(uint32_t dim, double* matrix);
 
+// Same result as ReflectMatrix(), but works through square blocks so each
+// page is only touched a few times.  Use this when the matrix may not fit in
+// RAM (e.g. it was spilled to disk).
+void ReflectMatrixBlocked(uint32_t dim, double* matrix);
+
 void ReflectFmatrix(uint32_t dim, uint32_t stride, float* matrix);
 
 // If dim < stride, this zeroes out the trailing elements of each row.
@@ -426,6 +431,15 @@ void TransposeMultiplySelfIncr(double* input_part, uint32_t dim, uint32_t partia
 #ifndef NOLAPACK
 BoolErr GetSvdRectLwork(uint32_t major_ct, uint32_t minor_ct, __CLPK_integer* lwork_ptr);
 
+// dgesvd_()'s documented minimum lwork.  The optimal value returned by
+// GetSvdRectLwork() can be nearly as large as the matrix itself; with the
+// minimum, dgesvd_() processes the matrix in smaller chunks instead.
+HEADER_INLINE __CLPK_integer GetSvdRectMinLwork(uint32_t major_ct, uint32_t minor_ct) {
+  const uint32_t min_ct = MINV(major_ct, minor_ct);
+  const uint64_t lwork = MAXV(3 * S_CAST(uint64_t, min_ct) + MAXV(major_ct, minor_ct), 5 * S_CAST(uint64_t, min_ct));
+  return RoundUpPow2(lwork, kCacheline / sizeof(double));
+}
+
 // currently a wrapper for dgesvd_().
 IntErr SvdRect(uint32_t major_ct, uint32_t minor_ct, __CLPK_integer lwork, double* matrix, double* ss, unsigned char* svd_rect_wkspace);
 
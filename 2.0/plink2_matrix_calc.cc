@@ -557,6 +557,7 @@ typedef struct CalcKingSparseCtxStruct {
   PgenReader** pgr_ptrs;
   uintptr_t** genovecs;
   uint32_t* read_variant_uidx_starts;
+  uint32_t* task_variant_uidx_starts;
 
   // this has length >= 3 * max_sparse_ct
   uint32_t** thread_idx_bufs;
@@ -634,14 +635,25 @@ THREAD_FUNC_DECL CalcKingSparseThread(void* raw_arg) {
   // their zero-initialization jobs before we can proceed.
   while (!THREAD_BLOCK_FINISH(arg)) {
     const uint32_t cur_block_size = ctx->cur_block_size;
-    const uint32_t idx_end = ((tidx + 1) * cur_block_size) / calc_thread_ct;
-    uintptr_t variant_uidx_base;
-    uintptr_t variant_include_bits;
-    BitIter1Start(variant_include_orig, ctx->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
+    const uint32_t task_ct = GetThreadTaskCt(arg->sharedp);
+    uint32_t idx_end = 0;
+    uintptr_t variant_uidx_base = 0;
+    uintptr_t variant_include_bits = 0;
     uintptr_t* sparse_exclude = ctx->thread_sparse_excludes[parity][tidx];
     ZeroWArr(read_block_sizel, sparse_exclude);
-    // probable todo: better load-balancing
-    for (uint32_t cur_idx = (tidx * cur_block_size) / calc_thread_ct; cur_idx != idx_end; ++cur_idx) {
+    for (uint32_t cur_idx = 0; ; ++cur_idx) {
+      if (cur_idx == idx_end) {
+        // Pair corrections are quadratic in the number of rare genotypes, so
+        // per-variant cost varies wildly; variants are claimed in small
+        // work-stealing tasks.
+        uint32_t task_idx;
+        if (ClaimThreadTask(arg, &task_idx)) {
+          break;
+        }
+        cur_idx = (S_CAST(uint64_t, task_idx) * cur_block_size) / task_ct;
+        idx_end = (S_CAST(uint64_t, task_idx + 1) * cur_block_size) / task_ct;
+        BitIter1Start(variant_include_orig, ctx->task_variant_uidx_starts[task_idx], &variant_uidx_base, &variant_include_bits);
+      }
       const uint32_t variant_uidx = BitIter1(variant_include_orig, &variant_uidx_base, &variant_include_bits);
       // tried DifflistOrGenovec, difference was negligible.  Not really worth
       // considering it when calculation is inherently >O(mn).
@@ -1192,26 +1204,29 @@ typedef struct CalcKingDenseCtxStruct {
   uintptr_t* smaj_ref2het[2];
   uint32_t homhom_needed;
 
-  uint32_t* thread_start;
+  // Row boundaries of the work-stealing tasks.
+  uint32_t* task_start;
 
   uint32_t* king_counts;
 } CalcKingDenseCtx;
 
 THREAD_FUNC_DECL CalcKingDenseThread(void* raw_arg) {
   ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
-  const uintptr_t tidx = arg->tidx;
   CalcKingDenseCtx* ctx = S_CAST(CalcKingDenseCtx*, arg->sharedp->context);
 
-  const uint64_t mem_start_idx = ctx->thread_start[0];
-  const uint64_t start_idx = ctx->thread_start[tidx];
-  const uint32_t end_idx = ctx->thread_start[tidx + 1];
+  const uint64_t mem_start_idx = ctx->task_start[0];
   const uint32_t homhom_needed = ctx->homhom_needed;
   uint32_t parity = 0;
   do {
-    if (homhom_needed) {
-      IncrKingHomhom(ctx->smaj_hom[parity], ctx->smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[((start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) / 2) * 5]));
-    } else {
-      IncrKing(ctx->smaj_hom[parity], ctx->smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[(start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) * 2]));
+    uint32_t task_idx;
+    while (!ClaimThreadTask(arg, &task_idx)) {
+      const uint64_t start_idx = ctx->task_start[task_idx];
+      const uint32_t end_idx = ctx->task_start[task_idx + 1];
+      if (homhom_needed) {
+        IncrKingHomhom(ctx->smaj_hom[parity], ctx->smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[((start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) / 2) * 5]));
+      } else {
+        IncrKing(ctx->smaj_hom[parity], ctx->smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[(start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) * 2]));
+      }
     }
     parity = 1 - parity;
   } while (!THREAD_BLOCK_FINISH(arg));
@@ -1323,8 +1338,90 @@ uint32_t KingMaxSparseCt(uint32_t row_end_idx) {
 #endif
 }
 
+void KingWorkspacePlan(const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, double king_cutoff, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, KingWorkspace* kwp) {
+  ParallelBounds(sample_ct, 1, parallel_idx, parallel_tot, R_CAST(int32_t*, &kwp->grand_row_start_idx), R_CAST(int32_t*, &kwp->grand_row_end_idx));
+  const uint32_t grand_row_end_idx = kwp->grand_row_end_idx;
+  // possible todo: allow this to change between passes
+  uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
+  if (calc_thread_ct > sample_ct / 32) {
+    calc_thread_ct = sample_ct / 32;
+  }
+  if (!calc_thread_ct) {
+    calc_thread_ct = 1;
+  }
+  kwp->calc_thread_ct = calc_thread_ct;
+  kwp->homhom_needed = (king_flags & kfKingColNsnp) || ((!(king_flags & kfKingCounts)) && (king_flags & (kfKingColHethet | kfKingColIbs0 | kfKingColIbs1)));
+  const uint32_t max_sparse_ct = KingMaxSparseCt(grand_row_end_idx);
+  kwp->max_sparse_ct = max_sparse_ct;
+  // Ok for this to be a slight underestimate, since bigstack_left()/8 is an
+  // arbitrary limit anyway.
+  kwp->thread_xalloc_cacheline_ct = DivUp((3 * k1LU) * (max_sparse_ct + grand_row_end_idx), kInt32PerCacheline) + ((kPglVblockSize * 2) / kBitsPerCacheline) + DivUp(kThreadTasksPerThread, kInt32PerCacheline);
+  kwp->matrix_overflow_buf_size = kCompressStreamBlock + ((king_flags & kfKingRoundtrip)? (kMaxDoubleRSlen + 1) : 16) * sample_ct;
+  kwp->table_overflow_buf_size = kCompressStreamBlock + kMaxMediumLine;
+
+  const uintptr_t raw_variant_alloc = BitCtToCachelineCt(raw_variant_ct) * kCacheline;
+  uint64_t pre_load_byte_ct = raw_variant_alloc;
+  if (king_cutoff != -1) {
+    pre_load_byte_ct += RoundUpPow2(S_CAST(uint64_t, sample_ct) * BitCtToWordCt(sample_ct) * sizeof(intptr_t), kCacheline);
+  }
+  if (CountNonAutosomalVariants(variant_include, cip, 1, 1)) {
+    pre_load_byte_ct += raw_variant_alloc;
+  }
+  kwp->pre_load_byte_ct = pre_load_byte_ct;
+  kwp->load_thread_byte_ct = PgenMtLoadThreadCachelineCt(grand_row_end_idx, pgr_alloc_cacheline_ct, 0, 1, 0, 0, 0, 0) * kCacheline;
+
+  // Sparse-scan buffers, at full thread count and read block size.
+  const uintptr_t thread_ptrs_alloc = RoundUpPow2(calc_thread_ct * sizeof(intptr_t), kCacheline);
+  const uintptr_t thread_u32_alloc = RoundUpPow2(calc_thread_ct * sizeof(int32_t), kCacheline);
+  uint64_t post_load_byte_ct = RoundUpPow2(ThreadTaskCt(kPglVblockSize, calc_thread_ct) * sizeof(int32_t), kCacheline) + 6 * thread_ptrs_alloc + thread_u32_alloc;
+  const uintptr_t sample_u32_alloc = RoundUpPow2(grand_row_end_idx * sizeof(int32_t), kCacheline);
+  post_load_byte_ct += calc_thread_ct * (RoundUpPow2(3 * k1LU * max_sparse_ct * sizeof(int32_t), kCacheline) + 3 * sample_u32_alloc + 2 * RoundUpPow2((kPglVblockSize / kBitsPerWord) * sizeof(intptr_t), kCacheline));
+  // Dense-phase buffers.
+  const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+  const uint32_t grei_ctaw = BitCtToAlignedWordCt(grand_row_end_idx);
+  post_load_byte_ct += RoundUpPow2((calc_thread_ct * kThreadTasksPerThread + 1) * sizeof(int32_t), kCacheline) + RoundUpPow2(raw_sample_ctl * sizeof(intptr_t), kCacheline) + RoundUpPow2(raw_sample_ctl * sizeof(int32_t), kCacheline) + RoundUpPow2(NypCtToAlignedWordCt(grand_row_end_idx) * sizeof(intptr_t), kCacheline) + 2 * RoundUpPow2(kPglBitTransposeBatch * grei_ctaw * sizeof(intptr_t), kCacheline) + 4 * RoundUpPow2(S_CAST(uint64_t, kKingMultiplexWords) * grand_row_end_idx * sizeof(intptr_t), kCacheline) + kPglBitTransposeBufbytes;
+  // Output buffers.
+  if (king_flags & kfKingMatrixShapemask) {
+    if (!(king_flags & (kfKingMatrixBin | kfKingMatrixBin4))) {
+      post_load_byte_ct += CstreamAllocReq(kwp->matrix_overflow_buf_size, king_flags & kfKingMatrixZs);
+    } else {
+      post_load_byte_ct += RoundUpPow2(S_CAST(uintptr_t, sample_ct) * 4 * (2 - ((king_flags / kfKingMatrixBin4) & 1)), kCacheline);
+    }
+  }
+  if (king_flags & kfKingColAll) {
+    post_load_byte_ct += CstreamAllocReq(kwp->table_overflow_buf_size, king_flags & kfKingTableZs);
+    const uint32_t king_col_fid = FidColIsRequired(siip, king_flags / kfKingColMaybefid);
+    const uint32_t king_col_sid = SidColIsRequired(siip->sids, king_flags / kfKingColMaybesid);
+    post_load_byte_ct += RoundUpPow2(GetMaxSampleFmtidBlen(siip, king_col_fid, king_col_sid) * grand_row_end_idx, kCacheline);
+  }
+  kwp->post_load_byte_ct = post_load_byte_ct;
+  // Lower triangle without diagonal, in a single pass.
+  const uint32_t grand_row_start_idx = kwp->grand_row_start_idx;
+  kwp->cell_ct = (S_CAST(uint64_t, grand_row_end_idx) * (grand_row_end_idx - 1) - S_CAST(uint64_t, grand_row_start_idx) * (grand_row_start_idx - 1)) / 2;
+  kwp->cell_byte_ct = sizeof(int32_t) * (kwp->homhom_needed + 4);
+}
+
+uint64_t KingWorkspaceReq(const KingWorkspace* kwp, uint64_t multiread_byte_ct) {
+  // PgenMtLoadInit() is given 1/8 of what's left after the pre-load
+  // allocations; it wants 4 raw load buffers' worth for a full-size read
+  // block, and room for every thread's share (including the sparse-scan
+  // buffers carved out afterward).
+  const uint64_t thread_ct = kwp->calc_thread_ct;
+  uint64_t remaining_byte_ct = multiread_byte_ct * 32;
+  const uint64_t load_full_byte_ct = 8 * (2 * multiread_byte_ct + thread_ct * (kwp->load_thread_byte_ct + kwp->thread_xalloc_cacheline_ct * kCacheline));
+  if (remaining_byte_ct < load_full_byte_ct) {
+    remaining_byte_ct = load_full_byte_ct;
+  }
+  const uint64_t single_pass_byte_ct = 2 * multiread_byte_ct + thread_ct * kwp->load_thread_byte_ct + kwp->post_load_byte_ct + kwp->cell_ct * kwp->cell_byte_ct;
+  if (remaining_byte_ct < single_pass_byte_ct) {
+    remaining_byte_ct = single_pass_byte_ct;
+  }
+  return kwp->pre_load_byte_ct + remaining_byte_ct;
+}
+
 PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, uintptr_t* sample_include, uint32_t* sample_ct_ptr, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
+  uint32_t* king_counts_spill = nullptr;
   FILE* outfile = nullptr;
   char* cswritep = nullptr;
   char* cswritetp = nullptr;
@@ -1338,6 +1435,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
   {
     const KingFlags matrix_shape = king_flags & kfKingMatrixShapemask;
     const char* flagname = matrix_shape? "--make-king" : ((king_flags & kfKingColAll)? "--make-king-table" : "--king-cutoff");
+    const uint32_t output_roundtrip = (king_flags / kfKingRoundtrip) & 1;
     if (unlikely(IsSet(cip->haploid_mask, 0))) {
       logerrprintf("Error: %s cannot be used on haploid genomes.\n", flagname);
       goto CalcKing_ret_INCONSISTENT_INPUT;
@@ -1357,6 +1455,8 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
       goto CalcKing_ret_1;
     }
 #endif
+    KingWorkspace kw;
+    KingWorkspacePlan(siip, variant_include_orig, cip, raw_sample_ct, sample_ct, raw_variant_ct, king_cutoff, king_flags, parallel_idx, parallel_tot, max_thread_ct, pgr_alloc_cacheline_ct, &kw);
     const uintptr_t sample_ctl = BitCtToWordCt(sample_ct);
     uintptr_t* kinship_table = nullptr;
     if (king_cutoff != -1) {
@@ -1386,20 +1486,15 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
     if (unlikely(bigstack_alloc_w(raw_variant_ctl, &variant_include))) {
       goto CalcKing_ret_NOMEM;
     }
+    assert(S_CAST(uintptr_t, g_bigstack_base - bigstack_mark) == kw.pre_load_byte_ct);
 
-    uint32_t grand_row_start_idx;
-    uint32_t grand_row_end_idx;
-    ParallelBounds(sample_ct, 1, parallel_idx, parallel_tot, R_CAST(int32_t*, &grand_row_start_idx), R_CAST(int32_t*, &grand_row_end_idx));
-
-    // possible todo: allow this to change between passes
-    uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
-    if (calc_thread_ct > sample_ct / 32) {
-      calc_thread_ct = sample_ct / 32;
-    }
-    if (!calc_thread_ct) {
-      calc_thread_ct = 1;
-    }
-    const uint32_t homhom_needed = (king_flags & kfKingColNsnp) || ((!(king_flags & kfKingCounts)) && (king_flags & (kfKingColHethet | kfKingColIbs0 | kfKingColIbs1)));
+    const uint32_t grand_row_start_idx = kw.grand_row_start_idx;
+    const uint32_t grand_row_end_idx = kw.grand_row_end_idx;
+    uint32_t calc_thread_ct = kw.calc_thread_ct;
+    const uint32_t homhom_needed = kw.homhom_needed;
+#ifndef NDEBUG
+    unsigned char* post_load_mark = nullptr;
+#endif
     CalcKingSparseCtx sparse_ctx;
     uint32_t sparse_read_block_size = 0;
     STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
@@ -1411,16 +1506,17 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
     {
       sparse_ctx.variant_include_orig = variant_include_orig;
       sparse_ctx.homhom_needed = homhom_needed;
-      const uint32_t max_sparse_ct = KingMaxSparseCt(grand_row_end_idx);
-      // Ok for this to be a slight underestimate, since bigstack_left()/8 is
-      // an arbitrary limit anyway.
-      const uintptr_t thread_xalloc_cacheline_ct = DivUp((3 * k1LU) * (max_sparse_ct + grand_row_end_idx), kInt32PerCacheline) + ((kPglVblockSize * 2) / kBitsPerCacheline);
-      if (unlikely(PgenMtLoadInit(variant_include_orig, grand_row_end_idx, variant_ct, bigstack_left() / 8, pgr_alloc_cacheline_ct, thread_xalloc_cacheline_ct, 0, 0, pgfip, &calc_thread_ct, &sparse_ctx.genovecs, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &sparse_read_block_size, nullptr, main_loadbufs, &sparse_ctx.pgr_ptrs, &sparse_ctx.read_variant_uidx_starts))) {
+      const uint32_t max_sparse_ct = kw.max_sparse_ct;
+      if (unlikely(PgenMtLoadInit(variant_include_orig, grand_row_end_idx, variant_ct, bigstack_left() / 8, pgr_alloc_cacheline_ct, kw.thread_xalloc_cacheline_ct, 0, 0, pgfip, &calc_thread_ct, &sparse_ctx.genovecs, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &sparse_read_block_size, nullptr, main_loadbufs, &sparse_ctx.pgr_ptrs, &sparse_ctx.read_variant_uidx_starts))) {
         goto CalcKing_ret_NOMEM;
       }
+#ifndef NDEBUG
+      post_load_mark = g_bigstack_base;
+#endif
       sparse_ctx.read_block_size = sparse_read_block_size;
       sparse_ctx.reterr = kPglRetSuccess;
-      if (unlikely(bigstack_alloc_u32p(calc_thread_ct, &sparse_ctx.thread_idx_bufs) ||
+      if (unlikely(bigstack_alloc_u32(ThreadTaskCt(sparse_read_block_size, calc_thread_ct), &sparse_ctx.task_variant_uidx_starts) ||
+                   bigstack_alloc_u32p(calc_thread_ct, &sparse_ctx.thread_idx_bufs) ||
                    bigstack_alloc_u32p(calc_thread_ct, &sparse_ctx.thread_singleton_het_cts) ||
                    bigstack_alloc_u32p(calc_thread_ct, &sparse_ctx.thread_singleton_hom_cts) ||
                    bigstack_alloc_u32p(calc_thread_ct, &sparse_ctx.thread_singleton_missing_cts) ||
@@ -1447,7 +1543,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
 
     CalcKingDenseCtx dense_ctx;
     if (unlikely(SetThreadCt(calc_thread_ct, &tg) ||
-                 bigstack_alloc_u32(calc_thread_ct + 1, &dense_ctx.thread_start))) {
+                 bigstack_alloc_u32(calc_thread_ct * kThreadTasksPerThread + 1, &dense_ctx.task_start))) {
       goto CalcKing_ret_NOMEM;
     }
     const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
@@ -1482,9 +1578,8 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
       SetKingMatrixFname(king_flags, parallel_idx, parallel_tot, outname_end);
       if (!(king_flags & (kfKingMatrixBin | kfKingMatrixBin4))) {
         // text matrix
-        // won't be >2gb since sample_ct <= 134m
-        const uint32_t overflow_buf_size = kCompressStreamBlock + 16 * sample_ct;
-        reterr = InitCstreamAlloc(outname, 0, king_flags & kfKingMatrixZs, max_thread_ct, overflow_buf_size, &css, &cswritep);
+        // won't be >4gb since sample_ct <= 134m
+        reterr = InitCstreamAlloc(outname, 0, king_flags & kfKingMatrixZs, max_thread_ct, kw.matrix_overflow_buf_size, &css, &cswritep);
         if (unlikely(reterr)) {
           goto CalcKing_ret_1;
         }
@@ -1502,9 +1597,8 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
     uintptr_t max_sample_fmtid_blen = 0;
     char* collapsed_sample_fmtids = nullptr;
     if (king_flags & kfKingColAll) {
-      const uint32_t overflow_buf_size = kCompressStreamBlock + kMaxMediumLine;
       SetKingTableFname(king_flags, parallel_idx, parallel_tot, outname_end);
-      reterr = InitCstreamAlloc(outname, 0, king_flags & kfKingTableZs, max_thread_ct, overflow_buf_size, &csst, &cswritetp);
+      reterr = InitCstreamAlloc(outname, 0, king_flags & kfKingTableZs, max_thread_ct, kw.table_overflow_buf_size, &csst, &cswritetp);
       if (unlikely(reterr)) {
         goto CalcKing_ret_1;
       }
@@ -1518,23 +1612,38 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
         goto CalcKing_ret_NOMEM;
       }
     }
+    assert(S_CAST(uintptr_t, g_bigstack_base - post_load_mark) <= kw.post_load_byte_ct);
     uint64_t king_table_filter_ct = 0;
-    const uintptr_t cells_avail = bigstack_left() / (sizeof(int32_t) * homhom_needed_p4);
-    const uint32_t pass_ct = CountTrianglePasses(grand_row_start_idx, grand_row_end_idx, 1, cells_avail);
-    if (unlikely(!pass_ct)) {
-      goto CalcKing_ret_NOMEM;
-    }
-    if (unlikely((pass_ct > 1) && (king_flags & kfKingMatrixSq))) {
-      logerrputs("Insufficient memory for --make-king square output.  Try square0 or triangle\nshape instead.\n");
-      goto CalcKing_ret_NOMEM;
+    uintptr_t cells_avail = bigstack_left() / kw.cell_byte_ct;
+    uint32_t pass_ct = CountTrianglePasses(grand_row_start_idx, grand_row_end_idx, 1, cells_avail);
+    uint32_t* king_counts = R_CAST(uint32_t*, g_bigstack_base);
+    if ((!pass_ct) || ((pass_ct > 1) && (king_flags & kfKingMatrixSq))) {
+      // Square output needs the whole triangle at once.  Try to get it from
+      // --spill-dir; every variant block sweeps the triangle in order.
+      const uintptr_t cell_ct = kw.cell_ct;
+      if (unlikely(SpillAlloc(cell_ct * kw.cell_byte_ct, 1, flagname, &king_counts_spill))) {
+        if (pass_ct) {
+          logerrputs("Insufficient memory for --make-king square output.  Try square0 or triangle\nshape, or --spill-dir, instead.\n");
+        }
+        goto CalcKing_ret_NOMEM;
+      }
+      king_counts = king_counts_spill;
+      cells_avail = cell_ct;
+      pass_ct = 1;
     }
     uint32_t row_end_idx = grand_row_start_idx;
-    sparse_ctx.king_counts = R_CAST(uint32_t*, g_bigstack_base);
+    sparse_ctx.king_counts = king_counts;
     dense_ctx.king_counts = sparse_ctx.king_counts;
     for (uint32_t pass_idx_p1 = 1; pass_idx_p1 <= pass_ct; ++pass_idx_p1) {
       const uint32_t row_start_idx = row_end_idx;
       row_end_idx = NextTrianglePass(row_start_idx, grand_row_end_idx, 1, cells_avail);
-      TriangleLoadBalance(calc_thread_ct, row_start_idx, row_end_idx, 1, dense_ctx.thread_start);
+      if (!king_counts_spill) {
+        // king_counts is carved out past g_bigstack_base.
+        const uint64_t pass_cell_ct = (S_CAST(uint64_t, row_end_idx) * (row_end_idx - 1) - S_CAST(uint64_t, row_start_idx) * (row_start_idx - 1)) / 2;
+        BigstackNoteExtent(&(king_counts[pass_cell_ct * homhom_needed_p4]), g_bigstack_end);
+      }
+      const uint32_t dense_task_ct = ThreadTaskCt(row_end_idx - row_start_idx, calc_thread_ct);
+      TriangleLoadBalance(dense_task_ct, row_start_idx, row_end_idx, 1, dense_ctx.task_start);
       memcpy(cur_sample_include, sample_include, raw_sample_ctl * sizeof(intptr_t));
       // bugfix (20 Nov 2019): forgot that --parallel could cause the old
       // row_end_idx != grand_row_end_idx comparison not work
@@ -1580,7 +1689,9 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
           }
           if (!IsLastBlock(&tg)) {
             sparse_ctx.cur_block_size = cur_block_size;
-            ComputeUidxStartPartition(variant_include_orig, cur_block_size, calc_thread_ct, read_block_idx * sparse_read_block_size, sparse_ctx.read_variant_uidx_starts);
+            const uint32_t task_ct = ThreadTaskCt(cur_block_size, calc_thread_ct);
+            ComputeUidxStartPartition(variant_include_orig, cur_block_size, task_ct, read_block_idx * sparse_read_block_size, sparse_ctx.task_variant_uidx_starts);
+            SetThreadTaskCt(task_ct, &tg);
             PgrCopyBaseAndOffset(pgfip, calc_thread_ct, sparse_ctx.pgr_ptrs);
             if (variant_idx + cur_block_size == variant_ct) {
               DeclareLastThreadBlock(&tg);
@@ -1768,6 +1879,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
           if (variants_completed + cur_block_size == cur_variant_ct) {
             DeclareLastThreadBlock(&tg);
           }
+          SetThreadTaskCt(dense_task_ct, &tg);
           if (unlikely(SpawnThreads(&tg))) {
             goto CalcKing_ret_THREAD_CREATE_FAIL;
           }
@@ -1801,7 +1913,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
                   SetBit(sample_idx2, &(kinship_table[sample_idx1 * sample_ctl]));
                   SetBit(sample_idx1, &(kinship_table[sample_idx2 * sample_ctl]));
                 }
-                cswritep = dtoa_g(kinship_coeff, cswritep);
+                cswritep = dtoa_gr(kinship_coeff, output_roundtrip, cswritep);
                 *cswritep++ = '\t';
                 results_iter = &(results_iter[homhom_needed_p4]);
               }
@@ -1836,7 +1948,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
                   // sample_idx1 = 3: [6] 9 13...
                   for (uint32_t sample_idx2 = sample_idx1 + 1; sample_idx2 != sample_ct; ++sample_idx2) {
                     *cswritep++ = '\t';
-                    cswritep = dtoa_g(ComputeKinship(results_iter2, singleton_het1_ct, singleton_hom1_ct, singleton_het_cts[sample_idx2], singleton_hom_cts[sample_idx2]), cswritep);
+                    cswritep = dtoa_gr(ComputeKinship(results_iter2, singleton_het1_ct, singleton_hom1_ct, singleton_het_cts[sample_idx2], singleton_hom_cts[sample_idx2]), output_roundtrip, cswritep);
                     results_iter2 = &(results_iter2[sample_idx2 * homhom_needed_p4]);
                   }
                 }
@@ -1989,7 +2101,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
                 if (report_counts) {
                   cswritetp = u32toa(hethet_ct, cswritetp);
                 } else {
-                  cswritetp = dtoa_g(nonmiss_recip * u31tod(hethet_ct), cswritetp);
+                  cswritetp = dtoa_gr(nonmiss_recip * u31tod(hethet_ct), output_roundtrip, cswritetp);
                 }
                 *cswritetp++ = '\t';
               }
@@ -1997,7 +2109,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
                 if (report_counts) {
                   cswritetp = u32toa(ibs0_ct, cswritetp);
                 } else {
-                  cswritetp = dtoa_g(nonmiss_recip * u31tod(ibs0_ct), cswritetp);
+                  cswritetp = dtoa_gr(nonmiss_recip * u31tod(ibs0_ct), output_roundtrip, cswritetp);
                 }
                 *cswritetp++ = '\t';
               }
@@ -2006,14 +2118,14 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
                   cswritetp = u32toa_x(het1hom2_ct, '\t', cswritetp);
                   cswritetp = u32toa(het2hom1_ct, cswritetp);
                 } else {
-                  cswritetp = dtoa_g(nonmiss_recip * u31tod(het1hom2_ct), cswritetp);
+                  cswritetp = dtoa_gr(nonmiss_recip * u31tod(het1hom2_ct), output_roundtrip, cswritetp);
                   *cswritetp++ = '\t';
-                  cswritetp = dtoa_g(nonmiss_recip * u31tod(het2hom1_ct), cswritetp);
+                  cswritetp = dtoa_gr(nonmiss_recip * u31tod(het2hom1_ct), output_roundtrip, cswritetp);
                 }
                 *cswritetp++ = '\t';
               }
               if (king_col_kinship) {
-                cswritetp = dtoa_g(kinship_coeff, cswritetp);
+                cswritetp = dtoa_gr(kinship_coeff, output_roundtrip, cswritetp);
                 ++cswritetp;
               }
               DecrAppendBinaryEoln(&cswritetp);
@@ -2142,6 +2254,7 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
   CswriteCloseCond(&csst, cswritetp);
   CswriteCloseCond(&css, cswritep);
   fclose_cond(outfile);
+  SpillFree(king_counts_spill);
   BigstackReset(bigstack_mark);
   return reterr;
 }
@@ -2864,7 +2977,7 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
       // 32-bit ctx.thread_start[] for now
       pair_buf_capacity = 0xffffffffU;
     }
-    ctx.loaded_sample_idx_pairs = S_CAST(uint32_t*, bigstack_alloc_raw_rd(pair_buf_capacity * 2 * sizeof(int32_t)));
+    ctx.loaded_sample_idx_pairs = S_CAST(uint32_t*, BigstackAllocElastic(pair_buf_capacity * 2 * sizeof(int32_t)));
     ctx.king_counts = R_CAST(uint32_t*, g_bigstack_base);
     SetThreadFuncAndData(CalcKingTableSubsetThread, &ctx, &tg);
 
@@ -3075,6 +3188,7 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
       const uint32_t king_col_ibs1 = king_flags & kfKingColIbs1;
       const uint32_t king_col_kinship = king_flags & kfKingColKinship;
       const uint32_t report_counts = king_flags & kfKingCounts;
+      const uint32_t output_roundtrip = (king_flags / kfKingRoundtrip) & 1;
       uint32_t* results_iter = ctx.king_counts;
       double nonmiss_recip = 0.0;
       for (uintptr_t cur_pair_idx = 0; cur_pair_idx != cur_pair_ct; ++cur_pair_idx, results_iter = &(results_iter[homhom_needed_p4])) {
@@ -3108,7 +3222,7 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
           if (report_counts) {
             cswritep = u32toa(hethet_ct, cswritep);
           } else {
-            cswritep = dtoa_g(nonmiss_recip * u31tod(hethet_ct), cswritep);
+            cswritep = dtoa_gr(nonmiss_recip * u31tod(hethet_ct), output_roundtrip, cswritep);
           }
           *cswritep++ = '\t';
         }
@@ -3116,7 +3230,7 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
           if (report_counts) {
             cswritep = u32toa(ibs0_ct, cswritep);
           } else {
-            cswritep = dtoa_g(nonmiss_recip * u31tod(ibs0_ct), cswritep);
+            cswritep = dtoa_gr(nonmiss_recip * u31tod(ibs0_ct), output_roundtrip, cswritep);
           }
           *cswritep++ = '\t';
         }
@@ -3125,14 +3239,14 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
             cswritep = u32toa_x(het1hom2_ct, '\t', cswritep);
             cswritep = u32toa(het2hom1_ct, cswritep);
           } else {
-            cswritep = dtoa_g(nonmiss_recip * u31tod(het1hom2_ct), cswritep);
+            cswritep = dtoa_gr(nonmiss_recip * u31tod(het1hom2_ct), output_roundtrip, cswritep);
             *cswritep++ = '\t';
-            cswritep = dtoa_g(nonmiss_recip * u31tod(het2hom1_ct), cswritep);
+            cswritep = dtoa_gr(nonmiss_recip * u31tod(het2hom1_ct), output_roundtrip, cswritep);
           }
           *cswritep++ = '\t';
         }
         if (king_col_kinship) {
-          cswritep = dtoa_g(kinship_coeff, cswritep);
+          cswritep = dtoa_gr(kinship_coeff, output_roundtrip, cswritep);
           ++cswritep;
         }
         DecrAppendBinaryEoln(&cswritep);
@@ -3765,6 +3879,13 @@ THREAD_FUNC_DECL CalcDblMissingThread(void* raw_arg) {
   THREAD_RETURN;
 }
 
+void MissingMatrixWorkspaceReq(uint32_t row_start_idx, uintptr_t row_end_idx, uint32_t max_thread_ct, uint64_t* kept_byte_ct_ptr, uint64_t* temp_byte_ct_ptr) {
+  const uint64_t cell_ct = (S_CAST(uint64_t, row_end_idx) * (row_end_idx - 1) - S_CAST(uint64_t, row_start_idx) * (row_start_idx - 1)) / 2;
+  *kept_byte_ct_ptr = RoundUpPow2(row_end_idx * sizeof(int32_t), kCacheline) + RoundUpPow2(cell_ct * sizeof(int32_t), kCacheline);
+  const uint32_t calc_thread_ct = (max_thread_ct > 8)? (max_thread_ct - 1) : max_thread_ct;
+  *temp_byte_ct_ptr = 2 * BitCtToCachelineCt(row_end_idx) * kCacheline + NypCtToCachelineCt(row_end_idx) * kCacheline + RoundUpPow2(BitCtToAlignedWordCt(row_end_idx) * (k1LU * kDblMissingBlockSize) * sizeof(intptr_t), kCacheline) + 2 * RoundUpPow2(RoundUpPow2(row_end_idx, 2) * kDblMissingBlockWordCt * sizeof(intptr_t), kCacheline) + kPglBitTransposeBufbytes + RoundUpPow2((calc_thread_ct + 1) * sizeof(int32_t), kCacheline);
+}
+
 PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const uintptr_t* variant_include, uint32_t sample_ct, uint32_t variant_ct, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t row_start_idx, uintptr_t row_end_idx, uint32_t max_thread_ct, PgenReader* simple_pgrp, uint32_t** missing_cts_ptr, uint32_t** missing_dbl_exclude_cts_ptr) {
   unsigned char* bigstack_mark = g_bigstack_base;
   ThreadGroup tg;
@@ -3796,6 +3917,14 @@ PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample
                  bigstack_alloc_u32(calc_thread_ct + 1, &ctx.thread_start))) {
       goto CalcMissingMatrix_ret_NOMEM;
     }
+#ifndef NDEBUG
+    {
+      uint64_t kept_byte_ct;
+      uint64_t temp_byte_ct;
+      MissingMatrixWorkspaceReq(row_start_idx, row_end_idx, max_thread_ct, &kept_byte_ct, &temp_byte_ct);
+      assert(S_CAST(uintptr_t, g_bigstack_base - bigstack_mark) == kept_byte_ct + temp_byte_ct);
+    }
+#endif
     // note that this ctx.thread_start[] may have different values than the one
     // computed by CalcGrm(), since calc_thread_ct changes in the MTBLAS and
     // OS X cases.
@@ -3916,11 +4045,80 @@ PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample
   return reterr;
 }
 
+void GrmWorkspacePlan(const uintptr_t* variant_include, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t max_allele_ct, uint32_t multiallelic_needed, PgenGlobalFlags gflags, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, GrmWorkspace* gwp) {
+#if defined(__APPLE__) || defined(USE_MTBLAS)
+  uint32_t calc_thread_ct = 1;
+#else
+  uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
+  if (calc_thread_ct * parallel_tot > sample_ct / 32) {
+    calc_thread_ct = sample_ct / (32 * parallel_tot);
+    if (!calc_thread_ct) {
+      calc_thread_ct = 1;
+    }
+  }
+#endif
+  gwp->calc_thread_ct = calc_thread_ct;
+  // Same outer bounds as TriangleFill().
+  uint32_t row_start_idx = 0;
+  uint32_t row_end_idx = sample_ct;
+  if (parallel_tot != 1) {
+    ParallelBounds(sample_ct, 0, parallel_idx, parallel_tot, R_CAST(int32_t*, &row_start_idx), R_CAST(int32_t*, &row_end_idx));
+  }
+  gwp->row_start_idx = row_start_idx;
+  gwp->row_end_idx = row_end_idx;
+  const uintptr_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+  const uintptr_t raw_variant_alloc = BitCtToCachelineCt(raw_variant_ct) * kCacheline;
+  uint64_t main_byte_ct = 0;
+  const uint32_t smaj_needed = (calc_thread_ct != 1) || parallel_idx;
+  if ((calc_thread_ct != 1) || (parallel_tot != 1)) {
+    main_byte_ct += RoundUpPow2((calc_thread_ct + 1) * sizeof(int32_t), kCacheline);
+    if (row_end_idx < sample_ct) {
+      main_byte_ct += RoundUpPow2(raw_sample_ctl * sizeof(intptr_t), kCacheline);
+    }
+  }
+  main_byte_ct += RoundUpPow2(S_CAST(uint64_t, row_end_idx - row_start_idx) * row_end_idx * sizeof(double), kCacheline) + RoundUpPow2(raw_sample_ctl * sizeof(int32_t), kCacheline) + PgvAllocReq(row_end_idx, multiallelic_needed, gflags) + RoundUpPow2(max_allele_ct * sizeof(double), kCacheline);
+  if (CountNonAutosomalVariants(variant_include, cip, 1, 1)) {
+    main_byte_ct += raw_variant_alloc;
+  }
+  const uintptr_t dosage_buf_alloc = RoundUpPow2(S_CAST(uintptr_t, row_end_idx) * kGrmVariantBlockSize * sizeof(double), kCacheline);
+  main_byte_ct += (2 + 2 * smaj_needed) * dosage_buf_alloc;
+  uint64_t missing_kept_byte_ct = 0;
+  uint64_t missing_temp_byte_ct = 0;
+  if (!(grm_flags & kfGrmMeanimpute)) {
+    main_byte_ct += raw_variant_alloc;
+    // Upper bound; nothing is allocated if there are no missing calls.
+    MissingMatrixWorkspaceReq(row_start_idx, row_end_idx, max_thread_ct, &missing_kept_byte_ct, &missing_temp_byte_ct);
+  }
+  gwp->main_byte_ct = main_byte_ct;
+  uint64_t output_byte_ct = 0;
+  const GrmFlags matrix_shape = grm_flags & kfGrmMatrixShapemask;
+  if (matrix_shape) {
+    if (grm_flags & kfGrmMatrixBin) {
+      if (matrix_shape == kfGrmMatrixSq) {
+        output_byte_ct = RoundUpPow2((row_end_idx - row_start_idx - 1) * sizeof(double), kCacheline);
+      }
+    } else if (grm_flags & kfGrmMatrixBin4) {
+      output_byte_ct = RoundUpPow2(row_end_idx * sizeof(float), kCacheline);
+    } else {
+      output_byte_ct = CstreamAllocReq(kCompressStreamBlock + 16 * row_end_idx, grm_flags & kfGrmMatrixZs);
+    }
+  } else if (grm_flags & kfGrmBin) {
+    output_byte_ct = RoundUpPow2(row_end_idx * sizeof(float), kCacheline);
+  } else if (grm_flags & kfGrmListmask) {
+    output_byte_ct = CstreamAllocReq(kCompressStreamBlock + kMaxMediumLine, !(grm_flags & kfGrmListNoGz));
+  }
+  // CalcMissingMatrix() frees its scratch buffers before the output ones are
+  // allocated.
+  gwp->byte_ct = main_byte_ct + missing_kept_byte_ct + MAXV(missing_temp_byte_ct, output_byte_ct);
+}
+
 PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end, double** grm_ptr) {
   unsigned char* bigstack_mark = g_bigstack_base;
   unsigned char* bigstack_end_mark = g_bigstack_end;
   FILE* outfile = nullptr;
   char* cswritep = nullptr;
+  double* grm = nullptr;
+  uint32_t grm_is_spilled = 0;
   CompressStreamState css;
   ThreadGroup tg;
   PglErr reterr = kPglRetSuccess;
@@ -3928,21 +4126,13 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
   PreinitThreads(&tg);
   {
     assert(variant_ct);
-#if defined(__APPLE__) || defined(USE_MTBLAS)
-    uint32_t calc_thread_ct = 1;
-#else
-    uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
-    if (calc_thread_ct * parallel_tot > sample_ct / 32) {
-      calc_thread_ct = sample_ct / (32 * parallel_tot);
-      if (!calc_thread_ct) {
-        calc_thread_ct = 1;
-      }
-    }
-#endif
     if (unlikely(sample_ct < 2)) {
       logerrputs("Error: GRM construction requires at least two samples.\n");
       goto CalcGrm_ret_DEGENERATE_DATA;
     }
+    GrmWorkspace gw;
+    GrmWorkspacePlan(variant_include, cip, raw_sample_ct, sample_ct, raw_variant_ct, max_allele_ct, (allele_idx_offsets != nullptr), PgrGetGflags(simple_pgrp), grm_flags, parallel_idx, parallel_tot, max_thread_ct, &gw);
+    const uint32_t calc_thread_ct = gw.calc_thread_ct;
     const uintptr_t* sample_include = orig_sample_include;
     const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
     uint32_t row_start_idx = 0;
@@ -3960,6 +4150,7 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       TriangleFill(sample_ct, calc_thread_ct, parallel_idx, parallel_tot, 0, 1, thread_start);
       row_start_idx = thread_start[0];
       row_end_idx = thread_start[calc_thread_ct];
+      assert((row_start_idx == gw.row_start_idx) && (row_end_idx == gw.row_end_idx));
       if (row_end_idx < sample_ct) {
         // 0
         // 0 0
@@ -3987,11 +4178,12 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
 
     CalcGrmPartCtx ctx;
     ctx.thread_start = thread_start;
-    double* grm;
     if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
       goto CalcGrm_ret_NOMEM;
     }
-    if (unlikely(bigstack_calloc_d((row_end_idx - row_start_idx) * row_end_idx, &grm))) {
+    // With --spill-dir, the matrix may end up file-backed.  Each variant block
+    // sweeps it in row order, so sequential readahead fits.
+    if (unlikely(BigstackAllocOrSpill((row_end_idx - row_start_idx) * row_end_idx * sizeof(double), 1, 1, grm_ptr? "--pca" : "GRM construction", &grm, &grm_is_spilled))) {
       if (!grm_ptr) {
         logerrputs("Error: Out of memory.  If you are SURE you are performing the right matrix\ncomputation, you can split it into smaller pieces with --parallel, and then\nconcatenate the results.  But before you try this, make sure the program you're\nproviding the matrix to can actually handle such a large input file.\n");
       } else {
@@ -4042,6 +4234,7 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       ctx.normed_dosage_smaj_bufs[1] = nullptr;
       SetThreadFuncAndData(CalcGrmThread, &ctx, &tg);
     }
+    assert(S_CAST(uintptr_t, (g_bigstack_base - bigstack_mark) + (bigstack_end_mark - g_bigstack_end)) <= gw.main_byte_ct);
 #ifdef USE_MTBLAS
     const uint32_t blas_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
     BLAS_SET_NUM_THREADS(blas_thread_ct);
@@ -4163,6 +4356,17 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
         // --make-rel
         fputs("--make-rel: Writing...", stdout);
         fflush(stdout);
+        // Square output normally reads the upper triangle column-by-column out
+        // of the lower triangle.  That's a strided sweep over the whole matrix
+        // per row, which is hopeless when grm[] is file-backed; in that case,
+        // fill in the upper triangle blockwise first and read it by row.
+        uintptr_t grm_sq_row_stride = 1;
+        uintptr_t grm_sq_col_stride = sample_ct;
+        if (grm_is_spilled && (matrix_shape == kfGrmMatrixSq) && (parallel_tot == 1)) {
+          ReflectMatrixBlocked(sample_ct, grm);
+          grm_sq_row_stride = sample_ct;
+          grm_sq_col_stride = 1;
+        }
         if (grm_flags & kfGrmMatrixBin) {
           char* outname_end2 = strcpya_k(outname_end, ".rel.bin");
           if (parallel_tot != 1) {
@@ -4206,9 +4410,9 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
               }
             } else if (matrix_shape == kfGrmMatrixSq) {
               double* write_double_iter = write_double_buf;
-              const double* grm_col = &(grm[row_idx - 1]);
+              const double* grm_col = &(grm[(row_idx - 1) * grm_sq_row_stride]);
               for (uintptr_t row_idx2 = row_idx; row_idx2 != sample_ct; ++row_idx2) {
-                *write_double_iter++ = grm_col[(row_idx2 - row_start_idx) * sample_ct];
+                *write_double_iter++ = grm_col[(row_idx2 - row_start_idx) * grm_sq_col_stride];
               }
               if (unlikely(fwrite_checked(write_double_buf, (sample_ct - row_idx) * sizeof(double), outfile))) {
                 goto CalcGrm_ret_WRITE_FAIL;
@@ -4245,9 +4449,9 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
               ZeroFArr(sample_ct - row_idx, write_float_iter);
               write_float_iter = &(write_float_buf[sample_ct]);
             } else if (matrix_shape == kfGrmMatrixSq) {
-              const double* grm_col = &(grm[row_idx - 1]);
+              const double* grm_col = &(grm[(row_idx - 1) * grm_sq_row_stride]);
               for (uintptr_t row_idx2 = row_idx; row_idx2 != sample_ct; ++row_idx2) {
-                *write_float_iter++ = S_CAST(float, grm_col[(row_idx2 - row_start_idx) * sample_ct]);
+                *write_float_iter++ = S_CAST(float, grm_col[(row_idx2 - row_start_idx) * grm_sq_col_stride]);
               }
             }
             if (unlikely(fwrite_checked(write_float_buf, sizeof(float) * S_CAST(uintptr_t, write_float_iter - write_float_buf), outfile))) {
@@ -4296,9 +4500,9 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
               }
               cswritep = &(cswritep[zcount * 2]);
             } else if (matrix_shape == kfGrmMatrixSq) {
-              const double* grm_col = &(grm[row_idx - 1]);
+              const double* grm_col = &(grm[(row_idx - 1) * grm_sq_row_stride]);
               for (uintptr_t row_idx2 = row_idx; row_idx2 != sample_ct; ++row_idx2) {
-                cswritep = dtoa_g(grm_col[(row_idx2 - row_start_idx) * sample_ct], cswritep);
+                cswritep = dtoa_g(grm_col[(row_idx2 - row_start_idx) * grm_sq_col_stride], cswritep);
                 *cswritep++ = '\t';
               }
             }
@@ -4491,11 +4695,15 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       WordWrapB(0);
       logputsb();
     }
+    assert(S_CAST(uintptr_t, (g_bigstack_base - bigstack_mark) + (bigstack_end_mark - g_bigstack_end)) <= gw.byte_ct);
 
     if (grm_ptr) {
       *grm_ptr = grm;
-      // allocation right on top of grm[]
+      // allocation right on top of grm[] (or on top of new_sample_include if
+      // grm[] was spilled)
       bigstack_mark = R_CAST(unsigned char*, sample_include_cumulative_popcounts);
+      // CalcPca() takes ownership
+      grm_is_spilled = 0;
     }
   }
   while (0) {
@@ -4526,6 +4734,9 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
   fclose_cond(outfile);
   CleanupThreads(&tg);
   BLAS_SET_NUM_THREADS(1);
+  if (grm_is_spilled) {
+    SpillFree(grm);
+  }
   BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
   return reterr;
 }
@@ -4932,6 +5143,8 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
   unsigned char* bigstack_mark = g_bigstack_base;
   FILE* outfile = nullptr;
   char* cswritep = nullptr;
+  double* qq = nullptr;
+  uint32_t qq_is_spilled = 0;
   CompressStreamState css;
   ThreadGroup tg;
   PreinitThreads(&tg);
@@ -5028,7 +5241,6 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
     const uintptr_t pca_row_ct = CountAlleles(variant_include, allele_idx_offsets, raw_variant_ct, variant_ct) - biallelic_variant_ct;
     const uint32_t is_haploid = cip->haploid_mask[0] & 1;
     uint32_t cur_allele_ct = 2;
-    double* qq = nullptr;
     double* eigvecs_smaj;
     char* writebuf;
     if (is_approx) {
@@ -5072,20 +5284,28 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
         goto CalcPca_ret_INCONSISTENT_INPUT;
       }
 #endif
-      uintptr_t svd_rect_wkspace_size = (svd_rect_lwork + qq_col_ct * qq_col_ct) * sizeof(double);
-      if (svd_rect_wkspace_size < writebuf_alloc) {
-        // used as writebuf later
-        svd_rect_wkspace_size = writebuf_alloc;
-      }
 
       unsigned char* svd_rect_wkspace;
       double* ss;
       double* g1;
+      // qq[] is filled and consumed in variant-block order, so it can be
+      // spilled to disk (--spill-dir) without much random access.
       if (unlikely(bigstack_alloc_d(qq_col_ct, &ss) ||
-                   bigstack_alloc_d(pca_row_ct * qq_col_ct, &qq) ||
+                   BigstackAllocOrSpill(pca_row_ct * qq_col_ct * sizeof(double), 0, 1, "--pca approx", &qq, &qq_is_spilled) ||
                    bigstack_alloc_dp(calc_thread_ct, &ctx.y_transpose_bufs) ||
-                   bigstack_alloc_dp(calc_thread_ct, &ctx.g2_bb_part_bufs) ||
-                   bigstack_alloc_uc(svd_rect_wkspace_size, &svd_rect_wkspace) ||
+                   bigstack_alloc_dp(calc_thread_ct, &ctx.g2_bb_part_bufs))) {
+        goto CalcPca_ret_NOMEM;
+      }
+      if (qq_is_spilled) {
+        // The optimal SVD workspace is about as large as qq[] itself.
+        svd_rect_lwork = GetSvdRectMinLwork(MAXV(pca_sample_ct, pca_row_ct), qq_col_ct);
+      }
+      uintptr_t svd_rect_wkspace_size = (svd_rect_lwork + qq_col_ct * qq_col_ct) * sizeof(double);
+      if (svd_rect_wkspace_size < writebuf_alloc) {
+        // used as writebuf later
+        svd_rect_wkspace_size = writebuf_alloc;
+      }
+      if (unlikely(bigstack_alloc_uc(svd_rect_wkspace_size, &svd_rect_wkspace) ||
                    bigstack_alloc_d(gg_size, &g1))) {
         goto CalcPca_ret_NOMEM;
       }
@@ -5440,12 +5660,13 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
         var_wts_part_size = (MINV(pca_row_ct, calc_thread_ct * kPcaVariantBlockSize)) * S_CAST(uintptr_t, pc_ct);
         var_wts = S_CAST(double*, arena_alloc_raw_rd(2 * var_wts_part_size * sizeof(double), &arena_bottom));
         vwctx.var_wts = var_wts;
-#ifndef NDEBUG
         if (arena_top == g_bigstack_end) {
+          BigstackNoteExtent(arena_bottom, arena_top);
+#ifndef NDEBUG
           // we shouldn't make any more allocations, but just in case...
           g_bigstack_base = arena_bottom;
-        }
 #endif
+        }
       }
       if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
         goto CalcPca_ret_NOMEM;
@@ -5617,8 +5838,11 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
   BLAS_SET_NUM_THREADS(1);
   CswriteCloseCond(&css, cswritep);
   fclose_cond(outfile);
-  if (grm) {
-    // nothing after --pca in the plink2 order of operations uses grm[]
+  if (qq_is_spilled) {
+    SpillFree(qq);
+  }
+  // nothing after --pca in the plink2 order of operations uses grm[]
+  if (grm && (!SpillFree(grm))) {
     BigstackReset(grm);
   } else {
     BigstackReset(bigstack_mark);
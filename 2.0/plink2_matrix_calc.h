@@ -51,7 +51,10 @@ FLAGSET_DEF_START()
   kfKingColIbs1 = (1 << 17),
   kfKingColKinship = (1 << 18),
   kfKingColDefault = (kfKingColMaybefid | kfKingColId | kfKingColMaybesid | kfKingColNsnp | kfKingColHethet | kfKingColIbs0 | kfKingColKinship),
-  kfKingColAll = ((kfKingColKinship * 2) - kfKingColMaybefid)
+  kfKingColAll = ((kfKingColKinship * 2) - kfKingColMaybefid),
+
+  // set by --output-roundtrip
+  kfKingRoundtrip = (1 << 19)
 FLAGSET_DEF_END(KingFlags);
 
 FLAGSET_DEF_START()
@@ -176,10 +179,51 @@ void CleanupScore(ScoreInfo* score_info_ptr);
 
 PglErr KingCutoffBatch(const SampleIdInfo* siip, uint32_t raw_sample_ct, double king_cutoff, uintptr_t* sample_include, char* king_cutoff_fprefix, uint32_t* sample_ct_ptr);
 
+// Workspace layout of CalcKing(), shared with --dry-run.  Byte counts assume
+// the full thread count and read block size, so they're upper bounds.
+typedef struct KingWorkspaceStruct {
+  uint32_t grand_row_start_idx;
+  uint32_t grand_row_end_idx;
+  uint32_t calc_thread_ct;
+  uint32_t homhom_needed;
+  uint32_t max_sparse_ct;
+  uintptr_t thread_xalloc_cacheline_ct;
+  uintptr_t matrix_overflow_buf_size;
+  uintptr_t table_overflow_buf_size;
+  // allocated before PgenMtLoadInit()
+  uint64_t pre_load_byte_ct;
+  // PgenMtLoadInit() per-thread allocations, excluding thread_xalloc
+  uint64_t load_thread_byte_ct;
+  // sparse-scan, transpose, and output buffers
+  uint64_t post_load_byte_ct;
+  // lower triangle without diagonal, in a single pass
+  uint64_t cell_ct;
+  uintptr_t cell_byte_ct;
+} KingWorkspace;
+
+void KingWorkspacePlan(const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, double king_cutoff, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, KingWorkspace* kwp);
+
+// Workspace (bytes) CalcKing() needs to finish in a single pass at full thread
+// count, given the size of one raw load buffer for a full read block.
+uint64_t KingWorkspaceReq(const KingWorkspace* kwp, uint64_t multiread_byte_ct);
+
 PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, uintptr_t* sample_include, uint32_t* sample_ct_ptr, char* outname, char* outname_end);
 
 PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* subset_fname, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_table_filter, double king_table_subset_thresh, uint32_t rel_check, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end);
 
+// Workspace layout of CalcGrm(), shared with --dry-run.
+typedef struct GrmWorkspaceStruct {
+  uint32_t calc_thread_ct;
+  uint32_t row_start_idx;
+  uint32_t row_end_idx;
+  // everything allocated before the main loop
+  uint64_t main_byte_ct;
+  // peak, including missingness correction and output buffers
+  uint64_t byte_ct;
+} GrmWorkspace;
+
+void GrmWorkspacePlan(const uintptr_t* variant_include, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t max_allele_ct, uint32_t multiallelic_needed, PgenGlobalFlags gflags, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, GrmWorkspace* gwp);
+
 PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end, double** grm_ptr);
 
 #ifndef NOLAPACK
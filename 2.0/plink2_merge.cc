@@ -118,8 +118,7 @@ PmergeInputFilesetLl* AllocFilesetLlEntry(PmergeInputFilesetLl*** filesets_endpp
   if (unlikely(S_CAST(uintptr_t, g_bigstack_end - g_bigstack_base) < alloc_size)) {
     return nullptr;
   }
-  g_bigstack_end -= alloc_size;
-  PmergeInputFilesetLl* new_entry = R_CAST(PmergeInputFilesetLl*, g_bigstack_end);
+  PmergeInputFilesetLl* new_entry = S_CAST(PmergeInputFilesetLl*, bigstack_end_alloc_raw(alloc_size));
   new_entry->next = nullptr;
   **filesets_endpp = new_entry;
   *filesets_endpp = &(new_entry->next);
@@ -909,7 +908,7 @@ PglErr MergePsams(const PmergeInfo* pmip, const char* sample_sort_fname, MiscFla
       sample_include = nullptr;
       cur_sample_include = nullptr;
       sample_id_strset = nullptr;
-      g_bigstack_base = bigstack_mark;
+      BigstackReset(bigstack_mark);
 
       if (pheno_ct) {
         const char* pheno_names_read_iter = pheno_names_tmp_start;
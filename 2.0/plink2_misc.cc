@@ -3164,10 +3164,18 @@ PglErr WriteAlleleFreqs(const uintptr_t* variant_include, const ChrInfo* cip, co
       const uint32_t max_chr_blen = GetMaxChrSlen(cip) + 1;
       const uintptr_t overflow_buf_size = kCompressStreamBlock + max_chr_blen + kMaxIdSlen + 512 + max_allele_ct * (24 * k1LU) + 2 * max_allele_slen;
       const uint32_t output_zst = freq_rpt_flags & kfAlleleFreqZs;
+      const uint32_t output_bgz = freq_rpt_flags & kfAlleleFreqBgz;
+      const uint32_t output_roundtrip = (freq_rpt_flags / kfAlleleFreqRoundtrip) & 1;
       if (output_zst) {
         snprintf(&(outname_end[6 + counts]), kMaxOutfnameExtBlen - 7, ".zst");
+      } else if (output_bgz) {
+        snprintf(&(outname_end[6 + counts]), kMaxOutfnameExtBlen - 7, ".gz");
+      }
+      if (output_bgz) {
+        reterr = InitCstreamBgzAlloc(outname, max_thread_ct, overflow_buf_size, &css, &cswritep);
+      } else {
+        reterr = InitCstreamAlloc(outname, 0, output_zst, max_thread_ct, overflow_buf_size, &css, &cswritep);
       }
-      reterr = InitCstreamAlloc(outname, 0, output_zst, max_thread_ct, overflow_buf_size, &css, &cswritep);
       if (unlikely(reterr)) {
         goto WriteAlleleFreqs_ret_1;
       }
@@ -3327,7 +3335,7 @@ PglErr WriteAlleleFreqs(const uintptr_t* variant_include, const ChrInfo* cip, co
             // enough for this purpose.
             cswritep = ddosagetoa_full(ref_ddosage, cswritep);
           } else {
-            cswritep = dtoa_g(u63tod(ref_ddosage) * tot_allele_ddosage_recip, cswritep);
+            cswritep = dtoa_gr(u63tod(ref_ddosage) * tot_allele_ddosage_recip, output_roundtrip, cswritep);
           }
         }
         if (alt1freq_col) {
@@ -3336,7 +3344,7 @@ PglErr WriteAlleleFreqs(const uintptr_t* variant_include, const ChrInfo* cip, co
           if (counts) {
             cswritep = ddosagetoa_full(alt1_ddosage, cswritep);
           } else {
-            cswritep = dtoa_g(u63tod(alt1_ddosage) * tot_allele_ddosage_recip, cswritep);
+            cswritep = dtoa_gr(u63tod(alt1_ddosage) * tot_allele_ddosage_recip, output_roundtrip, cswritep);
           }
         }
         if (freq_col) {
@@ -3346,7 +3354,7 @@ PglErr WriteAlleleFreqs(const uintptr_t* variant_include, const ChrInfo* cip, co
             if (counts) {
               cswritep = ddosagetoa_full(cur_allele_ddosage, cswritep);
             } else {
-              cswritep = dtoa_g(u63tod(cur_allele_ddosage) * tot_allele_ddosage_recip, cswritep);
+              cswritep = dtoa_gr(u63tod(cur_allele_ddosage) * tot_allele_ddosage_recip, output_roundtrip, cswritep);
             }
             *cswritep++ = ',';
           }
@@ -3375,7 +3383,7 @@ PglErr WriteAlleleFreqs(const uintptr_t* variant_include, const ChrInfo* cip, co
               if (counts) {
                 cswritep = ddosagetoa_full(cur_allele_ddosage, cswritep);
               } else {
-                cswritep = dtoa_g(u63tod(cur_allele_ddosage) * tot_allele_ddosage_recip, cswritep);
+                cswritep = dtoa_gr(u63tod(cur_allele_ddosage) * tot_allele_ddosage_recip, output_roundtrip, cswritep);
               }
               *cswritep++ = ',';
               at_least_one_entry = 1;
@@ -3390,7 +3398,7 @@ PglErr WriteAlleleFreqs(const uintptr_t* variant_include, const ChrInfo* cip, co
         if (imp_r2_col) {
           *cswritep++ = '\t';
           if (!suppress_imp_r2) {
-            cswritep = dtoa_g(imp_r2_vals[variant_uidx], cswritep);
+            cswritep = dtoa_gr(imp_r2_vals[variant_uidx], output_roundtrip, cswritep);
           } else {
             cswritep = strcpya_k(cswritep, "NA");
           }
@@ -4907,6 +4915,8 @@ PglErr HardyReport(const uintptr_t* variant_include, const ChrInfo* cip, const u
     const uint32_t chr_code_endl = BitCtToWordCt(chr_code_end);
     const uintptr_t overflow_buf_size = RoundUpPow2(kCompressStreamBlock + max_chr_blen + kMaxIdSlen + 512 + 2 * max_allele_slen, kCacheline);
     const uint32_t output_zst = hardy_flags & kfHardyZs;
+    const uint32_t output_bgz = hardy_flags & kfHardyBgz;
+    const char* compress_modif = output_zst? " zs" : (output_bgz? " bgz" : "");
     const double output_min_p = (output_min_ln < kLnNormalMin)? 0 : exp(output_min_ln);
     uintptr_t overflow_buf_alloc = overflow_buf_size;
     if (output_zst) {
@@ -4952,8 +4962,12 @@ PglErr HardyReport(const uintptr_t* variant_include, const ChrInfo* cip, const u
     const uint32_t hetfreq_cols = hardy_flags & kfHardyColHetfreq;
     const uint32_t p_col = hardy_flags & kfHardyColP;
     if (variant_ct) {
-      OutnameZstSet(".hardy", output_zst, outname_end);
-      reterr = InitCstream(outname, 0, output_zst, max_thread_ct, overflow_buf_size, overflow_buf, R_CAST(unsigned char*, &(overflow_buf[overflow_buf_size])), &css);
+      OutnameCstreamSet(".hardy", output_zst, output_bgz, outname_end);
+      if (output_bgz) {
+        reterr = InitCstreamBgz(outname, max_thread_ct, overflow_buf, &css);
+      } else {
+        reterr = InitCstream(outname, 0, output_zst, max_thread_ct, overflow_buf_size, overflow_buf, R_CAST(unsigned char*, &(overflow_buf[overflow_buf_size])), &css);
+      }
       if (unlikely(reterr)) {
         goto HardyReport_ret_1;
       }
@@ -5013,7 +5027,7 @@ PglErr HardyReport(const uintptr_t* variant_include, const ChrInfo* cip, const u
       uint32_t chr_buf_blen = 0;
       uint32_t pct = 0;
       uint32_t next_print_variant_idx = variant_ct / 100;
-      printf("--hardy%s%s: 0%%", output_zst? " zs" : "", midp? " midp" : "");
+      printf("--hardy%s%s: 0%%", compress_modif, midp? " midp" : "");
       fflush(stdout);
       uintptr_t xgeno_idx = 0;
       uint32_t allele_ct = 2;
@@ -5149,12 +5163,16 @@ PglErr HardyReport(const uintptr_t* variant_include, const ChrInfo* cip, const u
         goto HardyReport_ret_WRITE_FAIL;
       }
       putc_unlocked('\r', stdout);
-      logprintfww("--hardy%s%s: Autosomal Hardy-Weinberg report (%s) written to %s .\n", output_zst? " zs" : "", midp? " midp" : "", nonfounders? "all samples" : "founders only", outname);
+      logprintfww("--hardy%s%s: Autosomal Hardy-Weinberg report (%s) written to %s .\n", compress_modif, midp? " midp" : "", nonfounders? "all samples" : "founders only", outname);
     }
     if (hwe_x_ct) {
       BigstackReset(chr_skips);
-      OutnameZstSet(".hardy.x", output_zst, outname_end);
-      reterr = InitCstream(outname, 0, output_zst, max_thread_ct, overflow_buf_size, overflow_buf, R_CAST(unsigned char*, &(overflow_buf[overflow_buf_size])), &css);
+      OutnameCstreamSet(".hardy.x", output_zst, output_bgz, outname_end);
+      if (output_bgz) {
+        reterr = InitCstreamBgz(outname, max_thread_ct, overflow_buf, &css);
+      } else {
+        reterr = InitCstream(outname, 0, output_zst, max_thread_ct, overflow_buf_size, overflow_buf, R_CAST(unsigned char*, &(overflow_buf[overflow_buf_size])), &css);
+      }
       if (unlikely(reterr)) {
         goto HardyReport_ret_1;
       }
@@ -5384,7 +5402,7 @@ PglErr HardyReport(const uintptr_t* variant_include, const ChrInfo* cip, const u
         goto HardyReport_ret_WRITE_FAIL;
       }
       putc_unlocked('\r', stdout);
-      logprintfww("--hardy%s%s: chrX Hardy-Weinberg report (%s) written to %s .\n", output_zst? " zs" : "", midp? " midp" : "", nonfounders? "all samples" : "founders only", outname);
+      logprintfww("--hardy%s%s: chrX Hardy-Weinberg report (%s) written to %s .\n", compress_modif, midp? " midp" : "", nonfounders? "all samples" : "founders only", outname);
     }
   }
   while (0) {
@@ -6577,7 +6595,7 @@ PglErr SampleCounts(const uintptr_t* sample_include, const SampleIdInfo* siip, c
     // in this case it's more convenient to allocate them at the end, which is
     // normally only vector-aligned.  So we force the end to be
     // cacheline-aligned here.
-    g_bigstack_end = R_CAST(unsigned char*, RoundDownPow2(R_CAST(uintptr_t, g_bigstack_end), kCacheline));
+    BigstackEndReset(BigstackEndRoundedDown());
 
     unsigned char* bigstack_mark2 = g_bigstack_base;
     STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
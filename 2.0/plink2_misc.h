@@ -97,7 +97,11 @@ FLAGSET_DEF_START()
   // don't force alt1freq/altfreq mutual exclusion since the former plays a bit
   // better with shell scripts
   // alt+alteqz is a bit silly, but I won't bother prohibiting it
-  kfAlleleFreqColMutex = ((kfAlleleFreqColAltnumeq * 2) - kfAlleleFreqColAltfreq)
+  kfAlleleFreqColMutex = ((kfAlleleFreqColAltnumeq * 2) - kfAlleleFreqColAltfreq),
+
+  // set by --output-roundtrip
+  kfAlleleFreqRoundtrip = (1 << 23),
+  kfAlleleFreqBgz = (1 << 24)
 FLAGSET_DEF_END(FreqRptFlags);
 
 // Will need to split this into multiple flagsets if we add any more options...
@@ -189,7 +193,8 @@ FLAGSET_DEF_START()
   kfHardyColFemalep = (1 << 13),
   kfHardyColP = (1 << 14),
   kfHardyColDefault = (kfHardyColChrom | kfHardyColAx | kfHardyColGcounts | kfHardyColHetfreq | kfHardyColSexaf | kfHardyColP),
-  kfHardyColAll = ((kfHardyColP * 2) - kfHardyColChrom)
+  kfHardyColAll = ((kfHardyColP * 2) - kfHardyColChrom),
+  kfHardyBgz = (1 << 15)
 FLAGSET_DEF_END(HardyFlags);
 
 FLAGSET_DEF_START()
@@ -684,7 +684,7 @@ PglErr LoadPsam(const char* psamname, const RangeList* pheno_range_list_ptr, Fam
     }
     // real allocations start here
     // could make these cacheline-aligned?
-    g_bigstack_end = bigstack_end_mark;
+    BigstackEndReset(bigstack_end_mark);
     const uint32_t aligned_wct = BitCtToAlignedWordCt(raw_sample_ct);
     if (unlikely(bigstack_end_alloc_c(raw_sample_ct * max_sample_id_blen, &(piip->sii.sample_ids)) ||
                  bigstack_end_alloc_c(raw_sample_ct * max_paternal_id_blen, &(piip->parental_id_info.paternal_ids)) ||
@@ -16,6 +16,14 @@
 
 #include "plink2_pvar.h"
 
+#ifndef NO_MMAP
+#  include <sys/types.h>  // fstat()
+#  include <sys/stat.h>  // open(), fstat(), stat()
+#  include <sys/mman.h>  // mmap()
+#  include <fcntl.h>  // open()
+#  include <unistd.h>  // getpid(), unlink()
+#endif
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -25,9 +33,12 @@ namespace plink2 {
 // size-64k pos[], allele_idxs[], ids[], cms[], etc. blocks, and just memcpy
 // those chunks at the end.  (cms[] is lazy-initialized.)
 //
-// probable todo: try making this more parallel.  could e.g. repeatedly peek at
-// end of ReadLineStream buffer, count # of '\n's, and divvy them up between
-// worker threads.
+// Only tokenization is parallelized: worker threads lex line-aligned chunks of
+// the TextStream buffer ahead of the main thread (see PvarLexThread() below),
+// locating column boundaries and parsing POS.  There are no per-chunk output
+// arenas.  Chromosome-code resolution, filtering, ID templating, and the
+// allele/ID copies into the blocks above all remain on the main thread, so
+// they bound the speedup.
 CONSTI32(kLoadPvarBlockSize, 65536);
 static_assert(!(kLoadPvarBlockSize & (kLoadPvarBlockSize - 1)), "kLoadPvarBlockSize must be a power of 2.");
 static_assert(kLoadPvarBlockSize >= (kMaxMediumLine / 8), "kLoadPvarBlockSize cannot be smaller than kMaxMediumLine / 8.");
@@ -796,8 +807,800 @@ PglErr SplitPar(const uint32_t* variant_bps, UnsortedVar vpos_sortstatus, uint32
   return kPglRetSuccess;
 }
 
+// Per-thread lookahead for the .pvar lexing pass.  kPvarLexChunkSize bytes of
+// the decompression buffer are handed to each worker at a time, with room for
+// up to kPvarLexChunkSize / 16 lines; any lines past that are lexed by the
+// main thread.
+CONSTI32(kPvarLexChunkSize, 32768);
+CONSTI32(kPvarLexRecordCapacity, kPvarLexChunkSize / 16);
+// Beyond this, the main thread's share of the work (everything except lexing
+// and POS parsing) dominates.
+CONSTI32(kMaxPvarLexThreadCt, 8);
+
+typedef struct PvarLexRecordStruct {
+  char* line_start;
+  char* chr_end;
+  char* line_end;  // points to '\n'
+  char* token_ptrs[8];
+  uint32_t token_slens[8];
+  uint32_t extra_alt_ct;
+  uint32_t missing_tokens;
+  // POS, valid when !missing_tokens
+  int32_t bp;
+  BoolErr bp_err;
+  // Chromosome code text is identical to the previous record's, so
+  // LoadPvar() can skip the lookup.
+  uint32_t chr_matches_prev;
+} PvarLexRecord;
+
+typedef struct PvarLexCtxStruct {
+  const uint32_t* col_types;
+  const uint32_t* col_skips;
+  uint32_t relevant_postchr_col_ct;
+
+  // chunk_starts[parity][thread_ct] is the end of the last chunk.
+  char* chunk_starts[2][kMaxPvarLexThreadCt + 1];
+  PvarLexRecord* records[2];
+  uint32_t record_cts[2][kMaxPvarLexThreadCt];
+} PvarLexCtx;
+
+// Performs the order-independent part of the LoadPvar() per-line work: finding
+// the chromosome-code end and noting whether it repeats the previous line's,
+// lexing the remaining relevant columns, parsing POS, counting ALT alleles,
+// and finding the end of the line.  Stops early at an empty line, since
+// LoadPvar() stops there too.
+THREAD_FUNC_DECL PvarLexThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uintptr_t tidx = arg->tidx;
+  PvarLexCtx* ctx = S_CAST(PvarLexCtx*, arg->sharedp->context);
+
+  const uint32_t* col_types = ctx->col_types;
+  const uint32_t* col_skips = ctx->col_skips;
+  const uint32_t relevant_postchr_col_ct = ctx->relevant_postchr_col_ct;
+  uint32_t parity = 0;
+  do {
+    PvarLexRecord* records = &(ctx->records[parity][tidx * kPvarLexRecordCapacity]);
+    char* line_iter = ctx->chunk_starts[parity][tidx];
+    char* chunk_end = ctx->chunk_starts[parity][tidx + 1];
+    uint32_t record_idx = 0;
+    const char* prev_chr_start = nullptr;
+    uintptr_t prev_chr_slen = 0;
+    for (; (line_iter != chunk_end) && (record_idx != kPvarLexRecordCapacity); ++record_idx) {
+      line_iter = FirstNonTspace(line_iter);
+      if (IsEolnKns(*line_iter)) {
+        break;
+      }
+      PvarLexRecord* cur_record = &(records[record_idx]);
+      cur_record->line_start = line_iter;
+      char* chr_end = CurTokenEnd(line_iter);
+      cur_record->chr_end = chr_end;
+      const uintptr_t chr_slen = chr_end - line_iter;
+      cur_record->chr_matches_prev = (chr_slen == prev_chr_slen) && memequal(line_iter, prev_chr_start, chr_slen);
+      prev_chr_start = line_iter;
+      prev_chr_slen = chr_slen;
+      char* last_token_end = TokenLex(chr_end, col_types, col_skips, relevant_postchr_col_ct, cur_record->token_ptrs, cur_record->token_slens);
+      if (last_token_end) {
+        cur_record->extra_alt_ct = CountByte(cur_record->token_ptrs[3], ',', cur_record->token_slens[3]);
+        cur_record->missing_tokens = 0;
+        cur_record->bp_err = ScanIntAbsDefcap(cur_record->token_ptrs[0], &cur_record->bp);
+      } else {
+        last_token_end = chr_end;
+        cur_record->missing_tokens = 1;
+      }
+      char* line_end = AdvToDelim(last_token_end, '\n');
+      cur_record->line_end = line_end;
+      line_iter = &(line_end[1]);
+    }
+    ctx->record_cts[parity][tidx] = record_idx;
+    parity = 1 - parity;
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+// Splits [batch_start, batch_end) into line-aligned chunks, one per thread.
+// batch_end must point after a '\n'.
+void PvarLexSplitBatch(char* batch_start, char* batch_end, uint32_t thread_ct, char** chunk_starts) {
+  const uintptr_t batch_size = batch_end - batch_start;
+  chunk_starts[0] = batch_start;
+  for (uint32_t tidx = 1; tidx != thread_ct; ++tidx) {
+    const uintptr_t offset = (batch_size * tidx) / thread_ct;
+    char* chunk_start = batch_start;
+    if (offset) {
+      chunk_start = AdvPastDelim(&(batch_start[offset - 1]), '\n');
+    }
+    chunk_starts[tidx] = chunk_start;
+  }
+  chunk_starts[thread_ct] = batch_end;
+}
+
+// Returns the line-aligned end of the next lexing batch starting at
+// batch_start.
+char* PvarLexBatchEnd(char* batch_start, char* consume_stop, uint32_t thread_ct) {
+  const uintptr_t max_batch_size = thread_ct * S_CAST(uintptr_t, kPvarLexChunkSize);
+  if (S_CAST(uintptr_t, consume_stop - batch_start) <= max_batch_size) {
+    return consume_stop;
+  }
+  return AdvPastDelim(&(batch_start[max_batch_size - 1]), '\n');
+}
+
+// Handles a ##chrSet header line.  chrset_iter is expected to point to the
+// first character after "##chrSet=<".
+PglErr LoadPvarChrsetLine(const char* chrset_iter, const char* pvarname, MiscFlags misc_flags, uintptr_t line_idx, ChrInfo* cip) {
+  const uint32_t cmdline_chrset = (cip->chrset_source == kChrsetSourceCmdline) && (!(misc_flags & kfMiscChrOverrideFile));
+  const PglErr reterr = ReadChrsetHeaderLine(chrset_iter, pvarname, misc_flags, line_idx, cip);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (!cmdline_chrset) {
+    const uint32_t autosome_ct = cip->autosome_ct;
+    if (cip->haploid_mask[0] & 1) {
+      logprintf("chrSet header line: %u autosome%s (haploid).\n", autosome_ct, (autosome_ct == 1)? "" : "s");
+    } else {
+      logprintf("chrSet header line: %u autosome pair%s.\n", autosome_ct, (autosome_ct == 1)? "" : "s");
+    }
+  }
+  return kPglRetSuccess;
+}
+
+// Binary .pvar cache ({pvarname}.pvc) layout:
+//   PvarCacheHeader (192 bytes)
+//   sections in PvarCacheSection order, each zero-padded to a cacheline
+//   boundary (empty sections take no space):
+//     ##chrSet text after "##chrSet=<", through the terminating '\n' and a
+//       null terminator
+//     retained header lines (see xheader_ptr)
+//     chromosome table: chr_ct (code, fo_vidx_start) uint32 pairs in file
+//       order, with code == UINT32_MAX for nonstandard contigs, followed by
+//       the null-terminated nonstandard contig names
+//     LoadPvar() return arrays, in LoadPvar()'s allocation order
+//     string heap: a verbatim copy of the variant ID/allele/FILTER string
+//       block LoadPvar() leaves at the top of bigstack
+// The variant_ids, allele_storage, and filter_storage sections store heap
+// offsets, or kPvarCacheOneCharBit | (offset into g_one_char_strs[]).
+// Everything is in native byte order, and word_byte_ct must match.
+//
+// file_crc covers the whole file, with file_crc itself zeroed.  It is only
+// checked under --pvar-cache verify; normal loads trust the identity fields
+// and pvar_sample_crc, since the cache is always written via rename.
+// pvar_sample_crc covers the first and last kPvarCacheSampleBlen bytes of the
+// .pvar, to catch same-size rewrites within the mtime resolution.
+typedef struct PvarCacheHeaderStruct {
+  char magic[4];
+  uint32_t word_byte_ct;
+  uint64_t pvar_fsize;
+  int64_t pvar_mtime;
+  int64_t pvar_mtime_nsec;
+  uint32_t pvar_sample_crc;
+  uint32_t file_crc;
+  uint32_t config_crc;
+  uint32_t flags;
+  uint32_t raw_variant_ct;
+  uint32_t variant_ct;
+  uint32_t chr_ct;
+  uint32_t info_flags;
+  uint32_t vpos_sortstatus;
+  uint32_t max_variant_id_slen;
+  uint32_t max_allele_ct;
+  uint32_t max_allele_slen;
+  uint32_t max_filter_slen;
+  uint32_t info_max_slen;
+  uint32_t heap_misalign;
+  uint32_t reserved0;
+  // 0 if no such line
+  uint64_t chrset_line_idx;
+  uint64_t info_pr_nonflag_line_idx;
+
+  uint64_t allele_idx_end;
+  uint64_t chrset_blen;
+  uint64_t xheader_blen;
+  uint64_t chr_names_blen;
+  uint64_t heap_blen;
+  uint64_t reserved[5];
+} PvarCacheHeader;
+
+static_assert(sizeof(PvarCacheHeader) == 192, "PvarCacheHeader must be 192 bytes.");
+
+static const char kPvarCacheMagic[4] = {'l', 0x1b, 'V', 1};
+
+static const uintptr_t kPvarCacheOneCharBit = k1LU << (kBitsPerWord - 1);
+
+CONSTI32(kPvarCacheSampleBlen, 65536);
+static_assert(kPvarCacheSampleBlen <= kTextbufSize, "kPvarCacheSampleBlen must not exceed kTextbufSize.");
+
+// Longer ##chrSet lines just aren't cached.
+CONSTI32(kPvarCacheChrsetBlenMax, 1024);
+
+FLAGSET_DEF_START()
+  kfPvarCache0,
+  // xheader/QUAL/FILTER were requested by the writing run.  (If the column
+  // was absent, nothing is stored and the cache is still usable.)
+  kfPvarCacheXheaderChecked = (1 << 0),
+  kfPvarCacheQualChecked = (1 << 1),
+  kfPvarCacheFilterChecked = (1 << 2),
+
+  kfPvarCacheQual = (1 << 3),
+  kfPvarCacheFilter = (1 << 4),
+  kfPvarCacheFilterStorage = (1 << 5),
+  kfPvarCacheNonrefFlags = (1 << 6),
+  kfPvarCacheMultiallelic = (1 << 7),
+  kfPvarCacheCms = (1 << 8),
+  kfPvarCacheInfoFlagsSet = (1 << 9),
+  kfPvarCacheInfoCol = (1 << 10),
+  // INFO contains something other than the PR flag
+  kfPvarCacheInfoReload = (1 << 11)
+FLAGSET_DEF_END(PvarCacheFlags);
+
+ENUM_U31_DEF_START()
+  kPvarCacheSectionChrset,
+  kPvarCacheSectionXheader,
+  kPvarCacheSectionChrTable,
+  kPvarCacheSectionAlleles,
+  kPvarCacheSectionInclude,
+  kPvarCacheSectionBps,
+  kPvarCacheSectionIds,
+  kPvarCacheSectionQualPresent,
+  kPvarCacheSectionQuals,
+  kPvarCacheSectionFilterPresent,
+  kPvarCacheSectionFilterNpass,
+  kPvarCacheSectionFilterStorage,
+  kPvarCacheSectionNonrefFlags,
+  kPvarCacheSectionAlleleIdxOffsets,
+  kPvarCacheSectionCms,
+  kPvarCacheSectionHeap,
+  kPvarCacheSectionCt
+ENUM_U31_DEF_END(PvarCacheSection);
+
+void PvarCacheSectionBlens(const PvarCacheHeader* pvc_headerp, uint64_t* section_blens) {
+  const PvarCacheFlags pvc_flags = S_CAST(PvarCacheFlags, pvc_headerp->flags);
+  const uint64_t raw_variant_ct = pvc_headerp->raw_variant_ct;
+  const uint64_t bitvec_blen = DivUp(raw_variant_ct, kBitsPerWord) * kBytesPerWord;
+  section_blens[kPvarCacheSectionChrset] = pvc_headerp->chrset_blen;
+  section_blens[kPvarCacheSectionXheader] = pvc_headerp->xheader_blen;
+  section_blens[kPvarCacheSectionChrTable] = pvc_headerp->chr_ct * (2 * sizeof(int32_t)) + pvc_headerp->chr_names_blen;
+  section_blens[kPvarCacheSectionAlleles] = pvc_headerp->allele_idx_end * sizeof(intptr_t);
+  section_blens[kPvarCacheSectionInclude] = bitvec_blen;
+  section_blens[kPvarCacheSectionBps] = raw_variant_ct * sizeof(int32_t);
+  section_blens[kPvarCacheSectionIds] = raw_variant_ct * sizeof(intptr_t);
+  const uint32_t qual_present = (pvc_flags / kfPvarCacheQual) & 1;
+  section_blens[kPvarCacheSectionQualPresent] = qual_present * bitvec_blen;
+  section_blens[kPvarCacheSectionQuals] = qual_present * raw_variant_ct * sizeof(float);
+  const uint32_t filter_present = (pvc_flags / kfPvarCacheFilter) & 1;
+  section_blens[kPvarCacheSectionFilterPresent] = filter_present * bitvec_blen;
+  section_blens[kPvarCacheSectionFilterNpass] = filter_present * bitvec_blen;
+  section_blens[kPvarCacheSectionFilterStorage] = ((pvc_flags / kfPvarCacheFilterStorage) & 1) * raw_variant_ct * sizeof(intptr_t);
+  section_blens[kPvarCacheSectionNonrefFlags] = ((pvc_flags / kfPvarCacheNonrefFlags) & 1) * bitvec_blen;
+  section_blens[kPvarCacheSectionAlleleIdxOffsets] = ((pvc_flags / kfPvarCacheMultiallelic) & 1) * (raw_variant_ct + 1) * sizeof(intptr_t);
+  section_blens[kPvarCacheSectionCms] = ((pvc_flags / kfPvarCacheCms) & 1) * raw_variant_ct * sizeof(double);
+  section_blens[kPvarCacheSectionHeap] = pvc_headerp->heap_blen;
+}
+
+uint64_t PvarCacheFsizeExpected(const uint64_t* section_blens) {
+  uint64_t fsize = sizeof(PvarCacheHeader);
+  for (uint32_t section_idx = 0; section_idx != kPvarCacheSectionCt; ++section_idx) {
+    fsize += RoundUpPow2(section_blens[section_idx], kCacheline);
+  }
+  return fsize;
+}
+
+// Chromosome filters are applied while the .pvar is loaded, so the cache is
+// bypassed when any are active.
+uint32_t PvarCacheChrConfigOk(MiscFlags misc_flags, const ChrInfo* cip) {
+  return (!(misc_flags & (kfMiscAutosomePar | kfMiscAutosomeOnly | kfMiscMergePar | kfMiscMergeX))) && (!cip->name_ct) && (!cip->incl_excl_name_stack) && (!cip->is_include_stack) && AllWordsAreZero(cip->chr_mask, kChrMaskWords) && AllWordsAreZero(cip->chr_exclude, kChrExcludeWords);
+}
+
+// Checksum of the settings (other than the .pvar itself) that affect how
+// LoadPvar() interprets the .pvar when PvarCacheChrConfigOk() is true.
+uint32_t PvarCacheConfigCrc(MiscFlags misc_flags, const ChrInfo* cip) {
+  const uint64_t scalars[4] = {cip->chrset_source, cip->autosome_ct, misc_flags & (kfMiscAllowExtraChrs | kfMiscChrOverrideCmdline | kfMiscChrOverrideFile), ctou64(*g_input_missing_geno_ptr)};
+  uint32_t crc = libdeflate_crc32(0, scalars, sizeof(scalars));
+  crc = libdeflate_crc32(crc, &(cip->xymt_codes[0]), kChrOffsetCt * sizeof(int32_t));
+  return libdeflate_crc32(crc, cip->haploid_mask, kChrMaskWords * sizeof(intptr_t));
+}
+
+#ifndef NO_MMAP
+int64_t StatMtimeNsec(const struct stat* statbufp) {
+#ifdef __APPLE__
+  return statbufp->st_mtimespec.tv_nsec;
+#else
+  return statbufp->st_mtim.tv_nsec;
+#endif
+}
+
+BoolErr PvarSampleCrc(const char* pvarname, uint64_t pvar_fsize, uint32_t* crc_ptr) {
+  FILE* infile = fopen(pvarname, FOPEN_RB);
+  if (unlikely(!infile)) {
+    return 1;
+  }
+  unsigned char* buf = R_CAST(unsigned char*, g_textbuf);
+  const uintptr_t head_blen = MINV(pvar_fsize, S_CAST(uint64_t, kPvarCacheSampleBlen));
+  if (unlikely(fread_checked(buf, head_blen, infile))) {
+    fclose(infile);
+    return 1;
+  }
+  uint32_t crc = libdeflate_crc32(0, buf, head_blen);
+  if (pvar_fsize > kPvarCacheSampleBlen) {
+    const uint64_t tail_start = MAXV(pvar_fsize - kPvarCacheSampleBlen, S_CAST(uint64_t, kPvarCacheSampleBlen));
+    const uintptr_t tail_blen = pvar_fsize - tail_start;
+    if (unlikely(fseeko(infile, tail_start, SEEK_SET) ||
+                 fread_checked(buf, tail_blen, infile))) {
+      fclose(infile);
+      return 1;
+    }
+    crc = libdeflate_crc32(crc, buf, tail_blen);
+  }
+  *crc_ptr = crc;
+  return fclose_null(&infile);
+}
+
+BoolErr PvarCacheFwrite(const void* buf, uintptr_t len, FILE* outfile, uint32_t* crc_ptr) {
+  // libdeflate_crc32() returns the initial value, rather than *crc_ptr, when
+  // buf is null.
+  if (!len) {
+    return 0;
+  }
+  *crc_ptr = libdeflate_crc32(*crc_ptr, buf, len);
+  return fwrite_checked(buf, len, outfile);
+}
+
+// Writes strs[] as heap offsets (see PvarCacheHeader).
+BoolErr PvarCacheWriteStrs(const char* const* strs, uintptr_t ct, const char* heap_start, uintptr_t heap_blen, FILE* outfile, uint32_t* crc_ptr) {
+  uintptr_t code_buf[512];
+  for (uintptr_t str_idx_start = 0; str_idx_start < ct; str_idx_start += 512) {
+    const uintptr_t cur_ct = MINV(ct - str_idx_start, 512);
+    for (uintptr_t uii = 0; uii != cur_ct; ++uii) {
+      const uintptr_t cur_addr = R_CAST(uintptr_t, strs[str_idx_start + uii]);
+      uintptr_t code = cur_addr - R_CAST(uintptr_t, heap_start);
+      if (code >= heap_blen) {
+        code = cur_addr - R_CAST(uintptr_t, g_one_char_strs);
+        if (code >= 512) {
+          // never-initialized entry of a variant excluded during loading
+          code = 92;
+        }
+        code |= kPvarCacheOneCharBit;
+      }
+      code_buf[uii] = code;
+    }
+    if (unlikely(PvarCacheFwrite(code_buf, cur_ct * sizeof(intptr_t), outfile, crc_ptr))) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void PvarCacheDecodeStrs(const uintptr_t* codes, uintptr_t ct, const char* heap_start, const char** strs) {
+  for (uintptr_t ulii = 0; ulii != ct; ++ulii) {
+    const uintptr_t code = codes[ulii];
+    if (code & kPvarCacheOneCharBit) {
+      strs[ulii] = &(g_one_char_strs[code ^ kPvarCacheOneCharBit]);
+    } else {
+      strs[ulii] = &(heap_start[code]);
+    }
+  }
+}
+
+// Sources for the WritePvarCache() sections that aren't derived from
+// ChrInfo.  Null pointers are fine for sections with zero length.
+typedef struct PvarCacheSrcStruct {
+  const char* chrset_text;
+  const char* xheader;
+  const char* const* allele_storage;
+  const uintptr_t* variant_include;
+  const uint32_t* variant_bps;
+  const char* const* variant_ids;
+  const uintptr_t* qual_present;
+  const float* quals;
+  const uintptr_t* filter_present;
+  const uintptr_t* filter_npass;
+  const char* const* filter_storage;
+  const uintptr_t* nonref_flags;
+  const uintptr_t* allele_idx_offsets;
+  const double* variant_cms;
+  const char* heap_start;
+} PvarCacheSrc;
+
+// Fills in the .pvar identity fields, chr_names_blen, and file_crc of
+// *pvc_headerp; everything else must already be set.  The cache is written to
+// a temporary file which is then renamed, so concurrent readers never see a
+// partial cache.
+PglErr WritePvarCache(const char* pvarname, const char* pvc_fname, const ChrInfo* cip, const PvarCacheSrc* srcp, PvarCacheHeader* pvc_headerp) {
+  FILE* outfile = nullptr;
+  char tmp_fname[kPglFnamesize + 32];
+  tmp_fname[0] = '\0';
+  PglErr reterr = kPglRetSuccess;
+  {
+    struct stat statbuf;
+    if (unlikely(stat(pvarname, &statbuf))) {
+      logerrprintfww(kErrprintfFopen, pvarname, strerror(errno));
+      goto WritePvarCache_ret_OPEN_FAIL;
+    }
+    pvc_headerp->pvar_fsize = statbuf.st_size;
+    pvc_headerp->pvar_mtime = statbuf.st_mtime;
+    pvc_headerp->pvar_mtime_nsec = StatMtimeNsec(&statbuf);
+    if (unlikely(PvarSampleCrc(pvarname, statbuf.st_size, &(pvc_headerp->pvar_sample_crc)))) {
+      logerrprintfww(kErrprintfFread, pvarname, rstrerror(errno));
+      reterr = kPglRetReadFail;
+      goto WritePvarCache_ret_1;
+    }
+    const uint32_t chr_ct = pvc_headerp->chr_ct;
+    const uint32_t max_code = cip->max_code;
+    uint64_t chr_names_blen = 0;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+      const uint32_t chr_code = cip->chr_file_order[chr_fo_idx];
+      if (chr_code > max_code) {
+        chr_names_blen += strlen(cip->nonstd_names[chr_code]) + 1;
+      }
+    }
+    pvc_headerp->chr_names_blen = chr_names_blen;
+    pvc_headerp->file_crc = 0;
+    uint64_t section_blens[kPvarCacheSectionCt];
+    PvarCacheSectionBlens(pvc_headerp, section_blens);
+    const void* section_srcs[kPvarCacheSectionCt];
+    section_srcs[kPvarCacheSectionChrset] = srcp->chrset_text;
+    section_srcs[kPvarCacheSectionXheader] = srcp->xheader;
+    section_srcs[kPvarCacheSectionChrTable] = nullptr;
+    section_srcs[kPvarCacheSectionAlleles] = srcp->allele_storage;
+    section_srcs[kPvarCacheSectionInclude] = srcp->variant_include;
+    section_srcs[kPvarCacheSectionBps] = srcp->variant_bps;
+    section_srcs[kPvarCacheSectionIds] = srcp->variant_ids;
+    section_srcs[kPvarCacheSectionQualPresent] = srcp->qual_present;
+    section_srcs[kPvarCacheSectionQuals] = srcp->quals;
+    section_srcs[kPvarCacheSectionFilterPresent] = srcp->filter_present;
+    section_srcs[kPvarCacheSectionFilterNpass] = srcp->filter_npass;
+    section_srcs[kPvarCacheSectionFilterStorage] = srcp->filter_storage;
+    section_srcs[kPvarCacheSectionNonrefFlags] = srcp->nonref_flags;
+    section_srcs[kPvarCacheSectionAlleleIdxOffsets] = srcp->allele_idx_offsets;
+    section_srcs[kPvarCacheSectionCms] = srcp->variant_cms;
+    section_srcs[kPvarCacheSectionHeap] = srcp->heap_start;
+
+    snprintf(tmp_fname, kPglFnamesize + 32, "%s.%u.tmp", pvc_fname, S_CAST(uint32_t, getpid()));
+    outfile = fopen(tmp_fname, FOPEN_WB);
+    if (unlikely(!outfile)) {
+      logerrprintfww(kErrprintfFopen, tmp_fname, strerror(errno));
+      tmp_fname[0] = '\0';
+      goto WritePvarCache_ret_OPEN_FAIL;
+    }
+    unsigned char zero_buf[kCacheline];
+    memset(zero_buf, 0, kCacheline);
+    uint32_t crc = 0;
+    if (unlikely(PvarCacheFwrite(pvc_headerp, sizeof(PvarCacheHeader), outfile, &crc))) {
+      goto WritePvarCache_ret_WRITE_FAIL;
+    }
+    const uintptr_t heap_blen = pvc_headerp->heap_blen;
+    for (uint32_t section_idx = 0; section_idx != kPvarCacheSectionCt; ++section_idx) {
+      const uintptr_t cur_blen = section_blens[section_idx];
+      if (section_idx == kPvarCacheSectionChrTable) {
+        uint32_t chr_pair[2];
+        for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+          const uint32_t chr_code = cip->chr_file_order[chr_fo_idx];
+          chr_pair[0] = (chr_code > max_code)? UINT32_MAX : chr_code;
+          chr_pair[1] = cip->chr_fo_vidx_start[chr_fo_idx];
+          if (unlikely(PvarCacheFwrite(chr_pair, 2 * sizeof(int32_t), outfile, &crc))) {
+            goto WritePvarCache_ret_WRITE_FAIL;
+          }
+        }
+        for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+          const uint32_t chr_code = cip->chr_file_order[chr_fo_idx];
+          if (chr_code > max_code) {
+            const char* chr_name = cip->nonstd_names[chr_code];
+            if (unlikely(PvarCacheFwrite(chr_name, strlen(chr_name) + 1, outfile, &crc))) {
+              goto WritePvarCache_ret_WRITE_FAIL;
+            }
+          }
+        }
+      } else if ((section_idx == kPvarCacheSectionAlleles) || (section_idx == kPvarCacheSectionIds) || (section_idx == kPvarCacheSectionFilterStorage)) {
+        if (unlikely(PvarCacheWriteStrs(S_CAST(const char* const*, section_srcs[section_idx]), cur_blen / sizeof(intptr_t), srcp->heap_start, heap_blen, outfile, &crc))) {
+          goto WritePvarCache_ret_WRITE_FAIL;
+        }
+      } else if (unlikely(PvarCacheFwrite(section_srcs[section_idx], cur_blen, outfile, &crc))) {
+        goto WritePvarCache_ret_WRITE_FAIL;
+      }
+      if (unlikely(PvarCacheFwrite(zero_buf, RoundUpPow2(cur_blen, kCacheline) - cur_blen, outfile, &crc))) {
+        goto WritePvarCache_ret_WRITE_FAIL;
+      }
+    }
+    pvc_headerp->file_crc = crc;
+    if (unlikely(fseeko(outfile, 0, SEEK_SET) ||
+                 fwrite_checked(pvc_headerp, sizeof(PvarCacheHeader), outfile) ||
+                 fclose_null(&outfile))) {
+      goto WritePvarCache_ret_WRITE_FAIL;
+    }
+    if (unlikely(rename(tmp_fname, pvc_fname))) {
+      goto WritePvarCache_ret_WRITE_FAIL;
+    }
+    tmp_fname[0] = '\0';
+    logprintfww("Binary .pvar cache written to %s .\n", pvc_fname);
+  }
+  while (0) {
+  WritePvarCache_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  WritePvarCache_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  }
+ WritePvarCache_ret_1:
+  fclose_cond(outfile);
+  if (tmp_fname[0]) {
+    unlink(tmp_fname);
+  }
+  return reterr;
+}
+
+// LoadPvarCache() returns pointers into this mapping, so it is kept until
+// CleanupPvarCache().
+static void* g_pvar_cache_map = nullptr;
+static uintptr_t g_pvar_cache_map_size = 0;
+
+void CleanupPvarCache() {
+  if (g_pvar_cache_map) {
+    munmap(g_pvar_cache_map, g_pvar_cache_map_size);
+    g_pvar_cache_map = nullptr;
+  }
+}
+
+// Returns kPglRetSkipped, without modifying anything, when the cache is
+// absent, out of date, or lacks something this run needs; a warning is
+// printed in the out-of-date case.  Otherwise, this fills the same return
+// values LoadPvar() would.  The fixed-width arrays (variant_include,
+// variant_bps, QUAL/FILTER/nonref, allele_idx_offsets, and variant_cms) point
+// directly into a private copy-on-write mapping of the cache, so only the
+// string heap and the decoded string-pointer arrays occupy workspace, and
+// callers may still modify the arrays in place.
+PglErr LoadPvarCache(const char* pvarname, const char* pvc_fname, MiscFlags misc_flags, uint32_t xheader_needed, uint32_t qual_needed, uint32_t filter_needed, uint32_t config_crc, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  unsigned char* bigstack_end_mark = g_bigstack_end;
+  const unsigned char* pvc_base = nullptr;
+  uint64_t pvc_size = 0;
+  PglErr reterr = kPglRetSkipped;
+  {
+    if (g_pvar_cache_map) {
+      // only one mapping is tracked
+      goto LoadPvarCache_ret_1;
+    }
+    const int32_t pvc_fd = open(pvc_fname, O_RDONLY);
+    if (pvc_fd == -1) {
+      goto LoadPvarCache_ret_1;
+    }
+    struct stat statbuf;
+    if (unlikely(fstat(pvc_fd, &statbuf) < 0)) {
+      close(pvc_fd);
+      goto LoadPvarCache_ret_1;
+    }
+    pvc_size = statbuf.st_size;
+    if (unlikely(pvc_size < sizeof(PvarCacheHeader))) {
+      close(pvc_fd);
+      goto LoadPvarCache_ret_STALE;
+    }
+    void* map_result = mmap(0, pvc_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, pvc_fd, 0);
+    close(pvc_fd);
+    if (unlikely(map_result == MAP_FAILED)) {
+      goto LoadPvarCache_ret_1;
+    }
+    pvc_base = S_CAST(const unsigned char*, map_result);
+    const PvarCacheHeader* pvc_headerp = R_CAST(const PvarCacheHeader*, pvc_base);
+    if (unlikely(stat(pvarname, &statbuf))) {
+      goto LoadPvarCache_ret_1;
+    }
+    if (unlikely((!memequal(pvc_headerp->magic, kPvarCacheMagic, 4)) ||
+                 (pvc_headerp->word_byte_ct != kBytesPerWord))) {
+      goto LoadPvarCache_ret_STALE;
+    }
+    uint64_t section_blens[kPvarCacheSectionCt];
+    PvarCacheSectionBlens(pvc_headerp, section_blens);
+    if (unlikely((pvc_headerp->pvar_fsize != S_CAST(uint64_t, statbuf.st_size)) ||
+                 (pvc_headerp->pvar_mtime != S_CAST(int64_t, statbuf.st_mtime)) ||
+                 (pvc_headerp->pvar_mtime_nsec != StatMtimeNsec(&statbuf)) ||
+                 (PvarCacheFsizeExpected(section_blens) != pvc_size))) {
+      goto LoadPvarCache_ret_STALE;
+    }
+    const PvarCacheFlags pvc_flags = S_CAST(PvarCacheFlags, pvc_headerp->flags);
+    if ((pvc_headerp->config_crc != config_crc) ||
+        (xheader_needed && (!(pvc_flags & kfPvarCacheXheaderChecked))) ||
+        (qual_needed && (!(pvc_flags & kfPvarCacheQualChecked))) ||
+        (filter_needed && (!(pvc_flags & kfPvarCacheFilterChecked)))) {
+      goto LoadPvarCache_ret_1;
+    }
+    uint32_t pvar_sample_crc;
+    if (unlikely(PvarSampleCrc(pvarname, pvc_headerp->pvar_fsize, &pvar_sample_crc) ||
+                 (pvar_sample_crc != pvc_headerp->pvar_sample_crc))) {
+      goto LoadPvarCache_ret_STALE;
+    }
+    if (misc_flags & kfMiscPvarCacheVerify) {
+      PvarCacheHeader header_copy;
+      memcpy(&header_copy, pvc_headerp, sizeof(PvarCacheHeader));
+      header_copy.file_crc = 0;
+      uint32_t crc = libdeflate_crc32(0, &header_copy, sizeof(PvarCacheHeader));
+      crc = libdeflate_crc32(crc, &(pvc_base[sizeof(PvarCacheHeader)]), pvc_size - sizeof(PvarCacheHeader));
+      if (unlikely(crc != pvc_headerp->file_crc)) {
+        logerrprintfww("Warning: Ignoring %s, since its checksum does not match.\n", pvc_fname);
+        goto LoadPvarCache_ret_1;
+      }
+    }
+    reterr = kPglRetSuccess;
+
+    unsigned char* section_starts[kPvarCacheSectionCt];
+    unsigned char* section_iter = K_CAST(unsigned char*, &(pvc_base[sizeof(PvarCacheHeader)]));
+    for (uint32_t section_idx = 0; section_idx != kPvarCacheSectionCt; ++section_idx) {
+      section_starts[section_idx] = section_iter;
+      section_iter = &(section_iter[RoundUpPow2(section_blens[section_idx], kCacheline)]);
+    }
+    // Replay header-line messages in their original order.
+    const uintptr_t chrset_line_idx = pvc_headerp->chrset_line_idx;
+    const uintptr_t info_pr_nonflag_line_idx = pvc_headerp->info_pr_nonflag_line_idx;
+    if (info_pr_nonflag_line_idx && (info_pr_nonflag_line_idx < chrset_line_idx)) {
+      logerrprintfww("Warning: Header line %" PRIuPTR " of %s has an unexpected definition of INFO/PR. This interferes with a few merge and liftover operations.\n", info_pr_nonflag_line_idx, pvarname);
+    }
+    if (chrset_line_idx) {
+      reterr = LoadPvarChrsetLine(R_CAST(const char*, section_starts[kPvarCacheSectionChrset]), pvarname, misc_flags, chrset_line_idx, cip);
+      if (unlikely(reterr)) {
+        goto LoadPvarCache_ret_1;
+      }
+    }
+    if (info_pr_nonflag_line_idx > chrset_line_idx) {
+      logerrprintfww("Warning: Header line %" PRIuPTR " of %s has an unexpected definition of INFO/PR. This interferes with a few merge and liftover operations.\n", info_pr_nonflag_line_idx, pvarname);
+    }
+    FinalizeChrset(misc_flags, cip);
+
+    // The string heap goes where LoadPvar() would have put it, with the same
+    // alignment.
+    const uintptr_t heap_blen = pvc_headerp->heap_blen;
+    unsigned char* heap_end = g_bigstack_end;
+    if (R_CAST(const char*, heap_end) > (&(g_one_char_strs[512 - kMaxIdSlen]))) {
+      heap_end = R_CAST(unsigned char*, K_CAST(char*, &(g_one_char_strs[512 - kMaxIdSlen])));
+    }
+    if (unlikely(S_CAST(uintptr_t, heap_end - g_bigstack_base) < heap_blen + 2 * kCacheline)) {
+      goto LoadPvarCache_ret_NOMEM;
+    }
+    uintptr_t heap_start_addr = RoundDownPow2(R_CAST(uintptr_t, heap_end) - heap_blen, kCacheline) + pvc_headerp->heap_misalign;
+    if (heap_start_addr + heap_blen > R_CAST(uintptr_t, heap_end)) {
+      heap_start_addr -= kCacheline;
+    }
+    char* heap_start = R_CAST(char*, heap_start_addr);
+    memcpy(heap_start, section_starts[kPvarCacheSectionHeap], heap_blen);
+    BigstackEndSet(heap_start);
+
+    if (xheader_needed) {
+      const uintptr_t xheader_blen = section_blens[kPvarCacheSectionXheader];
+      if (unlikely(bigstack_left() < RoundUpPow2(xheader_blen, kCacheline))) {
+        goto LoadPvarCache_ret_NOMEM;
+      }
+      *xheader_ptr = R_CAST(char*, g_bigstack_base);
+      memcpy(*xheader_ptr, section_starts[kPvarCacheSectionXheader], xheader_blen);
+      *xheader_blen_ptr = xheader_blen;
+      BigstackBaseSet(&(g_bigstack_base[xheader_blen]));
+    }
+    const uint32_t raw_variant_ct = pvc_headerp->raw_variant_ct;
+    const uintptr_t allele_idx_end = pvc_headerp->allele_idx_end;
+    if (unlikely(bigstack_left() / sizeof(intptr_t) < allele_idx_end)) {
+      goto LoadPvarCache_ret_NOMEM;
+    }
+    const char** allele_storage = R_CAST(const char**, g_bigstack_base);
+    PvarCacheDecodeStrs(R_CAST(const uintptr_t*, section_starts[kPvarCacheSectionAlleles]), allele_idx_end, heap_start, allele_storage);
+    BigstackFinalizeCp(allele_storage, allele_idx_end);
+    if (unlikely(bigstack_alloc_cp(raw_variant_ct, variant_ids_ptr))) {
+      goto LoadPvarCache_ret_NOMEM;
+    }
+    PvarCacheDecodeStrs(R_CAST(const uintptr_t*, section_starts[kPvarCacheSectionIds]), raw_variant_ct, heap_start, K_CAST(const char**, *variant_ids_ptr));
+    const uint32_t qual_loaded = qual_needed && (pvc_flags & kfPvarCacheQual);
+    if (qual_loaded) {
+      *qual_present_ptr = R_CAST(uintptr_t*, section_starts[kPvarCacheSectionQualPresent]);
+      *quals_ptr = R_CAST(float*, section_starts[kPvarCacheSectionQuals]);
+    }
+    const uint32_t filter_loaded = filter_needed && (pvc_flags & kfPvarCacheFilter);
+    if (filter_loaded) {
+      *filter_present_ptr = R_CAST(uintptr_t*, section_starts[kPvarCacheSectionFilterPresent]);
+      *filter_npass_ptr = R_CAST(uintptr_t*, section_starts[kPvarCacheSectionFilterNpass]);
+      if (pvc_flags & kfPvarCacheFilterStorage) {
+        if (unlikely(bigstack_alloc_cp(raw_variant_ct, filter_storage_ptr))) {
+          goto LoadPvarCache_ret_NOMEM;
+        }
+        PvarCacheDecodeStrs(R_CAST(const uintptr_t*, section_starts[kPvarCacheSectionFilterStorage]), raw_variant_ct, heap_start, K_CAST(const char**, *filter_storage_ptr));
+      }
+    }
+    if (pvc_flags & kfPvarCacheNonrefFlags) {
+      *nonref_flags_ptr = R_CAST(uintptr_t*, section_starts[kPvarCacheSectionNonrefFlags]);
+    }
+    if (pvc_flags & kfPvarCacheMultiallelic) {
+      *allele_idx_offsets_ptr = R_CAST(uintptr_t*, section_starts[kPvarCacheSectionAlleleIdxOffsets]);
+    }
+    if (pvc_flags & kfPvarCacheCms) {
+      *variant_cms_ptr = R_CAST(double*, section_starts[kPvarCacheSectionCms]);
+    } else {
+      *variant_cms_ptr = nullptr;
+    }
+
+    // Nonstandard contigs are re-added in file order, so they get the same
+    // codes as before.
+    uintptr_t* loaded_chr_mask;
+    if (unlikely(bigstack_end_calloc_w(kChrMaskWords, &loaded_chr_mask))) {
+      goto LoadPvarCache_ret_NOMEM;
+    }
+    const uint32_t chr_ct = pvc_headerp->chr_ct;
+    const uint32_t* chr_table = R_CAST(const uint32_t*, section_starts[kPvarCacheSectionChrTable]);
+    const char* nonstd_name_iter = R_CAST(const char*, &(chr_table[2 * chr_ct]));
+    const uint32_t allow_extra_chrs = (misc_flags / kfMiscAllowExtraChrs) & 1;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+      uint32_t chr_code = chr_table[2 * chr_fo_idx];
+      if (chr_code == UINT32_MAX) {
+        // GetOrAddChrCode() may read a bit past the end of the name.
+        const uint32_t name_slen = strlen(nonstd_name_iter);
+        memcpyx(g_textbuf, nonstd_name_iter, name_slen, '\0');
+        reterr = GetOrAddChrCode(g_textbuf, pvc_fname, 0, name_slen, allow_extra_chrs, cip, &chr_code);
+        if (unlikely(reterr)) {
+          goto LoadPvarCache_ret_1;
+        }
+        nonstd_name_iter = &(nonstd_name_iter[name_slen + 1]);
+      }
+      cip->chr_file_order[chr_fo_idx] = chr_code;
+      cip->chr_fo_vidx_start[chr_fo_idx] = chr_table[2 * chr_fo_idx + 1];
+      cip->chr_idx_to_foidx[chr_code] = chr_fo_idx;
+      SetBit(chr_code, loaded_chr_mask);
+    }
+    cip->chr_fo_vidx_start[chr_ct] = raw_variant_ct;
+    cip->chr_ct = chr_ct;
+    BitvecAnd(loaded_chr_mask, BitCtToWordCt(cip->max_code + cip->name_ct + 1), cip->chr_mask);
+    BigstackEndSet(heap_start);
+
+    if (pvc_headerp->max_variant_id_slen > *max_variant_id_slen_ptr) {
+      *max_variant_id_slen_ptr = pvc_headerp->max_variant_id_slen;
+    }
+    // Same rules as LoadPvar(): INFO lengths are only tracked when the caller
+    // wants a reload or INFO/PR is defined as a flag, and a reload is
+    // pointless when INFO/PR is the only key.
+    uint32_t info_reload_slen = *info_reload_slen_ptr;
+    if ((pvc_flags & kfPvarCacheInfoCol) && (pvc_flags & kfPvarCacheInfoReload) && (info_reload_slen || (pvc_flags & kfPvarCacheNonrefFlags))) {
+      if (pvc_headerp->info_max_slen > info_reload_slen) {
+        info_reload_slen = pvc_headerp->info_max_slen;
+      }
+    } else {
+      info_reload_slen = 0;
+    }
+    if (info_reload_slen) {
+      if (unlikely(ForceNonFifo(pvarname))) {
+        logerrprintfww(kErrprintfRewind, pvarname);
+        reterr = kPglRetRewindFail;
+        goto LoadPvarCache_ret_1;
+      }
+    }
+    *info_reload_slen_ptr = info_reload_slen;
+    *vpos_sortstatus_ptr = S_CAST(UnsortedVar, pvc_headerp->vpos_sortstatus);
+    if (pvc_flags & kfPvarCacheInfoFlagsSet) {
+      *info_flags_ptr = S_CAST(InfoFlags, pvc_headerp->info_flags);
+    }
+    *allele_storage_ptr = allele_storage;
+    *raw_variant_ct_ptr = raw_variant_ct;
+    *variant_ct_ptr = pvc_headerp->variant_ct;
+    *max_allele_ct_ptr = pvc_headerp->max_allele_ct;
+    *max_allele_slen_ptr = pvc_headerp->max_allele_slen;
+    *max_filter_slen_ptr = filter_loaded? pvc_headerp->max_filter_slen : 0;
+    *variant_include_ptr = R_CAST(uintptr_t*, section_starts[kPvarCacheSectionInclude]);
+    *variant_bps_ptr = R_CAST(uint32_t*, section_starts[kPvarCacheSectionBps]);
+    g_pvar_cache_map = K_CAST(unsigned char*, pvc_base);
+    g_pvar_cache_map_size = pvc_size;
+    pvc_base = nullptr;
+    logprintfww("Using binary .pvar cache %s .\n", pvc_fname);
+  }
+  while (0) {
+  LoadPvarCache_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  LoadPvarCache_ret_STALE:
+    logerrprintfww("Warning: Ignoring %s, since it is out of date relative to %s.\n", pvc_fname, pvarname);
+    break;
+  }
+ LoadPvarCache_ret_1:
+  if (pvc_base) {
+    munmap(K_CAST(unsigned char*, pvc_base), pvc_size);
+  }
+  if (reterr && (reterr != kPglRetSkipped)) {
+    BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
+  }
+  return reterr;
+}
+#endif
+
 static_assert((!(kMaxIdSlen % kCacheline)), "LoadPvar() must be updated.");
-PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattened, const char* varid_template_str, const char* varid_multi_template_str, const char* varid_multi_nonsnp_template_str, const char* missing_varid_match, const char* require_info_flattened, const char* require_no_info_flattened, const CmpExpr* extract_if_info_exprp, const CmpExpr* exclude_if_info_exprp, MiscFlags misc_flags, PvarPsamFlags pvar_psam_flags, uint32_t xheader_needed, uint32_t qualfilter_needed, float var_min_qual, uint32_t splitpar_bound1, uint32_t splitpar_bound2, uint32_t new_variant_id_max_allele_slen, uint32_t snps_only, uint32_t split_chr_ok, uint32_t filter_min_allele_ct, uint32_t filter_max_allele_ct, uint32_t max_thread_ct, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, ChrIdx** chr_idxs_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr) {
+PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattened, const char* varid_template_str, const char* varid_multi_template_str, const char* varid_multi_nonsnp_template_str, const char* missing_varid_match, const char* require_info_flattened, const char* require_no_info_flattened, const CmpExpr* extract_if_info_exprp, const CmpExpr* exclude_if_info_exprp, MiscFlags misc_flags, PvarPsamFlags pvar_psam_flags, uint32_t xheader_needed, uint32_t qualfilter_needed, float var_min_qual, uint32_t splitpar_bound1, uint32_t splitpar_bound2, uint32_t new_variant_id_max_allele_slen, uint32_t snps_only, uint32_t split_chr_ok, uint32_t filter_min_allele_ct, uint32_t filter_max_allele_ct, uint32_t index_seek_ok, int32_t from_bp, int32_t to_bp, uint32_t max_thread_ct, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, ChrIdx** chr_idxs_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr) {
   // chr_info, max_variant_id_slen, and info_reload_slen are in/out; just
   // outparameters after them.  (Due to its large size in some VCFs, INFO is
   // not kept in memory for now.  This has a speed penalty, of course; maybe
@@ -834,7 +1637,40 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
   PglErr reterr = kPglRetSuccess;
   TextStream pvar_txs;
   PreinitTextStream(&pvar_txs);
+  ThreadGroup tg;
+  PreinitThreads(&tg);
   {
+    // Binary cache: use it if possible, otherwise note whether the parse
+    // below should write it.
+    PvarCacheHeader pvc_header;
+    memset(&pvc_header, 0, sizeof(PvarCacheHeader));
+    char pvc_fname[kPglFnamesize + 8];
+    char pvc_chrset_text[kPvarCacheChrsetBlenMax];
+    uint32_t pvc_write = 0;
+#ifndef NO_MMAP
+    {
+      const uint32_t pvc_ok = (!varid_template_str) && (!require_info_flattened) && (!require_no_info_flattened) && (!extract_if_info_exprp->pheno_name) && (!exclude_if_info_exprp->pheno_name) && (!(misc_flags & kfMiscExcludePvarFilterFail)) && (var_min_qual == -1) && (!splitpar_bound2) && (!snps_only) && (!filter_min_allele_ct) && (filter_max_allele_ct > kPglMaxAltAlleleCt) && PvarCacheChrConfigOk(misc_flags, cip);
+      struct stat pvar_statbuf;
+      if (pvc_ok && (!stat(pvarname, &pvar_statbuf)) && S_ISREG(pvar_statbuf.st_mode)) {
+        snprintf(pvc_fname, kPglFnamesize + 8, "%s.pvc", pvarname);
+        pvc_header.config_crc = PvarCacheConfigCrc(misc_flags, cip);
+        const uint32_t pvc_xheader_needed = (pvar_psam_flags & (kfPvarColXheader | kfPvarColVcfheader)) || xheader_needed;
+        const uint32_t pvc_qual_needed = (pvar_psam_flags & (kfPvarColMaybequal | kfPvarColQual)) || qualfilter_needed;
+        const uint32_t pvc_filter_needed = (pvar_psam_flags & (kfPvarColMaybefilter | kfPvarColFilter)) || qualfilter_needed;
+        reterr = LoadPvarCache(pvarname, pvc_fname, misc_flags, pvc_xheader_needed, pvc_qual_needed, pvc_filter_needed, pvc_header.config_crc, cip, max_variant_id_slen_ptr, info_reload_slen_ptr, vpos_sortstatus_ptr, xheader_ptr, variant_include_ptr, variant_bps_ptr, variant_ids_ptr, allele_idx_offsets_ptr, allele_storage_ptr, qual_present_ptr, quals_ptr, filter_present_ptr, filter_npass_ptr, filter_storage_ptr, nonref_flags_ptr, variant_cms_ptr, raw_variant_ct_ptr, variant_ct_ptr, max_allele_ct_ptr, max_allele_slen_ptr, xheader_blen_ptr, info_flags_ptr, max_filter_slen_ptr);
+        if (reterr != kPglRetSkipped) {
+          goto LoadPvar_ret_1;
+        }
+        reterr = kPglRetSuccess;
+        pvc_write = (misc_flags / kfMiscPvarCache) & 1;
+        if (pvc_write) {
+          pvc_header.flags = (pvc_xheader_needed * kfPvarCacheXheaderChecked) | (pvc_qual_needed * kfPvarCacheQualChecked) | (pvc_filter_needed * kfPvarCacheFilterChecked);
+        }
+      } else if (misc_flags & kfMiscPvarCache) {
+        logerrputs("Warning: --pvar-cache ignored, since variants are filtered or modified while\nthe .pvar is loaded, or it isn't a regular file.\n");
+      }
+    }
+#endif
     const uintptr_t quarter_left = RoundDownPow2(bigstack_left() / 4, kCacheline);
     uint32_t max_line_blen;
     if (unlikely(StandardizeMaxLineBlenEx(quarter_left, kLoadPvarBlockSize * 2 * sizeof(intptr_t), &max_line_blen))) {
@@ -842,8 +1678,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     }
     // bugfix (29 Jun 2018): don't cap allele_storage space at 2 GB, otherwise
     // we're limited to 134M variants
-    unsigned char* rlstream_start = &(bigstack_mark[quarter_left]);
-    g_bigstack_base = rlstream_start;
+    // Allele pointers are written to the first quarter while the file is read.
+    BigstackAllocElastic(quarter_left);
+    unsigned char* rlstream_start = g_bigstack_base;
     uint32_t decompress_thread_ct = max_thread_ct - 1;
     // 3 still seems best on a heavily multicore Linux test machine
     if (decompress_thread_ct > 3) {
@@ -855,8 +1692,22 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     if (unlikely(reterr)) {
       goto LoadPvar_ret_TSTREAM_FAIL;
     }
+    unsigned char* rlstream_end = g_bigstack_base;
+    // Lexing-pass records live next to the line buffer, so they're freed
+    // along with it.
+    uint32_t lex_thread_ct = 0;
+    PvarLexRecord* lex_records = nullptr;
+    if (max_thread_ct > 1) {
+      lex_thread_ct = MINV(max_thread_ct - 1, kMaxPvarLexThreadCt);
+      const uintptr_t lex_record_ct = 2 * lex_thread_ct * S_CAST(uintptr_t, kPvarLexRecordCapacity);
+      // Not worth squeezing a small workspace for.
+      if ((bigstack_left() / 16 < lex_record_ct * sizeof(PvarLexRecord)) ||
+          BIGSTACK_ALLOC_X(PvarLexRecord, lex_record_ct, &lex_records)) {
+        lex_thread_ct = 0;
+      }
+    }
     unsigned char* tmp_alloc_base = g_bigstack_base;
-    g_bigstack_base = bigstack_mark;
+    BigstackReset(bigstack_mark);
 
     char* xheader_end = ((pvar_psam_flags & (kfPvarColXheader | kfPvarColVcfheader)) || xheader_needed)? R_CAST(char*, bigstack_mark) : nullptr;
     uint32_t chrset_present = 0;
@@ -888,6 +1739,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
         info_pr_present = 1 - info_pr_nonflag_present;
         if (info_pr_nonflag_present) {
           logerrprintfww("Warning: Header line %" PRIuPTR " of %s has an unexpected definition of INFO/PR. This interferes with a few merge and liftover operations.\n", line_idx, pvarname);
+          pvc_header.info_pr_nonflag_line_idx = line_idx;
         }
       } else if ((!info_nonpr_present) && StrStartsWithUnsafe(line_start, "##INFO=<ID=")) {
         info_nonpr_present = 1;
@@ -898,19 +1750,23 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           goto LoadPvar_ret_MALFORMED_INPUT_WW;
         }
         chrset_present = 1;
-        const uint32_t cmdline_chrset = (cip->chrset_source == kChrsetSourceCmdline) && (!(misc_flags & kfMiscChrOverrideFile));
-        reterr = ReadChrsetHeaderLine(&(line_start[strlen("##chrSet=<")]), pvarname, misc_flags, line_idx, cip);
-        if (unlikely(reterr)) {
-          goto LoadPvar_ret_1;
-        }
-        if (!cmdline_chrset) {
-          const uint32_t autosome_ct = cip->autosome_ct;
-          if (cip->haploid_mask[0] & 1) {
-            logprintf("chrSet header line: %u autosome%s (haploid).\n", autosome_ct, (autosome_ct == 1)? "" : "s");
+        const char* chrset_iter = &(line_start[strlen("##chrSet=<")]);
+        if (pvc_write) {
+          const char* chrset_end = AdvPastDelim(chrset_iter, '\n');
+          const uint32_t chrset_slen = chrset_end - chrset_iter;
+          if (chrset_slen < kPvarCacheChrsetBlenMax) {
+            memcpyx(pvc_chrset_text, chrset_iter, chrset_slen, '\0');
+            pvc_header.chrset_blen = chrset_slen + 1;
+            pvc_header.chrset_line_idx = line_idx;
           } else {
-            logprintf("chrSet header line: %u autosome pair%s.\n", autosome_ct, (autosome_ct == 1)? "" : "s");
+            logerrputs("Warning: Not writing .pvar cache, since the ##chrSet header line is too long.\n");
+            pvc_write = 0;
           }
         }
+        reterr = LoadPvarChrsetLine(chrset_iter, pvarname, misc_flags, line_idx, cip);
+        if (unlikely(reterr)) {
+          goto LoadPvar_ret_1;
+        }
       } else if (xheader_end) {
         // if the "pvar file" was actually a VCF, suppress the same lines we'd
         // suppress when importing with --vcf.
@@ -953,6 +1809,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     uint32_t cm_col_present = 0;
     if (line_start[0] == '#') {
       *info_flags_ptr = S_CAST(InfoFlags, (info_pr_present * kfInfoPrFlagPresent) | (info_pr_nonflag_present * kfInfoPrNonflagPresent) | (info_nonpr_present * kfInfoNonprPresent));
+      pvc_header.flags |= kfPvarCacheInfoFlagsSet;
       // parse header
       // [-1] = #CHROM (must be first column)
       // [0] = POS
@@ -1064,6 +1921,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
         goto LoadPvar_ret_INCONSISTENT_INPUT;
       }
       *info_flags_ptr = kfInfoPrNonrefDefault;
+      pvc_header.flags |= kfPvarCacheInfoFlagsSet;
       col_skips[0] = 1;
       col_skips[1] = 1;
       col_skips[2] = 1;
@@ -1127,6 +1985,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     // bugfix (2 Jun 2017): forgot to zero-initialize loaded_chr_mask
     ZeroWArr(kChrMaskWords, loaded_chr_mask);
 
+    uint32_t info_slen_untracked = 0;
     InfoExist* info_existp = nullptr;
     if (require_info_flattened) {
       reterr = InfoExistInit(tmp_alloc_end, require_info_flattened, "require-info", &tmp_alloc_base, &info_existp);
@@ -1172,7 +2031,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       info_pr_present = 0;
       info_reload_slen = 0;
     } else if ((!info_pr_present) && (!info_reload_slen) && (!info_existp) && (!info_nonexistp) && (!info_keep.prekey) && (!info_remove.prekey)) {
-      info_col_present = 0;
+      // The cache still needs the INFO length.
+      info_col_present = pvc_write;
+      info_slen_untracked = pvc_write;
     }
 
     uint32_t fexcept_ct = 0;
@@ -1222,12 +2083,13 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
 
     // prevent later return-array allocations from overlapping with temporary
     // storage
-    g_bigstack_end = tmp_alloc_base;
+    BigstackEndCap(tmp_alloc_base);
 
     // prevent variant_id_htable_find from breaking
     if (R_CAST(const char*, tmp_alloc_end) > (&(g_one_char_strs[512 - kMaxIdSlen]))) {
       tmp_alloc_end = R_CAST(unsigned char*, K_CAST(char*, &(g_one_char_strs[512 - kMaxIdSlen])));
     }
+    unsigned char* pvc_heap_end = tmp_alloc_end;
     const uint32_t allow_extra_chrs = (misc_flags / kfMiscAllowExtraChrs) & 1;
     const uint32_t merge_par = ((misc_flags & (kfMiscMergePar | kfMiscMergeX)) != 0);
     const uint32_t x_code = cip->xymt_codes[kChrOffsetX];
@@ -1302,12 +2164,61 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     uint32_t is_split_chr = 0;
     UnsortedVar vpos_sortstatus = kfUnsortedVar0;
 
-    if (IsEolnKns(*line_start)) {
+    // If raw variant indexes don't need to match anything else (no .pgen, no
+    // INFO reload), a tabix/CSI index lets us skip directly to the first
+    // variant that can survive the chromosome (and --from-bp/--to-bp)
+    // filter, and stop after the last one.  Line numbers in error messages
+    // are then relative to the end of the header.
+    uint32_t kept_ref_ct = UINT32_MAX;
+    uint64_t index_voffset = UINT64_MAX;
+    if (index_seek_ok && (!info_reload_slen) && (!merge_par) && (!splitpar_bound2) && (!pvc_write) && TextIsBgzf(&pvar_txs)) {
+      index_voffset = BgzfIndexScanStart(pvarname, "--pvar file", cip, allow_extra_chrs, from_bp, to_bp, &kept_ref_ct);
+    }
+    const uint32_t index_to_bp = ((kept_ref_ct == 1) && (to_bp != -1))? to_bp : UINT32_MAX;
+    uint32_t kept_ref_seen_ct = 0;
+    uint32_t prev_kept_chr_code = UINT32_MAX;
+    uint32_t index_stop = 0;
+    if (index_voffset != UINT64_MAX) {
+      reterr = TextSeekBgzf(index_voffset, &pvar_txs);
+      if (unlikely(reterr)) {
+        goto LoadPvar_ret_TSTREAM_FAIL;
+      }
+      line_iter = TextLineEnd(&pvar_txs);
+      ++line_idx;
+    } else if (IsEolnKns(*line_start)) {
       ++line_iter;
       ++line_idx;
     } else {
       line_iter = line_start;
     }
+
+    // Worker threads lex batches of up to lex_thread_ct * kPvarLexChunkSize
+    // bytes of the loaded buffer, one batch ahead of the main thread.  A batch
+    // never extends past TextConsumeStop(), so it's always fully consumed
+    // before the next TextAdvance() call.  Lines without a matching record
+    // (a chunk had more than kPvarLexRecordCapacity lines) are lexed here.
+    PvarLexCtx lex_ctx;
+    uint32_t lex_parity = 0;
+    uint32_t lex_cur_parity = 0;
+    uint32_t lex_tidx = lex_thread_ct - 1;
+    // chromosome code before --merge-par remapping
+    uint32_t prev_raw_chr_code = UINT32_MAX;
+    const PvarLexRecord* lex_record_iter = nullptr;
+    const PvarLexRecord* lex_record_stop = nullptr;
+    // Bounds of the in-flight batch, if any.
+    char* lex_next_start = nullptr;
+    char* lex_next_end = nullptr;
+    if (lex_thread_ct) {
+      lex_ctx.col_types = col_types;
+      lex_ctx.col_skips = col_skips;
+      lex_ctx.relevant_postchr_col_ct = relevant_postchr_col_ct;
+      lex_ctx.records[0] = lex_records;
+      lex_ctx.records[1] = &(lex_records[lex_thread_ct * kPvarLexRecordCapacity]);
+      if (unlikely(SetThreadCt(lex_thread_ct, &tg))) {
+        goto LoadPvar_ret_NOMEM;
+      }
+      SetThreadFuncAndData(PvarLexThread, &lex_ctx, &tg);
+    }
     for (; TextGetUnsafe2(&pvar_txs, &line_iter); ++line_iter, ++line_idx) {
       if (unlikely(line_iter[0] == '#')) {
         snprintf(g_logbuf, kLogbufSize, "Error: Line %" PRIuPTR " of %s starts with a '#'. (This is only permitted before the first nonheader line, and if a #CHROM header line is present it must denote the end of the header block.)\n", line_idx, pvarname);
@@ -1370,15 +2281,82 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           tmp_alloc_base = R_CAST(unsigned char*, &(cur_chr_idxs[kLoadPvarBlockSize]));
         }
       }
-      char* linebuf_iter = CurTokenEnd(line_iter);
+      if (lex_thread_ct) {
+        while (lex_record_iter == lex_record_stop) {
+          if (lex_tidx + 1 != lex_thread_ct) {
+            ++lex_tidx;
+          } else {
+            if (!lex_next_start) {
+              lex_next_start = line_iter;
+              lex_next_end = PvarLexBatchEnd(line_iter, TextConsumeStop(&pvar_txs), lex_thread_ct);
+              PvarLexSplitBatch(line_iter, lex_next_end, lex_thread_ct, lex_ctx.chunk_starts[lex_parity]);
+              if (unlikely(SpawnThreads(&tg))) {
+                goto LoadPvar_ret_THREAD_CREATE_FAIL;
+              }
+              lex_parity = 1 - lex_parity;
+            } else if (line_iter < lex_next_start) {
+              // Unrecorded tail of the current batch.
+              break;
+            }
+            JoinThreads(&tg);
+            lex_cur_parity = 1 - lex_parity;
+            lex_tidx = 0;
+            char* consume_stop = TextConsumeStop(&pvar_txs);
+            if (lex_next_end != consume_stop) {
+              lex_next_start = lex_next_end;
+              lex_next_end = PvarLexBatchEnd(lex_next_start, consume_stop, lex_thread_ct);
+              PvarLexSplitBatch(lex_next_start, lex_next_end, lex_thread_ct, lex_ctx.chunk_starts[lex_parity]);
+              if (unlikely(SpawnThreads(&tg))) {
+                goto LoadPvar_ret_THREAD_CREATE_FAIL;
+              }
+              lex_parity = 1 - lex_parity;
+            } else {
+              lex_next_start = nullptr;
+            }
+          }
+          lex_record_iter = &(lex_ctx.records[lex_cur_parity][lex_tidx * kPvarLexRecordCapacity]);
+          lex_record_stop = &(lex_record_iter[lex_ctx.record_cts[lex_cur_parity][lex_tidx]]);
+        }
+      }
+      const PvarLexRecord* lex_record = nullptr;
+      if ((lex_record_iter != lex_record_stop) && (lex_record_iter->line_start == line_iter)) {
+        lex_record = lex_record_iter++;
+      }
+      char* linebuf_iter = lex_record? lex_record->chr_end : CurTokenEnd(line_iter);
       // #CHROM
       if (unlikely(*linebuf_iter == '\n')) {
         goto LoadPvar_ret_MISSING_TOKENS;
       }
       uint32_t cur_chr_code;
-      reterr = GetOrAddChrCodeDestructive(".pvar file", line_idx, allow_extra_chrs, line_iter, linebuf_iter, cip, &cur_chr_code);
-      if (unlikely(reterr)) {
-        goto LoadPvar_ret_1;
+      if (lex_record && lex_record->chr_matches_prev) {
+        // previous line was the preceding record
+        cur_chr_code = prev_raw_chr_code;
+      } else {
+        reterr = GetOrAddChrCodeDestructive(".pvar file", line_idx, allow_extra_chrs, line_iter, linebuf_iter, cip, &cur_chr_code);
+        if (unlikely(reterr)) {
+          goto LoadPvar_ret_1;
+        }
+        prev_raw_chr_code = cur_chr_code;
+      }
+      if (index_voffset != UINT64_MAX) {
+        if (!IsSet(chr_mask, cur_chr_code)) {
+          if (kept_ref_seen_ct == kept_ref_ct) {
+            // Past the last indexed sequence that may be kept.
+            index_stop = 1;
+            break;
+          }
+        } else {
+          if (cur_chr_code != prev_kept_chr_code) {
+            prev_kept_chr_code = cur_chr_code;
+            ++kept_ref_seen_ct;
+          }
+          // Records are position-sorted within each indexed sequence.
+          uint32_t cur_bp;
+          if ((index_to_bp != UINT32_MAX) && (!ScanUintDefcap(FirstNonTspace(&(linebuf_iter[1])), &cur_bp)) && (cur_bp > index_to_bp)) {
+            index_stop = 1;
+            break;
+          }
+        }
       }
       if (merge_par) {
         if (cur_chr_code == par2_code) {
@@ -1453,12 +2431,20 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       uint32_t token_slens[8];
       uint32_t extra_alt_ct;
       if (IsSet(chr_mask, cur_chr_code) || info_pr_present) {
-        linebuf_iter = TokenLex(linebuf_iter, col_types, col_skips, relevant_postchr_col_ct, token_ptrs, token_slens);
-        if (unlikely(!linebuf_iter)) {
-          goto LoadPvar_ret_MISSING_TOKENS;
+        if (!lex_record) {
+          linebuf_iter = TokenLex(linebuf_iter, col_types, col_skips, relevant_postchr_col_ct, token_ptrs, token_slens);
+          if (unlikely(!linebuf_iter)) {
+            goto LoadPvar_ret_MISSING_TOKENS;
+          }
+          extra_alt_ct = CountByte(token_ptrs[3], ',', token_slens[3]);
+        } else {
+          if (unlikely(lex_record->missing_tokens)) {
+            goto LoadPvar_ret_MISSING_TOKENS;
+          }
+          memcpy(token_ptrs, lex_record->token_ptrs, 8 * sizeof(intptr_t));
+          memcpy(token_slens, lex_record->token_slens, 8 * sizeof(int32_t));
+          extra_alt_ct = lex_record->extra_alt_ct;
         }
-
-        extra_alt_ct = CountByte(token_ptrs[3], ',', token_slens[3]);
         if (extra_alt_ct > max_extra_alt_ct) {
           if (extra_alt_ct >= kPglMaxAltAlleleCt) {
             logerrprintfww("Error: Too many ALT alleles on line %" PRIuPTR " of %s. (This " PROG_NAME_STR " build is limited to " PGL_MAX_ALT_ALLELE_CT_STR ".)\n", line_idx, pvarname);
@@ -1471,7 +2457,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
         // It is possible for the info_token[info_slen] assignment below to
         // clobber the line terminator, so we advance line_iter to eoln here
         // and never reference it again before the next line.
-        line_iter = AdvToDelim(linebuf_iter, '\n');
+        line_iter = lex_record? lex_record->line_end : AdvToDelim(linebuf_iter, '\n');
         if (info_col_present) {
           const uint32_t info_slen = token_slens[6];
           if (info_slen > info_reload_slen) {
@@ -1518,7 +2504,14 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
         }
         // POS
         int32_t cur_bp;
-        if (unlikely(ScanIntAbsDefcap(token_ptrs[0], &cur_bp))) {
+        BoolErr bp_err;
+        if (lex_record) {
+          cur_bp = lex_record->bp;
+          bp_err = lex_record->bp_err;
+        } else {
+          bp_err = ScanIntAbsDefcap(token_ptrs[0], &cur_bp);
+        }
+        if (unlikely(bp_err)) {
           snprintf(g_logbuf, kLogbufSize, "Error: Invalid bp coordinate on line %" PRIuPTR " of %s.\n", line_idx, pvarname);
           goto LoadPvar_ret_MALFORMED_INPUT_WW;
         }
@@ -1785,7 +2778,10 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           }
         }
       } else {
-        {
+        if (lex_record && (!lex_record->missing_tokens)) {
+          extra_alt_ct = lex_record->extra_alt_ct;
+          line_iter = lex_record->line_end;
+        } else {
           // linebuf_iter guaranteed to be at '\t' after chromosome code
           char* alt_col_start = NextTokenMult(linebuf_iter, alt_col_idx);
           if (unlikely(!alt_col_start)) {
@@ -1814,10 +2810,15 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       }
       ++raw_variant_ct;
     }
-    if (unlikely(TextStreamErrcode2(&pvar_txs, &reterr))) {
+    CleanupThreads(&tg);
+    if (unlikely((!index_stop) && TextStreamErrcode2(&pvar_txs, &reterr))) {
       goto LoadPvar_ret_TSTREAM_FAIL;
     }
     reterr = kPglRetSuccess;
+    pvc_header.info_max_slen = info_reload_slen;
+    if (info_slen_untracked) {
+      info_reload_slen = 0;
+    }
     if (unlikely(max_variant_id_slen > kMaxIdSlen)) {
       logerrputs("Error: Variant names are limited to " MAX_ID_SLEN_STR " characters.\n");
       goto LoadPvar_ret_MALFORMED_INPUT;
@@ -1863,6 +2864,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     *max_filter_slen_ptr = max_filter_slen;
     *raw_variant_ct_ptr = raw_variant_ct;
     uintptr_t allele_idx_end = allele_storage_iter - allele_storage;
+    // Allele pointers, per-block arrays and lexing records, ID/allele strings,
+    // and the line buffer.
+    BigstackNoteUsage(BigstackExtentUsage(allele_storage_iter, tmp_alloc_end) + S_CAST(uintptr_t, tmp_alloc_base - rlstream_end), rlstream_end - rlstream_start);
     BigstackFinalizeCp(allele_storage, allele_idx_end);
     // We may clobber this object soon, so close it now (verifying
     // rewindability first, if necessary).
@@ -2087,6 +3091,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     const uint32_t last_chr_code = cip->max_code + cip->name_ct;
     const uint32_t chr_word_ct = BitCtToWordCt(last_chr_code + 1);
     BitvecAnd(loaded_chr_mask, chr_word_ct, chr_mask);
+    // The per-block arrays were live until the copy above finished.
+    unsigned char* tmp_alloc_start = MAXV(g_bigstack_base, R_CAST(unsigned char*, loaded_chr_mask));
+    BigstackNoteUsage(BigstackExtentUsage(g_bigstack_base, tmp_alloc_end) + S_CAST(uintptr_t, tmp_alloc_base - tmp_alloc_start), 0);
     BigstackEndSet(tmp_alloc_end);
     *variant_ct_ptr = raw_variant_ct - exclude_ct;
     *vpos_sortstatus_ptr = vpos_sortstatus;
@@ -2104,6 +3111,50 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       }
     }
     *info_reload_slen_ptr = info_reload_slen;
+#ifndef NO_MMAP
+    if (pvc_write) {
+      if (is_split_chr) {
+        logerrputs("Warning: Not writing .pvar cache, since chromosomes are split.\n");
+      } else {
+        memcpy(pvc_header.magic, kPvarCacheMagic, 4);
+        pvc_header.word_byte_ct = kBytesPerWord;
+        pvc_header.flags |= ((qual_present != nullptr) * kfPvarCacheQual) | ((filter_present != nullptr) * kfPvarCacheFilter) | ((filter_storage != nullptr) * kfPvarCacheFilterStorage) | ((nonref_flags != nullptr) * kfPvarCacheNonrefFlags) | ((allele_idx_offsets != nullptr) * kfPvarCacheMultiallelic) | (((*variant_cms_ptr) != nullptr) * kfPvarCacheCms) | (info_col_present * kfPvarCacheInfoCol) | ((info_nonpr_present || info_pr_nonflag_present) * kfPvarCacheInfoReload);
+        pvc_header.raw_variant_ct = raw_variant_ct;
+        pvc_header.variant_ct = raw_variant_ct - exclude_ct;
+        pvc_header.chr_ct = cip->chr_ct;
+        pvc_header.info_flags = *info_flags_ptr;
+        pvc_header.vpos_sortstatus = vpos_sortstatus;
+        pvc_header.max_variant_id_slen = max_variant_id_slen;
+        pvc_header.max_allele_ct = max_extra_alt_ct + 2;
+        pvc_header.max_allele_slen = max_allele_slen;
+        pvc_header.max_filter_slen = max_filter_slen;
+        pvc_header.heap_misalign = R_CAST(uintptr_t, tmp_alloc_end) % kCacheline;
+        pvc_header.allele_idx_end = allele_idx_end;
+        pvc_header.xheader_blen = xheader_end? (*xheader_blen_ptr) : 0;
+        pvc_header.heap_blen = pvc_heap_end - tmp_alloc_end;
+        PvarCacheSrc pvc_src;
+        pvc_src.chrset_text = pvc_chrset_text;
+        pvc_src.xheader = xheader_end? (*xheader_ptr) : nullptr;
+        pvc_src.allele_storage = allele_storage;
+        pvc_src.variant_include = variant_include;
+        pvc_src.variant_bps = variant_bps;
+        pvc_src.variant_ids = variant_ids;
+        pvc_src.qual_present = qual_present;
+        pvc_src.quals = quals;
+        pvc_src.filter_present = filter_present;
+        pvc_src.filter_npass = filter_npass;
+        pvc_src.filter_storage = filter_storage;
+        pvc_src.nonref_flags = nonref_flags;
+        pvc_src.allele_idx_offsets = allele_idx_offsets;
+        pvc_src.variant_cms = *variant_cms_ptr;
+        pvc_src.heap_start = R_CAST(char*, tmp_alloc_end);
+        reterr = WritePvarCache(pvarname, pvc_fname, cip, &pvc_src, &pvc_header);
+        if (unlikely(reterr)) {
+          goto LoadPvar_ret_1;
+        }
+      }
+    }
+#endif
   }
 
   while (0) {
@@ -2134,8 +3185,14 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     logerrprintfww("Error: Line %" PRIuPTR " of %s has fewer tokens than expected.\n", line_idx, pvarname);
     reterr = kPglRetMalformedInput;
     break;
+  LoadPvar_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
   }
  LoadPvar_ret_1:
+  // Must precede text stream cleanup, since workers may still be reading the
+  // line buffer.
+  CleanupThreads(&tg);
   CleanupTextStream2(pvarname, &pvar_txs, &reterr);
   if (reterr) {
     BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
@@ -2143,6 +3200,77 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
   return reterr;
 }
 
+#ifndef NO_MMAP
+PglErr MakePvarCache(const char* pvarname, MiscFlags misc_flags, uint32_t max_thread_ct, ChrInfo* cip) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  unsigned char* bigstack_end_mark = g_bigstack_end;
+  PglErr reterr = kPglRetSuccess;
+  {
+    if (unlikely(!PvarCacheChrConfigOk(misc_flags, cip))) {
+      logerrputs("Error: --make-pvar-cache cannot be used with chromosome filters.\n");
+      goto MakePvarCache_ret_INVALID_CMDLINE;
+    }
+    struct stat statbuf;
+    if (unlikely(stat(pvarname, &statbuf))) {
+      logerrprintfww(kErrprintfFopen, pvarname, strerror(errno));
+      goto MakePvarCache_ret_OPEN_FAIL;
+    }
+    if (unlikely(!S_ISREG(statbuf.st_mode))) {
+      logerrprintfww("Error: --make-pvar-cache requires %s to be a regular file.\n", pvarname);
+      goto MakePvarCache_ret_INVALID_CMDLINE;
+    }
+    // Remove any existing cache first, so the LoadPvar() call below parses
+    // the .pvar and always writes a fresh one.
+    char pvc_fname[kPglFnamesize + 8];
+    snprintf(pvc_fname, kPglFnamesize + 8, "%s.pvc", pvarname);
+    if (unlikely(unlink(pvc_fname) && (errno != ENOENT))) {
+      logerrprintfww("Error: Failed to delete %s : %s.\n", pvc_fname, strerror(errno));
+      goto MakePvarCache_ret_WRITE_FAIL;
+    }
+    CmpExpr empty_expr;
+    InitCmpExpr(&empty_expr);
+    uint32_t max_variant_id_slen = 1;
+    uint32_t info_reload_slen = 0;
+    UnsortedVar vpos_sortstatus = kfUnsortedVar0;
+    char* xheader = nullptr;
+    uintptr_t* variant_include = nullptr;
+    uint32_t* variant_bps = nullptr;
+    char** variant_ids = nullptr;
+    uintptr_t* allele_idx_offsets = nullptr;
+    const char** allele_storage = nullptr;
+    uintptr_t* qual_present = nullptr;
+    float* quals = nullptr;
+    uintptr_t* filter_present = nullptr;
+    uintptr_t* filter_npass = nullptr;
+    char** filter_storage = nullptr;
+    uintptr_t* nonref_flags = nullptr;
+    double* variant_cms = nullptr;
+    ChrIdx* chr_idxs = nullptr;
+    uint32_t raw_variant_ct = 0;
+    uint32_t variant_ct = 0;
+    uint32_t max_allele_ct = 2;
+    uint32_t max_allele_slen = 1;
+    uintptr_t xheader_blen = 0;
+    InfoFlags info_flags = kfInfo0;
+    uint32_t max_filter_slen = 0;
+    reterr = LoadPvar(pvarname, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &empty_expr, &empty_expr, misc_flags | kfMiscPvarCache, kfPvarPsam0, 1, 1, -1, 0, 0, 0, 0, 0, 0, UINT32_MAX, 0, -1, -1, max_thread_ct, cip, &max_variant_id_slen, &info_reload_slen, &vpos_sortstatus, &xheader, &variant_include, &variant_bps, &variant_ids, &allele_idx_offsets, &allele_storage, &qual_present, &quals, &filter_present, &filter_npass, &filter_storage, &nonref_flags, &variant_cms, &chr_idxs, &raw_variant_ct, &variant_ct, &max_allele_ct, &max_allele_slen, &xheader_blen, &info_flags, &max_filter_slen);
+  }
+  while (0) {
+  MakePvarCache_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  MakePvarCache_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  MakePvarCache_ret_INVALID_CMDLINE:
+    reterr = kPglRetInvalidCmdline;
+    break;
+  }
+  BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
+  return reterr;
+}
+#endif
+
 // Useful when we need to read from multiple .pgens (possibly with multiallelic
 // variants) at once, and the usual LoadPvar() memory footprint is larger than
 // we want.